@@ -0,0 +1,255 @@
+##
+# Render the boot trace saved by the "boottrace -o" shell command.
+#
+# The boot trace table is recorded by the DXE core and holds the duration,
+# protocol installations and allocations of each image entry point and driver
+# binding Start() function. This tool prints the time spent in each module,
+# sorted by time, and renders a timing heatmap of the modules over the boot.
+# The time of an entry that nests other entries, e.g. an entry point that
+# calls the Start() functions of other drivers, is reported without the
+# nested entries, which are accounted to their own modules.
+# Module GUIDs are resolved to names with the Guid.xref file that GenFds
+# writes to the FV output directory of a build.
+#
+# Copyright (c) 2026, agent. All rights reserved.<BR>
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+##
+
+import argparse
+import csv
+import struct
+import sys
+import uuid
+
+#
+# Globals for help information
+#
+__prog__        = 'BootTraceReport'
+__version__     = '%s Version %s' % (__prog__, '0.10 ')
+__copyright__   = 'Copyright (c) 2026, agent. All rights reserved.'
+__description__ = 'Render the boot trace recorded by the DXE core.\n'
+
+#
+# Layout of EDKII_BOOT_TRACE_TABLE and EDKII_BOOT_TRACE_ENTRY, see
+# MdeModulePkg/Include/Guid/BootTraceTable.h
+#
+BOOT_TRACE_TABLE_SIGNATURE = b'BTRC'
+BOOT_TRACE_TABLE_VERSION   = 2
+BOOT_TRACE_TABLE_FORMAT    = '<4sIIIIIQ'
+BOOT_TRACE_ENTRY_FORMAT    = '<HHI16sQQQQQQ'
+
+BOOT_TRACE_TYPE_START_IMAGE          = 1
+BOOT_TRACE_TYPE_DRIVER_BINDING_START = 2
+
+HEATMAP_SHADES = ' .:-=+*#%@'
+
+class TraceEntry:
+    def __init__ (self, Data):
+        (self.Type,
+         self.Depth,
+         self.ProtocolInstallCount,
+         Guid,
+         self.Status,
+         self.ControllerHandle,
+         self.StartTime,
+         self.Duration,
+         self.ChildDuration,
+         self.AllocatedBytes) = struct.unpack_from (BOOT_TRACE_ENTRY_FORMAT, Data)
+        self.ModuleName = str (uuid.UUID (bytes_le = Guid)).upper ()
+        self.Children   = []
+
+    @property
+    def SelfTime (self):
+        return self.Duration - self.ChildDuration
+
+class ModuleSummary:
+    def __init__ (self, ModuleName):
+        self.ModuleName           = ModuleName
+        self.ImageTime            = 0
+        self.StartTime            = 0
+        self.StartCount           = 0
+        self.ProtocolInstallCount = 0
+        self.AllocatedBytes       = 0
+        self.Entries              = []
+
+    @property
+    def TotalTime (self):
+        return self.ImageTime + self.StartTime
+
+def ReadTrace (File):
+    Data = File.read ()
+    HeaderSize = struct.calcsize (BOOT_TRACE_TABLE_FORMAT)
+    if len (Data) < HeaderSize:
+        raise ValueError ('%s is too small for a boot trace table' % File.name)
+    Signature, Version, HeaderSize, EntrySize, EntryCount, _, RecordCount = struct.unpack_from (BOOT_TRACE_TABLE_FORMAT, Data)
+    if Signature != BOOT_TRACE_TABLE_SIGNATURE or Version != BOOT_TRACE_TABLE_VERSION:
+        raise ValueError ('%s is not a boot trace table of version %d' % (File.name, BOOT_TRACE_TABLE_VERSION))
+    if EntrySize < struct.calcsize (BOOT_TRACE_ENTRY_FORMAT) or EntryCount == 0 or len (Data) < HeaderSize + EntrySize * EntryCount:
+        raise ValueError ('%s holds a truncated boot trace table' % File.name)
+
+    #
+    # Entries are returned the oldest first
+    #
+    Count = min (RecordCount, EntryCount)
+    First = RecordCount % EntryCount if RecordCount > EntryCount else 0
+    Entries = []
+    for Position in range (Count):
+        Index = (First + Position) % EntryCount
+        Entries.append (TraceEntry (Data[HeaderSize + Index * EntrySize:]))
+    LinkChildren (Entries)
+    return RecordCount, EntryCount, Entries
+
+def LinkChildren (Entries):
+    #
+    # An entry is recorded after the entries nested in it, so the entries
+    # one level deeper that are still pending when it is read are its
+    # children. Deeper pending entries lost their parent when the ring buffer
+    # wrapped and are dropped.
+    #
+    Pending = []
+    for Entry in Entries:
+        while Pending and Pending[-1].Depth > Entry.Depth:
+            Child = Pending.pop ()
+            if Child.Depth == Entry.Depth + 1:
+                Entry.Children.insert (0, Child)
+        Pending.append (Entry)
+
+def ReadGuidXref (File):
+    Names = {}
+    for Line in File:
+        Fields = Line.split ()
+        if len (Fields) == 2:
+            try:
+                Names[str (uuid.UUID (Fields[0])).upper ()] = Fields[1]
+            except ValueError:
+                pass
+    return Names
+
+def Summarize (Entries):
+    Summaries = {}
+    for Entry in Entries:
+        Summary = Summaries.setdefault (Entry.ModuleName, ModuleSummary (Entry.ModuleName))
+        if Entry.Type == BOOT_TRACE_TYPE_START_IMAGE:
+            Summary.ImageTime += Entry.SelfTime
+        else:
+            Summary.StartTime  += Entry.SelfTime
+            Summary.StartCount += 1
+        Summary.ProtocolInstallCount += Entry.ProtocolInstallCount
+        Summary.AllocatedBytes       += Entry.AllocatedBytes
+        Summary.Entries.append (Entry)
+    return sorted (Summaries.values (), key = lambda Summary: Summary.TotalTime, reverse = True)
+
+def AddInterval (Busy, Start, End, BinTime, Sign):
+    Bin = min (Start // BinTime, len (Busy) - 1)
+    while Bin < len (Busy) and Bin * BinTime < End:
+        BinEnd = (Bin + 1) * BinTime
+        Busy[Bin] += Sign * (min (End, BinEnd) - max (Start, Bin * BinTime))
+        Bin += 1
+
+def HeatmapRow (Summary, BootStart, BinTime, Width):
+    #
+    # Fraction of each time bin spent in the entries of the module, without
+    # the entries nested in them
+    #
+    Busy = [0] * Width
+    for Entry in Summary.Entries:
+        Start = Entry.StartTime - BootStart
+        AddInterval (Busy, Start, Start + Entry.Duration, BinTime, 1)
+        for Child in Entry.Children:
+            Start = Child.StartTime - BootStart
+            AddInterval (Busy, Start, Start + Child.Duration, BinTime, -1)
+    return [min (1.0, max (0, Value) / BinTime) for Value in Busy]
+
+def ModuleLabel (Summary, Names):
+    return Names.get (Summary.ModuleName, Summary.ModuleName)
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser (prog = __prog__,
+                                      description = __description__ + __copyright__,
+                                      conflict_handler = 'resolve')
+    parser.add_argument ('TraceFile', type = argparse.FileType ('rb'),
+                         help = 'Boot trace table saved with "boottrace -o".')
+    parser.add_argument ('-x', '--xref', dest = 'XrefFile', type = argparse.FileType ('r'),
+                         help = 'Guid.xref file of the build, used to name the modules.')
+    parser.add_argument ('-n', '--top', dest = 'Top', type = int, default = 0,
+                         help = 'Only report the given number of slowest modules.')
+    parser.add_argument ('-w', '--width', dest = 'Width', type = int, default = 60,
+                         help = 'Number of time bins of the heatmap, 60 by default.')
+    parser.add_argument ('--csv', dest = 'CsvFile', type = argparse.FileType ('w', encoding = 'utf-8'),
+                         help = 'Export the heatmap as a CSV file of modules by time bins.')
+    parser.add_argument ('-r', '--raw', dest = 'Raw', action = 'store_true',
+                         help = 'Also list every entry, the oldest first.')
+    parser.add_argument ('--version', action = 'version', version = __version__)
+    args = parser.parse_args ()
+
+    try:
+        RecordCount, EntryCount, Entries = ReadTrace (args.TraceFile)
+    except ValueError as Error:
+        print ('BootTraceReport: error: %s' % Error, file = sys.stderr)
+        sys.exit (1)
+
+    Names = ReadGuidXref (args.XrefFile) if args.XrefFile else {}
+    Summaries = Summarize (Entries)
+    if args.Top > 0:
+        Summaries = Summaries[:args.Top]
+
+    print ('%d entries recorded, the last %d are held in a buffer of %d entries.' % (RecordCount, len (Entries), EntryCount))
+    if RecordCount > EntryCount:
+        print ('The oldest %d entries were overwritten, increase PcdBootTraceEntryCount to keep them.' % (RecordCount - EntryCount))
+    if len (Entries) == 0:
+        sys.exit (0)
+
+    Label = max ([len (ModuleLabel (Summary, Names)) for Summary in Summaries] + [len ('Module')])
+    print ()
+    print ('%-*s %11s %11s %7s %10s %12s' % (Label, 'Module', 'Image(us)', 'Start(us)', 'Starts', 'Protocols', 'Allocated'))
+    for Summary in Summaries:
+        print ('%-*s %11d %11d %7d %10d %12d' % (
+                 Label,
+                 ModuleLabel (Summary, Names),
+                 Summary.ImageTime // 1000,
+                 Summary.StartTime // 1000,
+                 Summary.StartCount,
+                 Summary.ProtocolInstallCount,
+                 Summary.AllocatedBytes
+                 ))
+
+    #
+    # The heatmap spans from the first entry that starts to the last one that
+    # ends. Time stamps are in nanoseconds.
+    #
+    BootStart = min (Entry.StartTime for Entry in Entries)
+    BootEnd   = max (Entry.StartTime + Entry.Duration for Entry in Entries)
+    Width     = max (1, args.Width)
+    BinTime   = max (1, -(-(BootEnd - BootStart) // Width))
+    Rows      = [(Summary, HeatmapRow (Summary, BootStart, BinTime, Width)) for Summary in Summaries]
+
+    print ()
+    print ('%-*s |%s| %d us per column' % (Label, 'Heatmap', '-' * Width, BinTime // 1000))
+    for Summary, Row in Rows:
+        print ('%-*s |%s|' % (Label, ModuleLabel (Summary, Names),
+                              ''.join (HEATMAP_SHADES[min (len (HEATMAP_SHADES) - 1, int (Value * len (HEATMAP_SHADES)))] for Value in Row)))
+
+    if args.CsvFile:
+        Writer = csv.writer (args.CsvFile)
+        Writer.writerow (['Module', 'Guid'] + ['%d' % ((BinTime * Bin) // 1000) for Bin in range (Width)])
+        for Summary, Row in Rows:
+            Writer.writerow ([ModuleLabel (Summary, Names), Summary.ModuleName] + ['%.3f' % Value for Value in Row])
+
+    if args.Raw:
+        print ()
+        print ('%-5s %5s %-*s %12s %10s %10s %9s %12s %18s %18s' % ('Type', 'Depth', Label, 'Module', 'Time(us)', 'Dur(us)', 'Self(us)', 'Protocols', 'Allocated', 'Controller', 'Status'))
+        for Entry in Entries:
+            print ('%-5s %5d %-*s %12d %10d %10d %9d %12d %18s %18s' % (
+                     'Image' if Entry.Type == BOOT_TRACE_TYPE_START_IMAGE else 'Start',
+                     Entry.Depth,
+                     Label,
+                     Names.get (Entry.ModuleName, Entry.ModuleName),
+                     (Entry.StartTime - BootStart) // 1000,
+                     Entry.Duration // 1000,
+                     Entry.SelfTime // 1000,
+                     Entry.ProtocolInstallCount,
+                     Entry.AllocatedBytes,
+                     '0x%X' % Entry.ControllerHandle,
+                     '0x%X' % Entry.Status
+                     ))
@@ -27,6 +27,14 @@
 
 #define LZMA_HEADER_SIZE (LZMA_PROPS_SIZE + 8)
 
+//
+// Layout of the data of a chunked section, see LZMA_CHUNKED_HEADER in
+// MdeModulePkg/Include/Guid/LzmaDecompress.h
+//
+#define LZMA_CHUNKED_SIGNATURE          0x434D5A4C
+#define LZMA_CHUNKED_HEADER_SIZE        16
+#define LZMA_CHUNKED_DEFAULT_BLOCK_SIZE (1 << 20)
+
 typedef enum {
   NoConverter,
   X86Converter,
@@ -44,6 +52,8 @@ static CONVERTER_TYPE mConType = NoConverter;
 
 UINT64 mDictionarySize = 28;
 UINT64 mCompressionMode = 2;
+static BoolInt mChunked = False;
+UINT64 mBlockSize = LZMA_CHUNKED_DEFAULT_BLOCK_SIZE;
 
 #define UTILITY_NAME "LzmaCompress"
 #define UTILITY_MAJOR_VERSION 0
@@ -60,6 +70,10 @@ void PrintHelp(char *buffer)
              "  -d: decode file\n"
              "  -o FileName, --output FileName: specify the output filename\n"
              "  --f86: enable converter for x86 code\n"
+             "  --chunked: split the input into blocks that are compressed\n"
+             "             independently, so that they can be decoded in parallel\n"
+             "  --block-size Size: set the size of the blocks in bytes for --chunked,\n"
+             "             default: 1048576 (1MB)\n"
              "  -v, --verbose: increase output messages\n"
              "  -q, --quiet: reduce output messages\n"
              "  --debug [0-9]: set debug level\n"
@@ -174,6 +188,184 @@ Done:
   return res;
 }
 
+static void WriteUInt32(Byte *buffer, UInt32 value)
+{
+  int i;
+  for (i = 0; i < 4; i++)
+    buffer[i] = (Byte)(value >> (8 * i));
+}
+
+static UInt32 ReadUInt32(const Byte *buffer)
+{
+  return (UInt32)buffer[0] | ((UInt32)buffer[1] << 8) | ((UInt32)buffer[2] << 16) | ((UInt32)buffer[3] << 24);
+}
+
+static SRes EncodeChunked(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize, CLzmaEncProps *props)
+{
+  SRes res;
+  size_t inSize = (size_t)fileSize;
+  size_t blockSize = (size_t)mBlockSize;
+  size_t blockCount;
+  size_t blockIndex;
+  size_t blockLength;
+  size_t offset;
+  Byte *inBuffer = 0;
+  Byte *outBuffer = 0;
+  size_t outSize;
+
+  if (fileSize > 0xFFFFFFFF)
+    return SZ_ERROR_PARAM;
+
+  if (inSize != 0) {
+    inBuffer = (Byte *)MyAlloc(inSize);
+    if (inBuffer == 0)
+      return SZ_ERROR_MEM;
+    if (SeqInStream_Read(inStream, inBuffer, inSize) != SZ_OK) {
+      res = SZ_ERROR_READ;
+      goto Done;
+    }
+  }
+
+  //
+  // Each block is a complete LZMA stream, so it can be decoded on its own.
+  // The dictionary is never larger than a block.
+  //
+  props->reduceSize = blockSize;
+  blockCount = (inSize + blockSize - 1) / blockSize;
+  offset = LZMA_CHUNKED_HEADER_SIZE + (blockCount + 1) * 4;
+  outSize = offset + blockCount * (LZMA_HEADER_SIZE + (1 << 16)) + inSize / 20 * 21;
+  outBuffer = (Byte *)MyAlloc(outSize);
+  if (outBuffer == 0) {
+    res = SZ_ERROR_MEM;
+    goto Done;
+  }
+
+  WriteUInt32(outBuffer, LZMA_CHUNKED_SIGNATURE);
+  WriteUInt32(outBuffer + 4, (UInt32)blockSize);
+  WriteUInt32(outBuffer + 8, (UInt32)inSize);
+  WriteUInt32(outBuffer + 12, (UInt32)blockCount);
+
+  res = SZ_OK;
+  for (blockIndex = 0; blockIndex < blockCount; blockIndex++) {
+    size_t outSizeProcessed;
+    size_t outPropsSize = LZMA_PROPS_SIZE;
+    int i;
+
+    WriteUInt32(outBuffer + LZMA_CHUNKED_HEADER_SIZE + blockIndex * 4, (UInt32)offset);
+
+    blockLength = inSize - blockIndex * blockSize;
+    if (blockLength > blockSize)
+      blockLength = blockSize;
+
+    for (i = 0; i < 8; i++)
+      outBuffer[offset + LZMA_PROPS_SIZE + i] = (Byte)((UInt64)blockLength >> (8 * i));
+
+    outSizeProcessed = outSize - offset - LZMA_HEADER_SIZE;
+    res = LzmaEncode(outBuffer + offset + LZMA_HEADER_SIZE, &outSizeProcessed,
+        inBuffer + blockIndex * blockSize, blockLength,
+        props, outBuffer + offset, &outPropsSize, 0,
+        NULL, &g_Alloc, &g_Alloc);
+    if (res != SZ_OK)
+      goto Done;
+
+    offset += LZMA_HEADER_SIZE + outSizeProcessed;
+    if (offset > 0xFFFFFFFF) {
+      res = SZ_ERROR_OUTPUT_EOF;
+      goto Done;
+    }
+  }
+
+  WriteUInt32(outBuffer + LZMA_CHUNKED_HEADER_SIZE + blockCount * 4, (UInt32)offset);
+
+  if (outStream->Write(outStream, outBuffer, offset) != offset)
+    res = SZ_ERROR_WRITE;
+
+Done:
+  MyFree(outBuffer);
+  MyFree(inBuffer);
+
+  return res;
+}
+
+static SRes DecodeChunked(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize)
+{
+  SRes res;
+  size_t inSize = (size_t)fileSize;
+  Byte *inBuffer = 0;
+  Byte *outBuffer = 0;
+  size_t outSize;
+  size_t blockSize;
+  size_t blockCount;
+  size_t blockIndex;
+  size_t blockStart;
+  size_t blockEnd;
+  size_t blockLength;
+  size_t inSizePure;
+  ELzmaStatus status;
+
+  if (inSize < LZMA_CHUNKED_HEADER_SIZE)
+    return SZ_ERROR_INPUT_EOF;
+
+  inBuffer = (Byte *)MyAlloc(inSize);
+  if (inBuffer == 0)
+    return SZ_ERROR_MEM;
+
+  if (SeqInStream_Read(inStream, inBuffer, inSize) != SZ_OK) {
+    res = SZ_ERROR_READ;
+    goto Done;
+  }
+
+  blockSize = ReadUInt32(inBuffer + 4);
+  outSize = ReadUInt32(inBuffer + 8);
+  blockCount = ReadUInt32(inBuffer + 12);
+  if ((ReadUInt32(inBuffer) != LZMA_CHUNKED_SIGNATURE) || (blockSize == 0) ||
+      (blockCount != (outSize + blockSize - 1) / blockSize) ||
+      (LZMA_CHUNKED_HEADER_SIZE + (blockCount + 1) * 4 > inSize)) {
+    res = SZ_ERROR_DATA;
+    goto Done;
+  }
+
+  if (outSize == 0) {
+    res = SZ_OK;
+    goto Done;
+  }
+
+  outBuffer = (Byte *)MyAlloc(outSize);
+  if (outBuffer == 0) {
+    res = SZ_ERROR_MEM;
+    goto Done;
+  }
+
+  res = SZ_OK;
+  for (blockIndex = 0; blockIndex < blockCount; blockIndex++) {
+    blockStart = ReadUInt32(inBuffer + LZMA_CHUNKED_HEADER_SIZE + blockIndex * 4);
+    blockEnd = ReadUInt32(inBuffer + LZMA_CHUNKED_HEADER_SIZE + (blockIndex + 1) * 4);
+    if ((blockStart > blockEnd) || (blockEnd > inSize) || (blockEnd - blockStart < LZMA_HEADER_SIZE)) {
+      res = SZ_ERROR_DATA;
+      goto Done;
+    }
+
+    blockLength = outSize - blockIndex * blockSize;
+    if (blockLength > blockSize)
+      blockLength = blockSize;
+
+    inSizePure = blockEnd - blockStart - LZMA_HEADER_SIZE;
+    res = LzmaDecode(outBuffer + blockIndex * blockSize, &blockLength, inBuffer + blockStart + LZMA_HEADER_SIZE, &inSizePure,
+        inBuffer + blockStart, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc);
+    if (res != SZ_OK)
+      goto Done;
+  }
+
+  if (outStream->Write(outStream, outBuffer, outSize) != outSize)
+    res = SZ_ERROR_WRITE;
+
+Done:
+  MyFree(outBuffer);
+  MyFree(inBuffer);
+
+  return res;
+}
+
 static SRes Decode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize)
 {
   SRes res;
@@ -272,6 +464,17 @@ int main2(int numArgs, const char *args[], char *rs)
       modeWasSet = True;
     } else if (strcmp(args[param], "--f86") == 0) {
       mConType = X86Converter;
+    } else if (strcmp(args[param], "--chunked") == 0) {
+      mChunked = True;
+    } else if (strcmp(args[param], "--block-size") == 0) {
+      if (numArgs < (param + 2)) {
+        return PrintUserError(rs);
+      }
+      if ((AsciiStringToUint64(args[param + 1], FALSE, &mBlockSize) != EFI_SUCCESS) ||
+          (mBlockSize == 0) || (mBlockSize > 0xFFFFFFFF)) {
+        return PrintError(rs, kInvalidParamValMessage);
+      }
+      param++;
     } else if (strcmp(args[param], "-o") == 0 ||
                strcmp(args[param], "--output") == 0) {
       if (numArgs < (param + 2)) {
@@ -342,6 +545,10 @@ int main2(int numArgs, const char *args[], char *rs)
     return PrintUserError(rs);
   }
 
+  if (mChunked && (mConType != NoConverter)) {
+    return PrintError(rs, "--chunked can not be used with --f86");
+  }
+
   {
     size_t t4 = sizeof(UInt32);
     size_t t8 = sizeof(UInt64);
@@ -364,14 +571,22 @@ int main2(int numArgs, const char *args[], char *rs)
     if (!mQuietMode) {
       printf("Encoding\n");
     }
-    res = Encode(&outStream.vt, &inStream.vt, fileSize, &props);
+    if (mChunked) {
+      res = EncodeChunked(&outStream.vt, &inStream.vt, fileSize, &props);
+    } else {
+      res = Encode(&outStream.vt, &inStream.vt, fileSize, &props);
+    }
   }
   else
   {
     if (!mQuietMode) {
       printf("Decoding\n");
     }
-    res = Decode(&outStream.vt, &inStream.vt, fileSize);
+    if (mChunked) {
+      res = DecodeChunked(&outStream.vt, &inStream.vt, fileSize);
+    } else {
+      res = Decode(&outStream.vt, &inStream.vt, fileSize);
+    }
   }
 
   File_Close(&outStream.file);
@@ -20,7 +20,18 @@ from Common import GlobalData
 from Common import EdkLogger
 import Common.LongFilePathOs as os
 
-DATABASE_VERSION = 7
+DATABASE_VERSION = 8
+
+#
+# Flag of the displacement of a bucket of the ExMap hash table that holds the
+# slot of its single PCD, see DYNAMICEX_HASH_ENTRY in PcdDataBaseSignatureGuid.h
+#
+EX_MAP_HASH_DIRECT = 0x80000000
+#
+# Number of seeds tried for a bucket of the ExMap hash table before giving up
+# the table, in which case the PCD drivers search ExMapTable.
+#
+EX_MAP_HASH_MAX_SEED = 0x10000
 
 gPcdDatabaseAutoGenC = TemplateString("""
 //
@@ -185,10 +196,11 @@ typedef struct {
   //TABLE_OFFSET          SizeTableOffset;
   //TABLE_OFFSET          SkuIdTableOffset;
   //TABLE_OFFSET          PcdNameTableOffset;
+  //TABLE_OFFSET          ExMapHashTableOffset;
   //UINT16                LocalTokenCount;  // LOCAL_TOKEN_NUMBER for all
   //UINT16                ExTokenCount;     // EX_TOKEN_NUMBER for DynamicEx
   //UINT16                GuidTableCount;   // The Number of Guid in GuidTable
-  //UINT8                 Pad[6];
+  //UINT8                 Pad[2];
   ${PHASE}_PCD_DATABASE_INIT    Init;
   ${PHASE}_PCD_DATABASE_UNINIT  Uninit;
 } ${PHASE}_PCD_DATABASE;
@@ -323,6 +335,21 @@ class DbExMapTblItemList (DbItemList):
                            GetIntegerValue(Datas[2]))
         return Buffer
 
+## DbExMapHashTblItemList
+#
+#  The class holds the ExMap hash table
+#
+class DbExMapHashTblItemList (DbItemList):
+    def __init__(self, ItemSize, DataList=None, RawDataList=None):
+        DbItemList.__init__(self, ItemSize, DataList, RawDataList)
+
+    def PackData(self):
+        Buffer = bytearray()
+        PackStr = "=LHH"
+        for (Displacement, ExMapIndex) in self.RawDataList:
+            Buffer += pack(PackStr, Displacement, ExMapIndex, 0)
+        return Buffer
+
 ## DbComItemList
 #
 # The DbComItemList is a special kind of DbItemList in case that the size of the List can not be computed by the
@@ -528,7 +555,77 @@ class DbStringItemList (DbComItemList):
         self.RawDataList = self.DataList
         return DbComItemList.PackData(self)
 
+## ExMapHash
+#
+#  Compute the hash of a DynamicEx PCD in the ExMap hash table. It must match
+#  PcdExMapHash() of the PCD drivers in MdeModulePkg/Universal/PCD.
+#
+#   @param      Guid            The token space GUID as packed in the GuidTable
+#   @param      ExTokenNumber   The token number of the PCD
+#   @param      Seed            The seed of the hash
+#
+#   @retval     The 32-bit hash
+#
+def ExMapHash(Guid, ExTokenNumber, Seed):
+    Hash = 0x811C9DC5 ^ Seed
+    for Byte in bytearray(Guid + pack('<L', ExTokenNumber)):
+        Hash = ((Hash ^ Byte) * 0x01000193) & 0xFFFFFFFF
+    Hash ^= Hash >> 16
+    Hash = (Hash * 0x85EBCA6B) & 0xFFFFFFFF
+    Hash ^= Hash >> 13
+    Hash = (Hash * 0xC2B2AE35) & 0xFFFFFFFF
+    Hash ^= Hash >> 16
+    return Hash
+
+## BuildExMapHashTable
+#
+#  Build a minimal perfect hash table of the ExMap table with the hash and
+#  displace method. The PCDs are first spread in one bucket per PCD with seed 0.
+#  Then a seed is searched for each bucket of several PCDs, the largest ones
+#  first, so that all its PCDs hash to free slots. Buckets of a single PCD are
+#  directly given one of the remaining slots.
+#
+#   @param      ExMapTable  The list of (ExTokenNumber, TokenNumber, GuidIndex)
+#   @param      GuidTable   The GUID table in C structure format
+#
+#   @retval     The list of (Displacement, ExMapIndex) entries of the table,
+#               or an empty list if no seed is found for a bucket
+#
+def BuildExMapHashTable(ExMapTable, GuidTable):
+    Count = len(ExMapTable)
+    Keys = []
+    for (ExTokenNumber, _, GuidIndex) in ExMapTable:
+        Guid = PackGUID(GuidStructureStringToGuidString(GuidTable[GetIntegerValue(GuidIndex)]).split('-'))
+        Keys.append((Guid, GetIntegerValue(ExTokenNumber)))
+
+    Buckets = [[] for _ in range(Count)]
+    for (Index, Key) in enumerate(Keys):
+        Buckets[ExMapHash(Key[0], Key[1], 0) % Count].append(Index)
+
+    Displacements = [0] * Count
+    Slots = [None] * Count
+    for Bucket in sorted(range(Count), key=lambda Bucket: len(Buckets[Bucket]), reverse=True):
+        if len(Buckets[Bucket]) < 2:
+            break
+        for Seed in range(1, EX_MAP_HASH_MAX_SEED):
+            BucketSlots = set(ExMapHash(Keys[Index][0], Keys[Index][1], Seed) % Count for Index in Buckets[Bucket])
+            if len(BucketSlots) == len(Buckets[Bucket]) and all(Slots[Slot] is None for Slot in BucketSlots):
+                break
+        else:
+            EdkLogger.verbose("No seed found for the ExMap hash table, the PCD drivers will search the ExMap table")
+            return []
+        for Index in Buckets[Bucket]:
+            Slots[ExMapHash(Keys[Index][0], Keys[Index][1], Seed) % Count] = Index
+        Displacements[Bucket] = Seed
+
+    FreeSlots = [Slot for Slot in range(Count) if Slots[Slot] is None]
+    for Bucket in range(Count):
+        if len(Buckets[Bucket]) == 1:
+            Slot = FreeSlots.pop()
+            Slots[Slot] = Buckets[Bucket][0]
+            Displacements[Bucket] = EX_MAP_HASH_DIRECT | Slot
 
+    return list(zip(Displacements, Slots))
 
 ##  Find the index in two list where the item matches the key separately
 #
@@ -611,6 +708,10 @@ def BuildExDataBase(Dict):
     DbVpdHeadValue = DbComItemList(4, RawDataList = VpdHeadValue)
     ExMapTable = list(zip(Dict['EXMAPPING_TABLE_EXTOKEN'], Dict['EXMAPPING_TABLE_LOCAL_TOKEN'], Dict['EXMAPPING_TABLE_GUID_INDEX']))
     DbExMapTable = DbExMapTblItemList(8, RawDataList = ExMapTable)
+    ExMapHashTable = []
+    if GetIntegerValue(Dict['EX_TOKEN_NUMBER']) != 0:
+        ExMapHashTable = BuildExMapHashTable(ExMapTable, Dict['GUID_STRUCTURE'])
+    DbExMapHashTable = DbExMapHashTblItemList(8, RawDataList = ExMapHashTable)
     LocalTokenNumberTable = Dict['LOCAL_TOKEN_NUMBER_DB_VALUE']
     DbLocalTokenNumberTable = DbItemList(4, RawDataList = LocalTokenNumberTable)
     GuidTable = Dict['GUID_STRUCTURE']
@@ -675,16 +776,16 @@ def BuildExDataBase(Dict):
     DbUnInitValueBoolean = DbItemList(1, RawDataList = UnInitValueBoolean)
     PcdTokenNumberMap = Dict['PCD_ORDER_TOKEN_NUMBER_MAP']
 
-    DbNameTotle = ["SkuidValue",  "InitValueUint64", "VardefValueUint64", "InitValueUint32", "VardefValueUint32", "VpdHeadValue", "ExMapTable",
+    DbNameTotle = ["SkuidValue",  "InitValueUint64", "VardefValueUint64", "InitValueUint32", "VardefValueUint32", "VpdHeadValue", "ExMapTable", "ExMapHashTable",
                "LocalTokenNumberTable", "GuidTable", "StringHeadValue",  "PcdNameOffsetTable", "VariableTable", "StringTableLen", "PcdTokenTable", "PcdCNameTable",
                "SizeTableValue", "InitValueUint16", "VardefValueUint16", "InitValueUint8", "VardefValueUint8", "InitValueBoolean",
                "VardefValueBoolean", "UnInitValueUint64", "UnInitValueUint32", "UnInitValueUint16", "UnInitValueUint8", "UnInitValueBoolean"]
 
-    DbTotal = [SkuidValue,  InitValueUint64, VardefValueUint64, InitValueUint32, VardefValueUint32, VpdHeadValue, ExMapTable,
+    DbTotal = [SkuidValue,  InitValueUint64, VardefValueUint64, InitValueUint32, VardefValueUint32, VpdHeadValue, ExMapTable, ExMapHashTable,
                LocalTokenNumberTable, GuidTable, StringHeadValue,  PcdNameOffsetTable, VariableTable, StringTableLen, PcdTokenTable, PcdCNameTable,
                SizeTableValue, InitValueUint16, VardefValueUint16, InitValueUint8, VardefValueUint8, InitValueBoolean,
                VardefValueBoolean, UnInitValueUint64, UnInitValueUint32, UnInitValueUint16, UnInitValueUint8, UnInitValueBoolean]
-    DbItemTotal = [DbSkuidValue,  DbInitValueUint64, DbVardefValueUint64, DbInitValueUint32, DbVardefValueUint32, DbVpdHeadValue, DbExMapTable,
+    DbItemTotal = [DbSkuidValue,  DbInitValueUint64, DbVardefValueUint64, DbInitValueUint32, DbVardefValueUint32, DbVpdHeadValue, DbExMapTable, DbExMapHashTable,
                DbLocalTokenNumberTable, DbGuidTable, DbStringHeadValue,  DbPcdNameOffsetTable, DbVariableTable, DbStringTableLen, DbPcdTokenTable, DbPcdCNameTable,
                DbSizeTableValue, DbInitValueUint16, DbVardefValueUint16, DbInitValueUint8, DbVardefValueUint8, DbInitValueBoolean,
                DbVardefValueBoolean, DbUnInitValueUint64, DbUnInitValueUint32, DbUnInitValueUint16, DbUnInitValueUint8, DbUnInitValueBoolean]
@@ -754,11 +855,14 @@ def BuildExDataBase(Dict):
 
     # calculate various table offset now
     DbTotalLength = FixedHeaderLen
+    ExMapHashTableOffset = 0
     for DbIndex in range(len(DbItemTotal)):
         if DbItemTotal[DbIndex] is DbLocalTokenNumberTable:
             LocalTokenNumberTableOffset = DbTotalLength
         elif DbItemTotal[DbIndex] is DbExMapTable:
             ExMapTableOffset = DbTotalLength
+        elif DbItemTotal[DbIndex] is DbExMapHashTable and ExMapHashTable:
+            ExMapHashTableOffset = DbTotalLength
         elif DbItemTotal[DbIndex] is DbGuidTable:
             GuidTableOffset = DbTotalLength
         elif DbItemTotal[DbIndex] is DbStringTableLen:
@@ -826,6 +930,9 @@ def BuildExDataBase(Dict):
     Buffer += b
     b = pack('=L', DbPcdNameOffset)
 
+    Buffer += b
+    b = pack('=L', ExMapHashTableOffset)
+
     Buffer += b
     b = pack('=H', LocalTokenCount)
 
@@ -839,10 +946,6 @@ def BuildExDataBase(Dict):
     b = pack('=B', Pad)
     Buffer += b
     Buffer += b
-    Buffer += b
-    Buffer += b
-    Buffer += b
-    Buffer += b
 
     Index = 0
     for Item in DbItemTotal:
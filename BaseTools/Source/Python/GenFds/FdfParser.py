@@ -2102,7 +2102,8 @@ class FdfParser:
             if not (self._GetBlockStatement(FvObj) or self._GetFvBaseAddress(FvObj) or
                 self._GetFvForceRebase(FvObj) or self._GetFvAlignment(FvObj) or
                 self._GetFvAttributes(FvObj) or self._GetFvNameGuid(FvObj) or
-                self._GetFvExtEntryStatement(FvObj) or self._GetFvNameString(FvObj)):
+                self._GetFvExtEntryStatement(FvObj) or self._GetFvNameString(FvObj) or
+                self._GetFvDriverIndex(FvObj)):
                 break
 
         if FvObj.FvNameString == 'TRUE' and not FvObj.FvNameGuid:
@@ -2272,6 +2273,20 @@ class FdfParser:
 
         return True
 
+    def _GetFvDriverIndex(self, FvObj):
+        if not self._IsKeyword("FvDriverIndex"):
+            return False
+
+        if not self._IsToken(TAB_EQUAL_SPLIT):
+            raise Warning.ExpectedEquals(self.FileName, self.CurrentLineNumber)
+
+        if not self._GetNextToken() or self._Token.upper() not in {'TRUE', 'FALSE'}:
+            raise Warning.Expected("TRUE or FALSE for FvDriverIndex", self.FileName, self.CurrentLineNumber)
+
+        FvObj.FvDriverIndex = self._Token.upper()
+
+        return True
+
     def _GetFvExtEntryStatement(self, FvObj):
         if not (self._IsKeyword("FV_EXT_ENTRY") or self._IsKeyword("FV_EXT_ENTRY_TYPE")):
             return False
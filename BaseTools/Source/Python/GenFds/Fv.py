@@ -15,6 +15,7 @@ import subprocess
 from io import BytesIO
 from struct import *
 from . import FfsFileStatement
+from .FvDriverIndex import FvDriverIndex
 from .GenFdsGlobalVariable import GenFdsGlobalVariable
 from Common.Misc import SaveFileOnChange, PackGUID
 from Common.LongFilePathSupport import CopyLongFilePath
@@ -41,6 +42,7 @@ class FV (object):
         self.FvAttributeDict = {}
         self.FvNameGuid = None
         self.FvNameString = None
+        self.FvDriverIndex = None
         self.AprioriSectionList = []
         self.FfsList = []
         self.BsBaseAddress = None
@@ -130,6 +132,13 @@ class FV (object):
                 self.FvInfFile.append("EFI_FILE_NAME = " + \
                                             FileName          + \
                                             TAB_LINE_BREAK)
+        # Generate the driver index last, from the FFS files of the FV
+        if not Flag and self.FvDriverIndex == 'TRUE':
+            FileName = FvDriverIndex().GenFfs(self.UiFvName, FfsFileList)
+            FfsFileList.append(FileName)
+            self.FvInfFile.append("EFI_FILE_NAME = " + \
+                                        FileName          + \
+                                        TAB_LINE_BREAK)
         if not Flag:
             FvInfFile = ''.join(self.FvInfFile)
             SaveFileOnChange(self.InfFileName, FvInfFile, False)
@@ -196,6 +205,9 @@ class FV (object):
                                                 FileSystemGuid=FFSGuid
                                                 )
 
+            if self.FvDriverIndex == 'TRUE':
+                FvDriverIndex().UpdateFv(FvOutputFile)
+
             #
             # Write the Fv contents to Buffer
             #
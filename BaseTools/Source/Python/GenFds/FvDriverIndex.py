@@ -0,0 +1,292 @@
+## @file
+# process FV files and generate the DXE driver index file of a FV
+#
+#  Copyright (c) 2026, agent. All rights reserved.<BR>
+#
+#  SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+from __future__ import absolute_import
+from struct import pack, pack_into, unpack_from
+import uuid
+import Common.LongFilePathOs as os
+from io import BytesIO
+from .GenFdsGlobalVariable import GenFdsGlobalVariable
+from .AprioriSection import DXE_APRIORI_GUID
+from Common.Misc import SaveFileOnChange
+from Common.LongFilePathSupport import OpenLongFilePath as open
+
+FV_DRIVER_INDEX_GUID = "2C024061-32F4-4796-A904-4971595338EB"
+
+FV_DRIVER_INDEX_SIGNATURE = 0x49445646   # 'FVDI'
+FV_DRIVER_INDEX_VERSION = 3
+
+FV_DRIVER_INDEX_DXE_DEPEX = 0x01
+FV_DRIVER_INDEX_SMM_DEPEX = 0x02
+FV_DRIVER_INDEX_DEPEX_UNKNOWN = 0x04
+FV_DRIVER_INDEX_NOT_APRIORI = 0xFFFFFFFF
+
+# Size of EDKII_FV_DRIVER_INDEX_HEADER and EDKII_FV_DRIVER_INDEX_ENTRY
+HEADER_SIZE = 32
+ENTRY_SIZE = 32
+
+# Offset of FvLength, IndexFileOffset and FvHeaderChecksum in EDKII_FV_DRIVER_INDEX_HEADER
+HEADER_FV_LENGTH_OFFSET = 16
+# Offset of IntegrityCheck in EDKII_FV_DRIVER_INDEX_ENTRY
+ENTRY_INTEGRITY_CHECK_OFFSET = 18
+
+FFS_ATTRIB_LARGE_FILE = 0x01
+FFS_ATTRIB_CHECKSUM = 0x40
+FV_FILETYPE_RAW = 0x01
+FV_FILETYPE_FFS_PAD = 0xF0
+
+SECTION_COMPRESSION = 0x01
+SECTION_GUID_DEFINED = 0x02
+SECTION_DXE_DEPEX = 0x13
+SECTION_RAW = 0x19
+SECTION_MM_DEPEX = 0x1C
+
+## Parse the header of a FFS file
+#
+#   @param  Data        The contents of the FFS file
+#   @retval tuple       (Name GUID string, file type, size of the file header)
+#
+def _ParseFfsHeader(Data):
+    Name = str(uuid.UUID(bytes_le=bytes(Data[0:16]))).upper()
+    Type = Data[18]
+    Attributes = Data[19]
+    if Attributes & FFS_ATTRIB_LARGE_FILE:
+        return Name, Type, 32
+    return Name, Type, 24
+
+## Iterate over the top level sections of a FFS file
+#
+#   @param  Data        The contents of the FFS file
+#   @param  Offset      Offset of the first section
+#   @retval generator   (section type, section data) tuples
+#
+def _IterSections(Data, Offset):
+    while Offset + 4 <= len(Data):
+        Size = Data[Offset] | (Data[Offset + 1] << 8) | (Data[Offset + 2] << 16)
+        Type = Data[Offset + 3]
+        HeaderSize = 4
+        if Size == 0xFFFFFF:
+            if Offset + 8 > len(Data):
+                return
+            Size = unpack_from('<I', Data, Offset + 4)[0]
+            HeaderSize = 8
+        if Size < HeaderSize or Offset + Size > len(Data):
+            return
+        yield Type, Data[Offset + HeaderSize:Offset + Size]
+        Offset = (Offset + Size + 3) & ~3
+
+## Iterate over the FFS files of a FV image
+#
+#   @param  Data        The contents of the FV
+#   @retval generator   (offset, size, name GUID string) tuples
+#
+def _IterFvFiles(Data):
+    if len(Data) < 0x38 or Data[0x28:0x2C] != b'_FVH':
+        return
+    FvLength = min(unpack_from('<Q', Data, 0x20)[0], len(Data))
+    Offset = unpack_from('<H', Data, 0x30)[0]
+    ExtHeaderOffset = unpack_from('<H', Data, 0x34)[0]
+    if ExtHeaderOffset != 0 and ExtHeaderOffset + 20 <= FvLength:
+        Offset = ExtHeaderOffset + unpack_from('<I', Data, ExtHeaderOffset + 16)[0]
+    Offset = (Offset + 7) & ~7
+    while Offset + 24 <= FvLength:
+        Header = Data[Offset:Offset + 24]
+        if Header == b'\xff' * 24 or Header == b'\0' * 24:
+            return
+        Name, Type, HeaderSize = _ParseFfsHeader(Header)
+        Size = Data[Offset + 20] | (Data[Offset + 21] << 8) | (Data[Offset + 22] << 16)
+        if HeaderSize == 32:
+            if Offset + 32 > FvLength:
+                return
+            Size = unpack_from('<Q', Data, Offset + 24)[0]
+        if Size < HeaderSize or Offset + Size > FvLength:
+            return
+        yield Offset, Size, Name
+        Offset = (Offset + Size + 7) & ~7
+
+## Record the FV a driver index was built for in the index
+#
+#   The offset of the index file, the FV header checksum and the integrity
+#   check of the FFS files are only known once GenFv has laid out the FV, so
+#   they are patched into the index file of the FV image. The DXE core walks
+#   the FFS file headers and ignores an index that does not match them.
+#
+#   @param  Data        The contents of the FV, updated in place
+#   @retval bool        True if the FV holds a driver index and it was updated
+#
+def PatchFvImage(Data):
+    for Offset, Size, Name in _IterFvFiles(Data):
+        if Name != FV_DRIVER_INDEX_GUID:
+            continue
+        _, _, HeaderSize = _ParseFfsHeader(Data[Offset:Offset + 24])
+        for SectionType, SectionData in _IterSections(Data[Offset:Offset + Size], HeaderSize):
+            if SectionType != SECTION_RAW or len(SectionData) < HEADER_SIZE:
+                return False
+            IndexOffset = Offset + Size - len(SectionData)
+            break
+        else:
+            return False
+        Signature, Version, EntryCount = unpack_from('<III', Data, IndexOffset)
+        if (Signature, Version) != (FV_DRIVER_INDEX_SIGNATURE, FV_DRIVER_INDEX_VERSION):
+            return False
+        #
+        # The files before the index, other than the APRIORI file and the pad
+        # files GenFv inserted, are the files of the index in the same order
+        #
+        EntryIndex = 0
+        for FileOffset, FileSize, FileName in _IterFvFiles(Data):
+            if FileOffset >= Offset:
+                break
+            if Data[FileOffset + 18] == FV_FILETYPE_FFS_PAD or FileName == DXE_APRIORI_GUID:
+                continue
+            EntryOffset = IndexOffset + HEADER_SIZE + EntryIndex * ENTRY_SIZE
+            if EntryIndex == EntryCount or \
+               str(uuid.UUID(bytes_le=bytes(Data[EntryOffset:EntryOffset + 16]))).upper() != FileName:
+                return False
+            Data[EntryOffset + ENTRY_INTEGRITY_CHECK_OFFSET:EntryOffset + ENTRY_INTEGRITY_CHECK_OFFSET + 2] = \
+                Data[FileOffset + 16:FileOffset + 18]
+            EntryIndex += 1
+        if EntryIndex != EntryCount:
+            return False
+        pack_into('<QIH', Data, IndexOffset + HEADER_FV_LENGTH_OFFSET,
+                  unpack_from('<Q', Data, 0x20)[0], Offset, unpack_from('<H', Data, 0x32)[0])
+        #
+        # The index changed, so the file checksum has to be updated if it is used
+        #
+        if Data[Offset + 19] & FFS_ATTRIB_CHECKSUM:
+            Data[Offset + 17] = (0x100 - (sum(Data[Offset + HeaderSize:Offset + Size]) & 0xFF)) & 0xFF
+        return True
+    return False
+
+## Build the driver index of a FV
+#
+#   Every FFS file of the FV other than the APRIORI file and pad files is
+#   listed in FV order, together with its DXE depex and its position in the
+#   DXE APRIORI file.
+#
+#   @param  FfsDataList The contents of the FFS files of the FV
+#   @retval bytes       The contents of the RAW section of the index file
+#
+def BuildIndex(FfsDataList):
+    Files = []
+    Apriori = {}
+    AprioriCount = 0
+    for Data in FfsDataList:
+        if len(Data) < 24:
+            continue
+        Name, Type, HeaderSize = _ParseFfsHeader(Data)
+        if Type == FV_FILETYPE_FFS_PAD:
+            continue
+        if Name == DXE_APRIORI_GUID:
+            for SectionType, SectionData in _IterSections(Data, HeaderSize):
+                if SectionType == SECTION_RAW:
+                    for Index in range(len(SectionData) // 16):
+                        Guid = str(uuid.UUID(bytes_le=bytes(SectionData[Index * 16:Index * 16 + 16]))).upper()
+                        Apriori.setdefault(Guid, Index)
+                    AprioriCount = len(SectionData) // 16
+                    break
+            continue
+
+        Flags = 0
+        Depex = b''
+        if Type != FV_FILETYPE_RAW:
+            for SectionType, SectionData in _IterSections(Data, HeaderSize):
+                if SectionType == SECTION_DXE_DEPEX and not Flags & FV_DRIVER_INDEX_DXE_DEPEX:
+                    Flags |= FV_DRIVER_INDEX_DXE_DEPEX
+                    Depex = bytes(SectionData)
+                elif SectionType == SECTION_MM_DEPEX:
+                    Flags |= FV_DRIVER_INDEX_SMM_DEPEX
+                elif SectionType in (SECTION_COMPRESSION, SECTION_GUID_DEFINED):
+                    #
+                    # The DXE core looks for depex sections inside of
+                    # encapsulation sections too, so let it read them
+                    #
+                    Flags = FV_DRIVER_INDEX_DEPEX_UNKNOWN
+                    Depex = b''
+                    break
+            if Flags & FV_DRIVER_INDEX_DXE_DEPEX and len(Depex) == 0:
+                Flags = FV_DRIVER_INDEX_DEPEX_UNKNOWN
+                Depex = b''
+        Files.append((Name, Type, Flags, Depex))
+
+    #
+    # FvLength, IndexFileOffset, FvHeaderChecksum and the IntegrityCheck of
+    # the entries are set by UpdateFv() once the FV is laid out
+    #
+    Buffer = BytesIO()
+    Buffer.write(pack('<IIIIQIHH', FV_DRIVER_INDEX_SIGNATURE, FV_DRIVER_INDEX_VERSION, len(Files), AprioriCount,
+                      0, 0, 0, 0))
+    DepexOffset = HEADER_SIZE + ENTRY_SIZE * len(Files)
+    for Name, Type, Flags, Depex in Files:
+        Buffer.write(uuid.UUID(Name).bytes_le)
+        Buffer.write(pack('<BBHIII', Type, Flags, 0, Apriori.get(Name, FV_DRIVER_INDEX_NOT_APRIORI),
+                          DepexOffset if Depex else 0, len(Depex)))
+        DepexOffset += (len(Depex) + 3) & ~3
+    for Name, Type, Flags, Depex in Files:
+        Buffer.write(Depex)
+        Buffer.write(b'\0' * (((len(Depex) + 3) & ~3) - len(Depex)))
+
+    return Buffer.getvalue()
+
+## generate the DXE driver index file of a FV
+#
+#
+class FvDriverIndex (object):
+    ## GenFfs() method
+    #
+    #   Generate FFS for the driver index of a FV. Every FFS file of the FV
+    #   other than the APRIORI file and pad files is listed in FV order,
+    #   together with its DXE depex and its position in the DXE APRIORI file.
+    #   The file is protected by the FFS file checksum.
+    #
+    #   @param  self        The object pointer
+    #   @param  FvName      for whom driver index file generated
+    #   @param  FfsFileList FFS files of the FV
+    #   @retval string      Generated file name
+    #
+    def GenFfs (self, FvName, FfsFileList):
+        OutputIndexFilePath = os.path.join (GenFdsGlobalVariable.WorkSpaceDir, \
+                                   GenFdsGlobalVariable.FfsDir,\
+                                   FV_DRIVER_INDEX_GUID + FvName)
+        if not os.path.exists(OutputIndexFilePath):
+            os.makedirs(OutputIndexFilePath)
+
+        OutputIndexFileName = os.path.join(OutputIndexFilePath, FV_DRIVER_INDEX_GUID + FvName + '.Index')
+        RawSectionFileName = os.path.join(OutputIndexFilePath, FV_DRIVER_INDEX_GUID + FvName + '.raw')
+        IndexFfsFileName = os.path.join(OutputIndexFilePath, FV_DRIVER_INDEX_GUID + FvName + '.Ffs')
+
+        FfsDataList = []
+        for FfsFileName in FfsFileList:
+            with open(FfsFileName, 'rb') as FfsFile:
+                FfsDataList.append(bytearray(FfsFile.read()))
+        SaveFileOnChange(OutputIndexFileName, BuildIndex(FfsDataList))
+
+        GenFdsGlobalVariable.GenerateSection(RawSectionFileName, [OutputIndexFileName], 'EFI_SECTION_RAW')
+        GenFdsGlobalVariable.GenerateFfs(IndexFfsFileName, [RawSectionFileName],
+                                        'EFI_FV_FILETYPE_FREEFORM', FV_DRIVER_INDEX_GUID, CheckSum=True)
+
+        return IndexFfsFileName
+
+    ## UpdateFv() method
+    #
+    #   Record the FV generated by GenFv in its driver index.
+    #
+    #   @param  self        The object pointer
+    #   @param  FvFileName  The FV image generated by GenFv
+    #
+    def UpdateFv (self, FvFileName):
+        with open(FvFileName, 'rb') as FvFile:
+            Data = bytearray(FvFile.read())
+        if not PatchFvImage(Data):
+            GenFdsGlobalVariable.ErrorLogger("Driver index not found in FV file %s." % FvFileName)
+            return
+        with open(FvFileName, 'wb') as FvFile:
+            FvFile.write(Data)
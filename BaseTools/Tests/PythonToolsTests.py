@@ -20,6 +20,10 @@ def TheTestSuite():
     suites.append(CheckPythonSyntax.TheTestSuite())
     import CheckUnicodeSourceFiles
     suites.append(CheckUnicodeSourceFiles.TheTestSuite())
+    import TestFvDriverIndex
+    suites.append(TestFvDriverIndex.TheTestSuite())
+    import TestPcdExMapHash
+    suites.append(TestPcdExMapHash.TheTestSuite())
     return unittest.TestSuite(suites)
 
 if __name__ == '__main__':
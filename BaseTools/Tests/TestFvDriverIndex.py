@@ -0,0 +1,261 @@
+## @file
+# Unit tests for the FV driver index generated by GenFds
+#
+#  Copyright (c) 2026, agent. All rights reserved.<BR>
+#
+#  SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+import struct
+import unittest
+import uuid
+
+import TestTools
+from GenFds.FvDriverIndex import BuildIndex, PatchFvImage, FV_DRIVER_INDEX_GUID, \
+    FV_DRIVER_INDEX_DXE_DEPEX, FV_DRIVER_INDEX_SMM_DEPEX, FV_DRIVER_INDEX_DEPEX_UNKNOWN, \
+    FV_DRIVER_INDEX_NOT_APRIORI, FV_DRIVER_INDEX_VERSION, HEADER_SIZE, ENTRY_SIZE
+from GenFds.AprioriSection import DXE_APRIORI_GUID
+
+FV_FILETYPE_FREEFORM = 0x02
+FV_FILETYPE_DRIVER = 0x07
+FV_FILETYPE_FFS_PAD = 0xF0
+
+FFS_ATTRIB_CHECKSUM = 0x40
+
+SECTION_COMPRESSION = 0x01
+SECTION_PE32 = 0x10
+SECTION_DXE_DEPEX = 0x13
+SECTION_RAW = 0x19
+SECTION_MM_DEPEX = 0x1C
+
+FV_LENGTH = 0x4000
+FV_HEADER_LENGTH = 0x48
+
+DRIVER1_GUID = '11111111-2222-3333-4444-555555555555'
+DRIVER2_GUID = '66666666-7777-8888-9999-AAAAAAAAAAAA'
+DRIVER3_GUID = 'BBBBBBBB-CCCC-DDDD-EEEE-FFFFFFFFFFFF'
+PAD_GUID = '00000000-0000-0000-0000-000000000000'
+
+def Section(Type, Data):
+    Data = struct.pack('<I', (len(Data) + 4) | (Type << 24)) + Data
+    return Data + b'\0' * (-len(Data) % 4)
+
+def FfsFile(Name, Type, Sections, Attributes=0):
+    Data = b''.join(Sections)
+    Size = 24 + len(Data)
+    Header = bytearray(uuid.UUID(Name).bytes_le + struct.pack('<BBBB', 0, 0, Type, Attributes) +
+                       struct.pack('<I', Size)[:3] + b'\xf8')
+    Header[16] = -sum(Header[:17] + Header[18:23]) & 0xFF
+    Header[17] = (-sum(Data) & 0xFF) if Attributes & FFS_ATTRIB_CHECKSUM else 0xAA
+    return bytes(Header) + Data
+
+def FvImage(Files):
+    Fv = bytearray(b'\xff' * FV_LENGTH)
+    struct.pack_into('<16x16sQ4sIHHHBB', Fv, 0, uuid.UUID('8C8CE578-8A3D-4F1C-9935-896185C32DD3').bytes_le,
+                     FV_LENGTH, b'_FVH', 0x0004FEFF, FV_HEADER_LENGTH, 0, 0, 0, 2)
+    struct.pack_into('<IIII', Fv, 0x38, FV_LENGTH // 0x1000, 0x1000, 0, 0)
+    struct.pack_into('<H', Fv, 0x32, -sum(struct.unpack_from('<36H', Fv, 0)) & 0xFFFF)
+    Offset = FV_HEADER_LENGTH
+    for File in Files:
+        Fv[Offset:Offset + len(File)] = File
+        Offset = (Offset + len(File) + 7) & ~7
+    return Fv
+
+def ParseIndex(Index):
+    Header = struct.unpack_from('<IIIIQIHH', Index, 0)
+    Entries = {}
+    for EntryIndex in range(Header[2]):
+        Entry = struct.unpack_from('<16sBBHIII', Index, HEADER_SIZE + EntryIndex * ENTRY_SIZE)
+        Entries[str(uuid.UUID(bytes_le=Entry[0])).upper()] = Entry[1:]
+    return Header, Entries
+
+## Check a driver index against its FV the same way the DXE core does
+#
+def DxeIndexMatches(Fv, IndexOffset):
+    _, _, EntryCount, _, FvLength, IndexFileOffset, FvHeaderChecksum, _ = struct.unpack_from('<IIIIQIHH', Fv, IndexOffset)
+    if FvLength != struct.unpack_from('<Q', Fv, 0x20)[0]:
+        return False
+    if FvHeaderChecksum != struct.unpack_from('<H', Fv, 0x32)[0] or sum(struct.unpack_from('<36H', Fv, 0)) & 0xFFFF:
+        return False
+    if IndexFileOffset < FV_HEADER_LENGTH or IndexFileOffset > FvLength - 24:
+        return False
+    if str(uuid.UUID(bytes_le=bytes(Fv[IndexFileOffset:IndexFileOffset + 16]))).upper() != FV_DRIVER_INDEX_GUID:
+        return False
+    IndexFileSize = struct.unpack_from('<I', Fv, IndexFileOffset + 20)[0] & 0xFFFFFF
+    if not Fv[IndexFileOffset + 19] & FFS_ATTRIB_CHECKSUM:
+        return False
+    if (Fv[IndexFileOffset + 17] + sum(Fv[IndexFileOffset + 24:IndexFileOffset + IndexFileSize])) & 0xFF:
+        return False
+    Offset = (IndexFileOffset + IndexFileSize + 7) & ~7
+    if Offset + 24 <= FvLength and Fv[Offset:Offset + 24] != b'\xff' * 24:
+        return False
+    Offset = FV_HEADER_LENGTH
+    EntryIndex = 0
+    while Offset < IndexFileOffset:
+        Name = str(uuid.UUID(bytes_le=bytes(Fv[Offset:Offset + 16]))).upper()
+        FileSize = struct.unpack_from('<I', Fv, Offset + 20)[0] & 0xFFFFFF
+        if FileSize < 24 or FileSize > IndexFileOffset - Offset:
+            return False
+        if Fv[Offset + 18] != FV_FILETYPE_FFS_PAD and Name != DXE_APRIORI_GUID:
+            if EntryIndex == EntryCount:
+                return False
+            EntryName, EntryType, _, IntegrityCheck = struct.unpack_from('<16sBBH', Fv, IndexOffset + HEADER_SIZE +
+                                                                          EntryIndex * ENTRY_SIZE)
+            if (EntryName, EntryType, IntegrityCheck) != (bytes(Fv[Offset:Offset + 16]), Fv[Offset + 18],
+                                                          struct.unpack_from('<H', Fv, Offset + 16)[0]):
+                return False
+            EntryIndex += 1
+        Offset = (Offset + FileSize + 7) & ~7
+    return Offset == IndexFileOffset and EntryIndex == EntryCount
+
+class TestFvDriverIndex(unittest.TestCase):
+
+    def setUp(self):
+        self.Depex = b'\x02\x08'
+        self.Files = [
+            FfsFile(DRIVER1_GUID, FV_FILETYPE_DRIVER,
+                    [Section(SECTION_DXE_DEPEX, self.Depex), Section(SECTION_PE32, b'\x4d\x5a' * 40)]),
+            FfsFile(PAD_GUID, FV_FILETYPE_FFS_PAD, [b'\xff' * 8]),
+            FfsFile(DRIVER2_GUID, FV_FILETYPE_DRIVER,
+                    [Section(SECTION_MM_DEPEX, b'\x08'), Section(SECTION_PE32, b'\x4d\x5a' * 8)]),
+            FfsFile(DRIVER3_GUID, FV_FILETYPE_DRIVER,
+                    [Section(SECTION_COMPRESSION, b'\0' * 16)], FFS_ATTRIB_CHECKSUM),
+            FfsFile(DXE_APRIORI_GUID, FV_FILETYPE_FREEFORM,
+                    [Section(SECTION_RAW, uuid.UUID(DRIVER2_GUID).bytes_le)]),
+        ]
+        self.Index = BuildIndex([bytearray(File) for File in self.Files])
+
+    def IndexFile(self, Attributes=FFS_ATTRIB_CHECKSUM):
+        return FfsFile(FV_DRIVER_INDEX_GUID, FV_FILETYPE_FREEFORM, [Section(SECTION_RAW, self.Index)], Attributes)
+
+    def IndexOffset(self, Fv):
+        return Fv.index(self.Index[:HEADER_SIZE - 16])
+
+    def PatchedFv(self, Files):
+        Fv = FvImage(Files + [self.IndexFile()])
+        self.assertTrue(PatchFvImage(Fv))
+        return Fv, Fv[self.IndexOffset(Fv):self.IndexOffset(Fv) + len(self.Index)]
+
+    def test_BuildIndex(self):
+        Header, Entries = ParseIndex(self.Index)
+        self.assertEqual(Header[1], FV_DRIVER_INDEX_VERSION)
+        self.assertEqual(Header[2], 3)
+        self.assertEqual(Header[3], 1)
+        self.assertEqual(Header[4:], (0, 0, 0, 0))
+        self.assertNotIn(PAD_GUID, Entries)
+
+        Type, Flags, _, Apriori, DepexOffset, DepexSize = Entries[DRIVER1_GUID]
+        self.assertEqual(Type, FV_FILETYPE_DRIVER)
+        self.assertEqual(Flags, FV_DRIVER_INDEX_DXE_DEPEX)
+        self.assertEqual(Apriori, FV_DRIVER_INDEX_NOT_APRIORI)
+        self.assertEqual(self.Index[DepexOffset:DepexOffset + DepexSize], self.Depex)
+
+        self.assertEqual(Entries[DRIVER2_GUID][1], FV_DRIVER_INDEX_SMM_DEPEX)
+        self.assertEqual(Entries[DRIVER2_GUID][3], 0)
+        self.assertEqual(Entries[DRIVER3_GUID][1], FV_DRIVER_INDEX_DEPEX_UNKNOWN)
+
+    def test_PatchFvImage(self):
+        for Attributes in (0, FFS_ATTRIB_CHECKSUM):
+            Fv = FvImage(self.Files + [self.IndexFile(Attributes)])
+            self.assertTrue(PatchFvImage(Fv))
+            self.assertEqual(len(Fv), FV_LENGTH)
+
+            IndexFileOffset = struct.unpack_from('<I', Fv, self.IndexOffset(Fv) + 24)[0]
+            IndexFileSize = struct.unpack_from('<I', Fv, IndexFileOffset + 20)[0] & 0xFFFFFF
+            if Attributes & FFS_ATTRIB_CHECKSUM:
+                self.assertEqual((Fv[IndexFileOffset + 17] + sum(Fv[IndexFileOffset + 24:IndexFileOffset + IndexFileSize])) & 0xFF, 0)
+                self.assertTrue(DxeIndexMatches(Fv, self.IndexOffset(Fv)))
+            else:
+                #
+                # The DXE core only trusts an index protected by the file checksum
+                #
+                self.assertEqual(Fv[IndexFileOffset + 17], 0xAA)
+                self.assertFalse(DxeIndexMatches(Fv, self.IndexOffset(Fv)))
+
+        Header, Entries = ParseIndex(Fv[self.IndexOffset(Fv):])
+        self.assertEqual(Header[6], struct.unpack_from('<H', Fv, 0x32)[0])
+        for File in self.Files[:4]:
+            Name = str(uuid.UUID(bytes_le=File[:16])).upper()
+            if Name in Entries:
+                self.assertEqual(Entries[Name][2], struct.unpack_from('<H', File, 16)[0])
+
+    def test_ModifiedFvDoesNotMatch(self):
+        _, Index = self.PatchedFv(self.Files)
+
+        #
+        # A driver replaced by a larger one
+        #
+        Files = list(self.Files)
+        Files[0] = FfsFile(DRIVER1_GUID, FV_FILETYPE_DRIVER,
+                           [Section(SECTION_DXE_DEPEX, self.Depex), Section(SECTION_PE32, b'\x4d\x5a' * 48)])
+        Fv = FvImage(Files + [self.IndexFile()])
+        Fv[self.IndexOffset(Fv):self.IndexOffset(Fv) + len(Index)] = Index
+        self.assertFalse(DxeIndexMatches(Fv, self.IndexOffset(Fv)))
+
+        #
+        # The data of a driver protected by the file checksum
+        #
+        Fv, _ = self.PatchedFv(self.Files)
+        DriverOffset = Fv.index(self.Files[3])
+        DriverSize = len(self.Files[3])
+        Fv[DriverOffset + 28] ^= 0x01
+        Fv[DriverOffset + 17] = -sum(Fv[DriverOffset + 24:DriverOffset + DriverSize]) & 0xFF
+        self.assertFalse(DxeIndexMatches(Fv, self.IndexOffset(Fv)))
+
+        #
+        # A driver added after the index
+        #
+        Fv, _ = self.PatchedFv(self.Files)
+        IndexFileOffset = struct.unpack_from('<I', Fv, self.IndexOffset(Fv) + 24)[0]
+        Offset = (IndexFileOffset + len(self.IndexFile()) + 7) & ~7
+        Fv[Offset:Offset + len(self.Files[0])] = self.Files[0]
+        self.assertFalse(DxeIndexMatches(Fv, self.IndexOffset(Fv)))
+
+        #
+        # The index itself
+        #
+        Fv, _ = self.PatchedFv(self.Files)
+        Fv[self.IndexOffset(Fv) + HEADER_SIZE + 20] ^= 0x01
+        self.assertFalse(DxeIndexMatches(Fv, self.IndexOffset(Fv)))
+
+        #
+        # The FV header
+        #
+        Fv, _ = self.PatchedFv(self.Files)
+        struct.pack_into('<Q', Fv, 0x20, FV_LENGTH * 2)
+        self.assertFalse(DxeIndexMatches(Fv, self.IndexOffset(Fv)))
+
+        Fv, _ = self.PatchedFv(self.Files)
+        Fv[0x2C] ^= 0x01
+        struct.pack_into('<H', Fv, 0x32, 0)
+        struct.pack_into('<H', Fv, 0x32, -sum(struct.unpack_from('<36H', Fv, 0)) & 0xFFFF)
+        self.assertFalse(DxeIndexMatches(Fv, self.IndexOffset(Fv)))
+
+    def test_MovedIndexDoesNotMatch(self):
+        _, Index = self.PatchedFv(self.Files)
+
+        Pad = FfsFile(PAD_GUID, FV_FILETYPE_FFS_PAD, [b'\xff' * 8])
+        Fv = FvImage([Pad] + self.Files + [self.IndexFile()])
+        Fv[self.IndexOffset(Fv):self.IndexOffset(Fv) + len(Index)] = Index
+        self.assertFalse(DxeIndexMatches(Fv, self.IndexOffset(Fv)))
+
+    def test_PadFilesAreSkipped(self):
+        Pad = FfsFile(PAD_GUID, FV_FILETYPE_FFS_PAD, [b'\xff' * 8])
+        Fv, _ = self.PatchedFv([Pad] + self.Files)
+        self.assertTrue(DxeIndexMatches(Fv, self.IndexOffset(Fv)))
+
+    def test_FvWithOtherFiles(self):
+        self.assertFalse(PatchFvImage(FvImage(self.Files[2:] + [self.IndexFile()])))
+        self.assertFalse(PatchFvImage(FvImage(self.Files + self.Files[:1] + [self.IndexFile()])))
+
+    def test_FvWithoutIndex(self):
+        self.assertFalse(PatchFvImage(FvImage(self.Files)))
+
+TheTestSuite = TestTools.MakeTheTestSuite(locals())
+
+if __name__ == '__main__':
+    allTests = TheTestSuite()
+    unittest.TextTestRunner().run(allTests)
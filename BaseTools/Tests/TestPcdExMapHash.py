@@ -0,0 +1,96 @@
+## @file
+# Unit tests for the ExMap hash table of the PCD database generated by GenPcdDb
+#
+#  Copyright (c) 2026, agent. All rights reserved.<BR>
+#
+#  SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+import random
+import struct
+import unittest
+
+import TestTools
+from Common.Misc import GuidStructureStringToGuidString, PackGUID
+import AutoGen.GenPcdDb as GenPcdDb
+from AutoGen.GenPcdDb import BuildExMapHashTable, DbExMapHashTblItemList, ExMapHash, EX_MAP_HASH_DIRECT
+
+#
+# The PCDs of MdeModulePkg/Universal/PCD/Dxe/UnitTest/PcdExMapHashUnitTest.c,
+# which checks that the PCD DXE driver finds them in the table below.
+#
+GUID_TABLE = [
+    '{0x914AEBE7, 0x4635, 0x459b, {0xAA, 0x1C, 0x11, 0xE2, 0x19, 0xB0, 0x3A, 0x10}}',
+    '{0xA1AFF049, 0xFDEB, 0x442a, {0xB3, 0x20, 0x13, 0xAB, 0x4C, 0xB7, 0x2B, 0xBC}}',
+    '{0x3C7D193C, 0x682C, 0x4C14, {0xA6, 0x8F, 0x55, 0x2D, 0xEA, 0x4F, 0x43, 0x7E}}',
+]
+EX_MAP_TABLE = [('0x%X' % (0x10000 + (Index // 3) * 0x11 + Index % 3), str(Index + 1), str(Index % 3)) for Index in range(24)]
+EX_MAP_HASH_TABLE = [
+    (0x00000004, 3), (0x00000001, 6), (0x00000007, 17), (0x80000013, 15),
+    (0x80000011, 0), (0x00000001, 5), (0x00000000, 18), (0x00000000, 20),
+    (0x8000000C, 19), (0x00000000, 1), (0x00000001, 10), (0x8000000A, 21),
+    (0x80000009, 9), (0x80000004, 13), (0x00000000, 8), (0x00000000, 11),
+    (0x00000000, 22), (0x00000000, 16), (0x00000001, 4), (0x00000000, 12),
+    (0x00000000, 7), (0x00000000, 14), (0x00000003, 23), (0x80000000, 2),
+]
+
+def PackedGuid(GuidStructure):
+    return PackGUID(GuidStructureStringToGuidString(GuidStructure).split('-'))
+
+## Look up a PCD in the packed hash table the same way the PCD drivers do
+#
+def LookupExMapIndex(HashTable, Guid, ExTokenNumber):
+    Count = len(HashTable) // 8
+    Displacement = struct.unpack_from('<L', HashTable, (ExMapHash(Guid, ExTokenNumber, 0) % Count) * 8)[0]
+    if Displacement & EX_MAP_HASH_DIRECT:
+        Slot = Displacement & ~EX_MAP_HASH_DIRECT
+    else:
+        Slot = ExMapHash(Guid, ExTokenNumber, Displacement) % Count
+    return struct.unpack_from('<H', HashTable, Slot * 8 + 4)[0]
+
+def RandomExMapTable(Random, Count):
+    GuidTable = ['{0x%08X, 0x%04X, 0x%04X, {%s}}' % (Random.getrandbits(32), Random.getrandbits(16), Random.getrandbits(16),
+                 ', '.join('0x%02X' % Random.getrandbits(8) for _ in range(8))) for _ in range(4)]
+    Keys = set()
+    while len(Keys) < Count:
+        Keys.add((Random.getrandbits(32), Random.randrange(len(GuidTable))))
+    return [(str(ExTokenNumber), str(Index + 1), str(GuidIndex)) for (Index, (ExTokenNumber, GuidIndex)) in enumerate(Keys)], GuidTable
+
+class TestPcdExMapHash(unittest.TestCase):
+
+    def test_HashMatchesDriver(self):
+        Guid = PackedGuid(GUID_TABLE[0])
+        self.assertEqual(ExMapHash(Guid, 0x10000, 0), 0xAB42E305)
+        self.assertEqual(ExMapHash(Guid, 0x10000, 1), 0xA12BD747)
+        self.assertEqual(ExMapHash(Guid, 0x10000, 0x1234), 0x1D072323)
+
+    def test_TableMatchesDriverTest(self):
+        self.assertEqual(BuildExMapHashTable(EX_MAP_TABLE, GUID_TABLE), EX_MAP_HASH_TABLE)
+
+    def test_EveryPcdIsFound(self):
+        Random = random.Random(0x5EED)
+        for Count in (1, 2, 3, 7, 64, 500):
+            ExMapTable, GuidTable = RandomExMapTable(Random, Count)
+            HashTable = DbExMapHashTblItemList(8, RawDataList = BuildExMapHashTable(ExMapTable, GuidTable)).PackData()
+            self.assertEqual(len(HashTable), Count * 8)
+            for (Index, (ExTokenNumber, _, GuidIndex)) in enumerate(ExMapTable):
+                self.assertEqual(LookupExMapIndex(HashTable, PackedGuid(GuidTable[int(GuidIndex)]), int(ExTokenNumber)), Index)
+
+    def test_NoSeedFound(self):
+        Random = random.Random(0x5EED)
+        ExMapTable, GuidTable = RandomExMapTable(Random, 64)
+        MaxSeed = GenPcdDb.EX_MAP_HASH_MAX_SEED
+        GenPcdDb.EX_MAP_HASH_MAX_SEED = 2
+        try:
+            self.assertEqual(BuildExMapHashTable(ExMapTable, GuidTable), [])
+        finally:
+            GenPcdDb.EX_MAP_HASH_MAX_SEED = MaxSeed
+
+TheTestSuite = TestTools.MakeTheTestSuite(locals())
+
+if __name__ == '__main__':
+    allTests = TheTestSuite()
+    unittest.TextTestRunner().run(allTests)
@@ -0,0 +1,209 @@
+/** @file
+  Measure the sequential write throughput of the file system the application
+  is loaded from. A 1 GB file is written in chunks of 1 MB, flushed, and then
+  deleted. The cluster allocators of the EDK II FAT driver are compared by
+  running the application with the driver built with PcdFatScanClusterAllocator
+  set to TRUE, and then to FALSE.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Guid/FileSystemInfo.h>
+#include <Protocol/LoadedImage.h>
+#include <Protocol/SimpleFileSystem.h>
+#include <Protocol/Timestamp.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiApplicationEntryPoint.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/UefiLib.h>
+
+#define BENCHMARK_FILE_NAME   L"FatWriteBenchmark.bin"
+#define BENCHMARK_FILE_SIZE   SIZE_1GB
+#define BENCHMARK_CHUNK_SIZE  SIZE_1MB
+
+EFI_TIMESTAMP_PROTOCOL  *mTimestamp;
+UINT64                  mTimestampFrequency;
+
+/**
+  Return the current time in microseconds, from the timestamp protocol if it
+  is installed, or from the real time clock.
+
+  @return The current time in microseconds.
+
+**/
+UINT64
+GetTimeInMicroseconds (
+  VOID
+  )
+{
+  EFI_TIME  Time;
+
+  if (mTimestamp != NULL) {
+    return DivU64x64Remainder (MultU64x32 (mTimestamp->GetTimestamp (), 1000000), mTimestampFrequency, NULL);
+  }
+
+  if (EFI_ERROR (gRT->GetTime (&Time, NULL))) {
+    return 0;
+  }
+
+  return MultU64x32 ((Time.Day * 24 + Time.Hour) * 3600 + Time.Minute * 60 + Time.Second, 1000000) +
+         Time.Nanosecond / 1000;
+}
+
+/**
+  The user Entry Point for Application. The user code starts with this function
+  as the real entry point for the application.
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The benchmark completed.
+  @retval other             Some error occurs when executing this entry point.
+
+**/
+EFI_STATUS
+EFIAPI
+FatWriteBenchmarkMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS                       Status;
+  EFI_LOADED_IMAGE_PROTOCOL        *LoadedImage;
+  EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *FileSystem;
+  EFI_FILE_PROTOCOL                *Root;
+  EFI_FILE_PROTOCOL                *File;
+  EFI_FILE_SYSTEM_INFO             *FileSystemInfo;
+  EFI_TIMESTAMP_PROPERTIES         Properties;
+  VOID                             *Buffer;
+  UINTN                            BufferSize;
+  UINT64                           Written;
+  UINT64                           Start;
+  UINT64                           Elapsed;
+
+  Status = gBS->HandleProtocol (ImageHandle, &gEfiLoadedImageProtocolGuid, (VOID **)&LoadedImage);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->HandleProtocol (LoadedImage->DeviceHandle, &gEfiSimpleFileSystemProtocolGuid, (VOID **)&FileSystem);
+  if (EFI_ERROR (Status)) {
+    Print (L"The application is not loaded from a file system: %r\n", Status);
+    return Status;
+  }
+
+  Status = gBS->LocateProtocol (&gEfiTimestampProtocolGuid, NULL, (VOID **)&mTimestamp);
+  if (EFI_ERROR (Status) || EFI_ERROR (mTimestamp->GetProperties (&Properties)) || (Properties.Frequency == 0)) {
+    mTimestamp = NULL;
+  } else {
+    mTimestampFrequency = Properties.Frequency;
+  }
+
+  Status = FileSystem->OpenVolume (FileSystem, &Root);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  File   = NULL;
+  Buffer = NULL;
+
+  //
+  // Make sure the file fits in the free space of the volume
+  //
+  BufferSize     = 0;
+  FileSystemInfo = NULL;
+  Status         = Root->GetInfo (Root, &gEfiFileSystemInfoGuid, &BufferSize, NULL);
+  if (Status == EFI_BUFFER_TOO_SMALL) {
+    FileSystemInfo = AllocatePool (BufferSize);
+    if (FileSystemInfo == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto Done;
+    }
+
+    Status = Root->GetInfo (Root, &gEfiFileSystemInfoGuid, &BufferSize, FileSystemInfo);
+  }
+
+  if (EFI_ERROR (Status)) {
+    if (FileSystemInfo != NULL) {
+      FreePool (FileSystemInfo);
+    }
+
+    goto Done;
+  }
+
+  if (FileSystemInfo->FreeSpace < BENCHMARK_FILE_SIZE) {
+    Print (L"%lu bytes are free, %lu bytes are needed\n", FileSystemInfo->FreeSpace, (UINT64)BENCHMARK_FILE_SIZE);
+    FreePool (FileSystemInfo);
+    Status = EFI_VOLUME_FULL;
+    goto Done;
+  }
+
+  FreePool (FileSystemInfo);
+
+  Buffer = AllocatePool (BENCHMARK_CHUNK_SIZE);
+  if (Buffer == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+
+  SetMem (Buffer, BENCHMARK_CHUNK_SIZE, 0x5A);
+
+  Status = Root->Open (
+                   Root,
+                   &File,
+                   BENCHMARK_FILE_NAME,
+                   EFI_FILE_MODE_CREATE | EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE,
+                   0
+                   );
+  if (EFI_ERROR (Status)) {
+    Print (L"Failed to create %s: %r\n", BENCHMARK_FILE_NAME, Status);
+    File = NULL;
+    goto Done;
+  }
+
+  Start = GetTimeInMicroseconds ();
+  for (Written = 0; Written < BENCHMARK_FILE_SIZE; Written += BufferSize) {
+    BufferSize = BENCHMARK_CHUNK_SIZE;
+    Status     = File->Write (File, &BufferSize, Buffer);
+    if (EFI_ERROR (Status)) {
+      Print (L"Write failed at offset %lu: %r\n", Written, Status);
+      goto Done;
+    }
+  }
+
+  Status = File->Flush (File);
+  if (EFI_ERROR (Status)) {
+    Print (L"Flush failed: %r\n", Status);
+    goto Done;
+  }
+
+  Elapsed = GetTimeInMicroseconds () - Start;
+  if (Elapsed == 0) {
+    Elapsed = 1;
+  }
+
+  Print (
+    L"Wrote %lu MB in %lu ms: %lu MB/s\n",
+    RShiftU64 (Written, 20),
+    DivU64x32 (Elapsed, 1000),
+    DivU64x64Remainder (MultU64x32 (RShiftU64 (Written, 20), 1000000), Elapsed, NULL)
+    );
+
+Done:
+  if (File != NULL) {
+    File->Delete (File);
+  }
+
+  if (Buffer != NULL) {
+    FreePool (Buffer);
+  }
+
+  Root->Close (Root);
+  return Status;
+}
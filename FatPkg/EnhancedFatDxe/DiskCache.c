@@ -152,6 +152,95 @@ FatExchangeCachePage (
   return EFI_SUCCESS;
 }
 
+/**
+
+  Load a cache page, and the pages that follow it, from the disk with one
+  disk access. The pages are read ahead into the groups that follow the group
+  of the page, up to the end of the cache, so they are contiguous in the cache.
+  The read-ahead stops before a group that holds dirty data, or that already
+  holds the page.
+
+  @param  Volume                - FAT file system volume.
+  @param  CacheDataType         - The cache type: CACHE_FAT or CACHE_DATA.
+  @param  PageNo                - PageNo of the page to load; its cache page
+                                  must not be dirty.
+
+  @retval EFI_SUCCESS           - The pages are loaded.
+  @return other                 - An error occurred when reading the pages.
+
+**/
+STATIC
+EFI_STATUS
+FatPrefetchCachePages (
+  IN FAT_VOLUME       *Volume,
+  IN CACHE_DATA_TYPE  CacheDataType,
+  IN UINTN            PageNo
+  )
+{
+  EFI_STATUS  Status;
+  DISK_CACHE  *DiskCache;
+  CACHE_TAG   *CacheTag;
+  UINTN       GroupNo;
+  UINTN       PageCount;
+  UINTN       Index;
+  UINTN       PageSize;
+  UINTN       RealSize;
+  UINT64      EntryPos;
+  UINT8       PageAlignment;
+
+  DiskCache     = &Volume->DiskCache[CacheDataType];
+  GroupNo       = PageNo & DiskCache->GroupMask;
+  PageAlignment = DiskCache->PageAlignment;
+  PageSize      = (UINTN)1 << PageAlignment;
+  EntryPos      = DiskCache->BaseAddress + LShiftU64 (PageNo, PageAlignment);
+  PageCount     = MIN (DiskCache->PrefetchPageCount + 1, DiskCache->GroupMask + 1 - GroupNo);
+
+  for (Index = 1; Index < PageCount; Index++) {
+    CacheTag = &DiskCache->CacheTag[GroupNo + Index];
+    if ((CacheTag->RealSize > 0) && (CacheTag->Dirty || (CacheTag->PageNo == PageNo + Index))) {
+      break;
+    }
+
+    if (EntryPos + LShiftU64 (Index, PageAlignment) >= DiskCache->LimitAddress) {
+      break;
+    }
+  }
+
+  PageCount = Index;
+  RealSize  = PageCount << PageAlignment;
+  if (DiskCache->LimitAddress - EntryPos < RealSize) {
+    RealSize = (UINTN)(DiskCache->LimitAddress - EntryPos);
+  }
+
+  Status = FatDiskIo (
+             Volume,
+             ReadDisk,
+             EntryPos,
+             RealSize,
+             DiskCache->CacheBase + (GroupNo << PageAlignment),
+             NULL
+             );
+
+  for (Index = 0; Index < PageCount; Index++) {
+    CacheTag             = &DiskCache->CacheTag[GroupNo + Index];
+    CacheTag->PageNo     = PageNo + Index;
+    CacheTag->Dirty      = FALSE;
+    CacheTag->Prefetched = (BOOLEAN)(Index != 0);
+    CacheTag->RealSize   = 0;
+    if (!EFI_ERROR (Status)) {
+      CacheTag->RealSize = MIN (PageSize, RealSize - (Index << PageAlignment));
+    }
+  }
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  DiskCache->PrefetchCount += PageCount - 1;
+  DiskCache->NextPageNo     = PageNo + PageCount;
+  return EFI_SUCCESS;
+}
+
 /**
 
   Get one cache page by specified PageNo.
@@ -176,15 +265,25 @@ FatGetCachePage (
 {
   EFI_STATUS  Status;
   UINTN       OldPageNo;
+  DISK_CACHE  *DiskCache;
 
+  DiskCache = &Volume->DiskCache[CacheDataType];
   OldPageNo = CacheTag->PageNo;
   if ((CacheTag->RealSize > 0) && (OldPageNo == PageNo)) {
     //
     // Cache Hit occurred
     //
+    DiskCache->HitCount++;
+    if (CacheTag->Prefetched) {
+      DiskCache->PrefetchHitCount++;
+      CacheTag->Prefetched = FALSE;
+    }
+
     return EFI_SUCCESS;
   }
 
+  DiskCache->MissCount++;
+
   //
   // Write dirty cache page back to disk
   //
@@ -195,11 +294,21 @@ FatGetCachePage (
     }
   }
 
+  //
+  // A miss on the page that follows the last miss is a sequential access,
+  // read the pages after it ahead
+  //
+  if ((DiskCache->PrefetchPageCount != 0) && (PageNo == DiskCache->NextPageNo)) {
+    return FatPrefetchCachePages (Volume, CacheDataType, PageNo);
+  }
+
   //
   // Load new data from disk;
   //
-  CacheTag->PageNo = PageNo;
-  Status           = FatExchangeCachePage (Volume, CacheDataType, ReadDisk, CacheTag, NULL);
+  CacheTag->PageNo      = PageNo;
+  CacheTag->Prefetched  = FALSE;
+  DiskCache->NextPageNo = PageNo + 1;
+  Status                = FatExchangeCachePage (Volume, CacheDataType, ReadDisk, CacheTag, NULL);
 
   return Status;
 }
@@ -452,13 +561,15 @@ FatInitializeDiskCache (
 {
   DISK_CACHE  *DiskCache;
   UINTN       FatCacheGroupCount;
+  UINTN       DataCacheGroupCount;
   UINTN       DataCacheSize;
   UINTN       FatCacheSize;
   UINT8       *CacheBuffer;
 
   DiskCache = Volume->DiskCache;
   //
-  // Configure the parameters of disk cache
+  // Configure the parameters of disk cache; the geometry of the Data cache
+  // of FAT16 and FAT32 volumes is set by the platform
   //
   if (Volume->FatType == Fat12) {
     FatCacheGroupCount                 = FAT_FATCACHE_GROUP_MIN_COUNT;
@@ -467,21 +578,34 @@ FatInitializeDiskCache (
   } else {
     FatCacheGroupCount                 = FAT_FATCACHE_GROUP_MAX_COUNT;
     DiskCache[CacheFat].PageAlignment  = FAT_FATCACHE_PAGE_MAX_ALIGNMENT;
-    DiskCache[CacheData].PageAlignment = FAT_DATACACHE_PAGE_MAX_ALIGNMENT;
+    DiskCache[CacheData].PageAlignment = PcdGet8 (PcdFatDataCachePageAlignment);
+    if (DiskCache[CacheData].PageAlignment < FAT_DATACACHE_PAGE_MIN_ALIGNMENT) {
+      DiskCache[CacheData].PageAlignment = FAT_DATACACHE_PAGE_MIN_ALIGNMENT;
+    } else if (DiskCache[CacheData].PageAlignment > FAT_DATACACHE_PAGE_MAX_ALIGNMENT) {
+      DiskCache[CacheData].PageAlignment = FAT_DATACACHE_PAGE_MAX_ALIGNMENT;
+    }
   }
 
-  DiskCache[CacheData].GroupMask    = FAT_DATACACHE_GROUP_COUNT - 1;
-  DiskCache[CacheData].BaseAddress  = Volume->RootPos;
-  DiskCache[CacheData].LimitAddress = Volume->VolumeSize;
-  DiskCache[CacheFat].GroupMask     = FatCacheGroupCount - 1;
-  DiskCache[CacheFat].BaseAddress   = Volume->FatPos;
-  DiskCache[CacheFat].LimitAddress  = Volume->FatPos + Volume->FatSize;
-  FatCacheSize                      = FatCacheGroupCount << DiskCache[CacheFat].PageAlignment;
-  DataCacheSize                     = FAT_DATACACHE_GROUP_COUNT << DiskCache[CacheData].PageAlignment;
+  DataCacheGroupCount = PcdGet32 (PcdFatDataCachePageCount);
+  DataCacheGroupCount = GetPowerOfTwo32 ((UINT32)MIN (MAX (DataCacheGroupCount, 1), FAT_DATACACHE_GROUP_MAX_COUNT));
+
+  DiskCache[CacheData].GroupMask         = DataCacheGroupCount - 1;
+  DiskCache[CacheData].BaseAddress       = Volume->RootPos;
+  DiskCache[CacheData].LimitAddress      = Volume->VolumeSize;
+  DiskCache[CacheData].PrefetchPageCount = MIN (PcdGet32 (PcdFatDataCachePrefetchPageCount), DataCacheGroupCount / 2);
+  DiskCache[CacheData].NextPageNo        = MAX_UINTN;
+  DiskCache[CacheFat].GroupMask          = FatCacheGroupCount - 1;
+  DiskCache[CacheFat].BaseAddress        = Volume->FatPos;
+  DiskCache[CacheFat].LimitAddress       = Volume->FatPos + Volume->FatSize;
+  FatCacheSize                           = FatCacheGroupCount << DiskCache[CacheFat].PageAlignment;
+  DataCacheSize                          = DataCacheGroupCount << DiskCache[CacheData].PageAlignment;
   //
-  // Allocate the Fat Cache buffer
+  // Allocate the Fat Cache buffer, followed by the cache tags
   //
-  CacheBuffer = AllocateZeroPool (FatCacheSize + DataCacheSize);
+  CacheBuffer = AllocateZeroPool (
+                  FatCacheSize + DataCacheSize +
+                  (FatCacheGroupCount + DataCacheGroupCount) * sizeof (CACHE_TAG)
+                  );
   if (CacheBuffer == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
@@ -489,5 +613,97 @@ FatInitializeDiskCache (
   Volume->CacheBuffer            = CacheBuffer;
   DiskCache[CacheFat].CacheBase  = CacheBuffer;
   DiskCache[CacheData].CacheBase = CacheBuffer + FatCacheSize;
+  DiskCache[CacheFat].CacheTag   = (CACHE_TAG *)(CacheBuffer + FatCacheSize + DataCacheSize);
+  DiskCache[CacheData].CacheTag  = DiskCache[CacheFat].CacheTag + FatCacheGroupCount;
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Return the statistics of a disk cache of the volume.
+
+  @param  DiskCache             - The disk cache.
+  @param  Statistics            - Returns the statistics.
+
+**/
+STATIC
+VOID
+FatGetDiskCacheStatistics (
+  IN  DISK_CACHE                  *DiskCache,
+  OUT EDKII_FAT_CACHE_STATISTICS  *Statistics
+  )
+{
+  Statistics->PageSize         = (UINT32)1 << DiskCache->PageAlignment;
+  Statistics->PageCount        = (UINT32)(DiskCache->GroupMask + 1);
+  Statistics->HitCount         = DiskCache->HitCount;
+  Statistics->MissCount        = DiskCache->MissCount;
+  Statistics->PrefetchCount    = DiskCache->PrefetchCount;
+  Statistics->PrefetchHitCount = DiskCache->PrefetchHitCount;
+}
+
+/**
+
+  Implements GetCacheStatistics() of the FAT Diagnostics Protocol.
+
+  @param  This                  - The FAT Diagnostics Protocol of the volume.
+  @param  FatCache              - Returns the statistics of the FAT cache.
+  @param  DataCache             - Returns the statistics of the Data cache.
+
+  @retval EFI_SUCCESS           - The statistics are returned.
+  @retval EFI_INVALID_PARAMETER - FatCache or DataCache is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+FatGetCacheStatistics (
+  IN  EDKII_FAT_DIAGNOSTICS_PROTOCOL  *This,
+  OUT EDKII_FAT_CACHE_STATISTICS      *FatCache,
+  OUT EDKII_FAT_CACHE_STATISTICS      *DataCache
+  )
+{
+  FAT_VOLUME  *Volume;
+
+  if ((FatCache == NULL) || (DataCache == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Volume = VOLUME_FROM_DIAGNOSTICS (This);
+  FatAcquireLock ();
+  FatGetDiskCacheStatistics (&Volume->DiskCache[CacheFat], FatCache);
+  FatGetDiskCacheStatistics (&Volume->DiskCache[CacheData], DataCache);
+  FatReleaseLock ();
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Implements ResetCacheStatistics() of the FAT Diagnostics Protocol.
+
+  @param  This                  - The FAT Diagnostics Protocol of the volume.
+
+  @retval EFI_SUCCESS           - The counters are reset.
+
+**/
+EFI_STATUS
+EFIAPI
+FatResetCacheStatistics (
+  IN  EDKII_FAT_DIAGNOSTICS_PROTOCOL  *This
+  )
+{
+  FAT_VOLUME       *Volume;
+  CACHE_DATA_TYPE  CacheDataType;
+  DISK_CACHE       *DiskCache;
+
+  Volume = VOLUME_FROM_DIAGNOSTICS (This);
+  FatAcquireLock ();
+  for (CacheDataType = (CACHE_DATA_TYPE)0; CacheDataType < CacheMaxType; CacheDataType++) {
+    DiskCache                   = &Volume->DiskCache[CacheDataType];
+    DiskCache->HitCount         = 0;
+    DiskCache->MissCount        = 0;
+    DiskCache->PrefetchCount    = 0;
+    DiskCache->PrefetchHitCount = 0;
+  }
+
+  FatReleaseLock ();
   return EFI_SUCCESS;
 }
@@ -17,6 +17,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/BlockIo.h>
 #include <Protocol/DiskIo.h>
 #include <Protocol/DiskIo2.h>
+#include <Protocol/FatDiagnostics.h>
 #include <Protocol/SimpleFileSystem.h>
 #include <Protocol/UnicodeCollation.h>
 
@@ -53,6 +54,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define VOLUME_FROM_VOL_INTERFACE(a)  CR (a, FAT_VOLUME, VolumeInterface, FAT_VOLUME_SIGNATURE);
 
+#define VOLUME_FROM_DIAGNOSTICS(a)  CR (a, FAT_VOLUME, Diagnostics, FAT_VOLUME_SIGNATURE)
+
 #define ODIR_FROM_DIRCACHELINK(a)  CR (a, FAT_ODIR, DirCacheLink, FAT_ODIR_SIGNATURE)
 
 #define OFILE_FROM_CHECKLINK(a)  CR (a, FAT_OFILE, CheckLink, FAT_OFILE_SIGNATURE)
@@ -79,11 +82,25 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define FAT_FATCACHE_PAGE_MIN_ALIGNMENT   13
 #define FAT_FATCACHE_PAGE_MAX_ALIGNMENT   15
 #define FAT_DATACACHE_PAGE_MIN_ALIGNMENT  13
-#define FAT_DATACACHE_PAGE_MAX_ALIGNMENT  16
-#define FAT_DATACACHE_GROUP_COUNT         64
+#define FAT_DATACACHE_PAGE_MAX_ALIGNMENT  20
+#define FAT_DATACACHE_GROUP_MAX_COUNT     1024
 #define FAT_FATCACHE_GROUP_MIN_COUNT      1
 #define FAT_FATCACHE_GROUP_MAX_COUNT      16
 
+//
+// The free cluster bitmap is built from the FAT a segment of 4K bytes of
+// FAT entries at a time, when the segment is first searched
+//
+#define FAT_FREE_BITMAP_SEGMENT_SIZE     0x1000
+#define FAT_FREE_BITMAP_SEGMENT_INVALID  MAX_UINT32
+
+//
+// The maximum number of extents the cluster chain of an open file is
+// mapped with; the chain of a more fragmented file is partly followed
+// through the FAT
+//
+#define FAT_OFILE_EXTENT_MAX_COUNT  0x1000
+
 //
 // Used in 8.3 generation algorithm
 //
@@ -146,6 +163,7 @@ typedef struct {
   UINTN      PageNo;
   UINTN      RealSize;
   BOOLEAN    Dirty;
+  BOOLEAN    Prefetched;        // Read ahead, and not accessed since
 } CACHE_TAG;
 
 typedef struct {
@@ -155,9 +173,32 @@ typedef struct {
   BOOLEAN      Dirty;
   UINT8        PageAlignment;
   UINTN        GroupMask;
-  CACHE_TAG    CacheTag[FAT_DATACACHE_GROUP_COUNT];
+  CACHE_TAG    *CacheTag;
+  //
+  // Sequential prefetch, only done for the data cache
+  //
+  UINTN        PrefetchPageCount; // Pages read ahead of a sequential miss, 0 if disabled
+  UINTN        NextPageNo;        // The page a sequential access misses next
+  //
+  // Statistics reported through the FAT diagnostics protocol
+  //
+  UINT64       HitCount;
+  UINT64       MissCount;
+  UINT64       PrefetchCount;
+  UINT64       PrefetchHitCount;
 } DISK_CACHE;
 
+//
+// Free cluster bitmap
+//
+typedef struct {
+  UINT32    *SegmentFree;         // Free clusters in each segment, FAT_FREE_BITMAP_SEGMENT_INVALID if not built
+  UINTN     SegmentCount;
+  UINTN     SegmentClusters;      // Number of clusters in each segment
+  VOID      *FatBuffer;           // The FAT entries of the segment being built
+  UINT8     *Bitmap;              // A bit set for each free cluster
+} FAT_FREE_BITMAP;
+
 //
 // Hash table size
 //
@@ -228,6 +269,15 @@ typedef struct {
   LIST_ENTRY            Link;
 } FAT_SUBTASK;
 
+//
+// A run of consecutive clusters of an open file
+//
+typedef struct {
+  UINTN    Index;                 // Index of the first cluster of the extent in the file
+  UINTN    Cluster;               // First cluster of the extent on the volume
+  UINTN    Count;                 // Number of clusters of the extent
+} FAT_EXTENT;
+
 //
 // FAT_OFILE - Each opened file
 //
@@ -271,6 +321,17 @@ struct _FAT_OFILE {
   UINT64        PosDisk;        // on the disk
   UINTN         PosRem;         // remaining in this disk run
   //
+  // The cluster chain of the file, built when the file is first
+  // positioned. ExtentsComplete is set if the extents map the whole
+  // cluster chain, so that clusters appended to the file are appended
+  // to the extents too
+  //
+  FAT_EXTENT    *Extents;
+  UINTN         ExtentCount;
+  UINTN         ExtentMaxCount; // allocated entries of Extents
+  BOOLEAN       ExtentsBuilt;
+  BOOLEAN       ExtentsComplete;
+  //
   // The opened parent, full path length and currently opened child files
   //
   FAT_OFILE     *Parent;
@@ -302,6 +363,7 @@ struct _FAT_VOLUME {
   BOOLEAN                            DiskError;
 
   EFI_SIMPLE_FILE_SYSTEM_PROTOCOL    VolumeInterface;
+  EDKII_FAT_DIAGNOSTICS_PROTOCOL     Diagnostics;
 
   //
   // If opened, the parent handle and BlockIo interface
@@ -334,6 +396,7 @@ struct _FAT_VOLUME {
   FAT_INFO_SECTOR                    FatInfoSector;  // Free cluster info
   UINTN                              FreeInfoPos;    // Pos with the free cluster info
   BOOLEAN                            FreeInfoValid;  // If free cluster info is valid
+  FAT_FREE_BITMAP                    *FreeBitmap;    // NULL until clusters are allocated, and for FAT12
   //
   // Unpacked Fat BPB info
   //
@@ -768,6 +831,41 @@ FatVolumeFlushCache (
   IN FAT_TASK    *Task
   );
 
+/**
+
+  Implements GetCacheStatistics() of the FAT Diagnostics Protocol.
+
+  @param  This                  - The FAT Diagnostics Protocol of the volume.
+  @param  FatCache              - Returns the statistics of the FAT cache.
+  @param  DataCache             - Returns the statistics of the Data cache.
+
+  @retval EFI_SUCCESS           - The statistics are returned.
+  @retval EFI_INVALID_PARAMETER - FatCache or DataCache is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+FatGetCacheStatistics (
+  IN  EDKII_FAT_DIAGNOSTICS_PROTOCOL  *This,
+  OUT EDKII_FAT_CACHE_STATISTICS      *FatCache,
+  OUT EDKII_FAT_CACHE_STATISTICS      *DataCache
+  );
+
+/**
+
+  Implements ResetCacheStatistics() of the FAT Diagnostics Protocol.
+
+  @param  This                  - The FAT Diagnostics Protocol of the volume.
+
+  @retval EFI_SUCCESS           - The counters are reset.
+
+**/
+EFI_STATUS
+EFIAPI
+FatResetCacheStatistics (
+  IN  EDKII_FAT_DIAGNOSTICS_PROTOCOL  *This
+  );
+
 //
 // Flush.c
 //
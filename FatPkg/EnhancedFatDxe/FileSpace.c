@@ -122,6 +122,238 @@ FatGetFatEntry (
   return Accum;
 }
 
+/**
+
+  Get the free cluster bitmap of the volume, allocate it if it is not allocated.
+  The segments of the bitmap are built when they are first searched.
+
+  @param  Volume                - FAT file system volume.
+
+  @return The free cluster bitmap, or NULL if the FAT of the volume is searched
+          entry by entry.
+
+**/
+STATIC
+FAT_FREE_BITMAP *
+FatGetFreeBitmap (
+  IN FAT_VOLUME  *Volume
+  )
+{
+  FAT_FREE_BITMAP  *FreeBitmap;
+  UINTN            SegmentClusters;
+  UINTN            SegmentCount;
+
+  //
+  // The FAT12 entries are not byte aligned, and FAT12 volumes are small
+  //
+  if ((Volume->FreeBitmap != NULL) || (Volume->FatType == Fat12)) {
+    return Volume->FreeBitmap;
+  }
+
+  SegmentClusters = FAT_FREE_BITMAP_SEGMENT_SIZE / Volume->FatEntrySize;
+  SegmentCount    = (Volume->MaxCluster + 2 + SegmentClusters - 1) / SegmentClusters;
+  FreeBitmap      = AllocatePool (
+                      sizeof (FAT_FREE_BITMAP) +
+                      SegmentCount * sizeof (UINT32) +
+                      FAT_FREE_BITMAP_SEGMENT_SIZE +
+                      SegmentCount * SegmentClusters / 8
+                      );
+  if (FreeBitmap == NULL) {
+    return NULL;
+  }
+
+  FreeBitmap->SegmentCount    = SegmentCount;
+  FreeBitmap->SegmentClusters = SegmentClusters;
+  FreeBitmap->SegmentFree     = (UINT32 *)(FreeBitmap + 1);
+  FreeBitmap->FatBuffer       = FreeBitmap->SegmentFree + SegmentCount;
+  FreeBitmap->Bitmap          = (UINT8 *)FreeBitmap->FatBuffer + FAT_FREE_BITMAP_SEGMENT_SIZE;
+  SetMem32 (FreeBitmap->SegmentFree, SegmentCount * sizeof (UINT32), FAT_FREE_BITMAP_SEGMENT_INVALID);
+
+  Volume->FreeBitmap = FreeBitmap;
+  return FreeBitmap;
+}
+
+/**
+
+  Build a segment of the free cluster bitmap from the FAT entries in the FAT cache.
+
+  @param  Volume                - FAT file system volume.
+  @param  FreeBitmap            - The free cluster bitmap of the volume.
+  @param  Segment               - The index of the segment.
+
+  @retval EFI_SUCCESS           - The segment is built.
+  @return other                 - An error occurred when reading the FAT entries.
+
+**/
+STATIC
+EFI_STATUS
+FatBuildFreeBitmapSegment (
+  IN FAT_VOLUME       *Volume,
+  IN FAT_FREE_BITMAP  *FreeBitmap,
+  IN UINTN            Segment
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       FirstCluster;
+  UINTN       Count;
+  UINTN       Index;
+  UINTN       Cluster;
+  UINTN       Entry;
+  UINT32      Free;
+
+  FirstCluster = Segment * FreeBitmap->SegmentClusters;
+  Count        = MIN (FreeBitmap->SegmentClusters, Volume->MaxCluster + 2 - FirstCluster);
+
+  //
+  // A segment is smaller than a FAT cache page, and never crosses pages
+  //
+  Status = FatDiskIo (
+             Volume,
+             ReadFat,
+             Volume->FatPos + FirstCluster * Volume->FatEntrySize,
+             Count * Volume->FatEntrySize,
+             FreeBitmap->FatBuffer,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  ZeroMem (FreeBitmap->Bitmap + FirstCluster / 8, FreeBitmap->SegmentClusters / 8);
+  Free = 0;
+  for (Index = 0; Index < Count; Index++) {
+    if (Volume->FatType == Fat16) {
+      Entry = ((UINT16 *)FreeBitmap->FatBuffer)[Index];
+    } else {
+      Entry = ((UINT32 *)FreeBitmap->FatBuffer)[Index] & FAT_CLUSTER_MASK_FAT32;
+    }
+
+    Cluster = FirstCluster + Index;
+    if ((Entry == FAT_CLUSTER_FREE) && (Cluster >= FAT_MIN_CLUSTER)) {
+      FreeBitmap->Bitmap[Cluster / 8] |= (UINT8)(1 << (Cluster % 8));
+      Free++;
+    }
+  }
+
+  FreeBitmap->SegmentFree[Segment] = Free;
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Find the first free cluster from Cluster to the end of the FAT, and the
+  free clusters that follow it.
+
+  @param  Volume                - FAT file system volume.
+  @param  FreeBitmap            - The free cluster bitmap of the volume.
+  @param  Cluster               - The cluster to start the search from.
+  @param  MaxCount              - The maximum number of clusters of the run.
+  @param  RunStart              - Return the first free cluster.
+  @param  RunCount              - Return the number of consecutive free clusters
+                                  from RunStart, 0 if there is no free cluster.
+
+  @retval EFI_SUCCESS           - The search completed.
+  @return other                 - An error occurred when reading the FAT entries.
+
+**/
+STATIC
+EFI_STATUS
+FatFindFreeClusters (
+  IN  FAT_VOLUME       *Volume,
+  IN  FAT_FREE_BITMAP  *FreeBitmap,
+  IN  UINTN            Cluster,
+  IN  UINTN            MaxCount,
+  OUT UINTN            *RunStart,
+  OUT UINTN            *RunCount
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Segment;
+
+  *RunStart = Cluster;
+  *RunCount = 0;
+  while ((Cluster <= Volume->MaxCluster + 1) && (*RunCount < MaxCount)) {
+    Segment = Cluster / FreeBitmap->SegmentClusters;
+    if (FreeBitmap->SegmentFree[Segment] == FAT_FREE_BITMAP_SEGMENT_INVALID) {
+      Status = FatBuildFreeBitmapSegment (Volume, FreeBitmap, Segment);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    if (*RunCount == 0) {
+      //
+      // Skip the full segments and bytes of the bitmap
+      //
+      if (FreeBitmap->SegmentFree[Segment] == 0) {
+        Cluster = (Segment + 1) * FreeBitmap->SegmentClusters;
+        continue;
+      }
+
+      if (((Cluster % 8) == 0) && (FreeBitmap->Bitmap[Cluster / 8] == 0)) {
+        Cluster += 8;
+        continue;
+      }
+    }
+
+    if ((FreeBitmap->Bitmap[Cluster / 8] & (1 << (Cluster % 8))) != 0) {
+      if (*RunCount == 0) {
+        *RunStart = Cluster;
+      }
+
+      *RunCount += 1;
+    } else if (*RunCount != 0) {
+      break;
+    }
+
+    Cluster++;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Update the free cluster bitmap when a cluster is allocated or freed.
+
+  @param  Volume                - FAT file system volume.
+  @param  Cluster               - The cluster.
+  @param  Free                  - TRUE if the cluster is freed, FALSE if it is allocated.
+
+**/
+STATIC
+VOID
+FatUpdateFreeBitmap (
+  IN FAT_VOLUME  *Volume,
+  IN UINTN       Cluster,
+  IN BOOLEAN     Free
+  )
+{
+  FAT_FREE_BITMAP  *FreeBitmap;
+  UINTN            Segment;
+
+  FreeBitmap = Volume->FreeBitmap;
+  if ((FreeBitmap == NULL) || (Cluster > Volume->MaxCluster + 1)) {
+    return;
+  }
+
+  //
+  // A segment that is not built yet is read from the FAT when it is searched
+  //
+  Segment = Cluster / FreeBitmap->SegmentClusters;
+  if (FreeBitmap->SegmentFree[Segment] == FAT_FREE_BITMAP_SEGMENT_INVALID) {
+    return;
+  }
+
+  if (Free) {
+    FreeBitmap->Bitmap[Cluster / 8] |= (UINT8)(1 << (Cluster % 8));
+    FreeBitmap->SegmentFree[Segment]++;
+  } else {
+    FreeBitmap->Bitmap[Cluster / 8] &= (UINT8) ~(1 << (Cluster % 8));
+    FreeBitmap->SegmentFree[Segment]--;
+  }
+}
+
 /**
 
   Set the FAT entry value of the volume, which is identified with the Index.
@@ -161,10 +393,14 @@ FatSetFatEntry (
     if (Index < Volume->FatInfoSector.FreeInfo.NextCluster) {
       Volume->FatInfoSector.FreeInfo.NextCluster = (UINT32)Index;
     }
+
+    FatUpdateFreeBitmap (Volume, Index, TRUE);
   } else if ((Value != FAT_CLUSTER_FREE) && (OriginalVal == FAT_CLUSTER_FREE)) {
     if (Volume->FatInfoSector.FreeInfo.ClusterCount != 0) {
       Volume->FatInfoSector.FreeInfo.ClusterCount -= 1;
     }
+
+    FatUpdateFreeBitmap (Volume, Index, FALSE);
   }
 
   //
@@ -314,6 +550,65 @@ FatAllocateCluster (
   return Cluster;
 }
 
+/**
+
+  Allocate a run of consecutive free clusters, so that files are allocated
+  in extents. The run is the first free clusters from FreeInfo.NextCluster on;
+  it may be shorter than requested.
+
+  @param  Volume                - FAT file system volume.
+  @param  MaxCount              - The number of clusters requested.
+  @param  Count                 - Return the number of clusters of the run.
+
+  @return The index of the first cluster of the run, or FAT_CLUSTER_LAST if
+          there is no free cluster.
+
+**/
+STATIC
+UINTN
+FatAllocateClusterRun (
+  IN  FAT_VOLUME  *Volume,
+  IN  UINTN       MaxCount,
+  OUT UINTN       *Count
+  )
+{
+  EFI_STATUS       Status;
+  FAT_FREE_BITMAP  *FreeBitmap;
+  UINTN            Cluster;
+
+  *Count = 1;
+  if (FeaturePcdGet (PcdFatScanClusterAllocator)) {
+    return FatAllocateCluster (Volume);
+  }
+
+  FreeBitmap = FatGetFreeBitmap (Volume);
+  if ((FreeBitmap == NULL) || Volume->DiskError) {
+    return FatAllocateCluster (Volume);
+  }
+
+  Status = FatFindFreeClusters (
+             Volume,
+             FreeBitmap,
+             Volume->FatInfoSector.FreeInfo.NextCluster,
+             MaxCount,
+             &Cluster,
+             Count
+             );
+  if (!EFI_ERROR (Status) && (*Count == 0)) {
+    //
+    // Search again from the start of the FAT
+    //
+    Status = FatFindFreeClusters (Volume, FreeBitmap, FAT_MIN_CLUSTER, MaxCount, &Cluster, Count);
+  }
+
+  if (EFI_ERROR (Status) || (*Count == 0)) {
+    return (UINTN)FAT_CLUSTER_LAST;
+  }
+
+  Volume->FatInfoSector.FreeInfo.NextCluster = (UINT32)(Cluster + *Count);
+  return Cluster;
+}
+
 /**
 
   Count the number of clusters given a size.
@@ -341,6 +636,200 @@ FatSizeToClusters (
   return Clusters;
 }
 
+/**
+
+  Append consecutive clusters to the extents of the open file, if the
+  extents map the whole cluster chain of the file.
+
+  @param  OFile                 - The open file.
+  @param  Index                 - The index of the first cluster in the file.
+  @param  Cluster               - The first cluster.
+  @param  Count                 - The number of clusters.
+
+  @retval TRUE                  - The clusters are appended.
+  @retval FALSE                 - The extents do not map the whole cluster chain
+                                  of the file any more.
+
+**/
+STATIC
+BOOLEAN
+FatAppendExtent (
+  IN FAT_OFILE  *OFile,
+  IN UINTN      Index,
+  IN UINTN      Cluster,
+  IN UINTN      Count
+  )
+{
+  FAT_EXTENT  *Extent;
+  FAT_EXTENT  *Extents;
+  UINTN       MaxCount;
+
+  if (!OFile->ExtentsComplete) {
+    return FALSE;
+  }
+
+  if (OFile->ExtentCount != 0) {
+    Extent = &OFile->Extents[OFile->ExtentCount - 1];
+    if ((Extent->Index + Extent->Count == Index) && (Extent->Cluster + Extent->Count == Cluster)) {
+      Extent->Count += Count;
+      return TRUE;
+    }
+  }
+
+  if (OFile->ExtentCount == OFile->ExtentMaxCount) {
+    MaxCount = MAX (OFile->ExtentMaxCount * 2, 8);
+    Extents  = NULL;
+    if (MaxCount <= FAT_OFILE_EXTENT_MAX_COUNT) {
+      Extents = ReallocatePool (
+                  OFile->ExtentMaxCount * sizeof (FAT_EXTENT),
+                  MaxCount * sizeof (FAT_EXTENT),
+                  OFile->Extents
+                  );
+    }
+
+    if (Extents == NULL) {
+      //
+      // The rest of the cluster chain is followed through the FAT
+      //
+      OFile->ExtentsComplete = FALSE;
+      return FALSE;
+    }
+
+    OFile->Extents        = Extents;
+    OFile->ExtentMaxCount = MaxCount;
+  }
+
+  Extent          = &OFile->Extents[OFile->ExtentCount];
+  Extent->Index   = Index;
+  Extent->Cluster = Cluster;
+  Extent->Count   = Count;
+  OFile->ExtentCount++;
+  return TRUE;
+}
+
+/**
+
+  Remove the clusters from Count on from the extents of the open file.
+
+  @param  OFile                 - The open file.
+  @param  Count                 - The number of clusters the file keeps.
+
+**/
+STATIC
+VOID
+FatTruncateExtents (
+  IN FAT_OFILE  *OFile,
+  IN UINTN      Count
+  )
+{
+  FAT_EXTENT  *Extent;
+
+  while (OFile->ExtentCount != 0) {
+    Extent = &OFile->Extents[OFile->ExtentCount - 1];
+    if (Extent->Index < Count) {
+      Extent->Count = MIN (Extent->Count, Count - Extent->Index);
+      break;
+    }
+
+    OFile->ExtentCount--;
+  }
+}
+
+/**
+
+  Map the cluster chain of the open file to extents, by following the chain
+  through the FAT once. A corrupt chain is only mapped up to the corruption,
+  which is reported when the rest of the chain is followed.
+
+  @param  OFile                 - The open file.
+
+**/
+STATIC
+VOID
+FatBuildExtents (
+  IN FAT_OFILE  *OFile
+  )
+{
+  FAT_VOLUME  *Volume;
+  UINTN       Cluster;
+  UINTN       Count;
+  UINTN       Index;
+
+  Volume                 = OFile->Volume;
+  OFile->ExtentsBuilt    = TRUE;
+  OFile->ExtentsComplete = TRUE;
+  OFile->ExtentCount     = 0;
+
+  //
+  // Following no more clusters than the file size needs also stops
+  // a circular chain
+  //
+  Count   = FatSizeToClusters (Volume, OFile->FileSize);
+  Cluster = OFile->FileCluster;
+  for (Index = 0; Index < Count; Index++) {
+    if ((Cluster < FAT_MIN_CLUSTER) || (Cluster > Volume->MaxCluster + 1)) {
+      OFile->ExtentsComplete = FALSE;
+      return;
+    }
+
+    if (!FatAppendExtent (OFile, Index, Cluster, 1)) {
+      return;
+    }
+
+    Cluster = FatGetFatEntry (Volume, Cluster);
+    if (Volume->DiskError) {
+      OFile->ExtentsComplete = FALSE;
+      return;
+    }
+  }
+
+  //
+  // The extents map the whole chain if it ends at the file size
+  //
+  if ((Count == 0) ? (Cluster != FAT_CLUSTER_FREE) : !FAT_END_OF_FAT_CHAIN (Cluster)) {
+    OFile->ExtentsComplete = FALSE;
+  }
+}
+
+/**
+
+  Find the extent of the open file which contains the cluster.
+
+  @param  OFile                 - The open file.
+  @param  Index                 - The index of the cluster in the file.
+
+  @return The extent, or NULL if the cluster is not mapped by the extents.
+
+**/
+STATIC
+FAT_EXTENT *
+FatFindExtent (
+  IN FAT_OFILE  *OFile,
+  IN UINTN      Index
+  )
+{
+  FAT_EXTENT  *Extent;
+  UINTN       Low;
+  UINTN       High;
+  UINTN       Middle;
+
+  Low  = 0;
+  High = OFile->ExtentCount;
+  while (Low < High) {
+    Middle = (Low + High) / 2;
+    Extent = &OFile->Extents[Middle];
+    if (Index < Extent->Index) {
+      High = Middle;
+    } else if (Index >= Extent->Index + Extent->Count) {
+      Low = Middle + 1;
+    } else {
+      return Extent;
+    }
+  }
+
+  return NULL;
+}
+
 /**
 
   Shrink the end of the open file base on the file size.
@@ -385,6 +874,7 @@ FatShrinkEof (
     }
 
     FatSetFatEntry (Volume, LastCluster, (UINTN)FAT_CLUSTER_LAST);
+    FatTruncateExtents (OFile, NewSize);
   } else {
     //
     // Check to see if the file is already completely truncated
@@ -397,6 +887,7 @@ FatShrinkEof (
     // The file is being completely truncated.
     //
     OFile->FileCluster = FAT_CLUSTER_FREE;
+    FatTruncateExtents (OFile, 0);
   }
 
   //
@@ -439,6 +930,7 @@ FatGrowEof (
   UINTN       LastCluster;
   UINTN       NewCluster;
   UINTN       ClusterCount;
+  UINTN       RunCount;
 
   //
   // For FAT file system, the max file is 4GB.
@@ -494,7 +986,7 @@ FatGrowEof (
     LastCluster = OFile->FileLastCluster;
 
     while (CurSize < NewSize) {
-      NewCluster = FatAllocateCluster (Volume);
+      NewCluster = FatAllocateClusterRun (Volume, NewSize - CurSize, &RunCount);
       if (FAT_END_OF_FAT_CHAIN (NewCluster)) {
         if (LastCluster != FAT_CLUSTER_FREE) {
           FatSetFatEntry (Volume, LastCluster, (UINTN)FAT_CLUSTER_LAST);
@@ -505,7 +997,7 @@ FatGrowEof (
         goto Done;
       }
 
-      if ((NewCluster < FAT_MIN_CLUSTER) || (NewCluster > Volume->MaxCluster + 1)) {
+      if ((NewCluster < FAT_MIN_CLUSTER) || (NewCluster + RunCount - 1 > Volume->MaxCluster + 1)) {
         Status = EFI_VOLUME_CORRUPTED;
         goto Done;
       }
@@ -517,15 +1009,26 @@ FatGrowEof (
         OFile->FileCurrentCluster = NewCluster;
       }
 
+      FatAppendExtent (OFile, CurSize, NewCluster, RunCount);
+
+      //
+      // Chain the clusters of the run
+      //
+      for ( ; RunCount > 1; RunCount--) {
+        FatSetFatEntry (Volume, NewCluster, NewCluster + 1);
+        NewCluster += 1;
+        CurSize    += 1;
+      }
+
       LastCluster = NewCluster;
       CurSize    += 1;
 
       //
       // Terminate the cluster list
       //
-      // Note that we must do this EVERY time we allocate a cluster, because
-      // FatAllocateCluster scans the FAT looking for a free cluster and
-      // "LastCluster" is no longer free!  Usually, FatAllocateCluster will
+      // Note that we must do this EVERY time we allocate a run, because
+      // FatAllocateClusterRun scans the FAT looking for free clusters and
+      // "LastCluster" is no longer free!  Usually, FatAllocateClusterRun will
       // start looking with the cluster after "LastCluster"; however, when
       // there is only one free cluster left, it will find "LastCluster"
       // a second time.  There are other, less predictable scenarios
@@ -566,8 +1069,10 @@ FatOFilePosition (
   )
 {
   FAT_VOLUME  *Volume;
+  FAT_EXTENT  *Extent;
   UINTN       ClusterSize;
   UINTN       Cluster;
+  UINTN       Index;
   UINTN       StartPos;
   UINTN       Run;
 
@@ -584,6 +1089,31 @@ FatOFilePosition (
     OFile->PosDisk = Volume->RootPos + Position;
     Run            = OFile->FileSize - Position;
   } else {
+    //
+    // Look the position up in the extents of the file
+    //
+    if (!OFile->ExtentsBuilt) {
+      FatBuildExtents (OFile);
+    }
+
+    Index  = Position >> Volume->ClusterAlignment;
+    Extent = FatFindExtent (OFile, Index);
+    if (Extent != NULL) {
+      Cluster        = Extent->Cluster + Index - Extent->Index;
+      StartPos       = Index << Volume->ClusterAlignment;
+      OFile->PosDisk = Volume->FirstClusterPos +
+                       LShiftU64 (Cluster - FAT_MIN_CLUSTER, Volume->ClusterAlignment) +
+                       Position - StartPos;
+      OFile->FileCurrentCluster = Cluster;
+      OFile->Position           = StartPos;
+
+      //
+      // The rest of the extent is consecutive on the disk
+      //
+      OFile->PosRem = (UINTN)MIN (LShiftU64 (Extent->Index + Extent->Count, Volume->ClusterAlignment) - Position, PosLimit);
+      return EFI_SUCCESS;
+    }
+
     //
     // Run the file's cluster chain to find the current position
     // If possible, run from the current cluster rather than
@@ -721,7 +1251,9 @@ FatComputeFreeInfo (
   IN FAT_VOLUME  *Volume
   )
 {
-  UINTN  Index;
+  FAT_FREE_BITMAP  *FreeBitmap;
+  UINTN            Index;
+  UINTN            Count;
 
   //
   // If we don't have valid info, compute it now
@@ -729,14 +1261,39 @@ FatComputeFreeInfo (
   if (!Volume->FreeInfoValid) {
     Volume->FreeInfoValid                       = TRUE;
     Volume->FatInfoSector.FreeInfo.ClusterCount = 0;
-    for (Index = Volume->MaxCluster + 1; Index >= FAT_MIN_CLUSTER; Index--) {
-      if (Volume->DiskError) {
-        break;
+    FreeBitmap                                  = Volume->FreeBitmap;
+    if (FreeBitmap != NULL) {
+      //
+      // Count the free clusters of each segment of the free cluster bitmap.
+      // The bitmap is allocated when clusters are first allocated, so that
+      // getting the free space of a volume does not allocate it.
+      //
+      for (Index = 0; Index < FreeBitmap->SegmentCount; Index++) {
+        if ((FreeBitmap->SegmentFree[Index] == FAT_FREE_BITMAP_SEGMENT_INVALID) &&
+            EFI_ERROR (FatBuildFreeBitmapSegment (Volume, FreeBitmap, Index)))
+        {
+          break;
+        }
+
+        Volume->FatInfoSector.FreeInfo.ClusterCount += FreeBitmap->SegmentFree[Index];
       }
 
-      if (FatGetFatEntry (Volume, Index) == FAT_CLUSTER_FREE) {
-        Volume->FatInfoSector.FreeInfo.ClusterCount += 1;
-        Volume->FatInfoSector.FreeInfo.NextCluster   = (UINT32)Index;
+      if (!Volume->DiskError &&
+          !EFI_ERROR (FatFindFreeClusters (Volume, FreeBitmap, FAT_MIN_CLUSTER, 1, &Index, &Count)) &&
+          (Count != 0))
+      {
+        Volume->FatInfoSector.FreeInfo.NextCluster = (UINT32)Index;
+      }
+    } else {
+      for (Index = Volume->MaxCluster + 1; Index >= FAT_MIN_CLUSTER; Index--) {
+        if (Volume->DiskError) {
+          break;
+        }
+
+        if (FatGetFatEntry (Volume, Index) == FAT_CLUSTER_FREE) {
+          Volume->FatInfoSector.FreeInfo.ClusterCount += 1;
+          Volume->FatInfoSector.FreeInfo.NextCluster   = (UINT32)Index;
+        }
       }
     }
 
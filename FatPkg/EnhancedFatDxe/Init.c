@@ -45,15 +45,18 @@ FatAllocateVolume (
   //
   // Initialize the structure
   //
-  Volume->Signature                  = FAT_VOLUME_SIGNATURE;
-  Volume->Handle                     = Handle;
-  Volume->DiskIo                     = DiskIo;
-  Volume->DiskIo2                    = DiskIo2;
-  Volume->BlockIo                    = BlockIo;
-  Volume->MediaId                    = BlockIo->Media->MediaId;
-  Volume->ReadOnly                   = BlockIo->Media->ReadOnly;
-  Volume->VolumeInterface.Revision   = EFI_SIMPLE_FILE_SYSTEM_PROTOCOL_REVISION;
-  Volume->VolumeInterface.OpenVolume = FatOpenVolume;
+  Volume->Signature                        = FAT_VOLUME_SIGNATURE;
+  Volume->Handle                           = Handle;
+  Volume->DiskIo                           = DiskIo;
+  Volume->DiskIo2                          = DiskIo2;
+  Volume->BlockIo                          = BlockIo;
+  Volume->MediaId                          = BlockIo->Media->MediaId;
+  Volume->ReadOnly                         = BlockIo->Media->ReadOnly;
+  Volume->VolumeInterface.Revision         = EFI_SIMPLE_FILE_SYSTEM_PROTOCOL_REVISION;
+  Volume->VolumeInterface.OpenVolume       = FatOpenVolume;
+  Volume->Diagnostics.Revision             = EDKII_FAT_DIAGNOSTICS_PROTOCOL_REVISION;
+  Volume->Diagnostics.GetCacheStatistics   = FatGetCacheStatistics;
+  Volume->Diagnostics.ResetCacheStatistics = FatResetCacheStatistics;
   InitializeListHead (&Volume->CheckRef);
   InitializeListHead (&Volume->DirCacheList);
   //
@@ -84,6 +87,8 @@ FatAllocateVolume (
                   &Volume->Handle,
                   &gEfiSimpleFileSystemProtocolGuid,
                   &Volume->VolumeInterface,
+                  &gEdkiiFatDiagnosticsProtocolGuid,
+                  &Volume->Diagnostics,
                   NULL
                   );
   if (EFI_ERROR (Status)) {
@@ -130,6 +135,8 @@ FatAbandonVolume (
                     Volume->Handle,
                     &gEfiSimpleFileSystemProtocolGuid,
                     &Volume->VolumeInterface,
+                    &gEdkiiFatDiagnosticsProtocolGuid,
+                    &Volume->Diagnostics,
                     NULL
                     );
     if (EFI_ERROR (Status)) {
@@ -0,0 +1,641 @@
+/** @file
+  Host based unit tests of the data cache of the FAT driver.
+
+  The data cache runs on a memory volume filled with random data. Its geometry
+  must follow the platform PCDs, a sequential read must be read ahead in
+  requests of several pages, random reads must not be, and the read-ahead must
+  stop before the cache pages it must not replace. Random reads and writes
+  must see the data of a model of the volume, and the volume must match the
+  model after a flush. The counters of the FAT Diagnostics Protocol must
+  account for every access.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "FatTestVolume.h"
+
+#include <Library/UnitTestLib.h>
+#include <Library/UnitTestRandomLib.h>
+
+#define UNIT_TEST_APP_NAME     "FAT Data Cache Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_CLUSTER_ALIGNMENT  9
+#define TEST_CLUSTER_COUNT      0x1000
+#define TEST_RANDOM_ACTIONS     4000
+#define TEST_MAX_ACCESS_PAGES   3
+
+typedef struct {
+  FAT_TEST_VOLUME    *TestVolume;
+  UINT8              *Model;
+  UINT8              *Buffer;
+  UINTN              PageSize;
+  UINT64             DataPos;
+  UINTN              PageCount;
+  UINT64             Seed;
+} TEST_CONTEXT;
+
+STATIC TEST_CONTEXT  mTestContext;
+
+/**
+  Create the memory volume, fill its data area with random data, and copy it
+  to the model.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED                      The volume is created.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  There is not enough memory.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+CreateVolume (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  FAT_VOLUME    *Volume;
+  EFI_STATUS    Status;
+  UINTN         Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Status      = FatTestCreateVolume (Fat32, TEST_CLUSTER_ALIGNMENT, TEST_CLUSTER_COUNT, &TestContext->TestVolume);
+  if (EFI_ERROR (Status)) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  Volume                 = &TestContext->TestVolume->Volume;
+  TestContext->PageSize  = (UINTN)1 << Volume->DiskCache[CacheData].PageAlignment;
+  TestContext->DataPos   = Volume->DiskCache[CacheData].BaseAddress;
+  TestContext->PageCount = (UINTN)(Volume->VolumeSize - TestContext->DataPos) / TestContext->PageSize;
+  TestContext->Model     = AllocatePool ((UINTN)Volume->VolumeSize);
+  TestContext->Buffer    = AllocatePool (TEST_MAX_ACCESS_PAGES * TestContext->PageSize);
+  if ((TestContext->Model == NULL) || (TestContext->Buffer == NULL)) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  TestContext->Seed = 0xD1B54A32D192ED03ULL;
+  for (Index = (UINTN)TestContext->DataPos; Index < Volume->VolumeSize; Index++) {
+    TestContext->TestVolume->Disk[Index] = (UINT8)UnitTestRandom (&TestContext->Seed);
+  }
+
+  CopyMem (TestContext->Model, TestContext->TestVolume->Disk, (UINTN)Volume->VolumeSize);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the memory volume and the model.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+**/
+STATIC
+VOID
+EFIAPI
+FreeVolume (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  if (TestContext->TestVolume != NULL) {
+    FatTestFreeVolume (TestContext->TestVolume);
+  }
+
+  if (TestContext->Model != NULL) {
+    FreePool (TestContext->Model);
+  }
+
+  if (TestContext->Buffer != NULL) {
+    FreePool (TestContext->Buffer);
+  }
+
+  TestContext->TestVolume = NULL;
+  TestContext->Model      = NULL;
+  TestContext->Buffer     = NULL;
+}
+
+/**
+  Read through the data cache, and check the data against the model.
+
+  @param[in]  TestContext  The test context.
+  @param[in]  Offset       The disk position to read from.
+  @param[in]  Size         The number of bytes to read.
+
+  @retval TRUE   The data matches the model.
+  @retval FALSE  The read failed, or the data does not match the model.
+**/
+STATIC
+BOOLEAN
+ReadMatchesModel (
+  IN TEST_CONTEXT  *TestContext,
+  IN UINT64        Offset,
+  IN UINTN         Size
+  )
+{
+  ASSERT (Size <= TEST_MAX_ACCESS_PAGES * TestContext->PageSize);
+
+  if (EFI_ERROR (FatDiskIo (&TestContext->TestVolume->Volume, ReadData, Offset, Size, TestContext->Buffer, NULL))) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(CompareMem (TestContext->Buffer, TestContext->Model + Offset, Size) == 0);
+}
+
+/**
+  Write random data through the data cache, and to the model.
+
+  @param[in]  TestContext  The test context.
+  @param[in]  Offset       The disk position to write to.
+  @param[in]  Size         The number of bytes to write.
+
+  @return The status of the data cache.
+**/
+STATIC
+EFI_STATUS
+WriteRandomData (
+  IN TEST_CONTEXT  *TestContext,
+  IN UINT64        Offset,
+  IN UINTN         Size
+  )
+{
+  UINTN  Index;
+
+  ASSERT (Size <= TEST_MAX_ACCESS_PAGES * TestContext->PageSize);
+
+  for (Index = 0; Index < Size; Index++) {
+    TestContext->Buffer[Index] = (UINT8)UnitTestRandom (&TestContext->Seed);
+  }
+
+  CopyMem (TestContext->Model + Offset, TestContext->Buffer, Size);
+  return FatDiskIo (&TestContext->TestVolume->Volume, WriteData, Offset, Size, TestContext->Buffer, NULL);
+}
+
+/**
+  Return the disk position of a page of the data cache.
+
+  @param[in]  TestContext  The test context.
+  @param[in]  PageNo       The page.
+
+  @return The disk position of the page.
+**/
+STATIC
+UINT64
+PagePos (
+  IN TEST_CONTEXT  *TestContext,
+  IN UINTN         PageNo
+  )
+{
+  return TestContext->DataPos + (UINT64)PageNo * TestContext->PageSize;
+}
+
+/**
+  Get the statistics of the data cache through the FAT Diagnostics Protocol.
+
+  @param[in]  TestContext  The test context.
+  @param[out] DataCache    Returns the statistics of the data cache.
+
+  @return The status of the protocol.
+**/
+STATIC
+EFI_STATUS
+GetDataCacheStatistics (
+  IN  TEST_CONTEXT                *TestContext,
+  OUT EDKII_FAT_CACHE_STATISTICS  *DataCache
+  )
+{
+  EDKII_FAT_DIAGNOSTICS_PROTOCOL  *Diagnostics;
+  EDKII_FAT_CACHE_STATISTICS      FatCache;
+
+  Diagnostics = &TestContext->TestVolume->Volume.Diagnostics;
+  return Diagnostics->GetCacheStatistics (Diagnostics, &FatCache, DataCache);
+}
+
+/**
+  The geometry of the data cache follows the PCDs, and the FAT Diagnostics
+  Protocol reports the geometry of both caches.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+GeometryFollowsPcds (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                    *TestContext;
+  DISK_CACHE                      *DiskCache;
+  EDKII_FAT_DIAGNOSTICS_PROTOCOL  *Diagnostics;
+  EDKII_FAT_CACHE_STATISTICS      FatCache;
+  EDKII_FAT_CACHE_STATISTICS      DataCache;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  DiskCache   = &TestContext->TestVolume->Volume.DiskCache[CacheData];
+  Diagnostics = &TestContext->TestVolume->Volume.Diagnostics;
+
+  UT_ASSERT_EQUAL (DiskCache->PageAlignment, PcdGet8 (PcdFatDataCachePageAlignment));
+  UT_ASSERT_EQUAL (DiskCache->GroupMask + 1, PcdGet32 (PcdFatDataCachePageCount));
+  UT_ASSERT_EQUAL (DiskCache->PrefetchPageCount, MIN (PcdGet32 (PcdFatDataCachePrefetchPageCount), PcdGet32 (PcdFatDataCachePageCount) / 2));
+
+  UT_ASSERT_NOT_EFI_ERROR (Diagnostics->GetCacheStatistics (Diagnostics, &FatCache, &DataCache));
+  UT_ASSERT_EQUAL (FatCache.PageSize, (UINT32)1 << FAT_FATCACHE_PAGE_MAX_ALIGNMENT);
+  UT_ASSERT_EQUAL (FatCache.PageCount, FAT_FATCACHE_GROUP_MAX_COUNT);
+  UT_ASSERT_EQUAL (DataCache.PageSize, TestContext->PageSize);
+  UT_ASSERT_EQUAL (DataCache.PageCount, PcdGet32 (PcdFatDataCachePageCount));
+
+  UT_ASSERT_STATUS_EQUAL (Diagnostics->GetCacheStatistics (Diagnostics, NULL, &DataCache), EFI_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (Diagnostics->GetCacheStatistics (Diagnostics, &FatCache, NULL), EFI_INVALID_PARAMETER);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A sequential read, in accesses of parts of pages, reads the second page and
+  the pages after it ahead in one request, up to the end of the cache, and
+  goes on reading ahead without reading a page twice. Every page read ahead
+  is accessed and counted.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SequentialReadIsReadAhead (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                *TestContext;
+  FAT_TEST_VOLUME             *TestVolume;
+  EDKII_FAT_CACHE_STATISTICS  DataCache;
+  UINTN                       PrefetchPageCount;
+  UINTN                       GroupCount;
+  UINTN                       AccessSize;
+  UINTN                       ScanPages;
+  UINTN                       ReadPages;
+  UINT64                      Offset;
+  UINTN                       Index;
+
+  TestContext       = (TEST_CONTEXT *)Context;
+  TestVolume        = TestContext->TestVolume;
+  PrefetchPageCount = TestVolume->Volume.DiskCache[CacheData].PrefetchPageCount;
+  GroupCount        = TestVolume->Volume.DiskCache[CacheData].GroupMask + 1;
+  AccessSize        = TestContext->PageSize / 4;
+  ScanPages         = 3 * GroupCount;
+  UT_ASSERT_NOT_EQUAL (PrefetchPageCount, 0);
+  UT_ASSERT_TRUE (ScanPages <= TestContext->PageCount);
+
+  for (Offset = PagePos (TestContext, 0); Offset < PagePos (TestContext, ScanPages); Offset += AccessSize) {
+    UT_ASSERT_TRUE (ReadMatchesModel (TestContext, Offset, AccessSize));
+  }
+
+  //
+  // The first page is read alone, the second starts a sequential read
+  //
+  UT_ASSERT_TRUE (TestVolume->ReadCount <= FAT_TEST_MAX_REQUESTS);
+  UT_ASSERT_TRUE (TestVolume->ReadCount < ScanPages / 2);
+  UT_ASSERT_EQUAL (TestVolume->Reads[0].Offset, PagePos (TestContext, 0));
+  UT_ASSERT_EQUAL (TestVolume->Reads[0].Size, TestContext->PageSize);
+
+  ReadPages = 1;
+  for (Index = 1; Index < TestVolume->ReadCount; Index++) {
+    UT_ASSERT_EQUAL (TestVolume->Reads[Index].Offset, PagePos (TestContext, ReadPages));
+    UT_ASSERT_EQUAL (
+      TestVolume->Reads[Index].Size,
+      MIN (PrefetchPageCount + 1, GroupCount - ReadPages % GroupCount) * TestContext->PageSize
+      );
+    ReadPages += TestVolume->Reads[Index].Size / TestContext->PageSize;
+  }
+
+  UT_ASSERT_TRUE (ReadPages >= ScanPages);
+  UT_ASSERT_TRUE (ReadPages <= ScanPages + PrefetchPageCount);
+
+  //
+  // Each page access is a hit or a miss, and each miss reads the page and
+  // the pages ahead of it
+  //
+  UT_ASSERT_NOT_EFI_ERROR (GetDataCacheStatistics (TestContext, &DataCache));
+  UT_ASSERT_EQUAL (DataCache.MissCount, TestVolume->ReadCount);
+  UT_ASSERT_EQUAL (DataCache.HitCount + DataCache.MissCount, ScanPages * (TestContext->PageSize / AccessSize));
+  UT_ASSERT_EQUAL (DataCache.PrefetchCount, ReadPages - TestVolume->ReadCount);
+  UT_ASSERT_EQUAL (DataCache.PrefetchHitCount, ScanPages - TestVolume->ReadCount);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Reads of random pages, never the page after the previous one, read one page
+  at a time.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+RandomReadsAreNotReadAhead (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                *TestContext;
+  FAT_TEST_VOLUME             *TestVolume;
+  EDKII_FAT_CACHE_STATISTICS  DataCache;
+  UINTN                       PageNo;
+  UINTN                       Previous;
+  UINTN                       Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  TestVolume  = TestContext->TestVolume;
+
+  Previous = 0;
+  for (Index = 0; Index < FAT_TEST_MAX_REQUESTS; Index++) {
+    do {
+      PageNo = UnitTestRandom (&TestContext->Seed) % TestContext->PageCount;
+    } while (PageNo == Previous + 1);
+
+    UT_ASSERT_TRUE (ReadMatchesModel (TestContext, PagePos (TestContext, PageNo) + Index, 1));
+    Previous = PageNo;
+  }
+
+  UT_ASSERT_TRUE (TestVolume->ReadCount <= FAT_TEST_MAX_REQUESTS);
+  for (Index = 0; Index < TestVolume->ReadCount; Index++) {
+    UT_ASSERT_EQUAL (TestVolume->Reads[Index].Size, TestContext->PageSize);
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (GetDataCacheStatistics (TestContext, &DataCache));
+  UT_ASSERT_EQUAL (DataCache.MissCount, TestVolume->ReadCount);
+  UT_ASSERT_EQUAL (DataCache.PrefetchCount, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The read-ahead stops before a cache page that holds dirty data, and before
+  a cache page that already holds the page to read ahead, so that neither is
+  read again.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReadAheadKeepsCachedPages (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT     *TestContext;
+  FAT_TEST_VOLUME  *TestVolume;
+  UINTN            ReadCount;
+  UINTN            DirtyPageNo;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  TestVolume  = TestContext->TestVolume;
+  DirtyPageNo = 3 + TestVolume->Volume.DiskCache[CacheData].GroupMask + 1;
+
+  //
+  // A page held by the cache page after the one of page 2 is dirty, the
+  // sequential read of pages 1 and 2 reads page 2 alone
+  //
+  UT_ASSERT_NOT_EFI_ERROR (WriteRandomData (TestContext, PagePos (TestContext, DirtyPageNo) + 10, 20));
+  UT_ASSERT_TRUE (ReadMatchesModel (TestContext, PagePos (TestContext, 1), 1));
+  ReadCount = TestVolume->ReadCount;
+  UT_ASSERT_TRUE (ReadMatchesModel (TestContext, PagePos (TestContext, 2), 1));
+  UT_ASSERT_EQUAL (TestVolume->ReadCount, ReadCount + 1);
+  UT_ASSERT_EQUAL (TestVolume->Reads[ReadCount].Offset, PagePos (TestContext, 2));
+  UT_ASSERT_EQUAL (TestVolume->Reads[ReadCount].Size, TestContext->PageSize);
+  UT_ASSERT_TRUE (ReadMatchesModel (TestContext, PagePos (TestContext, DirtyPageNo), 64));
+  UT_ASSERT_EQUAL (TestVolume->ReadCount, ReadCount + 1);
+
+  //
+  // Page 8 is cached, the sequential read of pages 6 and 7 reads page 7 alone
+  //
+  UT_ASSERT_TRUE (ReadMatchesModel (TestContext, PagePos (TestContext, 8), 1));
+  UT_ASSERT_TRUE (ReadMatchesModel (TestContext, PagePos (TestContext, 6), 1));
+  ReadCount = TestVolume->ReadCount;
+  UT_ASSERT_TRUE (ReadMatchesModel (TestContext, PagePos (TestContext, 7), 1));
+  UT_ASSERT_EQUAL (TestVolume->ReadCount, ReadCount + 1);
+  UT_ASSERT_EQUAL (TestVolume->Reads[ReadCount].Size, TestContext->PageSize);
+
+  //
+  // The dirty page is written back on the flush
+  //
+  UT_ASSERT_EQUAL (TestVolume->WriteCount, 0);
+  UT_ASSERT_NOT_EFI_ERROR (FatVolumeFlushCache (&TestVolume->Volume, NULL));
+  UT_ASSERT_EQUAL (TestVolume->WriteCount, 1);
+  UT_ASSERT_MEM_EQUAL (TestVolume->Disk, TestContext->Model, (UINTN)TestVolume->Volume.VolumeSize);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Random reads and writes, sequential runs of them among them, of a few bytes
+  to more pages than a cache page, must see the data of the model. The disk
+  must match the model after each flush.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+RandomAccessesMatchModel (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT     *TestContext;
+  FAT_TEST_VOLUME  *TestVolume;
+  UINT64           DataSize;
+  UINT64           Offset;
+  UINTN            Size;
+  UINTN            Index;
+  UINT32           Action;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  TestVolume  = TestContext->TestVolume;
+  DataSize    = TestVolume->Volume.VolumeSize - TestContext->DataPos;
+
+  Offset = TestContext->DataPos;
+  for (Index = 0; Index < TEST_RANDOM_ACTIONS; Index++) {
+    Action = UnitTestRandom (&TestContext->Seed);
+    Size   = 1 + UnitTestRandom (&TestContext->Seed) % (((Action & 0x30) == 0) ? TEST_MAX_ACCESS_PAGES * TestContext->PageSize : 64);
+
+    //
+    // Half of the accesses go on from the previous one
+    //
+    if ((Action & 1) == 0) {
+      Offset = TestContext->DataPos + UnitTestRandom (&TestContext->Seed) % DataSize;
+    }
+
+    if (Offset + Size > TestVolume->Volume.VolumeSize) {
+      Offset = TestVolume->Volume.VolumeSize - Size;
+    }
+
+    if ((Action & 0x6) == 0) {
+      UT_ASSERT_NOT_EFI_ERROR (WriteRandomData (TestContext, Offset, Size));
+    } else {
+      UT_ASSERT_TRUE (ReadMatchesModel (TestContext, Offset, Size));
+    }
+
+    Offset += Size;
+    if (Offset >= TestVolume->Volume.VolumeSize) {
+      Offset = TestContext->DataPos;
+    }
+
+    if ((Action & 0x3C0) == 0) {
+      UT_ASSERT_NOT_EFI_ERROR (FatVolumeFlushCache (&TestVolume->Volume, NULL));
+      UT_ASSERT_MEM_EQUAL (TestVolume->Disk, TestContext->Model, (UINTN)TestVolume->Volume.VolumeSize);
+    }
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (FatVolumeFlushCache (&TestVolume->Volume, NULL));
+  UT_ASSERT_MEM_EQUAL (TestVolume->Disk, TestContext->Model, (UINTN)TestVolume->Volume.VolumeSize);
+  UT_ASSERT_NOT_EQUAL (TestVolume->Volume.DiskCache[CacheData].PrefetchHitCount, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Resetting the statistics clears the counters of both caches, and keeps
+  their geometry.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ResetClearsCounters (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                    *TestContext;
+  EDKII_FAT_DIAGNOSTICS_PROTOCOL  *Diagnostics;
+  EDKII_FAT_CACHE_STATISTICS      FatCache;
+  EDKII_FAT_CACHE_STATISTICS      DataCache;
+  UINTN                           PageNo;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Diagnostics = &TestContext->TestVolume->Volume.Diagnostics;
+
+  for (PageNo = 0; PageNo < 8; PageNo++) {
+    UT_ASSERT_TRUE (ReadMatchesModel (TestContext, PagePos (TestContext, PageNo), TestContext->PageSize / 2));
+  }
+
+  FatTestSetFatEntry (TestContext->TestVolume, FAT_MIN_CLUSTER, (UINTN)FAT_CLUSTER_LAST);
+  UT_ASSERT_NOT_EFI_ERROR (FatDiskIo (&TestContext->TestVolume->Volume, ReadFat, TestContext->TestVolume->Volume.FatPos, sizeof (UINT32), TestContext->Buffer, NULL));
+
+  UT_ASSERT_NOT_EFI_ERROR (Diagnostics->GetCacheStatistics (Diagnostics, &FatCache, &DataCache));
+  UT_ASSERT_EQUAL (FatCache.MissCount, 1);
+  UT_ASSERT_NOT_EQUAL (DataCache.MissCount, 0);
+  UT_ASSERT_NOT_EQUAL (DataCache.PrefetchHitCount, 0);
+
+  UT_ASSERT_NOT_EFI_ERROR (Diagnostics->ResetCacheStatistics (Diagnostics));
+  UT_ASSERT_NOT_EFI_ERROR (Diagnostics->GetCacheStatistics (Diagnostics, &FatCache, &DataCache));
+  UT_ASSERT_EQUAL (FatCache.HitCount + FatCache.MissCount + FatCache.PrefetchCount + FatCache.PrefetchHitCount, 0);
+  UT_ASSERT_EQUAL (DataCache.HitCount + DataCache.MissCount + DataCache.PrefetchCount + DataCache.PrefetchHitCount, 0);
+  UT_ASSERT_EQUAL (DataCache.PageSize, TestContext->PageSize);
+  UT_ASSERT_EQUAL (DataCache.PageCount, PcdGet32 (PcdFatDataCachePageCount));
+
+  //
+  // The pages read ahead before the reset are still cached
+  //
+  UT_ASSERT_TRUE (ReadMatchesModel (TestContext, PagePos (TestContext, 8), 1));
+  UT_ASSERT_NOT_EFI_ERROR (Diagnostics->GetCacheStatistics (Diagnostics, &FatCache, &DataCache));
+  UT_ASSERT_EQUAL (DataCache.HitCount, 1);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the data
+  cache and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      DataCacheTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&DataCacheTests, Framework, "FAT Data Cache Tests", "FatDataCache", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for DataCacheTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (DataCacheTests, "The geometry follows the PCDs", "Geometry", GeometryFollowsPcds, CreateVolume, FreeVolume, &mTestContext);
+  AddTestCase (DataCacheTests, "A sequential read is read ahead", "Sequential", SequentialReadIsReadAhead, CreateVolume, FreeVolume, &mTestContext);
+  AddTestCase (DataCacheTests, "Random reads are not read ahead", "Random", RandomReadsAreNotReadAhead, CreateVolume, FreeVolume, &mTestContext);
+  AddTestCase (DataCacheTests, "The read-ahead keeps the cached pages", "KeepCached", ReadAheadKeepsCachedPages, CreateVolume, FreeVolume, &mTestContext);
+  AddTestCase (DataCacheTests, "Random accesses match the model", "RandomAccesses", RandomAccessesMatchModel, CreateVolume, FreeVolume, &mTestContext);
+  AddTestCase (DataCacheTests, "Resetting the statistics clears the counters", "Reset", ResetClearsCounters, CreateVolume, FreeVolume, &mTestContext);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define FatDataCacheUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+FatDataCacheUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
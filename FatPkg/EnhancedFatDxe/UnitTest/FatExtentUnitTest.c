@@ -0,0 +1,732 @@
+/** @file
+  Host based unit tests of the extents of the open files of the FAT driver.
+
+  Files are chained through the FAT of a memory volume in runs of random
+  lengths, in a random order on the volume. FatOFilePosition() must return the
+  disk position of every file position, and the rest of its run of consecutive
+  clusters, from the extents and without following the FAT again. Growing and
+  shrinking a file must keep the extents in step with its chain, a corrupt
+  chain must still be reported, and a chain of more extents than a file keeps
+  must be followed through the FAT beyond them.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "FatTestVolume.h"
+
+#include <Library/UnitTestLib.h>
+#include <Library/UnitTestRandomLib.h>
+
+#define UNIT_TEST_APP_NAME     "FAT Extent Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_CLUSTER_ALIGNMENT  9
+#define TEST_CLUSTER_COUNT      0x4000
+#define TEST_SLOT_CLUSTERS      16
+#define TEST_SLOT_COUNT         (TEST_CLUSTER_COUNT / TEST_SLOT_CLUSTERS)
+#define TEST_SEEKS              2000
+#define TEST_USED_INTERVAL      8
+
+typedef struct {
+  FAT_VOLUME_TYPE    FatType;
+  FAT_TEST_VOLUME    *TestVolume;
+  FAT_OFILE          OFile;
+  ///
+  /// The clusters of the file, in the order of the file.
+  ///
+  UINTN              *Chain;
+  UINTN              ChainCount;
+  UINT64             Seed;
+} TEST_CONTEXT;
+
+STATIC TEST_CONTEXT  mFat16Context = { Fat16 };
+STATIC TEST_CONTEXT  mFat32Context = { Fat32 };
+
+/**
+  Create the memory volume and an open file without clusters.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED                      The volume is created.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  There is not enough memory.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+CreateVolume (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  EFI_STATUS    Status;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Status      = FatTestCreateVolume (TestContext->FatType, TEST_CLUSTER_ALIGNMENT, TEST_CLUSTER_COUNT, &TestContext->TestVolume);
+  if (EFI_ERROR (Status)) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  TestContext->Chain = AllocatePool (TEST_CLUSTER_COUNT * sizeof (UINTN));
+  if (TestContext->Chain == NULL) {
+    FatTestFreeVolume (TestContext->TestVolume);
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  ZeroMem (&TestContext->OFile, sizeof (FAT_OFILE));
+  TestContext->OFile.Signature = FAT_OFILE_SIGNATURE;
+  TestContext->OFile.Volume    = &TestContext->TestVolume->Volume;
+  TestContext->ChainCount      = 0;
+  TestContext->Seed            = 0x9E3779B97F4A7C15ULL;
+  FatAcquireLock ();
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the open file and the memory volume.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+**/
+STATIC
+VOID
+EFIAPI
+FreeVolume (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  FatReleaseLock ();
+  if (TestContext->OFile.Extents != NULL) {
+    FreePool (TestContext->OFile.Extents);
+  }
+
+  FreePool (TestContext->Chain);
+  FatTestFreeVolume (TestContext->TestVolume);
+  TestContext->OFile.Extents = NULL;
+  TestContext->Chain         = NULL;
+  TestContext->TestVolume    = NULL;
+}
+
+/**
+  Fill the chain with runs of random lengths, each at the end of a slot of
+  the volume, with the slots in a random order.
+
+  @param[in]  TestContext  The test context.
+  @param[in]  SlotCount    The number of runs.
+**/
+STATIC
+VOID
+CreateFragmentedChain (
+  IN TEST_CONTEXT  *TestContext,
+  IN UINTN         SlotCount
+  )
+{
+  UINTN  Slots[TEST_SLOT_COUNT];
+  UINTN  Index;
+  UINTN  Swap;
+  UINTN  Slot;
+  UINTN  Run;
+
+  ASSERT (SlotCount <= TEST_SLOT_COUNT);
+
+  for (Index = 0; Index < TEST_SLOT_COUNT; Index++) {
+    Slots[Index] = Index;
+  }
+
+  for (Index = TEST_SLOT_COUNT - 1; Index > 0; Index--) {
+    Swap         = UnitTestRandom (&TestContext->Seed) % (Index + 1);
+    Slot         = Slots[Index];
+    Slots[Index] = Slots[Swap];
+    Slots[Swap]  = Slot;
+  }
+
+  TestContext->ChainCount = 0;
+  for (Index = 0; Index < SlotCount; Index++) {
+    for (Run = 1 + UnitTestRandom (&TestContext->Seed) % TEST_SLOT_CLUSTERS; Run > 0; Run--) {
+      TestContext->Chain[TestContext->ChainCount++] = FAT_MIN_CLUSTER + (Slots[Index] + 1) * TEST_SLOT_CLUSTERS - Run;
+    }
+  }
+}
+
+/**
+  Chain the clusters of the chain through the FAT of the disk, and make them
+  the clusters of the open file.
+
+  @param[in]  TestContext  The test context.
+  @param[in]  FileSize     The size of the file.
+**/
+STATIC
+VOID
+WriteChain (
+  IN TEST_CONTEXT  *TestContext,
+  IN UINTN         FileSize
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index + 1 < TestContext->ChainCount; Index++) {
+    FatTestSetFatEntry (TestContext->TestVolume, TestContext->Chain[Index], TestContext->Chain[Index + 1]);
+  }
+
+  FatTestSetFatEntry (TestContext->TestVolume, TestContext->Chain[Index], (UINTN)FAT_CLUSTER_LAST);
+
+  TestContext->OFile.FileCluster        = TestContext->Chain[0];
+  TestContext->OFile.FileCurrentCluster = TestContext->Chain[0];
+  TestContext->OFile.FileSize           = FileSize;
+}
+
+/**
+  Flush the FAT cache and read the chain of the open file from the FAT of the
+  disk.
+
+  @param[in]  TestContext  The test context.
+
+  @retval TRUE   The chain is read, and ends at the size of the file.
+  @retval FALSE  The chain does not end at the size of the file.
+**/
+STATIC
+BOOLEAN
+ReadChain (
+  IN TEST_CONTEXT  *TestContext
+  )
+{
+  FAT_VOLUME  *Volume;
+  UINTN       Cluster;
+  UINTN       Count;
+
+  Volume = &TestContext->TestVolume->Volume;
+  if (EFI_ERROR (FatVolumeFlushCache (Volume, NULL))) {
+    return FALSE;
+  }
+
+  Count   = (TestContext->OFile.FileSize + Volume->ClusterSize - 1) >> Volume->ClusterAlignment;
+  Cluster = TestContext->OFile.FileCluster;
+  for (TestContext->ChainCount = 0; TestContext->ChainCount < Count; TestContext->ChainCount++) {
+    if ((Cluster < FAT_MIN_CLUSTER) || (Cluster > Volume->MaxCluster + 1)) {
+      return FALSE;
+    }
+
+    TestContext->Chain[TestContext->ChainCount] = Cluster;
+    Cluster                                     = FatTestGetFatEntry (TestContext->TestVolume, Cluster);
+  }
+
+  return (BOOLEAN)((Count == 0) ? (Cluster == FAT_CLUSTER_FREE) : FAT_END_OF_FAT_CHAIN (Cluster));
+}
+
+/**
+  Return the number of runs of consecutive clusters of the chain, which is the
+  number of extents that map it.
+
+  @param[in]  TestContext  The test context.
+
+  @return The number of runs of the chain.
+**/
+STATIC
+UINTN
+ChainRunCount (
+  IN TEST_CONTEXT  *TestContext
+  )
+{
+  UINTN  Index;
+  UINTN  Count;
+
+  Count = 0;
+  for (Index = 0; Index < TestContext->ChainCount; Index++) {
+    if ((Index == 0) || (TestContext->Chain[Index] != TestContext->Chain[Index - 1] + 1)) {
+      Count++;
+    }
+  }
+
+  return Count;
+}
+
+/**
+  Check that the extents of the open file map the chain, one extent per run
+  of consecutive clusters.
+
+  @param[in]  TestContext  The test context.
+
+  @retval TRUE   The extents map the chain.
+  @retval FALSE  The extents do not map the chain.
+**/
+STATIC
+BOOLEAN
+ExtentsMatchChain (
+  IN TEST_CONTEXT  *TestContext
+  )
+{
+  FAT_OFILE   *OFile;
+  FAT_EXTENT  *Extent;
+  UINTN       Index;
+  UINTN       Cluster;
+
+  OFile = &TestContext->OFile;
+  if (!OFile->ExtentsComplete || (OFile->ExtentCount != ChainRunCount (TestContext))) {
+    return FALSE;
+  }
+
+  Index = 0;
+  for (Extent = OFile->Extents; Extent < OFile->Extents + OFile->ExtentCount; Extent++) {
+    if (Extent->Index != Index) {
+      return FALSE;
+    }
+
+    for (Cluster = Extent->Cluster; Cluster < Extent->Cluster + Extent->Count; Cluster++) {
+      if ((Index >= TestContext->ChainCount) || (TestContext->Chain[Index] != Cluster)) {
+        return FALSE;
+      }
+
+      Index++;
+    }
+  }
+
+  return (BOOLEAN)(Index == TestContext->ChainCount);
+}
+
+/**
+  Position the open file, and check the disk position and the rest of the run
+  of consecutive clusters against the chain.
+
+  @param[in]  TestContext  The test context.
+  @param[in]  Position     The position in the file.
+  @param[in]  PosLimit     The maximum length of the access, at least the rest
+                           of the cluster of the position.
+
+  @retval TRUE   The position matches the chain.
+  @retval FALSE  The position does not match the chain.
+**/
+STATIC
+BOOLEAN
+PositionMatchesChain (
+  IN TEST_CONTEXT  *TestContext,
+  IN UINTN         Position,
+  IN UINTN         PosLimit
+  )
+{
+  FAT_OFILE  *OFile;
+  UINTN      Index;
+  UINTN      End;
+  UINT64     PosDisk;
+  UINT8      ClusterAlignment;
+
+  OFile            = &TestContext->OFile;
+  ClusterAlignment = TestContext->TestVolume->Volume.ClusterAlignment;
+  if (EFI_ERROR (FatOFilePosition (OFile, Position, PosLimit))) {
+    return FALSE;
+  }
+
+  Index = Position >> ClusterAlignment;
+  for (End = Index + 1; End < TestContext->ChainCount; End++) {
+    if (TestContext->Chain[End] != TestContext->Chain[End - 1] + 1) {
+      break;
+    }
+  }
+
+  PosDisk = FatTestClusterPos (TestContext->TestVolume, TestContext->Chain[Index]) +
+            (Position & (OFile->Volume->ClusterSize - 1));
+  return (BOOLEAN)((OFile->PosDisk == PosDisk) && (OFile->PosRem == MIN ((End << ClusterAlignment) - Position, PosLimit)));
+}
+
+/**
+  Return the number of accesses to the FAT cache.
+
+  @param[in]  TestContext  The test context.
+
+  @return The number of accesses to the FAT cache.
+**/
+STATIC
+UINT64
+FatCacheAccessCount (
+  IN TEST_CONTEXT  *TestContext
+  )
+{
+  DISK_CACHE  *DiskCache;
+
+  DiskCache = &TestContext->TestVolume->Volume.DiskCache[CacheFat];
+  return DiskCache->HitCount + DiskCache->MissCount;
+}
+
+/**
+  Random seeks in a fragmented file, forward and backward, must match its
+  chain. The extents are built on the first seek, the other seeks do not
+  follow the FAT, and the run of each seek ends at the end of its extent.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SeeksMatchChain (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  FAT_OFILE     *OFile;
+  FAT_EXTENT    *Extent;
+  UINTN         ClusterSize;
+  UINTN         FileSize;
+  UINTN         Position;
+  UINTN         Index;
+  UINT64        AccessCount;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  OFile       = &TestContext->OFile;
+  ClusterSize = OFile->Volume->ClusterSize;
+
+  CreateFragmentedChain (TestContext, TEST_SLOT_COUNT / 2);
+  FileSize = TestContext->ChainCount * ClusterSize - UnitTestRandom (&TestContext->Seed) % ClusterSize;
+  WriteChain (TestContext, FileSize);
+
+  UT_ASSERT_TRUE (PositionMatchesChain (TestContext, FileSize - 1, 1));
+  UT_ASSERT_TRUE (OFile->ExtentsBuilt);
+  UT_ASSERT_TRUE (ExtentsMatchChain (TestContext));
+
+  AccessCount = FatCacheAccessCount (TestContext);
+  for (Index = 0; Index < TEST_SEEKS; Index++) {
+    Position = UnitTestRandom (&TestContext->Seed) % FileSize;
+    UT_ASSERT_TRUE (PositionMatchesChain (TestContext, Position, 1 + UnitTestRandom (&TestContext->Seed) % (FileSize - Position)));
+  }
+
+  //
+  // The last byte of each extent ends a run, the first byte of the next
+  // extent starts one
+  //
+  for (Extent = OFile->Extents; Extent < OFile->Extents + OFile->ExtentCount; Extent++) {
+    Position = (Extent->Index + Extent->Count) * ClusterSize;
+    UT_ASSERT_TRUE (PositionMatchesChain (TestContext, Position - 1, FileSize));
+    UT_ASSERT_EQUAL (OFile->PosRem, 1);
+    if (Position < FileSize) {
+      UT_ASSERT_TRUE (PositionMatchesChain (TestContext, Position, FileSize - Position));
+    }
+  }
+
+  UT_ASSERT_EQUAL (FatCacheAccessCount (TestContext), AccessCount);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Growing a file whose extents are built appends the clusters to the extents,
+  merged with the last extent when they follow it on the volume, and
+  shrinking a file truncates its extents. The extents match the chain written
+  to the FAT after each change.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+GrowAndShrinkUpdateExtents (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  FAT_OFILE     *OFile;
+  UINTN         ClusterSize;
+  UINTN         Cluster;
+  UINTN         UsedCount;
+  UINTN         Position;
+  UINTN         Index;
+  UINTN         Sizes[4];
+
+  TestContext = (TEST_CONTEXT *)Context;
+  OFile       = &TestContext->OFile;
+  ClusterSize = OFile->Volume->ClusterSize;
+
+  //
+  // Leave runs of free clusters between used clusters
+  //
+  UsedCount = 0;
+  for (Cluster = FAT_MIN_CLUSTER + TEST_USED_INTERVAL - 1; Cluster <= TEST_CLUSTER_COUNT + 1; Cluster += TEST_USED_INTERVAL) {
+    FatTestSetFatEntry (TestContext->TestVolume, Cluster, (UINTN)FAT_CLUSTER_LAST);
+    UsedCount++;
+  }
+
+  //
+  // The extents of a new file are built on its first seek
+  //
+  UT_ASSERT_NOT_EFI_ERROR (FatGrowEof (OFile, 3 * ClusterSize + 1));
+  UT_ASSERT_FALSE (OFile->ExtentsBuilt);
+  UT_ASSERT_TRUE (ReadChain (TestContext));
+  UT_ASSERT_TRUE (PositionMatchesChain (TestContext, 0, ClusterSize));
+  UT_ASSERT_TRUE (ExtentsMatchChain (TestContext));
+  UT_ASSERT_EQUAL (OFile->ExtentCount, 1);
+
+  //
+  // Grow the file by a few clusters at a time, then by many, and shrink it
+  // into an extent and to the end of an extent
+  //
+  Sizes[0] = 5 * ClusterSize;
+  Sizes[1] = 9 * ClusterSize - 3;
+  Sizes[2] = 200 * ClusterSize;
+  Sizes[3] = 7 * ClusterSize;
+  for (Index = 0; Index < ARRAY_SIZE (Sizes); Index++) {
+    if (Sizes[Index] > OFile->FileSize) {
+      UT_ASSERT_NOT_EFI_ERROR (FatGrowEof (OFile, Sizes[Index]));
+    } else {
+      OFile->FileSize = Sizes[Index];
+      UT_ASSERT_NOT_EFI_ERROR (FatShrinkEof (OFile));
+    }
+
+    UT_ASSERT_TRUE (ReadChain (TestContext));
+    UT_ASSERT_TRUE (ExtentsMatchChain (TestContext));
+    for (Position = 0; Position < OFile->FileSize; Position += ClusterSize / 2) {
+      UT_ASSERT_TRUE (PositionMatchesChain (TestContext, Position, OFile->FileSize - Position));
+    }
+  }
+
+  //
+  // The clusters freed by the shrinking are free in the FAT
+  //
+  UsedCount += TestContext->ChainCount;
+  for (Cluster = FAT_MIN_CLUSTER; Cluster <= TEST_CLUSTER_COUNT + 1; Cluster++) {
+    if (FatTestGetFatEntry (TestContext->TestVolume, Cluster) != FAT_CLUSTER_FREE) {
+      UsedCount--;
+    }
+  }
+
+  UT_ASSERT_EQUAL (UsedCount, 0);
+
+  //
+  // A file truncated to nothing keeps its extents built, and grows them again
+  //
+  OFile->FileSize = 0;
+  UT_ASSERT_NOT_EFI_ERROR (FatShrinkEof (OFile));
+  UT_ASSERT_EQUAL (OFile->FileCluster, FAT_CLUSTER_FREE);
+  UT_ASSERT_EQUAL (OFile->ExtentCount, 0);
+  UT_ASSERT_NOT_EFI_ERROR (FatGrowEof (OFile, 20 * ClusterSize));
+  UT_ASSERT_TRUE (ReadChain (TestContext));
+  UT_ASSERT_TRUE (ExtentsMatchChain (TestContext));
+  UT_ASSERT_TRUE (PositionMatchesChain (TestContext, 19 * ClusterSize, ClusterSize));
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A chain that breaks before the end of the file is mapped up to the break,
+  and seeking beyond the break reports the corruption.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+CorruptChainIsReported (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  FAT_OFILE     *OFile;
+  UINTN         ClusterSize;
+  UINTN         Break;
+  UINTN         Position;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  OFile       = &TestContext->OFile;
+  ClusterSize = OFile->Volume->ClusterSize;
+
+  CreateFragmentedChain (TestContext, 64);
+  WriteChain (TestContext, TestContext->ChainCount * ClusterSize);
+  Break = TestContext->ChainCount / 2;
+  FatTestSetFatEntry (TestContext->TestVolume, TestContext->Chain[Break - 1], FAT_CLUSTER_FREE);
+
+  UT_ASSERT_TRUE (PositionMatchesChain (TestContext, 0, ClusterSize));
+  UT_ASSERT_FALSE (OFile->ExtentsComplete);
+  for (Position = 0; Position < Break * ClusterSize; Position += ClusterSize) {
+    UT_ASSERT_TRUE (PositionMatchesChain (TestContext, Position, ClusterSize));
+  }
+
+  UT_ASSERT_STATUS_EQUAL (FatOFilePosition (OFile, Break * ClusterSize, ClusterSize), EFI_VOLUME_CORRUPTED);
+  UT_ASSERT_STATUS_EQUAL (FatOFilePosition (OFile, OFile->FileSize - 1, 1), EFI_VOLUME_CORRUPTED);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A chain that goes on beyond the end of the file is mapped up to the end of
+  the file, and the extents do not map the whole chain.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LongChainIsMappedToFileSize (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  FAT_OFILE     *OFile;
+  FAT_EXTENT    *Extent;
+  UINTN         ClusterSize;
+  UINTN         Count;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  OFile       = &TestContext->OFile;
+  ClusterSize = OFile->Volume->ClusterSize;
+
+  CreateFragmentedChain (TestContext, 64);
+  Count = TestContext->ChainCount / 2;
+  WriteChain (TestContext, Count * ClusterSize);
+
+  UT_ASSERT_TRUE (PositionMatchesChain (TestContext, OFile->FileSize - 1, 1));
+  UT_ASSERT_FALSE (OFile->ExtentsComplete);
+  Extent = &OFile->Extents[OFile->ExtentCount - 1];
+  UT_ASSERT_EQUAL (Extent->Index + Extent->Count, Count);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A file of more extents than an open file keeps is mapped by the extents up
+  to their limit, and is followed through the FAT beyond them, also when it
+  grows.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ManyExtentsFollowFat (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  FAT_OFILE     *OFile;
+  UINTN         ClusterSize;
+  UINTN         FileSize;
+  UINTN         Position;
+  UINTN         Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  OFile       = &TestContext->OFile;
+  ClusterSize = OFile->Volume->ClusterSize;
+
+  //
+  // Every other cluster, so that each cluster is an extent
+  //
+  TestContext->ChainCount = FAT_OFILE_EXTENT_MAX_COUNT + 0x100;
+  for (Index = 0; Index < TestContext->ChainCount; Index++) {
+    TestContext->Chain[Index] = FAT_MIN_CLUSTER + 2 * Index;
+  }
+
+  FileSize = TestContext->ChainCount * ClusterSize;
+  WriteChain (TestContext, FileSize);
+
+  UT_ASSERT_TRUE (PositionMatchesChain (TestContext, 0, FileSize));
+  UT_ASSERT_FALSE (OFile->ExtentsComplete);
+  UT_ASSERT_EQUAL (OFile->ExtentCount, FAT_OFILE_EXTENT_MAX_COUNT);
+
+  for (Index = 0; Index < TEST_SEEKS; Index++) {
+    Position = UnitTestRandom (&TestContext->Seed) % FileSize;
+    UT_ASSERT_TRUE (PositionMatchesChain (TestContext, Position, FileSize - Position));
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (FatGrowEof (OFile, FileSize + 4 * ClusterSize));
+  UT_ASSERT_EQUAL (OFile->ExtentCount, FAT_OFILE_EXTENT_MAX_COUNT);
+  UT_ASSERT_TRUE (ReadChain (TestContext));
+  for (Position = FileSize - ClusterSize; Position < OFile->FileSize; Position += ClusterSize) {
+    UT_ASSERT_TRUE (PositionMatchesChain (TestContext, Position, ClusterSize));
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the extents
+  of the open files and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      ExtentTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&ExtentTests, Framework, "FAT Extent Tests", "FatExtent", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for ExtentTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (ExtentTests, "Seeks in a FAT16 file match its chain", "Fat16Seeks", SeeksMatchChain, CreateVolume, FreeVolume, &mFat16Context);
+  AddTestCase (ExtentTests, "Seeks in a FAT32 file match its chain", "Fat32Seeks", SeeksMatchChain, CreateVolume, FreeVolume, &mFat32Context);
+  AddTestCase (ExtentTests, "Growing and shrinking a FAT16 file update its extents", "Fat16GrowShrink", GrowAndShrinkUpdateExtents, CreateVolume, FreeVolume, &mFat16Context);
+  AddTestCase (ExtentTests, "Growing and shrinking a FAT32 file update its extents", "Fat32GrowShrink", GrowAndShrinkUpdateExtents, CreateVolume, FreeVolume, &mFat32Context);
+  AddTestCase (ExtentTests, "A corrupt chain is reported", "CorruptChain", CorruptChainIsReported, CreateVolume, FreeVolume, &mFat32Context);
+  AddTestCase (ExtentTests, "A chain longer than the file is mapped to the file size", "LongChain", LongChainIsMappedToFileSize, CreateVolume, FreeVolume, &mFat32Context);
+  AddTestCase (ExtentTests, "A chain of too many extents is followed through the FAT", "ManyExtents", ManyExtentsFollowFat, CreateVolume, FreeVolume, &mFat32Context);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define FatExtentUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+FatExtentUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
@@ -0,0 +1,430 @@
+/** @file
+  A FAT volume on a memory disk, shared by the host based unit tests of the
+  FAT driver.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "FatTestVolume.h"
+
+EFI_LOCK  FatFsLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_CALLBACK);
+
+/**
+  Record a request of the memory disk and check it.
+
+  @param[in]      TestVolume  The volume.
+  @param[in]      Requests    The recorded requests of the same direction.
+  @param[in, out] Count       The number of recorded requests.
+  @param[in]      MediaId     The media ID of the request.
+  @param[in]      Offset      The disk position of the request.
+  @param[in]      BufferSize  The size of the request in bytes.
+
+  @retval EFI_SUCCESS            The request is valid.
+  @retval EFI_MEDIA_CHANGED      The media ID is not the one of the volume.
+  @retval EFI_INVALID_PARAMETER  The request is beyond the end of the disk.
+**/
+STATIC
+EFI_STATUS
+FatTestRecordRequest (
+  IN     FAT_TEST_VOLUME   *TestVolume,
+  IN     FAT_TEST_REQUEST  *Requests,
+  IN OUT UINTN             *Count,
+  IN     UINT32            MediaId,
+  IN     UINT64            Offset,
+  IN     UINTN             BufferSize
+  )
+{
+  if (MediaId != TestVolume->Volume.MediaId) {
+    return EFI_MEDIA_CHANGED;
+  }
+
+  if (Offset + BufferSize > TestVolume->Volume.VolumeSize) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (*Count < FAT_TEST_MAX_REQUESTS) {
+    Requests[*Count].Offset = Offset;
+    Requests[*Count].Size   = BufferSize;
+  }
+
+  (*Count)++;
+  return EFI_SUCCESS;
+}
+
+/**
+  Read from the memory disk.
+
+  @param[in]  This        The Disk I/O protocol of the memory disk.
+  @param[in]  MediaId     The media ID of the request.
+  @param[in]  Offset      The disk position to read from.
+  @param[in]  BufferSize  The size of the buffer in bytes.
+  @param[out] Buffer      The buffer to receive the data.
+
+  @retval EFI_SUCCESS  The data was read.
+  @retval others       The request is not valid.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+FatTestReadDisk (
+  IN  EFI_DISK_IO_PROTOCOL  *This,
+  IN  UINT32                MediaId,
+  IN  UINT64                Offset,
+  IN  UINTN                 BufferSize,
+  OUT VOID                  *Buffer
+  )
+{
+  FAT_TEST_VOLUME  *TestVolume;
+  EFI_STATUS       Status;
+
+  TestVolume = BASE_CR (This, FAT_TEST_VOLUME, DiskIo);
+  Status     = FatTestRecordRequest (TestVolume, TestVolume->Reads, &TestVolume->ReadCount, MediaId, Offset, BufferSize);
+  if (!EFI_ERROR (Status)) {
+    CopyMem (Buffer, TestVolume->Disk + Offset, BufferSize);
+  }
+
+  return Status;
+}
+
+/**
+  Write to the memory disk.
+
+  @param[in] This        The Disk I/O protocol of the memory disk.
+  @param[in] MediaId     The media ID of the request.
+  @param[in] Offset      The disk position to write to.
+  @param[in] BufferSize  The size of the buffer in bytes.
+  @param[in] Buffer      The data to write.
+
+  @retval EFI_SUCCESS  The data was written.
+  @retval others       The request is not valid.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+FatTestWriteDisk (
+  IN EFI_DISK_IO_PROTOCOL  *This,
+  IN UINT32                MediaId,
+  IN UINT64                Offset,
+  IN UINTN                 BufferSize,
+  IN VOID                  *Buffer
+  )
+{
+  FAT_TEST_VOLUME  *TestVolume;
+  EFI_STATUS       Status;
+
+  TestVolume = BASE_CR (This, FAT_TEST_VOLUME, DiskIo);
+  Status     = FatTestRecordRequest (TestVolume, TestVolume->Writes, &TestVolume->WriteCount, MediaId, Offset, BufferSize);
+  if (!EFI_ERROR (Status)) {
+    CopyMem (TestVolume->Disk + Offset, Buffer, BufferSize);
+  }
+
+  return Status;
+}
+
+/**
+  Flush the memory disk, which has nothing to flush.
+
+  @param[in] This  The Block I/O protocol of the memory disk.
+
+  @retval EFI_SUCCESS  The disk is flushed.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+FatTestFlushBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Stub of FatAcquireLock(). The lock must not be held.
+**/
+VOID
+FatAcquireLock (
+  VOID
+  )
+{
+  ASSERT (FatFsLock.Lock == EfiLockReleased);
+  FatFsLock.Lock = EfiLockAcquired;
+}
+
+/**
+  Stub of FatReleaseLock(). The lock must be held.
+**/
+VOID
+FatReleaseLock (
+  VOID
+  )
+{
+  ASSERT (FatFsLock.Lock == EfiLockAcquired);
+  FatFsLock.Lock = EfiLockReleased;
+}
+
+/**
+  Set the volume as dirty or not, as the driver does.
+
+  @param[in] Volume      FAT file system volume.
+  @param[in] IoMode      The access mode.
+  @param[in] DirtyValue  Set the volume as dirty or not.
+
+  @retval EFI_SUCCESS  The FAT entry is accessed.
+  @return other        An error occurred when accessing the FAT entry.
+**/
+EFI_STATUS
+FatAccessVolumeDirty (
+  IN FAT_VOLUME  *Volume,
+  IN IO_MODE     IoMode,
+  IN VOID        *DirtyValue
+  )
+{
+  UINTN  WriteCount;
+
+  WriteCount = Volume->FatEntrySize;
+  return FatDiskIo (Volume, IoMode, Volume->FatPos + WriteCount, WriteCount, DirtyValue, NULL);
+}
+
+/**
+  Blocking disk access of the driver, through the cache or the memory disk.
+
+  @param[in]      Volume      FAT file system volume.
+  @param[in]      IoMode      The access mode (disk read/write or cache access).
+  @param[in]      Offset      The starting byte offset to read from.
+  @param[in]      BufferSize  Size of Buffer.
+  @param[in, out] Buffer      Buffer containing read data.
+  @param[in]      Task        Must be NULL.
+
+  @retval EFI_SUCCESS           The operation is performed successfully.
+  @retval EFI_VOLUME_CORRUPTED  The access is beyond the end of the volume.
+  @return Others                The status of read/write the disk.
+**/
+EFI_STATUS
+FatDiskIo (
+  IN     FAT_VOLUME  *Volume,
+  IN     IO_MODE     IoMode,
+  IN     UINT64      Offset,
+  IN     UINTN       BufferSize,
+  IN OUT VOID        *Buffer,
+  IN     FAT_TASK    *Task
+  )
+{
+  EFI_STATUS  Status;
+
+  ASSERT (Task == NULL);
+
+  Status = EFI_VOLUME_CORRUPTED;
+  if (Offset + BufferSize <= Volume->VolumeSize) {
+    if (CACHE_ENABLED (IoMode)) {
+      Status = FatAccessCache (Volume, CACHE_TYPE (IoMode), RAW_ACCESS (IoMode), Offset, BufferSize, Buffer, Task);
+    } else if (IoMode == ReadDisk) {
+      Status = Volume->DiskIo->ReadDisk (Volume->DiskIo, Volume->MediaId, Offset, BufferSize, Buffer);
+    } else {
+      Status = Volume->DiskIo->WriteDisk (Volume->DiskIo, Volume->MediaId, Offset, BufferSize, Buffer);
+    }
+  }
+
+  if (EFI_ERROR (Status)) {
+    Volume->DiskError = TRUE;
+  }
+
+  return Status;
+}
+
+/**
+  Create a FAT16 or FAT32 volume on a memory disk, with its FATs cleared and
+  its disk cache initialized.
+
+  @param[in]  FatType           Fat16 or Fat32.
+  @param[in]  ClusterAlignment  Log2 of the cluster size.
+  @param[in]  ClusterCount      The number of clusters of the volume.
+  @param[out] TestVolume        Returns the volume.
+
+  @retval EFI_SUCCESS           The volume is created.
+  @retval EFI_OUT_OF_RESOURCES  There is not enough memory for the volume.
+**/
+EFI_STATUS
+FatTestCreateVolume (
+  IN  FAT_VOLUME_TYPE  FatType,
+  IN  UINT8            ClusterAlignment,
+  IN  UINTN            ClusterCount,
+  OUT FAT_TEST_VOLUME  **TestVolume
+  )
+{
+  FAT_TEST_VOLUME  *Test;
+  FAT_VOLUME       *Volume;
+  EFI_STATUS       Status;
+
+  ASSERT (FatType == Fat16 || FatType == Fat32);
+  ASSERT (ClusterAlignment >= 9);
+
+  Test = AllocateZeroPool (sizeof (FAT_TEST_VOLUME));
+  if (Test == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Test->DiskIo.Revision     = EFI_DISK_IO_PROTOCOL_REVISION;
+  Test->DiskIo.ReadDisk     = FatTestReadDisk;
+  Test->DiskIo.WriteDisk    = FatTestWriteDisk;
+  Test->BlockIo.FlushBlocks = FatTestFlushBlocks;
+
+  Volume                                   = &Test->Volume;
+  Volume->Signature                        = FAT_VOLUME_SIGNATURE;
+  Volume->Valid                            = TRUE;
+  Volume->Diagnostics.Revision             = EDKII_FAT_DIAGNOSTICS_PROTOCOL_REVISION;
+  Volume->Diagnostics.GetCacheStatistics   = FatGetCacheStatistics;
+  Volume->Diagnostics.ResetCacheStatistics = FatResetCacheStatistics;
+  Volume->DiskIo                           = &Test->DiskIo;
+  Volume->BlockIo                          = &Test->BlockIo;
+  Volume->MediaId                          = 1;
+
+  Volume->FatType          = FatType;
+  Volume->FatEntrySize     = (FatType == Fat32) ? sizeof (UINT32) : sizeof (UINT16);
+  Volume->NumFats          = FAT_TEST_NUM_FATS;
+  Volume->FatPos           = FAT_TEST_BLOCK_SIZE;
+  Volume->FatSize          = ALIGN_VALUE ((ClusterCount + FAT_MIN_CLUSTER) * Volume->FatEntrySize, FAT_TEST_BLOCK_SIZE);
+  Volume->RootPos          = Volume->FatPos + Volume->NumFats * Volume->FatSize;
+  Volume->FirstClusterPos  = Volume->RootPos;
+  Volume->MaxCluster       = ClusterCount;
+  Volume->ClusterAlignment = ClusterAlignment;
+  Volume->ClusterSize      = (UINTN)1 << ClusterAlignment;
+  if (FatType != Fat32) {
+    Volume->RootEntries      = FAT_TEST_ROOT_ENTRIES;
+    Volume->FirstClusterPos += FAT_TEST_ROOT_ENTRIES * sizeof (FAT_DIRECTORY_ENTRY);
+  }
+
+  Volume->VolumeSize = Volume->FirstClusterPos + LShiftU64 (ClusterCount, ClusterAlignment);
+  Test->Disk         = AllocateZeroPool ((UINTN)Volume->VolumeSize);
+  if (Test->Disk == NULL) {
+    FreePool (Test);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // The media descriptor, and the volume is clean
+  //
+  FatTestSetFatEntry (Test, 0, FAT_CLUSTER_SPECIAL + 1);
+  FatTestSetFatEntry (Test, 1, (UINTN)FAT_CLUSTER_LAST);
+  if (FatType == Fat32) {
+    Volume->NotDirtyValue = (UINT32)FatTestGetFatEntry (Test, 1) & FAT_CLUSTER_MASK_FAT32;
+    Volume->DirtyValue    = Volume->NotDirtyValue & FAT32_DIRTY_MASK;
+  } else {
+    Volume->NotDirtyValue = (UINT16)FatTestGetFatEntry (Test, 1);
+    Volume->DirtyValue    = Volume->NotDirtyValue & FAT16_DIRTY_MASK;
+  }
+
+  Volume->FatInfoSector.FreeInfo.NextCluster = FAT_MIN_CLUSTER;
+
+  Status = FatInitializeDiskCache (Volume);
+  if (EFI_ERROR (Status)) {
+    FreePool (Test->Disk);
+    FreePool (Test);
+    return Status;
+  }
+
+  *TestVolume = Test;
+  return EFI_SUCCESS;
+}
+
+/**
+  Free a volume created by FatTestCreateVolume().
+
+  @param[in] TestVolume  The volume.
+**/
+VOID
+FatTestFreeVolume (
+  IN FAT_TEST_VOLUME  *TestVolume
+  )
+{
+  if (TestVolume->Volume.FreeBitmap != NULL) {
+    FreePool (TestVolume->Volume.FreeBitmap);
+  }
+
+  FreePool (TestVolume->Volume.CacheBuffer);
+  FreePool (TestVolume->Disk);
+  FreePool (TestVolume);
+}
+
+/**
+  Set an entry of every FAT of the disk. The FAT cache does not see the entry
+  if it already holds its page.
+
+  @param[in] TestVolume  The volume.
+  @param[in] Cluster     The cluster of the entry.
+  @param[in] Value       The value of the entry, as FatGetFatEntry() returns it.
+**/
+VOID
+FatTestSetFatEntry (
+  IN FAT_TEST_VOLUME  *TestVolume,
+  IN UINTN            Cluster,
+  IN UINTN            Value
+  )
+{
+  FAT_VOLUME  *Volume;
+  UINT8       *Entry;
+  UINTN       Index;
+
+  Volume = &TestVolume->Volume;
+  ASSERT (Cluster <= Volume->MaxCluster + 1);
+
+  for (Index = 0; Index < Volume->NumFats; Index++) {
+    Entry = TestVolume->Disk + Volume->FatPos + Index * Volume->FatSize + Cluster * Volume->FatEntrySize;
+    if (Volume->FatType == Fat32) {
+      WriteUnaligned32 ((UINT32 *)Entry, (UINT32)(Value & FAT_CLUSTER_MASK_FAT32));
+    } else {
+      WriteUnaligned16 ((UINT16 *)Entry, (UINT16)Value);
+    }
+  }
+}
+
+/**
+  Get an entry of the first FAT of the disk, which does not hold the entries
+  in the FAT cache until it is flushed.
+
+  @param[in] TestVolume  The volume.
+  @param[in] Cluster     The cluster of the entry.
+
+  @return The value of the entry, as FatGetFatEntry() returns it.
+**/
+UINTN
+FatTestGetFatEntry (
+  IN FAT_TEST_VOLUME  *TestVolume,
+  IN UINTN            Cluster
+  )
+{
+  FAT_VOLUME  *Volume;
+  UINT8       *Entry;
+  UINTN       Value;
+
+  Volume = &TestVolume->Volume;
+  ASSERT (Cluster <= Volume->MaxCluster + 1);
+
+  Entry = TestVolume->Disk + Volume->FatPos + Cluster * Volume->FatEntrySize;
+  if (Volume->FatType == Fat32) {
+    Value = ReadUnaligned32 ((UINT32 *)Entry) & FAT_CLUSTER_MASK_FAT32;
+    return Value | ((Value >= FAT_CLUSTER_SPECIAL_FAT32) ? FAT_CLUSTER_SPECIAL_EXT : 0);
+  }
+
+  Value = ReadUnaligned16 ((UINT16 *)Entry);
+  return Value | ((Value >= FAT_CLUSTER_SPECIAL_FAT16) ? FAT_CLUSTER_SPECIAL_EXT : 0);
+}
+
+/**
+  Return the disk position of a cluster.
+
+  @param[in] TestVolume  The volume.
+  @param[in] Cluster     The cluster.
+
+  @return The disk position of the cluster.
+**/
+UINT64
+FatTestClusterPos (
+  IN FAT_TEST_VOLUME  *TestVolume,
+  IN UINTN            Cluster
+  )
+{
+  return TestVolume->Volume.FirstClusterPos +
+         LShiftU64 (Cluster - FAT_MIN_CLUSTER, TestVolume->Volume.ClusterAlignment);
+}
@@ -0,0 +1,117 @@
+/** @file
+  A FAT volume on a memory disk, shared by the host based unit tests of the
+  FAT driver.
+
+  The volume is set up as FatAllocateVolume() and FatOpenDevice() set it up
+  from a formatted disk, with its FATs cleared, and the disk I/O and lock
+  functions of the driver the tests do not build are replaced here.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef FAT_TEST_VOLUME_H_
+#define FAT_TEST_VOLUME_H_
+
+#include "../Fat.h"
+
+#define FAT_TEST_BLOCK_SIZE    512
+#define FAT_TEST_NUM_FATS      2
+#define FAT_TEST_ROOT_ENTRIES  512
+#define FAT_TEST_MAX_REQUESTS  64
+
+typedef struct {
+  UINT64    Offset;
+  UINTN     Size;
+} FAT_TEST_REQUEST;
+
+typedef struct {
+  FAT_VOLUME               Volume;
+  EFI_DISK_IO_PROTOCOL     DiskIo;
+  EFI_BLOCK_IO_PROTOCOL    BlockIo;
+  UINT8                    *Disk;
+  ///
+  /// Disk I/O requests issued by the driver.
+  ///
+  FAT_TEST_REQUEST         Reads[FAT_TEST_MAX_REQUESTS];
+  UINTN                    ReadCount;
+  FAT_TEST_REQUEST         Writes[FAT_TEST_MAX_REQUESTS];
+  UINTN                    WriteCount;
+} FAT_TEST_VOLUME;
+
+/**
+  Create a FAT16 or FAT32 volume on a memory disk, with its FATs cleared and
+  its disk cache initialized.
+
+  @param[in]  FatType           Fat16 or Fat32.
+  @param[in]  ClusterAlignment  Log2 of the cluster size.
+  @param[in]  ClusterCount      The number of clusters of the volume.
+  @param[out] TestVolume        Returns the volume.
+
+  @retval EFI_SUCCESS           The volume is created.
+  @retval EFI_OUT_OF_RESOURCES  There is not enough memory for the volume.
+**/
+EFI_STATUS
+FatTestCreateVolume (
+  IN  FAT_VOLUME_TYPE  FatType,
+  IN  UINT8            ClusterAlignment,
+  IN  UINTN            ClusterCount,
+  OUT FAT_TEST_VOLUME  **TestVolume
+  );
+
+/**
+  Free a volume created by FatTestCreateVolume().
+
+  @param[in] TestVolume  The volume.
+**/
+VOID
+FatTestFreeVolume (
+  IN FAT_TEST_VOLUME  *TestVolume
+  );
+
+/**
+  Set an entry of every FAT of the disk. The FAT cache does not see the entry
+  if it already holds its page.
+
+  @param[in] TestVolume  The volume.
+  @param[in] Cluster     The cluster of the entry.
+  @param[in] Value       The value of the entry, as FatGetFatEntry() returns it.
+**/
+VOID
+FatTestSetFatEntry (
+  IN FAT_TEST_VOLUME  *TestVolume,
+  IN UINTN            Cluster,
+  IN UINTN            Value
+  );
+
+/**
+  Get an entry of the first FAT of the disk, which does not hold the entries
+  in the FAT cache until it is flushed.
+
+  @param[in] TestVolume  The volume.
+  @param[in] Cluster     The cluster of the entry.
+
+  @return The value of the entry, as FatGetFatEntry() returns it.
+**/
+UINTN
+FatTestGetFatEntry (
+  IN FAT_TEST_VOLUME  *TestVolume,
+  IN UINTN            Cluster
+  );
+
+/**
+  Return the disk position of a cluster.
+
+  @param[in] TestVolume  The volume.
+  @param[in] Cluster     The cluster.
+
+  @return The disk position of the cluster.
+**/
+UINT64
+FatTestClusterPos (
+  IN FAT_TEST_VOLUME  *TestVolume,
+  IN UINTN            Cluster
+  );
+
+#endif
@@ -0,0 +1,83 @@
+/** @file
+  FAT Diagnostics Protocol is related to the EDK II FAT driver, and is
+  installed on each volume the driver mounts. It reports how well the disk
+  caches of the volume perform, so that their geometry can be tuned.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __FAT_DIAGNOSTICS_H__
+#define __FAT_DIAGNOSTICS_H__
+
+#define EDKII_FAT_DIAGNOSTICS_PROTOCOL_GUID \
+  { \
+    0x5f0b7a8e, 0x3d41, 0x4c2b, { 0x9a, 0x6e, 0x1c, 0x84, 0x27, 0xd3, 0x5b, 0x90 } \
+  }
+
+#define EDKII_FAT_DIAGNOSTICS_PROTOCOL_REVISION  0x00000001
+
+typedef struct _EDKII_FAT_DIAGNOSTICS_PROTOCOL EDKII_FAT_DIAGNOSTICS_PROTOCOL;
+
+///
+/// Statistics of a disk cache of a FAT volume. A hit or a miss is counted
+/// for each cache page an access goes through the cache for. Accesses of
+/// whole data cache pages go to the disk directly and are not counted.
+///
+typedef struct {
+  UINT32    PageSize;
+  UINT32    PageCount;
+  UINT64    HitCount;
+  UINT64    MissCount;
+  ///
+  /// Pages read ahead of a sequential access, and how many of them were
+  /// accessed before they were evicted.
+  ///
+  UINT64    PrefetchCount;
+  UINT64    PrefetchHitCount;
+} EDKII_FAT_CACHE_STATISTICS;
+
+/**
+  Return the statistics of the disk caches of the volume.
+
+  @param[in]  This              The EDKII_FAT_DIAGNOSTICS_PROTOCOL instance.
+  @param[out] FatCache          Returns the statistics of the cache of the FAT.
+  @param[out] DataCache         Returns the statistics of the cache of the
+                                directories and files.
+
+  @retval EFI_SUCCESS           The statistics are returned.
+  @retval EFI_INVALID_PARAMETER FatCache or DataCache is NULL.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_FAT_GET_CACHE_STATISTICS)(
+  IN  EDKII_FAT_DIAGNOSTICS_PROTOCOL  *This,
+  OUT EDKII_FAT_CACHE_STATISTICS      *FatCache,
+  OUT EDKII_FAT_CACHE_STATISTICS      *DataCache
+  );
+
+/**
+  Reset the counters of the disk caches of the volume.
+
+  @param[in]  This              The EDKII_FAT_DIAGNOSTICS_PROTOCOL instance.
+
+  @retval EFI_SUCCESS           The counters are reset.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_FAT_RESET_CACHE_STATISTICS)(
+  IN  EDKII_FAT_DIAGNOSTICS_PROTOCOL  *This
+  );
+
+struct _EDKII_FAT_DIAGNOSTICS_PROTOCOL {
+  UINT64                              Revision;
+  EDKII_FAT_GET_CACHE_STATISTICS      GetCacheStatistics;
+  EDKII_FAT_RESET_CACHE_STATISTICS    ResetCacheStatistics;
+};
+
+extern EFI_GUID  gEdkiiFatDiagnosticsProtocolGuid;
+
+#endif
@@ -37,6 +37,7 @@
 #include <Library/UefiLib.h>
 #include <Library/DevicePathLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiDriverEntryPoint.h>
 #include <Library/ReportStatusCodeLib.h>
@@ -65,17 +66,35 @@ extern EFI_DRIVER_SUPPORTED_EFI_VERSION_PROTOCOL  gNvmExpressDriverSupportedEfiV
 #define NVME_CCQ_SIZE  1                                // Number of I/O completion queue entries, which is 0-based
 
 //
-// Number of asynchronous I/O submission queue entries, which is 0-based.
-// The asynchronous I/O submission queue size is 4kB in total.
+// Maximum number of asynchronous I/O queue pairs. PcdNvmExpressAsyncIoQueueCount
+// sets the number of queue pairs, which is limited by the number of I/O queues
+// the controller allocates.
 //
-#define NVME_ASYNC_CSQ_SIZE  63
+#define NVME_MAX_ASYNC_IO_QUEUES  8
 //
-// Number of asynchronous I/O completion queue entries, which is 0-based.
-// The asynchronous I/O completion queue size is 4kB in total.
+// Maximum number of entries of an asynchronous I/O submission or completion
+// queue. PcdNvmExpressAsyncIoQueueDepth sets the number of entries, which is
+// limited by CAP.MQES of the controller.
 //
-#define NVME_ASYNC_CCQ_SIZE  255
+#define NVME_MAX_ASYNC_QUEUE_DEPTH  1024
 
-#define NVME_MAX_QUEUES  3                              // Number of queues supported by the driver
+//
+// Queue pair 0 is the admin queue pair and queue pair 1 is used for blocking
+// I/O. The asynchronous I/O queue pairs start with queue pair 2.
+//
+#define NVME_ASYNC_IO_QUEUE_ID  2
+
+#define NVME_MAX_QUEUES  (NVME_ASYNC_IO_QUEUE_ID + NVME_MAX_ASYNC_IO_QUEUES)  // Number of queues supported by the driver
+
+//
+// Feature Identifier of the Number of Queues feature.
+//
+#define NVME_FEATURE_NUMBER_OF_QUEUES  0x07
+
+//
+// PRP list slot value of the commands whose PRP list is not in the PRP list pool.
+//
+#define NVME_PRP_LIST_SLOT_NONE  0xFFFF
 
 #define NVME_CONTROLLER_ID  0
 
@@ -118,16 +137,24 @@ struct _NVME_CONTROLLER_PRIVATE_DATA {
   NVME_ADMIN_CONTROLLER_DATA            *ControllerData;
 
   //
-  // 6 x 4kB aligned buffers will be carved out of this buffer.
+  // The 4kB aligned queues will be carved out of this buffer.
   // 1st 4kB boundary is the start of the admin submission queue.
   // 2nd 4kB boundary is the start of the admin completion queue.
   // 3rd 4kB boundary is the start of I/O submission queue #1.
   // 4th 4kB boundary is the start of I/O completion queue #1.
-  // 5th 4kB boundary is the start of I/O submission queue #2.
-  // 6th 4kB boundary is the start of I/O completion queue #2.
+  // Then the submission and completion queues of each asynchronous I/O
+  // queue pair follow, each of them spanning as many pages as needed.
   //
   UINT8          *Buffer;
   UINT8          *BufferPciAddr;
+  UINTN          BufferPages;
+
+  //
+  // Number of asynchronous I/O queue pairs and number of entries of each of
+  // their submission and completion queues.
+  //
+  UINT16         AsyncQueueCount;
+  UINT16         AsyncQueueDepth;
 
   //
   // Pointers to 4kB aligned submission & completion queues.
@@ -142,7 +169,11 @@ struct _NVME_CONTROLLER_PRIVATE_DATA {
   //
   NVME_SQTDBL    SqTdbl[NVME_MAX_QUEUES];
   NVME_CQHDBL    CqHdbl[NVME_MAX_QUEUES];
-  UINT16         AsyncSqHead;
+
+  //
+  // Number of commands of each asynchronous I/O queue which are not completed.
+  //
+  UINT16         OutstandingCmds[NVME_MAX_QUEUES];
 
   //
   // Flag to indicate internal IO queue creation.
@@ -159,6 +190,20 @@ struct _NVME_CONTROLLER_PRIVATE_DATA {
 
   VOID           *Mapping;
 
+  //
+  // Pool of PRP lists the I/O commands use instead of allocating and mapping
+  // a PRP list for each command. The pool holds one PRP list of PrpListSlotSize
+  // bytes for each entry of the asynchronous I/O queues, and one for the
+  // blocking I/O queue.
+  //
+  UINT8                   *PrpListPool;
+  EFI_PHYSICAL_ADDRESS    PrpListPoolPciAddr;
+  UINTN                   PrpListPoolPages;
+  VOID                    *PrpListPoolMapping;
+  UINT32                  PrpListSlotSize;
+  UINT16                  *PrpListFreeSlots;
+  UINT16                  PrpListFreeSlotCount;
+
   //
   // For Non-blocking operations.
   //
@@ -293,7 +338,9 @@ typedef struct {
   LIST_ENTRY                                  Link;
 
   EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET    *Packet;
+  UINT16                                      QueueId;
   UINT16                                      CommandId;
+  UINT16                                      PrpListSlot;
   VOID                                        *MapPrpList;
   UINTN                                       PrpListNo;
   VOID                                        *PrpListHost;
@@ -712,6 +759,117 @@ NvmExpressBuildDevicePath (
   IN OUT EFI_DEVICE_PATH_PROTOCOL            **DevicePath
   );
 
+/**
+  Call back function when the timer event is signaled.
+
+  @param[in]  Event     The Event this notify function registered to.
+  @param[in]  Context   Pointer to the context data registered to the
+                        Event.
+
+**/
+VOID
+EFIAPI
+ProcessAsyncTaskList (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  );
+
+/**
+  Create the pool of PRP lists of the I/O commands.
+
+  The size of the PRP lists is the smallest power of two that holds the PRP
+  entries of a transfer of the maximum data transfer size of the controller.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+  @retval EFI_SUCCESS           The pool was created.
+  @retval EFI_OUT_OF_RESOURCES  The pool could not be allocated.
+
+**/
+EFI_STATUS
+NvmeCreatePrpListPool (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  );
+
+/**
+  Free the pool of PRP lists of the I/O commands.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+**/
+VOID
+NvmeFreePrpListPool (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  );
+
+/**
+  Take a PRP list from the PRP list pool, and fill it for a data transfer.
+
+  @param[in]     Private             The pointer to the NVME_CONTROLLER_PRIVATE_DATA data structure.
+  @param[in]     PhysicalAddr        The physical base address of data buffer.
+  @param[in]     Pages               The number of pages to be transfered.
+  @param[out]    PrpListSlot         The slot of the PRP list in the pool.
+
+  @return The bus master address of the PRP list, or NULL if the pool has no
+          PRP list that is free or large enough.
+
+**/
+VOID *
+NvmeGetPrpListFromPool (
+  IN     NVME_CONTROLLER_PRIVATE_DATA  *Private,
+  IN     EFI_PHYSICAL_ADDRESS          PhysicalAddr,
+  IN     UINTN                         Pages,
+  OUT UINT16                           *PrpListSlot
+  );
+
+/**
+  Return a PRP list to the PRP list pool.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+  @param[in] PrpListSlot    The slot of the PRP list in the pool.
+
+**/
+VOID
+NvmeFreePrpListSlot (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private,
+  IN UINT16                        PrpListSlot
+  );
+
+/**
+  Free the resources of an asynchronous PassThru request that were allocated
+  before its submission, and release its entry of the asynchronous I/O queue.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+  @param[in] AsyncRequest   The asynchronous PassThru request.
+
+**/
+VOID
+NvmeReleaseAsyncPassThruRequest (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private,
+  IN NVME_PASS_THRU_ASYNC_REQ      *AsyncRequest
+  );
+
+/**
+  Reset the controller after an NVMe command timed out, and abort the
+  asynchronous requests.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+  @retval EFI_TIMEOUT       The controller was reset and the asynchronous
+                            requests were aborted.
+  @retval Others            The controller could not be recovered.
+
+**/
+EFI_STATUS
+NvmeRecoverFromTimeout (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  );
+
 /**
   Dump the execution status from a given completion queue entry.
 
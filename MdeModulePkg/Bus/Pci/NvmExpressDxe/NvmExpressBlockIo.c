@@ -195,21 +195,18 @@ NvmeRead (
     MaxTransferBlocks = 1024;
   }
 
-  while (Blocks > 0) {
-    if (Blocks > MaxTransferBlocks) {
-      Status = ReadSectors (Device, (UINT64)(UINTN)Buffer, Lba, MaxTransferBlocks);
-
-      Blocks -= MaxTransferBlocks;
-      Buffer  = (VOID *)(UINTN)((UINT64)(UINTN)Buffer + MaxTransferBlocks * BlockSize);
-      Lba    += MaxTransferBlocks;
-    } else {
-      Status = ReadSectors (Device, (UINT64)(UINTN)Buffer, Lba, (UINT32)Blocks);
-      Blocks = 0;
-    }
+  if (Blocks > MaxTransferBlocks) {
+    //
+    // Keep the commands of a read larger than the maximum data transfer size
+    // in flight on the asynchronous I/O queues.
+    //
+    Status = NvmeAsyncQueueTransfer (Device, Buffer, Lba, Blocks, FALSE);
+  } else {
+    Status = ReadSectors (Device, (UINT64)(UINTN)Buffer, Lba, (UINT32)Blocks);
+  }
 
-    if (EFI_ERROR (Status)) {
-      break;
-    }
+  if (!EFI_ERROR (Status)) {
+    Blocks = 0;
   }
 
   DEBUG ((
@@ -281,21 +278,18 @@ NvmeWrite (
     MaxTransferBlocks = 1024;
   }
 
-  while (Blocks > 0) {
-    if (Blocks > MaxTransferBlocks) {
-      Status = WriteSectors (Device, (UINT64)(UINTN)Buffer, Lba, MaxTransferBlocks);
-
-      Blocks -= MaxTransferBlocks;
-      Buffer  = (VOID *)(UINTN)((UINT64)(UINTN)Buffer + MaxTransferBlocks * BlockSize);
-      Lba    += MaxTransferBlocks;
-    } else {
-      Status = WriteSectors (Device, (UINT64)(UINTN)Buffer, Lba, (UINT32)Blocks);
-      Blocks = 0;
-    }
+  if (Blocks > MaxTransferBlocks) {
+    //
+    // Keep the commands of a write larger than the maximum data transfer size
+    // in flight on the asynchronous I/O queues.
+    //
+    Status = NvmeAsyncQueueTransfer (Device, Buffer, Lba, Blocks, TRUE);
+  } else {
+    Status = WriteSectors (Device, (UINT64)(UINTN)Buffer, Lba, (UINT32)Blocks);
+  }
 
-    if (EFI_ERROR (Status)) {
-      break;
-    }
+  if (!EFI_ERROR (Status)) {
+    Blocks = 0;
   }
 
   DEBUG ((
@@ -813,6 +807,14 @@ NvmeAsyncRead (
     }
   }
 
+  //
+  // Submit the subtasks now rather than on the next tick of the timer of the
+  // asynchronous I/O queues.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  ProcessAsyncTaskList (NULL, Private);
+  gBS->RestoreTPL (OldTpl);
+
   DEBUG ((
     DEBUG_BLKIO,
     "%a: Lba = 0x%08Lx, Original = 0x%08Lx, "
@@ -941,6 +943,14 @@ NvmeAsyncWrite (
     }
   }
 
+  //
+  // Submit the subtasks now rather than on the next tick of the timer of the
+  // asynchronous I/O queues.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  ProcessAsyncTaskList (NULL, Private);
+  gBS->RestoreTPL (OldTpl);
+
   DEBUG ((
     DEBUG_BLKIO,
     "%a: Lba = 0x%08Lx, Original = 0x%08Lx, "
@@ -956,6 +966,134 @@ NvmeAsyncWrite (
   return Status;
 }
 
+/**
+  Read or write some blocks through the asynchronous I/O queues, and wait for
+  the transfer to complete.
+
+  The transfer is split into commands of the maximum data transfer size, which
+  are kept in flight on the asynchronous I/O queues.
+
+  @param  Device                 The pointer to the NVME_DEVICE_PRIVATE_DATA data structure.
+  @param  Buffer                 The buffer of the data.
+  @param  Lba                    The start block number.
+  @param  Blocks                 Total block number to be transferred.
+  @param  IsWrite                TRUE to write the blocks, FALSE to read them.
+
+  @retval EFI_SUCCESS            Datum are transferred.
+  @retval EFI_TIMEOUT            The transfer timed out, and the controller was reset.
+  @retval Others                 Fail to transfer all the datum.
+
+**/
+EFI_STATUS
+NvmeAsyncQueueTransfer (
+  IN     NVME_DEVICE_PRIVATE_DATA  *Device,
+  IN OUT VOID                      *Buffer,
+  IN     UINT64                    Lba,
+  IN     UINTN                     Blocks,
+  IN     BOOLEAN                   IsWrite
+  )
+{
+  NVME_CONTROLLER_PRIVATE_DATA  *Private;
+  EFI_BLOCK_IO2_TOKEN           *Token;
+  EFI_EVENT                     TimerEvent;
+  UINT32                        MaxTransferBlocks;
+  EFI_STATUS                    Status;
+  EFI_TPL                       OldTpl;
+
+  Private    = Device->Controller;
+  TimerEvent = NULL;
+
+  //
+  // The token is allocated from pool, as the subtasks still refer to it if
+  // the controller cannot be recovered from a timeout.
+  //
+  Token = AllocateZeroPool (sizeof (EFI_BLOCK_IO2_TOKEN));
+  if (Token == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = gBS->CreateEvent (0, 0, NULL, NULL, &Token->Event);
+  if (EFI_ERROR (Status)) {
+    FreePool (Token);
+    return Status;
+  }
+
+  //
+  // Allow each command the time a blocking command would have.
+  //
+  if (Private->ControllerData->Mdts != 0) {
+    MaxTransferBlocks = (1 << (Private->ControllerData->Mdts)) * (1 << (Private->Cap.Mpsmin + 12)) / Device->Media.BlockSize;
+  } else {
+    MaxTransferBlocks = 1024;
+  }
+
+  Status = gBS->CreateEvent (EVT_TIMER, TPL_CALLBACK, NULL, NULL, &TimerEvent);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  Status = gBS->SetTimer (
+                  TimerEvent,
+                  TimerRelative,
+                  MultU64x64 (NVME_GENERIC_TIMEOUT, DivU64x32 (Blocks + MaxTransferBlocks - 1, MaxTransferBlocks))
+                  );
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  Token->TransactionStatus = EFI_SUCCESS;
+  if (IsWrite) {
+    Status = NvmeAsyncWrite (Device, Buffer, Lba, Blocks, Token);
+  } else {
+    Status = NvmeAsyncRead (Device, Buffer, Lba, Blocks, Token);
+  }
+
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  //
+  // Submit the subtasks and reap their completions here instead of on the
+  // ticks of the timer of the asynchronous I/O queues.
+  //
+  while (TRUE) {
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    ProcessAsyncTaskList (NULL, Private);
+    gBS->RestoreTPL (OldTpl);
+
+    if (!EFI_ERROR (gBS->CheckEvent (Token->Event))) {
+      Status = Token->TransactionStatus;
+      break;
+    }
+
+    if (!EFI_ERROR (gBS->CheckEvent (TimerEvent))) {
+      DEBUG ((DEBUG_ERROR, "%a: Timeout occurs for the NVMe commands.\n", __func__));
+
+      Status = NvmeRecoverFromTimeout (Private);
+      if (Status != EFI_TIMEOUT) {
+        //
+        // The subtasks that are not aborted still refer to the token.
+        //
+        Token = NULL;
+      }
+
+      break;
+    }
+  }
+
+Exit:
+  if (TimerEvent != NULL) {
+    gBS->CloseEvent (TimerEvent);
+  }
+
+  if (Token != NULL) {
+    gBS->CloseEvent (Token->Event);
+    FreePool (Token);
+  }
+
+  return Status;
+}
+
 /**
   Reset the Block Device.
 
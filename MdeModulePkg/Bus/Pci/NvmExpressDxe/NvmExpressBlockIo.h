@@ -9,6 +9,33 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #ifndef _EFI_NVME_BLOCKIO_H_
 #define _EFI_NVME_BLOCKIO_H_
 
+/**
+  Read or write some blocks through the asynchronous I/O queues, and wait for
+  the transfer to complete.
+
+  The transfer is split into commands of the maximum data transfer size, which
+  are kept in flight on the asynchronous I/O queues.
+
+  @param  Device                 The pointer to the NVME_DEVICE_PRIVATE_DATA data structure.
+  @param  Buffer                 The buffer of the data.
+  @param  Lba                    The start block number.
+  @param  Blocks                 Total block number to be transferred.
+  @param  IsWrite                TRUE to write the blocks, FALSE to read them.
+
+  @retval EFI_SUCCESS            Datum are transferred.
+  @retval EFI_TIMEOUT            The transfer timed out, and the controller was reset.
+  @retval Others                 Fail to transfer all the datum.
+
+**/
+EFI_STATUS
+NvmeAsyncQueueTransfer (
+  IN     NVME_DEVICE_PRIVATE_DATA  *Device,
+  IN OUT VOID                      *Buffer,
+  IN     UINT64                    Lba,
+  IN     UINTN                     Blocks,
+  IN     BOOLEAN                   IsWrite
+  );
+
 /**
   Reset the Block Device.
 
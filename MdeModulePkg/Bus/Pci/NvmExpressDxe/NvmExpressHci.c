@@ -589,7 +589,7 @@ NvmeCreateIoCompletionQueue (
   Status                 = EFI_SUCCESS;
   Private->CreateIoQueue = TRUE;
 
-  for (Index = 1; Index < NVME_MAX_QUEUES; Index++) {
+  for (Index = 1; Index < NVME_ASYNC_IO_QUEUE_ID + Private->AsyncQueueCount; Index++) {
     ZeroMem (&CommandPacket, sizeof (EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET));
     ZeroMem (&Command, sizeof (EFI_NVM_EXPRESS_COMMAND));
     ZeroMem (&Completion, sizeof (EFI_NVM_EXPRESS_COMPLETION));
@@ -607,11 +607,7 @@ NvmeCreateIoCompletionQueue (
     if (Index == 1) {
       QueueSize = NVME_CCQ_SIZE;
     } else {
-      if (Private->Cap.Mqes > NVME_ASYNC_CCQ_SIZE) {
-        QueueSize = NVME_ASYNC_CCQ_SIZE;
-      } else {
-        QueueSize = Private->Cap.Mqes;
-      }
+      QueueSize = Private->AsyncQueueDepth - 1;
     }
 
     CrIoCq.Qid   = Index;
@@ -661,7 +657,7 @@ NvmeCreateIoSubmissionQueue (
   Status                 = EFI_SUCCESS;
   Private->CreateIoQueue = TRUE;
 
-  for (Index = 1; Index < NVME_MAX_QUEUES; Index++) {
+  for (Index = 1; Index < NVME_ASYNC_IO_QUEUE_ID + Private->AsyncQueueCount; Index++) {
     ZeroMem (&CommandPacket, sizeof (EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET));
     ZeroMem (&Command, sizeof (EFI_NVM_EXPRESS_COMMAND));
     ZeroMem (&Completion, sizeof (EFI_NVM_EXPRESS_COMPLETION));
@@ -679,11 +675,7 @@ NvmeCreateIoSubmissionQueue (
     if (Index == 1) {
       QueueSize = NVME_CSQ_SIZE;
     } else {
-      if (Private->Cap.Mqes > NVME_ASYNC_CSQ_SIZE) {
-        QueueSize = NVME_ASYNC_CSQ_SIZE;
-      } else {
-        QueueSize = Private->Cap.Mqes;
-      }
+      QueueSize = Private->AsyncQueueDepth - 1;
     }
 
     CrIoSq.Qid   = Index;
@@ -710,6 +702,64 @@ NvmeCreateIoSubmissionQueue (
   return Status;
 }
 
+/**
+  Request the number of I/O queues of the driver with the Number of Queues
+  feature.
+
+  @param  Private          The pointer to the NVME_CONTROLLER_PRIVATE_DATA data structure.
+  @param  IoQueues         On input, the number of I/O submission and completion
+                           queues to request. On output, the number of I/O
+                           queue pairs the controller allocated.
+
+  @return EFI_SUCCESS      Successfully set the number of queues.
+  @return Others           Fail to set the number of queues.
+
+**/
+EFI_STATUS
+NvmeSetNumberOfQueues (
+  IN     NVME_CONTROLLER_PRIVATE_DATA  *Private,
+  IN OUT UINT16                        *IoQueues
+  )
+{
+  EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET  CommandPacket;
+  EFI_NVM_EXPRESS_COMMAND                   Command;
+  EFI_NVM_EXPRESS_COMPLETION                Completion;
+  EFI_STATUS                                Status;
+  NVME_ADMIN_SET_FEATURES                   SetFeatures;
+
+  ZeroMem (&CommandPacket, sizeof (EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET));
+  ZeroMem (&Command, sizeof (EFI_NVM_EXPRESS_COMMAND));
+  ZeroMem (&Completion, sizeof (EFI_NVM_EXPRESS_COMPLETION));
+  ZeroMem (&SetFeatures, sizeof (NVME_ADMIN_SET_FEATURES));
+
+  CommandPacket.NvmeCmd        = &Command;
+  CommandPacket.NvmeCompletion = &Completion;
+
+  Command.Cdw0.Opcode          = NVME_ADMIN_SET_FEATURES_CMD;
+  CommandPacket.CommandTimeout = NVME_GENERIC_TIMEOUT;
+  CommandPacket.QueueType      = NVME_ADMIN_QUEUE;
+
+  SetFeatures.Fid = NVME_FEATURE_NUMBER_OF_QUEUES;
+  CopyMem (&CommandPacket.NvmeCmd->Cdw10, &SetFeatures, sizeof (NVME_ADMIN_SET_FEATURES));
+  //
+  // The number of submission and completion queues are 0-based.
+  //
+  CommandPacket.NvmeCmd->Cdw11 = (UINT32)(*IoQueues - 1) | ((UINT32)(*IoQueues - 1) << 16);
+  CommandPacket.NvmeCmd->Flags = CDW10_VALID | CDW11_VALID;
+
+  Status = Private->Passthru.PassThru (
+                               &Private->Passthru,
+                               0,
+                               &CommandPacket,
+                               NULL
+                               );
+  if (!EFI_ERROR (Status)) {
+    *IoQueues = (UINT16)(MIN (Completion.DW0 & 0xFFFF, Completion.DW0 >> 16) + 1);
+  }
+
+  return Status;
+}
+
 /**
   Initialize the Nvm Express controller.
 
@@ -732,6 +782,11 @@ NvmeControllerInit (
   NVME_ACQ             Acq;
   UINT8                Sn[21];
   UINT8                Mn[41];
+  UINT16               Index;
+  UINT16               IoQueues;
+  UINTN                Offset;
+  UINTN                SqPages;
+  UINTN                CqPages;
 
   //
   // Enable this controller.
@@ -777,19 +832,17 @@ NvmeControllerInit (
   //
   ASSERT ((Private->Cap.Mpsmin + 12) <= EFI_PAGE_SHIFT);
 
-  Private->Cid[0]        = 0;
-  Private->Cid[1]        = 0;
-  Private->Cid[2]        = 0;
-  Private->Pt[0]         = 0;
-  Private->Pt[1]         = 0;
-  Private->Pt[2]         = 0;
-  Private->SqTdbl[0].Sqt = 0;
-  Private->SqTdbl[1].Sqt = 0;
-  Private->SqTdbl[2].Sqt = 0;
-  Private->CqHdbl[0].Cqh = 0;
-  Private->CqHdbl[1].Cqh = 0;
-  Private->CqHdbl[2].Cqh = 0;
-  Private->AsyncSqHead   = 0;
+  for (Index = 0; Index < NVME_MAX_QUEUES; Index++) {
+    Private->Cid[Index]        = 0;
+    Private->Pt[Index]         = 0;
+    Private->SqTdbl[Index].Sqt = 0;
+    Private->CqHdbl[Index].Cqh = 0;
+  }
+
+  //
+  // The asynchronous I/O queues cannot have more entries than CAP.MQES allows.
+  //
+  Private->AsyncQueueDepth = (UINT16)MIN (Private->AsyncQueueDepth, (UINT32)Private->Cap.Mqes + 1);
 
   Status = NvmeDisableController (Private);
 
@@ -818,19 +871,26 @@ NvmeControllerInit (
   //
   // Address of I/O submission & completion queue.
   //
-  ZeroMem (Private->Buffer, EFI_PAGES_TO_SIZE (6));
-  Private->SqBuffer[0]        = (NVME_SQ *)(UINTN)(Private->Buffer);
-  Private->SqBufferPciAddr[0] = (NVME_SQ *)(UINTN)(Private->BufferPciAddr);
-  Private->CqBuffer[0]        = (NVME_CQ *)(UINTN)(Private->Buffer + 1 * EFI_PAGE_SIZE);
-  Private->CqBufferPciAddr[0] = (NVME_CQ *)(UINTN)(Private->BufferPciAddr + 1 * EFI_PAGE_SIZE);
-  Private->SqBuffer[1]        = (NVME_SQ *)(UINTN)(Private->Buffer + 2 * EFI_PAGE_SIZE);
-  Private->SqBufferPciAddr[1] = (NVME_SQ *)(UINTN)(Private->BufferPciAddr + 2 * EFI_PAGE_SIZE);
-  Private->CqBuffer[1]        = (NVME_CQ *)(UINTN)(Private->Buffer + 3 * EFI_PAGE_SIZE);
-  Private->CqBufferPciAddr[1] = (NVME_CQ *)(UINTN)(Private->BufferPciAddr + 3 * EFI_PAGE_SIZE);
-  Private->SqBuffer[2]        = (NVME_SQ *)(UINTN)(Private->Buffer + 4 * EFI_PAGE_SIZE);
-  Private->SqBufferPciAddr[2] = (NVME_SQ *)(UINTN)(Private->BufferPciAddr + 4 * EFI_PAGE_SIZE);
-  Private->CqBuffer[2]        = (NVME_CQ *)(UINTN)(Private->Buffer + 5 * EFI_PAGE_SIZE);
-  Private->CqBufferPciAddr[2] = (NVME_CQ *)(UINTN)(Private->BufferPciAddr + 5 * EFI_PAGE_SIZE);
+  ZeroMem (Private->Buffer, EFI_PAGES_TO_SIZE (Private->BufferPages));
+  Offset = 0;
+  for (Index = 0; Index < NVME_ASYNC_IO_QUEUE_ID + Private->AsyncQueueCount; Index++) {
+    if (Index < NVME_ASYNC_IO_QUEUE_ID) {
+      SqPages = 1;
+      CqPages = 1;
+    } else {
+      SqPages = EFI_SIZE_TO_PAGES (Private->AsyncQueueDepth * sizeof (NVME_SQ));
+      CqPages = EFI_SIZE_TO_PAGES (Private->AsyncQueueDepth * sizeof (NVME_CQ));
+    }
+
+    Private->SqBuffer[Index]        = (NVME_SQ *)(UINTN)(Private->Buffer + Offset);
+    Private->SqBufferPciAddr[Index] = (NVME_SQ *)(UINTN)(Private->BufferPciAddr + Offset);
+    Offset                         += EFI_PAGES_TO_SIZE (SqPages);
+    Private->CqBuffer[Index]        = (NVME_CQ *)(UINTN)(Private->Buffer + Offset);
+    Private->CqBufferPciAddr[Index] = (NVME_CQ *)(UINTN)(Private->BufferPciAddr + Offset);
+    Offset                         += EFI_PAGES_TO_SIZE (CqPages);
+  }
+
+  ASSERT (Offset <= EFI_PAGES_TO_SIZE (Private->BufferPages));
 
   DEBUG ((DEBUG_INFO, "Private->Buffer = [%016X]\n", (UINT64)(UINTN)Private->Buffer));
   DEBUG ((DEBUG_INFO, "Admin     Submission Queue size (Aqa.Asqs) = [%08X]\n", Aqa.Asqs));
@@ -839,8 +899,12 @@ NvmeControllerInit (
   DEBUG ((DEBUG_INFO, "Admin     Completion Queue (CqBuffer[0]) = [%016X]\n", Private->CqBuffer[0]));
   DEBUG ((DEBUG_INFO, "Sync  I/O Submission Queue (SqBuffer[1]) = [%016X]\n", Private->SqBuffer[1]));
   DEBUG ((DEBUG_INFO, "Sync  I/O Completion Queue (CqBuffer[1]) = [%016X]\n", Private->CqBuffer[1]));
-  DEBUG ((DEBUG_INFO, "Async I/O Submission Queue (SqBuffer[2]) = [%016X]\n", Private->SqBuffer[2]));
-  DEBUG ((DEBUG_INFO, "Async I/O Completion Queue (CqBuffer[2]) = [%016X]\n", Private->CqBuffer[2]));
+  for (Index = NVME_ASYNC_IO_QUEUE_ID; Index < NVME_ASYNC_IO_QUEUE_ID + Private->AsyncQueueCount; Index++) {
+    DEBUG ((DEBUG_INFO, "Async I/O Submission Queue (SqBuffer[%u]) = [%016lX]\n", (UINT32)Index, (UINT64)(UINTN)Private->SqBuffer[Index]));
+    DEBUG ((DEBUG_INFO, "Async I/O Completion Queue (CqBuffer[%u]) = [%016lX]\n", (UINT32)Index, (UINT64)(UINTN)Private->CqBuffer[Index]));
+  }
+
+  DEBUG ((DEBUG_INFO, "Async I/O Queue entries = [%u]\n", (UINT32)Private->AsyncQueueDepth));
 
   //
   // Program admin queue attributes.
@@ -919,8 +983,24 @@ NvmeControllerInit (
   DEBUG ((DEBUG_INFO, "    NN        : 0x%x\n", Private->ControllerData->Nn));
 
   //
-  // Create two I/O completion queues.
-  // One for blocking I/O, one for non-blocking I/O.
+  // Request one I/O queue pair for blocking I/O and the asynchronous I/O queue
+  // pairs, and only create as many asynchronous I/O queue pairs as the
+  // controller allocates. At least one is created, as the controllers that
+  // fail the request accept the creation of two I/O queue pairs.
+  //
+  IoQueues = 1 + Private->AsyncQueueCount;
+  Status   = NvmeSetNumberOfQueues (Private, &IoQueues);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "NvmeControllerInit: failed to set the number of queues (%r)\n", Status));
+    IoQueues = 2;
+  }
+
+  Private->AsyncQueueCount = (UINT16)MIN (Private->AsyncQueueCount, MAX (IoQueues, 2) - 1);
+  DEBUG ((DEBUG_INFO, "Async I/O Queue pairs = [%u]\n", (UINT32)Private->AsyncQueueCount));
+
+  //
+  // Create the I/O completion queues.
+  // One for blocking I/O, the others for non-blocking I/O.
   //
   Status = NvmeCreateIoCompletionQueue (Private);
   if (EFI_ERROR (Status)) {
@@ -928,12 +1008,26 @@ NvmeControllerInit (
   }
 
   //
-  // Create two I/O Submission queues.
-  // One for blocking I/O, one for non-blocking I/O.
+  // Create the I/O Submission queues.
+  // One for blocking I/O, the others for non-blocking I/O.
   //
   Status = NvmeCreateIoSubmissionQueue (Private);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
-  return Status;
+  //
+  // The PRP list pool is sized after the maximum data transfer size, and is
+  // kept across resets of the controller. The commands allocate their PRP
+  // lists when it cannot be created.
+  //
+  if (Private->PrpListPool == NULL) {
+    if (EFI_ERROR (NvmeCreatePrpListPool (Private))) {
+      DEBUG ((DEBUG_WARN, "NvmeControllerInit: failed to create the PRP list pool\n"));
+    }
+  }
+
+  return EFI_SUCCESS;
 }
 
 /**
@@ -314,6 +314,250 @@ EXIT:
   return NULL;
 }
 
+/**
+  Create the pool of PRP lists of the I/O commands.
+
+  The size of the PRP lists is the smallest power of two that holds the PRP
+  entries of a transfer of the maximum data transfer size of the controller.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+  @retval EFI_SUCCESS           The pool was created.
+  @retval EFI_OUT_OF_RESOURCES  The pool could not be allocated.
+
+**/
+EFI_STATUS
+NvmeCreatePrpListPool (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  )
+{
+  EFI_PCI_IO_PROTOCOL  *PciIo;
+  UINT32               SlotSize;
+  UINTN                Slots;
+  UINTN                Pages;
+  UINTN                Bytes;
+  UINTN                Index;
+  EFI_STATUS           Status;
+
+  PciIo = Private->PciIo;
+
+  //
+  // A transfer of 2^MDTS pages needs at most 2^MDTS PRP entries. The PRP lists
+  // are one page long when the maximum data transfer size is not reported or
+  // needs more entries than a page holds.
+  //
+  SlotSize = EFI_PAGE_SIZE;
+  if ((Private->ControllerData->Mdts != 0) &&
+      (Private->ControllerData->Mdts + Private->Cap.Mpsmin < 9))
+  {
+    SlotSize = sizeof (UINT64) << (Private->ControllerData->Mdts + Private->Cap.Mpsmin);
+  }
+
+  //
+  // One PRP list for each entry of the asynchronous I/O queues and one for the
+  // blocking I/O queue.
+  //
+  Slots = Private->AsyncQueueCount * Private->AsyncQueueDepth + 1;
+  Pages = EFI_SIZE_TO_PAGES (Slots * SlotSize);
+
+  Private->PrpListFreeSlots = AllocatePool (Slots * sizeof (UINT16));
+  if (Private->PrpListFreeSlots == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = PciIo->AllocateBuffer (
+                    PciIo,
+                    AllocateAnyPages,
+                    EfiBootServicesData,
+                    Pages,
+                    (VOID **)&Private->PrpListPool,
+                    0
+                    );
+  if (EFI_ERROR (Status)) {
+    Private->PrpListPool = NULL;
+    NvmeFreePrpListPool (Private);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Private->PrpListPoolPages = Pages;
+
+  Bytes  = EFI_PAGES_TO_SIZE (Pages);
+  Status = PciIo->Map (
+                    PciIo,
+                    EfiPciIoOperationBusMasterCommonBuffer,
+                    Private->PrpListPool,
+                    &Bytes,
+                    &Private->PrpListPoolPciAddr,
+                    &Private->PrpListPoolMapping
+                    );
+  if (EFI_ERROR (Status) || (Bytes != EFI_PAGES_TO_SIZE (Pages))) {
+    if (EFI_ERROR (Status)) {
+      Private->PrpListPoolMapping = NULL;
+    }
+
+    NvmeFreePrpListPool (Private);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ZeroMem (Private->PrpListPool, EFI_PAGES_TO_SIZE (Pages));
+  for (Index = 0; Index < Slots; Index++) {
+    Private->PrpListFreeSlots[Index] = (UINT16)(Slots - 1 - Index);
+  }
+
+  Private->PrpListSlotSize      = SlotSize;
+  Private->PrpListFreeSlotCount = (UINT16)Slots;
+
+  DEBUG ((DEBUG_INFO, "PRP list pool = [%016lX], %u lists of %u bytes\n", Private->PrpListPoolPciAddr, (UINT32)Slots, (UINT32)SlotSize));
+  return EFI_SUCCESS;
+}
+
+/**
+  Free the pool of PRP lists of the I/O commands.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+**/
+VOID
+NvmeFreePrpListPool (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  )
+{
+  if (Private->PrpListPoolMapping != NULL) {
+    Private->PciIo->Unmap (Private->PciIo, Private->PrpListPoolMapping);
+    Private->PrpListPoolMapping = NULL;
+  }
+
+  if (Private->PrpListPool != NULL) {
+    Private->PciIo->FreeBuffer (Private->PciIo, Private->PrpListPoolPages, Private->PrpListPool);
+    Private->PrpListPool = NULL;
+  }
+
+  if (Private->PrpListFreeSlots != NULL) {
+    FreePool (Private->PrpListFreeSlots);
+    Private->PrpListFreeSlots = NULL;
+  }
+
+  Private->PrpListFreeSlotCount = 0;
+}
+
+/**
+  Take a PRP list from the PRP list pool, and fill it for a data transfer.
+
+  @param[in]     Private             The pointer to the NVME_CONTROLLER_PRIVATE_DATA data structure.
+  @param[in]     PhysicalAddr        The physical base address of data buffer.
+  @param[in]     Pages               The number of pages to be transfered.
+  @param[out]    PrpListSlot         The slot of the PRP list in the pool.
+
+  @return The bus master address of the PRP list, or NULL if the pool has no
+          PRP list that is free or large enough.
+
+**/
+VOID *
+NvmeGetPrpListFromPool (
+  IN     NVME_CONTROLLER_PRIVATE_DATA  *Private,
+  IN     EFI_PHYSICAL_ADDRESS          PhysicalAddr,
+  IN     UINTN                         Pages,
+  OUT UINT16                           *PrpListSlot
+  )
+{
+  UINT64   *PrpList;
+  UINTN    Index;
+  EFI_TPL  OldTpl;
+
+  if ((Private->PrpListPool == NULL) ||
+      (Pages > Private->PrpListSlotSize / sizeof (UINT64)))
+  {
+    return NULL;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  if (Private->PrpListFreeSlotCount == 0) {
+    gBS->RestoreTPL (OldTpl);
+    return NULL;
+  }
+
+  *PrpListSlot = Private->PrpListFreeSlots[--Private->PrpListFreeSlotCount];
+  gBS->RestoreTPL (OldTpl);
+
+  PrpList = (UINT64 *)(Private->PrpListPool + (UINTN)*PrpListSlot * Private->PrpListSlotSize);
+  for (Index = 0; Index < Pages; Index++) {
+    PrpList[Index] = PhysicalAddr;
+    PhysicalAddr  += EFI_PAGE_SIZE;
+  }
+
+  return (VOID *)(UINTN)(Private->PrpListPoolPciAddr + (UINTN)*PrpListSlot * Private->PrpListSlotSize);
+}
+
+/**
+  Return a PRP list to the PRP list pool.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+  @param[in] PrpListSlot    The slot of the PRP list in the pool.
+
+**/
+VOID
+NvmeFreePrpListSlot (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private,
+  IN UINT16                        PrpListSlot
+  )
+{
+  EFI_TPL  OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  Private->PrpListFreeSlots[Private->PrpListFreeSlotCount++] = PrpListSlot;
+  gBS->RestoreTPL (OldTpl);
+}
+
+/**
+  Free the resources of an asynchronous PassThru request that were allocated
+  before its submission, and release its entry of the asynchronous I/O queue.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+  @param[in] AsyncRequest   The asynchronous PassThru request.
+
+**/
+VOID
+NvmeReleaseAsyncPassThruRequest (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private,
+  IN NVME_PASS_THRU_ASYNC_REQ      *AsyncRequest
+  )
+{
+  EFI_PCI_IO_PROTOCOL  *PciIo;
+
+  PciIo = Private->PciIo;
+
+  if (AsyncRequest->MapData != NULL) {
+    PciIo->Unmap (PciIo, AsyncRequest->MapData);
+  }
+
+  if (AsyncRequest->MapMeta != NULL) {
+    PciIo->Unmap (PciIo, AsyncRequest->MapMeta);
+  }
+
+  if (AsyncRequest->MapPrpList != NULL) {
+    PciIo->Unmap (PciIo, AsyncRequest->MapPrpList);
+  }
+
+  if (AsyncRequest->PrpListHost != NULL) {
+    PciIo->FreeBuffer (
+             PciIo,
+             AsyncRequest->PrpListNo,
+             AsyncRequest->PrpListHost
+             );
+  }
+
+  if (AsyncRequest->PrpListSlot != NVME_PRP_LIST_SLOT_NONE) {
+    NvmeFreePrpListSlot (Private, AsyncRequest->PrpListSlot);
+  }
+
+  ASSERT (Private->OutstandingCmds[AsyncRequest->QueueId] != 0);
+  Private->OutstandingCmds[AsyncRequest->QueueId]--;
+}
+
 /**
   Aborts the asynchronous PassThru requests.
 
@@ -329,7 +573,6 @@ AbortAsyncPassThruTasks (
   IN NVME_CONTROLLER_PRIVATE_DATA  *Private
   )
 {
-  EFI_PCI_IO_PROTOCOL       *PciIo;
   LIST_ENTRY                *Link;
   LIST_ENTRY                *NextLink;
   NVME_BLKIO2_SUBTASK       *Subtask;
@@ -339,7 +582,6 @@ AbortAsyncPassThruTasks (
   EFI_TPL                   OldTpl;
   EFI_STATUS                Status;
 
-  PciIo  = Private->PciIo;
   OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
 
   //
@@ -376,25 +618,7 @@ AbortAsyncPassThruTasks (
     NextLink     = GetNextNode (&Private->AsyncPassThruQueue, Link);
     AsyncRequest = NVME_PASS_THRU_ASYNC_REQ_FROM_THIS (Link);
 
-    if (AsyncRequest->MapData != NULL) {
-      PciIo->Unmap (PciIo, AsyncRequest->MapData);
-    }
-
-    if (AsyncRequest->MapMeta != NULL) {
-      PciIo->Unmap (PciIo, AsyncRequest->MapMeta);
-    }
-
-    if (AsyncRequest->MapPrpList != NULL) {
-      PciIo->Unmap (PciIo, AsyncRequest->MapPrpList);
-    }
-
-    if (AsyncRequest->PrpListHost != NULL) {
-      PciIo->FreeBuffer (
-               PciIo,
-               AsyncRequest->PrpListNo,
-               AsyncRequest->PrpListHost
-               );
-    }
+    NvmeReleaseAsyncPassThruRequest (Private, AsyncRequest);
 
     RemoveEntryList (Link);
     gBS->SignalEvent (AsyncRequest->CallerEvent);
@@ -414,6 +638,60 @@ AbortAsyncPassThruTasks (
   return Status;
 }
 
+/**
+  Reset the controller after an NVMe command timed out, and abort the
+  asynchronous requests.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+  @retval EFI_TIMEOUT       The controller was reset and the asynchronous
+                            requests were aborted.
+  @retval Others            The controller could not be recovered.
+
+**/
+EFI_STATUS
+NvmeRecoverFromTimeout (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  )
+{
+  EFI_STATUS  Status;
+
+  //
+  // Disable the timer to trigger the process of async transfers temporarily.
+  //
+  Status = gBS->SetTimer (Private->TimerEvent, TimerCancel, 0);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Reset the NVMe controller.
+  //
+  Status = NvmeControllerInit (Private);
+  if (EFI_ERROR (Status)) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  Status = AbortAsyncPassThruTasks (Private);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Re-enable the timer to trigger the process of async transfers.
+  //
+  Status = gBS->SetTimer (Private->TimerEvent, TimerPeriodic, NVME_HC_ASYNC_TIMER);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Return EFI_TIMEOUT to indicate a timeout occurs for NVMe PassThru command.
+  //
+  return EFI_TIMEOUT;
+}
+
 /**
   Sends an NVM Express Command Packet to an NVM Express controller or namespace. This function supports
   both blocking I/O and non-blocking I/O. The blocking I/O functionality is required, and the non-blocking
@@ -475,6 +753,8 @@ NvmExpressPassThru (
   UINT64                         *Prp;
   VOID                           *PrpListHost;
   UINTN                          PrpListNo;
+  UINT16                         PrpListSlot;
+  UINT16                         Index;
   UINT32                         Attributes;
   UINT32                         IoAlign;
   UINT32                         MaxTransLen;
@@ -550,10 +830,11 @@ NvmExpressPassThru (
   MapPrpList  = NULL;
   PrpListHost = NULL;
   PrpListNo   = 0;
+  PrpListSlot = NVME_PRP_LIST_SLOT_NONE;
   Prp         = NULL;
   TimerEvent  = NULL;
   Status      = EFI_SUCCESS;
-  QueueSize   = MIN (NVME_ASYNC_CSQ_SIZE, Private->Cap.Mqes) + 1;
+  QueueSize   = Private->AsyncQueueDepth;
 
   if (Packet->QueueType == NVME_ADMIN_QUEUE) {
     QueueId = 0;
@@ -561,14 +842,21 @@ NvmExpressPassThru (
     if (Event == NULL) {
       QueueId = 1;
     } else {
-      QueueId = 2;
+      //
+      // Use the asynchronous I/O queue with the fewest outstanding commands.
+      //
+      QueueId = NVME_ASYNC_IO_QUEUE_ID;
+      for (Index = NVME_ASYNC_IO_QUEUE_ID + 1; Index < NVME_ASYNC_IO_QUEUE_ID + Private->AsyncQueueCount; Index++) {
+        if (Private->OutstandingCmds[Index] < Private->OutstandingCmds[QueueId]) {
+          QueueId = Index;
+        }
+      }
 
       //
-      // Submission queue full check.
+      // Submission queue full check. One entry is kept free so that neither
+      // the submission queue nor the completion queue can be full.
       //
-      if ((Private->SqTdbl[QueueId].Sqt + 1) % QueueSize ==
-          Private->AsyncSqHead)
-      {
+      if (Private->OutstandingCmds[QueueId] >= QueueSize - 1) {
         return EFI_NOT_READY;
       }
     }
@@ -677,10 +965,18 @@ NvmExpressPassThru (
 
   if ((Offset + Bytes) > (EFI_PAGE_SIZE * 2)) {
     //
-    // Create PrpList for remaining data buffer.
+    // Create PrpList for remaining data buffer. The I/O commands take it from
+    // the PRP list pool when one is free and large enough.
     //
     PhyAddr = (Sq->Prp[0] + EFI_PAGE_SIZE) & ~(EFI_PAGE_SIZE - 1);
-    Prp     = NvmeCreatePrpList (PciIo, PhyAddr, EFI_SIZE_TO_PAGES (Offset + Bytes) - 1, &PrpListHost, &PrpListNo, &MapPrpList);
+    if (QueueId != 0) {
+      Prp = NvmeGetPrpListFromPool (Private, PhyAddr, EFI_SIZE_TO_PAGES (Offset + Bytes) - 1, &PrpListSlot);
+    }
+
+    if (Prp == NULL) {
+      Prp = NvmeCreatePrpList (PciIo, PhyAddr, EFI_SIZE_TO_PAGES (Offset + Bytes) - 1, &PrpListHost, &PrpListNo, &MapPrpList);
+    }
+
     if (Prp == NULL) {
       Status = EFI_OUT_OF_RESOURCES;
       goto EXIT;
@@ -723,6 +1019,36 @@ NvmExpressPassThru (
     Sq->Payload.Raw.Cdw15 = Packet->NvmeCmd->Cdw15;
   }
 
+  //
+  // Queue the non-blocking requests before ringing the doorbell, so that the
+  // completion of the command always finds its request.
+  //
+  AsyncRequest = NULL;
+  if ((Event != NULL) && (QueueId != 0)) {
+    AsyncRequest = AllocateZeroPool (sizeof (NVME_PASS_THRU_ASYNC_REQ));
+    if (AsyncRequest == NULL) {
+      Status = EFI_DEVICE_ERROR;
+      goto EXIT;
+    }
+
+    AsyncRequest->Signature   = NVME_PASS_THRU_ASYNC_REQ_SIG;
+    AsyncRequest->Packet      = Packet;
+    AsyncRequest->QueueId     = QueueId;
+    AsyncRequest->CommandId   = Sq->Cid;
+    AsyncRequest->CallerEvent = Event;
+    AsyncRequest->MapData     = MapData;
+    AsyncRequest->MapMeta     = MapMeta;
+    AsyncRequest->MapPrpList  = MapPrpList;
+    AsyncRequest->PrpListNo   = PrpListNo;
+    AsyncRequest->PrpListHost = PrpListHost;
+    AsyncRequest->PrpListSlot = PrpListSlot;
+
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    InsertTailList (&Private->AsyncPassThruQueue, &AsyncRequest->Link);
+    Private->OutstandingCmds[QueueId]++;
+    gBS->RestoreTPL (OldTpl);
+  }
+
   //
   // Ring the submission queue doorbell.
   //
@@ -744,6 +1070,14 @@ NvmExpressPassThru (
                         );
 
   if (EFI_ERROR (Status)) {
+    if (AsyncRequest != NULL) {
+      OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+      RemoveEntryList (&AsyncRequest->Link);
+      Private->OutstandingCmds[QueueId]--;
+      gBS->RestoreTPL (OldTpl);
+      FreePool (AsyncRequest);
+    }
+
     goto EXIT;
   }
 
@@ -751,27 +1085,7 @@ NvmExpressPassThru (
   // For non-blocking requests, return directly if the command is placed
   // in the submission queue.
   //
-  if ((Event != NULL) && (QueueId != 0)) {
-    AsyncRequest = AllocateZeroPool (sizeof (NVME_PASS_THRU_ASYNC_REQ));
-    if (AsyncRequest == NULL) {
-      Status = EFI_DEVICE_ERROR;
-      goto EXIT;
-    }
-
-    AsyncRequest->Signature   = NVME_PASS_THRU_ASYNC_REQ_SIG;
-    AsyncRequest->Packet      = Packet;
-    AsyncRequest->CommandId   = Sq->Cid;
-    AsyncRequest->CallerEvent = Event;
-    AsyncRequest->MapData     = MapData;
-    AsyncRequest->MapMeta     = MapMeta;
-    AsyncRequest->MapPrpList  = MapPrpList;
-    AsyncRequest->PrpListNo   = PrpListNo;
-    AsyncRequest->PrpListHost = PrpListHost;
-
-    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
-    InsertTailList (&Private->AsyncPassThruQueue, &AsyncRequest->Link);
-    gBS->RestoreTPL (OldTpl);
-
+  if (AsyncRequest != NULL) {
     return EFI_SUCCESS;
   }
 
@@ -832,36 +1146,7 @@ NvmExpressPassThru (
     //
     DEBUG ((DEBUG_ERROR, "NvmExpressPassThru: Timeout occurs for an NVMe command.\n"));
 
-    //
-    // Disable the timer to trigger the process of async transfers temporarily.
-    //
-    Status = gBS->SetTimer (Private->TimerEvent, TimerCancel, 0);
-    if (EFI_ERROR (Status)) {
-      goto EXIT;
-    }
-
-    //
-    // Reset the NVMe controller.
-    //
-    Status = NvmeControllerInit (Private);
-    if (!EFI_ERROR (Status)) {
-      Status = AbortAsyncPassThruTasks (Private);
-      if (!EFI_ERROR (Status)) {
-        //
-        // Re-enable the timer to trigger the process of async transfers.
-        //
-        Status = gBS->SetTimer (Private->TimerEvent, TimerPeriodic, NVME_HC_ASYNC_TIMER);
-        if (!EFI_ERROR (Status)) {
-          //
-          // Return EFI_TIMEOUT to indicate a timeout occurs for NVMe PassThru command.
-          //
-          Status = EFI_TIMEOUT;
-        }
-      }
-    } else {
-      Status = EFI_DEVICE_ERROR;
-    }
-
+    Status = NvmeRecoverFromTimeout (Private);
     goto EXIT;
   }
 
@@ -914,7 +1199,9 @@ EXIT:
              );
   }
 
-  if (Prp != NULL) {
+  if (PrpListSlot != NVME_PRP_LIST_SLOT_NONE) {
+    NvmeFreePrpListSlot (Private, PrpListSlot);
+  } else if (Prp != NULL) {
     PciIo->FreeBuffer (PciIo, PrpListNo, PrpListHost);
   }
 
@@ -0,0 +1,803 @@
+/** @file
+  Host based unit tests of the asynchronous I/O queues and of the PRP list pool
+  of the NvmExpress driver.
+
+  The controller is emulated by a PCI I/O protocol whose DMA mappings are the
+  identity, and whose doorbell writes are recorded. The tests submit commands
+  with NvmExpressPassThru() and check the queue each command is placed in, the
+  PRP list it uses, and the resources its completion releases.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../NvmExpress.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_APP_NAME     "NvmExpress Queue Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_QUEUE_COUNT   3
+#define TEST_QUEUE_DEPTH   4
+#define TEST_MDTS          5
+#define TEST_NAMESPACE_ID  1
+#define TEST_SLOT_COUNT    (TEST_QUEUE_COUNT * TEST_QUEUE_DEPTH + 1)
+#define TEST_COMMANDS      (TEST_QUEUE_COUNT * (TEST_QUEUE_DEPTH - 1))
+#define TEST_BUFFER_PAGES  8
+
+typedef struct {
+  EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET    Packet;
+  EFI_NVM_EXPRESS_COMMAND                     Command;
+  EFI_NVM_EXPRESS_COMPLETION                  Completion;
+} TEST_COMMAND;
+
+typedef struct {
+  NVME_CONTROLLER_PRIVATE_DATA    Private;
+  NVME_ADMIN_CONTROLLER_DATA      ControllerData;
+  EFI_PCI_IO_PROTOCOL             PciIo;
+  TEST_COMMAND                    Commands[TEST_COMMANDS + 1];
+  VOID                            *Buffer;
+  ///
+  /// PCI I/O requests of the driver.
+  ///
+  UINTN                           AllocatedPages;
+  UINTN                           Mappings;
+  UINTN                           DoorbellWrites;
+  UINT64                          DoorbellOffset;
+  UINT32                          DoorbellData;
+} TEST_CONTEXT;
+
+STATIC TEST_CONTEXT  mTestContext;
+
+///
+/// Any event, the asynchronous commands are not completed by the tests.
+///
+STATIC UINTN  mCallerEvent;
+
+/**
+  Stub of the controller initialization, which the tests never reach.
+
+  @param[in] Private  The pointer to the NVME_CONTROLLER_PRIVATE_DATA data structure.
+
+  @retval EFI_UNSUPPORTED  Always.
+**/
+EFI_STATUS
+NvmeControllerInit (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Stub of the namespace identification, which the tests never reach.
+
+  @param[in]  Private      The pointer to the NVME_CONTROLLER_PRIVATE_DATA data structure.
+  @param[in]  NamespaceId  The namespace to identify.
+  @param[out] Buffer       The buffer of the namespace data.
+
+  @retval EFI_UNSUPPORTED  Always.
+**/
+EFI_STATUS
+NvmeIdentifyNamespace (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private,
+  IN UINT32                        NamespaceId,
+  IN VOID                          *Buffer
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Allocate pages of common buffer.
+
+  @param[in]  This         The PCI I/O protocol of the test context.
+  @param[in]  Type         Unused.
+  @param[in]  MemoryType   Unused.
+  @param[in]  Pages        The number of pages to allocate.
+  @param[out] HostAddress  The allocated pages.
+  @param[in]  Attributes   Unused.
+
+  @retval EFI_SUCCESS           The pages are allocated.
+  @retval EFI_OUT_OF_RESOURCES  The pages could not be allocated.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestAllocateBuffer (
+  IN  EFI_PCI_IO_PROTOCOL  *This,
+  IN  EFI_ALLOCATE_TYPE    Type,
+  IN  EFI_MEMORY_TYPE      MemoryType,
+  IN  UINTN                Pages,
+  OUT VOID                 **HostAddress,
+  IN  UINT64               Attributes
+  )
+{
+  *HostAddress = AllocateAlignedPages (Pages, EFI_PAGE_SIZE);
+  if (*HostAddress == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  mTestContext.AllocatedPages += Pages;
+  return EFI_SUCCESS;
+}
+
+/**
+  Free pages of common buffer.
+
+  @param[in]  This         The PCI I/O protocol of the test context.
+  @param[in]  Pages        The number of pages to free.
+  @param[in]  HostAddress  The pages to free.
+
+  @retval EFI_SUCCESS  The pages are freed.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestFreeBuffer (
+  IN  EFI_PCI_IO_PROTOCOL  *This,
+  IN  UINTN                Pages,
+  IN  VOID                 *HostAddress
+  )
+{
+  ASSERT (mTestContext.AllocatedPages >= Pages);
+  mTestContext.AllocatedPages -= Pages;
+  FreeAlignedPages (HostAddress, Pages);
+  return EFI_SUCCESS;
+}
+
+/**
+  Map a buffer at its own address.
+
+  @param[in]      This           The PCI I/O protocol of the test context.
+  @param[in]      Operation      Unused.
+  @param[in]      HostAddress    The buffer to map.
+  @param[in, out] NumberOfBytes  The number of bytes to map, all of them are.
+  @param[out]     DeviceAddress  The address of the buffer.
+  @param[out]     Mapping        The mapping to unmap.
+
+  @retval EFI_SUCCESS  The buffer is mapped.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestMap (
+  IN     EFI_PCI_IO_PROTOCOL            *This,
+  IN     EFI_PCI_IO_PROTOCOL_OPERATION  Operation,
+  IN     VOID                           *HostAddress,
+  IN OUT UINTN                          *NumberOfBytes,
+  OUT    EFI_PHYSICAL_ADDRESS           *DeviceAddress,
+  OUT    VOID                           **Mapping
+  )
+{
+  *DeviceAddress = (EFI_PHYSICAL_ADDRESS)(UINTN)HostAddress;
+  *Mapping       = HostAddress;
+  mTestContext.Mappings++;
+  return EFI_SUCCESS;
+}
+
+/**
+  Unmap a buffer.
+
+  @param[in]  This     The PCI I/O protocol of the test context.
+  @param[in]  Mapping  The mapping to unmap.
+
+  @retval EFI_SUCCESS  The buffer is unmapped.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestUnmap (
+  IN  EFI_PCI_IO_PROTOCOL  *This,
+  IN  VOID                 *Mapping
+  )
+{
+  ASSERT (mTestContext.Mappings != 0);
+  mTestContext.Mappings--;
+  return EFI_SUCCESS;
+}
+
+/**
+  Record a doorbell write.
+
+  @param[in]      This         The PCI I/O protocol of the test context.
+  @param[in]      Width        The width of the write.
+  @param[in]      BarIndex     The BAR of the doorbells.
+  @param[in]      Offset       The offset of the doorbell.
+  @param[in]      Count        The number of writes.
+  @param[in, out] Buffer       The value written.
+
+  @retval EFI_SUCCESS  The write is recorded.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestMemWrite (
+  IN     EFI_PCI_IO_PROTOCOL        *This,
+  IN     EFI_PCI_IO_PROTOCOL_WIDTH  Width,
+  IN     UINT8                      BarIndex,
+  IN     UINT64                     Offset,
+  IN     UINTN                      Count,
+  IN OUT VOID                       *Buffer
+  )
+{
+  ASSERT (Width == EfiPciIoWidthUint32);
+  ASSERT (BarIndex == NVME_BAR);
+  ASSERT (Count == 1);
+  mTestContext.DoorbellWrites++;
+  mTestContext.DoorbellOffset = Offset;
+  mTestContext.DoorbellData   = *(UINT32 *)Buffer;
+  return EFI_SUCCESS;
+}
+
+/**
+  Create a controller with TEST_QUEUE_COUNT asynchronous I/O queues of
+  TEST_QUEUE_DEPTH entries, and its PRP list pool.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED                      The controller is created.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The controller could not be created.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+CreateController (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                  *TestContext;
+  NVME_CONTROLLER_PRIVATE_DATA  *Private;
+  UINT16                        QueueId;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  ZeroMem (TestContext, sizeof (*TestContext));
+
+  TestContext->PciIo.AllocateBuffer = TestAllocateBuffer;
+  TestContext->PciIo.FreeBuffer     = TestFreeBuffer;
+  TestContext->PciIo.Map            = TestMap;
+  TestContext->PciIo.Unmap          = TestUnmap;
+  TestContext->PciIo.Mem.Write      = TestMemWrite;
+
+  TestContext->ControllerData.Nn   = TEST_NAMESPACE_ID;
+  TestContext->ControllerData.Mdts = TEST_MDTS;
+
+  Private                          = &TestContext->Private;
+  Private->Signature               = NVME_CONTROLLER_PRIVATE_DATA_SIGNATURE;
+  Private->PciIo                   = &TestContext->PciIo;
+  Private->ControllerData          = &TestContext->ControllerData;
+  Private->PassThruMode.Attributes = EFI_NVM_EXPRESS_PASS_THRU_ATTRIBUTES_PHYSICAL |
+                                     EFI_NVM_EXPRESS_PASS_THRU_ATTRIBUTES_LOGICAL |
+                                     EFI_NVM_EXPRESS_PASS_THRU_ATTRIBUTES_NONBLOCKIO |
+                                     EFI_NVM_EXPRESS_PASS_THRU_ATTRIBUTES_CMD_SET_NVM;
+  Private->PassThruMode.IoAlign    = sizeof (UINTN);
+  Private->Passthru.Mode           = &Private->PassThruMode;
+  Private->Passthru.PassThru       = NvmExpressPassThru;
+  Private->AsyncQueueCount         = TEST_QUEUE_COUNT;
+  Private->AsyncQueueDepth         = TEST_QUEUE_DEPTH;
+  InitializeListHead (&Private->AsyncPassThruQueue);
+  InitializeListHead (&Private->UnsubmittedSubtasks);
+
+  for (QueueId = 0; QueueId < NVME_ASYNC_IO_QUEUE_ID + TEST_QUEUE_COUNT; QueueId++) {
+    Private->SqBuffer[QueueId] = AllocateZeroPool (TEST_QUEUE_DEPTH * sizeof (NVME_SQ));
+    Private->CqBuffer[QueueId] = AllocateZeroPool (TEST_QUEUE_DEPTH * sizeof (NVME_CQ));
+    if ((Private->SqBuffer[QueueId] == NULL) || (Private->CqBuffer[QueueId] == NULL)) {
+      return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+    }
+
+    Private->Pt[QueueId] = 1;
+  }
+
+  TestContext->Buffer = AllocateAlignedPages (TEST_BUFFER_PAGES, EFI_PAGE_SIZE);
+  if (TestContext->Buffer == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  if (EFI_ERROR (NvmeCreatePrpListPool (Private))) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Release the commands the tests left in the asynchronous I/O queues, then
+  free the PRP list pool and the queues.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+**/
+STATIC
+VOID
+EFIAPI
+FreeController (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                  *TestContext;
+  NVME_CONTROLLER_PRIVATE_DATA  *Private;
+  LIST_ENTRY                    *Link;
+  NVME_PASS_THRU_ASYNC_REQ      *AsyncRequest;
+  UINT16                        QueueId;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Private     = &TestContext->Private;
+
+  while (!IsListEmpty (&Private->AsyncPassThruQueue)) {
+    Link         = GetFirstNode (&Private->AsyncPassThruQueue);
+    AsyncRequest = NVME_PASS_THRU_ASYNC_REQ_FROM_THIS (Link);
+    NvmeReleaseAsyncPassThruRequest (Private, AsyncRequest);
+    RemoveEntryList (Link);
+    FreePool (AsyncRequest);
+  }
+
+  NvmeFreePrpListPool (Private);
+
+  for (QueueId = 0; QueueId < NVME_ASYNC_IO_QUEUE_ID + TEST_QUEUE_COUNT; QueueId++) {
+    if (Private->SqBuffer[QueueId] != NULL) {
+      FreePool (Private->SqBuffer[QueueId]);
+    }
+
+    if (Private->CqBuffer[QueueId] != NULL) {
+      FreePool (Private->CqBuffer[QueueId]);
+    }
+  }
+
+  if (TestContext->Buffer != NULL) {
+    FreeAlignedPages (TestContext->Buffer, TEST_BUFFER_PAGES);
+  }
+
+  ZeroMem (TestContext, sizeof (*TestContext));
+}
+
+/**
+  Submit an asynchronous read of the test buffer.
+
+  @param[in]  TestContext  The test context.
+  @param[in]  Command      The command to submit.
+  @param[in]  Pages        The number of pages to read.
+
+  @return The status of NvmExpressPassThru().
+**/
+STATIC
+EFI_STATUS
+TestSubmitRead (
+  IN TEST_CONTEXT  *TestContext,
+  IN TEST_COMMAND  *Command,
+  IN UINTN         Pages
+  )
+{
+  ZeroMem (Command, sizeof (*Command));
+  Command->Command.Cdw0.Opcode   = NVME_IO_READ_OPC;
+  Command->Command.Nsid          = TEST_NAMESPACE_ID;
+  Command->Command.Cdw10         = 0;
+  Command->Command.Cdw12         = (UINT32)(Pages * (EFI_PAGE_SIZE / 512) - 1);
+  Command->Command.Flags         = CDW10_VALID | CDW12_VALID;
+  Command->Packet.CommandTimeout = NVME_GENERIC_TIMEOUT;
+  Command->Packet.TransferBuffer = TestContext->Buffer;
+  Command->Packet.TransferLength = (UINT32)EFI_PAGES_TO_SIZE (Pages);
+  Command->Packet.NvmeCmd        = &Command->Command;
+  Command->Packet.NvmeCompletion = &Command->Completion;
+  Command->Packet.QueueType      = NVME_IO_QUEUE;
+
+  return NvmExpressPassThru (
+           &TestContext->Private.Passthru,
+           TEST_NAMESPACE_ID,
+           &Command->Packet,
+           (EFI_EVENT)&mCallerEvent
+           );
+}
+
+/**
+  Return the last request queued by NvmExpressPassThru().
+
+  @param[in]  TestContext  The test context.
+
+  @return The last asynchronous request.
+**/
+STATIC
+NVME_PASS_THRU_ASYNC_REQ *
+TestLastRequest (
+  IN TEST_CONTEXT  *TestContext
+  )
+{
+  return NVME_PASS_THRU_ASYNC_REQ_FROM_THIS (GetPreviousNode (&TestContext->Private.AsyncPassThruQueue, &TestContext->Private.AsyncPassThruQueue));
+}
+
+/**
+  Complete an asynchronous request as ProcessAsyncTaskList() does.
+
+  @param[in]  TestContext   The test context.
+  @param[in]  AsyncRequest  The request to complete.
+**/
+STATIC
+VOID
+TestCompleteRequest (
+  IN TEST_CONTEXT              *TestContext,
+  IN NVME_PASS_THRU_ASYNC_REQ  *AsyncRequest
+  )
+{
+  NvmeReleaseAsyncPassThruRequest (&TestContext->Private, AsyncRequest);
+  RemoveEntryList (&AsyncRequest->Link);
+  FreePool (AsyncRequest);
+}
+
+/**
+  The PRP lists of the pool hold the PRP entries of a transfer of the maximum
+  data transfer size, and there is one for each entry of the asynchronous I/O
+  queues and one for the blocking I/O queue.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+PrpListPoolSizedByMdts (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                  *TestContext;
+  NVME_CONTROLLER_PRIVATE_DATA  *Private;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Private     = &TestContext->Private;
+
+  UT_ASSERT_EQUAL (Private->PrpListSlotSize, sizeof (UINT64) << TEST_MDTS);
+  UT_ASSERT_EQUAL (Private->PrpListFreeSlotCount, TEST_SLOT_COUNT);
+  UT_ASSERT_EQUAL (Private->PrpListPoolPages, EFI_SIZE_TO_PAGES (TEST_SLOT_COUNT * (sizeof (UINT64) << TEST_MDTS)));
+  UT_ASSERT_EQUAL (TestContext->AllocatedPages, Private->PrpListPoolPages);
+  UT_ASSERT_EQUAL (TestContext->Mappings, 1);
+
+  //
+  // The PRP lists are one page long when the maximum data transfer size is
+  // not reported, or when it needs more entries than a page holds.
+  //
+  NvmeFreePrpListPool (Private);
+  UT_ASSERT_EQUAL (TestContext->AllocatedPages, 0);
+  UT_ASSERT_EQUAL (TestContext->Mappings, 0);
+
+  TestContext->ControllerData.Mdts = 0;
+  UT_ASSERT_NOT_EFI_ERROR (NvmeCreatePrpListPool (Private));
+  UT_ASSERT_EQUAL (Private->PrpListSlotSize, EFI_PAGE_SIZE);
+  UT_ASSERT_EQUAL (Private->PrpListPoolPages, TEST_SLOT_COUNT);
+  NvmeFreePrpListPool (Private);
+
+  TestContext->ControllerData.Mdts = 7;
+  Private->Cap.Mpsmin              = 2;
+  UT_ASSERT_NOT_EFI_ERROR (NvmeCreatePrpListPool (Private));
+  UT_ASSERT_EQUAL (Private->PrpListSlotSize, EFI_PAGE_SIZE);
+  NvmeFreePrpListPool (Private);
+
+  TestContext->ControllerData.Mdts = 3;
+  Private->Cap.Mpsmin              = 1;
+  UT_ASSERT_NOT_EFI_ERROR (NvmeCreatePrpListPool (Private));
+  UT_ASSERT_EQUAL (Private->PrpListSlotSize, sizeof (UINT64) << 4);
+  UT_ASSERT_EQUAL (Private->PrpListFreeSlotCount, TEST_SLOT_COUNT);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The PRP lists taken from the pool are distinct and filled page by page, the
+  pool is empty when all of them are taken, and a freed PRP list is reused.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+PrpListPoolTakeAndFree (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                  *TestContext;
+  NVME_CONTROLLER_PRIVATE_DATA  *Private;
+  UINT64                        *PrpList;
+  UINT16                        Slots[TEST_SLOT_COUNT];
+  UINT16                        Slot;
+  BOOLEAN                       Taken[TEST_SLOT_COUNT];
+  EFI_PHYSICAL_ADDRESS          Address;
+  UINTN                         Pages;
+  UINTN                         Index;
+  UINTN                         Entry;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Private     = &TestContext->Private;
+  ZeroMem (Taken, sizeof (Taken));
+
+  //
+  // A transfer needing more PRP entries than a PRP list holds is not served.
+  //
+  Slot = NVME_PRP_LIST_SLOT_NONE;
+  UT_ASSERT_TRUE (NvmeGetPrpListFromPool (Private, SIZE_1GB, (1 << TEST_MDTS) + 1, &Slot) == NULL);
+  UT_ASSERT_EQUAL (Slot, NVME_PRP_LIST_SLOT_NONE);
+  UT_ASSERT_EQUAL (Private->PrpListFreeSlotCount, TEST_SLOT_COUNT);
+
+  for (Index = 0; Index < TEST_SLOT_COUNT; Index++) {
+    Address = SIZE_1GB + MultU64x32 (Index, SIZE_1MB);
+    Pages   = 1 + Index % (1 << TEST_MDTS);
+    PrpList = NvmeGetPrpListFromPool (Private, Address, Pages, &Slots[Index]);
+    UT_ASSERT_NOT_NULL (PrpList);
+    UT_ASSERT_TRUE (Slots[Index] < TEST_SLOT_COUNT);
+    UT_ASSERT_FALSE (Taken[Slots[Index]]);
+    Taken[Slots[Index]] = TRUE;
+
+    //
+    // The DMA mapping is the identity, so the bus master address of the PRP
+    // list is its host address.
+    //
+    UT_ASSERT_EQUAL ((UINTN)PrpList, (UINTN)Private->PrpListPool + Slots[Index] * Private->PrpListSlotSize);
+    for (Entry = 0; Entry < Pages; Entry++) {
+      UT_ASSERT_EQUAL (PrpList[Entry], Address + Entry * EFI_PAGE_SIZE);
+    }
+  }
+
+  UT_ASSERT_EQUAL (Private->PrpListFreeSlotCount, 0);
+  UT_ASSERT_TRUE (NvmeGetPrpListFromPool (Private, SIZE_1GB, 1, &Slot) == NULL);
+
+  NvmeFreePrpListSlot (Private, Slots[5]);
+  UT_ASSERT_NOT_NULL (NvmeGetPrpListFromPool (Private, SIZE_1GB, 1, &Slot));
+  UT_ASSERT_EQUAL (Slot, Slots[5]);
+
+  for (Index = 0; Index < TEST_SLOT_COUNT; Index++) {
+    NvmeFreePrpListSlot (Private, Slots[Index]);
+  }
+
+  UT_ASSERT_EQUAL (Private->PrpListFreeSlotCount, TEST_SLOT_COUNT);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The asynchronous commands go to the queue with the fewest outstanding
+  commands, a queue keeps one entry free, and a completion frees the entry of
+  its queue.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+AsyncCommandsSpreadOverQueues (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                  *TestContext;
+  NVME_CONTROLLER_PRIVATE_DATA  *Private;
+  NVME_PASS_THRU_ASYNC_REQ      *AsyncRequest;
+  NVME_PASS_THRU_ASYNC_REQ      *Completed;
+  UINT16                        QueueId;
+  UINTN                         Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Private     = &TestContext->Private;
+  Completed   = NULL;
+
+  for (Index = 0; Index < TEST_COMMANDS; Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (TestSubmitRead (TestContext, &TestContext->Commands[Index], 1));
+
+    AsyncRequest = TestLastRequest (TestContext);
+    QueueId      = (UINT16)(NVME_ASYNC_IO_QUEUE_ID + Index % TEST_QUEUE_COUNT);
+    UT_ASSERT_EQUAL (AsyncRequest->QueueId, QueueId);
+    UT_ASSERT_EQUAL (AsyncRequest->CommandId, Index / TEST_QUEUE_COUNT);
+    UT_ASSERT_EQUAL (AsyncRequest->PrpListSlot, NVME_PRP_LIST_SLOT_NONE);
+    UT_ASSERT_TRUE (AsyncRequest->Packet == &TestContext->Commands[Index].Packet);
+
+    UT_ASSERT_EQUAL (Private->SqBuffer[QueueId][Index / TEST_QUEUE_COUNT].Opc, NVME_IO_READ_OPC);
+    UT_ASSERT_EQUAL (Private->SqBuffer[QueueId][Index / TEST_QUEUE_COUNT].Prp[0], (UINTN)TestContext->Buffer);
+    UT_ASSERT_EQUAL (TestContext->DoorbellOffset, NVME_SQTDBL_OFFSET (QueueId, 0));
+    UT_ASSERT_EQUAL (TestContext->DoorbellData, Index / TEST_QUEUE_COUNT + 1);
+
+    if (QueueId == NVME_ASYNC_IO_QUEUE_ID + 1) {
+      Completed = AsyncRequest;
+    }
+  }
+
+  for (QueueId = NVME_ASYNC_IO_QUEUE_ID; QueueId < NVME_ASYNC_IO_QUEUE_ID + TEST_QUEUE_COUNT; QueueId++) {
+    UT_ASSERT_EQUAL (Private->OutstandingCmds[QueueId], TEST_QUEUE_DEPTH - 1);
+  }
+
+  UT_ASSERT_EQUAL (TestContext->DoorbellWrites, TEST_COMMANDS);
+  UT_ASSERT_EQUAL (TestContext->Mappings, 1 + TEST_COMMANDS);
+
+  //
+  // All the queues are full.
+  //
+  UT_ASSERT_STATUS_EQUAL (TestSubmitRead (TestContext, &TestContext->Commands[TEST_COMMANDS], 1), EFI_NOT_READY);
+  UT_ASSERT_EQUAL (TestContext->DoorbellWrites, TEST_COMMANDS);
+  UT_ASSERT_EQUAL (TestLastRequest (TestContext)->QueueId, NVME_ASYNC_IO_QUEUE_ID + TEST_QUEUE_COUNT - 1);
+
+  //
+  // The completion of a command of the second queue lets the next command use
+  // its entry, at the tail of the queue which wraps around.
+  //
+  UT_ASSERT_NOT_NULL (Completed);
+  TestCompleteRequest (TestContext, Completed);
+  UT_ASSERT_EQUAL (Private->OutstandingCmds[NVME_ASYNC_IO_QUEUE_ID + 1], TEST_QUEUE_DEPTH - 2);
+  UT_ASSERT_EQUAL (TestContext->Mappings, TEST_COMMANDS);
+
+  UT_ASSERT_NOT_EFI_ERROR (TestSubmitRead (TestContext, &TestContext->Commands[TEST_COMMANDS], 1));
+  AsyncRequest = TestLastRequest (TestContext);
+  UT_ASSERT_EQUAL (AsyncRequest->QueueId, NVME_ASYNC_IO_QUEUE_ID + 1);
+  UT_ASSERT_EQUAL (Private->OutstandingCmds[NVME_ASYNC_IO_QUEUE_ID + 1], TEST_QUEUE_DEPTH - 1);
+  UT_ASSERT_EQUAL (Private->SqBuffer[NVME_ASYNC_IO_QUEUE_ID + 1][TEST_QUEUE_DEPTH - 1].Cid, AsyncRequest->CommandId);
+  UT_ASSERT_EQUAL (TestContext->DoorbellOffset, NVME_SQTDBL_OFFSET (NVME_ASYNC_IO_QUEUE_ID + 1, 0));
+  UT_ASSERT_EQUAL (TestContext->DoorbellData, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  An asynchronous command spanning more than two pages takes its PRP list from
+  the pool, or allocates one when the pool is empty, and its completion
+  releases the PRP list.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+AsyncCommandsUsePrpListPool (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                  *TestContext;
+  NVME_CONTROLLER_PRIVATE_DATA  *Private;
+  NVME_PASS_THRU_ASYNC_REQ      *AsyncRequest;
+  NVME_SQ                       *Sq;
+  UINT64                        *PrpList;
+  UINT16                        Slots[TEST_SLOT_COUNT];
+  UINT16                        Slot;
+  UINTN                         PoolPages;
+  UINTN                         Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Private     = &TestContext->Private;
+  PoolPages   = TestContext->AllocatedPages;
+
+  UT_ASSERT_NOT_EFI_ERROR (TestSubmitRead (TestContext, &TestContext->Commands[0], TEST_BUFFER_PAGES));
+  AsyncRequest = TestLastRequest (TestContext);
+  UT_ASSERT_NOT_EQUAL (AsyncRequest->PrpListSlot, NVME_PRP_LIST_SLOT_NONE);
+  UT_ASSERT_TRUE (AsyncRequest->PrpListHost == NULL);
+  UT_ASSERT_EQUAL (Private->PrpListFreeSlotCount, TEST_SLOT_COUNT - 1);
+  UT_ASSERT_EQUAL (TestContext->AllocatedPages, PoolPages);
+
+  Sq      = &Private->SqBuffer[AsyncRequest->QueueId][AsyncRequest->CommandId];
+  PrpList = (UINT64 *)(Private->PrpListPool + AsyncRequest->PrpListSlot * Private->PrpListSlotSize);
+  UT_ASSERT_EQUAL (Sq->Prp[0], (UINTN)TestContext->Buffer);
+  UT_ASSERT_EQUAL (Sq->Prp[1], Private->PrpListPoolPciAddr + AsyncRequest->PrpListSlot * Private->PrpListSlotSize);
+  for (Index = 0; Index < TEST_BUFFER_PAGES - 1; Index++) {
+    UT_ASSERT_EQUAL (PrpList[Index], (UINTN)TestContext->Buffer + (Index + 1) * EFI_PAGE_SIZE);
+  }
+
+  TestCompleteRequest (TestContext, AsyncRequest);
+  UT_ASSERT_EQUAL (Private->PrpListFreeSlotCount, TEST_SLOT_COUNT);
+
+  //
+  // Without a free PRP list in the pool, the command allocates its own.
+  //
+  for (Index = 0; Index < TEST_SLOT_COUNT; Index++) {
+    UT_ASSERT_NOT_NULL (NvmeGetPrpListFromPool (Private, SIZE_1GB, 1, &Slots[Index]));
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (TestSubmitRead (TestContext, &TestContext->Commands[1], TEST_BUFFER_PAGES));
+  AsyncRequest = TestLastRequest (TestContext);
+  UT_ASSERT_EQUAL (AsyncRequest->PrpListSlot, NVME_PRP_LIST_SLOT_NONE);
+  UT_ASSERT_NOT_NULL (AsyncRequest->PrpListHost);
+  UT_ASSERT_EQUAL (AsyncRequest->PrpListNo, 1);
+  UT_ASSERT_EQUAL (TestContext->AllocatedPages, PoolPages + 1);
+
+  Sq      = &Private->SqBuffer[AsyncRequest->QueueId][AsyncRequest->CommandId];
+  PrpList = AsyncRequest->PrpListHost;
+  UT_ASSERT_EQUAL (Sq->Prp[1], (UINTN)PrpList);
+  for (Index = 0; Index < TEST_BUFFER_PAGES - 1; Index++) {
+    UT_ASSERT_EQUAL (PrpList[Index], (UINTN)TestContext->Buffer + (Index + 1) * EFI_PAGE_SIZE);
+  }
+
+  TestCompleteRequest (TestContext, AsyncRequest);
+  UT_ASSERT_EQUAL (TestContext->AllocatedPages, PoolPages);
+  UT_ASSERT_EQUAL (TestContext->Mappings, 1);
+
+  for (Index = 0; Index < TEST_SLOT_COUNT; Index++) {
+    NvmeFreePrpListSlot (Private, Slots[Index]);
+  }
+
+  Slot = NVME_PRP_LIST_SLOT_NONE;
+  UT_ASSERT_NOT_NULL (NvmeGetPrpListFromPool (Private, SIZE_1GB, 1, &Slot));
+  NvmeFreePrpListSlot (Private, Slot);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  asynchronous I/O queues and the PRP list pool, and run them.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      NvmeQueueTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&NvmeQueueTests, Framework, "NvmExpress Queue Tests", "NvmeQueue", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for NvmeQueueTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (NvmeQueueTests, "The PRP list pool is sized by MDTS", "PoolSize", PrpListPoolSizedByMdts, CreateController, FreeController, &mTestContext);
+  AddTestCase (NvmeQueueTests, "PRP lists are taken from and freed to the pool", "PoolTakeAndFree", PrpListPoolTakeAndFree, CreateController, FreeController, &mTestContext);
+  AddTestCase (NvmeQueueTests, "Asynchronous commands spread over the queues", "QueueSelection", AsyncCommandsSpreadOverQueues, CreateController, FreeController, &mTestContext);
+  AddTestCase (NvmeQueueTests, "Asynchronous commands use the PRP list pool", "PoolPassThru", AsyncCommandsUsePrpListPool, CreateController, FreeController, &mTestContext);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define NvmeQueueUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+NvmeQueueUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
@@ -141,6 +141,125 @@ PopBool (
   return EFI_SUCCESS;
 }
 
+/**
+  Record the protocols referenced by the PUSH opcodes of the dependency
+  expression of a driver. These are the edges of the dependency graph that
+  CoreIsDepexChanged() follows to decide whether the expression has to be
+  evaluated again.
+
+  If there is not enough memory, no protocols are recorded and the expression
+  is evaluated again whenever any protocol is installed or uninstalled.
+
+  @param  DriverEntry           DriverEntry element to update.
+
+**/
+STATIC
+VOID
+CoreRecordDepexProtocols (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  )
+{
+  UINT8     *Iterator;
+  UINT8     *End;
+  UINTN     Count;
+  BOOLEAN   Record;
+  EFI_GUID  DriverGuid;
+
+  DriverEntry->DepexProtocols     = NULL;
+  DriverEntry->DepexProtocolCount = 0;
+
+  //
+  // The first pass counts the PUSH opcodes, the second one records their protocols
+  //
+  for (Record = FALSE; ; Record = TRUE) {
+    Count    = 0;
+    Iterator = DriverEntry->Depex;
+    End      = Iterator + DriverEntry->DepexSize;
+    while (Iterator < End) {
+      if (*Iterator == EFI_DEP_END) {
+        break;
+      }
+
+      if (*Iterator == EFI_DEP_PUSH) {
+        if ((UINTN)(End - Iterator) <= sizeof (EFI_GUID)) {
+          break;
+        }
+
+        if (Record) {
+          CopyMem (&DriverGuid, Iterator + 1, sizeof (EFI_GUID));
+          DriverEntry->DepexProtocols[Count] = CoreGetProtocolEntry (&DriverGuid);
+          if (DriverEntry->DepexProtocols[Count] == NULL) {
+            FreePool (DriverEntry->DepexProtocols);
+            DriverEntry->DepexProtocols = NULL;
+            return;
+          }
+        }
+
+        Count++;
+        Iterator += sizeof (EFI_GUID);
+      }
+
+      Iterator++;
+    }
+
+    if (Record || (Count == 0)) {
+      break;
+    }
+
+    DriverEntry->DepexProtocols = AllocatePool (Count * sizeof (VOID *));
+    if (DriverEntry->DepexProtocols == NULL) {
+      return;
+    }
+  }
+
+  DriverEntry->DepexProtocolCount = Count;
+}
+
+/**
+  Check whether the result of the dependency expression of a driver may have
+  changed since it was last evaluated by CoreIsSchedulable().
+
+  @param  DriverEntry           DriverEntry element to check.
+
+  @retval TRUE                  The expression has to be evaluated.
+  @retval FALSE                 None of the protocols the expression references
+                                was installed or uninstalled since it was last
+                                evaluated, so it still evaluates to FALSE.
+
+**/
+STATIC
+BOOLEAN
+CoreIsDepexChanged (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  )
+{
+  UINTN  Index;
+
+  if (!DriverEntry->DepexEvaluated) {
+    return TRUE;
+  }
+
+  if (DriverEntry->DepexKey == CoreGetProtocolDatabaseKey ()) {
+    return FALSE;
+  }
+
+  if ((DriverEntry->Depex == NULL) || (DriverEntry->DepexProtocols == NULL)) {
+    //
+    // A NULL Depex depends on all the architectural protocols. An expression
+    // without recorded protocols may depend on any protocol.
+    //
+    return TRUE;
+  }
+
+  for (Index = 0; Index < DriverEntry->DepexProtocolCount; Index++) {
+    if (CoreGetProtocolKey (DriverEntry->DepexProtocols[Index]) > DriverEntry->DepexKey) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
 /**
   Preprocess dependency expression and update DriverEntry to reflect the
   state of  Before, After, and SOR dependencies. If DriverEntry->Before
@@ -175,6 +294,8 @@ CorePreProcessDepex (
 
   if (DriverEntry->Before || DriverEntry->After) {
     CopyMem (&DriverEntry->BeforeAfterGuid, Iterator + 1, sizeof (EFI_GUID));
+  } else {
+    CoreRecordDepexProtocols (DriverEntry);
   }
 
   return EFI_SUCCESS;
@@ -185,6 +306,8 @@ CorePreProcessDepex (
   not need to handle Before or After, as it is not valid to call this
   routine in this case. The SOR is just ignored and is a nop in the grammer.
   POSTFIX means all the math is done on top of the stack.
+  An expression that evaluated to FALSE is only evaluated again once one of
+  the protocols it references has been installed or uninstalled.
 
   @param  DriverEntry           DriverEntry element to update.
 
@@ -216,6 +339,16 @@ CoreIsSchedulable (
     return FALSE;
   }
 
+  if (!CoreIsDepexChanged (DriverEntry)) {
+    //
+    // The expression evaluated to FALSE last time and none of its inputs changed
+    //
+    return FALSE;
+  }
+
+  DriverEntry->DepexEvaluated = TRUE;
+  DriverEntry->DepexKey       = CoreGetProtocolDatabaseKey ();
+
   DEBUG ((DEBUG_DISPATCH, "Evaluate DXE DEPEX for FFS(%g)\n", &DriverEntry->FileName));
 
   if (DriverEntry->Depex == NULL) {
@@ -26,6 +26,17 @@
   Depex - Dependency Expresion.
   SOR   - Schedule On Request - Don't schedule if this bit is set.
 
+  Section lookup and decompression of the drivers in the mScheduledQueue are
+  always done on the BSP, as part of loading the image. They are not farmed
+  out to the APs through EFI_MP_SERVICES_PROTOCOL:
+  - FV2 ReadSection() and the GUIDed section extraction handlers allocate
+    memory and call other boot services, which may only be called on the BSP.
+  - EFI_MP_SERVICES_PROTOCOL is produced by a driver that this dispatcher
+    loads, so the drivers dispatched before it would not benefit.
+  - Platforms usually compress the DXE FV as a whole rather than each driver.
+    That FV is extracted in PEI, where chunked LZMA sections are decoded on
+    all processors, so the drivers are found here uncompressed.
+
 Copyright (c) 2006 - 2018, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -162,6 +173,10 @@ CoreFvToDevicePath (
                                 read out of the FV at a later time.
   @param  DriverName            Name of driver to add to mDiscoveredList.
   @param  Type                  Fv File Type of file to add to mDiscoveredList.
+  @param  DriverIndex           The driver index of the FV, or NULL to read the
+                                Depex info from the file.
+  @param  IndexEntry            The entry of the driver in DriverIndex, or NULL
+                                if DriverIndex is NULL.
 
   @retval EFI_SUCCESS           If driver was added to the mDiscoveredList.
   @retval EFI_ALREADY_STARTED   The driver has already been started. Only one
@@ -174,7 +189,9 @@ CoreAddToDriverList (
   IN  EFI_FIRMWARE_VOLUME2_PROTOCOL  *Fv,
   IN  EFI_HANDLE                     FvHandle,
   IN  EFI_GUID                       *DriverName,
-  IN  EFI_FV_FILETYPE                Type
+  IN  EFI_FV_FILETYPE                Type,
+  IN  EDKII_FV_DRIVER_INDEX_HEADER   *DriverIndex  OPTIONAL,
+  IN  EDKII_FV_DRIVER_INDEX_ENTRY    *IndexEntry   OPTIONAL
   );
 
 /**
@@ -845,6 +862,10 @@ CoreFvToDevicePath (
                                 read out of the FV at a later time.
   @param  DriverName            Name of driver to add to mDiscoveredList.
   @param  Type                  Fv File Type of file to add to mDiscoveredList.
+  @param  DriverIndex           The driver index of the FV, or NULL to read the
+                                Depex info from the file.
+  @param  IndexEntry            The entry of the driver in DriverIndex, or NULL
+                                if DriverIndex is NULL.
 
   @retval EFI_SUCCESS           If driver was added to the mDiscoveredList.
   @retval EFI_ALREADY_STARTED   The driver has already been started. Only one
@@ -857,7 +878,9 @@ CoreAddToDriverList (
   IN  EFI_FIRMWARE_VOLUME2_PROTOCOL  *Fv,
   IN  EFI_HANDLE                     FvHandle,
   IN  EFI_GUID                       *DriverName,
-  IN  EFI_FV_FILETYPE                Type
+  IN  EFI_FV_FILETYPE                Type,
+  IN  EDKII_FV_DRIVER_INDEX_HEADER   *DriverIndex  OPTIONAL,
+  IN  EDKII_FV_DRIVER_INDEX_ENTRY    *IndexEntry   OPTIONAL
   )
 {
   EFI_CORE_DRIVER_ENTRY  *DriverEntry;
@@ -878,7 +901,21 @@ CoreAddToDriverList (
   DriverEntry->Fv               = Fv;
   DriverEntry->FvFileDevicePath = CoreFvToDevicePath (Fv, FvHandle, DriverName);
 
-  CoreGetDepexSectionAndPreProccess (DriverEntry);
+  if ((IndexEntry == NULL) || ((IndexEntry->Flags & EDKII_FV_DRIVER_INDEX_DEPEX_UNKNOWN) != 0)) {
+    CoreGetDepexSectionAndPreProccess (DriverEntry);
+  } else if ((IndexEntry->Flags & EDKII_FV_DRIVER_INDEX_DXE_DEPEX) != 0) {
+    //
+    // The driver index is never freed, so the Depex is used in place
+    //
+    DriverEntry->Depex     = (UINT8 *)DriverIndex + IndexEntry->DepexOffset;
+    DriverEntry->DepexSize = IndexEntry->DepexSize;
+    CorePreProcessDepex (DriverEntry);
+  } else {
+    //
+    // If no Depex assume UEFI 2.0 driver model
+    //
+    DriverEntry->Dependent = TRUE;
+  }
 
   CoreAcquireDispatcherLock ();
 
@@ -1177,6 +1214,376 @@ CoreProcessFvImageFile (
   }
 }
 
+/**
+  Add a file of a firmware volume that the dispatcher processes to the
+  mDiscoveredList, or process it directly if it is the DXE core or a firmware
+  volume image without a depex.
+
+  @param  Fv                    The FIRMWARE_VOLUME protocol installed on the FV.
+  @param  FvHandle              The handle of the FV.
+  @param  KnownHandle           The entry of the FV in mFvHandleList.
+  @param  NameGuid              The name of the file.
+  @param  Type                  The type of the file.
+  @param  DriverIndex           The driver index of the FV, or NULL if the FV has
+                                no valid driver index.
+  @param  IndexEntry            The entry of the file in DriverIndex, or NULL if
+                                DriverIndex is NULL.
+
+**/
+STATIC
+VOID
+CoreDiscoverFvFile (
+  IN  EFI_FIRMWARE_VOLUME2_PROTOCOL  *Fv,
+  IN  EFI_HANDLE                     FvHandle,
+  IN  KNOWN_HANDLE                   *KnownHandle,
+  IN  EFI_GUID                       *NameGuid,
+  IN  EFI_FV_FILETYPE                Type,
+  IN  EDKII_FV_DRIVER_INDEX_HEADER   *DriverIndex  OPTIONAL,
+  IN  EDKII_FV_DRIVER_INDEX_ENTRY    *IndexEntry   OPTIONAL
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      AuthenticationStatus;
+  UINTN       SizeOfBuffer;
+  VOID        *DepexBuffer;
+  BOOLEAN     HasDxeDepex;
+
+  if (Type == EFI_FV_FILETYPE_DXE_CORE) {
+    //
+    // If this is the DXE core fill in it's DevicePath & DeviceHandle
+    //
+    if (gDxeCoreLoadedImage->FilePath == NULL) {
+      if (CompareGuid (NameGuid, gDxeCoreFileName)) {
+        //
+        // Maybe One specail Fv cantains only one DXE_CORE module, so its device path must
+        // be initialized completely.
+        //
+        EfiInitializeFwVolDevicepathNode (&mFvDevicePath.File, NameGuid);
+        SetDevicePathEndNode (&mFvDevicePath.End);
+
+        gDxeCoreLoadedImage->FilePath = DuplicateDevicePath (
+                                          (EFI_DEVICE_PATH_PROTOCOL *)&mFvDevicePath
+                                          );
+        gDxeCoreLoadedImage->DeviceHandle = FvHandle;
+      }
+    }
+  } else if (Type == EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE) {
+    //
+    // Check if this EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE file has already
+    // been extracted.
+    //
+    if (FvFoundInHobFv2 (&KnownHandle->FvNameGuid, NameGuid)) {
+      return;
+    }
+
+    if ((IndexEntry != NULL) && ((IndexEntry->Flags & EDKII_FV_DRIVER_INDEX_DEPEX_UNKNOWN) == 0)) {
+      //
+      // The driver index tells which depex sections the file has.
+      // If SMM depex section is found, this FV image is invalid to be supported.
+      //
+      ASSERT ((IndexEntry->Flags & EDKII_FV_DRIVER_INDEX_SMM_DEPEX) == 0);
+      HasDxeDepex = (BOOLEAN)((IndexEntry->Flags & EDKII_FV_DRIVER_INDEX_DXE_DEPEX) != 0);
+    } else {
+      //
+      // Check if this EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE file has SMM depex section.
+      //
+      DepexBuffer  = NULL;
+      SizeOfBuffer = 0;
+      Status       = Fv->ReadSection (
+                           Fv,
+                           NameGuid,
+                           EFI_SECTION_SMM_DEPEX,
+                           0,
+                           &DepexBuffer,
+                           &SizeOfBuffer,
+                           &AuthenticationStatus
+                           );
+      if (!EFI_ERROR (Status)) {
+        //
+        // If SMM depex section is found, this FV image is invalid to be supported.
+        // ASSERT FALSE to report this FV image.
+        //
+        FreePool (DepexBuffer);
+        ASSERT (FALSE);
+      }
+
+      //
+      // Check if this EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE file has DXE depex section.
+      //
+      DepexBuffer  = NULL;
+      SizeOfBuffer = 0;
+      Status       = Fv->ReadSection (
+                           Fv,
+                           NameGuid,
+                           EFI_SECTION_DXE_DEPEX,
+                           0,
+                           &DepexBuffer,
+                           &SizeOfBuffer,
+                           &AuthenticationStatus
+                           );
+      HasDxeDepex = (BOOLEAN)!EFI_ERROR (Status);
+      if (HasDxeDepex) {
+        FreePool (DepexBuffer);
+      }
+    }
+
+    if (!HasDxeDepex) {
+      //
+      // If no depex section, produce a firmware volume block protocol for it so it gets dispatched from.
+      //
+      CoreProcessFvImageFile (Fv, FvHandle, NameGuid);
+    } else {
+      //
+      // If depex section is found, this FV image will be dispatched until its depex is evaluated to TRUE.
+      //
+      CoreAddToDriverList (Fv, FvHandle, NameGuid, Type, DriverIndex, IndexEntry);
+    }
+  } else {
+    //
+    // Transition driver from Undiscovered to Discovered state
+    //
+    CoreAddToDriverList (Fv, FvHandle, NameGuid, Type, DriverIndex, IndexEntry);
+  }
+}
+
+/**
+  Check that a driver index was built for the firmware volume it is found in.
+
+  The build tools record the length and the header checksum of the firmware
+  volume, the offset of the index file and the integrity check of each file
+  the index lists, and protect the index file with the FFS file checksum. The
+  FFS file headers of the firmware volume are walked to check that it still
+  holds exactly these files followed by free space. A firmware volume that was
+  modified after the build, for example by replacing a driver, no longer
+  matches. File data other than the index itself is never read, so the check
+  stays cheap on large firmware volumes. The file headers can only be walked
+  in place, so the index of a firmware volume that is not memory mapped is
+  never trusted.
+
+  @param  FvHandle              The handle of the FV.
+  @param  DriverIndex           The well formed driver index read from the FV.
+
+  @retval TRUE                  The driver index matches the firmware volume.
+  @retval FALSE                 The driver index is stale or cannot be checked.
+
+**/
+STATIC
+BOOLEAN
+CoreVerifyFvDriverIndex (
+  IN  EFI_HANDLE                    FvHandle,
+  IN  EDKII_FV_DRIVER_INDEX_HEADER  *DriverIndex
+  )
+{
+  EFI_STATUS                          Status;
+  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *Fvb;
+  EFI_FVB_ATTRIBUTES_2                FvbAttributes;
+  EFI_PHYSICAL_ADDRESS                Address;
+  EFI_FIRMWARE_VOLUME_HEADER          *FwVolHeader;
+  EFI_FIRMWARE_VOLUME_EXT_HEADER      *FwVolExtHeader;
+  EFI_FFS_FILE_HEADER                 *IndexFile;
+  EFI_FFS_FILE_HEADER                 *FfsFileHeader;
+  EDKII_FV_DRIVER_INDEX_ENTRY         *IndexEntry;
+  UINT64                              Offset;
+  UINT64                              FileSize;
+  UINTN                               HeaderSize;
+  UINTN                               Index;
+  UINT8                               ErasedByte;
+
+  Status = CoreHandleProtocol (FvHandle, &gEfiFirmwareVolumeBlockProtocolGuid, (VOID **)&Fvb);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  Status = Fvb->GetAttributes (Fvb, &FvbAttributes);
+  if (EFI_ERROR (Status) || ((FvbAttributes & EFI_FVB2_MEMORY_MAPPED) == 0)) {
+    return FALSE;
+  }
+
+  Status = Fvb->GetPhysicalAddress (Fvb, &Address);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  FwVolHeader = (EFI_FIRMWARE_VOLUME_HEADER *)(UINTN)Address;
+  if ((FwVolHeader->Signature != EFI_FVH_SIGNATURE) ||
+      (FwVolHeader->FvLength != DriverIndex->FvLength) ||
+      (FwVolHeader->HeaderLength < sizeof (EFI_FIRMWARE_VOLUME_HEADER)) ||
+      (FwVolHeader->Checksum != DriverIndex->FvHeaderChecksum) ||
+      (CalculateSum16 ((UINT16 *)FwVolHeader, FwVolHeader->HeaderLength) != 0) ||
+      (DriverIndex->IndexFileOffset < FwVolHeader->HeaderLength) ||
+      (DriverIndex->IndexFileOffset > FwVolHeader->FvLength - sizeof (EFI_FFS_FILE_HEADER)))
+  {
+    return FALSE;
+  }
+
+  //
+  // The index file must be a small file protected by the FFS file checksum
+  //
+  IndexFile = (EFI_FFS_FILE_HEADER *)((UINT8 *)FwVolHeader + DriverIndex->IndexFileOffset);
+  FileSize  = FFS_FILE_SIZE (IndexFile);
+  if (!CompareGuid (&IndexFile->Name, &gEdkiiFvDriverIndexFileGuid) ||
+      IS_FFS_FILE2 (IndexFile) ||
+      ((IndexFile->Attributes & FFS_ATTRIB_CHECKSUM) == 0) ||
+      (FileSize < sizeof (EFI_FFS_FILE_HEADER)) ||
+      (FileSize > FwVolHeader->FvLength - DriverIndex->IndexFileOffset))
+  {
+    return FALSE;
+  }
+
+  if ((UINT8)(CalculateSum8 ((UINT8 *)(IndexFile + 1), (UINTN)FileSize - sizeof (EFI_FFS_FILE_HEADER)) +
+              IndexFile->IntegrityCheck.Checksum.File) != 0)
+  {
+    return FALSE;
+  }
+
+  //
+  // The space after the index file must be free
+  //
+  Offset     = ALIGN_VALUE (DriverIndex->IndexFileOffset + FileSize, 8);
+  ErasedByte = ((FwVolHeader->Attributes & EFI_FVB2_ERASE_POLARITY) != 0) ? 0xFF : 0;
+  if (Offset + sizeof (EFI_FFS_FILE_HEADER) <= FwVolHeader->FvLength) {
+    for (Index = 0; Index < sizeof (EFI_FFS_FILE_HEADER); Index++) {
+      if (((UINT8 *)FwVolHeader)[Offset + Index] != ErasedByte) {
+        return FALSE;
+      }
+    }
+  }
+
+  //
+  // Every file before the index file, other than the a priori file and pad
+  // files, must be the next file of the index
+  //
+  Offset = FwVolHeader->HeaderLength;
+  if (FwVolHeader->ExtHeaderOffset != 0) {
+    if (FwVolHeader->ExtHeaderOffset > DriverIndex->IndexFileOffset - sizeof (EFI_FIRMWARE_VOLUME_EXT_HEADER)) {
+      return FALSE;
+    }
+
+    FwVolExtHeader = (EFI_FIRMWARE_VOLUME_EXT_HEADER *)((UINT8 *)FwVolHeader + FwVolHeader->ExtHeaderOffset);
+    Offset         = FwVolHeader->ExtHeaderOffset + FwVolExtHeader->ExtHeaderSize;
+  }
+
+  IndexEntry = (EDKII_FV_DRIVER_INDEX_ENTRY *)(DriverIndex + 1);
+  Index      = 0;
+  for (Offset = ALIGN_VALUE (Offset, 8); Offset < DriverIndex->IndexFileOffset; Offset = ALIGN_VALUE (Offset + FileSize, 8)) {
+    if (Offset > DriverIndex->IndexFileOffset - sizeof (EFI_FFS_FILE_HEADER)) {
+      return FALSE;
+    }
+
+    FfsFileHeader = (EFI_FFS_FILE_HEADER *)((UINT8 *)FwVolHeader + Offset);
+    if (IS_FFS_FILE2 (FfsFileHeader)) {
+      if (Offset > DriverIndex->IndexFileOffset - sizeof (EFI_FFS_FILE_HEADER2)) {
+        return FALSE;
+      }
+
+      HeaderSize = sizeof (EFI_FFS_FILE_HEADER2);
+      FileSize   = FFS_FILE2_SIZE (FfsFileHeader);
+    } else {
+      HeaderSize = sizeof (EFI_FFS_FILE_HEADER);
+      FileSize   = FFS_FILE_SIZE (FfsFileHeader);
+    }
+
+    if ((FileSize < HeaderSize) || (FileSize > DriverIndex->IndexFileOffset - Offset)) {
+      return FALSE;
+    }
+
+    if ((FfsFileHeader->Type == EFI_FV_FILETYPE_FFS_PAD) || CompareGuid (&FfsFileHeader->Name, &gAprioriGuid)) {
+      continue;
+    }
+
+    if ((Index == DriverIndex->EntryCount) ||
+        !CompareGuid (&FfsFileHeader->Name, &IndexEntry[Index].FileName) ||
+        (FfsFileHeader->Type != IndexEntry[Index].Type) ||
+        (FfsFileHeader->IntegrityCheck.Checksum16 != IndexEntry[Index].IntegrityCheck))
+    {
+      return FALSE;
+    }
+
+    Index++;
+  }
+
+  return (BOOLEAN)((Offset == DriverIndex->IndexFileOffset) && (Index == DriverIndex->EntryCount));
+}
+
+/**
+  Read the driver index of a firmware volume and check that it is well formed
+  and that it matches the firmware volume.
+
+  @param  Fv                    The FIRMWARE_VOLUME protocol installed on the FV.
+  @param  FvHandle              The handle of the FV.
+
+  @return The driver index, or NULL if the FV has no valid driver index. The
+          index is never freed, as the depex of the drivers of the FV point
+          into it.
+
+**/
+STATIC
+EDKII_FV_DRIVER_INDEX_HEADER *
+CoreGetFvDriverIndex (
+  IN  EFI_FIRMWARE_VOLUME2_PROTOCOL  *Fv,
+  IN  EFI_HANDLE                     FvHandle
+  )
+{
+  EFI_STATUS                    Status;
+  EDKII_FV_DRIVER_INDEX_HEADER  *DriverIndex;
+  EDKII_FV_DRIVER_INDEX_ENTRY   *IndexEntry;
+  UINTN                         Size;
+  UINTN                         Index;
+  UINT32                        AuthenticationStatus;
+
+  DriverIndex = NULL;
+  Status      = Fv->ReadSection (
+                      Fv,
+                      &gEdkiiFvDriverIndexFileGuid,
+                      EFI_SECTION_RAW,
+                      0,
+                      (VOID **)&DriverIndex,
+                      &Size,
+                      &AuthenticationStatus
+                      );
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  if ((Size < sizeof (EDKII_FV_DRIVER_INDEX_HEADER)) ||
+      (DriverIndex->Signature != EDKII_FV_DRIVER_INDEX_SIGNATURE) ||
+      (DriverIndex->Version != EDKII_FV_DRIVER_INDEX_VERSION) ||
+      (DriverIndex->EntryCount > (Size - sizeof (EDKII_FV_DRIVER_INDEX_HEADER)) / sizeof (EDKII_FV_DRIVER_INDEX_ENTRY)))
+  {
+    goto Invalid;
+  }
+
+  IndexEntry = (EDKII_FV_DRIVER_INDEX_ENTRY *)(DriverIndex + 1);
+  for (Index = 0; Index < DriverIndex->EntryCount; Index++) {
+    if ((IndexEntry[Index].AprioriIndex != EDKII_FV_DRIVER_INDEX_NOT_APRIORI) &&
+        (IndexEntry[Index].AprioriIndex >= DriverIndex->AprioriCount))
+    {
+      goto Invalid;
+    }
+
+    if (((IndexEntry[Index].Flags & EDKII_FV_DRIVER_INDEX_DXE_DEPEX) != 0) &&
+        ((IndexEntry[Index].DepexSize == 0) ||
+         (IndexEntry[Index].DepexOffset > Size) ||
+         (IndexEntry[Index].DepexSize > Size - IndexEntry[Index].DepexOffset)))
+    {
+      goto Invalid;
+    }
+  }
+
+  if (!CoreVerifyFvDriverIndex (FvHandle, DriverIndex)) {
+    DEBUG ((DEBUG_WARN, "Ignoring driver index that does not match FV %p\n", Fv));
+    CoreFreePool (DriverIndex);
+    return NULL;
+  }
+
+  return DriverIndex;
+
+Invalid:
+  DEBUG ((DEBUG_WARN, "Ignoring malformed driver index in FV %p\n", Fv));
+  CoreFreePool (DriverIndex);
+  return NULL;
+}
+
 /**
   Event notification that is fired every time a FV dispatch protocol is added.
   More than one protocol may have been added when this event is fired, so you
@@ -1219,8 +1626,10 @@ CoreFwVolEventProtocolNotify (
   LIST_ENTRY                     *Link;
   UINT32                         AuthenticationStatus;
   UINTN                          SizeOfBuffer;
-  VOID                           *DepexBuffer;
   KNOWN_HANDLE                   *KnownHandle;
+  EDKII_FV_DRIVER_INDEX_HEADER   *DriverIndex;
+  EDKII_FV_DRIVER_INDEX_ENTRY    *IndexEntry;
+  UINTN                          EntryIndex;
 
   FvHandle = NULL;
 
@@ -1281,8 +1690,30 @@ CoreFwVolEventProtocolNotify (
     // Process EFI_FV_FILETYPE_DRIVER type and then EFI_FV_FILETYPE_COMBINED_PEIM_DRIVER
     //  EFI_FV_FILETYPE_DXE_CORE is processed to produce a Loaded Image protocol for the core
     //  EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE is processed to create a Fvb
+    // If the FV has a driver index, the files are taken from it instead.
     //
+    DriverIndex = CoreGetFvDriverIndex (Fv, FvHandle);
+    IndexEntry  = (DriverIndex != NULL) ? (EDKII_FV_DRIVER_INDEX_ENTRY *)(DriverIndex + 1) : NULL;
+
     for (Index = 0; Index < sizeof (mDxeFileTypes) / sizeof (EFI_FV_FILETYPE); Index++) {
+      if (DriverIndex != NULL) {
+        for (EntryIndex = 0; EntryIndex < DriverIndex->EntryCount; EntryIndex++) {
+          if (IndexEntry[EntryIndex].Type == mDxeFileTypes[Index]) {
+            CoreDiscoverFvFile (
+              Fv,
+              FvHandle,
+              KnownHandle,
+              &IndexEntry[EntryIndex].FileName,
+              IndexEntry[EntryIndex].Type,
+              DriverIndex,
+              &IndexEntry[EntryIndex]
+              );
+          }
+        }
+
+        continue;
+      }
+
       //
       // Initialize the search key
       //
@@ -1298,89 +1729,7 @@ CoreFwVolEventProtocolNotify (
                                   &Size
                                   );
         if (!EFI_ERROR (GetNextFileStatus)) {
-          if (Type == EFI_FV_FILETYPE_DXE_CORE) {
-            //
-            // If this is the DXE core fill in it's DevicePath & DeviceHandle
-            //
-            if (gDxeCoreLoadedImage->FilePath == NULL) {
-              if (CompareGuid (&NameGuid, gDxeCoreFileName)) {
-                //
-                // Maybe One specail Fv cantains only one DXE_CORE module, so its device path must
-                // be initialized completely.
-                //
-                EfiInitializeFwVolDevicepathNode (&mFvDevicePath.File, &NameGuid);
-                SetDevicePathEndNode (&mFvDevicePath.End);
-
-                gDxeCoreLoadedImage->FilePath = DuplicateDevicePath (
-                                                  (EFI_DEVICE_PATH_PROTOCOL *)&mFvDevicePath
-                                                  );
-                gDxeCoreLoadedImage->DeviceHandle = FvHandle;
-              }
-            }
-          } else if (Type == EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE) {
-            //
-            // Check if this EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE file has already
-            // been extracted.
-            //
-            if (FvFoundInHobFv2 (&KnownHandle->FvNameGuid, &NameGuid)) {
-              continue;
-            }
-
-            //
-            // Check if this EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE file has SMM depex section.
-            //
-            DepexBuffer  = NULL;
-            SizeOfBuffer = 0;
-            Status       = Fv->ReadSection (
-                                 Fv,
-                                 &NameGuid,
-                                 EFI_SECTION_SMM_DEPEX,
-                                 0,
-                                 &DepexBuffer,
-                                 &SizeOfBuffer,
-                                 &AuthenticationStatus
-                                 );
-            if (!EFI_ERROR (Status)) {
-              //
-              // If SMM depex section is found, this FV image is invalid to be supported.
-              // ASSERT FALSE to report this FV image.
-              //
-              FreePool (DepexBuffer);
-              ASSERT (FALSE);
-            }
-
-            //
-            // Check if this EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE file has DXE depex section.
-            //
-            DepexBuffer  = NULL;
-            SizeOfBuffer = 0;
-            Status       = Fv->ReadSection (
-                                 Fv,
-                                 &NameGuid,
-                                 EFI_SECTION_DXE_DEPEX,
-                                 0,
-                                 &DepexBuffer,
-                                 &SizeOfBuffer,
-                                 &AuthenticationStatus
-                                 );
-            if (EFI_ERROR (Status)) {
-              //
-              // If no depex section, produce a firmware volume block protocol for it so it gets dispatched from.
-              //
-              CoreProcessFvImageFile (Fv, FvHandle, &NameGuid);
-            } else {
-              //
-              // If depex section is found, this FV image will be dispatched until its depex is evaluated to TRUE.
-              //
-              FreePool (DepexBuffer);
-              CoreAddToDriverList (Fv, FvHandle, &NameGuid, Type);
-            }
-          } else {
-            //
-            // Transition driver from Undiscovered to Discovered state
-            //
-            CoreAddToDriverList (Fv, FvHandle, &NameGuid, Type);
-          }
+          CoreDiscoverFvFile (Fv, FvHandle, KnownHandle, &NameGuid, Type, NULL, NULL);
         }
       } while (!EFI_ERROR (GetNextFileStatus));
     }
@@ -1388,20 +1737,37 @@ CoreFwVolEventProtocolNotify (
     //
     // Read the array of GUIDs from the Apriori file if it is present in the firmware volume
     //
-    AprioriFile = NULL;
-    Status      = Fv->ReadSection (
-                        Fv,
-                        &gAprioriGuid,
-                        EFI_SECTION_RAW,
-                        0,
-                        (VOID **)&AprioriFile,
-                        &SizeOfBuffer,
-                        &AuthenticationStatus
-                        );
-    if (!EFI_ERROR (Status)) {
-      AprioriEntryCount = SizeOfBuffer / sizeof (EFI_GUID);
+    AprioriFile       = NULL;
+    AprioriEntryCount = 0;
+    if (DriverIndex != NULL) {
+      //
+      // Rebuild the array from the positions recorded in the driver index
+      //
+      if (DriverIndex->AprioriCount != 0) {
+        AprioriFile = AllocateZeroPool (DriverIndex->AprioriCount * sizeof (EFI_GUID));
+        ASSERT (AprioriFile != NULL);
+        if (AprioriFile != NULL) {
+          AprioriEntryCount = DriverIndex->AprioriCount;
+          for (EntryIndex = 0; EntryIndex < DriverIndex->EntryCount; EntryIndex++) {
+            if (IndexEntry[EntryIndex].AprioriIndex != EDKII_FV_DRIVER_INDEX_NOT_APRIORI) {
+              CopyGuid (&AprioriFile[IndexEntry[EntryIndex].AprioriIndex], &IndexEntry[EntryIndex].FileName);
+            }
+          }
+        }
+      }
     } else {
-      AprioriEntryCount = 0;
+      Status = Fv->ReadSection (
+                     Fv,
+                     &gAprioriGuid,
+                     EFI_SECTION_RAW,
+                     0,
+                     (VOID **)&AprioriFile,
+                     &SizeOfBuffer,
+                     &AuthenticationStatus
+                     );
+      if (!EFI_ERROR (Status)) {
+        AprioriEntryCount = SizeOfBuffer / sizeof (EFI_GUID);
+      }
     }
 
     //
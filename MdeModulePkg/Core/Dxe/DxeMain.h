@@ -49,9 +49,13 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Guid/FirmwareFileSystem2.h>
 #include <Guid/FirmwareFileSystem3.h>
 #include <Guid/HobList.h>
+#include <Guid/HobGuidIndex.h>
 #include <Guid/DebugImageInfoTable.h>
 #include <Guid/FileInfo.h>
 #include <Guid/Apriori.h>
+#include <Guid/FvDriverIndex.h>
+#include <Guid/DecompressedSectionCache.h>
+#include <Guid/BootTraceTable.h>
 #include <Guid/DxeServices.h>
 #include <Guid/MemoryAllocationHob.h>
 #include <Guid/EventLegacyBios.h>
@@ -84,6 +88,9 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/DxeServicesLib.h>
 #include <Library/DebugAgentLib.h>
 #include <Library/CpuExceptionHandlerLib.h>
+#include <Library/HashIndexLib.h>
+#include <Library/OrderedCollectionLib.h>
+#include <Library/TimerLib.h>
 
 //
 // attributes for reserved memory before it is promoted to system memory
@@ -158,6 +165,16 @@ typedef struct {
   BOOLEAN                          Initialized;
   BOOLEAN                          DepexProtocolError;
 
+  ///
+  /// Protocol entries referenced by the PUSH opcodes of Depex, see
+  /// CoreGetProtocolEntry(). Depex is only evaluated again once the key of
+  /// one of them has moved past DepexKey.
+  ///
+  VOID                             **DepexProtocols;
+  UINTN                            DepexProtocolCount;
+  BOOLEAN                          DepexEvaluated;
+  UINT64                           DepexKey;
+
   EFI_HANDLE                       ImageHandle;
   BOOLEAN                          IsFvImage;
 } EFI_CORE_DRIVER_ENTRY;
@@ -167,16 +184,21 @@ typedef struct {
 //
 #define EFI_GCD_MAP_SIGNATURE  SIGNATURE_32('g','c','d','m')
 typedef struct {
-  UINTN                   Signature;
-  LIST_ENTRY              Link;
-  EFI_PHYSICAL_ADDRESS    BaseAddress;
-  UINT64                  EndAddress;
-  UINT64                  Capabilities;
-  UINT64                  Attributes;
-  EFI_GCD_MEMORY_TYPE     GcdMemoryType;
-  EFI_GCD_IO_TYPE         GcdIoType;
-  EFI_HANDLE              ImageHandle;
-  EFI_HANDLE              DeviceHandle;
+  UINTN                       Signature;
+  LIST_ENTRY                  Link;
+  EFI_PHYSICAL_ADDRESS        BaseAddress;
+  UINT64                      EndAddress;
+  UINT64                      Capabilities;
+  UINT64                      Attributes;
+  EFI_GCD_MEMORY_TYPE         GcdMemoryType;
+  EFI_GCD_IO_TYPE             GcdIoType;
+  EFI_HANDLE                  ImageHandle;
+  EFI_HANDLE                  DeviceHandle;
+  ///
+  /// Node of this entry in the address index of its GCD map, or NULL if the
+  /// entry is not indexed.
+  ///
+  ORDERED_COLLECTION_ENTRY    *IndexEntry;
 } EFI_GCD_MAP_ENTRY;
 
 #define LOADED_IMAGE_PRIVATE_DATA_SIGNATURE  SIGNATURE_32('l','d','r','i')
@@ -264,6 +286,31 @@ extern BOOLEAN  gMemoryAttributesTableForwardCfi;
 
 extern EFI_LOAD_FIXED_ADDRESS_CONFIGURATION_TABLE  gLoadModuleAtFixAddressConfigurationTable;
 extern BOOLEAN                                     gLoadFixedAddressCodeMemoryReady;
+
+extern UINT64  gBootTraceProtocolInstallCount;
+extern UINT64  gBootTraceAllocatedBytes;
+
+///
+/// State of a boot trace entry between CoreBootTraceBegin() and CoreBootTraceEnd()
+///
+typedef struct _BOOT_TRACE_SCOPE BOOT_TRACE_SCOPE;
+struct _BOOT_TRACE_SCOPE {
+  EFI_GUID            ModuleName;
+  UINT64              StartTime;
+  UINT64              ProtocolInstallCount;
+  UINT64              AllocatedBytes;
+  ///
+  /// Totals of the entries nested in this one
+  ///
+  UINT64              ChildDuration;
+  UINT64              ChildProtocolInstallCount;
+  UINT64              ChildAllocatedBytes;
+  UINT16              Depth;
+  ///
+  /// The entry this one is nested in, or NULL
+  ///
+  BOOT_TRACE_SCOPE    *Parent;
+};
 //
 // Service Initialization Functions
 //
@@ -453,6 +500,8 @@ CoreInitializeDispatcher (
   not need to handle Before or After, as it is not valid to call this
   routine in this case. The SOR is just ignored and is a nop in the grammer.
   POSTFIX means all the math is done on top of the stack.
+  An expression that evaluated to FALSE is only evaluated again once one of
+  the protocols it references has been installed or uninstalled.
 
   @param  DriverEntry           DriverEntry element to update.
 
@@ -1067,6 +1116,47 @@ CoreConnectHandlesByKey (
   UINT64  Key
   );
 
+/**
+  Return the protocol database key.
+
+  @return Protocol database key.
+
+**/
+UINT64
+CoreGetProtocolDatabaseKey (
+  VOID
+  );
+
+/**
+  Return the entry of a protocol in the protocol database, creating it if it
+  does not exist yet. Protocol entries are never freed, so the entry can be
+  kept by the caller and passed to CoreGetProtocolKey() at any later time.
+
+  @param  Protocol               The ID of the protocol.
+
+  @return The protocol entry, or NULL if there is not enough memory.
+
+**/
+VOID *
+CoreGetProtocolEntry (
+  IN EFI_GUID  *Protocol
+  );
+
+/**
+  Return the protocol database key at which an interface of a protocol was
+  last installed or uninstalled.
+
+  @param  ProtocolEntry          The protocol entry returned by
+                                 CoreGetProtocolEntry().
+
+  @return The key, or 0 if no interface of the protocol was ever installed.
+
+**/
+UINT64
+CoreGetProtocolKey (
+  IN VOID  *ProtocolEntry
+  );
+
 /**
   Connects one or more drivers to a controller.
 
@@ -2576,6 +2666,19 @@ MemoryProfileInit (
   IN VOID  *HobStart
   );
 
+/**
+  Get the GUID file name from the file path.
+
+  @param FilePath  File path.
+
+  @return The GUID file name from the file path.
+
+**/
+EFI_GUID *
+GetFileNameFromFilePath (
+  IN EFI_DEVICE_PATH_PROTOCOL  *FilePath
+  );
+
 /**
   Install memory profile protocol.
 
@@ -2772,6 +2875,62 @@ ApplyMemoryProtectionPolicy (
   IN  UINT64                Length
   );
 
+/**
+  Allocate the boot trace buffer and install it into the EFI System Table.
+  The boot trace stays disabled if PcdBootTraceEntryCount is 0.
+
+**/
+VOID
+CoreInitializeBootTrace (
+  VOID
+  );
+
+/**
+  Begin a boot trace entry for the code of an image.
+
+  @param  Scope             Receives the state of the entry, to be passed to
+                            CoreBootTraceEnd().
+  @param  ImageHandle       The handle of the image whose code is called.
+
+**/
+VOID
+CoreBootTraceBegin (
+  OUT BOOT_TRACE_SCOPE  *Scope,
+  IN  EFI_HANDLE        ImageHandle
+  );
+
+/**
+  End a boot trace entry and record it in the ring buffer.
+
+  @param  Scope             The state returned by CoreBootTraceBegin().
+  @param  Type              EDKII_BOOT_TRACE_TYPE_START_IMAGE or
+                            EDKII_BOOT_TRACE_TYPE_DRIVER_BINDING_START.
+  @param  ControllerHandle  The controller handle passed to Start(), or NULL.
+  @param  Status            The status returned by the traced code.
+
+**/
+VOID
+CoreBootTraceEnd (
+  IN BOOT_TRACE_SCOPE  *Scope,
+  IN UINT16            Type,
+  IN EFI_HANDLE        ControllerHandle,
+  IN EFI_STATUS        Status
+  );
+
+/**
+  Build the index of the GUID extension HOBs of the HOB list and install it
+  into the EFI System Table. The HOB list is not indexed if
+  PcdDxeHobGuidIndex is FALSE.
+
+  @param  HobStart          The HOB list that is installed as the
+                            gEfiHobListGuid configuration table.
+
+**/
+VOID
+CoreInstallHobGuidIndex (
+  IN VOID  *HobStart
+  );
+
 /**
   Merge continous memory map entries whose have same attributes.
 
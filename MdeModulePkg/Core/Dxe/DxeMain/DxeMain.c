@@ -352,6 +352,7 @@ DxeMain (
   //
   Status = CoreInstallConfigurationTable (&gEfiHobListGuid, HobStart);
   ASSERT_EFI_ERROR (Status);
+  CoreInstallHobGuidIndex (HobStart);
 
   //
   // Install Memory Type Information Table into the EFI System Tables's Configuration Table
@@ -459,6 +460,7 @@ DxeMain (
 
   CoreInitializeMemoryAttributesTable ();
   CoreInitializeMemoryProtection ();
+  CoreInitializeBootTrace ();
 
   //
   // Get persisted vector hand-off info from GUIDeed HOB again due to HobStart may be updated,
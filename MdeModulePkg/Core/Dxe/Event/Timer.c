@@ -13,9 +13,9 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 // Internal data
 //
 
-LIST_ENTRY  mEfiTimerList       = INITIALIZE_LIST_HEAD_VARIABLE (mEfiTimerList);
-EFI_LOCK    mEfiTimerLock       = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL - 1);
-EFI_EVENT   mEfiCheckTimerEvent = NULL;
+TIMER_WHEEL  mEfiTimerWheel;
+EFI_LOCK     mEfiTimerLock       = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL - 1);
+EFI_EVENT    mEfiCheckTimerEvent = NULL;
 
 EFI_LOCK  mEfiSystemTimeLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL);
 UINT64    mEfiSystemTime     = 0;
@@ -36,29 +36,13 @@ CoreInsertEventTimer (
   IN IEVENT  *Event
   )
 {
-  UINT64      TriggerTime;
-  LIST_ENTRY  *Link;
-  IEVENT      *Event2;
-
   ASSERT_LOCKED (&mEfiTimerLock);
 
   //
-  // Get the timer's trigger time
-  //
-  TriggerTime = Event->Timer.TriggerTime;
-
-  //
-  // Insert the timer into the timer database in assending sorted order
+  // Insert the timer into the timer wheel. Timers with the same trigger time
+  // fire in the order they were inserted.
   //
-  for (Link = mEfiTimerList.ForwardLink; Link != &mEfiTimerList; Link = Link->ForwardLink) {
-    Event2 = CR (Link, IEVENT, Timer.Link, EVENT_SIGNATURE);
-
-    if (Event2->Timer.TriggerTime > TriggerTime) {
-      break;
-    }
-  }
-
-  InsertTailList (Link, &Event->Timer.Link);
+  TimerWheelInsert (&mEfiTimerWheel, &Event->Timer.Entry);
 }
 
 /**
@@ -82,8 +66,8 @@ CoreCurrentSystemTime (
 }
 
 /**
-  Checks the sorted timer list against the current system time.
-  Signals any expired event timer.
+  Checks the timer wheel against the current system time.
+  Signals any expired event timer in trigger time order.
 
   @param  CheckEvent             Not used
   @param  Context                Not used
@@ -96,8 +80,9 @@ CoreCheckTimers (
   IN VOID       *Context
   )
 {
-  UINT64  SystemTime;
-  IEVENT  *Event;
+  UINT64             SystemTime;
+  TIMER_WHEEL_ENTRY  *Entry;
+  IEVENT             *Event;
 
   //
   // Check the timer database for expired timers
@@ -105,22 +90,16 @@ CoreCheckTimers (
   CoreAcquireLock (&mEfiTimerLock);
   SystemTime = CoreCurrentSystemTime ();
 
-  while (!IsListEmpty (&mEfiTimerList)) {
-    Event = CR (mEfiTimerList.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
-
-    //
-    // If this timer is not expired, then we're done
-    //
-    if (Event->Timer.TriggerTime > SystemTime) {
+  //
+  // Remove each expired timer from the timer queue, earliest first
+  //
+  while (TRUE) {
+    Entry = TimerWheelRemoveExpired (&mEfiTimerWheel, SystemTime);
+    if (Entry == NULL) {
       break;
     }
 
-    //
-    // Remove this timer from the timer queue
-    //
-
-    RemoveEntryList (&Event->Timer.Link);
-    Event->Timer.Link.ForwardLink = NULL;
+    Event = CR (Entry, IEVENT, Timer.Entry, EVENT_SIGNATURE);
 
     //
     // Signal it
@@ -134,13 +113,13 @@ CoreCheckTimers (
       //
       // Compute the timers new trigger time
       //
-      Event->Timer.TriggerTime = Event->Timer.TriggerTime + Event->Timer.Period;
+      Event->Timer.Entry.TriggerTime = Event->Timer.Entry.TriggerTime + Event->Timer.Period;
 
       //
       // If that's before now, then reset the timer to start from now
       //
-      if (Event->Timer.TriggerTime <= SystemTime) {
-        Event->Timer.TriggerTime = SystemTime;
+      if (Event->Timer.Entry.TriggerTime <= SystemTime) {
+        Event->Timer.Entry.TriggerTime = SystemTime;
         CoreSignalEvent (mEfiCheckTimerEvent);
       }
 
@@ -165,6 +144,8 @@ CoreInitializeTimer (
 {
   EFI_STATUS  Status;
 
+  TimerWheelInitialize (&mEfiTimerWheel);
+
   Status = CoreCreateEventInternal (
              EVT_NOTIFY_SIGNAL,
              TPL_HIGH_LEVEL - 1,
@@ -189,8 +170,6 @@ CoreTimerTick (
   IN UINT64  Duration
   )
 {
-  IEVENT  *Event;
-
   //
   // Check runtiem flag in case there are ticks while exiting boot services
   //
@@ -202,15 +181,11 @@ CoreTimerTick (
   mEfiSystemTime += Duration;
 
   //
-  // If the head of the list is expired, fire the timer event
+  // If the earliest timer may have expired, fire the timer event
   // to process it
   //
-  if (!IsListEmpty (&mEfiTimerList)) {
-    Event = CR (mEfiTimerList.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
-
-    if (Event->Timer.TriggerTime <= mEfiSystemTime) {
-      CoreSignalEvent (mEfiCheckTimerEvent);
-    }
+  if (TimerWheelNextTriggerTime (&mEfiTimerWheel) <= mEfiSystemTime) {
+    CoreSignalEvent (mEfiCheckTimerEvent);
   }
 
   CoreReleaseLock (&mEfiSystemTimeLock);
@@ -260,13 +235,12 @@ CoreSetTimer (
   //
   // If the timer is queued to the timer database, remove it
   //
-  if (Event->Timer.Link.ForwardLink != NULL) {
-    RemoveEntryList (&Event->Timer.Link);
-    Event->Timer.Link.ForwardLink = NULL;
+  if (Event->Timer.Entry.Link.ForwardLink != NULL) {
+    TimerWheelRemove (&mEfiTimerWheel, &Event->Timer.Entry);
   }
 
-  Event->Timer.TriggerTime = 0;
-  Event->Timer.Period      = 0;
+  Event->Timer.Entry.TriggerTime = 0;
+  Event->Timer.Period            = 0;
 
   if (Type != TimerCancel) {
     if (Type == TimerPeriodic) {
@@ -277,7 +251,7 @@ CoreSetTimer (
       Event->Timer.Period = TriggerTime;
     }
 
-    Event->Timer.TriggerTime = CoreCurrentSystemTime () + TriggerTime;
+    Event->Timer.Entry.TriggerTime = CoreCurrentSystemTime () + TriggerTime;
     CoreInsertEventTimer (Event);
 
     if (TriggerTime == 0) {
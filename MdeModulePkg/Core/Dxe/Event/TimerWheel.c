@@ -0,0 +1,355 @@
+/** @file
+  Hierarchical timing wheel used to queue DXE core timer events.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include "TimerWheel.h"
+
+/**
+  Check if an entry expires before another one.
+
+  @param  Entry1                 The first entry.
+  @param  Entry2                 The second entry.
+
+  @retval TRUE                   Entry1 expires before Entry2.
+  @retval FALSE                  Entry1 expires after Entry2.
+
+**/
+STATIC
+BOOLEAN
+TimerWheelIsBefore (
+  IN TIMER_WHEEL_ENTRY  *Entry1,
+  IN TIMER_WHEEL_ENTRY  *Entry2
+  )
+{
+  if (Entry1->TriggerTime != Entry2->TriggerTime) {
+    return (BOOLEAN)(Entry1->TriggerTime < Entry2->TriggerTime);
+  }
+
+  return (BOOLEAN)(Entry1->Sequence < Entry2->Sequence);
+}
+
+/**
+  Insert an entry into the sorted expired list. Entries are usually inserted
+  close to the end of the list, so the list is searched backwards.
+
+  @param  Wheel                  The timing wheel.
+  @param  Entry                  The entry to insert.
+
+**/
+STATIC
+VOID
+TimerWheelInsertExpired (
+  IN OUT TIMER_WHEEL        *Wheel,
+  IN OUT TIMER_WHEEL_ENTRY  *Entry
+  )
+{
+  LIST_ENTRY  *Link;
+
+  for (Link = Wheel->Expired.BackLink; Link != &Wheel->Expired; Link = Link->BackLink) {
+    if (TimerWheelIsBefore (BASE_CR (Link, TIMER_WHEEL_ENTRY, Link), Entry)) {
+      break;
+    }
+  }
+
+  InsertHeadList (Link, &Entry->Link);
+}
+
+/**
+  Place an entry on the slot of the lowest level whose range covers its
+  trigger time, or on the expired list if its tick has already been reached.
+
+  @param  Wheel                  The timing wheel.
+  @param  Entry                  The entry to place.
+
+**/
+STATIC
+VOID
+TimerWheelPlace (
+  IN OUT TIMER_WHEEL        *Wheel,
+  IN OUT TIMER_WHEEL_ENTRY  *Entry
+  )
+{
+  UINT64  Tick;
+  UINTN   Level;
+  UINTN   Shift;
+  UINTN   Slot;
+
+  Tick = RShiftU64 (Entry->TriggerTime, TIMER_WHEEL_TICK_SHIFT);
+  if (Tick <= Wheel->CurrentTick) {
+    TimerWheelInsertExpired (Wheel, Entry);
+    return;
+  }
+
+  //
+  // The entry goes to the first level above which its tick and the current
+  // tick agree. The slot it lands in is therefore always ahead of the current
+  // position of that level, and it is cascaded before that level wraps.
+  //
+  for (Level = 0; Level < TIMER_WHEEL_LEVEL_COUNT - 1; Level++) {
+    Shift = (Level + 1) * TIMER_WHEEL_SLOT_SHIFT;
+    if (RShiftU64 (Tick, Shift) == RShiftU64 (Wheel->CurrentTick, Shift)) {
+      break;
+    }
+  }
+
+  Slot = (UINTN)RShiftU64 (Tick, Level * TIMER_WHEEL_SLOT_SHIFT) & (TIMER_WHEEL_SLOT_COUNT - 1);
+  InsertTailList (&Wheel->Slots[Level][Slot], &Entry->Link);
+  Wheel->SlotMap[Level] |= LShiftU64 (1, Slot);
+}
+
+/**
+  Re-place every entry of a wheel slot relative to the current tick.
+
+  @param  Wheel                  The timing wheel.
+  @param  Level                  The level of the slot.
+  @param  Slot                   The index of the slot.
+
+**/
+STATIC
+VOID
+TimerWheelCascade (
+  IN OUT TIMER_WHEEL  *Wheel,
+  IN     UINTN        Level,
+  IN     UINTN        Slot
+  )
+{
+  LIST_ENTRY         *Head;
+  TIMER_WHEEL_ENTRY  *Entry;
+
+  Wheel->SlotMap[Level] &= ~LShiftU64 (1, Slot);
+
+  Head = &Wheel->Slots[Level][Slot];
+  while (!IsListEmpty (Head)) {
+    Entry = BASE_CR (Head->ForwardLink, TIMER_WHEEL_ENTRY, Link);
+    RemoveEntryList (&Entry->Link);
+    TimerWheelPlace (Wheel, Entry);
+  }
+}
+
+/**
+  Return the first tick after the current one at which a wheel slot has to be
+  processed.
+
+  @param  Wheel                  The timing wheel.
+
+  @return The tick, or MAX_UINT64 if no slot is in use.
+
+**/
+STATIC
+UINT64
+TimerWheelNextTick (
+  IN TIMER_WHEEL  *Wheel
+  )
+{
+  UINTN   Level;
+  UINTN   Shift;
+  UINTN   Index;
+  UINT64  Pending;
+
+  //
+  // Slots of a lower level are always processed before any slot of a higher
+  // level, as the latter are only reached when the lower level wraps.
+  //
+  for (Level = 0; Level < TIMER_WHEEL_LEVEL_COUNT; Level++) {
+    Shift   = Level * TIMER_WHEEL_SLOT_SHIFT;
+    Index   = (UINTN)RShiftU64 (Wheel->CurrentTick, Shift) & (TIMER_WHEEL_SLOT_COUNT - 1);
+    Pending = Wheel->SlotMap[Level] & ~(LShiftU64 (2, Index) - 1);
+    if (Pending != 0) {
+      return LShiftU64 (RShiftU64 (Wheel->CurrentTick, Shift + TIMER_WHEEL_SLOT_SHIFT), Shift + TIMER_WHEEL_SLOT_SHIFT) +
+             LShiftU64 ((UINT64)LowBitSet64 (Pending), Shift);
+    }
+  }
+
+  return MAX_UINT64;
+}
+
+/**
+  Advance a timing wheel to a tick, moving all entries whose tick is reached
+  to the expired list. Ticks without slots to process are skipped.
+
+  @param  Wheel                  The timing wheel.
+  @param  Tick                   The tick to advance to.
+
+**/
+STATIC
+VOID
+TimerWheelAdvance (
+  IN OUT TIMER_WHEEL  *Wheel,
+  IN     UINT64       Tick
+  )
+{
+  UINT64  NextTick;
+  UINTN   Level;
+  UINTN   Shift;
+
+  while (Wheel->CurrentTick < Tick) {
+    NextTick = TimerWheelNextTick (Wheel);
+    if (NextTick > Tick) {
+      Wheel->CurrentTick = Tick;
+      break;
+    }
+
+    Wheel->CurrentTick = NextTick;
+
+    //
+    // Cascade the higher levels that wrap at this tick, highest first, then
+    // collect the level 0 slot
+    //
+    for (Level = TIMER_WHEEL_LEVEL_COUNT - 1; Level > 0; Level--) {
+      Shift = Level * TIMER_WHEEL_SLOT_SHIFT;
+      if ((NextTick & (LShiftU64 (1, Shift) - 1)) == 0) {
+        TimerWheelCascade (Wheel, Level, (UINTN)RShiftU64 (NextTick, Shift) & (TIMER_WHEEL_SLOT_COUNT - 1));
+      }
+    }
+
+    TimerWheelCascade (Wheel, 0, (UINTN)NextTick & (TIMER_WHEEL_SLOT_COUNT - 1));
+  }
+}
+
+/**
+  Initialize an empty timing wheel.
+
+  @param  Wheel                  The timing wheel.
+
+**/
+VOID
+TimerWheelInitialize (
+  OUT TIMER_WHEEL  *Wheel
+  )
+{
+  UINTN  Level;
+  UINTN  Slot;
+
+  for (Level = 0; Level < TIMER_WHEEL_LEVEL_COUNT; Level++) {
+    for (Slot = 0; Slot < TIMER_WHEEL_SLOT_COUNT; Slot++) {
+      InitializeListHead (&Wheel->Slots[Level][Slot]);
+    }
+
+    Wheel->SlotMap[Level] = 0;
+  }
+
+  InitializeListHead (&Wheel->Expired);
+  Wheel->CurrentTick     = 0;
+  Wheel->Sequence        = 0;
+  Wheel->NextTriggerTime = MAX_UINT64;
+}
+
+/**
+  Queue an entry on a timing wheel. Entry->TriggerTime must be set by the
+  caller.
+
+  @param  Wheel                  The timing wheel.
+  @param  Entry                  The entry to queue.
+
+**/
+VOID
+TimerWheelInsert (
+  IN OUT TIMER_WHEEL        *Wheel,
+  IN OUT TIMER_WHEEL_ENTRY  *Entry
+  )
+{
+  Entry->Sequence = Wheel->Sequence++;
+  TimerWheelPlace (Wheel, Entry);
+
+  if (Entry->TriggerTime < Wheel->NextTriggerTime) {
+    Wheel->NextTriggerTime = Entry->TriggerTime;
+  }
+}
+
+/**
+  Remove a queued entry from a timing wheel.
+
+  The slot the entry was on is left marked in use, it is cleaned up when the
+  wheel reaches it.
+
+  @param  Wheel                  The timing wheel.
+  @param  Entry                  The entry to remove.
+
+**/
+VOID
+TimerWheelRemove (
+  IN OUT TIMER_WHEEL        *Wheel,
+  IN OUT TIMER_WHEEL_ENTRY  *Entry
+  )
+{
+  ASSERT (Entry->Link.ForwardLink != NULL);
+
+  RemoveEntryList (&Entry->Link);
+  Entry->Link.ForwardLink = NULL;
+}
+
+/**
+  Remove and return the entry that expires first, if it has expired.
+
+  Entries are returned in ascending trigger time. Entries with the same
+  trigger time are returned in the order they were inserted.
+
+  @param  Wheel                  The timing wheel.
+  @param  Time                   The current time.
+
+  @return The first entry whose trigger time is not after Time, or NULL if
+          there is none.
+
+**/
+TIMER_WHEEL_ENTRY *
+TimerWheelRemoveExpired (
+  IN OUT TIMER_WHEEL  *Wheel,
+  IN     UINT64       Time
+  )
+{
+  TIMER_WHEEL_ENTRY  *Entry;
+  UINT64             NextTick;
+
+  //
+  // Every entry that expires by Time is on the expired list after this
+  //
+  TimerWheelAdvance (Wheel, RShiftU64 (Time, TIMER_WHEEL_TICK_SHIFT));
+
+  if (!IsListEmpty (&Wheel->Expired)) {
+    Entry = BASE_CR (Wheel->Expired.ForwardLink, TIMER_WHEEL_ENTRY, Link);
+    if (Entry->TriggerTime <= Time) {
+      TimerWheelRemove (Wheel, Entry);
+      return Entry;
+    }
+
+    Wheel->NextTriggerTime = Entry->TriggerTime;
+    return NULL;
+  }
+
+  //
+  // Nothing is due before the next slot is reached
+  //
+  NextTick = TimerWheelNextTick (Wheel);
+  if (NextTick == MAX_UINT64) {
+    Wheel->NextTriggerTime = MAX_UINT64;
+  } else {
+    Wheel->NextTriggerTime = LShiftU64 (NextTick, TIMER_WHEEL_TICK_SHIFT);
+  }
+
+  return NULL;
+}
+
+/**
+  Return a lower bound of the trigger times of the queued entries. The bound
+  is refreshed each time TimerWheelRemoveExpired() returns NULL, and may be
+  stale after entries are removed.
+
+  @param  Wheel                  The timing wheel.
+
+  @return The lower bound, or MAX_UINT64 if the wheel is empty.
+
+**/
+UINT64
+TimerWheelNextTriggerTime (
+  IN TIMER_WHEEL  *Wheel
+  )
+{
+  return Wheel->NextTriggerTime;
+}
@@ -0,0 +1,134 @@
+/** @file
+  Hierarchical timing wheel used to queue DXE core timer events.
+
+  Time is kept in the 100ns units of the DXE core system time and is grouped
+  into wheel ticks of 2^TIMER_WHEEL_TICK_SHIFT units. Each level of the wheel
+  has TIMER_WHEEL_SLOT_COUNT slots and covers TIMER_WHEEL_SLOT_COUNT times the
+  range of the level below it; entries are cascaded to lower levels as the
+  wheel advances. Entries whose tick has been reached are kept on a separate
+  list sorted by trigger time and then by insertion order, so that expired
+  entries are handed out in exactly the order of a sorted timer list.
+
+  This file does not depend on the rest of the DXE core so that it can be
+  built into host based unit tests.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __TIMER_WHEEL_H__
+#define __TIMER_WHEEL_H__
+
+#define TIMER_WHEEL_TICK_SHIFT   16
+#define TIMER_WHEEL_SLOT_SHIFT   6
+#define TIMER_WHEEL_SLOT_COUNT   (1 << TIMER_WHEEL_SLOT_SHIFT)
+#define TIMER_WHEEL_LEVEL_COUNT  ((64 - TIMER_WHEEL_TICK_SHIFT + TIMER_WHEEL_SLOT_SHIFT - 1) / TIMER_WHEEL_SLOT_SHIFT)
+
+///
+/// Entry embedded in every structure queued on a timing wheel
+///
+typedef struct {
+  ///
+  /// Link on a wheel slot or on the expired list. ForwardLink is NULL while
+  /// the entry is not queued.
+  ///
+  LIST_ENTRY    Link;
+  UINT64        TriggerTime;
+  ///
+  /// Insertion order, breaks ties between equal trigger times
+  ///
+  UINT64        Sequence;
+} TIMER_WHEEL_ENTRY;
+
+typedef struct {
+  LIST_ENTRY    Slots[TIMER_WHEEL_LEVEL_COUNT][TIMER_WHEEL_SLOT_COUNT];
+  ///
+  /// Bit N of SlotMap[L] is set if Slots[L][N] may be non-empty
+  ///
+  UINT64        SlotMap[TIMER_WHEEL_LEVEL_COUNT];
+  ///
+  /// Entries whose tick is not after CurrentTick, in firing order
+  ///
+  LIST_ENTRY    Expired;
+  UINT64        CurrentTick;
+  UINT64        Sequence;
+  ///
+  /// No queued entry has a trigger time below this value
+  ///
+  UINT64        NextTriggerTime;
+} TIMER_WHEEL;
+
+/**
+  Initialize an empty timing wheel.
+
+  @param  Wheel                  The timing wheel.
+
+**/
+VOID
+TimerWheelInitialize (
+  OUT TIMER_WHEEL  *Wheel
+  );
+
+/**
+  Queue an entry on a timing wheel. Entry->TriggerTime must be set by the
+  caller.
+
+  @param  Wheel                  The timing wheel.
+  @param  Entry                  The entry to queue.
+
+**/
+VOID
+TimerWheelInsert (
+  IN OUT TIMER_WHEEL        *Wheel,
+  IN OUT TIMER_WHEEL_ENTRY  *Entry
+  );
+
+/**
+  Remove a queued entry from a timing wheel.
+
+  @param  Wheel                  The timing wheel.
+  @param  Entry                  The entry to remove.
+
+**/
+VOID
+TimerWheelRemove (
+  IN OUT TIMER_WHEEL        *Wheel,
+  IN OUT TIMER_WHEEL_ENTRY  *Entry
+  );
+
+/**
+  Remove and return the entry that expires first, if it has expired.
+
+  Entries are returned in ascending trigger time. Entries with the same
+  trigger time are returned in the order they were inserted.
+
+  @param  Wheel                  The timing wheel.
+  @param  Time                   The current time.
+
+  @return The first entry whose trigger time is not after Time, or NULL if
+          there is none.
+
+**/
+TIMER_WHEEL_ENTRY *
+TimerWheelRemoveExpired (
+  IN OUT TIMER_WHEEL  *Wheel,
+  IN     UINT64       Time
+  );
+
+/**
+  Return a lower bound of the trigger times of the queued entries. The bound
+  is refreshed each time TimerWheelRemoveExpired() returns NULL, and may be
+  stale after entries are removed.
+
+  @param  Wheel                  The timing wheel.
+
+  @return The lower bound, or MAX_UINT64 if the wheel is empty.
+
+**/
+UINT64
+TimerWheelNextTriggerTime (
+  IN TIMER_WHEEL  *Wheel
+  );
+
+#endif
@@ -0,0 +1,617 @@
+/** @file
+  Host based unit tests of the DXE core timer wheel.
+
+  The timer wheel replaced a timer list kept sorted by trigger time. These
+  tests drive a copy of the sorted list algorithm and the timer wheel with the
+  same timer operations and check that timers fire in the same order.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+#include <Library/UnitTestRandomLib.h>
+
+#include "../TimerWheel.h"
+
+#define UNIT_TEST_APP_NAME     "DXE Core Timer Wheel Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_TIMER_COUNT     64
+#define TEST_FIRED_MAX       (4 * TEST_TIMER_COUNT)
+#define TEST_DEFAULT_PERIOD  100000
+#define TEST_RANDOM_STEPS    20000
+
+typedef enum {
+  TestTimerCancel,
+  TestTimerPeriodic,
+  TestTimerRelative
+} TEST_TIMER_DELAY;
+
+typedef struct {
+  UINTN                Id;
+  ///
+  /// State of the timer in the sorted list model
+  ///
+  LIST_ENTRY           ListLink;
+  UINT64               ListTriggerTime;
+  UINT64               ListPeriod;
+  ///
+  /// State of the timer in the timer wheel
+  ///
+  TIMER_WHEEL_ENTRY    WheelEntry;
+  UINT64               WheelPeriod;
+} TEST_TIMER;
+
+typedef struct {
+  LIST_ENTRY     TimerList;
+  TIMER_WHEEL    Wheel;
+  TEST_TIMER     Timers[TEST_TIMER_COUNT];
+  UINT64         SystemTime;
+  UINT64         Seed;
+  UINTN          ListFired[TEST_FIRED_MAX];
+  UINTN          ListFiredCount;
+  UINTN          WheelFired[TEST_FIRED_MAX];
+  UINTN          WheelFiredCount;
+} TEST_CONTEXT;
+
+/**
+  Return a pseudo random 64-bit value below Limit.
+
+  @param[in, out] Context  The test context holding the seed.
+  @param[in]      Limit    The exclusive upper bound.
+
+  @return The pseudo random value.
+**/
+STATIC
+UINT64
+TestRandomBelow (
+  IN OUT TEST_CONTEXT  *Context,
+  IN     UINT64        Limit
+  )
+{
+  UINT64  Value;
+
+  Value = LShiftU64 (UnitTestRandom (&Context->Seed), 31) | UnitTestRandom (&Context->Seed);
+  return Value % Limit;
+}
+
+/**
+  Insert a timer into the sorted list, as the DXE core did before the timer
+  wheel was introduced.
+
+  @param[in, out] Context  The test context.
+  @param[in, out] Timer    The timer to insert.
+**/
+STATIC
+VOID
+ListInsertTimer (
+  IN OUT TEST_CONTEXT  *Context,
+  IN OUT TEST_TIMER    *Timer
+  )
+{
+  LIST_ENTRY  *Link;
+  TEST_TIMER  *Timer2;
+
+  for (Link = Context->TimerList.ForwardLink; Link != &Context->TimerList; Link = Link->ForwardLink) {
+    Timer2 = BASE_CR (Link, TEST_TIMER, ListLink);
+    if (Timer2->ListTriggerTime > Timer->ListTriggerTime) {
+      break;
+    }
+  }
+
+  InsertTailList (Link, &Timer->ListLink);
+}
+
+/**
+  Set a timer of the sorted list model, following CoreSetTimer().
+
+  @param[in, out] Context      The test context.
+  @param[in, out] Timer        The timer to set.
+  @param[in]      Type         The type of the timer.
+  @param[in]      TriggerTime  The relative trigger time or period.
+**/
+STATIC
+VOID
+ListSetTimer (
+  IN OUT TEST_CONTEXT      *Context,
+  IN OUT TEST_TIMER        *Timer,
+  IN     TEST_TIMER_DELAY  Type,
+  IN     UINT64            TriggerTime
+  )
+{
+  if (Timer->ListLink.ForwardLink != NULL) {
+    RemoveEntryList (&Timer->ListLink);
+    Timer->ListLink.ForwardLink = NULL;
+  }
+
+  Timer->ListTriggerTime = 0;
+  Timer->ListPeriod      = 0;
+
+  if (Type != TestTimerCancel) {
+    if (Type == TestTimerPeriodic) {
+      Timer->ListPeriod = TriggerTime;
+    }
+
+    Timer->ListTriggerTime = Context->SystemTime + TriggerTime;
+    ListInsertTimer (Context, Timer);
+  }
+}
+
+/**
+  Fire the expired timers of the sorted list model, following
+  CoreCheckTimers().
+
+  @param[in, out] Context  The test context.
+**/
+STATIC
+VOID
+ListCheckTimers (
+  IN OUT TEST_CONTEXT  *Context
+  )
+{
+  TEST_TIMER  *Timer;
+
+  Context->ListFiredCount = 0;
+
+  while (!IsListEmpty (&Context->TimerList)) {
+    Timer = BASE_CR (Context->TimerList.ForwardLink, TEST_TIMER, ListLink);
+    if (Timer->ListTriggerTime > Context->SystemTime) {
+      break;
+    }
+
+    RemoveEntryList (&Timer->ListLink);
+    Timer->ListLink.ForwardLink = NULL;
+
+    ASSERT (Context->ListFiredCount < TEST_FIRED_MAX);
+    Context->ListFired[Context->ListFiredCount++] = Timer->Id;
+
+    if (Timer->ListPeriod != 0) {
+      Timer->ListTriggerTime = Timer->ListTriggerTime + Timer->ListPeriod;
+      if (Timer->ListTriggerTime <= Context->SystemTime) {
+        Timer->ListTriggerTime = Context->SystemTime;
+      }
+
+      ListInsertTimer (Context, Timer);
+    }
+  }
+}
+
+/**
+  Set a timer of the timer wheel, following CoreSetTimer().
+
+  @param[in, out] Context      The test context.
+  @param[in, out] Timer        The timer to set.
+  @param[in]      Type         The type of the timer.
+  @param[in]      TriggerTime  The relative trigger time or period.
+**/
+STATIC
+VOID
+WheelSetTimer (
+  IN OUT TEST_CONTEXT      *Context,
+  IN OUT TEST_TIMER        *Timer,
+  IN     TEST_TIMER_DELAY  Type,
+  IN     UINT64            TriggerTime
+  )
+{
+  if (Timer->WheelEntry.Link.ForwardLink != NULL) {
+    TimerWheelRemove (&Context->Wheel, &Timer->WheelEntry);
+  }
+
+  Timer->WheelEntry.TriggerTime = 0;
+  Timer->WheelPeriod            = 0;
+
+  if (Type != TestTimerCancel) {
+    if (Type == TestTimerPeriodic) {
+      Timer->WheelPeriod = TriggerTime;
+    }
+
+    Timer->WheelEntry.TriggerTime = Context->SystemTime + TriggerTime;
+    TimerWheelInsert (&Context->Wheel, &Timer->WheelEntry);
+  }
+}
+
+/**
+  Fire the expired timers of the timer wheel, following CoreCheckTimers().
+
+  @param[in, out] Context  The test context.
+**/
+STATIC
+VOID
+WheelCheckTimers (
+  IN OUT TEST_CONTEXT  *Context
+  )
+{
+  TIMER_WHEEL_ENTRY  *Entry;
+  TEST_TIMER         *Timer;
+
+  Context->WheelFiredCount = 0;
+
+  while (TRUE) {
+    Entry = TimerWheelRemoveExpired (&Context->Wheel, Context->SystemTime);
+    if (Entry == NULL) {
+      break;
+    }
+
+    Timer = BASE_CR (Entry, TEST_TIMER, WheelEntry);
+
+    ASSERT (Context->WheelFiredCount < TEST_FIRED_MAX);
+    Context->WheelFired[Context->WheelFiredCount++] = Timer->Id;
+
+    if (Timer->WheelPeriod != 0) {
+      Timer->WheelEntry.TriggerTime = Timer->WheelEntry.TriggerTime + Timer->WheelPeriod;
+      if (Timer->WheelEntry.TriggerTime <= Context->SystemTime) {
+        Timer->WheelEntry.TriggerTime = Context->SystemTime;
+      }
+
+      TimerWheelInsert (&Context->Wheel, &Timer->WheelEntry);
+    }
+  }
+}
+
+/**
+  Set a timer in both models.
+
+  @param[in, out] Context      The test context.
+  @param[in]      Id           The index of the timer.
+  @param[in]      Type         The type of the timer.
+  @param[in]      TriggerTime  The relative trigger time or period.
+**/
+STATIC
+VOID
+TestSetTimer (
+  IN OUT TEST_CONTEXT      *Context,
+  IN     UINTN             Id,
+  IN     TEST_TIMER_DELAY  Type,
+  IN     UINT64            TriggerTime
+  )
+{
+  ListSetTimer (Context, &Context->Timers[Id], Type, TriggerTime);
+  WheelSetTimer (Context, &Context->Timers[Id], Type, TriggerTime);
+}
+
+/**
+  Advance the system time, fire the expired timers of both models and check
+  that they fired the same timers in the same order.
+
+  @param[in, out] Context   The test context.
+  @param[in]      Duration  The time to advance by.
+
+  @retval  UNIT_TEST_PASSED             Both models fired the same timers.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The models disagree.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestTick (
+  IN OUT TEST_CONTEXT  *Context,
+  IN     UINT64        Duration
+  )
+{
+  LIST_ENTRY  *Link;
+  TEST_TIMER  *Timer;
+
+  Context->SystemTime += Duration;
+  ListCheckTimers (Context);
+  WheelCheckTimers (Context);
+
+  UT_ASSERT_EQUAL (Context->WheelFiredCount, Context->ListFiredCount);
+  UT_ASSERT_MEM_EQUAL (Context->WheelFired, Context->ListFired, Context->ListFiredCount * sizeof (UINTN));
+
+  //
+  // The timer wheel must never report a next trigger time after the one of
+  // the earliest queued timer
+  //
+  Link = GetFirstNode (&Context->TimerList);
+  if (!IsNull (&Context->TimerList, Link)) {
+    Timer = BASE_CR (Link, TEST_TIMER, ListLink);
+    UT_ASSERT_TRUE (TimerWheelNextTriggerTime (&Context->Wheel) <= Timer->ListTriggerTime);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Prepare an empty test context.
+
+  @param[in]  Context  The test context.
+
+  @retval  UNIT_TEST_PASSED  The context is ready.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+TimerWheelTestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINTN         Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  ZeroMem (TestContext, sizeof (TEST_CONTEXT));
+
+  InitializeListHead (&TestContext->TimerList);
+  TimerWheelInitialize (&TestContext->Wheel);
+  for (Index = 0; Index < TEST_TIMER_COUNT; Index++) {
+    TestContext->Timers[Index].Id = Index;
+  }
+
+  TestContext->Seed = 0x5EED;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Timers with the same trigger time fire in the order they were set, even if
+  one of them was placed on a higher level of the wheel.
+
+  @param[in]  Context  The test context.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+EqualTriggerTimesFireInInsertionOrder (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT      *TestContext;
+  UNIT_TEST_STATUS  Status;
+  UINTN             Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  //
+  // Timer 0 is set long before the timers that expire at the same time
+  //
+  TestSetTimer (TestContext, 0, TestTimerRelative, 50000000);
+  Status = TestTick (TestContext, 49990000);
+  UT_ASSERT_EQUAL (Status, UNIT_TEST_PASSED);
+  UT_ASSERT_EQUAL (TestContext->WheelFiredCount, 0);
+
+  for (Index = 1; Index < 8; Index++) {
+    TestSetTimer (TestContext, 8 - Index, TestTimerRelative, 10000);
+  }
+
+  Status = TestTick (TestContext, 10000);
+  UT_ASSERT_EQUAL (Status, UNIT_TEST_PASSED);
+  UT_ASSERT_EQUAL (TestContext->WheelFiredCount, 8);
+  UT_ASSERT_EQUAL (TestContext->WheelFired[0], 0);
+  UT_ASSERT_EQUAL (TestContext->WheelFired[1], 7);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Periodic timers that fall behind and cancelled timers behave as with the
+  sorted list.
+
+  @param[in]  Context  The test context.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+PeriodicAndCancelledTimers (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT      *TestContext;
+  UNIT_TEST_STATUS  Status;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  TestSetTimer (TestContext, 0, TestTimerPeriodic, TEST_DEFAULT_PERIOD);
+  TestSetTimer (TestContext, 1, TestTimerPeriodic, 3 * TEST_DEFAULT_PERIOD);
+  TestSetTimer (TestContext, 2, TestTimerRelative, 2 * TEST_DEFAULT_PERIOD);
+  TestSetTimer (TestContext, 3, TestTimerRelative, 0);
+
+  Status = TestTick (TestContext, 0);
+  UT_ASSERT_EQUAL (Status, UNIT_TEST_PASSED);
+  UT_ASSERT_EQUAL (TestContext->WheelFiredCount, 1);
+
+  TestSetTimer (TestContext, 2, TestTimerCancel, 0);
+
+  //
+  // A long stall makes both periodic timers fall behind
+  //
+  Status = TestTick (TestContext, 1000 * TEST_DEFAULT_PERIOD);
+  UT_ASSERT_EQUAL (Status, UNIT_TEST_PASSED);
+  UT_ASSERT_EQUAL (TestContext->WheelFiredCount, 4);
+
+  Status = TestTick (TestContext, TEST_DEFAULT_PERIOD);
+  UT_ASSERT_EQUAL (Status, UNIT_TEST_PASSED);
+  UT_ASSERT_EQUAL (TestContext->WheelFiredCount, 1);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Random timer operations over short and very long time spans fire the same
+  timers in the same order as the sorted list.
+
+  @param[in]  Context  The test context.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+RandomTimersFireInListOrder (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT      *TestContext;
+  UNIT_TEST_STATUS  Status;
+  UINTN             Step;
+  UINTN             Id;
+  UINT32            Choice;
+  UINT64            Delay;
+  TEST_TIMER_DELAY  Type;
+  UINTN             FiredCount;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  FiredCount  = 0;
+
+  for (Step = 0; Step < TEST_RANDOM_STEPS; Step++) {
+    Choice = UnitTestRandom (&TestContext->Seed) % 100;
+    if (Choice < 45) {
+      Id     = UnitTestRandom (&TestContext->Seed) % TEST_TIMER_COUNT;
+      Choice = UnitTestRandom (&TestContext->Seed) % 100;
+      if (Choice < 10) {
+        Delay = 0;
+      } else if (Choice < 40) {
+        Delay = TestRandomBelow (TestContext, LShiftU64 (1, TIMER_WHEEL_TICK_SHIFT));
+      } else if (Choice < 80) {
+        Delay = TestRandomBelow (TestContext, 10000000);
+      } else if (Choice < 95) {
+        Delay = TestRandomBelow (TestContext, 36000000000ULL);
+      } else {
+        Delay = TestRandomBelow (TestContext, LShiftU64 (1, 50));
+      }
+
+      Choice = UnitTestRandom (&TestContext->Seed) % 10;
+      if (Choice == 0) {
+        Type = TestTimerCancel;
+      } else if ((Choice < 4) && (Delay != 0)) {
+        Type = TestTimerPeriodic;
+      } else {
+        Type = TestTimerRelative;
+      }
+
+      TestSetTimer (TestContext, Id, Type, Delay);
+    } else {
+      Choice = UnitTestRandom (&TestContext->Seed) % 100;
+      if (Choice < 90) {
+        Delay = TestRandomBelow (TestContext, 200000);
+      } else if (Choice < 99) {
+        Delay = TestRandomBelow (TestContext, 100000000);
+      } else {
+        Delay = TestRandomBelow (TestContext, 864000000000ULL);
+      }
+
+      Status = TestTick (TestContext, Delay);
+      UT_ASSERT_EQUAL (Status, UNIT_TEST_PASSED);
+      FiredCount += TestContext->WheelFiredCount;
+    }
+  }
+
+  UT_LOG_INFO ("%d timers fired\n", FiredCount);
+  UT_ASSERT_TRUE (FiredCount > 0);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the timer
+  wheel and run the timer wheel unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      TimerWheelTests;
+  TEST_CONTEXT                *TestContext;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  TestContext = AllocateZeroPool (sizeof (TEST_CONTEXT));
+  if (TestContext == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the timer wheel Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&TimerWheelTests, Framework, "Timer Wheel Ordering Tests", "DxeCore.TimerWheel", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Timer Wheel Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite-----------Description-----------------------------------Name-------------Function--------------------------------Pre--------------------Post---Context-----
+  //
+  AddTestCase (TimerWheelTests, "Equal trigger times fire in insertion order", "EqualTrigger", EqualTriggerTimesFireInInsertionOrder, TimerWheelTestSetup, NULL, TestContext);
+  AddTestCase (TimerWheelTests, "Periodic and cancelled timers", "PeriodicCancel", PeriodicAndCancelledTimers, TimerWheelTestSetup, NULL, TestContext);
+  AddTestCase (TimerWheelTests, "Random timers fire in sorted list order", "Random", RandomTimersFireInListOrder, TimerWheelTestSetup, NULL, TestContext);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  if (TestContext != NULL) {
+    FreePool (TestContext);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define TimerWheelUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+TimerWheelUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
@@ -8,9 +8,9 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
 
+#include "DxeMain.h"
 #include <Pi/PiDxeCis.h>
 #include <Pi/PiHob.h>
-#include "DxeMain.h"
 #include "Gcd.h"
 #include "Mem/HeapGuard.h"
 
@@ -45,6 +45,16 @@ EFI_LOCK    mGcdIoSpaceLock     = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
 LIST_ENTRY  mGcdMemorySpaceMap  = INITIALIZE_LIST_HEAD_VARIABLE (mGcdMemorySpaceMap);
 LIST_ENTRY  mGcdIoSpaceMap      = INITIALIZE_LIST_HEAD_VARIABLE (mGcdIoSpaceMap);
 
+//
+// Red-black tree indexes of the GCD maps, ordered by base address. The lists
+// above stay authoritative for ordered walks; the indexes only speed up the
+// lookup of the entry containing an address. An index is NULL before the GCD
+// services are initialized, or after an entry could not be indexed, in which
+// case lookups fall back to walking the list.
+//
+ORDERED_COLLECTION  *mGcdMemorySpaceIndex = NULL;
+ORDERED_COLLECTION  *mGcdIoSpaceIndex     = NULL;
+
 EFI_GCD_MAP_ENTRY  mGcdMemorySpaceMapEntryTemplate = {
   EFI_GCD_MAP_SIGNATURE,
   {
@@ -58,6 +68,7 @@ EFI_GCD_MAP_ENTRY  mGcdMemorySpaceMapEntryTemplate = {
   EfiGcdMemoryTypeNonExistent,
   (EFI_GCD_IO_TYPE)0,
   NULL,
+  NULL,
   NULL
 };
 
@@ -74,6 +85,7 @@ EFI_GCD_MAP_ENTRY  mGcdIoSpaceMapEntryTemplate = {
   (EFI_GCD_MEMORY_TYPE)0,
   EfiGcdIoTypeNonExistent,
   NULL,
+  NULL,
   NULL
 };
 
@@ -375,6 +387,281 @@ PageAlignLength (
 // GCD Memory Space Worker Functions
 //
 
+/**
+  Compare two GCD map entries by base address.
+
+  @param  UserStruct1            The first EFI_GCD_MAP_ENTRY.
+  @param  UserStruct2            The second EFI_GCD_MAP_ENTRY.
+
+  @retval <0                     UserStruct1 is below UserStruct2.
+  @retval 0                      Both entries start at the same address.
+  @retval >0                     UserStruct1 is above UserStruct2.
+
+**/
+STATIC
+INTN
+EFIAPI
+CoreCompareGcdMapEntry (
+  IN CONST VOID  *UserStruct1,
+  IN CONST VOID  *UserStruct2
+  )
+{
+  CONST EFI_GCD_MAP_ENTRY  *Entry1;
+  CONST EFI_GCD_MAP_ENTRY  *Entry2;
+
+  Entry1 = UserStruct1;
+  Entry2 = UserStruct2;
+
+  if (Entry1->BaseAddress < Entry2->BaseAddress) {
+    return -1;
+  }
+
+  if (Entry1->BaseAddress > Entry2->BaseAddress) {
+    return 1;
+  }
+
+  return 0;
+}
+
+/**
+  Compare an address against the range covered by a GCD map entry.
+
+  GCD map entries never overlap, so an address compares equal to exactly
+  the entry that contains it.
+
+  @param  StandaloneKey          Pointer to the EFI_PHYSICAL_ADDRESS to look up.
+  @param  UserStruct             The EFI_GCD_MAP_ENTRY.
+
+  @retval <0                     The address is below the entry.
+  @retval 0                      The address is within the entry.
+  @retval >0                     The address is above the entry.
+
+**/
+STATIC
+INTN
+EFIAPI
+CoreCompareGcdMapEntryAddress (
+  IN CONST VOID  *StandaloneKey,
+  IN CONST VOID  *UserStruct
+  )
+{
+  EFI_PHYSICAL_ADDRESS     Address;
+  CONST EFI_GCD_MAP_ENTRY  *Entry;
+
+  Address = *(CONST EFI_PHYSICAL_ADDRESS *)StandaloneKey;
+  Entry   = UserStruct;
+
+  if (Address < Entry->BaseAddress) {
+    return -1;
+  }
+
+  if (Address > Entry->EndAddress) {
+    return 1;
+  }
+
+  return 0;
+}
+
+/**
+  Return the address index of a GCD map.
+
+  @param  Map                    The GCD map.
+
+  @return Pointer to the index of the map.
+
+**/
+STATIC
+ORDERED_COLLECTION **
+CoreGetGcdMapIndex (
+  IN LIST_ENTRY  *Map
+  )
+{
+  if (Map == &mGcdMemorySpaceMap) {
+    return &mGcdMemorySpaceIndex;
+  }
+
+  ASSERT (Map == &mGcdIoSpaceMap);
+  return &mGcdIoSpaceIndex;
+}
+
+/**
+  Create the address index of a GCD map holding a single entry.
+
+  @param  Map                    The GCD map.
+  @param  Entry                  The only entry of the GCD map.
+
+**/
+STATIC
+VOID
+CoreInitializeGcdMapIndex (
+  IN LIST_ENTRY         *Map,
+  IN EFI_GCD_MAP_ENTRY  *Entry
+  )
+{
+  ORDERED_COLLECTION  **Index;
+
+  Index  = CoreGetGcdMapIndex (Map);
+  *Index = OrderedCollectionInit (CoreCompareGcdMapEntry, CoreCompareGcdMapEntryAddress);
+  if ((*Index == NULL) ||
+      RETURN_ERROR (OrderedCollectionInsert (*Index, &Entry->IndexEntry, Entry)))
+  {
+    DEBUG ((DEBUG_WARN, "GCD: Failed to create the map index, lookups will walk the map\n"));
+    if (*Index != NULL) {
+      OrderedCollectionUninit (*Index);
+      *Index = NULL;
+    }
+
+    Entry->IndexEntry = NULL;
+  }
+}
+
+/**
+  Discard the address index of a GCD map. Lookups in the map walk the list
+  from then on.
+
+  @param  Map                    The GCD map.
+
+**/
+STATIC
+VOID
+CoreDiscardGcdMapIndex (
+  IN LIST_ENTRY  *Map
+  )
+{
+  ORDERED_COLLECTION  **Index;
+  LIST_ENTRY          *Link;
+  EFI_GCD_MAP_ENTRY   *Entry;
+
+  Index = CoreGetGcdMapIndex (Map);
+  if (*Index == NULL) {
+    return;
+  }
+
+  DEBUG ((DEBUG_WARN, "GCD: Discarding the map index, lookups will walk the map\n"));
+
+  for (Link = Map->ForwardLink; Link != Map; Link = Link->ForwardLink) {
+    Entry = CR (Link, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
+    if (Entry->IndexEntry != NULL) {
+      OrderedCollectionDelete (*Index, Entry->IndexEntry, NULL);
+      Entry->IndexEntry = NULL;
+    }
+  }
+
+  OrderedCollectionUninit (*Index);
+  *Index = NULL;
+}
+
+/**
+  Add an entry that was just linked into a GCD map to the index of the map.
+
+  Entries are split and merged in place. Since GCD map entries never overlap,
+  this never changes the order of the indexed entries, so they do not have to
+  be re-indexed when their addresses are updated.
+
+  @param  Map                    The GCD map.
+  @param  Entry                  The entry to add to the index.
+
+**/
+STATIC
+VOID
+CoreIndexGcdMapEntry (
+  IN LIST_ENTRY         *Map,
+  IN EFI_GCD_MAP_ENTRY  *Entry
+  )
+{
+  ORDERED_COLLECTION  **Index;
+  RETURN_STATUS       Status;
+
+  //
+  // The entry may be a copy of an indexed entry
+  //
+  Entry->IndexEntry = NULL;
+
+  Index = CoreGetGcdMapIndex (Map);
+  if (*Index == NULL) {
+    return;
+  }
+
+  //
+  // Same as CoreAllocateGcdMapEntry(), the index node must not be guarded
+  //
+  mOnGuarding = TRUE;
+  Status      = OrderedCollectionInsert (*Index, &Entry->IndexEntry, Entry);
+  mOnGuarding = FALSE;
+  if (RETURN_ERROR (Status)) {
+    ASSERT (Status == RETURN_OUT_OF_RESOURCES);
+    Entry->IndexEntry = NULL;
+    CoreDiscardGcdMapIndex (Map);
+  }
+}
+
+/**
+  Remove an entry that is about to be unlinked from a GCD map from the index
+  of the map.
+
+  @param  Map                    The GCD map.
+  @param  Entry                  The entry to remove from the index.
+
+**/
+STATIC
+VOID
+CoreUnindexGcdMapEntry (
+  IN LIST_ENTRY         *Map,
+  IN EFI_GCD_MAP_ENTRY  *Entry
+  )
+{
+  ORDERED_COLLECTION  **Index;
+
+  Index = CoreGetGcdMapIndex (Map);
+  if ((*Index != NULL) && (Entry->IndexEntry != NULL)) {
+    OrderedCollectionDelete (*Index, Entry->IndexEntry, NULL);
+  }
+
+  Entry->IndexEntry = NULL;
+}
+
+/**
+  Find the GCD map entry that contains an address.
+
+  @param  Map                    The GCD map.
+  @param  Address                The address to look up.
+
+  @return The link of the entry containing Address, or NULL if there is none.
+
+**/
+STATIC
+LIST_ENTRY *
+CoreFindGcdMapEntry (
+  IN LIST_ENTRY            *Map,
+  IN EFI_PHYSICAL_ADDRESS  Address
+  )
+{
+  ORDERED_COLLECTION        **Index;
+  ORDERED_COLLECTION_ENTRY  *IndexEntry;
+  LIST_ENTRY                *Link;
+  EFI_GCD_MAP_ENTRY         *Entry;
+
+  Index = CoreGetGcdMapIndex (Map);
+  if (*Index != NULL) {
+    IndexEntry = OrderedCollectionFind (*Index, &Address);
+    if (IndexEntry == NULL) {
+      return NULL;
+    }
+
+    Entry = OrderedCollectionUserStruct (IndexEntry);
+    return &Entry->Link;
+  }
+
+  for (Link = Map->ForwardLink; Link != Map; Link = Link->ForwardLink) {
+    Entry = CR (Link, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
+    if ((Address >= Entry->BaseAddress) && (Address <= Entry->EndAddress)) {
+      return Link;
+    }
+  }
+
+  return NULL;
+}
+
 /**
   Allocate pool for two entries.
 
@@ -417,6 +704,7 @@ CoreAllocateGcdMapEntry (
 /**
   Internal function.  Inserts a new descriptor into a sorted list
 
+  @param  Map                    The GCD map that Link belongs to
   @param  Link                   The linked list to insert the range BaseAddress
                                  and Length into
   @param  Entry                  A pointer to the entry that is inserted
@@ -430,6 +718,7 @@ CoreAllocateGcdMapEntry (
 **/
 EFI_STATUS
 CoreInsertGcdMapEntry (
+  IN LIST_ENTRY            *Map,
   IN LIST_ENTRY            *Link,
   IN EFI_GCD_MAP_ENTRY     *Entry,
   IN EFI_PHYSICAL_ADDRESS  BaseAddress,
@@ -447,6 +736,7 @@ CoreInsertGcdMapEntry (
     Entry->BaseAddress      = BaseAddress;
     BottomEntry->EndAddress = BaseAddress - 1;
     InsertTailList (Link, &BottomEntry->Link);
+    CoreIndexGcdMapEntry (Map, BottomEntry);
   }
 
   if ((BaseAddress + Length - 1) < Entry->EndAddress) {
@@ -456,6 +746,7 @@ CoreInsertGcdMapEntry (
     TopEntry->BaseAddress = BaseAddress + Length;
     Entry->EndAddress     = BaseAddress + Length - 1;
     InsertHeadList (Link, &TopEntry->Link);
+    CoreIndexGcdMapEntry (Map, TopEntry);
   }
 
   return EFI_SUCCESS;
@@ -533,6 +824,7 @@ CoreMergeGcdMapEntry (
     Entry->BaseAddress = AdjacentEntry->BaseAddress;
   }
 
+  CoreUnindexGcdMapEntry (Map, AdjacentEntry);
   RemoveEntryList (AdjacentLink);
   CoreFreePool (AdjacentEntry);
 
@@ -605,34 +897,29 @@ CoreSearchGcdMapEntry (
   IN  LIST_ENTRY            *Map
   )
 {
-  LIST_ENTRY         *Link;
-  EFI_GCD_MAP_ENTRY  *Entry;
-
   ASSERT (Length != 0);
 
   *StartLink = NULL;
   *EndLink   = NULL;
 
-  Link = Map->ForwardLink;
-  while (Link != Map) {
-    Entry = CR (Link, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
-    if ((BaseAddress >= Entry->BaseAddress) && (BaseAddress <= Entry->EndAddress)) {
-      *StartLink = Link;
-    }
-
-    if (*StartLink != NULL) {
-      if (((BaseAddress + Length - 1) >= Entry->BaseAddress) &&
-          ((BaseAddress + Length - 1) <= Entry->EndAddress))
-      {
-        *EndLink = Link;
-        return EFI_SUCCESS;
-      }
-    }
+  *StartLink = CoreFindGcdMapEntry (Map, BaseAddress);
+  if (*StartLink == NULL) {
+    return EFI_NOT_FOUND;
+  }
 
-    Link = Link->ForwardLink;
+  //
+  // The last entry of the segment can only come before the first one if the
+  // segment wraps around, which is only found when both are the same entry.
+  //
+  *EndLink = CoreFindGcdMapEntry (Map, BaseAddress + Length - 1);
+  if ((*EndLink == NULL) ||
+      (((BaseAddress + Length - 1) < BaseAddress) && (*EndLink != *StartLink)))
+  {
+    *EndLink = NULL;
+    return EFI_NOT_FOUND;
   }
 
-  return EFI_NOT_FOUND;
+  return EFI_SUCCESS;
 }
 
 /**
@@ -935,7 +1222,7 @@ CoreConvertSpace (
   Link = StartLink;
   while (Link != EndLink->ForwardLink) {
     Entry = CR (Link, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
-    CoreInsertGcdMapEntry (Link, Entry, BaseAddress, Length, TopEntry, BottomEntry);
+    CoreInsertGcdMapEntry (Map, Link, Entry, BaseAddress, Length, TopEntry, BottomEntry);
     switch (Operation) {
       //
       // Add operations
@@ -1215,9 +1502,16 @@ CoreAllocateSpace (
     //
     // Verify that the list of descriptors are unallocated memory matching GcdMemoryType.
     //
-    if ((GcdAllocateType == EfiGcdAllocateMaxAddressSearchTopDown) ||
-        (GcdAllocateType == EfiGcdAllocateAnySearchTopDown))
-    {
+    if (GcdAllocateType == EfiGcdAllocateMaxAddressSearchTopDown) {
+      //
+      // Entries above MaxAddress cannot satisfy the request, so start from
+      // the one that contains it
+      //
+      Link = CoreFindGcdMapEntry (Map, MaxAddress);
+      if (Link == NULL) {
+        Link = Map->BackLink;
+      }
+    } else if (GcdAllocateType == EfiGcdAllocateAnySearchTopDown) {
       Link = Map->BackLink;
     } else {
       Link = Map->ForwardLink;
@@ -1323,7 +1617,7 @@ CoreAllocateSpace (
   Link = StartLink;
   while (Link != EndLink->ForwardLink) {
     Entry = CR (Link, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
-    CoreInsertGcdMapEntry (Link, Entry, *BaseAddress, Length, TopEntry, BottomEntry);
+    CoreInsertGcdMapEntry (Map, Link, Entry, *BaseAddress, Length, TopEntry, BottomEntry);
     Entry->ImageHandle  = ImageHandle;
     Entry->DeviceHandle = DeviceHandle;
     Link                = Link->ForwardLink;
@@ -2614,6 +2908,7 @@ CoreInitializeGcdServices (
   Entry->EndAddress = LShiftU64 (1, SizeOfMemorySpace) - 1;
 
   InsertHeadList (&mGcdMemorySpaceMap, &Entry->Link);
+  CoreInitializeGcdMapIndex (&mGcdMemorySpaceMap, Entry);
 
   CoreDumpGcdMemorySpaceMap (TRUE);
 
@@ -2626,6 +2921,7 @@ CoreInitializeGcdServices (
   Entry->EndAddress = LShiftU64 (1, SizeOfIoSpace) - 1;
 
   InsertHeadList (&mGcdIoSpaceMap, &Entry->Link);
+  CoreInitializeGcdMapIndex (&mGcdIoSpaceMap, Entry);
 
   CoreDumpGcdIoSpaceMap (TRUE);
 
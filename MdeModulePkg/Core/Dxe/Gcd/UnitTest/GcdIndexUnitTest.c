@@ -0,0 +1,610 @@
+/** @file
+  Host based unit tests of the DXE core GCD map index.
+
+  Gcd.c is built with the memory services and HOB accesses of the DXE core
+  replaced by the stubs below. The same random sequence of memory space
+  operations runs once with the red-black tree index of the memory space map
+  and once with the index dropped, so that every lookup walks the map as it
+  did before the index was introduced. Both runs must return the same
+  results and end with the same memory space map.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../../DxeMain.h"
+
+#include <Library/OrderedCollectionLib.h>
+#include <Library/UnitTestLib.h>
+#include <Library/UnitTestRandomLib.h>
+
+#define UNIT_TEST_APP_NAME     "DXE Core GCD Map Index Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_SYSTEM_MEMORY_BASE    SIZE_1MB
+#define TEST_SYSTEM_MEMORY_LENGTH  SIZE_64MB
+#define TEST_ADDRESS_LIMIT         SIZE_4GB
+#define TEST_ALLOCATION_COUNT      64
+#define TEST_RANDOM_STEPS          4000
+
+typedef struct {
+  EFI_HOB_HANDOFF_INFO_TABLE     Phit;
+  EFI_HOB_CPU                    Cpu;
+  EFI_HOB_RESOURCE_DESCRIPTOR    Resource;
+  EFI_HOB_GENERIC_HEADER         End;
+} TEST_HOB_LIST;
+
+typedef struct {
+  EFI_STATUS              Status;
+  EFI_PHYSICAL_ADDRESS    BaseAddress;
+} TEST_RESULT;
+
+typedef struct {
+  EFI_PHYSICAL_ADDRESS    BaseAddress;
+  UINT64                  Length;
+} TEST_ALLOCATION;
+
+typedef struct {
+  UINT64             Seed;
+  TEST_RESULT        Results[TEST_RANDOM_STEPS];
+  TEST_ALLOCATION    Allocations[TEST_ALLOCATION_COUNT];
+} TEST_CONTEXT;
+
+//
+// The GCD memory space map and its index, from Gcd.c
+//
+extern LIST_ENTRY          mGcdMemorySpaceMap;
+extern LIST_ENTRY          mGcdIoSpaceMap;
+extern ORDERED_COLLECTION  *mGcdMemorySpaceIndex;
+extern ORDERED_COLLECTION  *mGcdIoSpaceIndex;
+
+//
+// Stubs of the DXE core services used by Gcd.c
+//
+EFI_HANDLE                   gDxeCoreImageHandle = (EFI_HANDLE)(UINTN)0x1000;
+EFI_CPU_ARCH_PROTOCOL        *gCpu               = NULL;
+VOID                         *gHobList           = NULL;
+BOOLEAN                      mOnGuarding         = FALSE;
+EFI_MEMORY_TYPE_INFORMATION  gMemoryTypeInformation[EfiMaxMemoryType + 1];
+
+VOID
+CoreAcquireLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockReleased);
+  Lock->Lock = EfiLockAcquired;
+}
+
+VOID
+CoreReleaseLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockAcquired);
+  Lock->Lock = EfiLockReleased;
+}
+
+EFI_STATUS
+EFIAPI
+CoreFreePool (
+  IN VOID  *Buffer
+  )
+{
+  FreePool (Buffer);
+  return EFI_SUCCESS;
+}
+
+VOID
+CoreInitializePool (
+  VOID
+  )
+{
+}
+
+VOID
+CoreSetMemoryTypeInformationRange (
+  IN EFI_PHYSICAL_ADDRESS  Start,
+  IN UINT64                Length
+  )
+{
+}
+
+VOID
+CoreAddMemoryDescriptor (
+  IN EFI_MEMORY_TYPE       Type,
+  IN EFI_PHYSICAL_ADDRESS  Start,
+  IN UINT64                NumberOfPages,
+  IN UINT64                Attribute
+  )
+{
+}
+
+VOID
+CoreUpdateMemoryAttributes (
+  IN EFI_PHYSICAL_ADDRESS  Start,
+  IN UINT64                NumberOfPages,
+  IN UINT64                NewAttributes
+  )
+{
+}
+
+VOID *
+EFIAPI
+GetNextHob (
+  IN UINT16      Type,
+  IN CONST VOID  *HobStart
+  )
+{
+  EFI_PEI_HOB_POINTERS  Hob;
+
+  for (Hob.Raw = (UINT8 *)HobStart; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (GET_HOB_TYPE (Hob) == Type) {
+      return Hob.Raw;
+    }
+  }
+
+  return NULL;
+}
+
+VOID *
+EFIAPI
+GetFirstHob (
+  IN UINT16  Type
+  )
+{
+  return GetNextHob (Type, gHobList);
+}
+
+VOID *
+EFIAPI
+GetFirstGuidHob (
+  IN CONST EFI_GUID  *Guid
+  )
+{
+  return NULL;
+}
+
+/**
+  Return a pseudo random page aligned address below TEST_ADDRESS_LIMIT.
+
+  @param[in, out] Context  The test context holding the seed.
+
+  @return The pseudo random address.
+**/
+STATIC
+EFI_PHYSICAL_ADDRESS
+TestRandomAddress (
+  IN OUT TEST_CONTEXT  *Context
+  )
+{
+  return LShiftU64 (UnitTestRandom (&Context->Seed) % (TEST_ADDRESS_LIMIT / EFI_PAGE_SIZE), EFI_PAGE_SHIFT);
+}
+
+/**
+  Return a pseudo random length of a few pages up to a few megabytes.
+
+  @param[in, out] Context  The test context holding the seed.
+
+  @return The pseudo random length.
+**/
+STATIC
+UINT64
+TestRandomLength (
+  IN OUT TEST_CONTEXT  *Context
+  )
+{
+  return LShiftU64 (UnitTestRandom (&Context->Seed) % 64 + 1, EFI_PAGE_SHIFT + UnitTestRandom (&Context->Seed) % 8);
+}
+
+/**
+  Initialize the GCD services from a HOB list describing a single range of
+  system memory.
+
+  @param[in]  UseIndex  FALSE to drop the memory space map index, so that
+                        lookups walk the map.
+**/
+STATIC
+VOID
+TestInitializeGcd (
+  IN BOOLEAN  UseIndex
+  )
+{
+  TEST_HOB_LIST  *HobList;
+  VOID           *HobStart;
+
+  HobList = AllocateZeroPool (sizeof (TEST_HOB_LIST));
+  ASSERT (HobList != NULL);
+
+  HobList->Phit.Header.HobType      = EFI_HOB_TYPE_HANDOFF;
+  HobList->Phit.Header.HobLength    = sizeof (HobList->Phit);
+  HobList->Phit.EfiFreeMemoryBottom = (EFI_PHYSICAL_ADDRESS)(UINTN)(HobList + 1);
+
+  HobList->Cpu.Header.HobType    = EFI_HOB_TYPE_CPU;
+  HobList->Cpu.Header.HobLength  = sizeof (HobList->Cpu);
+  HobList->Cpu.SizeOfMemorySpace = 48;
+  HobList->Cpu.SizeOfIoSpace     = 16;
+
+  HobList->Resource.Header.HobType    = EFI_HOB_TYPE_RESOURCE_DESCRIPTOR;
+  HobList->Resource.Header.HobLength  = sizeof (HobList->Resource);
+  HobList->Resource.ResourceType      = EFI_RESOURCE_SYSTEM_MEMORY;
+  HobList->Resource.ResourceAttribute = EFI_RESOURCE_ATTRIBUTE_PRESENT |
+                                        EFI_RESOURCE_ATTRIBUTE_INITIALIZED |
+                                        EFI_RESOURCE_ATTRIBUTE_TESTED;
+  HobList->Resource.PhysicalStart  = TEST_SYSTEM_MEMORY_BASE;
+  HobList->Resource.ResourceLength = TEST_SYSTEM_MEMORY_LENGTH;
+
+  HobList->End.HobType   = EFI_HOB_TYPE_END_OF_HOB_LIST;
+  HobList->End.HobLength = sizeof (HobList->End);
+
+  //
+  // Entries of a previous test are leaked on purpose
+  //
+  InitializeListHead (&mGcdMemorySpaceMap);
+  InitializeListHead (&mGcdIoSpaceMap);
+  mGcdMemorySpaceIndex = NULL;
+  mGcdIoSpaceIndex     = NULL;
+
+  gHobList = HobList;
+  HobStart = HobList;
+  CoreInitializeGcdServices (&HobStart, TEST_SYSTEM_MEMORY_BASE, SIZE_1MB);
+  FreePool (HobList);
+
+  if (!UseIndex) {
+    mGcdMemorySpaceIndex = NULL;
+  }
+}
+
+/**
+  Check that the index holds exactly the entries of the memory space map, in
+  the same order, and that looking up the first, last and middle address of
+  each entry returns that entry.
+
+  @retval  UNIT_TEST_PASSED             The index matches the map.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The index is out of sync.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestCheckIndex (
+  VOID
+  )
+{
+  ORDERED_COLLECTION_ENTRY         *IndexEntry;
+  LIST_ENTRY                       *Link;
+  EFI_GCD_MAP_ENTRY                *Entry;
+  EFI_GCD_MEMORY_SPACE_DESCRIPTOR  Descriptor;
+  EFI_PHYSICAL_ADDRESS             Address[3];
+  UINTN                            Index;
+  EFI_STATUS                       Status;
+
+  UT_ASSERT_NOT_NULL (mGcdMemorySpaceIndex);
+
+  IndexEntry = OrderedCollectionMin (mGcdMemorySpaceIndex);
+  for (Link = mGcdMemorySpaceMap.ForwardLink; Link != &mGcdMemorySpaceMap; Link = Link->ForwardLink) {
+    Entry = CR (Link, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
+    UT_ASSERT_NOT_NULL (IndexEntry);
+    UT_ASSERT_EQUAL ((UINTN)OrderedCollectionUserStruct (IndexEntry), (UINTN)Entry);
+    UT_ASSERT_EQUAL ((UINTN)Entry->IndexEntry, (UINTN)IndexEntry);
+    IndexEntry = OrderedCollectionNext (IndexEntry);
+
+    Address[0] = Entry->BaseAddress;
+    Address[1] = Entry->EndAddress;
+    Address[2] = Entry->BaseAddress + (Entry->EndAddress - Entry->BaseAddress) / 2;
+    for (Index = 0; Index < ARRAY_SIZE (Address); Index++) {
+      Status = CoreGetMemorySpaceDescriptor (Address[Index], &Descriptor);
+      UT_ASSERT_NOT_EFI_ERROR (Status);
+      UT_ASSERT_EQUAL (Descriptor.BaseAddress, Entry->BaseAddress);
+      UT_ASSERT_EQUAL (Descriptor.Length, Entry->EndAddress - Entry->BaseAddress + 1);
+    }
+  }
+
+  UT_ASSERT_TRUE (IndexEntry == NULL);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Run a random sequence of memory space operations and record their results.
+
+  Memory-mapped I/O and reserved ranges are added and removed, and allocated
+  with every search type, the same way PCI resource allocation does.
+
+  @param[in, out] Context   The test context.
+  @param[in]      UseIndex  TRUE to check the index after each operation.
+
+  @retval  UNIT_TEST_PASSED             The sequence completed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The index went out of sync.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestRunOperations (
+  IN OUT TEST_CONTEXT  *Context,
+  IN     BOOLEAN       UseIndex
+  )
+{
+  UINTN                  Step;
+  UINTN                  Slot;
+  EFI_GCD_MEMORY_TYPE    GcdMemoryType;
+  EFI_GCD_ALLOCATE_TYPE  AllocateType;
+  EFI_PHYSICAL_ADDRESS   BaseAddress;
+  UINT64                 Length;
+  EFI_STATUS             Status;
+  UNIT_TEST_STATUS       TestStatus;
+
+  Context->Seed = 0x6cd;
+  ZeroMem (Context->Allocations, sizeof (Context->Allocations));
+  TestInitializeGcd (UseIndex);
+
+  for (Step = 0; Step < TEST_RANDOM_STEPS; Step++) {
+    GcdMemoryType = (UnitTestRandom (&Context->Seed) % 3 == 0) ? EfiGcdMemoryTypeReserved : EfiGcdMemoryTypeMemoryMappedIo;
+    BaseAddress   = TestRandomAddress (Context);
+    Length        = TestRandomLength (Context);
+    Slot          = UnitTestRandom (&Context->Seed) % TEST_ALLOCATION_COUNT;
+
+    switch (UnitTestRandom (&Context->Seed) % 4) {
+      case 0:
+        Status = CoreAddMemorySpace (GcdMemoryType, BaseAddress, Length, EFI_MEMORY_UC | EFI_MEMORY_RUNTIME);
+        break;
+
+      case 1:
+        Status = CoreRemoveMemorySpace (BaseAddress, Length);
+        break;
+
+      case 2:
+        if (Context->Allocations[Slot].Length != 0) {
+          Status = CoreFreeMemorySpace (Context->Allocations[Slot].BaseAddress, Context->Allocations[Slot].Length);
+          Context->Allocations[Slot].Length = 0;
+          break;
+        }
+
+      //
+      // Fall through to allocate the free slot
+      //
+      default:
+        if (Context->Allocations[Slot].Length != 0) {
+          Status = EFI_ALREADY_STARTED;
+          break;
+        }
+
+        AllocateType = (EFI_GCD_ALLOCATE_TYPE)(UnitTestRandom (&Context->Seed) % EfiGcdMaxAllocateType);
+        Status       = CoreAllocateMemorySpace (
+                         AllocateType,
+                         GcdMemoryType,
+                         EFI_PAGE_SHIFT + UnitTestRandom (&Context->Seed) % 8,
+                         Length,
+                         &BaseAddress,
+                         gDxeCoreImageHandle,
+                         NULL
+                         );
+        if (!EFI_ERROR (Status)) {
+          Context->Allocations[Slot].BaseAddress = BaseAddress;
+          Context->Allocations[Slot].Length      = Length;
+        }
+
+        break;
+    }
+
+    if (UseIndex) {
+      Context->Results[Step].Status      = Status;
+      Context->Results[Step].BaseAddress = BaseAddress;
+      TestStatus                         = TestCheckIndex ();
+      if (TestStatus != UNIT_TEST_PASSED) {
+        return TestStatus;
+      }
+    } else {
+      UT_ASSERT_STATUS_EQUAL (Status, Context->Results[Step].Status);
+      UT_ASSERT_EQUAL (BaseAddress, Context->Results[Step].BaseAddress);
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Reset the test context before each test.
+
+  @param[in]  Context  The test context.
+
+  @retval  UNIT_TEST_PASSED  The test context is ready.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+GcdIndexTestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  ZeroMem (Context, sizeof (TEST_CONTEXT));
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that the index is built for the initial memory space map.
+
+  @param[in]  Context  The test context.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+InitialMapIsIndexed (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_GCD_MEMORY_SPACE_DESCRIPTOR  Descriptor;
+  EFI_STATUS                       Status;
+
+  TestInitializeGcd (TRUE);
+
+  Status = CoreGetMemorySpaceDescriptor (TEST_SYSTEM_MEMORY_BASE, &Descriptor);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (Descriptor.GcdMemoryType, EfiGcdMemoryTypeSystemMemory);
+  UT_ASSERT_EQUAL ((UINTN)Descriptor.ImageHandle, (UINTN)gDxeCoreImageHandle);
+
+  Status = CoreGetMemorySpaceDescriptor (LShiftU64 (1, 48), &Descriptor);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+
+  return TestCheckIndex ();
+}
+
+/**
+  Check that random memory space operations return the same results and
+  leave the same memory space map with and without the index.
+
+  @param[in]  Context  The test context.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+IndexedLookupsMatchMapWalk (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                     *TestContext;
+  UNIT_TEST_STATUS                 TestStatus;
+  EFI_GCD_MEMORY_SPACE_DESCRIPTOR  *IndexedMap;
+  EFI_GCD_MEMORY_SPACE_DESCRIPTOR  *WalkedMap;
+  UINTN                            IndexedCount;
+  UINTN                            WalkedCount;
+  UINTN                            Index;
+  EFI_STATUS                       Status;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  TestStatus = TestRunOperations (TestContext, TRUE);
+  if (TestStatus != UNIT_TEST_PASSED) {
+    return TestStatus;
+  }
+
+  Status = CoreGetMemorySpaceMap (&IndexedCount, &IndexedMap);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  TestStatus = TestRunOperations (TestContext, FALSE);
+  if (TestStatus != UNIT_TEST_PASSED) {
+    return TestStatus;
+  }
+
+  UT_ASSERT_TRUE (mGcdMemorySpaceIndex == NULL);
+  Status = CoreGetMemorySpaceMap (&WalkedCount, &WalkedMap);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  UT_ASSERT_EQUAL (IndexedCount, WalkedCount);
+  for (Index = 0; Index < IndexedCount; Index++) {
+    UT_ASSERT_EQUAL (IndexedMap[Index].BaseAddress, WalkedMap[Index].BaseAddress);
+    UT_ASSERT_EQUAL (IndexedMap[Index].Length, WalkedMap[Index].Length);
+    UT_ASSERT_EQUAL (IndexedMap[Index].Capabilities, WalkedMap[Index].Capabilities);
+    UT_ASSERT_EQUAL (IndexedMap[Index].Attributes, WalkedMap[Index].Attributes);
+    UT_ASSERT_EQUAL (IndexedMap[Index].GcdMemoryType, WalkedMap[Index].GcdMemoryType);
+    UT_ASSERT_EQUAL ((UINTN)IndexedMap[Index].ImageHandle, (UINTN)WalkedMap[Index].ImageHandle);
+  }
+
+  FreePool (IndexedMap);
+  FreePool (WalkedMap);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the GCD map
+  index and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      GcdIndexTests;
+  TEST_CONTEXT                *TestContext;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  TestContext = AllocateZeroPool (sizeof (TEST_CONTEXT));
+  if (TestContext == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the GCD map index Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&GcdIndexTests, Framework, "GCD Map Index Tests", "DxeCore.GcdIndex", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for GCD Map Index Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite---------Description---------------------------------------Name--------Function--------------------Pre------------------Post---Context-----
+  //
+  AddTestCase (GcdIndexTests, "Initial map is indexed", "Initial", InitialMapIsIndexed, GcdIndexTestSetup, NULL, TestContext);
+  AddTestCase (GcdIndexTests, "Indexed lookups match the map walk", "Random", IndexedLookupsMatchMapWalk, GcdIndexTestSetup, NULL, TestContext);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  if (TestContext != NULL) {
+    FreePool (TestContext);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define GcdIndexUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+GcdIndexUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
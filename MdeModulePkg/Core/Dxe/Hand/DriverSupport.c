@@ -415,6 +415,7 @@ CoreConnectSingleController (
   UINTN                                      SortIndex;
   BOOLEAN                                    OneStarted;
   BOOLEAN                                    DriverFound;
+  BOOT_TRACE_SCOPE                           TraceScope;
 
   //
   // Initialize local variables
@@ -655,11 +656,13 @@ CoreConnectSingleController (
           // on ControllerHandle.
           //
           PERF_DRIVER_BINDING_START_BEGIN (DriverBinding->DriverBindingHandle, ControllerHandle);
+          CoreBootTraceBegin (&TraceScope, DriverBinding->ImageHandle);
           Status = DriverBinding->Start (
                                     DriverBinding,
                                     ControllerHandle,
                                     RemainingDevicePath
                                     );
+          CoreBootTraceEnd (&TraceScope, EDKII_BOOT_TRACE_TYPE_DRIVER_BINDING_START, ControllerHandle, Status);
           PERF_DRIVER_BINDING_START_END (DriverBinding->DriverBindingHandle, ControllerHandle);
 
           if (!EFI_ERROR (Status)) {
@@ -14,11 +14,46 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 // gHandleList           - A list of all the handles in the system
 // gProtocolDatabaseLock - Lock to protect the mProtocolDatabase
 // gHandleDatabaseKey    -  The Key to show that the handle has been created/modified
+// gProtocolDatabaseKey  -  The Key to show that a protocol interface has been added/removed
 //
 LIST_ENTRY  mProtocolDatabase     = INITIALIZE_LIST_HEAD_VARIABLE (mProtocolDatabase);
 LIST_ENTRY  gHandleList           = INITIALIZE_LIST_HEAD_VARIABLE (gHandleList);
 EFI_LOCK    gProtocolDatabaseLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
 UINT64      gHandleDatabaseKey    = 0;
+UINT64      gProtocolDatabaseKey  = 0;
+
+//
+// Hash indexes over the lists above, also protected by gProtocolDatabaseLock.
+//
+// mHandleIndex            - All IHANDLEs, keyed by handle address
+// mProtocolEntryIndex     - All PROTOCOL_ENTRYs, keyed by protocol GUID
+// mProtocolInterfaceIndex - All PROTOCOL_INTERFACEs, keyed by handle and protocol GUID
+//
+LIST_ENTRY  mHandleIndexBuckets[HANDLE_INDEX_BUCKET_COUNT];
+LIST_ENTRY  mProtocolEntryIndexBuckets[PROTOCOL_ENTRY_INDEX_BUCKET_COUNT];
+LIST_ENTRY  mProtocolInterfaceIndexBuckets[PROTOCOL_INTERFACE_INDEX_BUCKET_COUNT];
+HASH_INDEX  mHandleIndex            = HASH_INDEX_INITIALIZER (mHandleIndexBuckets);
+HASH_INDEX  mProtocolEntryIndex     = HASH_INDEX_INITIALIZER (mProtocolEntryIndexBuckets);
+HASH_INDEX  mProtocolInterfaceIndex = HASH_INDEX_INITIALIZER (mProtocolInterfaceIndexBuckets);
+
+/**
+  Compute the mProtocolInterfaceIndex hash value of a protocol on a handle.
+
+  @param  Handle                 The handle the protocol is installed on
+  @param  Protocol               The ID of the protocol
+
+  @return The hash value
+
+**/
+STATIC
+UINTN
+CoreProtocolInterfaceHash (
+  IN IHANDLE         *Handle,
+  IN CONST EFI_GUID  *Protocol
+  )
+{
+  return HashIndexPointer (Handle) ^ HashIndexGuid (Protocol);
+}
 
 /**
   Acquire lock on gProtocolDatabaseLock.
@@ -59,8 +94,9 @@ CoreValidateHandle (
   IN  EFI_HANDLE  UserHandle
   )
 {
-  IHANDLE     *Handle;
-  LIST_ENTRY  *Link;
+  IHANDLE           *Handle;
+  HASH_INDEX_ENTRY  *Entry;
+  UINTN             Hash;
 
   if (UserHandle == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -68,8 +104,12 @@ CoreValidateHandle (
 
   ASSERT_LOCKED (&gProtocolDatabaseLock);
 
-  for (Link = gHandleList.BackLink; Link != &gHandleList; Link = Link->BackLink) {
-    Handle = CR (Link, IHANDLE, AllHandles, EFI_HANDLE_SIGNATURE);
+  Hash = HashIndexPointer (UserHandle);
+  for (Entry = HashIndexGetFirst (&mHandleIndex, Hash);
+       Entry != NULL;
+       Entry = HashIndexGetNext (&mHandleIndex, Entry))
+  {
+    Handle = CR (Entry, IHANDLE, HashEntry, EFI_HANDLE_SIGNATURE);
     if (Handle == (IHANDLE *)UserHandle) {
       return EFI_SUCCESS;
     }
@@ -94,22 +134,24 @@ CoreFindProtocolEntry (
   IN BOOLEAN   Create
   )
 {
-  LIST_ENTRY      *Link;
-  PROTOCOL_ENTRY  *Item;
-  PROTOCOL_ENTRY  *ProtEntry;
+  HASH_INDEX_ENTRY  *Entry;
+  PROTOCOL_ENTRY    *Item;
+  PROTOCOL_ENTRY    *ProtEntry;
+  UINTN             Hash;
 
   ASSERT_LOCKED (&gProtocolDatabaseLock);
 
   //
-  // Search the database for the matching GUID
+  // Search the database index for the matching GUID
   //
 
   ProtEntry = NULL;
-  for (Link = mProtocolDatabase.ForwardLink;
-       Link != &mProtocolDatabase;
-       Link = Link->ForwardLink)
+  Hash      = HashIndexGuid (Protocol);
+  for (Entry = HashIndexGetFirst (&mProtocolEntryIndex, Hash);
+       Entry != NULL;
+       Entry = HashIndexGetNext (&mProtocolEntryIndex, Entry))
   {
-    Item = CR (Link, PROTOCOL_ENTRY, AllEntries, PROTOCOL_ENTRY_SIGNATURE);
+    Item = CR (Entry, PROTOCOL_ENTRY, HashEntry, PROTOCOL_ENTRY_SIGNATURE);
     if (CompareGuid (&Item->ProtocolID, Protocol)) {
       //
       // This is the protocol entry
@@ -135,17 +177,61 @@ CoreFindProtocolEntry (
       CopyGuid ((VOID *)&ProtEntry->ProtocolID, Protocol);
       InitializeListHead (&ProtEntry->Protocols);
       InitializeListHead (&ProtEntry->Notify);
+      ProtEntry->Key = 0;
 
       //
       // Add it to protocol database
       //
       InsertTailList (&mProtocolDatabase, &ProtEntry->AllEntries);
+      HashIndexInsert (&mProtocolEntryIndex, &ProtEntry->HashEntry, Hash);
     }
   }
 
   return ProtEntry;
 }
 
+/**
+  Locate a certain GUID protocol interface in a Handle's protocols.
+
+  @param  UserHandle             The handle to obtain the protocol interface on
+                                 The caller must pass in a valid UserHandle that
+                                 is checked with CoreValidateHandle().
+  @param  Protocol               The GUID of the protocol
+
+  @return The requested protocol interface for the handle
+
+**/
+STATIC
+PROTOCOL_INTERFACE  *
+CoreGetProtocolInterface (
+  IN  EFI_HANDLE  UserHandle,
+  IN  EFI_GUID    *Protocol
+  )
+{
+  PROTOCOL_INTERFACE  *Prot;
+  IHANDLE             *Handle;
+  HASH_INDEX_ENTRY    *Entry;
+  UINTN               Hash;
+
+  Handle = (IHANDLE *)UserHandle;
+
+  //
+  // Look up the protocol interface index for a match
+  //
+  Hash = CoreProtocolInterfaceHash (Handle, Protocol);
+  for (Entry = HashIndexGetFirst (&mProtocolInterfaceIndex, Hash);
+       Entry != NULL;
+       Entry = HashIndexGetNext (&mProtocolInterfaceIndex, Entry))
+  {
+    Prot = CR (Entry, PROTOCOL_INTERFACE, HashEntry, PROTOCOL_INTERFACE_SIGNATURE);
+    if ((Prot->Handle == Handle) && CompareGuid (&Prot->Protocol->ProtocolID, Protocol)) {
+      return Prot;
+    }
+  }
+
+  return NULL;
+}
+
 /**
   Finds the protocol instance for the requested handle and protocol.
   Note: This function doesn't do parameters checking, it's caller's responsibility
@@ -166,32 +252,16 @@ CoreFindProtocolInterface (
   )
 {
   PROTOCOL_INTERFACE  *Prot;
-  PROTOCOL_ENTRY      *ProtEntry;
-  LIST_ENTRY          *Link;
 
   ASSERT_LOCKED (&gProtocolDatabaseLock);
-  Prot = NULL;
 
   //
-  // Lookup the protocol entry for this protocol ID
+  // A protocol can only be installed once on a handle, so the interface
+  // index lookup yields the only candidate
   //
-
-  ProtEntry = CoreFindProtocolEntry (Protocol, FALSE);
-  if (ProtEntry != NULL) {
-    //
-    // Look at each protocol interface for any matches
-    //
-    for (Link = Handle->Protocols.ForwardLink; Link != &Handle->Protocols; Link = Link->ForwardLink) {
-      //
-      // If this protocol interface matches, remove it
-      //
-      Prot = CR (Link, PROTOCOL_INTERFACE, Link, PROTOCOL_INTERFACE_SIGNATURE);
-      if ((Prot->Interface == Interface) && (Prot->Protocol == ProtEntry)) {
-        break;
-      }
-
-      Prot = NULL;
-    }
+  Prot = CoreGetProtocolInterface (Handle, Protocol);
+  if ((Prot != NULL) && (Prot->Interface != Interface)) {
+    Prot = NULL;
   }
 
   return Prot;
@@ -469,6 +539,7 @@ CoreInstallProtocolInterfaceNotify (
     // in the system
     //
     InsertTailList (&gHandleList, &Handle->AllHandles);
+    HashIndexInsert (&mHandleIndex, &Handle->HashEntry, HashIndexPointer (Handle));
   } else {
     Status = CoreValidateHandle (Handle);
     if (EFI_ERROR (Status)) {
@@ -507,6 +578,18 @@ CoreInstallProtocolInterfaceNotify (
   // protocol entry
   //
   InsertTailList (&ProtEntry->Protocols, &Prot->ByProtocol);
+  gProtocolDatabaseKey++;
+  ProtEntry->Key = gProtocolDatabaseKey;
+  gBootTraceProtocolInstallCount++;
+
+  //
+  // Index the protocol interface by handle and protocol ID
+  //
+  HashIndexInsert (
+    &mProtocolInterfaceIndex,
+    &Prot->HashEntry,
+    CoreProtocolInterfaceHash (Handle, &ProtEntry->ProtocolID)
+    );
 
   //
   // Notify the notification list for this protocol
@@ -811,6 +894,7 @@ CoreUninstallProtocolInterface (
     // Remove the protocol interface from the handle
     //
     RemoveEntryList (&Prot->Link);
+    HashIndexRemove (&mProtocolInterfaceIndex, &Prot->HashEntry);
 
     //
     // Free the memory
@@ -826,6 +910,7 @@ CoreUninstallProtocolInterface (
   if (IsListEmpty (&Handle->Protocols)) {
     Handle->Signature = 0;
     RemoveEntryList (&Handle->AllHandles);
+    HashIndexRemove (&mHandleIndex, &Handle->HashEntry);
     CoreFreePool (Handle);
   }
 
@@ -914,45 +999,6 @@ CoreUninstallMultipleProtocolInterfaces (
   return Status;
 }
 
-/**
-  Locate a certain GUID protocol interface in a Handle's protocols.
-
-  @param  UserHandle             The handle to obtain the protocol interface on
-                                 The caller must pass in a valid UserHandle that
-                                 is checked with CoreValidateHandle().
-  @param  Protocol               The GUID of the protocol
-
-  @return The requested protocol interface for the handle
-
-**/
-STATIC
-PROTOCOL_INTERFACE  *
-CoreGetProtocolInterface (
-  IN  EFI_HANDLE  UserHandle,
-  IN  EFI_GUID    *Protocol
-  )
-{
-  PROTOCOL_ENTRY      *ProtEntry;
-  PROTOCOL_INTERFACE  *Prot;
-  IHANDLE             *Handle;
-  LIST_ENTRY          *Link;
-
-  Handle = (IHANDLE *)UserHandle;
-
-  //
-  // Look at each protocol interface for a match
-  //
-  for (Link = Handle->Protocols.ForwardLink; Link != &Handle->Protocols; Link = Link->ForwardLink) {
-    Prot      = CR (Link, PROTOCOL_INTERFACE, Link, PROTOCOL_INTERFACE_SIGNATURE);
-    ProtEntry = Prot->Protocol;
-    if (CompareGuid (&ProtEntry->ProtocolID, Protocol)) {
-      return Prot;
-    }
-  }
-
-  return NULL;
-}
-
 /**
   Queries a handle to determine if it supports a specified protocol.
 
@@ -1622,3 +1668,64 @@ CoreConnectHandlesByKey (
 
   CoreFreePool (HandleBuffer);
 }
+
+/**
+  Return the protocol database key.
+
+  @return Protocol database key.
+
+**/
+UINT64
+CoreGetProtocolDatabaseKey (
+  VOID
+  )
+{
+  return gProtocolDatabaseKey;
+}
+
+/**
+  Return the entry of a protocol in the protocol database, creating it if it
+  does not exist yet. Protocol entries are never freed, so the entry can be
+  kept by the caller and passed to CoreGetProtocolKey() at any later time.
+
+  @param  Protocol               The ID of the protocol.
+
+  @return The protocol entry, or NULL if there is not enough memory.
+
+**/
+VOID *
+CoreGetProtocolEntry (
+  IN EFI_GUID  *Protocol
+  )
+{
+  PROTOCOL_ENTRY  *ProtEntry;
+
+  CoreAcquireProtocolLock ();
+  ProtEntry = CoreFindProtocolEntry (Protocol, TRUE);
+  CoreReleaseProtocolLock ();
+
+  return ProtEntry;
+}
+
+/**
+  Return the protocol database key at which an interface of a protocol was
+  last installed or uninstalled.
+
+  @param  ProtocolEntry          The protocol entry returned by
+                                 CoreGetProtocolEntry().
+
+  @return The key, or 0 if no interface of the protocol was ever installed.
+
+**/
+UINT64
+CoreGetProtocolKey (
+  IN VOID  *ProtocolEntry
+  )
+{
+  PROTOCOL_ENTRY  *ProtEntry;
+
+  ProtEntry = (PROTOCOL_ENTRY *)ProtocolEntry;
+  ASSERT (ProtEntry->Signature == PROTOCOL_ENTRY_SIGNATURE);
+
+  return ProtEntry->Key;
+}
@@ -11,18 +11,28 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define EFI_HANDLE_SIGNATURE  SIGNATURE_32('h','n','d','l')
 
+//
+// Number of buckets in the hash indexes over the handle database. Each must
+// be a power of two.
+//
+#define HANDLE_INDEX_BUCKET_COUNT              1024
+#define PROTOCOL_ENTRY_INDEX_BUCKET_COUNT      256
+#define PROTOCOL_INTERFACE_INDEX_BUCKET_COUNT  1024
+
 ///
 /// IHANDLE - contains a list of protocol handles
 ///
 typedef struct {
-  UINTN         Signature;
+  UINTN               Signature;
   /// All handles list of IHANDLE
-  LIST_ENTRY    AllHandles;
+  LIST_ENTRY          AllHandles;
   /// List of PROTOCOL_INTERFACE's for this handle
-  LIST_ENTRY    Protocols;
-  UINTN         LocateRequest;
+  LIST_ENTRY          Protocols;
+  UINTN               LocateRequest;
   /// The Handle Database Key value when this handle was last created or modified
-  UINT64        Key;
+  UINT64              Key;
+  /// Link on mHandleIndex, keyed by the handle address
+  HASH_INDEX_ENTRY    HashEntry;
 } IHANDLE;
 
 #define ASSERT_IS_HANDLE(a)  ASSERT((a)->Signature == EFI_HANDLE_SIGNATURE)
@@ -35,15 +45,19 @@ typedef struct {
 /// with a list of registered notifies.
 ///
 typedef struct {
-  UINTN         Signature;
+  UINTN               Signature;
   /// Link Entry inserted to mProtocolDatabase
-  LIST_ENTRY    AllEntries;
+  LIST_ENTRY          AllEntries;
   /// ID of the protocol
-  EFI_GUID      ProtocolID;
+  EFI_GUID            ProtocolID;
   /// All protocol interfaces
-  LIST_ENTRY    Protocols;
+  LIST_ENTRY          Protocols;
   /// Registerd notification handlers
-  LIST_ENTRY    Notify;
+  LIST_ENTRY          Notify;
+  /// Link on mProtocolEntryIndex, keyed by ProtocolID
+  HASH_INDEX_ENTRY    HashEntry;
+  /// Value of gProtocolDatabaseKey when an interface was last added or removed
+  UINT64              Key;
 } PROTOCOL_ENTRY;
 
 #define PROTOCOL_INTERFACE_SIGNATURE  SIGNATURE_32('p','i','f','c')
@@ -53,20 +67,22 @@ typedef struct {
 /// with a protocol interface structure
 ///
 typedef struct {
-  UINTN             Signature;
+  UINTN               Signature;
   /// Link on IHANDLE.Protocols
-  LIST_ENTRY        Link;
+  LIST_ENTRY          Link;
   /// Back pointer
-  IHANDLE           *Handle;
+  IHANDLE             *Handle;
   /// Link on PROTOCOL_ENTRY.Protocols
-  LIST_ENTRY        ByProtocol;
+  LIST_ENTRY          ByProtocol;
   /// The protocol ID
-  PROTOCOL_ENTRY    *Protocol;
+  PROTOCOL_ENTRY      *Protocol;
   /// The interface value
-  VOID              *Interface;
+  VOID                *Interface;
   /// OPEN_PROTOCOL_DATA list
-  LIST_ENTRY        OpenList;
-  UINTN             OpenListCount;
+  LIST_ENTRY          OpenList;
+  UINTN               OpenListCount;
+  /// Link on mProtocolInterfaceIndex, keyed by Handle and protocol ID
+  HASH_INDEX_ENTRY    HashEntry;
 } PROTOCOL_INTERFACE;
 
 #define OPEN_PROTOCOL_DATA_SIGNATURE  SIGNATURE_32('p','o','d','l')
@@ -248,5 +264,6 @@ CoreValidateHandle (
 extern EFI_LOCK    gProtocolDatabaseLock;
 extern LIST_ENTRY  gHandleList;
 extern UINT64      gHandleDatabaseKey;
+extern UINT64      gProtocolDatabaseKey;
 
 #endif
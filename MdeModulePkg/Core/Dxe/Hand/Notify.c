@@ -76,6 +76,8 @@ CoreRemoveInterfaceFromProtocol (
     // Remove the protocol interface entry
     //
     RemoveEntryList (&Prot->ByProtocol);
+    gProtocolDatabaseKey++;
+    ProtEntry->Key = gProtocolDatabaseKey;
   }
 
   return Prot;
@@ -1611,6 +1611,7 @@ CoreStartImage (
   UINT64                     HandleDatabaseKey;
   UINTN                      SetJumpFlag;
   EFI_HANDLE                 Handle;
+  BOOT_TRACE_SCOPE           TraceScope;
 
   Handle = ImageHandle;
 
@@ -1656,6 +1657,7 @@ CoreStartImage (
   }
 
   PERF_START_IMAGE_BEGIN (Handle);
+  CoreBootTraceBegin (&TraceScope, ImageHandle);
 
   //
   // Push the current start image context, and
@@ -1678,6 +1680,7 @@ CoreStartImage (
     // Image may be unloaded after return with failure,
     // then ImageHandle may be invalid, so use NULL handle to record perf log.
     //
+    CoreBootTraceEnd (&TraceScope, EDKII_BOOT_TRACE_TYPE_START_IMAGE, NULL, EFI_OUT_OF_RESOURCES);
     PERF_START_IMAGE_END (NULL);
 
     //
@@ -1796,6 +1799,7 @@ CoreStartImage (
   //
   // Done
   //
+  CoreBootTraceEnd (&TraceScope, EDKII_BOOT_TRACE_TYPE_START_IMAGE, NULL, Status);
   PERF_START_IMAGE_END (Handle);
   return Status;
 }
@@ -15,16 +15,25 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define MEMORY_MAP_SIGNATURE  SIGNATURE_32('m','m','a','p')
 typedef struct {
-  UINTN              Signature;
-  LIST_ENTRY         Link;
-  BOOLEAN            FromPages;
-
-  EFI_MEMORY_TYPE    Type;
-  UINT64             Start;
-  UINT64             End;
-
-  UINT64             VirtualStart;
-  UINT64             Attribute;
+  UINTN               Signature;
+  LIST_ENTRY          Link;
+  BOOLEAN             FromPages;
+
+  EFI_MEMORY_TYPE     Type;
+  UINT64              Start;
+  UINT64              End;
+
+  UINT64              VirtualStart;
+  UINT64              Attribute;
+
+  //
+  // Links of the memory map index (PcdDxeIndexedPageAllocator). They are
+  // only valid while Indexed is TRUE.
+  //
+  BOOLEAN             Indexed;
+  LIST_ENTRY          FreeLink;
+  HASH_INDEX_ENTRY    StartEntry;
+  HASH_INDEX_ENTRY    EndEntry;
 } MEMORY_MAP;
 
 //
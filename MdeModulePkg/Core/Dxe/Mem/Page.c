@@ -69,6 +69,37 @@ EFI_MEMORY_TYPE_STATISTICS  mMemoryTypeStatistics[EfiMaxMemoryType + 1] = {
 EFI_PHYSICAL_ADDRESS  mDefaultMaximumAddress = MAX_ALLOC_ADDRESS;
 EFI_PHYSICAL_ADDRESS  mDefaultBaseAddress    = MAX_ALLOC_ADDRESS;
 
+//
+// Memory map index (PcdDxeIndexedPageAllocator).
+//
+// Free descriptors, i.e. EfiConventionalMemory without EFI_MEMORY_SP, are
+// kept in bins by the order of their number of pages: bin N holds the
+// descriptors of 2^N to 2^(N+1)-1 pages, and bit N of mFreeBinMap is set if
+// bin N is not empty. A search for free pages therefore only visits the
+// descriptors that are large enough, instead of the whole memory map.
+//
+// All descriptors are also indexed by their start address and by the address
+// that follows their end, so that adjacent descriptors are found without
+// walking the memory map when ranges are added or converted.
+//
+// The index does not change the descriptors themselves, so the memory map and
+// the addresses returned by the allocator are the same as without it.
+//
+#define FREE_BIN_COUNT                 64
+#define MEMORY_MAP_INDEX_BUCKET_COUNT  512
+
+LIST_ENTRY  mFreeBins[FREE_BIN_COUNT];
+UINT64      mFreeBinMap = 0;
+LIST_ENTRY  mMemoryMapStartIndexBuckets[MEMORY_MAP_INDEX_BUCKET_COUNT];
+LIST_ENTRY  mMemoryMapEndIndexBuckets[MEMORY_MAP_INDEX_BUCKET_COUNT];
+HASH_INDEX  mMemoryMapStartIndex = HASH_INDEX_INITIALIZER (mMemoryMapStartIndexBuckets);
+HASH_INDEX  mMemoryMapEndIndex   = HASH_INDEX_INITIALIZER (mMemoryMapEndIndexBuckets);
+///
+/// The free descriptor that the last search for free pages returned pages
+/// from, which is usually the one that has to be converted next
+///
+MEMORY_MAP  *mLastFreePagesEntry = NULL;
+
 EFI_MEMORY_TYPE_INFORMATION  gMemoryTypeInformation[EfiMaxMemoryType + 1] = {
   { EfiReservedMemoryType,      0 },
   { EfiLoaderCode,              0 },
@@ -119,6 +150,186 @@ CoreReleaseMemoryLock (
   CoreReleaseLock (&gMemoryLock);
 }
 
+/**
+  Compute the hash value of an address for the memory map index.
+
+  @param  Address                The address.
+
+  @return The hash value.
+
+**/
+STATIC
+UINTN
+MemoryMapIndexHash (
+  IN UINT64  Address
+  )
+{
+  return HashIndexPointer ((VOID *)(UINTN)RShiftU64 (Address, EFI_PAGE_SHIFT));
+}
+
+/**
+  Internal function.  Adds a descriptor entry of the memory map to the memory
+  map index. Does nothing if PcdDxeIndexedPageAllocator is FALSE.
+
+  @param  Entry                  The entry to add, which must be on gMemoryMap
+                                 and must not be empty
+
+**/
+STATIC
+VOID
+CoreIndexMemoryMapEntry (
+  IN OUT MEMORY_MAP  *Entry
+  )
+{
+  UINTN  Bin;
+
+  if (!FeaturePcdGet (PcdDxeIndexedPageAllocator)) {
+    return;
+  }
+
+  ASSERT (!Entry->Indexed);
+  ASSERT (Entry->End > Entry->Start);
+
+  if (mFreeBins[0].ForwardLink == NULL) {
+    for (Bin = 0; Bin < FREE_BIN_COUNT; Bin++) {
+      InitializeListHead (&mFreeBins[Bin]);
+    }
+  }
+
+  if ((Entry->Type == EfiConventionalMemory) && ((Entry->Attribute & EFI_MEMORY_SP) == 0)) {
+    Bin = (UINTN)HighBitSet64 (RShiftU64 (Entry->End - Entry->Start + 1, EFI_PAGE_SHIFT));
+    InsertTailList (&mFreeBins[Bin], &Entry->FreeLink);
+    mFreeBinMap |= LShiftU64 (1, Bin);
+  } else {
+    Entry->FreeLink.ForwardLink = NULL;
+  }
+
+  HashIndexInsert (&mMemoryMapStartIndex, &Entry->StartEntry, MemoryMapIndexHash (Entry->Start));
+  HashIndexInsert (&mMemoryMapEndIndex, &Entry->EndEntry, MemoryMapIndexHash (Entry->End + 1));
+  Entry->Indexed = TRUE;
+}
+
+/**
+  Internal function.  Removes a descriptor entry of the memory map from the
+  memory map index. Must be called before the range or the type of the entry
+  is changed. Does nothing if the entry is not indexed.
+
+  @param  Entry                  The entry to remove
+
+**/
+STATIC
+VOID
+CoreUnindexMemoryMapEntry (
+  IN OUT MEMORY_MAP  *Entry
+  )
+{
+  UINTN  Bin;
+
+  if (!Entry->Indexed) {
+    return;
+  }
+
+  if (Entry->FreeLink.ForwardLink != NULL) {
+    Bin = (UINTN)HighBitSet64 (RShiftU64 (Entry->End - Entry->Start + 1, EFI_PAGE_SHIFT));
+    RemoveEntryList (&Entry->FreeLink);
+    if (IsListEmpty (&mFreeBins[Bin])) {
+      mFreeBinMap &= ~LShiftU64 (1, Bin);
+    }
+  }
+
+  HashIndexRemove (&mMemoryMapStartIndex, &Entry->StartEntry);
+  HashIndexRemove (&mMemoryMapEndIndex, &Entry->EndEntry);
+  Entry->Indexed = FALSE;
+
+  if (mLastFreePagesEntry == Entry) {
+    mLastFreePagesEntry = NULL;
+  }
+}
+
+/**
+  Internal function.  Finds the indexed descriptor entry that starts at an
+  address, or that ends right before an address.
+
+  @param  Index                  mMemoryMapStartIndex or mMemoryMapEndIndex
+  @param  Address                The start address of the entry, or the
+                                 address that follows its end
+
+  @return The entry, or NULL if there is none.
+
+**/
+STATIC
+MEMORY_MAP *
+CoreLookupMemoryMapIndex (
+  IN HASH_INDEX  *Index,
+  IN UINT64      Address
+  )
+{
+  HASH_INDEX_ENTRY  *HashEntry;
+  MEMORY_MAP        *Entry;
+
+  for (HashEntry = HashIndexGetFirst (Index, MemoryMapIndexHash (Address));
+       HashEntry != NULL;
+       HashEntry = HashIndexGetNext (Index, HashEntry))
+  {
+    if (Index == &mMemoryMapStartIndex) {
+      Entry = BASE_CR (HashEntry, MEMORY_MAP, StartEntry);
+      if (Entry->Start == Address) {
+        return Entry;
+      }
+    } else {
+      Entry = BASE_CR (HashEntry, MEMORY_MAP, EndEntry);
+      if (Entry->End + 1 == Address) {
+        return Entry;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Internal function.  Finds the descriptor entry that covers an address.
+
+  @param  Address                The address
+
+  @return The entry, or NULL if no entry covers Address.
+
+**/
+STATIC
+MEMORY_MAP *
+CoreFindMemoryMapEntry (
+  IN UINT64  Address
+  )
+{
+  LIST_ENTRY  *Link;
+  MEMORY_MAP  *Entry;
+
+  if (FeaturePcdGet (PcdDxeIndexedPageAllocator)) {
+    //
+    // Pages are usually converted right after they were found free, or at
+    // the start of a descriptor
+    //
+    Entry = mLastFreePagesEntry;
+    if ((Entry != NULL) && (Entry->Start <= Address) && (Entry->End > Address)) {
+      return Entry;
+    }
+
+    Entry = CoreLookupMemoryMapIndex (&mMemoryMapStartIndex, Address);
+    if ((Entry != NULL) && (Entry->End > Address)) {
+      return Entry;
+    }
+  }
+
+  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
+    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
+    if ((Entry->Start <= Address) && (Entry->End > Address)) {
+      return Entry;
+    }
+  }
+
+  return NULL;
+}
+
 /**
   Internal function.  Removes a descriptor entry.
 
@@ -130,6 +341,7 @@ RemoveMemoryMapEntry (
   IN OUT MEMORY_MAP  *Entry
   )
 {
+  CoreUnindexMemoryMapEntry (Entry);
   RemoveEntryList (&Entry->Link);
   Entry->Link.ForwardLink = NULL;
 
@@ -163,6 +375,7 @@ CoreAddRange (
 {
   LIST_ENTRY  *Link;
   MEMORY_MAP  *Entry;
+  BOOLEAN     Merged;
 
   ASSERT ((Start & EFI_PAGE_MASK) == 0);
   ASSERT (End > Start);
@@ -210,25 +423,44 @@ CoreAddRange (
   // and the same Attribute
   //
 
-  Link = gMemoryMap.ForwardLink;
-  while (Link != &gMemoryMap) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-    Link  = Link->ForwardLink;
+  if (FeaturePcdGet (PcdDxeIndexedPageAllocator)) {
+    do {
+      Merged = FALSE;
+      Entry  = CoreLookupMemoryMapIndex (&mMemoryMapEndIndex, Start);
+      if ((Entry != NULL) && (Entry->Type == Type) && (Entry->Attribute == Attribute)) {
+        Start = Entry->Start;
+        RemoveMemoryMapEntry (Entry);
+        Merged = TRUE;
+      }
 
-    if (Entry->Type != Type) {
-      continue;
-    }
+      Entry = CoreLookupMemoryMapIndex (&mMemoryMapStartIndex, End + 1);
+      if ((Entry != NULL) && (Entry->Type == Type) && (Entry->Attribute == Attribute)) {
+        End = Entry->End;
+        RemoveMemoryMapEntry (Entry);
+        Merged = TRUE;
+      }
+    } while (Merged);
+  } else {
+    Link = gMemoryMap.ForwardLink;
+    while (Link != &gMemoryMap) {
+      Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
+      Link  = Link->ForwardLink;
 
-    if (Entry->Attribute != Attribute) {
-      continue;
-    }
+      if (Entry->Type != Type) {
+        continue;
+      }
 
-    if (Entry->End + 1 == Start) {
-      Start = Entry->Start;
-      RemoveMemoryMapEntry (Entry);
-    } else if (Entry->Start == End + 1) {
-      End = Entry->End;
-      RemoveMemoryMapEntry (Entry);
+      if (Entry->Attribute != Attribute) {
+        continue;
+      }
+
+      if (Entry->End + 1 == Start) {
+        Start = Entry->Start;
+        RemoveMemoryMapEntry (Entry);
+      } else if (Entry->Start == End + 1) {
+        End = Entry->End;
+        RemoveMemoryMapEntry (Entry);
+      }
     }
   }
 
@@ -243,7 +475,9 @@ CoreAddRange (
   mMapStack[mMapDepth].End          = End;
   mMapStack[mMapDepth].VirtualStart = 0;
   mMapStack[mMapDepth].Attribute    = Attribute;
+  mMapStack[mMapDepth].Indexed      = FALSE;
   InsertTailList (&gMemoryMap, &mMapStack[mMapDepth].Link);
+  CoreIndexMemoryMapEntry (&mMapStack[mMapDepth]);
 
   mMapDepth += 1;
   ASSERT (mMapDepth < MAX_MAP_DEPTH);
@@ -350,6 +584,7 @@ CoreFreeMemoryMapStack (
       //
       // Move this entry to general memory
       //
+      CoreUnindexMemoryMapEntry (&mMapStack[mMapDepth]);
       RemoveEntryList (&mMapStack[mMapDepth].Link);
       mMapStack[mMapDepth].Link.ForwardLink = NULL;
 
@@ -367,6 +602,7 @@ CoreFreeMemoryMapStack (
       }
 
       InsertTailList (Link2, &Entry->Link);
+      CoreIndexMemoryMapEntry (Entry);
     } else {
       //
       // This item of mMapStack[mMapDepth] has already been dequeued from gMemoryMap list,
@@ -843,7 +1079,6 @@ CoreConvertPagesEx (
   UINT64           RangeEnd;
   UINT64           Attribute;
   EFI_MEMORY_TYPE  MemType;
-  LIST_ENTRY       *Link;
   MEMORY_MAP       *Entry;
 
   Entry         = NULL;
@@ -868,15 +1103,8 @@ CoreConvertPagesEx (
     //
     // Find the entry that the covers the range
     //
-    for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-      Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-
-      if ((Entry->Start <= Start) && (Entry->End > Start)) {
-        break;
-      }
-    }
-
-    if (Link == &gMemoryMap) {
+    Entry = CoreFindMemoryMapEntry (Start);
+    if (Entry == NULL) {
       DEBUG ((DEBUG_ERROR | DEBUG_PAGE, "ConvertPages: failed to find range %lx - %lx\n", Start, End));
       return EFI_NOT_FOUND;
     }
@@ -957,6 +1185,7 @@ CoreConvertPagesEx (
     //
     // Pull range out of descriptor
     //
+    CoreUnindexMemoryMapEntry (Entry);
     if (Entry->Start == Start) {
       //
       // Clip start
@@ -988,8 +1217,10 @@ CoreConvertPagesEx (
 
       Entry->End = Start - 1;
       ASSERT (Entry->Start < Entry->End);
+      CoreIndexMemoryMapEntry (Entry);
 
-      Entry = &mMapStack[mMapDepth];
+      Entry          = &mMapStack[mMapDepth];
+      Entry->Indexed = FALSE;
       InsertTailList (&gMemoryMap, &Entry->Link);
 
       mMapDepth += 1;
@@ -1014,6 +1245,8 @@ CoreConvertPagesEx (
     if (Entry->Start == Entry->End + 1) {
       RemoveMemoryMapEntry (Entry);
       Entry = NULL;
+    } else {
+      CoreIndexMemoryMapEntry (Entry);
     }
 
     //
@@ -1112,6 +1345,119 @@ CoreUpdateMemoryAttributes (
   CoreReleaseMemoryLock ();
 }
 
+/**
+  Internal function. Checks if a free descriptor holds a consecutive page
+  range below the requested address that is higher than the best range found
+  so far.
+
+  @param  Entry                  The free descriptor
+  @param  MaxAddress             The address that the range must be below,
+                                 aligned to the end of a page
+  @param  MinAddress             The address that the range must be above
+  @param  NumberOfBytes          Number of bytes needed
+  @param  Alignment              Bits to align with
+  @param  NeedGuard              Flag to indicate Guard page is needed or not
+  @param  Target                 The end of the best range found so far, updated
+                                 with the end of the range in Entry if it is
+                                 higher
+
+  @retval TRUE                   Target was updated.
+  @retval FALSE                  Entry does not hold a better range.
+
+**/
+STATIC
+BOOLEAN
+CoreCheckFreePagesEntry (
+  IN     MEMORY_MAP  *Entry,
+  IN     UINT64      MaxAddress,
+  IN     UINT64      MinAddress,
+  IN     UINT64      NumberOfBytes,
+  IN     UINTN       Alignment,
+  IN     BOOLEAN     NeedGuard,
+  IN OUT UINT64      *Target
+  )
+{
+  UINT64  DescStart;
+  UINT64  DescEnd;
+  UINT64  DescNumberOfBytes;
+
+  //
+  // If it's not a free entry, don't bother with it
+  //
+  if (Entry->Type != EfiConventionalMemory) {
+    return FALSE;
+  }
+
+  //
+  // Don't allocate out of Special-Purpose memory.
+  //
+  if ((Entry->Attribute & EFI_MEMORY_SP) != 0) {
+    return FALSE;
+  }
+
+  DescStart = Entry->Start;
+  DescEnd   = Entry->End;
+
+  //
+  // If desc is past max allowed address or below min allowed address, skip it
+  //
+  if ((DescStart >= MaxAddress) || (DescEnd < MinAddress)) {
+    return FALSE;
+  }
+
+  //
+  // If desc ends past max allowed address, clip the end
+  //
+  if (DescEnd >= MaxAddress) {
+    DescEnd = MaxAddress;
+  }
+
+  DescEnd = ((DescEnd + 1) & (~((UINT64)Alignment - 1))) - 1;
+
+  // Skip if DescEnd is less than DescStart after alignment clipping
+  if (DescEnd < DescStart) {
+    return FALSE;
+  }
+
+  //
+  // Compute the number of bytes we can used from this
+  // descriptor, and see it's enough to satisfy the request
+  //
+  DescNumberOfBytes = DescEnd - DescStart + 1;
+
+  if (DescNumberOfBytes < NumberOfBytes) {
+    return FALSE;
+  }
+
+  //
+  // If the start of the allocated range is below the min address allowed, skip it
+  //
+  if ((DescEnd - NumberOfBytes + 1) < MinAddress) {
+    return FALSE;
+  }
+
+  //
+  // If this is the best match so far remember it
+  //
+  if (DescEnd <= *Target) {
+    return FALSE;
+  }
+
+  if (NeedGuard) {
+    DescEnd = AdjustMemoryS (
+                DescEnd + 1 - DescNumberOfBytes,
+                DescNumberOfBytes,
+                NumberOfBytes
+                );
+    if (DescEnd == 0) {
+      return FALSE;
+    }
+  }
+
+  *Target = DescEnd;
+  return TRUE;
+}
+
 /**
   Internal function. Finds a consecutive free page range below
   the requested address.
@@ -1139,9 +1485,8 @@ CoreFindFreePagesI (
 {
   UINT64      NumberOfBytes;
   UINT64      Target;
-  UINT64      DescStart;
-  UINT64      DescEnd;
-  UINT64      DescNumberOfBytes;
+  UINT64      BinMap;
+  UINTN       Bin;
   LIST_ENTRY  *Link;
   MEMORY_MAP  *Entry;
 
@@ -1173,79 +1518,27 @@ CoreFindFreePagesI (
   NumberOfBytes = LShiftU64 (NumberOfPages, EFI_PAGE_SHIFT);
   Target        = 0;
 
-  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-
+  if (FeaturePcdGet (PcdDxeIndexedPageAllocator)) {
     //
-    // If it's not a free entry, don't bother with it
-    //
-    if (Entry->Type != EfiConventionalMemory) {
-      continue;
-    }
-
-    //
-    // Don't allocate out of Special-Purpose memory.
-    //
-    if ((Entry->Attribute & EFI_MEMORY_SP) != 0) {
-      continue;
-    }
-
-    DescStart = Entry->Start;
-    DescEnd   = Entry->End;
-
-    //
-    // If desc is past max allowed address or below min allowed address, skip it
-    //
-    if ((DescStart >= MaxAddress) || (DescEnd < MinAddress)) {
-      continue;
-    }
-
-    //
-    // If desc ends past max allowed address, clip the end
-    //
-    if (DescEnd >= MaxAddress) {
-      DescEnd = MaxAddress;
-    }
-
-    DescEnd = ((DescEnd + 1) & (~((UINT64)Alignment - 1))) - 1;
-
-    // Skip if DescEnd is less than DescStart after alignment clipping
-    if (DescEnd < DescStart) {
-      continue;
-    }
-
+    // Only the bins of descriptors with at least NumberOfPages pages are
+    // searched. The descriptors of lower bins are all too small.
     //
-    // Compute the number of bytes we can used from this
-    // descriptor, and see it's enough to satisfy the request
-    //
-    DescNumberOfBytes = DescEnd - DescStart + 1;
-
-    if (DescNumberOfBytes >= NumberOfBytes) {
-      //
-      // If the start of the allocated range is below the min address allowed, skip it
-      //
-      if ((DescEnd - NumberOfBytes + 1) < MinAddress) {
-        continue;
-      }
-
-      //
-      // If this is the best match so far remember it
-      //
-      if (DescEnd > Target) {
-        if (NeedGuard) {
-          DescEnd = AdjustMemoryS (
-                      DescEnd + 1 - DescNumberOfBytes,
-                      DescNumberOfBytes,
-                      NumberOfBytes
-                      );
-          if (DescEnd == 0) {
-            continue;
-          }
+    BinMap = mFreeBinMap & ~(LShiftU64 (1, (UINTN)HighBitSet64 (NumberOfPages)) - 1);
+    while (BinMap != 0) {
+      Bin     = (UINTN)LowBitSet64 (BinMap);
+      BinMap &= ~LShiftU64 (1, Bin);
+      for (Link = mFreeBins[Bin].ForwardLink; Link != &mFreeBins[Bin]; Link = Link->ForwardLink) {
+        Entry = BASE_CR (Link, MEMORY_MAP, FreeLink);
+        if (CoreCheckFreePagesEntry (Entry, MaxAddress, MinAddress, NumberOfBytes, Alignment, NeedGuard, &Target)) {
+          mLastFreePagesEntry = Entry;
         }
-
-        Target = DescEnd;
       }
     }
+  } else {
+    for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
+      Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
+      CoreCheckFreePagesEntry (Entry, MaxAddress, MinAddress, NumberOfBytes, Alignment, NeedGuard, &Target);
+    }
   }
 
   //
@@ -1608,6 +1901,7 @@ CoreAllocatePages (
                 NeedGuard
                 );
   if (!EFI_ERROR (Status)) {
+    gBootTraceAllocatedBytes += EFI_PAGES_TO_SIZE (NumberOfPages);
     CoreUpdateProfile (
       (EFI_PHYSICAL_ADDRESS)(UINTN)RETURN_ADDRESS (0),
       MemoryProfileActionAllocatePages,
@@ -1649,7 +1943,6 @@ CoreInternalFreePages (
   )
 {
   EFI_STATUS  Status;
-  LIST_ENTRY  *Link;
   MEMORY_MAP  *Entry;
   UINTN       Alignment;
   BOOLEAN     IsGuarded;
@@ -1663,21 +1956,8 @@ CoreInternalFreePages (
   // Find the entry that the covers the range
   //
   IsGuarded = FALSE;
-  Entry     = NULL;
-  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-    if ((Entry->Start <= Memory) && (Entry->End > Memory)) {
-      break;
-    }
-  }
-
-  if (Link == &gMemoryMap) {
-    Status = EFI_NOT_FOUND;
-    goto Done;
-  }
-
+  Entry     = CoreFindMemoryMapEntry (Memory);
   if (Entry == NULL) {
-    ASSERT (Entry != NULL);
     Status = EFI_NOT_FOUND;
     goto Done;
   }
@@ -82,6 +82,65 @@ POOL  mPoolHead[EfiMaxMemoryType];
 //
 LIST_ENTRY  mPoolHeadList = INITIALIZE_LIST_HEAD_VARIABLE (mPoolHeadList);
 
+//
+// Slab allocation mode (PcdDxePoolSlabAllocator).
+//
+// Small allocations are served from EFI_PAGE_SIZE slabs holding objects of
+// a single size class. Objects carry no POOL_HEAD/POOL_TAIL; the POOL_SLAB
+// header at the start of the page records the memory type and size class
+// for all of them. Each memory type keeps a small magazine of recently freed
+// objects per size class, so that the common free/allocate pattern does not
+// touch the slab lists at all.
+//
+// The pages of the slabs are recorded in a hash index, so that FreePool()
+// tells slab objects from regular pool entries without trusting the memory
+// at the start of the page of the buffer, which may be caller data.
+//
+STATIC CONST UINT16  mPoolSlabSizeTable[] = {
+  16, 32, 48, 64, 96, 128, 192, 256, 384, 512
+};
+
+#define POOL_SLAB_CLASS_COUNT    (ARRAY_SIZE (mPoolSlabSizeTable))
+#define POOL_SLAB_MAX_SIZE       512
+#define POOL_SLAB_MAGAZINE_SIZE  8
+#define POOL_SLAB_INDEX_BUCKETS  256
+
+#define POOL_SLAB_SIGNATURE  SIGNATURE_32('p','s','l','b')
+typedef struct {
+  UINT32              Signature;
+  UINT16              ClassIndex;
+  UINT16              FreeCount;
+  EFI_MEMORY_TYPE     Type;
+  /// Singly linked list of free objects, threaded through the objects
+  VOID                *FreeList;
+  /// Link on POOL_SLAB_CACHE.Partial[ClassIndex] while FreeCount != 0
+  LIST_ENTRY          Link;
+  /// Entry of the slab in mPoolSlabIndex, keyed by the address of the slab
+  HASH_INDEX_ENTRY    IndexEntry;
+} POOL_SLAB;
+
+#define POOL_SLAB_OBJECT_OFFSET  ALIGN_VALUE (sizeof (POOL_SLAB), 16)
+
+typedef struct {
+  /// Slabs with at least one free object, per size class
+  LIST_ENTRY    Partial[POOL_SLAB_CLASS_COUNT];
+  /// Recently freed objects, per size class
+  VOID          *Magazine[POOL_SLAB_CLASS_COUNT][POOL_SLAB_MAGAZINE_SIZE];
+  UINTN         MagazineCount[POOL_SLAB_CLASS_COUNT];
+} POOL_SLAB_CACHE;
+
+//
+// Slab caches for each memory type. OEM and OS memory types are not served
+// from slabs.
+//
+STATIC POOL_SLAB_CACHE  mPoolSlabCache[EfiMaxMemoryType];
+
+//
+// The pages of all the slabs
+//
+STATIC LIST_ENTRY  mPoolSlabIndexBuckets[POOL_SLAB_INDEX_BUCKETS];
+STATIC HASH_INDEX  mPoolSlabIndex = HASH_INDEX_INITIALIZER (mPoolSlabIndexBuckets);
+
 /**
   Get pool size table index from the specified size.
 
@@ -126,6 +185,11 @@ CoreInitializePool (
     for (Index = 0; Index < MAX_POOL_LIST; Index++) {
       InitializeListHead (&mPoolHead[Type].FreeList[Index]);
     }
+
+    for (Index = 0; Index < POOL_SLAB_CLASS_COUNT; Index++) {
+      InitializeListHead (&mPoolSlabCache[Type].Partial[Index]);
+      mPoolSlabCache[Type].MagazineCount[Index] = 0;
+    }
   }
 }
 
@@ -274,6 +338,7 @@ CoreAllocatePool (
 
   Status = CoreInternalAllocatePool (PoolType, Size, Buffer);
   if (!EFI_ERROR (Status)) {
+    gBootTraceAllocatedBytes += Size;
     CoreUpdateProfile (
       (EFI_PHYSICAL_ADDRESS)(UINTN)RETURN_ADDRESS (0),
       MemoryProfileActionAllocatePool,
@@ -336,6 +401,157 @@ CoreAllocatePoolPagesI (
   return Buffer;
 }
 
+/**
+  Get the slab size class index for the specified size.
+
+  @param  Size          The size of the requested object.
+
+  @return               The index of the slab size table, or
+                        POOL_SLAB_CLASS_COUNT if Size is too large.
+
+**/
+STATIC
+UINTN
+GetPoolSlabClassFromSize (
+  UINTN  Size
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < POOL_SLAB_CLASS_COUNT; Index++) {
+    if (mPoolSlabSizeTable[Index] >= Size) {
+      return Index;
+    }
+  }
+
+  return POOL_SLAB_CLASS_COUNT;
+}
+
+/**
+  Internal function to find the slab that owns a page.
+
+  @param  Page                   The address of the page.
+
+  @return The slab at the start of the page, or NULL if the page is not a
+          slab page.
+
+**/
+STATIC
+POOL_SLAB *
+LookupPoolSlab (
+  IN VOID  *Page
+  )
+{
+  HASH_INDEX_ENTRY  *Entry;
+  POOL_SLAB         *Slab;
+
+  for (Entry = HashIndexGetFirst (&mPoolSlabIndex, HashIndexPointer (Page));
+       Entry != NULL;
+       Entry = HashIndexGetNext (&mPoolSlabIndex, Entry))
+  {
+    Slab = BASE_CR (Entry, POOL_SLAB, IndexEntry);
+    if (Slab == Page) {
+      return Slab;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Internal function to allocate a header-less object from the slab cache of
+  a memory type. Caller must have the memory lock held
+
+  @param  PoolType               Type of pool to allocate
+  @param  Size                   The amount of pool to allocate
+
+  @return The allocated object, or NULL if the request cannot be served from
+          a slab.
+
+**/
+STATIC
+VOID *
+CoreAllocatePoolSlabI (
+  IN EFI_MEMORY_TYPE  PoolType,
+  IN UINTN            Size
+  )
+{
+  POOL_SLAB_CACHE  *Cache;
+  POOL_SLAB        *Slab;
+  UINTN            ClassIndex;
+  UINTN            ObjectSize;
+  UINTN            ObjectCount;
+  UINTN            Index;
+  CHAR8            *Object;
+
+  ASSERT_LOCKED (&mPoolMemoryLock);
+
+  if (((UINT32)PoolType >= EfiMaxMemoryType) || (Size > POOL_SLAB_MAX_SIZE)) {
+    return NULL;
+  }
+
+  Cache      = &mPoolSlabCache[PoolType];
+  ClassIndex = GetPoolSlabClassFromSize (MAX (Size, 1));
+  ObjectSize = mPoolSlabSizeTable[ClassIndex];
+
+  //
+  // Recently freed objects are the cheapest to hand out
+  //
+  if (Cache->MagazineCount[ClassIndex] > 0) {
+    Cache->MagazineCount[ClassIndex]--;
+    Object = Cache->Magazine[ClassIndex][Cache->MagazineCount[ClassIndex]];
+    goto Done;
+  }
+
+  if (IsListEmpty (&Cache->Partial[ClassIndex])) {
+    //
+    // Get another page and thread all of its objects onto the slab free list
+    //
+    Slab = CoreAllocatePoolPagesI (PoolType, 1, EFI_PAGE_SIZE, FALSE);
+    if (Slab == NULL) {
+      return NULL;
+    }
+
+    Slab->Signature  = POOL_SLAB_SIGNATURE;
+    Slab->ClassIndex = (UINT16)ClassIndex;
+    Slab->FreeCount  = 0;
+    Slab->Type       = PoolType;
+    Slab->FreeList   = NULL;
+
+    //
+    // Objects are laid out backwards from the end of the page, so the lowest
+    // address is handed out first
+    //
+    ObjectCount = (EFI_PAGE_SIZE - POOL_SLAB_OBJECT_OFFSET) / ObjectSize;
+    for (Index = 1; Index <= ObjectCount; Index++) {
+      Object           = (CHAR8 *)Slab + EFI_PAGE_SIZE - Index * ObjectSize;
+      *(VOID **)Object = Slab->FreeList;
+      Slab->FreeList   = Object;
+    }
+
+    Slab->FreeCount = (UINT16)ObjectCount;
+
+    InsertHeadList (&Cache->Partial[ClassIndex], &Slab->Link);
+    HashIndexInsert (&mPoolSlabIndex, &Slab->IndexEntry, HashIndexPointer (Slab));
+    DEBUG ((DEBUG_POOL, "AllocatePoolI: New slab Type %x, Addr %p, object size %d\n", PoolType, Slab, ObjectSize));
+  }
+
+  Slab = CR (Cache->Partial[ClassIndex].ForwardLink, POOL_SLAB, Link, POOL_SLAB_SIGNATURE);
+  ASSERT (Slab->FreeCount > 0);
+
+  Object         = Slab->FreeList;
+  Slab->FreeList = *(VOID **)Object;
+  Slab->FreeCount--;
+  if (Slab->FreeCount == 0) {
+    RemoveEntryList (&Slab->Link);
+  }
+
+Done:
+  DEBUG_CLEAR_MEMORY (Object, ObjectSize);
+  DEBUG ((DEBUG_POOL, "AllocatePoolI: Type %x, Addr %p (len %lx) slab\n", PoolType, Object, (UINT64)ObjectSize));
+  return Object;
+}
+
 /**
   Internal function to allocate pool of a particular type.
   Caller must have the memory lock held
@@ -399,6 +615,19 @@ CoreAllocatePoolI (
                   ((PcdGet8 (PcdHeapGuardPropertyMask) & BIT7) == 0));
   PageAsPool = (IsHeapGuardEnabled (GUARD_HEAP_TYPE_FREED) && !mOnGuarding);
 
+  //
+  // Serve small requests from the slab cache unless the allocation has to be
+  // guarded, which needs the regular pool layout
+  //
+  if (FeaturePcdGet (PcdDxePoolSlabAllocator) &&
+      (Granularity == EFI_PAGE_SIZE) && !NeedGuard && !PageAsPool)
+  {
+    Buffer = CoreAllocatePoolSlabI (PoolType, ALIGN_VARIABLE (Size));
+    if (Buffer != NULL) {
+      return Buffer;
+    }
+  }
+
   //
   // Adjusting the Size to be of proper alignment so that
   // we don't get an unaligned access fault later when
@@ -676,6 +905,98 @@ CoreFreePoolPagesWithGuard (
   }
 }
 
+/**
+  Internal function to return an object to the slab cache it was allocated
+  from. Caller must have the memory lock held
+
+  @param  Buffer                 The allocated pool entry to free
+  @param  PoolType               Pointer to pool type
+
+  @retval EFI_NOT_FOUND          Buffer is not a slab object
+  @retval EFI_INVALID_PARAMETER  Buffer is inside a slab but is not a valid
+                                 object address
+  @retval EFI_SUCCESS            Buffer successfully freed.
+
+**/
+STATIC
+EFI_STATUS
+CoreFreePoolSlabI (
+  IN VOID              *Buffer,
+  OUT EFI_MEMORY_TYPE  *PoolType OPTIONAL
+  )
+{
+  POOL_SLAB_CACHE  *Cache;
+  POOL_SLAB        *Slab;
+  UINTN            ClassIndex;
+  UINTN            ObjectSize;
+  UINTN            Offset;
+  UINTN            ObjectCount;
+
+  ASSERT_LOCKED (&mPoolMemoryLock);
+
+  //
+  // Slab objects find their POOL_SLAB at the start of the page. The page is
+  // looked up in the index of the slabs rather than recognized by its
+  // content, as the page of a regular pool entry may start with caller data.
+  //
+  Slab = LookupPoolSlab ((VOID *)((UINTN)Buffer & ~(UINTN)EFI_PAGE_MASK));
+  if (Slab == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  ASSERT (Slab->Signature == POOL_SLAB_SIGNATURE);
+
+  ClassIndex = Slab->ClassIndex;
+  ObjectSize = mPoolSlabSizeTable[ClassIndex];
+  Offset     = (UINTN)Buffer - (UINTN)Slab;
+  if ((Offset < POOL_SLAB_OBJECT_OFFSET) ||
+      (((EFI_PAGE_SIZE - Offset) % ObjectSize) != 0))
+  {
+    ASSERT (FALSE);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (PoolType != NULL) {
+    *PoolType = Slab->Type;
+  }
+
+  DEBUG_CLEAR_MEMORY (Buffer, ObjectSize);
+  DEBUG ((DEBUG_POOL, "FreePool: %p (len %lx) slab\n", Buffer, (UINT64)ObjectSize));
+
+  Cache = &mPoolSlabCache[Slab->Type];
+  if (Cache->MagazineCount[ClassIndex] < POOL_SLAB_MAGAZINE_SIZE) {
+    Cache->Magazine[ClassIndex][Cache->MagazineCount[ClassIndex]] = Buffer;
+    Cache->MagazineCount[ClassIndex]++;
+    return EFI_SUCCESS;
+  }
+
+  //
+  // The magazine is full, give the object back to its slab
+  //
+  *(VOID **)Buffer = Slab->FreeList;
+  Slab->FreeList   = Buffer;
+  Slab->FreeCount++;
+  if (Slab->FreeCount == 1) {
+    InsertTailList (&Cache->Partial[ClassIndex], &Slab->Link);
+  }
+
+  //
+  // Release the page once every object in it is free, keeping the last
+  // partial slab of the class to avoid allocating a new page right away.
+  //
+  ObjectCount = (EFI_PAGE_SIZE - POOL_SLAB_OBJECT_OFFSET) / ObjectSize;
+  if ((Slab->FreeCount == ObjectCount) &&
+      !IsNodeAtEnd (&Cache->Partial[ClassIndex], GetFirstNode (&Cache->Partial[ClassIndex])))
+  {
+    RemoveEntryList (&Slab->Link);
+    HashIndexRemove (&mPoolSlabIndex, &Slab->IndexEntry);
+    Slab->Signature = 0;
+    CoreFreePoolPagesI (Slab->Type, (EFI_PHYSICAL_ADDRESS)(UINTN)Slab, 1);
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Internal function to free a pool entry.
   Caller must have the memory lock held
@@ -693,22 +1014,31 @@ CoreFreePoolI (
   OUT EFI_MEMORY_TYPE  *PoolType OPTIONAL
   )
 {
-  POOL       *Pool;
-  POOL_HEAD  *Head;
-  POOL_TAIL  *Tail;
-  POOL_FREE  *Free;
-  UINTN      Index;
-  UINTN      NoPages;
-  UINTN      Size;
-  CHAR8      *NewPage;
-  UINTN      Offset;
-  BOOLEAN    AllFree;
-  UINTN      Granularity;
-  BOOLEAN    IsGuarded;
-  BOOLEAN    HasPoolTail;
-  BOOLEAN    PageAsPool;
+  POOL        *Pool;
+  POOL_HEAD   *Head;
+  POOL_TAIL   *Tail;
+  POOL_FREE   *Free;
+  UINTN       Index;
+  UINTN       NoPages;
+  UINTN       Size;
+  CHAR8       *NewPage;
+  UINTN       Offset;
+  BOOLEAN     AllFree;
+  UINTN       Granularity;
+  BOOLEAN     IsGuarded;
+  BOOLEAN     HasPoolTail;
+  BOOLEAN     PageAsPool;
+  EFI_STATUS  Status;
 
   ASSERT (Buffer != NULL);
+
+  if (FeaturePcdGet (PcdDxePoolSlabAllocator)) {
+    Status = CoreFreePoolSlabI (Buffer, PoolType);
+    if (Status != EFI_NOT_FOUND) {
+      return Status;
+    }
+  }
+
   //
   // Get the head & tail of the pool entry
   //
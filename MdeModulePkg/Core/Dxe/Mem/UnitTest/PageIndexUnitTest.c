@@ -0,0 +1,773 @@
+/** @file
+  Host based unit tests of the DXE core memory map index.
+
+  Page.c is built with PcdDxeIndexedPageAllocator set and the locks, heap
+  guard and memory protection of the DXE core replaced by the stubs below.
+  The memory map is made of buffers of the host, so that the pages the DXE
+  core allocates for its own descriptors are real memory.
+
+  After every random allocation and free, the free descriptor bins and the
+  address hashes are checked against the memory map, and searches for free
+  pages are checked against a walk of the memory map.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../../DxeMain.h"
+#include "../Imem.h"
+#include "../HeapGuard.h"
+
+#include <Library/UnitTestLib.h>
+#include <Library/UnitTestRandomLib.h>
+
+#define UNIT_TEST_APP_NAME     "DXE Core Memory Map Index Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_RANGE_COUNT       4
+#define TEST_RANGE_PAGES       1024
+#define TEST_ALLOCATION_COUNT  512
+#define TEST_RANDOM_STEPS      4000
+#define TEST_FREE_BIN_COUNT    64
+
+typedef struct {
+  EFI_PHYSICAL_ADDRESS    Base;
+  UINTN                   Pages;
+  EFI_MEMORY_TYPE         Type;
+} TEST_ALLOCATION;
+
+typedef struct {
+  VOID               *Ranges[TEST_RANGE_COUNT];
+  TEST_ALLOCATION    Allocations[TEST_ALLOCATION_COUNT];
+  UINTN              AllocationCount;
+  UINT64             Seed;
+} TEST_CONTEXT;
+
+//
+// Memory map index of Page.c
+//
+extern LIST_ENTRY  mFreeBins[TEST_FREE_BIN_COUNT];
+extern UINT64      mFreeBinMap;
+extern HASH_INDEX  mMemoryMapStartIndex;
+extern HASH_INDEX  mMemoryMapEndIndex;
+
+UINT64
+CoreFindFreePagesI (
+  IN UINT64           MaxAddress,
+  IN UINT64           MinAddress,
+  IN UINT64           NumberOfPages,
+  IN EFI_MEMORY_TYPE  NewType,
+  IN UINTN            Alignment,
+  IN BOOLEAN          NeedGuard
+  );
+
+STATIC CONST EFI_MEMORY_TYPE  mTestMemoryTypes[] = {
+  EfiBootServicesData,
+  EfiBootServicesCode,
+  EfiRuntimeServicesData,
+  EfiACPIMemoryNVS,
+  EfiLoaderData
+};
+
+//
+// Stubs of the DXE core services used by Page.c
+//
+BOOLEAN                                      mOnGuarding              = FALSE;
+UINT64                                       gBootTraceAllocatedBytes = 0;
+EFI_HANDLE                                   gDxeCoreImageHandle      = NULL;
+LIST_ENTRY                                   mGcdMemorySpaceMap       = INITIALIZE_LIST_HEAD_VARIABLE (mGcdMemorySpaceMap);
+EFI_LOAD_FIXED_ADDRESS_CONFIGURATION_TABLE  gLoadModuleAtFixAddressConfigurationTable;
+
+VOID
+CoreAcquireLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockReleased);
+  Lock->Lock = EfiLockAcquired;
+}
+
+EFI_STATUS
+CoreAcquireLockOrFail (
+  IN EFI_LOCK  *Lock
+  )
+{
+  if (Lock->Lock == EfiLockAcquired) {
+    return EFI_ACCESS_DENIED;
+  }
+
+  Lock->Lock = EfiLockAcquired;
+  return EFI_SUCCESS;
+}
+
+VOID
+CoreReleaseLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockAcquired);
+  Lock->Lock = EfiLockReleased;
+}
+
+VOID
+CoreAcquireGcdMemoryLock (
+  VOID
+  )
+{
+}
+
+VOID
+CoreReleaseGcdMemoryLock (
+  VOID
+  )
+{
+}
+
+EFI_STATUS
+EFIAPI
+CoreGetMemorySpaceDescriptor (
+  IN  EFI_PHYSICAL_ADDRESS             BaseAddress,
+  OUT EFI_GCD_MEMORY_SPACE_DESCRIPTOR  *Descriptor
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+VOID
+CoreNotifySignalList (
+  IN EFI_GUID  *EventGroup
+  )
+{
+}
+
+VOID
+MergeMemoryMap (
+  IN OUT EFI_MEMORY_DESCRIPTOR  *MemoryMap,
+  IN OUT UINTN                  *MemoryMapSize,
+  IN UINTN                      DescriptorSize
+  )
+{
+}
+
+VOID
+EFIAPI
+DumpGuardedMemoryBitmap (
+  VOID
+  )
+{
+}
+
+BOOLEAN
+IsPageTypeToGuard (
+  IN EFI_MEMORY_TYPE    MemoryType,
+  IN EFI_ALLOCATE_TYPE  AllocateType
+  )
+{
+  return FALSE;
+}
+
+BOOLEAN
+IsHeapGuardEnabled (
+  UINT8  GuardType
+  )
+{
+  return FALSE;
+}
+
+BOOLEAN
+EFIAPI
+IsMemoryGuarded (
+  IN EFI_PHYSICAL_ADDRESS  Address
+  )
+{
+  return FALSE;
+}
+
+UINT64
+AdjustMemoryS (
+  IN UINT64  Start,
+  IN UINT64  Size,
+  IN UINT64  SizeRequested
+  )
+{
+  return Start + Size - 1;
+}
+
+VOID
+AdjustMemoryF (
+  IN OUT EFI_PHYSICAL_ADDRESS  *Memory,
+  IN OUT UINTN                 *NumberOfPages
+  )
+{
+}
+
+VOID
+AdjustMemoryA (
+  IN OUT EFI_PHYSICAL_ADDRESS  *Memory,
+  IN OUT UINTN                 *NumberOfPages
+  )
+{
+}
+
+EFI_STATUS
+CoreConvertPagesWithGuard (
+  IN UINT64           Start,
+  IN UINTN            NumberOfPages,
+  IN EFI_MEMORY_TYPE  NewType
+  )
+{
+  return CoreConvertPages (Start, NumberOfPages, NewType);
+}
+
+VOID
+SetGuardForMemory (
+  IN EFI_PHYSICAL_ADDRESS  Memory,
+  IN UINTN                 NumberOfPages
+  )
+{
+}
+
+VOID
+EFIAPI
+GuardFreedPagesChecked (
+  IN  EFI_PHYSICAL_ADDRESS  BaseAddress,
+  IN  UINTN                 Pages
+  )
+{
+}
+
+BOOLEAN
+PromoteGuardedFreePages (
+  OUT EFI_PHYSICAL_ADDRESS  *StartAddress,
+  OUT EFI_PHYSICAL_ADDRESS  *EndAddress
+  )
+{
+  return FALSE;
+}
+
+EFI_STATUS
+EFIAPI
+CoreUpdateProfile (
+  IN EFI_PHYSICAL_ADDRESS   CallerAddress,
+  IN MEMORY_PROFILE_ACTION  Action,
+  IN EFI_MEMORY_TYPE        MemoryType,
+  IN UINTN                  Size,
+  IN VOID                   *Buffer,
+  IN CHAR8                  *ActionString OPTIONAL
+  )
+{
+  return EFI_SUCCESS;
+}
+
+VOID
+InstallMemoryAttributesTableOnMemoryAllocation (
+  IN EFI_MEMORY_TYPE  MemoryType
+  )
+{
+}
+
+EFI_STATUS
+EFIAPI
+ApplyMemoryProtectionPolicy (
+  IN  EFI_MEMORY_TYPE       OldType,
+  IN  EFI_MEMORY_TYPE       NewType,
+  IN  EFI_PHYSICAL_ADDRESS  Memory,
+  IN  UINT64                Length
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Check whether a descriptor is a free descriptor, which is indexed in the
+  free bins.
+
+  @param[in] Entry  The descriptor.
+
+  @retval TRUE   The descriptor is free.
+  @retval FALSE  The descriptor is not free.
+**/
+STATIC
+BOOLEAN
+TestIsFreeEntry (
+  IN MEMORY_MAP  *Entry
+  )
+{
+  return (BOOLEAN)((Entry->Type == EfiConventionalMemory) && ((Entry->Attribute & EFI_MEMORY_SP) == 0));
+}
+
+/**
+  Check whether an address hash of the memory map index holds a descriptor.
+
+  @param[in] Index      mMemoryMapStartIndex or mMemoryMapEndIndex.
+  @param[in] Address    The address the descriptor is indexed by.
+  @param[in] HashEntry  The hash entry of the descriptor.
+
+  @retval TRUE   The descriptor is found.
+  @retval FALSE  The descriptor is missing.
+**/
+STATIC
+BOOLEAN
+TestHashHoldsEntry (
+  IN HASH_INDEX        *Index,
+  IN UINT64            Address,
+  IN HASH_INDEX_ENTRY  *HashEntry
+  )
+{
+  HASH_INDEX_ENTRY  *Found;
+
+  for (Found = HashIndexGetFirst (Index, HashIndexPointer ((VOID *)(UINTN)RShiftU64 (Address, EFI_PAGE_SHIFT)));
+       Found != NULL;
+       Found = HashIndexGetNext (Index, Found))
+  {
+    if (Found == HashEntry) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Check that the memory map is sorted and that the free bins, the free bin
+  bitmap and the address hashes describe it.
+
+  @retval UNIT_TEST_PASSED             The index matches the memory map.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The index does not match.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestCheckIndex (
+  VOID
+  )
+{
+  LIST_ENTRY  *Link;
+  LIST_ENTRY  *BinLink;
+  MEMORY_MAP  *Entry;
+  MEMORY_MAP  *Previous;
+  UINTN       Bin;
+  UINTN       FreeEntryCount;
+  UINTN       BinEntryCount;
+
+  Previous       = NULL;
+  FreeEntryCount = 0;
+  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
+    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
+    UT_ASSERT_TRUE (Entry->Indexed);
+    UT_ASSERT_TRUE (Entry->Start < Entry->End);
+    UT_ASSERT_EQUAL (Entry->Start & EFI_PAGE_MASK, 0);
+    UT_ASSERT_EQUAL (Entry->End & EFI_PAGE_MASK, EFI_PAGE_MASK);
+    if (Previous != NULL) {
+      UT_ASSERT_TRUE (Previous->End < Entry->Start);
+    }
+
+    UT_ASSERT_TRUE (TestHashHoldsEntry (&mMemoryMapStartIndex, Entry->Start, &Entry->StartEntry));
+    UT_ASSERT_TRUE (TestHashHoldsEntry (&mMemoryMapEndIndex, Entry->End + 1, &Entry->EndEntry));
+
+    if (TestIsFreeEntry (Entry)) {
+      FreeEntryCount++;
+      Bin = (UINTN)HighBitSet64 (RShiftU64 (Entry->End - Entry->Start + 1, EFI_PAGE_SHIFT));
+      UT_ASSERT_TRUE (IsNodeInList (&mFreeBins[Bin], &Entry->FreeLink));
+    } else {
+      UT_ASSERT_TRUE (Entry->FreeLink.ForwardLink == NULL);
+    }
+
+    Previous = Entry;
+  }
+
+  //
+  // The bins only hold free descriptors of the memory map, and the bitmap
+  // tells the non-empty bins.
+  //
+  BinEntryCount = 0;
+  for (Bin = 0; Bin < TEST_FREE_BIN_COUNT; Bin++) {
+    UT_ASSERT_EQUAL (!IsListEmpty (&mFreeBins[Bin]), (RShiftU64 (mFreeBinMap, Bin) & 1) != 0);
+    for (BinLink = mFreeBins[Bin].ForwardLink; BinLink != &mFreeBins[Bin]; BinLink = BinLink->ForwardLink) {
+      Entry = BASE_CR (BinLink, MEMORY_MAP, FreeLink);
+      UT_ASSERT_TRUE (TestIsFreeEntry (Entry));
+      BinEntryCount++;
+    }
+  }
+
+  UT_ASSERT_EQUAL (BinEntryCount, FreeEntryCount);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Find free pages by walking the memory map, as CoreFindFreePagesI() does
+  without the index.
+
+  @param[in] MaxAddress     The address that the range must be below, the
+                            last byte of a page.
+  @param[in] MinAddress     The address that the range must be above.
+  @param[in] NumberOfPages  Number of pages needed.
+  @param[in] Alignment      Alignment of the range.
+
+  @return The base address of the range, or 0 if the range was not found.
+**/
+STATIC
+UINT64
+TestFindFreePagesByWalk (
+  IN UINT64  MaxAddress,
+  IN UINT64  MinAddress,
+  IN UINT64  NumberOfPages,
+  IN UINTN   Alignment
+  )
+{
+  LIST_ENTRY  *Link;
+  MEMORY_MAP  *Entry;
+  UINT64      NumberOfBytes;
+  UINT64      DescStart;
+  UINT64      DescEnd;
+  UINT64      Target;
+
+  NumberOfBytes = LShiftU64 (NumberOfPages, EFI_PAGE_SHIFT);
+  Target        = 0;
+  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
+    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
+    if (!TestIsFreeEntry (Entry) || (Entry->Start >= MaxAddress) || (Entry->End < MinAddress)) {
+      continue;
+    }
+
+    DescStart = Entry->Start;
+    DescEnd   = MIN (Entry->End, MaxAddress);
+    DescEnd   = ((DescEnd + 1) & ~((UINT64)Alignment - 1)) - 1;
+    if ((DescEnd < DescStart) || (DescEnd - DescStart + 1 < NumberOfBytes) ||
+        (DescEnd - NumberOfBytes + 1 < MinAddress) || (DescEnd <= Target))
+    {
+      continue;
+    }
+
+    Target = DescEnd;
+  }
+
+  return (Target == 0) ? 0 : Target - NumberOfBytes + 1;
+}
+
+/**
+  Add the test ranges to the memory map once, as conventional memory
+  separated by reserved pages.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED                      The memory map is set up.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The ranges could not be
+                                                allocated.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+PageIndexTestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT          *TestContext;
+  UINTN                 Index;
+  EFI_PHYSICAL_ADDRESS  Base;
+
+  TestContext       = (TEST_CONTEXT *)Context;
+  TestContext->Seed = 0x5EED;
+  if (TestContext->Ranges[0] != NULL) {
+    return UNIT_TEST_PASSED;
+  }
+
+  for (Index = 0; Index < TEST_RANGE_COUNT; Index++) {
+    TestContext->Ranges[Index] = AllocateAlignedPages (TEST_RANGE_PAGES, EFI_PAGE_SIZE);
+    if (TestContext->Ranges[Index] == NULL) {
+      return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+    }
+
+    //
+    // The first and last pages of each range are reserved, so that the free
+    // descriptors of the ranges are never merged. The conventional memory is
+    // added first so that the descriptor stack can be moved to it.
+    //
+    Base = (EFI_PHYSICAL_ADDRESS)(UINTN)TestContext->Ranges[Index];
+    CoreAddMemoryDescriptor (EfiConventionalMemory, Base + EFI_PAGE_SIZE, TEST_RANGE_PAGES - 2, EFI_MEMORY_WB);
+    CoreAddMemoryDescriptor (EfiReservedMemoryType, Base, 1, EFI_MEMORY_WB);
+    CoreAddMemoryDescriptor (EfiReservedMemoryType, Base + EFI_PAGES_TO_SIZE (TEST_RANGE_PAGES - 1), 1, EFI_MEMORY_WB);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the allocations recorded by the test.
+
+  @param[in]  Context    The test context.
+**/
+STATIC
+VOID
+EFIAPI
+PageIndexTestCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  while (TestContext->AllocationCount > 0) {
+    TestContext->AllocationCount--;
+    CoreFreePages (
+      TestContext->Allocations[TestContext->AllocationCount].Base,
+      TestContext->Allocations[TestContext->AllocationCount].Pages
+      );
+  }
+}
+
+/**
+  Check that the free pages found with the index are those found by walking
+  the memory map, while random allocations change it.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+FindFreePagesMatchesWalk (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT          *TestContext;
+  UINTN                 Step;
+  UINT64                Pages;
+  UINT64                MaxAddress;
+  UINT64                MinAddress;
+  UINTN                 Alignment;
+  EFI_PHYSICAL_ADDRESS  Memory;
+  TEST_ALLOCATION       *Allocation;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  for (Step = 0; Step < TEST_RANDOM_STEPS; Step++) {
+    Pages      = 1 + UnitTestRandom (&TestContext->Seed) % ((UnitTestRandom (&TestContext->Seed) % 4 == 0) ? TEST_RANGE_PAGES : 16);
+    MaxAddress = (UINT64)(UINTN)TestContext->Ranges[UnitTestRandom (&TestContext->Seed) % TEST_RANGE_COUNT] +
+                 EFI_PAGES_TO_SIZE (UnitTestRandom (&TestContext->Seed) % (TEST_RANGE_PAGES + 1)) - 1;
+    if (UnitTestRandom (&TestContext->Seed) % 4 == 0) {
+      MaxAddress = MAX_ALLOC_ADDRESS;
+    }
+
+    MinAddress = (UnitTestRandom (&TestContext->Seed) % 4 == 0) ? MaxAddress / 2 : 0;
+    Alignment  = EFI_PAGE_SIZE << (UnitTestRandom (&TestContext->Seed) % 4);
+
+    UT_ASSERT_EQUAL (
+      CoreFindFreePagesI (MaxAddress, MinAddress, Pages, EfiBootServicesData, Alignment, FALSE),
+      TestFindFreePagesByWalk (MaxAddress, MinAddress, Pages, Alignment)
+      );
+
+    //
+    // Allocate the pages or free an allocation, so that the memory map keeps
+    // changing.
+    //
+    if ((TestContext->AllocationCount < TEST_ALLOCATION_COUNT) && (UnitTestRandom (&TestContext->Seed) % 3 != 0)) {
+      Allocation       = &TestContext->Allocations[TestContext->AllocationCount];
+      Allocation->Type = mTestMemoryTypes[UnitTestRandom (&TestContext->Seed) % ARRAY_SIZE (mTestMemoryTypes)];
+      Memory           = MaxAddress;
+      if (!EFI_ERROR (CoreAllocatePages (AllocateMaxAddress, Allocation->Type, (UINTN)Pages, &Memory))) {
+        Allocation->Base  = Memory;
+        Allocation->Pages = (UINTN)Pages;
+        TestContext->AllocationCount++;
+      }
+    } else if (TestContext->AllocationCount > 0) {
+      Allocation = &TestContext->Allocations[UnitTestRandom (&TestContext->Seed) % TestContext->AllocationCount];
+      UT_ASSERT_NOT_EFI_ERROR (CoreFreePages (Allocation->Base, Allocation->Pages));
+      *Allocation = TestContext->Allocations[--TestContext->AllocationCount];
+    }
+
+    UT_ASSERT_EQUAL (TestCheckIndex (), UNIT_TEST_PASSED);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that the index follows the memory map through random allocations at
+  any, maximum and fixed addresses, and frees of whole allocations and of
+  pages at their start, end and middle.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+RandomAllocationsKeepIndex (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT          *TestContext;
+  UINTN                 Step;
+  UINTN                 Pages;
+  UINTN                 Offset;
+  EFI_ALLOCATE_TYPE     AllocateType;
+  EFI_PHYSICAL_ADDRESS  Memory;
+  EFI_STATUS            Status;
+  TEST_ALLOCATION       *Allocation;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  for (Step = 0; Step < TEST_RANDOM_STEPS; Step++) {
+    if ((TestContext->AllocationCount < TEST_ALLOCATION_COUNT - 1) && (UnitTestRandom (&TestContext->Seed) % 2 == 0)) {
+      Allocation       = &TestContext->Allocations[TestContext->AllocationCount];
+      Allocation->Type = mTestMemoryTypes[UnitTestRandom (&TestContext->Seed) % ARRAY_SIZE (mTestMemoryTypes)];
+      Pages            = 1 + UnitTestRandom (&TestContext->Seed) % 32;
+      AllocateType     = (EFI_ALLOCATE_TYPE)(UnitTestRandom (&TestContext->Seed) % 3);
+      Memory           = MAX_ALLOC_ADDRESS;
+      if (AllocateType == AllocateMaxAddress) {
+        Memory = (UINT64)(UINTN)TestContext->Ranges[UnitTestRandom (&TestContext->Seed) % TEST_RANGE_COUNT] +
+                 EFI_PAGES_TO_SIZE (UnitTestRandom (&TestContext->Seed) % TEST_RANGE_PAGES) - 1;
+      } else if (AllocateType == AllocateAddress) {
+        Memory = (UINT64)(UINTN)TestContext->Ranges[UnitTestRandom (&TestContext->Seed) % TEST_RANGE_COUNT] +
+                 EFI_PAGES_TO_SIZE (UnitTestRandom (&TestContext->Seed) % TEST_RANGE_PAGES);
+      }
+
+      Status = CoreAllocatePages (AllocateType, Allocation->Type, Pages, &Memory);
+      if (!EFI_ERROR (Status)) {
+        Allocation->Base  = Memory;
+        Allocation->Pages = Pages;
+        TestContext->AllocationCount++;
+      }
+    } else if (TestContext->AllocationCount > 0) {
+      Allocation = &TestContext->Allocations[UnitTestRandom (&TestContext->Seed) % TestContext->AllocationCount];
+      Pages      = 1 + UnitTestRandom (&TestContext->Seed) % Allocation->Pages;
+      Offset     = UnitTestRandom (&TestContext->Seed) % (Allocation->Pages - Pages + 1);
+      if (TestContext->AllocationCount == TEST_ALLOCATION_COUNT) {
+        //
+        // No room to record the pages left after the freed ones.
+        //
+        Pages = Allocation->Pages - Offset;
+      }
+
+      UT_ASSERT_NOT_EFI_ERROR (CoreFreePages (Allocation->Base + EFI_PAGES_TO_SIZE (Offset), Pages));
+
+      //
+      // Keep the pages left before and after the freed ones.
+      //
+      if (Offset + Pages < Allocation->Pages) {
+        TestContext->Allocations[TestContext->AllocationCount].Base  = Allocation->Base + EFI_PAGES_TO_SIZE (Offset + Pages);
+        TestContext->Allocations[TestContext->AllocationCount].Pages = Allocation->Pages - Offset - Pages;
+        TestContext->Allocations[TestContext->AllocationCount].Type  = Allocation->Type;
+        TestContext->AllocationCount++;
+      }
+
+      if (Offset > 0) {
+        Allocation->Pages = Offset;
+      } else {
+        *Allocation = TestContext->Allocations[--TestContext->AllocationCount];
+      }
+    }
+
+    UT_ASSERT_EQUAL (TestCheckIndex (), UNIT_TEST_PASSED);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the memory map
+  index and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      PageIndexTests;
+  TEST_CONTEXT                *TestContext;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  TestContext = AllocateZeroPool (sizeof (TEST_CONTEXT));
+  if (TestContext == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the memory map index Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&PageIndexTests, Framework, "Memory Map Index Tests", "DxeCore.PageIndex", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Memory Map Index Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite---------Description--------------------------------------Name-----------Function-------------------Pre------------------Post------------------Context-----
+  //
+  AddTestCase (PageIndexTests, "Free pages match a memory map walk", "FindFreePages", FindFreePagesMatchesWalk, PageIndexTestSetup, PageIndexTestCleanup, TestContext);
+  AddTestCase (PageIndexTests, "Random allocations keep the index", "Random", RandomAllocationsKeepIndex, PageIndexTestSetup, PageIndexTestCleanup, TestContext);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  if (TestContext != NULL) {
+    FreePool (TestContext);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define PageIndexUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+PageIndexUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
@@ -0,0 +1,700 @@
+/** @file
+  Host based unit tests of the DXE core pool slab allocator.
+
+  Pool.c is built with PcdDxePoolSlabAllocator set and the page allocator,
+  locks and heap guard of the DXE core replaced by the stubs below. Pages
+  handed to the pool are counted so that the tests can check when the slab
+  cache gives pages back. Pool entries whose page starts with what looks
+  like a slab header must still be freed to the pool.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../../DxeMain.h"
+#include "../Imem.h"
+#include "../HeapGuard.h"
+
+#include <Library/UnitTestLib.h>
+#include <Library/UnitTestRandomLib.h>
+
+#define UNIT_TEST_APP_NAME     "DXE Core Pool Slab Allocator Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_SLAB_MAX_SIZE     512
+#define TEST_BUFFER_COUNT      256
+#define TEST_RANDOM_MAX_SIZE   2048
+#define TEST_RANDOM_STEPS      20000
+
+typedef struct {
+  UINT8              *Buffer;
+  UINTN              Size;
+  EFI_MEMORY_TYPE    Type;
+  UINT8              Pattern;
+} TEST_BUFFER;
+
+typedef struct {
+  TEST_BUFFER    Buffers[TEST_BUFFER_COUNT];
+  UINT64         Seed;
+} TEST_CONTEXT;
+
+///
+/// A slab header as stale or caller data could forge it at the start of a page
+///
+typedef struct {
+  UINT32             Signature;
+  UINT16             ClassIndex;
+  UINT16             FreeCount;
+  EFI_MEMORY_TYPE    Type;
+  VOID               *Base;
+  VOID               *FreeList;
+} TEST_FORGED_SLAB;
+
+//
+// Stubs of the DXE core services used by Pool.c
+//
+EFI_LOCK  gMemoryLock              = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
+BOOLEAN   mOnGuarding              = FALSE;
+UINT64    gBootTraceAllocatedBytes = 0;
+
+STATIC UINTN    mTestPagesInUse = 0;
+STATIC BOOLEAN  mTestGuardPool  = FALSE;
+
+VOID
+CoreAcquireLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockReleased);
+  Lock->Lock = EfiLockAcquired;
+}
+
+EFI_STATUS
+CoreAcquireLockOrFail (
+  IN EFI_LOCK  *Lock
+  )
+{
+  if (Lock->Lock == EfiLockAcquired) {
+    return EFI_ACCESS_DENIED;
+  }
+
+  Lock->Lock = EfiLockAcquired;
+  return EFI_SUCCESS;
+}
+
+VOID
+CoreReleaseLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockAcquired);
+  Lock->Lock = EfiLockReleased;
+}
+
+VOID
+CoreAcquireMemoryLock (
+  VOID
+  )
+{
+  CoreAcquireLock (&gMemoryLock);
+}
+
+VOID
+CoreReleaseMemoryLock (
+  VOID
+  )
+{
+  CoreReleaseLock (&gMemoryLock);
+}
+
+VOID *
+CoreAllocatePoolPages (
+  IN EFI_MEMORY_TYPE  PoolType,
+  IN UINTN            NumberOfPages,
+  IN UINTN            Alignment,
+  IN BOOLEAN          NeedGuard
+  )
+{
+  VOID  *Buffer;
+
+  Buffer = AllocateAlignedPages (NumberOfPages, Alignment);
+  if (Buffer != NULL) {
+    mTestPagesInUse += NumberOfPages;
+  }
+
+  return Buffer;
+}
+
+VOID
+CoreFreePoolPages (
+  IN EFI_PHYSICAL_ADDRESS  Memory,
+  IN UINTN                 NumberOfPages
+  )
+{
+  ASSERT (mTestPagesInUse >= NumberOfPages);
+  mTestPagesInUse -= NumberOfPages;
+  FreeAlignedPages ((VOID *)(UINTN)Memory, NumberOfPages);
+}
+
+BOOLEAN
+IsHeapGuardEnabled (
+  UINT8  GuardType
+  )
+{
+  return FALSE;
+}
+
+BOOLEAN
+IsPoolTypeToGuard (
+  IN EFI_MEMORY_TYPE  MemoryType
+  )
+{
+  return mTestGuardPool;
+}
+
+BOOLEAN
+EFIAPI
+IsMemoryGuarded (
+  IN EFI_PHYSICAL_ADDRESS  Address
+  )
+{
+  return mTestGuardPool;
+}
+
+VOID
+SetGuardForMemory (
+  IN EFI_PHYSICAL_ADDRESS  Memory,
+  IN UINTN                 NumberOfPages
+  )
+{
+}
+
+VOID
+UnsetGuardForMemory (
+  IN EFI_PHYSICAL_ADDRESS  Memory,
+  IN UINTN                 NumberOfPages
+  )
+{
+}
+
+VOID
+AdjustMemoryF (
+  IN OUT EFI_PHYSICAL_ADDRESS  *Memory,
+  IN OUT UINTN                 *NumberOfPages
+  )
+{
+}
+
+//
+// Guarded pool entries are put against the end of their pages, as the heap
+// guard puts them against the tail guard page
+//
+VOID *
+AdjustPoolHeadA (
+  IN EFI_PHYSICAL_ADDRESS  Memory,
+  IN UINTN                 NoPages,
+  IN UINTN                 Size
+  )
+{
+  return (VOID *)(UINTN)(Memory + EFI_PAGES_TO_SIZE (NoPages) - ALIGN_VALUE (Size, 8));
+}
+
+VOID *
+AdjustPoolHeadF (
+  IN EFI_PHYSICAL_ADDRESS  Memory,
+  IN UINTN                 NoPages,
+  IN UINTN                 Size
+  )
+{
+  return (VOID *)(UINTN)(Memory + ALIGN_VALUE (Size, 8) - EFI_PAGES_TO_SIZE (NoPages));
+}
+
+VOID
+EFIAPI
+GuardFreedPagesChecked (
+  IN  EFI_PHYSICAL_ADDRESS  BaseAddress,
+  IN  UINTN                 Pages
+  )
+{
+}
+
+EFI_STATUS
+EFIAPI
+CoreUpdateProfile (
+  IN EFI_PHYSICAL_ADDRESS   CallerAddress,
+  IN MEMORY_PROFILE_ACTION  Action,
+  IN EFI_MEMORY_TYPE        MemoryType,
+  IN UINTN                  Size,
+  IN VOID                   *Buffer,
+  IN CHAR8                  *ActionString OPTIONAL
+  )
+{
+  return EFI_SUCCESS;
+}
+
+VOID
+InstallMemoryAttributesTableOnMemoryAllocation (
+  IN EFI_MEMORY_TYPE  MemoryType
+  )
+{
+}
+
+EFI_STATUS
+EFIAPI
+ApplyMemoryProtectionPolicy (
+  IN  EFI_MEMORY_TYPE       OldType,
+  IN  EFI_MEMORY_TYPE       NewType,
+  IN  EFI_PHYSICAL_ADDRESS  Memory,
+  IN  UINT64                Length
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Allocate a buffer from the pool and fill it with a pattern.
+
+  @param[in, out] Buffer   The test buffer to allocate.
+  @param[in]      Type     The memory type of the pool.
+  @param[in]      Size     The size of the allocation.
+  @param[in]      Pattern  The byte to fill the buffer with.
+
+  @retval  UNIT_TEST_PASSED             The buffer was allocated.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The pool failed the allocation.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestAllocate (
+  IN OUT TEST_BUFFER      *Buffer,
+  IN     EFI_MEMORY_TYPE  Type,
+  IN     UINTN            Size,
+  IN     UINT8            Pattern
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = CoreInternalAllocatePool (Type, Size, (VOID **)&Buffer->Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_NOT_NULL (Buffer->Buffer);
+  UT_ASSERT_EQUAL ((UINTN)Buffer->Buffer & (sizeof (UINT64) - 1), 0);
+
+  Buffer->Size    = Size;
+  Buffer->Type    = Type;
+  Buffer->Pattern = Pattern;
+  SetMem (Buffer->Buffer, Size, Pattern);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check the pattern of a buffer and free it.
+
+  @param[in, out] Buffer  The test buffer to free.
+
+  @retval  UNIT_TEST_PASSED             The buffer was intact and freed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  Another allocation overlapped the
+                                        buffer or the pool failed the free.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestFree (
+  IN OUT TEST_BUFFER  *Buffer
+  )
+{
+  EFI_STATUS       Status;
+  EFI_MEMORY_TYPE  Type;
+  UINTN            Index;
+
+  for (Index = 0; Index < Buffer->Size; Index++) {
+    UT_ASSERT_EQUAL (Buffer->Buffer[Index], Buffer->Pattern);
+  }
+
+  Status = CoreInternalFreePool (Buffer->Buffer, &Type);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (Type, Buffer->Type);
+
+  Buffer->Buffer = NULL;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Reset the pool and the test context before each test.
+
+  @param[in]  Context  The test context.
+
+  @retval  UNIT_TEST_PASSED  The test context is ready.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+PoolSlabTestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  ZeroMem (TestContext, sizeof (TEST_CONTEXT));
+  TestContext->Seed = 0x5eed;
+
+  //
+  // Pages still held by a previous test are leaked on purpose, the counter
+  // restarts so that each test only sees its own pages.
+  //
+  CoreInitializePool ();
+  mTestPagesInUse = 0;
+  mTestGuardPool  = FALSE;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Allocate many buffers of every slab size class and check that none of them
+  overlap and that every free reports the memory type of the allocation.
+
+  @param[in]  Context  The test context.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+SlabBuffersDoNotOverlap (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT      *TestContext;
+  UNIT_TEST_STATUS  Status;
+  UINTN             Index;
+  UINTN             Size;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  for (Size = 1; Size <= TEST_SLAB_MAX_SIZE; Size = Size * 2 + 7) {
+    for (Index = 0; Index < TEST_BUFFER_COUNT; Index++) {
+      Status = TestAllocate (
+                 &TestContext->Buffers[Index],
+                 (Index % 2 == 0) ? EfiBootServicesData : EfiRuntimeServicesData,
+                 Size,
+                 (UINT8)(Index + 1)
+                 );
+      if (Status != UNIT_TEST_PASSED) {
+        return Status;
+      }
+    }
+
+    for (Index = 0; Index < TEST_BUFFER_COUNT; Index++) {
+      Status = TestFree (&TestContext->Buffers[Index]);
+      if (Status != UNIT_TEST_PASSED) {
+        return Status;
+      }
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that a freed buffer is the next one handed out for its size class and
+  memory type, and that other memory types do not get it.
+
+  @param[in]  Context  The test context.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+FreedBufferIsReusedFirst (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VOID        *First;
+  VOID        *Second;
+  EFI_STATUS  Status;
+
+  Status = CoreInternalAllocatePool (EfiBootServicesData, 40, &First);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  Status = CoreInternalFreePool (First, NULL);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  //
+  // Same size class, other memory type
+  //
+  Status = CoreInternalAllocatePool (EfiRuntimeServicesData, 40, &Second);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_NOT_EQUAL ((UINTN)Second, (UINTN)First);
+  Status = CoreInternalFreePool (Second, NULL);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  //
+  // Same memory type, size rounded up to the same class
+  //
+  Status = CoreInternalAllocatePool (EfiBootServicesData, 33, &Second);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL ((UINTN)Second, (UINTN)First);
+  Status = CoreInternalFreePool (Second, NULL);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Fill several slab pages with buffers of one size class, free them all and
+  check that every page but one goes back to the page allocator.
+
+  @param[in]  Context  The test context.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+EmptySlabPagesAreReleased (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT      *TestContext;
+  UNIT_TEST_STATUS  Status;
+  UINTN             Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  for (Index = 0; Index < TEST_BUFFER_COUNT; Index++) {
+    Status = TestAllocate (&TestContext->Buffers[Index], EfiBootServicesData, 64, (UINT8)Index);
+    if (Status != UNIT_TEST_PASSED) {
+      return Status;
+    }
+  }
+
+  //
+  // Slab objects carry no pool header, so the buffers fit in the pages
+  //
+  UT_ASSERT_TRUE (mTestPagesInUse > TEST_BUFFER_COUNT * 64 / EFI_PAGE_SIZE);
+  UT_ASSERT_TRUE (mTestPagesInUse <= TEST_BUFFER_COUNT * 64 / EFI_PAGE_SIZE + 1);
+
+  for (Index = 0; Index < TEST_BUFFER_COUNT; Index++) {
+    Status = TestFree (&TestContext->Buffers[Index]);
+    if (Status != UNIT_TEST_PASSED) {
+      return Status;
+    }
+  }
+
+  //
+  // The slab holding the magazine objects is kept for the next allocation
+  //
+  UT_ASSERT_EQUAL (mTestPagesInUse, 1);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Allocate guarded pool entries, whose pool header is not at the start of
+  their page, forge slab headers in the stale memory at the start of the
+  pages, and check that the entries are still freed to the pool.
+
+  @param[in]  Context  The test context.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ForgedSlabHeadersAreIgnored (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT      *TestContext;
+  UNIT_TEST_STATUS  Status;
+  TEST_BUFFER       *Buffer;
+  TEST_FORGED_SLAB  *Forged;
+  UINTN             Index;
+
+  TestContext    = (TEST_CONTEXT *)Context;
+  mTestGuardPool = TRUE;
+
+  for (Index = 0; Index < TEST_BUFFER_COUNT / 4; Index++) {
+    Buffer = &TestContext->Buffers[Index];
+    Status = TestAllocate (Buffer, EfiBootServicesData, 1 + Index % TEST_SLAB_MAX_SIZE, (UINT8)Index);
+    if (Status != UNIT_TEST_PASSED) {
+      return Status;
+    }
+
+    Forged = (TEST_FORGED_SLAB *)((UINTN)Buffer->Buffer & ~(UINTN)EFI_PAGE_MASK);
+    UT_ASSERT_TRUE ((UINTN)Buffer->Buffer - (UINTN)Forged >= 2 * sizeof (TEST_FORGED_SLAB));
+
+    Forged->Signature  = SIGNATURE_32 ('p', 's', 'l', 'b');
+    Forged->ClassIndex = 0;
+    Forged->FreeCount  = 0;
+    Forged->Type       = EfiRuntimeServicesData;
+    Forged->Base       = Forged;
+    Forged->FreeList   = NULL;
+  }
+
+  for (Index = 0; Index < TEST_BUFFER_COUNT / 4; Index++) {
+    Status = TestFree (&TestContext->Buffers[Index]);
+    if (Status != UNIT_TEST_PASSED) {
+      return Status;
+    }
+  }
+
+  mTestGuardPool = FALSE;
+  UT_ASSERT_EQUAL (mTestPagesInUse, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Allocate and free buffers of random sizes, mixing slab objects and regular
+  pool entries, and check that no buffer is overwritten by another one.
+
+  @param[in]  Context  The test context.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+RandomSlabAndPoolBuffers (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT      *TestContext;
+  UNIT_TEST_STATUS  Status;
+  UINTN             Step;
+  UINTN             Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  for (Step = 0; Step < TEST_RANDOM_STEPS; Step++) {
+    Index = UnitTestRandom (&TestContext->Seed) % TEST_BUFFER_COUNT;
+    if (TestContext->Buffers[Index].Buffer != NULL) {
+      Status = TestFree (&TestContext->Buffers[Index]);
+    } else {
+      Status = TestAllocate (
+                 &TestContext->Buffers[Index],
+                 (UnitTestRandom (&TestContext->Seed) % 4 == 0) ? EfiRuntimeServicesData : EfiBootServicesData,
+                 UnitTestRandom (&TestContext->Seed) % TEST_RANDOM_MAX_SIZE + 1,
+                 (UINT8)Step
+                 );
+    }
+
+    if (Status != UNIT_TEST_PASSED) {
+      return Status;
+    }
+  }
+
+  for (Index = 0; Index < TEST_BUFFER_COUNT; Index++) {
+    if (TestContext->Buffers[Index].Buffer != NULL) {
+      Status = TestFree (&TestContext->Buffers[Index]);
+      if (Status != UNIT_TEST_PASSED) {
+        return Status;
+      }
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the pool slab
+  allocator and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      PoolSlabTests;
+  TEST_CONTEXT                *TestContext;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  TestContext = AllocateZeroPool (sizeof (TEST_CONTEXT));
+  if (TestContext == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the pool slab allocator Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&PoolSlabTests, Framework, "Pool Slab Allocator Tests", "DxeCore.PoolSlab", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Pool Slab Allocator Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite---------Description----------------------------------------Name-----------Function-------------------Pre------------------Post---Context-----
+  //
+  AddTestCase (PoolSlabTests, "Slab buffers do not overlap", "NoOverlap", SlabBuffersDoNotOverlap, PoolSlabTestSetup, NULL, TestContext);
+  AddTestCase (PoolSlabTests, "Freed buffer is reused first", "Reuse", FreedBufferIsReusedFirst, PoolSlabTestSetup, NULL, TestContext);
+  AddTestCase (PoolSlabTests, "Empty slab pages are released", "Release", EmptySlabPagesAreReleased, PoolSlabTestSetup, NULL, TestContext);
+  AddTestCase (PoolSlabTests, "Forged slab headers are ignored", "Forged", ForgedSlabHeadersAreIgnored, PoolSlabTestSetup, NULL, TestContext);
+  AddTestCase (PoolSlabTests, "Random slab and pool buffers", "Random", RandomSlabAndPoolBuffers, PoolSlabTestSetup, NULL, TestContext);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  if (TestContext != NULL) {
+    FreePool (TestContext);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define PoolSlabUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+PoolSlabUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
@@ -0,0 +1,179 @@
+/** @file
+  Boot trace of the image entry points and driver binding Start() functions
+  called by the DXE core.
+
+  The trace is a ring buffer of PcdBootTraceEntryCount entries that is
+  installed as the gEdkiiBootTraceTableGuid configuration table. Time stamps
+  use the same time base as the performance records of the DXE core.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+
+//
+// Counters sampled at the beginning and at the end of each trace entry
+//
+UINT64  gBootTraceProtocolInstallCount;
+UINT64  gBootTraceAllocatedBytes;
+
+EDKII_BOOT_TRACE_TABLE  *mBootTraceTable = NULL;
+EDKII_BOOT_TRACE_ENTRY  *mBootTraceEntries;
+
+//
+// The innermost entry being recorded, or NULL
+//
+BOOT_TRACE_SCOPE  *mBootTraceCurrentScope = NULL;
+
+/**
+  Allocate the boot trace buffer and install it into the EFI System Table.
+  The boot trace stays disabled if PcdBootTraceEntryCount is 0.
+
+**/
+VOID
+CoreInitializeBootTrace (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      EntryCount;
+
+  EntryCount = PcdGet32 (PcdBootTraceEntryCount);
+  if (EntryCount == 0) {
+    return;
+  }
+
+  mBootTraceTable = AllocateZeroPool (sizeof (EDKII_BOOT_TRACE_TABLE) + (UINTN)EntryCount * sizeof (EDKII_BOOT_TRACE_ENTRY));
+  if (mBootTraceTable == NULL) {
+    DEBUG ((DEBUG_ERROR, "Boot trace: failed to allocate %d entries\n", EntryCount));
+    return;
+  }
+
+  mBootTraceTable->Signature  = EDKII_BOOT_TRACE_TABLE_SIGNATURE;
+  mBootTraceTable->Version    = EDKII_BOOT_TRACE_TABLE_VERSION;
+  mBootTraceTable->HeaderSize = sizeof (EDKII_BOOT_TRACE_TABLE);
+  mBootTraceTable->EntrySize  = sizeof (EDKII_BOOT_TRACE_ENTRY);
+  mBootTraceTable->EntryCount = EntryCount;
+  mBootTraceEntries           = (EDKII_BOOT_TRACE_ENTRY *)(mBootTraceTable + 1);
+
+  Status = CoreInstallConfigurationTable (&gEdkiiBootTraceTableGuid, mBootTraceTable);
+  if (EFI_ERROR (Status)) {
+    CoreFreePool (mBootTraceTable);
+    mBootTraceTable = NULL;
+  }
+}
+
+/**
+  Begin a boot trace entry for the code of an image.
+
+  @param  Scope             Receives the state of the entry, to be passed to
+                            CoreBootTraceEnd().
+  @param  ImageHandle       The handle of the image whose code is called.
+
+**/
+VOID
+CoreBootTraceBegin (
+  OUT BOOT_TRACE_SCOPE  *Scope,
+  IN  EFI_HANDLE        ImageHandle
+  )
+{
+  EFI_STATUS                 Status;
+  EFI_LOADED_IMAGE_PROTOCOL  *LoadedImage;
+  EFI_GUID                   *FileName;
+
+  if (mBootTraceTable == NULL) {
+    return;
+  }
+
+  //
+  // The image may be unloaded by the time the entry ends, so its name is
+  // captured now
+  //
+  FileName = NULL;
+  Status   = CoreHandleProtocol (ImageHandle, &gEfiLoadedImageProtocolGuid, (VOID **)&LoadedImage);
+  if (!EFI_ERROR (Status)) {
+    FileName = GetFileNameFromFilePath (LoadedImage->FilePath);
+  }
+
+  if (FileName != NULL) {
+    CopyGuid (&Scope->ModuleName, FileName);
+  } else {
+    ZeroMem (&Scope->ModuleName, sizeof (Scope->ModuleName));
+  }
+
+  Scope->ChildDuration             = 0;
+  Scope->ChildProtocolInstallCount = 0;
+  Scope->ChildAllocatedBytes       = 0;
+  Scope->Parent                    = mBootTraceCurrentScope;
+  if (Scope->Parent != NULL) {
+    Scope->Depth = (UINT16)MIN (Scope->Parent->Depth + 1, MAX_UINT16);
+  } else {
+    Scope->Depth = 0;
+  }
+
+  mBootTraceCurrentScope = Scope;
+
+  Scope->ProtocolInstallCount = gBootTraceProtocolInstallCount;
+  Scope->AllocatedBytes       = gBootTraceAllocatedBytes;
+  Scope->StartTime            = GetTimeInNanoSecond (GetPerformanceCounter ());
+}
+
+/**
+  End a boot trace entry and record it in the ring buffer.
+
+  The totals of the entry are added to the child totals of the entry it is
+  nested in, which becomes the current entry again. The parent is taken from
+  the scope rather than by unwinding, so that an image that calls Exit() from
+  a nested entry does not leave a stale scope behind.
+
+  @param  Scope             The state returned by CoreBootTraceBegin().
+  @param  Type              EDKII_BOOT_TRACE_TYPE_START_IMAGE or
+                            EDKII_BOOT_TRACE_TYPE_DRIVER_BINDING_START.
+  @param  ControllerHandle  The controller handle passed to Start(), or NULL.
+  @param  Status            The status returned by the traced code.
+
+**/
+VOID
+CoreBootTraceEnd (
+  IN BOOT_TRACE_SCOPE  *Scope,
+  IN UINT16            Type,
+  IN EFI_HANDLE        ControllerHandle,
+  IN EFI_STATUS        Status
+  )
+{
+  UINT64                  Duration;
+  UINT64                  ProtocolInstallCount;
+  UINT64                  AllocatedBytes;
+  EDKII_BOOT_TRACE_ENTRY  *Entry;
+
+  if (mBootTraceTable == NULL) {
+    return;
+  }
+
+  Duration             = GetTimeInNanoSecond (GetPerformanceCounter ()) - Scope->StartTime;
+  ProtocolInstallCount = gBootTraceProtocolInstallCount - Scope->ProtocolInstallCount;
+  AllocatedBytes       = gBootTraceAllocatedBytes - Scope->AllocatedBytes;
+
+  mBootTraceCurrentScope = Scope->Parent;
+  if (Scope->Parent != NULL) {
+    Scope->Parent->ChildDuration             += Duration;
+    Scope->Parent->ChildProtocolInstallCount += ProtocolInstallCount;
+    Scope->Parent->ChildAllocatedBytes       += AllocatedBytes;
+  }
+
+  Entry = &mBootTraceEntries[ModU64x32 (mBootTraceTable->RecordCount, mBootTraceTable->EntryCount)];
+  mBootTraceTable->RecordCount++;
+
+  Entry->Type                 = Type;
+  Entry->Depth                = Scope->Depth;
+  Entry->ProtocolInstallCount = (UINT32)(ProtocolInstallCount - Scope->ChildProtocolInstallCount);
+  CopyGuid (&Entry->ModuleName, &Scope->ModuleName);
+  Entry->Status           = (UINT64)Status;
+  Entry->ControllerHandle = (UINT64)(UINTN)ControllerHandle;
+  Entry->StartTime        = Scope->StartTime;
+  Entry->Duration         = Duration;
+  Entry->ChildDuration    = Scope->ChildDuration;
+  Entry->AllocatedBytes   = AllocatedBytes - Scope->ChildAllocatedBytes;
+}
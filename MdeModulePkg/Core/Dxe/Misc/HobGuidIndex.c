@@ -0,0 +1,115 @@
+/** @file
+  Index of the GUID extension HOBs of the HOB list.
+
+  The index is installed as the gEdkiiHobGuidIndexTableGuid configuration
+  table, so that GetFirstGuidHob() and GetNextGuidHob() of the DXE HOB library
+  look up GUID HOBs with a binary search instead of walking the HOB list.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+
+/**
+  Compare two entries of the GUID HOB index by GUID, then by HOB address.
+
+  @param  Buffer1           The first EDKII_HOB_GUID_INDEX_ENTRY.
+  @param  Buffer2           The second EDKII_HOB_GUID_INDEX_ENTRY.
+
+  @retval 0                 The entries are equal.
+  @retval >0                Buffer1 is sorted after Buffer2.
+  @retval <0                Buffer1 is sorted before Buffer2.
+
+**/
+STATIC
+INTN
+EFIAPI
+CompareHobGuidIndexEntry (
+  IN CONST VOID  *Buffer1,
+  IN CONST VOID  *Buffer2
+  )
+{
+  CONST EDKII_HOB_GUID_INDEX_ENTRY  *Entry1;
+  CONST EDKII_HOB_GUID_INDEX_ENTRY  *Entry2;
+  INTN                              Result;
+
+  Entry1 = Buffer1;
+  Entry2 = Buffer2;
+  Result = CompareMem (&Entry1->Name, &Entry2->Name, sizeof (EFI_GUID));
+  if (Result != 0) {
+    return Result;
+  }
+
+  if (Entry1->Hob == Entry2->Hob) {
+    return 0;
+  }
+
+  return (Entry1->Hob > Entry2->Hob) ? 1 : -1;
+}
+
+/**
+  Build the index of the GUID extension HOBs of the HOB list and install it
+  into the EFI System Table. The HOB list is not indexed if
+  PcdDxeHobGuidIndex is FALSE.
+
+  @param  HobStart          The HOB list that is installed as the
+                            gEfiHobListGuid configuration table.
+
+**/
+VOID
+CoreInstallHobGuidIndex (
+  IN VOID  *HobStart
+  )
+{
+  EFI_STATUS                  Status;
+  EFI_PEI_HOB_POINTERS        Hob;
+  UINTN                       Count;
+  EDKII_HOB_GUID_INDEX_TABLE  *Table;
+  EDKII_HOB_GUID_INDEX_ENTRY  *Entries;
+  EDKII_HOB_GUID_INDEX_ENTRY  Buffer;
+
+  if (!FeaturePcdGet (PcdDxeHobGuidIndex)) {
+    return;
+  }
+
+  Count = 0;
+  for (Hob.Raw = HobStart; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) {
+      Count++;
+    }
+  }
+
+  Table = AllocatePool (sizeof (EDKII_HOB_GUID_INDEX_TABLE) + Count * sizeof (EDKII_HOB_GUID_INDEX_ENTRY));
+  if (Table == NULL) {
+    DEBUG ((DEBUG_ERROR, "HOB GUID index: failed to allocate %d entries\n", (UINT32)Count));
+    return;
+  }
+
+  Table->Signature    = EDKII_HOB_GUID_INDEX_TABLE_SIGNATURE;
+  Table->Version      = EDKII_HOB_GUID_INDEX_TABLE_VERSION;
+  Table->HeaderSize   = sizeof (EDKII_HOB_GUID_INDEX_TABLE);
+  Table->EntrySize    = sizeof (EDKII_HOB_GUID_INDEX_ENTRY);
+  Table->HobList      = (UINTN)HobStart;
+  Table->EndOfHobList = (UINTN)Hob.Raw;
+  Table->EntryCount   = (UINT32)Count;
+  Table->Reserved     = 0;
+  Entries             = (EDKII_HOB_GUID_INDEX_ENTRY *)(Table + 1);
+
+  Count = 0;
+  for (Hob.Raw = HobStart; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) {
+      CopyGuid (&Entries[Count].Name, &Hob.Guid->Name);
+      Entries[Count].Hob = (UINTN)Hob.Raw;
+      Count++;
+    }
+  }
+
+  QuickSort (Entries, Count, sizeof (EDKII_HOB_GUID_INDEX_ENTRY), CompareHobGuidIndexEntry, &Buffer);
+
+  Status = CoreInstallConfigurationTable (&gEdkiiHobGuidIndexTableGuid, Table);
+  if (EFI_ERROR (Status)) {
+    CoreFreePool (Table);
+  }
+}
@@ -0,0 +1,561 @@
+/** @file
+  Host based unit tests of the GUID HOB index.
+
+  HobGuidIndex.c of the DXE core and HobLib.c of DxeHobLib are built into the
+  test, with the configuration table services replaced by the stubs below, so
+  that the index the DXE core builds is the one DxeHobLib looks up.
+
+  GUID HOBs are looked up from every HOB of a random HOB list, and the
+  results are checked against a walk of the HOB list, also after HOBs are
+  marked as unused.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../../DxeMain.h"
+
+#include <Library/UefiLib.h>
+#include <Library/UnitTestLib.h>
+#include <Library/UnitTestRandomLib.h>
+
+#define UNIT_TEST_APP_NAME     "DXE Core GUID HOB Index Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_HOB_LIST_SIZE  SIZE_64KB
+#define TEST_GUID_COUNT     8
+#define TEST_HOB_COUNT      600
+
+typedef struct {
+  UINT8     *HobList;
+  UINT8     *HobListCopy;
+  UINTN     HobListSize;
+  EFI_GUID  Guids[TEST_GUID_COUNT + 1];
+  UINT64    Seed;
+} TEST_CONTEXT;
+
+//
+// Cached pointers of HobLib.c
+//
+extern VOID                        *mHobList;
+extern EDKII_HOB_GUID_INDEX_TABLE  *mHobGuidIndex;
+extern BOOLEAN                     mHobGuidIndexChecked;
+
+//
+// The configuration table installed by CoreInstallHobGuidIndex ()
+//
+STATIC VOID  *mTestHobGuidIndexTable = NULL;
+
+/**
+  Stub of the DXE core service that installs a configuration table.
+
+  @param  Guid           The GUID of the configuration table.
+  @param  Table          The configuration table.
+
+  @retval EFI_SUCCESS    The table is recorded.
+
+**/
+EFI_STATUS
+EFIAPI
+CoreInstallConfigurationTable (
+  IN EFI_GUID  *Guid,
+  IN VOID      *Table
+  )
+{
+  if (CompareGuid (Guid, &gEdkiiHobGuidIndexTableGuid)) {
+    mTestHobGuidIndexTable = Table;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Stub of the DXE core service that frees pool.
+
+  @param  Buffer         The buffer to free.
+
+  @retval EFI_SUCCESS    The buffer is freed.
+
+**/
+EFI_STATUS
+EFIAPI
+CoreFreePool (
+  IN VOID  *Buffer
+  )
+{
+  FreePool (Buffer);
+  return EFI_SUCCESS;
+}
+
+/**
+  Stub of the UefiLib service that looks up a configuration table.
+
+  @param  TableGuid      The GUID of the configuration table.
+  @param  Table          Returns the configuration table.
+
+  @retval EFI_SUCCESS    The table is found.
+  @retval EFI_NOT_FOUND  The table is not installed.
+
+**/
+EFI_STATUS
+EFIAPI
+EfiGetSystemConfigurationTable (
+  IN  EFI_GUID  *TableGuid,
+  OUT VOID      **Table
+  )
+{
+  *Table = NULL;
+  if (CompareGuid (TableGuid, &gEdkiiHobGuidIndexTableGuid) && (mTestHobGuidIndexTable != NULL)) {
+    *Table = mTestHobGuidIndexTable;
+    return EFI_SUCCESS;
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Look up a GUID HOB from a HOB by walking the HOB list.
+
+  @param[in]  Guid      The GUID to look up.
+  @param[in]  HobStart  The HOB to start from.
+
+  @return The first HOB of the GUID at or after HobStart, or NULL.
+**/
+STATIC
+VOID *
+TestGetNextGuidHobByWalk (
+  IN CONST EFI_GUID  *Guid,
+  IN CONST VOID      *HobStart
+  )
+{
+  EFI_PEI_HOB_POINTERS  Hob;
+
+  for (Hob.Raw = (UINT8 *)HobStart; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if ((Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) && CompareGuid (Guid, &Hob.Guid->Name)) {
+      return Hob.Raw;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Check the lookups of every GUID from every HOB of a HOB list against a
+  walk of the HOB list.
+
+  @param[in]  TestContext  The test context.
+  @param[in]  HobList      The HOB list to look up the GUIDs in.
+
+  @retval UNIT_TEST_PASSED             The lookups match the walk.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A lookup does not match the walk.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestCheckLookups (
+  IN TEST_CONTEXT  *TestContext,
+  IN VOID          *HobList
+  )
+{
+  EFI_PEI_HOB_POINTERS  Hob;
+  UINTN                 Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (TestContext->Guids); Index++) {
+    UT_ASSERT_EQUAL (
+      (UINTN)GetFirstGuidHob (&TestContext->Guids[Index]),
+      (UINTN)TestGetNextGuidHobByWalk (&TestContext->Guids[Index], mHobList)
+      );
+
+    for (Hob.Raw = HobList; ; Hob.Raw = GET_NEXT_HOB (Hob)) {
+      UT_ASSERT_EQUAL (
+        (UINTN)GetNextGuidHob (&TestContext->Guids[Index], Hob.Raw),
+        (UINTN)TestGetNextGuidHobByWalk (&TestContext->Guids[Index], Hob.Raw)
+        );
+      if (END_OF_HOB_LIST (Hob)) {
+        break;
+      }
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Build a random HOB list of GUID HOBs of a few GUIDs, mixed with resource
+  descriptor HOBs, and index it.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED                      The HOB list is indexed.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The HOB list could not be
+                                                allocated or indexed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+HobGuidIndexTestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT          *TestContext;
+  EFI_PEI_HOB_POINTERS  Hob;
+  UINTN                 Index;
+  UINT16                Length;
+
+  TestContext       = (TEST_CONTEXT *)Context;
+  TestContext->Seed = 0x5EED;
+  for (Index = 0; Index < ARRAY_SIZE (TestContext->Guids); Index++) {
+    //
+    // GUIDs that only differ in their last bytes, so that the comparison of
+    // the whole GUID is needed. The last GUID is not in the HOB list.
+    //
+    SetMem (&TestContext->Guids[Index], sizeof (EFI_GUID), 0x5A);
+    TestContext->Guids[Index].Data4[7] = (UINT8)(TEST_GUID_COUNT - Index);
+  }
+
+  TestContext->HobList = AllocateZeroPool (TEST_HOB_LIST_SIZE);
+  if (TestContext->HobList == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  Hob.Raw                               = TestContext->HobList;
+  Hob.Header->HobType                   = EFI_HOB_TYPE_HANDOFF;
+  Hob.Header->HobLength                 = sizeof (EFI_HOB_HANDOFF_INFO_TABLE);
+  Hob.HandoffInformationTable->Version  = EFI_HOB_HANDOFF_TABLE_VERSION;
+  Hob.HandoffInformationTable->BootMode = BOOT_WITH_FULL_CONFIGURATION;
+  Hob.Raw                               = GET_NEXT_HOB (Hob);
+
+  for (Index = 0; Index < TEST_HOB_COUNT; Index++) {
+    if (UnitTestRandom (&TestContext->Seed) % 4 == 0) {
+      Hob.Header->HobType   = EFI_HOB_TYPE_RESOURCE_DESCRIPTOR;
+      Hob.Header->HobLength = sizeof (EFI_HOB_RESOURCE_DESCRIPTOR);
+      //
+      // The owner of a resource descriptor is not a GUID HOB name.
+      //
+      CopyGuid (&Hob.ResourceDescriptor->Owner, &TestContext->Guids[0]);
+    } else {
+      Length                = (UINT16)(sizeof (EFI_HOB_GUID_TYPE) + 8 * (UnitTestRandom (&TestContext->Seed) % 8));
+      Hob.Header->HobType   = EFI_HOB_TYPE_GUID_EXTENSION;
+      Hob.Header->HobLength = Length;
+      CopyGuid (&Hob.Guid->Name, &TestContext->Guids[UnitTestRandom (&TestContext->Seed) % TEST_GUID_COUNT]);
+    }
+
+    Hob.Raw = GET_NEXT_HOB (Hob);
+  }
+
+  Hob.Header->HobType   = EFI_HOB_TYPE_END_OF_HOB_LIST;
+  Hob.Header->HobLength = sizeof (EFI_HOB_GENERIC_HEADER);
+  Hob.Raw               = GET_NEXT_HOB (Hob);
+
+  TestContext->HobListSize = (UINTN)(Hob.Raw - TestContext->HobList);
+  ((EFI_HOB_HANDOFF_INFO_TABLE *)TestContext->HobList)->EfiEndOfHobList = (UINTN)Hob.Raw - sizeof (EFI_HOB_GENERIC_HEADER);
+
+  TestContext->HobListCopy = AllocateCopyPool (TestContext->HobListSize, TestContext->HobList);
+  if (TestContext->HobListCopy == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  mTestHobGuidIndexTable = NULL;
+  CoreInstallHobGuidIndex (TestContext->HobList);
+  if (mTestHobGuidIndexTable == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  mHobList             = TestContext->HobList;
+  mHobGuidIndex        = NULL;
+  mHobGuidIndexChecked = FALSE;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the HOB lists and the index.
+
+  @param[in]  Context    The test context.
+**/
+STATIC
+VOID
+EFIAPI
+HobGuidIndexTestCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  if (TestContext->HobList != NULL) {
+    FreePool (TestContext->HobList);
+    TestContext->HobList = NULL;
+  }
+
+  if (TestContext->HobListCopy != NULL) {
+    FreePool (TestContext->HobListCopy);
+    TestContext->HobListCopy = NULL;
+  }
+
+  if (mTestHobGuidIndexTable != NULL) {
+    FreePool (mTestHobGuidIndexTable);
+    mTestHobGuidIndexTable = NULL;
+  }
+
+  mHobList             = NULL;
+  mHobGuidIndex        = NULL;
+  mHobGuidIndexChecked = FALSE;
+}
+
+/**
+  Check that the index holds every GUID HOB, and that the lookups from every
+  HOB match a walk of the HOB list.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LookupsMatchWalk (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                *TestContext;
+  EDKII_HOB_GUID_INDEX_TABLE  *Table;
+  EDKII_HOB_GUID_INDEX_ENTRY  *Entries;
+  EFI_PEI_HOB_POINTERS        Hob;
+  UINTN                       Count;
+  UINTN                       Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Table       = mTestHobGuidIndexTable;
+  Entries     = (EDKII_HOB_GUID_INDEX_ENTRY *)(Table + 1);
+
+  Count = 0;
+  for (Hob.Raw = TestContext->HobList; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) {
+      Count++;
+    }
+  }
+
+  UT_ASSERT_EQUAL (Table->HobList, (UINTN)TestContext->HobList);
+  UT_ASSERT_EQUAL (Table->EndOfHobList, (UINTN)Hob.Raw);
+  UT_ASSERT_EQUAL (Table->EntryCount, Count);
+  for (Index = 1; Index < Count; Index++) {
+    UT_ASSERT_TRUE (
+      (CompareMem (&Entries[Index - 1].Name, &Entries[Index].Name, sizeof (EFI_GUID)) < 0) ||
+      (CompareGuid (&Entries[Index - 1].Name, &Entries[Index].Name) && (Entries[Index - 1].Hob < Entries[Index].Hob))
+      );
+  }
+
+  UT_ASSERT_EQUAL (TestCheckLookups (TestContext, TestContext->HobList), UNIT_TEST_PASSED);
+  UT_ASSERT_EQUAL ((UINTN)mHobGuidIndex, (UINTN)Table);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that the HOBs marked as unused after the index was built are not
+  returned, and that the HOBs of the same GUID that follow them are.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+UnusedHobsAreSkipped (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT          *TestContext;
+  EFI_PEI_HOB_POINTERS  Hob;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  for (Hob.Raw = TestContext->HobList; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if ((Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) && (UnitTestRandom (&TestContext->Seed) % 2 == 0)) {
+      Hob.Header->HobType = EFI_HOB_TYPE_UNUSED;
+    }
+  }
+
+  UT_ASSERT_EQUAL (TestCheckLookups (TestContext, TestContext->HobList), UNIT_TEST_PASSED);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that the lookups from a HOB outside of the indexed HOB list walk the
+  HOB list they start from.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+OtherHobListIsWalked (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT          *TestContext;
+  EFI_PEI_HOB_POINTERS  Hob;
+  UINTN                 Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  UT_ASSERT_EQUAL (TestCheckLookups (TestContext, TestContext->HobListCopy), UNIT_TEST_PASSED);
+
+  for (Index = 0; Index < TEST_GUID_COUNT; Index++) {
+    Hob.Raw = GetNextGuidHob (&TestContext->Guids[Index], TestContext->HobListCopy);
+    if (Hob.Raw != NULL) {
+      UT_ASSERT_TRUE (Hob.Raw >= TestContext->HobListCopy);
+      UT_ASSERT_TRUE (Hob.Raw < TestContext->HobListCopy + TestContext->HobListSize);
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that an index of another HOB list is not used.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+IndexOfOtherHobListIsIgnored (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT          *TestContext;
+  EFI_PEI_HOB_POINTERS  Hob;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  //
+  // The index describes HobList, while DxeHobLib looks up HobListCopy.
+  // Entries of HobListCopy marked as unused must not be found through the
+  // entries of HobList.
+  //
+  mHobList = TestContext->HobListCopy;
+  for (Hob.Raw = TestContext->HobListCopy; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if ((Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) && (UnitTestRandom (&TestContext->Seed) % 2 == 0)) {
+      Hob.Header->HobType = EFI_HOB_TYPE_UNUSED;
+    }
+  }
+
+  UT_ASSERT_EQUAL (TestCheckLookups (TestContext, TestContext->HobListCopy), UNIT_TEST_PASSED);
+  UT_ASSERT_TRUE (mHobGuidIndexChecked);
+  UT_ASSERT_EQUAL ((UINTN)mHobGuidIndex, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the GUID HOB
+  index and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      HobGuidIndexTests;
+  TEST_CONTEXT                *TestContext;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  TestContext = AllocateZeroPool (sizeof (TEST_CONTEXT));
+  if (TestContext == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the GUID HOB index Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&HobGuidIndexTests, Framework, "GUID HOB Index Tests", "DxeCore.HobGuidIndex", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for GUID HOB Index Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite------------Description----------------------------------------Name---------------Function----------------------Pre--------------------Post---------------------Context-----
+  //
+  AddTestCase (HobGuidIndexTests, "GUID HOB lookups match a HOB list walk", "Lookups", LookupsMatchWalk, HobGuidIndexTestSetup, HobGuidIndexTestCleanup, TestContext);
+  AddTestCase (HobGuidIndexTests, "Unused HOBs are skipped", "UnusedHobs", UnusedHobsAreSkipped, HobGuidIndexTestSetup, HobGuidIndexTestCleanup, TestContext);
+  AddTestCase (HobGuidIndexTests, "Lookups outside of the indexed HOB list walk", "OtherHobList", OtherHobListIsWalked, HobGuidIndexTestSetup, HobGuidIndexTestCleanup, TestContext);
+  AddTestCase (HobGuidIndexTests, "Index of another HOB list is ignored", "OtherIndex", IndexOfOtherHobListIsIgnored, HobGuidIndexTestSetup, HobGuidIndexTestCleanup, TestContext);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  if (TestContext != NULL) {
+    FreePool (TestContext);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define HobGuidIndexUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+HobGuidIndexUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
@@ -196,6 +196,13 @@ EFI_GUIDED_SECTION_EXTRACTION_PROTOCOL  mCustomGuidedSectionExtractionProtocol =
   CustomGuidedSectionExtract
 };
 
+//
+// First decompressed section cache HOB handed over by the PEI Core, looked up
+// on first use
+//
+STATIC VOID     *mDecompressedSectionCacheHob        = NULL;
+STATIC BOOLEAN  mDecompressedSectionCacheHobSearched = FALSE;
+
 /**
   Entry point of the section extraction code. Initializes an instance of the
   section extraction interface and installs it on a new handle.
@@ -640,6 +647,77 @@ CreateGuidedExtractionRpnEvent (
                                 );
 }
 
+/**
+  Look up the output of a GUIDed section that the PEI Core has already
+  extracted.
+
+  The section is matched by its SectionDefinitionGuid and by its address,
+  which is the same as in the PEI phase when the section stream is read in
+  place from a memory mapped firmware volume. A 64-bit hash of the section
+  then makes sure that it was not changed. The output is not trusted for
+  sections that carry authentication data. Those are extracted again so that
+  their authentication status is computed by the DXE Core.
+
+  @param  GuidedHeader           The GUIDed section.
+  @param  SectionDefinitionGuid  The SectionDefinitionGuid of the section.
+  @param  SectionSize            The size of the section, including its header.
+  @param  OutputBuffer           Returns the extracted data.
+  @param  OutputSize             Returns the size of the extracted data.
+
+  @retval TRUE                   The section was extracted by the PEI Core, and
+                                 its extraction returned no authentication
+                                 status.
+  @retval FALSE                  The section has to be extracted.
+
+**/
+STATIC
+BOOLEAN
+FindDecompressedSectionCache (
+  IN  EFI_GUID_DEFINED_SECTION  *GuidedHeader,
+  IN  EFI_GUID                  *SectionDefinitionGuid,
+  IN  UINT32                    SectionSize,
+  OUT VOID                      **OutputBuffer,
+  OUT UINTN                     *OutputSize
+  )
+{
+  EFI_PEI_HOB_POINTERS                    Hob;
+  EDKII_DECOMPRESSED_SECTION_CACHE_ENTRY  *Entry;
+
+  if (!mDecompressedSectionCacheHobSearched) {
+    mDecompressedSectionCacheHob         = GetFirstGuidHob (&gEdkiiDecompressedSectionCacheHobGuid);
+    mDecompressedSectionCacheHobSearched = TRUE;
+  }
+
+  //
+  // The PEI Core records a section once, so only the section hash of the
+  // entry at the address of the section needs to be checked.
+  //
+  for (Hob.Raw = mDecompressedSectionCacheHob;
+       Hob.Raw != NULL;
+       Hob.Raw = GetNextGuidHob (&gEdkiiDecompressedSectionCacheHobGuid, GET_NEXT_HOB (Hob)))
+  {
+    Entry = GET_GUID_HOB_DATA (Hob);
+    if ((Entry->SectionAddress != (EFI_PHYSICAL_ADDRESS)(UINTN)GuidedHeader) ||
+        (Entry->SectionSize != SectionSize) ||
+        !CompareGuid (&Entry->SectionDefinitionGuid, SectionDefinitionGuid))
+    {
+      continue;
+    }
+
+    if ((Entry->AuthenticationStatus != 0) ||
+        (Entry->SectionHash != HashIndexBuffer64 (GuidedHeader, SectionSize)))
+    {
+      return FALSE;
+    }
+
+    *OutputBuffer = (VOID *)(UINTN)Entry->OutputBuffer;
+    *OutputSize   = (UINTN)Entry->OutputSize;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
 /**
   Worker function.  Constructor for new child nodes.
 
@@ -684,6 +762,7 @@ CreateChildNode (
   UINT32                                  UncompressedLength;
   UINT8                                   CompressionType;
   UINT16                                  GuidedSectionAttributes;
+  BOOLEAN                                 SectionCached;
 
   CORE_SECTION_CHILD_NODE  *Node;
 
@@ -840,19 +919,40 @@ CreateChildNode (
 
       if (VerifyGuidedSectionGuid (Node->EncapsulationGuid, &GuidedExtraction)) {
         //
-        // NewStreamBuffer is always allocated by ExtractSection... No caller
-        // allocation here.
+        // Reuse the output of the PEI Core if it extracted this section. That
+        // buffer is not owned by the stream, so it is copied below. Sections
+        // with authentication data are always extracted again.
         //
-        Status = GuidedExtraction->ExtractSection (
-                                     GuidedExtraction,
-                                     GuidedHeader,
-                                     &NewStreamBuffer,
-                                     &NewStreamBufferSize,
-                                     &AuthenticationStatus
-                                     );
-        if (EFI_ERROR (Status)) {
-          CoreFreePool (*ChildNode);
-          return EFI_PROTOCOL_ERROR;
+        SectionCached        = FALSE;
+        AuthenticationStatus = 0;
+        if (FeaturePcdGet (PcdDecompressedSectionCacheHob) &&
+            ((GuidedSectionAttributes & EFI_GUIDED_SECTION_AUTH_STATUS_VALID) == 0))
+        {
+          SectionCached = FindDecompressedSectionCache (
+                            GuidedHeader,
+                            Node->EncapsulationGuid,
+                            Node->Size,
+                            &NewStreamBuffer,
+                            &NewStreamBufferSize
+                            );
+        }
+
+        if (!SectionCached) {
+          //
+          // NewStreamBuffer is always allocated by ExtractSection... No caller
+          // allocation here.
+          //
+          Status = GuidedExtraction->ExtractSection (
+                                       GuidedExtraction,
+                                       GuidedHeader,
+                                       &NewStreamBuffer,
+                                       &NewStreamBufferSize,
+                                       &AuthenticationStatus
+                                       );
+          if (EFI_ERROR (Status)) {
+            CoreFreePool (*ChildNode);
+            return EFI_PROTOCOL_ERROR;
+          }
         }
 
         //
@@ -875,13 +975,16 @@ CreateChildNode (
         Status = OpenSectionStreamEx (
                    NewStreamBufferSize,
                    NewStreamBuffer,
-                   FALSE,
+                   SectionCached,
                    AuthenticationStatus,
                    &Node->EncapsulatedStreamHandle
                    );
         if (EFI_ERROR (Status)) {
           CoreFreePool (*ChildNode);
-          CoreFreePool (NewStreamBuffer);
+          if (!SectionCached) {
+            CoreFreePool (NewStreamBuffer);
+          }
+
           return Status;
         }
       } else {
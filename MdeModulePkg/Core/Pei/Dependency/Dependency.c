@@ -250,3 +250,65 @@ PeimDispatchReadiness (
     }
   }
 }
+
+/**
+  Return the bit of a PPI in the PPI masks of dependency expressions.
+
+  @param Guid            The GUID of the PPI.
+
+  @return The bit of the PPI.
+
+**/
+UINT64
+PeimDepexPpiBit (
+  IN CONST EFI_GUID  *Guid
+  )
+{
+  return LShiftU64 (1, ReadUnaligned32 ((CONST UINT32 *)Guid) & 0x3F);
+}
+
+/**
+  Return the mask of the PPIs that a dependency expression references, which
+  holds the bit returned by PeimDepexPpiBit() for each PUSH opcode. Only the
+  installation of a PPI whose bit is set in the mask may change the result of
+  the expression.
+
+  @param DependencyExpression   Pointer to a dependency expression.
+
+  @return The PPI mask, or 0 if the expression references no PPI or is not a
+          well-formed Grammar.
+
+**/
+UINT64
+PeimDepexPpiMask (
+  IN VOID  *DependencyExpression
+  )
+{
+  DEPENDENCY_EXPRESSION_OPERAND  *Iterator;
+  UINT64                         PpiMask;
+
+  Iterator = DependencyExpression;
+  PpiMask  = 0;
+
+  while (TRUE) {
+    switch (*(Iterator++)) {
+      case (EFI_DEP_PUSH):
+        PpiMask |= PeimDepexPpiBit ((EFI_GUID *)Iterator);
+        Iterator = Iterator + sizeof (EFI_GUID);
+        break;
+
+      case (EFI_DEP_AND):
+      case (EFI_DEP_OR):
+      case (EFI_DEP_NOT):
+      case (EFI_DEP_TRUE):
+      case (EFI_DEP_FALSE):
+        break;
+
+      case (EFI_DEP_END):
+        return PpiMask;
+
+      default:
+        return 0;
+    }
+  }
+}
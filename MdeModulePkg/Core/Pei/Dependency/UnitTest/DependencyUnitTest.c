@@ -0,0 +1,421 @@
+/** @file
+  Host based unit tests of the PPI masks of PEIM dependency expressions.
+
+  Dependency.c of the PEI core is built into the test, with the PPI database
+  replaced by the stub below. The dispatcher only evaluates a dependency
+  expression that evaluated to FALSE again once a PPI whose bit is in the
+  mask of the expression is installed. Random expressions are evaluated
+  while random PPIs are installed, and an expression that is skipped this
+  way is checked to still evaluate to FALSE.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../../PeiMain.h"
+
+#include <Library/UnitTestLib.h>
+#include <Library/UnitTestRandomLib.h>
+
+#define UNIT_TEST_APP_NAME     "PEI Core Dependency Expression Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+//
+// More PPIs than bits in a PPI mask, so that some PPIs share a bit
+//
+#define TEST_GUID_COUNT   96
+#define TEST_DEPEX_COUNT  200
+#define TEST_DEPEX_SIZE   1024
+#define TEST_DEPEX_DEPTH  4
+#define TEST_ROUNDS       20
+
+typedef struct {
+  EFI_GUID    Guids[TEST_GUID_COUNT];
+  BOOLEAN     Installed[TEST_GUID_COUNT];
+  UINT8       Depex[TEST_DEPEX_COUNT][TEST_DEPEX_SIZE];
+  BOOLEAN     Result[TEST_DEPEX_COUNT];
+  UINT64      PpiMask[TEST_DEPEX_COUNT];
+  UINTN       Order[TEST_GUID_COUNT];
+  UINT64      Seed;
+} TEST_CONTEXT;
+
+//
+// The PPIs seen as installed by PeiServicesLocatePpi ()
+//
+STATIC TEST_CONTEXT  *mTestContext = NULL;
+
+/**
+  Stub of the PEI service that locates a PPI, which looks the PPI up in the
+  PPIs of the test context marked as installed.
+
+  @param  Guid           The GUID of the PPI.
+  @param  Instance       The instance of the PPI.
+  @param  PpiDescriptor  Not used.
+  @param  Ppi            Returns the PPI.
+
+  @retval EFI_SUCCESS    The PPI is installed.
+  @retval EFI_NOT_FOUND  The PPI is not installed.
+
+**/
+EFI_STATUS
+EFIAPI
+PeiServicesLocatePpi (
+  IN CONST EFI_GUID              *Guid,
+  IN UINTN                       Instance,
+  IN OUT EFI_PEI_PPI_DESCRIPTOR  **PpiDescriptor  OPTIONAL,
+  IN OUT VOID                    **Ppi
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < TEST_GUID_COUNT; Index++) {
+    if (mTestContext->Installed[Index] && CompareGuid (Guid, &mTestContext->Guids[Index])) {
+      *Ppi = &mTestContext->Guids[Index];
+      return EFI_SUCCESS;
+    }
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Append a PUSH opcode to a dependency expression.
+
+  @param[in, out] Depex  Points to the end of the expression, and returns the
+                         new end.
+  @param[in]      Guid   The GUID of the PPI to push.
+**/
+STATIC
+VOID
+TestPushGuid (
+  IN OUT UINT8           **Depex,
+  IN     CONST EFI_GUID  *Guid
+  )
+{
+  **Depex = EFI_DEP_PUSH;
+  CopyGuid ((EFI_GUID *)(*Depex + 1), Guid);
+  *Depex += 1 + sizeof (EFI_GUID);
+}
+
+/**
+  Append a random well-formed postfix sub-expression to a dependency
+  expression.
+
+  @param[in, out] TestContext  The test context.
+  @param[in, out] Depex        Points to the end of the expression, and
+                               returns the new end.
+  @param[in]      Depth        The maximum depth of the sub-expression.
+**/
+STATIC
+VOID
+TestGenerateExpression (
+  IN OUT TEST_CONTEXT  *TestContext,
+  IN OUT UINT8         **Depex,
+  IN     UINTN         Depth
+  )
+{
+  UINT32  Choice;
+
+  if ((Depth == 0) || (UnitTestRandom (&TestContext->Seed) % 3 == 0)) {
+    Choice = UnitTestRandom (&TestContext->Seed) % 16;
+    if (Choice == 0) {
+      *((*Depex)++) = EFI_DEP_TRUE;
+    } else if (Choice == 1) {
+      *((*Depex)++) = EFI_DEP_FALSE;
+    } else {
+      TestPushGuid (Depex, &TestContext->Guids[UnitTestRandom (&TestContext->Seed) % TEST_GUID_COUNT]);
+    }
+
+    return;
+  }
+
+  Choice = UnitTestRandom (&TestContext->Seed) % 5;
+  TestGenerateExpression (TestContext, Depex, Depth - 1);
+  if (Choice == 0) {
+    *((*Depex)++) = EFI_DEP_NOT;
+    return;
+  }
+
+  TestGenerateExpression (TestContext, Depex, Depth - 1);
+  *((*Depex)++) = (Choice % 2 == 0) ? EFI_DEP_AND : EFI_DEP_OR;
+}
+
+/**
+  Generate random PPI GUIDs and random dependency expressions of them.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED  The expressions are generated.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+TestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINTN         Index;
+  UINT8         *Depex;
+
+  TestContext       = (TEST_CONTEXT *)Context;
+  TestContext->Seed = 0x5EED;
+  mTestContext      = TestContext;
+
+  for (Index = 0; Index < TEST_GUID_COUNT; Index++) {
+    TestContext->Guids[Index].Data1 = UnitTestRandom (&TestContext->Seed);
+    TestContext->Guids[Index].Data2 = (UINT16)UnitTestRandom (&TestContext->Seed);
+    TestContext->Guids[Index].Data3 = (UINT16)Index;
+    WriteUnaligned64 ((UINT64 *)TestContext->Guids[Index].Data4, LShiftU64 (UnitTestRandom (&TestContext->Seed), 32) | UnitTestRandom (&TestContext->Seed));
+  }
+
+  for (Index = 0; Index < TEST_DEPEX_COUNT; Index++) {
+    Depex = TestContext->Depex[Index];
+    TestGenerateExpression (TestContext, &Depex, TEST_DEPEX_DEPTH);
+    *Depex = EFI_DEP_END;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check the PPI masks of hand-written dependency expressions.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             The masks are as expected.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A mask is wrong.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+PpiMaskHoldsPushedPpis (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINT8         *Depex;
+  UINT64        Bit0;
+  UINT64        Bit1;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Bit0        = PeimDepexPpiBit (&TestContext->Guids[0]);
+  Bit1        = PeimDepexPpiBit (&TestContext->Guids[1]);
+  UT_ASSERT_EQUAL (Bit0, LShiftU64 (1, TestContext->Guids[0].Data1 & 0x3F));
+
+  //
+  // PUSH Guid0 PUSH Guid1 AND NOT END
+  //
+  Depex = TestContext->Depex[0];
+  TestPushGuid (&Depex, &TestContext->Guids[0]);
+  TestPushGuid (&Depex, &TestContext->Guids[1]);
+  *(Depex++) = EFI_DEP_AND;
+  *(Depex++) = EFI_DEP_NOT;
+  *Depex     = EFI_DEP_END;
+  UT_ASSERT_EQUAL (PeimDepexPpiMask (TestContext->Depex[0]), Bit0 | Bit1);
+
+  //
+  // TRUE END references no PPI
+  //
+  Depex      = TestContext->Depex[0];
+  *(Depex++) = EFI_DEP_TRUE;
+  *Depex     = EFI_DEP_END;
+  UT_ASSERT_EQUAL (PeimDepexPpiMask (TestContext->Depex[0]), 0);
+
+  //
+  // An unknown opcode makes the mask 0, so the expression is always evaluated
+  //
+  Depex = TestContext->Depex[0];
+  TestPushGuid (&Depex, &TestContext->Guids[0]);
+  *(Depex++) = 0xFF;
+  *Depex     = EFI_DEP_END;
+  UT_ASSERT_EQUAL (PeimDepexPpiMask (TestContext->Depex[0]), 0);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Install random PPIs one at a time, and check that an expression that
+  evaluated to FALSE still does while none of the PPIs installed since has
+  its bit in the mask of the expression.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             Skipped expressions still evaluate to
+                                       FALSE.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A skipped expression evaluates to
+                                       TRUE.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+FalseDepexUnchangedUntilPpiInstalled (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINTN         Round;
+  UINTN         Step;
+  UINTN         Index;
+  UINTN         Swap;
+  UINTN         Temp;
+  UINT64        Bit;
+  UINTN         SkipCount;
+  UINTN         SatisfiedCount;
+
+  TestContext    = (TEST_CONTEXT *)Context;
+  SkipCount      = 0;
+  SatisfiedCount = 0;
+
+  for (Round = 0; Round < TEST_ROUNDS; Round++) {
+    for (Index = 0; Index < TEST_GUID_COUNT; Index++) {
+      TestContext->Installed[Index] = FALSE;
+      TestContext->Order[Index]     = Index;
+    }
+
+    for (Index = TEST_GUID_COUNT - 1; Index > 0; Index--) {
+      Swap                      = UnitTestRandom (&TestContext->Seed) % (Index + 1);
+      Temp                      = TestContext->Order[Index];
+      TestContext->Order[Index] = TestContext->Order[Swap];
+      TestContext->Order[Swap]  = Temp;
+    }
+
+    for (Index = 0; Index < TEST_DEPEX_COUNT; Index++) {
+      TestContext->Result[Index]  = PeimDispatchReadiness (NULL, TestContext->Depex[Index]);
+      TestContext->PpiMask[Index] = TestContext->Result[Index] ? 0 : PeimDepexPpiMask (TestContext->Depex[Index]);
+    }
+
+    for (Step = 0; Step < TEST_GUID_COUNT; Step++) {
+      TestContext->Installed[TestContext->Order[Step]] = TRUE;
+      Bit                                              = PeimDepexPpiBit (&TestContext->Guids[TestContext->Order[Step]]);
+
+      for (Index = 0; Index < TEST_DEPEX_COUNT; Index++) {
+        if (TestContext->Result[Index] || (TestContext->PpiMask[Index] == 0)) {
+          continue;
+        }
+
+        if ((TestContext->PpiMask[Index] & Bit) == 0) {
+          UT_ASSERT_FALSE (PeimDispatchReadiness (NULL, TestContext->Depex[Index]));
+          SkipCount++;
+        } else {
+          TestContext->Result[Index] = PeimDispatchReadiness (NULL, TestContext->Depex[Index]);
+          if (TestContext->Result[Index]) {
+            SatisfiedCount++;
+          }
+        }
+      }
+    }
+  }
+
+  //
+  // Make sure the expressions exercise both cases
+  //
+  UT_ASSERT_NOT_EQUAL (SkipCount, 0);
+  UT_ASSERT_NOT_EQUAL (SatisfiedCount, 0);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the PPI
+  masks of dependency expressions and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      DependencyTests;
+  TEST_CONTEXT                *TestContext;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  TestContext = AllocateZeroPool (sizeof (TEST_CONTEXT));
+  if (TestContext == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the dependency expression Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&DependencyTests, Framework, "PEIM Dependency Expression Tests", "PeiCore.Dependency", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for PEIM Dependency Expression Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite----------Description------------------------------------------------------------Name---------------------Function--------------------------------Pre---------Post--Context-----
+  //
+  AddTestCase (DependencyTests, "The PPI mask holds the pushed PPIs", "PpiMask", PpiMaskHoldsPushedPpis, TestSetup, NULL, TestContext);
+  AddTestCase (DependencyTests, "A FALSE expression stays FALSE until a PPI of its mask is installed", "FalseDepexUnchanged", FalseDepexUnchangedUntilPpiInstalled, TestSetup, NULL, TestContext);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  if (TestContext != NULL) {
+    FreePool (TestContext);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define DependencyUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+DependencyUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
@@ -122,6 +122,7 @@ DiscoverPeimsAndOrderWithApriori (
   ASSERT (CoreFileHandle->PeimState != NULL);
   CoreFileHandle->FvFileHandles = AllocateZeroPool (sizeof (EFI_PEI_FILE_HANDLE) * PeimCount);
   ASSERT (CoreFileHandle->FvFileHandles != NULL);
+  CoreFileHandle->DepexState = AllocateZeroPool (sizeof (PEI_CORE_DEPEX_STATE) * PeimCount);
 
   //
   // Get Apriori File handle
@@ -1098,7 +1099,8 @@ ConvertStatusCodeCallbacks (
 }
 
 /**
-  Migrates PEIMs in the given firmware volume.
+  Migrates PEIMs in the given firmware volume, and converts the file handles
+  of its file table.
 
   @param Private          Pointer to the PeiCore's private data structure.
   @param FvIndex          The firmware volume index to migrate.
@@ -1127,6 +1129,11 @@ MigratePeimsInFv (
     return EFI_INVALID_PARAMETER;
   }
 
+  for (FileIndex = 0; FileIndex < Private->Fv[FvIndex].FileCount; FileIndex++) {
+    FileHandle                                           = Private->Fv[FvIndex].FileTable[FileIndex].FileHandle;
+    Private->Fv[FvIndex].FileTable[FileIndex].FileHandle = (EFI_PEI_FILE_HANDLE)((UINTN)FileHandle - OrgFvHandle + FvHandle);
+  }
+
   if (Private->Fv[FvIndex].ScanFv) {
     for (FileIndex = 0; FileIndex < Private->Fv[FvIndex].PeimCount; FileIndex++) {
       if (Private->Fv[FvIndex].FvFileHandles[FileIndex] != NULL) {
@@ -1709,6 +1716,13 @@ PeiDispatcher (
     //  as it will fail the next time too (nothing has changed).
     //
   } while (Private->PeimNeedingDispatch && Private->PeimDispatchOnThisPass);
+
+  DEBUG ((
+    DEBUG_INFO,
+    "PEIM DEPEX: %Lu evaluated, %Lu not evaluated since none of their PPIs was installed\n",
+    (UINT64)Private->DepexEvaluationCount,
+    (UINT64)Private->DepexSkipCount
+    ));
 }
 
 /**
@@ -1741,9 +1755,60 @@ InitializeDispatcherData (
   return;
 }
 
+/**
+  Check whether the result of the dependency expression of a PEIM of the
+  current FV may have changed since it last evaluated to FALSE.
+
+  @param Private         PeiCore's private data structure
+  @param PeimCount       Index of the PEIM in the current FV.
+
+  @retval TRUE   The dependency expression has to be evaluated.
+  @retval FALSE  None of the PPIs referenced by the dependency expression
+                 was installed, so it still evaluates to FALSE.
+
+**/
+STATIC
+BOOLEAN
+IsPeimDepexChanged (
+  IN PEI_CORE_INSTANCE  *Private,
+  IN UINTN              PeimCount
+  )
+{
+  PEI_CORE_DEPEX_STATE  *DepexState;
+  PEI_PPI_LIST          *PpiList;
+  UINTN                 Index;
+
+  if (Private->Fv[Private->CurrentPeimFvCount].DepexState == NULL) {
+    return TRUE;
+  }
+
+  DepexState = &Private->Fv[Private->CurrentPeimFvCount].DepexState[PeimCount];
+  PpiList    = &Private->PpiData.PpiList;
+  if ((DepexState->PpiMask == 0) ||
+      (DepexState->PpiReinstallCount != Private->PpiReinstallCount) ||
+      (DepexState->PpiCount > PpiList->CurrentCount))
+  {
+    return TRUE;
+  }
+
+  for (Index = DepexState->PpiCount; Index < PpiList->CurrentCount; Index++) {
+    if ((PeimDepexPpiBit (PpiList->PpiPtrs[Index].Ppi->Guid) & DepexState->PpiMask) != 0) {
+      return TRUE;
+    }
+  }
+
+  //
+  // The PPIs installed so far do not need to be checked again
+  //
+  DepexState->PpiCount = (UINT32)PpiList->CurrentCount;
+  return FALSE;
+}
+
 /**
   This routine parses the Dependency Expression, if available, and
   decides if the module can be executed.
+  A dependency expression that evaluated to FALSE is only evaluated again
+  once a PPI it references has been installed.
 
 
   @param Private         PeiCore's private data structure
@@ -1761,9 +1826,16 @@ DepexSatisfied (
   IN UINTN                PeimCount
   )
 {
-  EFI_STATUS        Status;
-  VOID              *DepexData;
-  EFI_FV_FILE_INFO  FileInfo;
+  EFI_STATUS            Status;
+  VOID                  *DepexData;
+  EFI_FV_FILE_INFO      FileInfo;
+  BOOLEAN               Result;
+  PEI_CORE_DEPEX_STATE  *DepexState;
+
+  if ((PeimCount >= Private->AprioriCount) && !IsPeimDepexChanged (Private, PeimCount)) {
+    Private->DepexSkipCount++;
+    return FALSE;
+  }
 
   Status = PeiServicesFfsGetFileInfo (FileHandle, &FileInfo);
   if (EFI_ERROR (Status)) {
@@ -1800,7 +1872,17 @@ DepexSatisfied (
   //
   // Evaluate a given DEPEX
   //
-  return PeimDispatchReadiness (&Private->Ps, DepexData);
+  Private->DepexEvaluationCount++;
+  Result = PeimDispatchReadiness (&Private->Ps, DepexData);
+
+  if (Private->Fv[Private->CurrentPeimFvCount].DepexState != NULL) {
+    DepexState                    = &Private->Fv[Private->CurrentPeimFvCount].DepexState[PeimCount];
+    DepexState->PpiMask           = Result ? 0 : PeimDepexPpiMask (DepexData);
+    DepexState->PpiCount          = (UINT32)Private->PpiData.PpiList.CurrentCount;
+    DepexState->PpiReinstallCount = Private->PpiReinstallCount;
+  }
+
+  return Result;
 }
 
 /**
@@ -455,6 +455,188 @@ FindFileEx (
   return EFI_NOT_FOUND;
 }
 
+/**
+  Returns the file table of a firmware volume, which records the name, the type
+  and the handle of each file of the firmware volume, in the order of the
+  firmware volume. The table is built on the first call, so that the later
+  searches for files do not read the firmware volume again.
+
+  There is no file table if PcdPeiCoreFvFileTable is FALSE, if the firmware
+  volume has no file, or if there is no room left for the table. If there is
+  no room before permanent memory is installed, the failure is recorded so
+  that the firmware volume is not scanned again until permanent memory is
+  installed, and the table is built once more then.
+
+  @param CoreFvHandle    The firmware volume.
+
+  @return The file table, or NULL if the firmware volume has no file table.
+
+**/
+STATIC
+PEI_CORE_FV_FILE *
+GetFvFileTable (
+  IN PEI_CORE_FV_HANDLE  *CoreFvHandle
+  )
+{
+  EFI_STATUS           Status;
+  PEI_CORE_INSTANCE    *PrivateData;
+  EFI_PEI_FILE_HANDLE  FileHandle;
+  EFI_FFS_FILE_HEADER  *FileHeader;
+  PEI_CORE_FV_FILE     *FileTable;
+  UINTN                FileCount;
+  UINTN                Index;
+
+  if (!FeaturePcdGet (PcdPeiCoreFvFileTable)) {
+    return NULL;
+  }
+
+  if (CoreFvHandle->ScanFiles) {
+    return CoreFvHandle->FileTable;
+  }
+
+  PrivateData = PEI_CORE_INSTANCE_FROM_PS_THIS (GetPeiServicesTablePointer ());
+  if (CoreFvHandle->FileTableDeferred && !PrivateData->PeiMemoryInstalled) {
+    return NULL;
+  }
+
+  FileCount  = 0;
+  FileHandle = NULL;
+  while (!EFI_ERROR (FindFileEx (CoreFvHandle->FvHandle, NULL, EFI_FV_FILETYPE_ALL, &FileHandle, NULL))) {
+    FileCount++;
+  }
+
+  if (FileCount == 0) {
+    CoreFvHandle->ScanFiles = TRUE;
+    return NULL;
+  }
+
+  FileTable = AllocatePool (sizeof (PEI_CORE_FV_FILE) * FileCount);
+  if (FileTable == NULL) {
+    DEBUG ((DEBUG_INFO, "No room for the table of 0x%lx files of the FV at 0x%p\n", (UINT64)FileCount, CoreFvHandle->FvHandle));
+    //
+    // Retry once permanent memory is installed, and give up if there is no
+    // room then either.
+    //
+    if (PrivateData->PeiMemoryInstalled) {
+      CoreFvHandle->ScanFiles = TRUE;
+    } else {
+      CoreFvHandle->FileTableDeferred = TRUE;
+    }
+
+    return NULL;
+  }
+
+  FileHandle = NULL;
+  for (Index = 0; Index < FileCount; Index++) {
+    Status = FindFileEx (CoreFvHandle->FvHandle, NULL, EFI_FV_FILETYPE_ALL, &FileHandle, NULL);
+    ASSERT_EFI_ERROR (Status);
+    FileHeader = (EFI_FFS_FILE_HEADER *)FileHandle;
+    CopyGuid (&FileTable[Index].Name, &FileHeader->Name);
+    FileTable[Index].Type       = FileHeader->Type;
+    FileTable[Index].FileHandle = FileHandle;
+  }
+
+  CoreFvHandle->FileTable = FileTable;
+  CoreFvHandle->FileCount = FileCount;
+  CoreFvHandle->ScanFiles = TRUE;
+  return FileTable;
+}
+
+/**
+  Search for a file with the file table of a firmware volume. The search has
+  the same result as the search of FindFileEx() in the firmware volume.
+
+  @param FvHandle        Pointer to the FV header of the volume to search
+  @param FileName        File name
+  @param SearchType      Filter to find only files of this type.
+                         Type EFI_FV_FILETYPE_ALL causes no filtering to be done.
+  @param FileHandle      This parameter must point to a valid FFS volume.
+  @param Status          Receives the result of the search if it was done.
+
+  @retval TRUE           The search was done with the file table.
+  @retval FALSE          The firmware volume has no file table, or FileHandle
+                         is not a file of the file table.
+
+**/
+STATIC
+BOOLEAN
+FindFileInFvFileTable (
+  IN  CONST EFI_PEI_FV_HANDLE    FvHandle,
+  IN  CONST EFI_GUID             *FileName    OPTIONAL,
+  IN        EFI_FV_FILETYPE      SearchType,
+  IN OUT    EFI_PEI_FILE_HANDLE  *FileHandle,
+  OUT       EFI_STATUS           *Status
+  )
+{
+  PEI_CORE_FV_HANDLE  *CoreFvHandle;
+  PEI_CORE_FV_FILE    *FileTable;
+  UINTN               Index;
+  UINTN               Low;
+  UINTN               High;
+
+  CoreFvHandle = FvHandleToCoreHandle (FvHandle);
+  if (CoreFvHandle == NULL) {
+    return FALSE;
+  }
+
+  FileTable = GetFvFileTable (CoreFvHandle);
+  if (FileTable == NULL) {
+    return FALSE;
+  }
+
+  //
+  // Like FindFileEx(), start with the first file of the firmware volume if
+  // FileName is not NULL, and otherwise with the file that follows FileHandle.
+  // The file handles of the table are in ascending order.
+  //
+  Index = 0;
+  if ((FileName == NULL) && (*FileHandle != NULL)) {
+    Low  = 0;
+    High = CoreFvHandle->FileCount;
+    while (Low < High) {
+      Index = Low + (High - Low) / 2;
+      if ((UINTN)FileTable[Index].FileHandle < (UINTN)*FileHandle) {
+        Low = Index + 1;
+      } else {
+        High = Index;
+      }
+    }
+
+    if ((Low == CoreFvHandle->FileCount) || (FileTable[Low].FileHandle != *FileHandle)) {
+      return FALSE;
+    }
+
+    Index = Low + 1;
+  }
+
+  for ( ; Index < CoreFvHandle->FileCount; Index++) {
+    if (FileName != NULL) {
+      if (CompareGuid (&FileTable[Index].Name, FileName)) {
+        break;
+      }
+    } else if (SearchType == PEI_CORE_INTERNAL_FFS_FILE_DISPATCH_TYPE) {
+      if ((FileTable[Index].Type == EFI_FV_FILETYPE_PEIM) ||
+          (FileTable[Index].Type == EFI_FV_FILETYPE_COMBINED_PEIM_DRIVER) ||
+          (FileTable[Index].Type == EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE))
+      {
+        break;
+      }
+    } else if ((SearchType == FileTable[Index].Type) || (SearchType == EFI_FV_FILETYPE_ALL)) {
+      break;
+    }
+  }
+
+  if (Index < CoreFvHandle->FileCount) {
+    *FileHandle = FileTable[Index].FileHandle;
+    *Status     = EFI_SUCCESS;
+  } else {
+    *FileHandle = NULL;
+    *Status     = EFI_NOT_FOUND;
+  }
+
+  return TRUE;
+}
+
 /**
   Initialize PeiCore FV List.
 
@@ -759,6 +941,68 @@ VerifyGuidedSectionGuid (
   return FALSE;
 }
 
+/**
+  Record the output of an extracted GUIDed section in a HOB, so that the DXE
+  Core can use it instead of extracting the section again.
+
+  The DXE Core cannot tell whether the output was tampered with after it was
+  recorded, so only sections whose extraction reported no authentication
+  status are recorded. The DXE Core finds the record by the address of the
+  section, so it only reuses the output of sections that it reads in place
+  from the same memory mapped firmware volume.
+
+  @param Section                The GUIDed section.
+  @param SectionDefinitionGuid  The SectionDefinitionGuid of the section.
+  @param OutputBuffer           The output of the extraction, in permanent memory.
+  @param OutputSize             The size of OutputBuffer in bytes.
+
+**/
+STATIC
+VOID
+BuildDecompressedSectionCacheHob (
+  IN EFI_COMMON_SECTION_HEADER  *Section,
+  IN EFI_GUID                   *SectionDefinitionGuid,
+  IN VOID                       *OutputBuffer,
+  IN UINTN                      OutputSize
+  )
+{
+  EFI_PEI_HOB_POINTERS                    Hob;
+  EDKII_DECOMPRESSED_SECTION_CACHE_ENTRY  *Entry;
+  EDKII_DECOMPRESSED_SECTION_CACHE_ENTRY  NewEntry;
+
+  if (IS_SECTION2 (Section)) {
+    NewEntry.SectionSize = SECTION2_SIZE (Section);
+  } else {
+    NewEntry.SectionSize = SECTION_SIZE (Section);
+  }
+
+  NewEntry.SectionAddress = (EFI_PHYSICAL_ADDRESS)(UINTN)Section;
+
+  //
+  // The section may be extracted again after it has been evicted from the
+  // section cache of the PEI Core instance, so skip it if it is recorded.
+  //
+  for (Hob.Raw = GetFirstGuidHob (&gEdkiiDecompressedSectionCacheHobGuid);
+       Hob.Raw != NULL;
+       Hob.Raw = GetNextGuidHob (&gEdkiiDecompressedSectionCacheHobGuid, GET_NEXT_HOB (Hob)))
+  {
+    Entry = GET_GUID_HOB_DATA (Hob);
+    if ((Entry->SectionAddress == NewEntry.SectionAddress) &&
+        (Entry->SectionSize == NewEntry.SectionSize) &&
+        CompareGuid (&Entry->SectionDefinitionGuid, SectionDefinitionGuid))
+    {
+      return;
+    }
+  }
+
+  CopyGuid (&NewEntry.SectionDefinitionGuid, SectionDefinitionGuid);
+  NewEntry.AuthenticationStatus = 0;
+  NewEntry.SectionHash          = HashIndexBuffer64 (Section, NewEntry.SectionSize);
+  NewEntry.OutputBuffer         = (EFI_PHYSICAL_ADDRESS)(UINTN)OutputBuffer;
+  NewEntry.OutputSize           = OutputSize;
+  BuildGuidDataHob (&gEdkiiDecompressedSectionCacheHobGuid, &NewEntry, sizeof (NewEntry));
+}
+
 /**
   Go through the file to search SectionType section.
   Search within encapsulation sections (compression and GUIDed) recursively,
@@ -802,6 +1046,7 @@ ProcessSection (
   PEI_CORE_INSTANCE                      *PrivateData;
   EFI_GUID                               *SectionDefinitionGuid;
   BOOLEAN                                SectionCached;
+  BOOLEAN                                SectionExtracted;
   VOID                                   *TempOutputBuffer;
   UINT32                                 TempAuthenticationStatus;
   UINT16                                 GuidedSectionAttributes;
@@ -901,8 +1146,11 @@ ProcessSection (
       // If SectionCached is TRUE, the section data has been cached and scanned.
       //
       if (!SectionCached) {
-        Status         = EFI_NOT_FOUND;
-        Authentication = 0;
+        Status                  = EFI_NOT_FOUND;
+        Authentication          = 0;
+        SectionDefinitionGuid   = NULL;
+        GuidedSectionAttributes = 0;
+        SectionExtracted        = FALSE;
         if (Section->Type == EFI_SECTION_GUID_DEFINED) {
           if (IS_SECTION2 (Section)) {
             SectionDefinitionGuid   = &((EFI_GUID_DEFINED_SECTION2 *)Section)->SectionDefinitionGuid;
@@ -920,6 +1168,7 @@ ProcessSection (
                                        &PpiOutputSize,
                                        &Authentication
                                        );
+            SectionExtracted = TRUE;
           } else if ((GuidedSectionAttributes & EFI_GUIDED_SECTION_PROCESSING_REQUIRED) == 0) {
             //
             // Figure out the proper authentication status for GUIDED section without processing required
@@ -963,6 +1212,17 @@ ProcessSection (
             PrivateData->CacheSection.SectionSize[PrivateData->CacheSection.SectionIndex]          = PpiOutputSize;
             PrivateData->CacheSection.AuthenticationStatus[PrivateData->CacheSection.SectionIndex] = Authentication;
             PrivateData->CacheSection.SectionIndex                                                 = (PrivateData->CacheSection.SectionIndex + 1)%CACHE_SETION_MAX_NUMBER;
+
+            //
+            // Only output in permanent memory outlives the PEI phase. Sections
+            // that carry authentication data are always extracted again by the
+            // DXE Core, so that it computes their authentication status itself.
+            //
+            if (FeaturePcdGet (PcdDecompressedSectionCacheHob) && SectionExtracted && PrivateData->PeiMemoryInstalled &&
+                (Authentication == 0) && ((GuidedSectionAttributes & EFI_GUIDED_SECTION_AUTH_STATUS_VALID) == 0))
+            {
+              BuildDecompressedSectionCacheHob (Section, SectionDefinitionGuid, PpiOutput, PpiOutputSize);
+            }
           }
 
           TempAuthenticationStatus = 0;
@@ -1690,6 +1950,12 @@ PeiFfsFvPpiFindFileByType (
   IN OUT    EFI_PEI_FILE_HANDLE          *FileHandle
   )
 {
+  EFI_STATUS  Status;
+
+  if (FindFileInFvFileTable (FvHandle, NULL, SearchType, FileHandle, &Status)) {
+    return Status;
+  }
+
   return FindFileEx (FvHandle, NULL, SearchType, FileHandle, NULL);
 }
 
@@ -1736,7 +2002,10 @@ PeiFfsFvPpiFindFileByName (
   }
 
   if (*FvHandle != NULL) {
-    Status = FindFileEx (*FvHandle, FileName, 0, FileHandle, NULL);
+    if (!FindFileInFvFileTable (*FvHandle, FileName, 0, FileHandle, &Status)) {
+      Status = FindFileEx (*FvHandle, FileName, 0, FileHandle, NULL);
+    }
+
     if (Status == EFI_NOT_FOUND) {
       *FileHandle = NULL;
     }
@@ -1752,7 +2021,10 @@ PeiFfsFvPpiFindFileByName (
       // Only search the FV which is associated with a EFI_PEI_FIRMWARE_VOLUME_PPI instance.
       //
       if (PrivateData->Fv[Index].FvPpi != NULL) {
-        Status = FindFileEx (PrivateData->Fv[Index].FvHandle, FileName, 0, FileHandle, NULL);
+        if (!FindFileInFvFileTable (PrivateData->Fv[Index].FvHandle, FileName, 0, FileHandle, &Status)) {
+          Status = FindFileEx (PrivateData->Fv[Index].FvHandle, FileName, 0, FileHandle, NULL);
+        }
+
         if (!EFI_ERROR (Status)) {
           *FvHandle = PrivateData->Fv[Index].FvHandle;
           break;
@@ -42,10 +42,12 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <IndustryStandard/PeImage.h>
 #include <Library/PeiServicesTablePointerLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/HashIndexLib.h>
 #include <Guid/FirmwareFileSystem2.h>
 #include <Guid/FirmwareFileSystem3.h>
 #include <Guid/AprioriFileName.h>
 #include <Guid/MigratedFvInfo.h>
+#include <Guid/DecompressedSectionCache.h>
 
 ///
 /// It is an FFS type extension used for PeiFindFileEx. It indicates current
@@ -132,6 +134,27 @@ typedef struct {
 //
 #define FV_GROWTH_STEP  8
 
+//
+// State of the dependency expression of a PEIM that evaluated to FALSE. The
+// expression is only evaluated again once a PPI whose bit is in PpiMask was
+// installed after the first PpiCount PPIs, or once any PPI was reinstalled.
+// A PpiMask of 0 means the expression is evaluated on the next pass.
+//
+typedef struct {
+  UINT64    PpiMask;
+  UINT32    PpiCount;
+  UINT32    PpiReinstallCount;
+} PEI_CORE_DEPEX_STATE;
+
+//
+// Entry of the file table of a firmware volume
+//
+typedef struct {
+  EFI_GUID               Name;
+  EFI_FV_FILETYPE        Type;
+  EFI_PEI_FILE_HANDLE    FileHandle;
+} PEI_CORE_FV_FILE;
+
 typedef struct {
   EFI_FIRMWARE_VOLUME_HEADER     *FvHeader;
   EFI_PEI_FIRMWARE_VOLUME_PPI    *FvPpi;
@@ -145,8 +168,24 @@ typedef struct {
   // Pointer to the buffer with the PeimCount number of Entries.
   //
   EFI_PEI_FILE_HANDLE            *FvFileHandles;
+  //
+  // Pointer to the buffer with the PeimCount number of Entries, or NULL if
+  // there was no room for it.
+  //
+  PEI_CORE_DEPEX_STATE           *DepexState;
   BOOLEAN                        ScanFv;
   UINT32                         AuthenticationStatus;
+  //
+  // Pointer to the buffer with the FileCount number of Entries, in the order
+  // of the files in the FV. NULL if the files of the FV are not recorded.
+  // ScanFiles is TRUE once the table is built, or once the FV is found to
+  // have no file or no room is left for the table. FileTableDeferred is TRUE if there was no room for the
+  // table before permanent memory was installed.
+  //
+  PEI_CORE_FV_FILE               *FileTable;
+  UINTN                          FileCount;
+  BOOLEAN                        ScanFiles;
+  BOOLEAN                        FileTableDeferred;
 } PEI_CORE_FV_HANDLE;
 
 typedef struct {
@@ -255,6 +294,13 @@ struct _PEI_CORE_INSTANCE {
   BOOLEAN                           PeimNeedingDispatch;
   BOOLEAN                           PeimDispatchOnThisPass;
   BOOLEAN                           PeimDispatcherReenter;
+  ///
+  /// Number of PPIs reinstalled, and of the dependency expressions of PEIMs
+  /// evaluated and not evaluated since none of their PPIs was installed.
+  ///
+  UINT32                            PpiReinstallCount;
+  UINTN                             DepexEvaluationCount;
+  UINTN                             DepexSkipCount;
   EFI_PEI_HOB_POINTERS              HobList;
   BOOLEAN                           SwitchStackSignal;
   BOOLEAN                           PeiMemoryInstalled;
@@ -396,6 +442,36 @@ PeimDispatchReadiness (
   IN VOID              *DependencyExpression
   );
 
+/**
+  Return the bit of a PPI in the PPI masks of dependency expressions.
+
+  @param Guid            The GUID of the PPI.
+
+  @return The bit of the PPI.
+
+**/
+UINT64
+PeimDepexPpiBit (
+  IN CONST EFI_GUID  *Guid
+  );
+
+/**
+  Return the mask of the PPIs that a dependency expression references, which
+  holds the bit returned by PeimDepexPpiBit() for each PUSH opcode. Only the
+  installation of a PPI whose bit is set in the mask may change the result of
+  the expression.
+
+  @param DependencyExpression   Pointer to a dependency expression.
+
+  @return The PPI mask, or 0 if the expression references no PPI or is not a
+          well-formed Grammar.
+
+**/
+UINT64
+PeimDepexPpiMask (
+  IN VOID  *DependencyExpression
+  );
+
 /**
   Migrate a PEIM from temporary RAM to permanent memory.
 
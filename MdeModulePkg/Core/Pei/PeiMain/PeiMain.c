@@ -241,6 +241,14 @@ PeiCore (
           if (OldCoreData->Fv[Index].FvFileHandles != NULL) {
             OldCoreData->Fv[Index].FvFileHandles = (EFI_PEI_FILE_HANDLE *)((UINT8 *)OldCoreData->Fv[Index].FvFileHandles + OldCoreData->HeapOffset);
           }
+
+          if (OldCoreData->Fv[Index].DepexState != NULL) {
+            OldCoreData->Fv[Index].DepexState = (PEI_CORE_DEPEX_STATE *)((UINT8 *)OldCoreData->Fv[Index].DepexState + OldCoreData->HeapOffset);
+          }
+
+          if (OldCoreData->Fv[Index].FileTable != NULL) {
+            OldCoreData->Fv[Index].FileTable = (PEI_CORE_FV_FILE *)((UINT8 *)OldCoreData->Fv[Index].FileTable + OldCoreData->HeapOffset);
+          }
         }
 
         OldCoreData->TempFileGuid    = (EFI_GUID *)((UINT8 *)OldCoreData->TempFileGuid + OldCoreData->HeapOffset);
@@ -276,6 +284,14 @@ PeiCore (
           if (OldCoreData->Fv[Index].FvFileHandles != NULL) {
             OldCoreData->Fv[Index].FvFileHandles = (EFI_PEI_FILE_HANDLE *)((UINT8 *)OldCoreData->Fv[Index].FvFileHandles - OldCoreData->HeapOffset);
           }
+
+          if (OldCoreData->Fv[Index].DepexState != NULL) {
+            OldCoreData->Fv[Index].DepexState = (PEI_CORE_DEPEX_STATE *)((UINT8 *)OldCoreData->Fv[Index].DepexState - OldCoreData->HeapOffset);
+          }
+
+          if (OldCoreData->Fv[Index].FileTable != NULL) {
+            OldCoreData->Fv[Index].FileTable = (PEI_CORE_FV_FILE *)((UINT8 *)OldCoreData->Fv[Index].FileTable - OldCoreData->HeapOffset);
+          }
         }
 
         OldCoreData->TempFileGuid    = (EFI_GUID *)((UINT8 *)OldCoreData->TempFileGuid - OldCoreData->HeapOffset);
@@ -625,6 +625,7 @@ PeiReInstallPpi (
   //
   DEBUG ((DEBUG_INFO, "Reinstall PPI: %g\n", NewPpi->Guid));
   PrivateData->PpiData.PpiList.PpiPtrs[Index].Ppi = (EFI_PEI_PPI_DESCRIPTOR *)NewPpi;
+  PrivateData->PpiReinstallCount++;
 
   //
   // Process any callback level notifies for the newly installed PPI.
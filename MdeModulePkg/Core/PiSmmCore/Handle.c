@@ -15,6 +15,36 @@
 LIST_ENTRY  mProtocolDatabase = INITIALIZE_LIST_HEAD_VARIABLE (mProtocolDatabase);
 LIST_ENTRY  gHandleList       = INITIALIZE_LIST_HEAD_VARIABLE (gHandleList);
 
+//
+// Hash indexes over the lists above.
+//
+// mProtocolEntryIndex     - All PROTOCOL_ENTRYs, keyed by protocol GUID
+// mProtocolInterfaceIndex - All PROTOCOL_INTERFACEs, keyed by handle and protocol GUID
+//
+LIST_ENTRY  mProtocolEntryIndexBuckets[PROTOCOL_ENTRY_INDEX_BUCKET_COUNT];
+LIST_ENTRY  mProtocolInterfaceIndexBuckets[PROTOCOL_INTERFACE_INDEX_BUCKET_COUNT];
+HASH_INDEX  mProtocolEntryIndex     = HASH_INDEX_INITIALIZER (mProtocolEntryIndexBuckets);
+HASH_INDEX  mProtocolInterfaceIndex = HASH_INDEX_INITIALIZER (mProtocolInterfaceIndexBuckets);
+
+/**
+  Compute the mProtocolInterfaceIndex hash value of a protocol on a handle.
+
+  @param  Handle                 The handle the protocol is installed on
+  @param  Protocol               The ID of the protocol
+
+  @return The hash value
+
+**/
+STATIC
+UINTN
+SmmProtocolInterfaceHash (
+  IN IHANDLE         *Handle,
+  IN CONST EFI_GUID  *Protocol
+  )
+{
+  return HashIndexPointer (Handle) ^ HashIndexGuid (Protocol);
+}
+
 /**
   Check whether a handle is a valid EFI_HANDLE
 
@@ -58,20 +88,22 @@ SmmFindProtocolEntry (
   IN BOOLEAN   Create
   )
 {
-  LIST_ENTRY      *Link;
-  PROTOCOL_ENTRY  *Item;
-  PROTOCOL_ENTRY  *ProtEntry;
+  HASH_INDEX_ENTRY  *Entry;
+  PROTOCOL_ENTRY    *Item;
+  PROTOCOL_ENTRY    *ProtEntry;
+  UINTN             Hash;
 
   //
-  // Search the database for the matching GUID
+  // Search the database index for the matching GUID
   //
 
   ProtEntry = NULL;
-  for (Link = mProtocolDatabase.ForwardLink;
-       Link != &mProtocolDatabase;
-       Link = Link->ForwardLink)
+  Hash      = HashIndexGuid (Protocol);
+  for (Entry = HashIndexGetFirst (&mProtocolEntryIndex, Hash);
+       Entry != NULL;
+       Entry = HashIndexGetNext (&mProtocolEntryIndex, Entry))
   {
-    Item = CR (Link, PROTOCOL_ENTRY, AllEntries, PROTOCOL_ENTRY_SIGNATURE);
+    Item = CR (Entry, PROTOCOL_ENTRY, HashEntry, PROTOCOL_ENTRY_SIGNATURE);
     if (CompareGuid (&Item->ProtocolID, Protocol)) {
       //
       // This is the protocol entry
@@ -100,6 +132,7 @@ SmmFindProtocolEntry (
       // Add it to protocol database
       //
       InsertTailList (&mProtocolDatabase, &ProtEntry->AllEntries);
+      HashIndexInsert (&mProtocolEntryIndex, &ProtEntry->HashEntry, Hash);
     }
   }
 
@@ -126,33 +159,27 @@ SmmFindProtocolInterface (
   )
 {
   PROTOCOL_INTERFACE  *Prot;
-  PROTOCOL_ENTRY      *ProtEntry;
-  LIST_ENTRY          *Link;
-
-  Prot = NULL;
+  HASH_INDEX_ENTRY    *Entry;
+  UINTN               Hash;
 
   //
-  // Lookup the protocol entry for this protocol ID
+  // A protocol can only be installed once on a handle, so the interface
+  // index lookup yields the only candidate
   //
-  ProtEntry = SmmFindProtocolEntry (Protocol, FALSE);
-  if (ProtEntry != NULL) {
-    //
-    // Look at each protocol interface for any matches
-    //
-    for (Link = Handle->Protocols.ForwardLink; Link != &Handle->Protocols; Link = Link->ForwardLink) {
-      //
-      // If this protocol interface matches, remove it
-      //
-      Prot = CR (Link, PROTOCOL_INTERFACE, Link, PROTOCOL_INTERFACE_SIGNATURE);
-      if ((Prot->Interface == Interface) && (Prot->Protocol == ProtEntry)) {
-        break;
-      }
-
-      Prot = NULL;
+  Hash = SmmProtocolInterfaceHash (Handle, Protocol);
+  for (Entry = HashIndexGetFirst (&mProtocolInterfaceIndex, Hash);
+       Entry != NULL;
+       Entry = HashIndexGetNext (&mProtocolInterfaceIndex, Entry))
+  {
+    Prot = CR (Entry, PROTOCOL_INTERFACE, HashEntry, PROTOCOL_INTERFACE_SIGNATURE);
+    if ((Prot->Handle == Handle) && (Prot->Interface == Interface) &&
+        CompareGuid (&Prot->Protocol->ProtocolID, Protocol))
+    {
+      return Prot;
     }
   }
 
-  return Prot;
+  return NULL;
 }
 
 /**
@@ -319,6 +346,15 @@ SmmInstallProtocolInterfaceNotify (
   //
   InsertTailList (&ProtEntry->Protocols, &Prot->ByProtocol);
 
+  //
+  // Index the protocol interface by handle and protocol ID
+  //
+  HashIndexInsert (
+    &mProtocolInterfaceIndex,
+    &Prot->HashEntry,
+    SmmProtocolInterfaceHash (Handle, &ProtEntry->ProtocolID)
+    );
+
   //
   // Notify the notification list for this protocol
   //
@@ -408,6 +444,7 @@ SmmUninstallProtocolInterface (
     // Remove the protocol interface from the handle
     //
     RemoveEntryList (&Prot->Link);
+    HashIndexRemove (&mProtocolInterfaceIndex, &Prot->HashEntry);
 
     //
     // Free the memory
@@ -445,10 +482,10 @@ SmmGetProtocolInterface (
   )
 {
   EFI_STATUS          Status;
-  PROTOCOL_ENTRY      *ProtEntry;
   PROTOCOL_INTERFACE  *Prot;
   IHANDLE             *Handle;
-  LIST_ENTRY          *Link;
+  HASH_INDEX_ENTRY    *Entry;
+  UINTN               Hash;
 
   Status = SmmValidateHandle (UserHandle);
   if (EFI_ERROR (Status)) {
@@ -458,12 +495,15 @@ SmmGetProtocolInterface (
   Handle = (IHANDLE *)UserHandle;
 
   //
-  // Look at each protocol interface for a match
+  // Look up the protocol interface index for a match
   //
-  for (Link = Handle->Protocols.ForwardLink; Link != &Handle->Protocols; Link = Link->ForwardLink) {
-    Prot      = CR (Link, PROTOCOL_INTERFACE, Link, PROTOCOL_INTERFACE_SIGNATURE);
-    ProtEntry = Prot->Protocol;
-    if (CompareGuid (&ProtEntry->ProtocolID, Protocol)) {
+  Hash = SmmProtocolInterfaceHash (Handle, Protocol);
+  for (Entry = HashIndexGetFirst (&mProtocolInterfaceIndex, Hash);
+       Entry != NULL;
+       Entry = HashIndexGetNext (&mProtocolInterfaceIndex, Entry))
+  {
+    Prot = CR (Entry, PROTOCOL_INTERFACE, HashEntry, PROTOCOL_INTERFACE_SIGNATURE);
+    if ((Prot->Handle == Handle) && CompareGuid (&Prot->Protocol->ProtocolID, Protocol)) {
       return Prot;
     }
   }
@@ -55,6 +55,7 @@
 #include <Library/HobLib.h>
 #include <Library/SmmMemLib.h>
 #include <Library/SafeIntLib.h>
+#include <Library/HashIndexLib.h>
 
 #include "PiSmmCorePrivateData.h"
 #include "HeapGuard.h"
@@ -158,6 +159,13 @@ typedef struct {
 
 #define ASSERT_IS_HANDLE(a)  ASSERT((a)->Signature == EFI_HANDLE_SIGNATURE)
 
+//
+// Number of buckets in the hash indexes over the protocol database. Each
+// must be a power of two.
+//
+#define PROTOCOL_ENTRY_INDEX_BUCKET_COUNT      64
+#define PROTOCOL_INTERFACE_INDEX_BUCKET_COUNT  256
+
 #define PROTOCOL_ENTRY_SIGNATURE  SIGNATURE_32('s','p','t','e')
 
 ///
@@ -166,15 +174,17 @@ typedef struct {
 /// with a list of registered notifies.
 ///
 typedef struct {
-  UINTN         Signature;
+  UINTN               Signature;
   /// Link Entry inserted to mProtocolDatabase
-  LIST_ENTRY    AllEntries;
+  LIST_ENTRY          AllEntries;
   /// ID of the protocol
-  EFI_GUID      ProtocolID;
+  EFI_GUID            ProtocolID;
   /// All protocol interfaces
-  LIST_ENTRY    Protocols;
+  LIST_ENTRY          Protocols;
   /// Registered notification handlers
-  LIST_ENTRY    Notify;
+  LIST_ENTRY          Notify;
+  /// Link on mProtocolEntryIndex, keyed by ProtocolID
+  HASH_INDEX_ENTRY    HashEntry;
 } PROTOCOL_ENTRY;
 
 #define PROTOCOL_INTERFACE_SIGNATURE  SIGNATURE_32('s','p','i','f')
@@ -184,17 +194,19 @@ typedef struct {
 /// with a protocol interface structure
 ///
 typedef struct {
-  UINTN             Signature;
+  UINTN               Signature;
   /// Link on IHANDLE.Protocols
-  LIST_ENTRY        Link;
+  LIST_ENTRY          Link;
   /// Back pointer
-  IHANDLE           *Handle;
+  IHANDLE             *Handle;
   /// Link on PROTOCOL_ENTRY.Protocols
-  LIST_ENTRY        ByProtocol;
+  LIST_ENTRY          ByProtocol;
   /// The protocol ID
-  PROTOCOL_ENTRY    *Protocol;
+  PROTOCOL_ENTRY      *Protocol;
   /// The interface value
-  VOID              *Interface;
+  VOID                *Interface;
+  /// Link on mProtocolInterfaceIndex, keyed by Handle and protocol ID
+  HASH_INDEX_ENTRY    HashEntry;
 } PROTOCOL_INTERFACE;
 
 #define PROTOCOL_NOTIFY_SIGNATURE  SIGNATURE_32('s','p','t','n')
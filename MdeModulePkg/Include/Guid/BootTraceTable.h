@@ -0,0 +1,102 @@
+/** @file
+  Definitions of the boot trace table installed by the DXE core.
+
+  The DXE core records one entry for each image it starts and for each call
+  to the Start() function of a driver binding protocol. Entries are kept in a
+  ring buffer of fixed size, which is published in the EFI system table as a
+  configuration table so that it can be read by shell commands or dumped to a
+  file and rendered by host tools.
+
+  Entries nest, e.g. the entry point of an image may call ConnectController()
+  and so the Start() functions of other drivers. An entry is recorded when it
+  ends, after its nested entries, and holds its nesting depth. The duration
+  of an entry includes its nested entries and ChildDuration tells how much of
+  it they took. The protocol and allocation counters of an entry exclude its
+  nested entries, so that they can be summed over all the entries.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __BOOT_TRACE_TABLE_H__
+#define __BOOT_TRACE_TABLE_H__
+
+#define EDKII_BOOT_TRACE_TABLE_GUID \
+  { \
+    0xf868f3f6, 0x65c0, 0x4f16, { 0xbd, 0x21, 0x14, 0xd5, 0xca, 0x6e, 0xee, 0xd7 } \
+  }
+
+#define EDKII_BOOT_TRACE_TABLE_SIGNATURE  SIGNATURE_32 ('B', 'T', 'R', 'C')
+#define EDKII_BOOT_TRACE_TABLE_VERSION    2
+
+///
+/// The entry records the entry point of an image started with StartImage()
+///
+#define EDKII_BOOT_TRACE_TYPE_START_IMAGE  1
+///
+/// The entry records a call to EFI_DRIVER_BINDING_PROTOCOL.Start()
+///
+#define EDKII_BOOT_TRACE_TYPE_DRIVER_BINDING_START  2
+
+typedef struct {
+  UINT16      Type;
+  ///
+  /// Number of entries the entry is nested in, 0 for an outermost entry
+  ///
+  UINT16      Depth;
+  ///
+  /// Number of protocol interfaces installed by the entry, excluding its
+  /// nested entries
+  ///
+  UINT32      ProtocolInstallCount;
+  ///
+  /// File name GUID of the image, or zero if the image was not loaded from
+  /// a firmware volume
+  ///
+  EFI_GUID    ModuleName;
+  UINT64      Status;
+  ///
+  /// The controller handle passed to Start(), zero for images
+  ///
+  UINT64      ControllerHandle;
+  ///
+  /// Start time and duration in nanoseconds. The duration includes the
+  /// nested entries.
+  ///
+  UINT64      StartTime;
+  UINT64      Duration;
+  ///
+  /// Part of the duration spent in the nested entries, in nanoseconds. The
+  /// time spent in the entry itself is Duration - ChildDuration.
+  ///
+  UINT64      ChildDuration;
+  ///
+  /// Number of bytes of pages and pool allocated by the entry, excluding its
+  /// nested entries
+  ///
+  UINT64      AllocatedBytes;
+} EDKII_BOOT_TRACE_ENTRY;
+
+typedef struct {
+  UINT32    Signature;
+  UINT32    Version;
+  UINT32    HeaderSize;
+  UINT32    EntrySize;
+  ///
+  /// Number of entries of the ring buffer that follows the header
+  ///
+  UINT32    EntryCount;
+  UINT32    Reserved;
+  ///
+  /// Total number of entries recorded. The next entry is written at index
+  /// RecordCount % EntryCount, overwriting the oldest entry once
+  /// RecordCount exceeds EntryCount.
+  ///
+  UINT64    RecordCount;
+  // EDKII_BOOT_TRACE_ENTRY  Entry[EntryCount];
+} EDKII_BOOT_TRACE_TABLE;
+
+extern EFI_GUID  gEdkiiBootTraceTableGuid;
+
+#endif
@@ -0,0 +1,60 @@
+/** @file
+  Definitions of the HOBs through which the PEI core hands over the output of
+  the GUIDed sections it extracted, so that the DXE core can reuse it instead
+  of extracting the same sections again.
+
+  The output buffers are allocated in permanent memory and stay valid until
+  the end of the boot services. Sections are identified by their
+  SectionDefinitionGuid and by their address in the memory mapped firmware
+  volume, which the DXE core reads in place. A 64-bit hash of the section,
+  computed with HashIndexBuffer64(), makes sure that the section at that
+  address is still the one that was extracted.
+
+  Only sections without the EFI_GUIDED_SECTION_AUTH_STATUS_VALID attribute,
+  whose extraction returned an authentication status of 0, are handed over.
+  The DXE core extracts the other sections again to authenticate them.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __DECOMPRESSED_SECTION_CACHE_H__
+#define __DECOMPRESSED_SECTION_CACHE_H__
+
+#define EDKII_DECOMPRESSED_SECTION_CACHE_HOB_GUID \
+  { \
+    0xb212e561, 0x461c, 0x49f2, { 0xbf, 0x31, 0x94, 0xe5, 0x53, 0x9e, 0xa7, 0x10 } \
+  }
+
+///
+/// Data of each GUIDed HOB, describing one extracted section
+///
+typedef struct {
+  ///
+  /// SectionDefinitionGuid of the GUIDed section
+  ///
+  EFI_GUID                SectionDefinitionGuid;
+  ///
+  /// Address of the GUIDed section header in the firmware volume
+  ///
+  EFI_PHYSICAL_ADDRESS    SectionAddress;
+  ///
+  /// Size of the GUIDed section, including its header
+  ///
+  UINT32                  SectionSize;
+  ///
+  /// AuthenticationStatus returned by the extraction of the section, always 0
+  ///
+  UINT32                  AuthenticationStatus;
+  ///
+  /// HashIndexBuffer64() of the GUIDed section, including its header
+  ///
+  UINT64                  SectionHash;
+  EFI_PHYSICAL_ADDRESS    OutputBuffer;
+  UINT64                  OutputSize;
+} EDKII_DECOMPRESSED_SECTION_CACHE_ENTRY;
+
+extern EFI_GUID  gEdkiiDecompressedSectionCacheHobGuid;
+
+#endif
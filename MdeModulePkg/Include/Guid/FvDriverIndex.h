@@ -0,0 +1,105 @@
+/** @file
+  Definitions of the driver index file that the build tools can place into a
+  firmware volume.
+
+  The index is a FREEFORM file named EDKII_FV_DRIVER_INDEX_FILE_GUID holding a
+  single RAW section. It describes every other file of the firmware volume in
+  the order they appear in it, together with the DXE dependency expression and
+  the a priori position of each file, so that the DXE dispatcher can discover
+  the drivers of the firmware volume without walking the files and reading
+  their sections one by one.
+
+  The build tools place the index last in the firmware volume, protect it with
+  the FFS file checksum and record the header checksum of the firmware volume
+  and the integrity check of every file it lists. These can be checked against
+  the FFS file headers of the firmware volume without reading any file data.
+  An index that does not match the firmware volume it is found in is ignored.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __FV_DRIVER_INDEX_H__
+#define __FV_DRIVER_INDEX_H__
+
+#define EDKII_FV_DRIVER_INDEX_FILE_GUID \
+  { \
+    0x2c024061, 0x32f4, 0x4796, { 0xa9, 0x04, 0x49, 0x71, 0x59, 0x53, 0x38, 0xeb } \
+  }
+
+#define EDKII_FV_DRIVER_INDEX_SIGNATURE  SIGNATURE_32 ('F', 'V', 'D', 'I')
+#define EDKII_FV_DRIVER_INDEX_VERSION    3
+
+///
+/// The index starts with this header, followed by EntryCount entries of type
+/// EDKII_FV_DRIVER_INDEX_ENTRY and then by the dependency expressions they
+/// reference.
+///
+typedef struct {
+  UINT32    Signature;
+  UINT32    Version;
+  UINT32    EntryCount;
+  ///
+  /// The number of files in the a priori file of the firmware volume
+  ///
+  UINT32    AprioriCount;
+  ///
+  /// FvLength of the firmware volume the index was built for
+  ///
+  UINT64    FvLength;
+  ///
+  /// Offset of the index file from the start of the firmware volume
+  ///
+  UINT32    IndexFileOffset;
+  ///
+  /// Checksum field of the firmware volume header
+  ///
+  UINT16    FvHeaderChecksum;
+  UINT16    Reserved;
+} EDKII_FV_DRIVER_INDEX_HEADER;
+
+///
+/// DepexOffset and DepexSize describe the contents of the DXE_DEPEX section of
+/// the file.
+///
+#define EDKII_FV_DRIVER_INDEX_DXE_DEPEX  BIT0
+///
+/// The file has a SMM_DEPEX section.
+///
+#define EDKII_FV_DRIVER_INDEX_SMM_DEPEX  BIT1
+///
+/// The sections of the file are encapsulated, so the build tools could not
+/// tell whether it has any depex section. The sections must be read from the
+/// file itself.
+///
+#define EDKII_FV_DRIVER_INDEX_DEPEX_UNKNOWN  BIT2
+
+///
+/// AprioriIndex of a file that is not in the a priori file
+///
+#define EDKII_FV_DRIVER_INDEX_NOT_APRIORI  MAX_UINT32
+
+typedef struct {
+  EFI_GUID           FileName;
+  EFI_FV_FILETYPE    Type;
+  UINT8              Flags;
+  ///
+  /// IntegrityCheck field of the FFS file header in the firmware volume
+  ///
+  UINT16             IntegrityCheck;
+  ///
+  /// Position of the file in the a priori file of the firmware volume, or
+  /// EDKII_FV_DRIVER_INDEX_NOT_APRIORI
+  ///
+  UINT32             AprioriIndex;
+  ///
+  /// Offset of the DXE dependency expression from the start of the index
+  ///
+  UINT32             DepexOffset;
+  UINT32             DepexSize;
+} EDKII_FV_DRIVER_INDEX_ENTRY;
+
+extern EFI_GUID  gEdkiiFvDriverIndexFileGuid;
+
+#endif
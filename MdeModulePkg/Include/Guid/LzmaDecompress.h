@@ -23,7 +23,36 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define LZMAF86_CUSTOM_DECOMPRESS_GUID  \
   { 0xD42AE6BD, 0x1352, 0x4bfb, { 0x90, 0x9A, 0xCA, 0x72, 0xA6, 0xEA, 0xE8, 0x89 } }
 
+///
+/// The Global ID used to identify a section of an FFS file of type
+/// EFI_SECTION_GUID_DEFINED, whose contents have been split into blocks that
+/// are compressed independently using LZMA, so that they can be decompressed
+/// in parallel.
+///
+#define LZMA_CHUNKED_CUSTOM_DECOMPRESS_GUID  \
+  { 0x3aed380a, 0x1daf, 0x4b7e, { 0x91, 0x75, 0x7d, 0x7e, 0x4f, 0x42, 0x7a, 0x89 } }
+
+#define LZMA_CHUNKED_SIGNATURE  SIGNATURE_32 ('L', 'Z', 'M', 'C')
+
+///
+/// Header of the data of a LZMA_CHUNKED_CUSTOM_DECOMPRESS_GUID section.
+///
+/// The header is followed by an array of BlockCount + 1 UINT32 offsets,
+/// relative to the start of the header. Block N is the LZMA stream, including
+/// its own LZMA header, found between offsets N and N + 1. It decodes to
+/// BlockSize bytes at offset N * BlockSize of the output, except the last
+/// block which decodes to the remainder of DecodedSize.
+///
+typedef struct {
+  UINT32    Signature;
+  UINT32    BlockSize;
+  UINT32    DecodedSize;
+  UINT32    BlockCount;
+  // UINT32 BlockOffset[BlockCount + 1];
+} LZMA_CHUNKED_HEADER;
+
 extern GUID  gLzmaCustomDecompressGuid;
 extern GUID  gLzmaF86CustomDecompressGuid;
+extern GUID  gLzmaChunkedCustomDecompressGuid;
 
 #endif
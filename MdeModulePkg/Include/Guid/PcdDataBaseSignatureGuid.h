@@ -54,6 +54,27 @@ typedef struct  {
   UINT16    ExGuidIndex;        // Index of GuidTable in units of GUID.
 } DYNAMICEX_MAPPING;
 
+//
+// The ExMap hash table is a minimal perfect hash table of the DynamicEx PCDs,
+// with ExTokenCount entries. The entry at index
+// Hash (Guid, ExTokenNumber, 0) % ExTokenCount holds the displacement of the
+// bucket of a PCD. The displacement either is the index of the slot of the PCD
+// if PCD_EX_MAP_HASH_DIRECT is set, or the seed of Hash() that gives the index
+// of that slot. The entry at the index of the slot holds the index of the PCD
+// in ExMapTable.
+//
+// Hash() is the 32-bit FNV-1a hash of the token space GUID followed by the
+// token number, with an offset basis of 0x811C9DC5 XOR the seed, finalized
+// with the MurmurHash3 fmix32 function.
+//
+#define PCD_EX_MAP_HASH_DIRECT  0x80000000U
+
+typedef struct {
+  UINT32    Displacement;       // Displacement of the bucket.
+  UINT16    ExMapIndex;         // Index in ExMapTable of the PCD in the slot.
+  UINT16    Reserved;
+} DYNAMICEX_HASH_ENTRY;
+
 typedef struct {
   UINT32    StringIndex;        // Offset in String Table in units of UINT8.
   UINT32    DefaultValueOffset; // Offset of the Default Value.
@@ -93,10 +114,11 @@ typedef struct {
   TABLE_OFFSET    SizeTableOffset;
   TABLE_OFFSET    SkuIdTableOffset;
   TABLE_OFFSET    PcdNameTableOffset;
+  TABLE_OFFSET    ExMapHashTableOffset;         // Zero if the ExMap hash table is not generated.
   UINT16          LocalTokenCount;              // LOCAL_TOKEN_NUMBER for all.
   UINT16          ExTokenCount;                 // EX_TOKEN_NUMBER for DynamicEx.
   UINT16          GuidTableCount;               // The Number of Guid in GuidTable.
-  UINT8           Pad[6];                       // Pad bytes to satisfy the alignment.
+  UINT8           Pad[2];                       // Pad bytes to satisfy the alignment.
 
   //
   // Default initialized external PCD database binary structure
@@ -108,6 +130,7 @@ typedef struct {
   // UINT32                         ValueUint32[];
   // VPD_HEAD                       VpdHead[];               // VPD Offset
   // DYNAMICEX_MAPPING              ExMapTable[];            // DynamicEx PCD mapped to LocalIndex in LocalTokenNumberTable. It can be accessed by the ExMapTableOffset.
+  // DYNAMICEX_HASH_ENTRY           ExMapHashTable[];        // Perfect hash table of ExMapTable. It can be accessed by the ExMapHashTableOffset.
   // UINT32                         LocalTokenNumberTable[]; // Offset | DataType | PCD Type. It can be accessed by LocalTokenNumberTableOffset.
   // GUID                           GuidTable[];             // GUID for DynamicEx and HII PCD variable Guid. It can be accessed by the GuidTableOffset.
   // STRING_HEAD                    StringHead[];            // String PCD
@@ -77,6 +77,19 @@ typedef struct {
 // The payload for this function is SMM_VARIABLE_COMMUNICATE_GET_RUNTIME_CACHE_INFO
 //
 #define SMM_VARIABLE_FUNCTION_GET_RUNTIME_CACHE_INFO  14
+//
+// The payload for this function is SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH
+// followed by EntryCount records of SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE.
+//
+#define SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH  15
+//
+// The payload for this function is SMM_VARIABLE_COMMUNICATE_GET_NEXT_VARIABLE_BY_CURSOR.
+//
+#define SMM_VARIABLE_FUNCTION_GET_NEXT_VARIABLE_BY_CURSOR  16
+//
+// The payload for this function is SMM_VARIABLE_COMMUNICATE_GET_VARIABLE_RECORDS.
+//
+#define SMM_VARIABLE_FUNCTION_GET_VARIABLE_RECORDS  17
 
 ///
 /// Size of SMM communicate header, without including the payload.
@@ -138,6 +151,12 @@ typedef struct {
   VARIABLE_STORE_HEADER    *RuntimeHobCache;
   VARIABLE_STORE_HEADER    *RuntimeNvCache;
   VARIABLE_STORE_HEADER    *RuntimeVolatileCache;
+  //
+  // Optional, incremented when the variables of a store are moved. It is NULL,
+  // or missing from the payload of older callers, if the runtime caches are
+  // not indexed.
+  //
+  UINT32                   *StoreRewriteCount;
 } SMM_VARIABLE_COMMUNICATE_RUNTIME_VARIABLE_CACHE_CONTEXT;
 
 typedef struct {
@@ -147,4 +166,47 @@ typedef struct {
   BOOLEAN    AuthenticatedVariableUsage;
 } SMM_VARIABLE_COMMUNICATE_GET_RUNTIME_CACHE_INFO;
 
+///
+/// This structure is used to communicate with SMI handler by the variable batch
+/// protocol. Each record of the batch starts on a UINTN boundary. If a record
+/// fails, it and the records applied before it are undone, last one first,
+/// until an undo fails; AppliedCount returns the number of the first records
+/// that may remain applied, FailedIndex + 1 if the undo of the record that
+/// failed fails.
+///
+typedef struct {
+  UINTN    EntryCount;
+  UINTN    FailedIndex;        // Return index of the record that failed, or EntryCount
+  UINTN    AppliedCount;       // Return number of the first records that may remain applied
+} SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH;
+
+///
+/// Size of a record of SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH, including the
+/// padding to the next record.
+///
+#define SMM_VARIABLE_BATCH_RECORD_SIZE(NameSize, DataSize) \
+  ALIGN_VALUE (OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + (NameSize) + (DataSize), sizeof (UINTN))
+
+///
+/// This structure is used to communicate with SMI handler by GetNextVariableName
+/// of the variable enumeration protocol.
+///
+typedef struct {
+  UINT64      Cursor;       // Return cursor of the next variable
+  EFI_GUID    Guid;
+  UINTN       NameSize;     // Return name buffer size
+  UINT32      Attributes;
+  CHAR16      Name[1];
+} SMM_VARIABLE_COMMUNICATE_GET_NEXT_VARIABLE_BY_CURSOR;
+
+///
+/// This structure is used to communicate with SMI handler by GetVariableRecords
+/// of the variable enumeration protocol.
+///
+typedef struct {
+  UINT64    Cursor;         // Return cursor of the variable following the records
+  UINTN     RecordsSize;    // Return size of the records
+  UINT8     Records[1];
+} SMM_VARIABLE_COMMUNICATE_GET_VARIABLE_RECORDS;
+
 #endif // _SMM_VARIABLE_COMMON_H_
@@ -35,6 +35,11 @@ typedef struct {
   /// TRUE indicates all HOB variables have been flushed in flash.
   ///
   BOOLEAN    HobFlushComplete;
+  ///
+  /// Incremented whenever variables are moved within a variable store, e.g. by
+  /// a reclaim. Indexes of the runtime caches are rebuilt when it changes.
+  ///
+  UINT32     StoreRewriteCount;
 } CACHE_INFO_FLAG;
 
 typedef struct {
@@ -0,0 +1,54 @@
+/** @file
+  The MP dispatch library runs a procedure on all the enabled processors at
+  once, the calling boot processor included, so that they can share a work
+  queue.
+
+  The procedure runs on application processors, so it must not use any
+  service that is only available on the boot processor.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __MP_DISPATCH_LIB_H__
+#define __MP_DISPATCH_LIB_H__
+
+#include <Pi/PiMultiPhase.h>
+
+/**
+  Return the number of processors that MpDispatchRunOnAllProcessors() runs
+  the procedure on.
+
+  The number only changes when processors are enabled or disabled, or when
+  the services used to start the application processors are installed.
+
+  @return The number of processors, at least one.
+
+**/
+UINTN
+EFIAPI
+MpDispatchGetProcessorCount (
+  VOID
+  );
+
+/**
+  Run a procedure on all the enabled processors, the calling boot processor
+  included, and return when it has returned on all of them.
+
+  The boot processor runs the procedure while the application processors run
+  it, rather than waiting for them. If the application processors cannot be
+  started, the procedure is only run on the boot processor.
+
+  @param[in]      Procedure  The procedure to run.
+  @param[in, out] Argument   The argument passed to the procedure.
+
+**/
+VOID
+EFIAPI
+MpDispatchRunOnAllProcessors (
+  IN     EFI_AP_PROCEDURE  Procedure,
+  IN OUT VOID              *Argument  OPTIONAL
+  );
+
+#endif
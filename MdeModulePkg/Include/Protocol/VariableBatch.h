@@ -0,0 +1,106 @@
+/** @file
+  Variable Batch Protocol is related to EDK II-specific implementation of
+  variables and intended for use as a means to set several variables with a
+  single request to the variable driver.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __VARIABLE_BATCH_H__
+#define __VARIABLE_BATCH_H__
+
+#define EDKII_VARIABLE_BATCH_PROTOCOL_GUID \
+  { \
+    0xbb7c20cf, 0xba76, 0x4136, { 0x8e, 0x7c, 0x5a, 0xd8, 0x78, 0x60, 0x36, 0xfc } \
+  }
+
+#define EDKII_VARIABLE_BATCH_PROTOCOL_REVISION  0x00000001
+
+typedef struct _EDKII_VARIABLE_BATCH_PROTOCOL EDKII_VARIABLE_BATCH_PROTOCOL;
+
+///
+/// One variable update of a batch. The fields other than Status have the
+/// meaning of the parameters of SetVariable(), a DataSize of 0 deletes the
+/// variable.
+///
+typedef struct {
+  CHAR16        *VariableName;
+  EFI_GUID      *VendorGuid;
+  UINT32        Attributes;
+  UINTN         DataSize;
+  VOID          *Data;
+  ///
+  /// Returns the status of SetVariable() for this update, or EFI_NOT_STARTED
+  /// if the update is not applied because another update of the batch failed.
+  /// EFI_SUCCESS is returned for the updates that remain applied.
+  ///
+  EFI_STATUS    Status;
+} EDKII_VARIABLE_BATCH_ENTRY;
+
+/**
+  Set several variables in order with a single request to the variable driver.
+
+  The updates are applied in the order of Entries, with the checks of
+  SetVariable(). All the updates are checked, and the variable storage space
+  they and their undo need is reserved, before the first one is written. If an
+  update still fails when it is written, it and the updates written before it
+  are undone, last one first.
+
+  The rollback is best effort and is not reset-safe: each update and each undo
+  is a separate write of the variable storage, so a reset during the batch or
+  its rollback leaves the updates written so far, and an undo that fails stops
+  the rollback. EFI_ABORTED is returned when some updates may remain applied:
+  the Status of the entries before the one that failed is EFI_SUCCESS for the
+  updates that remain applied, and the entry that failed may hold either its
+  old or its new value.
+
+  A variable can be updated at most once by a batch. Authenticated variables,
+  the MOR variables and the language variables cannot be updated by a batch:
+  their update also updates other variables or state that an undo cannot
+  restore, such as the time stamp and the certificate database of
+  authenticated variables, the one-way MOR lock, and the language codes.
+
+  @param[in]      This          The EDKII_VARIABLE_BATCH_PROTOCOL instance.
+  @param[in]      EntryCount    Number of updates in Entries.
+  @param[in, out] Entries       The updates to apply. The Status field of each
+                                entry is updated on return.
+
+  @retval EFI_SUCCESS           All the updates were applied.
+  @retval EFI_INVALID_PARAMETER Entries is NULL and EntryCount is not 0.
+                                Or an entry has a NULL VariableName or VendorGuid,
+                                an empty VariableName, or a NULL Data and a DataSize
+                                that is not 0.
+                                Or two entries update the same variable.
+  @retval EFI_UNSUPPORTED       An entry updates a variable that cannot be
+                                updated by a batch.
+  @retval EFI_OUT_OF_RESOURCES  The updates do not fit in one request to the
+                                variable driver, or in the variable storage.
+  @retval EFI_ABORTED           An update failed and it or the updates written
+                                before it could not all be undone. The entries
+                                whose Status is EFI_SUCCESS remain applied.
+  @retval Others                The status of the update that failed. No update
+                                remains applied.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_VARIABLE_BATCH_PROTOCOL_SET_VARIABLES)(
+  IN     EDKII_VARIABLE_BATCH_PROTOCOL  *This,
+  IN     UINTN                          EntryCount,
+  IN OUT EDKII_VARIABLE_BATCH_ENTRY     *Entries
+  );
+
+///
+/// Variable Batch Protocol is related to EDK II-specific implementation of
+/// variables and intended for use as a means to set several variables with a
+/// single request to the variable driver.
+///
+struct _EDKII_VARIABLE_BATCH_PROTOCOL {
+  UINT64                                         Revision;
+  EDKII_VARIABLE_BATCH_PROTOCOL_SET_VARIABLES    SetVariables;
+};
+
+extern EFI_GUID  gEdkiiVariableBatchProtocolGuid;
+
+#endif
@@ -0,0 +1,124 @@
+/** @file
+  Variable Enumeration Protocol is related to EDK II-specific implementation of
+  variables and intended for use as a means to enumerate the variables in linear
+  time. The variable driver resumes an enumeration from an opaque cursor instead
+  of finding the previous variable by its name.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __VARIABLE_ENUMERATION_H__
+#define __VARIABLE_ENUMERATION_H__
+
+#define EDKII_VARIABLE_ENUMERATION_PROTOCOL_GUID \
+  { \
+    0x24b54f3c, 0x5e6a, 0x43e6, { 0xb9, 0x22, 0xf4, 0x16, 0x06, 0x7e, 0x2f, 0x9e } \
+  }
+
+#define EDKII_VARIABLE_ENUMERATION_PROTOCOL_REVISION  0x00000001
+
+///
+/// Cursor to start an enumeration from the first variable.
+///
+#define EDKII_VARIABLE_ENUMERATION_CURSOR_START  0
+
+typedef struct _EDKII_VARIABLE_ENUMERATION_PROTOCOL EDKII_VARIABLE_ENUMERATION_PROTOCOL;
+
+///
+/// Record of a variable returned by GetVariableRecords(). The Null-terminated
+/// name of the variable follows the record.
+///
+typedef struct {
+  ///
+  /// Size of the record, including the name and the padding that aligns the
+  /// next record on a UINT64 boundary.
+  ///
+  UINT32      RecordSize;
+  UINT32      Attributes;
+  UINT32      NameSize;
+  UINT32      DataSize;
+  EFI_GUID    VendorGuid;
+} EDKII_VARIABLE_ENUMERATION_RECORD;
+
+/**
+  Return the name and GUID of the variable at a cursor, and advance the cursor
+  to the next variable.
+
+  The variables are returned in the order of GetNextVariableName(). A cursor
+  may become invalid if the variable stores are reclaimed, in which case the
+  enumeration must be restarted.
+
+  @param[in]      This              The EDKII_VARIABLE_ENUMERATION_PROTOCOL instance.
+  @param[in, out] Cursor            On input, EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor
+                                    returned by this protocol. On output, the cursor of the next
+                                    variable if EFI_SUCCESS is returned.
+  @param[in, out] VariableNameSize  On input, the size of the VariableName buffer. On output, the
+                                    size of the name of the variable.
+  @param[out]     VariableName      Returns the Null-terminated name of the variable.
+  @param[out]     VendorGuid        Returns the vendor GUID of the variable.
+  @param[out]     Attributes        Returns the attributes of the variable. Optional.
+
+  @retval EFI_SUCCESS               The variable was returned and Cursor was advanced.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_BUFFER_TOO_SMALL      VariableNameSize is too small for the name. VariableNameSize
+                                    has been updated with the size needed, Cursor is unchanged.
+  @retval EFI_INVALID_PARAMETER     Cursor, VariableNameSize, VariableName or VendorGuid is NULL.
+                                    Or Cursor is not a cursor of the current variable stores.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_VARIABLE_ENUMERATION_PROTOCOL_GET_NEXT_VARIABLE_NAME)(
+  IN     EDKII_VARIABLE_ENUMERATION_PROTOCOL  *This,
+  IN OUT UINT64                               *Cursor,
+  IN OUT UINTN                                *VariableNameSize,
+  OUT    CHAR16                               *VariableName,
+  OUT    EFI_GUID                             *VendorGuid,
+  OUT    UINT32                               *Attributes OPTIONAL
+  );
+
+/**
+  Return packed EDKII_VARIABLE_ENUMERATION_RECORD records of the variables from
+  a cursor, as many as Buffer holds, and advance the cursor past them.
+
+  @param[in]      This              The EDKII_VARIABLE_ENUMERATION_PROTOCOL instance.
+  @param[in, out] Cursor            On input, EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor
+                                    returned by this protocol. On output, the cursor of the variable
+                                    following the last record if EFI_SUCCESS is returned.
+  @param[in, out] BufferSize        On input, the size of Buffer. On output, the size of the records
+                                    returned, or the size of the first record if EFI_BUFFER_TOO_SMALL
+                                    is returned.
+  @param[out]     Buffer            Returns the records, aligned on a UINT64 boundary.
+
+  @retval EFI_SUCCESS               At least one record was returned and Cursor was advanced.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_BUFFER_TOO_SMALL      Buffer cannot hold the first record. Cursor is unchanged.
+  @retval EFI_OUT_OF_RESOURCES      The first record is larger than the variable driver can return.
+                                    Cursor is unchanged.
+  @retval EFI_INVALID_PARAMETER     Cursor, BufferSize or Buffer is NULL.
+                                    Or Cursor is not a cursor of the current variable stores.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_VARIABLE_ENUMERATION_PROTOCOL_GET_VARIABLE_RECORDS)(
+  IN     EDKII_VARIABLE_ENUMERATION_PROTOCOL  *This,
+  IN OUT UINT64                               *Cursor,
+  IN OUT UINTN                                *BufferSize,
+  OUT    VOID                                 *Buffer
+  );
+
+///
+/// Variable Enumeration Protocol is related to EDK II-specific implementation of
+/// variables and intended for use as a means to enumerate the variables in linear
+/// time.
+///
+struct _EDKII_VARIABLE_ENUMERATION_PROTOCOL {
+  UINT64                                                        Revision;
+  EDKII_VARIABLE_ENUMERATION_PROTOCOL_GET_NEXT_VARIABLE_NAME    GetNextVariableName;
+  EDKII_VARIABLE_ENUMERATION_PROTOCOL_GET_VARIABLE_RECORDS      GetVariableRecords;
+};
+
+extern EFI_GUID  gEdkiiVariableEnumerationProtocolGuid;
+
+#endif
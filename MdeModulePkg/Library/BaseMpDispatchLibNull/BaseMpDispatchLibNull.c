@@ -0,0 +1,47 @@
+/** @file
+  Null instance of the MP dispatch library, which runs the procedure on the
+  calling processor only.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Library/DebugLib.h>
+#include <Library/MpDispatchLib.h>
+
+/**
+  Return the number of processors that MpDispatchRunOnAllProcessors() runs
+  the procedure on.
+
+  @return 1, the calling processor.
+
+**/
+UINTN
+EFIAPI
+MpDispatchGetProcessorCount (
+  VOID
+  )
+{
+  return 1;
+}
+
+/**
+  Run a procedure on the calling processor.
+
+  @param[in]      Procedure  The procedure to run.
+  @param[in, out] Argument   The argument passed to the procedure.
+
+**/
+VOID
+EFIAPI
+MpDispatchRunOnAllProcessors (
+  IN     EFI_AP_PROCEDURE  Procedure,
+  IN OUT VOID              *Argument  OPTIONAL
+  )
+{
+  ASSERT (Procedure != NULL);
+
+  Procedure (Argument);
+}
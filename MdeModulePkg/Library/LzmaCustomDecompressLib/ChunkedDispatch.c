@@ -0,0 +1,39 @@
+/** @file
+  Decode the blocks of a chunked LZMA section on the calling processor only.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "LzmaDecompressLibInternal.h"
+
+/**
+  Return the maximum number of processors that decode blocks of a chunked
+  section at the same time.
+
+  @return The number of processors, at least one.
+
+**/
+UINT32
+LzmaChunkedGetProcessorCount (
+  VOID
+  )
+{
+  return 1;
+}
+
+/**
+  Run LzmaChunkedDecodeBlocks() on the available processors until all the
+  blocks of a chunked section have been decoded.
+
+  @param  Context   The LZMA_CHUNKED_CONTEXT of the section.
+
+**/
+VOID
+LzmaChunkedDispatch (
+  IN OUT LZMA_CHUNKED_CONTEXT  *Context
+  )
+{
+  LzmaChunkedDecodeBlocks (Context);
+}
@@ -0,0 +1,420 @@
+/** @file
+  Chunked LZMA Decompress GUIDed Section Extraction Library.
+  The data of a chunked section is split into blocks that are compressed
+  independently, so that the blocks can be decoded by several processors at
+  the same time. It wraps the decoding of the blocks to GUIDed Section
+  Extraction interfaces and registers them into GUIDed handler table.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "LzmaDecompressLibInternal.h"
+#include <Library/SynchronizationLib.h>
+
+//
+// Size of the LZMA properties and decoded size found at the start of each block
+//
+#define LZMA_CHUNKED_BLOCK_HEADER_SIZE  (5 + 8)
+
+/**
+  Return the offset of a block of a chunked section.
+
+  @param  Header    The header of the chunked section.
+  @param  Index     The index of the block, BlockCount for the end of the
+                    last block.
+
+  @return The offset of the block relative to the start of Header.
+
+**/
+STATIC
+UINT32
+LzmaChunkedBlockOffset (
+  IN CONST LZMA_CHUNKED_HEADER  *Header,
+  IN UINT32                     Index
+  )
+{
+  return ReadUnaligned32 ((CONST UINT32 *)(Header + 1) + Index);
+}
+
+/**
+  Locate and check the header of a chunked section.
+
+  @param[in]  InputSection  A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] Header        The header of the chunked data.
+  @param[out] DataSize      The size of the chunked data, including the header.
+
+  @retval  RETURN_SUCCESS            The header was returned.
+  @retval  RETURN_INVALID_PARAMETER  The section is not a valid chunked section.
+
+**/
+STATIC
+RETURN_STATUS
+LzmaChunkedGetHeader (
+  IN  CONST VOID                 *InputSection,
+  OUT CONST LZMA_CHUNKED_HEADER  **Header,
+  OUT UINTN                      *DataSize
+  )
+{
+  CONST LZMA_CHUNKED_HEADER  *ChunkedHeader;
+  UINT64                     BlockCount;
+  UINT32                     Index;
+
+  if (IS_SECTION2 (InputSection)) {
+    if (!CompareGuid (
+           &gLzmaChunkedCustomDecompressGuid,
+           &(((EFI_GUID_DEFINED_SECTION2 *)InputSection)->SectionDefinitionGuid)
+           ))
+    {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    ChunkedHeader = (LZMA_CHUNKED_HEADER *)((UINT8 *)InputSection + ((EFI_GUID_DEFINED_SECTION2 *)InputSection)->DataOffset);
+    *DataSize     = SECTION2_SIZE (InputSection) - ((EFI_GUID_DEFINED_SECTION2 *)InputSection)->DataOffset;
+  } else {
+    if (!CompareGuid (
+           &gLzmaChunkedCustomDecompressGuid,
+           &(((EFI_GUID_DEFINED_SECTION *)InputSection)->SectionDefinitionGuid)
+           ))
+    {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    ChunkedHeader = (LZMA_CHUNKED_HEADER *)((UINT8 *)InputSection + ((EFI_GUID_DEFINED_SECTION *)InputSection)->DataOffset);
+    *DataSize     = SECTION_SIZE (InputSection) - ((EFI_GUID_DEFINED_SECTION *)InputSection)->DataOffset;
+  }
+
+  if ((*DataSize < sizeof (LZMA_CHUNKED_HEADER)) ||
+      (ReadUnaligned32 (&ChunkedHeader->Signature) != LZMA_CHUNKED_SIGNATURE) ||
+      (ReadUnaligned32 (&ChunkedHeader->BlockSize) == 0))
+  {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  BlockCount = DivU64x32 (
+                 (UINT64)ReadUnaligned32 (&ChunkedHeader->DecodedSize) + ReadUnaligned32 (&ChunkedHeader->BlockSize) - 1,
+                 ReadUnaligned32 (&ChunkedHeader->BlockSize)
+                 );
+  if ((BlockCount != ReadUnaligned32 (&ChunkedHeader->BlockCount)) ||
+      (sizeof (LZMA_CHUNKED_HEADER) + MultU64x32 (BlockCount + 1, sizeof (UINT32)) > *DataSize))
+  {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  //
+  // Every block must at least hold its LZMA header and lie within the data.
+  //
+  for (Index = 0; Index < (UINT32)BlockCount; Index++) {
+    if ((LzmaChunkedBlockOffset (ChunkedHeader, Index) > LzmaChunkedBlockOffset (ChunkedHeader, Index + 1)) ||
+        (LzmaChunkedBlockOffset (ChunkedHeader, Index + 1) - LzmaChunkedBlockOffset (ChunkedHeader, Index) < LZMA_CHUNKED_BLOCK_HEADER_SIZE) ||
+        (LzmaChunkedBlockOffset (ChunkedHeader, Index + 1) > *DataSize))
+    {
+      return RETURN_INVALID_PARAMETER;
+    }
+  }
+
+  *Header = ChunkedHeader;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Return the number of scratch buffers used to decode a chunked section, one
+  for each processor that takes part in the decoding. The number of processors
+  does not change between the GetInfo and the Decode calls made to extract one
+  section, so that the decoding never uses more scratch slots than
+  LzmaChunkedGuidedSectionGetInfo() reported.
+
+  @param  Header    The header of the chunked section.
+
+  @return The number of scratch buffers.
+
+**/
+STATIC
+UINT32
+LzmaChunkedGetScratchSlotCount (
+  IN CONST LZMA_CHUNKED_HEADER  *Header
+  )
+{
+  return MIN (LzmaChunkedGetProcessorCount (), ReadUnaligned32 (&Header->BlockCount));
+}
+
+/**
+  Decode one block of a chunked section.
+
+  @param  Context   The LZMA_CHUNKED_CONTEXT of the section.
+  @param  Index     The index of the block.
+  @param  Scratch   The scratch buffer of the calling processor.
+
+  @retval  RETURN_SUCCESS            The block was decoded.
+  @retval  RETURN_INVALID_PARAMETER  The block is corrupted.
+
+**/
+STATIC
+RETURN_STATUS
+LzmaChunkedDecodeBlock (
+  IN LZMA_CHUNKED_CONTEXT  *Context,
+  IN UINT32                Index,
+  IN VOID                  *Scratch
+  )
+{
+  CONST UINT8    *Block;
+  UINT32         BlockSize;
+  UINT32         BlockOffset;
+  UINT32         DecodedSize;
+  UINT32         ScratchSize;
+  RETURN_STATUS  Status;
+
+  BlockOffset = Index * ReadUnaligned32 (&Context->Header->BlockSize);
+  Block       = (CONST UINT8 *)Context->Header + LzmaChunkedBlockOffset (Context->Header, Index);
+  BlockSize   = LzmaChunkedBlockOffset (Context->Header, Index + 1) - LzmaChunkedBlockOffset (Context->Header, Index);
+
+  //
+  // The decoded size recorded in the block must match its place in the output.
+  //
+  Status = LzmaUefiDecompressGetInfo (Block, BlockSize, &DecodedSize, &ScratchSize);
+  if (RETURN_ERROR (Status) ||
+      (ScratchSize > Context->ScratchSize) ||
+      (DecodedSize != MIN (ReadUnaligned32 (&Context->Header->BlockSize), ReadUnaligned32 (&Context->Header->DecodedSize) - BlockOffset)))
+  {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  return LzmaUefiDecompress (Block, BlockSize, Context->Destination + BlockOffset, Scratch);
+}
+
+/**
+  Decode blocks of a chunked section until none is left. Each processor
+  running this function claims a scratch slot of its own, and returns
+  immediately if none is left.
+
+  This function runs on application processors, so it must not use any
+  service that is only available on the boot processor.
+
+  @param  Buffer    The LZMA_CHUNKED_CONTEXT of the section.
+
+**/
+VOID
+EFIAPI
+LzmaChunkedDecodeBlocks (
+  IN OUT VOID  *Buffer
+  )
+{
+  LZMA_CHUNKED_CONTEXT  *Context;
+  UINT32                Slot;
+  UINT32                Index;
+
+  Context = (LZMA_CHUNKED_CONTEXT *)Buffer;
+
+  Slot = InterlockedIncrement (&Context->NextSlot) - 1;
+  if (Slot >= Context->ScratchSlotCount) {
+    return;
+  }
+
+  while (TRUE) {
+    Index = InterlockedIncrement (&Context->NextBlock) - 1;
+    if (Index >= ReadUnaligned32 (&Context->Header->BlockCount)) {
+      break;
+    }
+
+    if (RETURN_ERROR (LzmaChunkedDecodeBlock (Context, Index, Context->Scratch + Slot * Context->ScratchSize))) {
+      InterlockedIncrement (&Context->FailedBlockCount);
+    }
+  }
+}
+
+/**
+  Examines a GUIDed section and returns the size of the decoded buffer and the
+  size of an scratch buffer required to actually decode the data in a GUIDed section.
+
+  Examines a GUIDed section specified by InputSection.
+  If GUID for InputSection does not match the GUID that this handler supports,
+  then RETURN_UNSUPPORTED is returned.
+  If the required information can not be retrieved from InputSection,
+  then RETURN_INVALID_PARAMETER is returned.
+  If the GUID of InputSection does match the GUID that this handler supports,
+  then the size required to hold the decoded buffer is returned in OututBufferSize,
+  the size of an optional scratch buffer is returned in ScratchSize, and the Attributes field
+  from EFI_GUID_DEFINED_SECTION header of InputSection is returned in SectionAttribute.
+
+  If InputSection is NULL, then ASSERT().
+  If OutputBufferSize is NULL, then ASSERT().
+  If ScratchBufferSize is NULL, then ASSERT().
+  If SectionAttribute is NULL, then ASSERT().
+
+
+  @param[in]  InputSection       A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBufferSize   A pointer to the size, in bytes, of an output buffer required
+                                 if the buffer specified by InputSection were decoded.
+  @param[out] ScratchBufferSize  A pointer to the size, in bytes, required as scratch space
+                                 if the buffer specified by InputSection were decoded.
+  @param[out] SectionAttribute   A pointer to the attributes of the GUIDed section. See the Attributes
+                                 field of EFI_GUID_DEFINED_SECTION in the PI Specification.
+
+  @retval  RETURN_SUCCESS            The information about InputSection was returned.
+  @retval  RETURN_UNSUPPORTED        The section specified by InputSection does not match the GUID this handler supports.
+  @retval  RETURN_INVALID_PARAMETER  The information can not be retrieved from the section specified by InputSection.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionGetInfo (
+  IN  CONST VOID  *InputSection,
+  OUT UINT32      *OutputBufferSize,
+  OUT UINT32      *ScratchBufferSize,
+  OUT UINT16      *SectionAttribute
+  )
+{
+  RETURN_STATUS              Status;
+  CONST LZMA_CHUNKED_HEADER  *Header;
+  UINTN                      DataSize;
+  UINT32                     DecodedSize;
+  UINT32                     ScratchSize;
+
+  ASSERT (InputSection != NULL);
+  ASSERT (OutputBufferSize != NULL);
+  ASSERT (ScratchBufferSize != NULL);
+  ASSERT (SectionAttribute != NULL);
+
+  Status = LzmaChunkedGetHeader (InputSection, &Header, &DataSize);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  if (IS_SECTION2 (InputSection)) {
+    *SectionAttribute = ((EFI_GUID_DEFINED_SECTION2 *)InputSection)->Attributes;
+  } else {
+    *SectionAttribute = ((EFI_GUID_DEFINED_SECTION *)InputSection)->Attributes;
+  }
+
+  *OutputBufferSize  = ReadUnaligned32 (&Header->DecodedSize);
+  *ScratchBufferSize = 0;
+  if (ReadUnaligned32 (&Header->BlockCount) == 0) {
+    return RETURN_SUCCESS;
+  }
+
+  //
+  // Every block needs the same scratch size, so the first one is used to get it.
+  //
+  Status = LzmaUefiDecompressGetInfo (
+             (CONST UINT8 *)Header + LzmaChunkedBlockOffset (Header, 0),
+             LzmaChunkedBlockOffset (Header, 1) - LzmaChunkedBlockOffset (Header, 0),
+             &DecodedSize,
+             &ScratchSize
+             );
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  *ScratchBufferSize = ScratchSize * LzmaChunkedGetScratchSlotCount (Header);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Decompress a chunked LZMA compressed GUIDed section into a caller allocated output buffer.
+
+  Decodes the GUIDed section specified by InputSection.
+  If GUID for InputSection does not match the GUID that this handler supports, then RETURN_UNSUPPORTED is returned.
+  If the data in InputSection can not be decoded, then RETURN_INVALID_PARAMETER is returned.
+  If the GUID of InputSection does match the GUID that this handler supports, then InputSection
+  is decoded into the buffer specified by OutputBuffer and the authentication status of this
+  decode operation is returned in AuthenticationStatus.  If the decoded buffer is identical to the
+  data in InputSection, then OutputBuffer is set to point at the data in InputSection.  Otherwise,
+  the decoded data will be placed in caller allocated buffer specified by OutputBuffer.
+
+  If InputSection is NULL, then ASSERT().
+  If OutputBuffer is NULL, then ASSERT().
+  If ScratchBuffer is NULL and this decode operation requires a scratch buffer, then ASSERT().
+  If AuthenticationStatus is NULL, then ASSERT().
+
+
+  @param[in]  InputSection  A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBuffer  A pointer to a buffer that contains the result of a decode operation.
+  @param[out] ScratchBuffer A caller allocated buffer that may be required by this function
+                            as a scratch buffer to perform the decode operation.
+  @param[out] AuthenticationStatus
+                            A pointer to the authentication status of the decoded output buffer.
+                            See the definition of authentication status in the EFI_PEI_GUIDED_SECTION_EXTRACTION_PPI
+                            section of the PI Specification. EFI_AUTH_STATUS_PLATFORM_OVERRIDE must
+                            never be set by this handler.
+
+  @retval  RETURN_SUCCESS            The buffer specified by InputSection was decoded.
+  @retval  RETURN_UNSUPPORTED        The section specified by InputSection does not match the GUID this handler supports.
+  @retval  RETURN_INVALID_PARAMETER  The section specified by InputSection can not be decoded.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionExtraction (
+  IN CONST  VOID    *InputSection,
+  OUT       VOID    **OutputBuffer,
+  OUT       VOID    *ScratchBuffer         OPTIONAL,
+  OUT       UINT32  *AuthenticationStatus
+  )
+{
+  RETURN_STATUS              Status;
+  CONST LZMA_CHUNKED_HEADER  *Header;
+  LZMA_CHUNKED_CONTEXT       Context;
+  UINT32                     DecodedSize;
+
+  ASSERT (OutputBuffer != NULL);
+  ASSERT (InputSection != NULL);
+
+  ZeroMem (&Context, sizeof (Context));
+  Status = LzmaChunkedGetHeader (InputSection, &Header, &Context.DataSize);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Authentication is set to Zero, which may be ignored.
+  //
+  *AuthenticationStatus = 0;
+
+  if (ReadUnaligned32 (&Header->BlockCount) == 0) {
+    return RETURN_SUCCESS;
+  }
+
+  Context.Header      = Header;
+  Context.Destination = *OutputBuffer;
+  Context.Scratch     = ScratchBuffer;
+  Status              = LzmaUefiDecompressGetInfo (
+                          (CONST UINT8 *)Header + LzmaChunkedBlockOffset (Header, 0),
+                          LzmaChunkedBlockOffset (Header, 1) - LzmaChunkedBlockOffset (Header, 0),
+                          &DecodedSize,
+                          &Context.ScratchSize
+                          );
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  Context.ScratchSlotCount = LzmaChunkedGetScratchSlotCount (Header);
+  ASSERT (ScratchBuffer != NULL);
+
+  LzmaChunkedDispatch (&Context);
+
+  if ((Context.FailedBlockCount != 0) || (Context.NextBlock < ReadUnaligned32 (&Header->BlockCount))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Register LzmaChunkedDecompress and LzmaChunkedDecompressGetInfo handlers with LzmaChunkedCustomDecompressGuid.
+
+  @retval  RETURN_SUCCESS            Register successfully.
+  @retval  RETURN_OUT_OF_RESOURCES   No enough memory to store this handler.
+**/
+EFI_STATUS
+EFIAPI
+LzmaChunkedDecompressLibConstructor (
+  VOID
+  )
+{
+  return ExtractGuidedSectionRegisterHandlers (
+           &gLzmaChunkedCustomDecompressGuid,
+           LzmaChunkedGuidedSectionGetInfo,
+           LzmaChunkedGuidedSectionExtraction
+           );
+}
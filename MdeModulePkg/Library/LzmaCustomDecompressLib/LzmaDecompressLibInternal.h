@@ -91,4 +91,62 @@ LzmaUefiDecompress (
   IN OUT VOID    *Scratch
   );
 
+///
+/// State shared by the processors decoding the blocks of a chunked section.
+///
+typedef struct {
+  CONST LZMA_CHUNKED_HEADER    *Header;
+  UINTN                        DataSize;
+  UINT8                        *Destination;
+  UINT8                        *Scratch;
+  UINT32                       ScratchSize;
+  UINT32                       ScratchSlotCount;
+  volatile UINT32              NextSlot;
+  volatile UINT32              NextBlock;
+  volatile UINT32              FailedBlockCount;
+} LZMA_CHUNKED_CONTEXT;
+
+/**
+  Decode blocks of a chunked section until none is left. Each processor
+  running this function claims a scratch slot of its own, and returns
+  immediately if none is left.
+
+  This function runs on application processors, so it must not use any
+  service that is only available on the boot processor.
+
+  @param  Buffer    The LZMA_CHUNKED_CONTEXT of the section.
+
+**/
+VOID
+EFIAPI
+LzmaChunkedDecodeBlocks (
+  IN OUT VOID  *Buffer
+  );
+
+/**
+  Return the maximum number of processors that decode blocks of a chunked
+  section at the same time. The size of the scratch buffer returned by
+  LzmaChunkedGuidedSectionGetInfo() depends on it, so it is a constant of the
+  library instance rather than the number of processors found at run time.
+
+  @return The number of processors, at least one.
+
+**/
+UINT32
+LzmaChunkedGetProcessorCount (
+  VOID
+  );
+
+/**
+  Run LzmaChunkedDecodeBlocks() on the available processors until all the
+  blocks of a chunked section have been decoded.
+
+  @param  Context   The LZMA_CHUNKED_CONTEXT of the section.
+
+**/
+VOID
+LzmaChunkedDispatch (
+  IN OUT LZMA_CHUNKED_CONTEXT  *Context
+  );
+
 #endif
@@ -0,0 +1,68 @@
+/** @file
+  Decode the blocks of a chunked LZMA section on all the enabled processors,
+  using the MP dispatch library.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "LzmaDecompressLibInternal.h"
+#include <Library/MpDispatchLib.h>
+#include <Library/PcdLib.h>
+
+/**
+  Return the maximum number of processors that decode blocks of a chunked
+  section at the same time.
+
+  This is the number of enabled processors, limited by
+  PcdLzmaChunkedDecodeProcessorCount unless it is 0. The number of enabled
+  processors only changes when the MP services are installed or processors
+  are enabled or disabled, which does not happen between the GetInfo and the
+  Decode calls made to extract one section. The processors started beyond
+  the number of scratch slots find none and return at once.
+
+  @return The number of processors, at least one.
+
+**/
+UINT32
+LzmaChunkedGetProcessorCount (
+  VOID
+  )
+{
+  UINTN  ProcessorCount;
+
+  ProcessorCount = MpDispatchGetProcessorCount ();
+  if (FixedPcdGet32 (PcdLzmaChunkedDecodeProcessorCount) != 0) {
+    ProcessorCount = MIN (ProcessorCount, FixedPcdGet32 (PcdLzmaChunkedDecodeProcessorCount));
+  }
+
+  return (UINT32)MAX (MIN (ProcessorCount, MAX_UINT32), 1);
+}
+
+/**
+  Run LzmaChunkedDecodeBlocks() on the available processors until all the
+  blocks of a chunked section have been decoded.
+
+  @param  Context   The LZMA_CHUNKED_CONTEXT of the section.
+
+**/
+VOID
+LzmaChunkedDispatch (
+  IN OUT LZMA_CHUNKED_CONTEXT  *Context
+  )
+{
+  //
+  // The BSP takes blocks from the same counter as the APs while they run.
+  //
+  if (Context->ScratchSlotCount > 1) {
+    MpDispatchRunOnAllProcessors (LzmaChunkedDecodeBlocks, Context);
+  }
+
+  //
+  // All the processors have returned, so their scratch slots can be reused.
+  // The BSP decodes whatever is left, or every block if it did not take part.
+  //
+  Context->NextSlot = 0;
+  LzmaChunkedDecodeBlocks (Context);
+}
@@ -0,0 +1,626 @@
+/** @file
+  Host based unit tests of the chunked LZMA GUIDed section extraction.
+
+  The test section holds 5 blocks of 1 KB, compressed with
+  "LzmaCompress -e --chunked --block-size 1024" from the data returned by
+  TestPattern(). The dispatch of the blocks to the processors is replaced by
+  the stubs below, which decode every block with the last scratch slot, so
+  that a scratch buffer smaller than the slots in use is detected.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../LzmaDecompressLibInternal.h"
+
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_APP_NAME     "Chunked LZMA Section Extraction Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_BLOCK_COUNT     5
+#define TEST_DECODED_SIZE    (4 * 1024 + 300)
+#define TEST_GUARD_SIZE      64
+#define TEST_GUARD_PATTERN   0x5A
+
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionGetInfo (
+  IN  CONST VOID  *InputSection,
+  OUT UINT32      *OutputBufferSize,
+  OUT UINT32      *ScratchBufferSize,
+  OUT UINT16      *SectionAttribute
+  );
+
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionExtraction (
+  IN CONST  VOID    *InputSection,
+  OUT       VOID    **OutputBuffer,
+  OUT       VOID    *ScratchBuffer         OPTIONAL,
+  OUT       UINT32  *AuthenticationStatus
+  );
+
+typedef struct {
+  EFI_GUID_DEFINED_SECTION    *Section;
+  UINTN                       SectionSize;
+  UINT8                       *Output;
+  UINT8                       *Scratch;
+  UINT32                      BlockScratchSize;
+} TEST_CONTEXT;
+
+//
+// Data of the test section, made of a LZMA_CHUNKED_HEADER, 6 block offsets and
+// 5 LZMA streams
+//
+STATIC CONST UINT8  mTestChunkedData[] = {
+  0x4c, 0x5a, 0x4d, 0x43, 0x00, 0x04, 0x00, 0x00, 0x2c, 0x11, 0x00, 0x00,
+  0x05, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00, 0xb0, 0x00, 0x00, 0x00,
+  0x38, 0x01, 0x00, 0x00, 0xc0, 0x01, 0x00, 0x00, 0x48, 0x02, 0x00, 0x00,
+  0xb0, 0x02, 0x00, 0x00, 0x5d, 0x00, 0x10, 0x00, 0x00, 0x00, 0x04, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x09, 0xc2, 0x20, 0x02, 0xd3,
+  0x6f, 0x1d, 0x1b, 0x6b, 0xa7, 0x94, 0xe6, 0x18, 0x1c, 0xd0, 0x80, 0x35,
+  0x69, 0x4a, 0xd0, 0xc2, 0x06, 0x6e, 0xe4, 0x2c, 0x71, 0x17, 0xe8, 0x75,
+  0xb8, 0x1c, 0xe1, 0x65, 0x26, 0xb5, 0x17, 0x86, 0x6d, 0x17, 0x7f, 0x4e,
+  0x69, 0x14, 0xc8, 0xdf, 0x8a, 0x5b, 0x93, 0x76, 0x52, 0xbd, 0x2e, 0xa5,
+  0x95, 0xb5, 0xc2, 0x0a, 0xee, 0x33, 0x69, 0x1e, 0x1d, 0x64, 0x73, 0xa7,
+  0xb7, 0x7f, 0x76, 0xa2, 0x2f, 0xaf, 0x42, 0xbe, 0x1a, 0x74, 0xb1, 0x6e,
+  0xd3, 0x51, 0x55, 0x75, 0x82, 0xc4, 0xfc, 0x4b, 0x50, 0xfe, 0x6b, 0xcd,
+  0xda, 0x48, 0x87, 0x81, 0x02, 0x37, 0x01, 0xea, 0x9e, 0x4f, 0x20, 0x47,
+  0xf8, 0x53, 0x4a, 0x14, 0x8b, 0xd5, 0x3a, 0x60, 0xab, 0x75, 0x3a, 0xf4,
+  0x36, 0x38, 0x30, 0x7e, 0xf3, 0x5f, 0x5d, 0x80, 0x5d, 0x00, 0x10, 0x00,
+  0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x11,
+  0xc6, 0x01, 0x18, 0x72, 0x1c, 0xef, 0xc6, 0xd8, 0x2a, 0xa1, 0x14, 0xd4,
+  0xc7, 0xb4, 0xe1, 0x25, 0x82, 0xe5, 0xf8, 0xf2, 0xb6, 0x8e, 0x06, 0x77,
+  0x7c, 0xba, 0x58, 0x55, 0x67, 0x62, 0xca, 0xb1, 0x21, 0x71, 0x42, 0x5f,
+  0xf9, 0x08, 0x17, 0xb2, 0x79, 0xef, 0x7f, 0x04, 0xe4, 0x3c, 0x29, 0x96,
+  0x48, 0xe9, 0xd8, 0xec, 0xc7, 0x1c, 0xba, 0x82, 0xca, 0x72, 0xab, 0x4b,
+  0x3a, 0xf0, 0x18, 0x3e, 0x40, 0x4f, 0x1c, 0x66, 0xe3, 0xf2, 0x3f, 0xc9,
+  0x46, 0x35, 0x3b, 0xde, 0x0a, 0x73, 0x6b, 0xde, 0xd9, 0x04, 0x16, 0x9d,
+  0x51, 0x2e, 0x12, 0xe8, 0xae, 0x46, 0x91, 0xf3, 0x4e, 0x3e, 0xb1, 0x85,
+  0xc6, 0x50, 0x8b, 0x9b, 0x79, 0xe5, 0x79, 0x06, 0xc2, 0x84, 0xe1, 0x3f,
+  0x88, 0x46, 0xea, 0xb8, 0x4a, 0xce, 0xcf, 0x2e, 0xda, 0xf7, 0x65, 0x53,
+  0x5d, 0x00, 0x10, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x10, 0x09, 0xc2, 0x20, 0x02, 0xd3, 0x6f, 0x1d, 0x1b, 0x6b,
+  0xa7, 0x94, 0xe6, 0x18, 0x1c, 0xd0, 0x80, 0x35, 0x69, 0x4a, 0xd0, 0xc2,
+  0x06, 0x6e, 0xe4, 0x2c, 0x71, 0x17, 0xe8, 0x75, 0xb8, 0x1c, 0xe1, 0x65,
+  0x26, 0xb5, 0x17, 0x86, 0x6d, 0x17, 0x7f, 0x4e, 0x69, 0x14, 0xc8, 0xdf,
+  0x8a, 0x5b, 0x93, 0x76, 0x52, 0xbd, 0x2e, 0xa5, 0x95, 0xb5, 0xc2, 0x0a,
+  0xee, 0x33, 0x69, 0x1e, 0x1d, 0x64, 0x73, 0xa7, 0xb7, 0x7f, 0x76, 0xa2,
+  0x2f, 0xaf, 0x42, 0xbe, 0x1a, 0x74, 0xb1, 0x6e, 0xd3, 0x51, 0x55, 0x75,
+  0x82, 0xc4, 0xfc, 0x4b, 0x50, 0xfe, 0x6b, 0xcd, 0xda, 0x48, 0x87, 0x81,
+  0x02, 0x37, 0x01, 0xea, 0x9e, 0x4f, 0x20, 0x47, 0xf8, 0x53, 0x4a, 0x14,
+  0x8b, 0xd5, 0x3a, 0x60, 0xab, 0x75, 0x3a, 0xf4, 0x36, 0x38, 0x30, 0x7e,
+  0xf3, 0x5f, 0x5d, 0x80, 0x5d, 0x00, 0x10, 0x00, 0x00, 0x00, 0x04, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x11, 0xc6, 0x01, 0x18, 0x72,
+  0x1c, 0xef, 0xc6, 0xd8, 0x2a, 0xa1, 0x14, 0xd4, 0xc7, 0xb4, 0xe1, 0x25,
+  0x82, 0xe5, 0xf8, 0xf2, 0xb6, 0x8e, 0x06, 0x77, 0x7c, 0xba, 0x58, 0x55,
+  0x67, 0x62, 0xca, 0xb1, 0x21, 0x71, 0x42, 0x5f, 0xf9, 0x08, 0x17, 0xb2,
+  0x79, 0xef, 0x7f, 0x04, 0xe4, 0x3c, 0x29, 0x96, 0x48, 0xe9, 0xd8, 0xec,
+  0xc7, 0x1c, 0xba, 0x82, 0xca, 0x72, 0xab, 0x4b, 0x3a, 0xf0, 0x18, 0x3e,
+  0x40, 0x4f, 0x1c, 0x66, 0xe3, 0xf2, 0x3f, 0xc9, 0x46, 0x35, 0x3b, 0xde,
+  0x0a, 0x73, 0x6b, 0xde, 0xd9, 0x04, 0x16, 0x9d, 0x51, 0x2e, 0x12, 0xe8,
+  0xae, 0x46, 0x91, 0xf3, 0x4e, 0x3e, 0xb1, 0x85, 0xc6, 0x50, 0x8b, 0x9b,
+  0x79, 0xe5, 0x79, 0x06, 0xc2, 0x84, 0xe1, 0x3f, 0x88, 0x46, 0xea, 0xb8,
+  0x4a, 0xce, 0xcf, 0x2e, 0xda, 0xf7, 0x65, 0x53, 0x5d, 0x00, 0x10, 0x00,
+  0x00, 0x2c, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x09,
+  0xc2, 0x20, 0x02, 0xd3, 0x6f, 0x1d, 0x1b, 0x6b, 0xa7, 0x94, 0xe6, 0x18,
+  0x1c, 0xd0, 0x80, 0x35, 0x69, 0x4a, 0xd0, 0xc2, 0x06, 0x6e, 0xe4, 0x2c,
+  0x71, 0x17, 0xe8, 0x75, 0xb8, 0x1c, 0xe1, 0x65, 0x26, 0xb5, 0x17, 0x86,
+  0x6d, 0x17, 0x7f, 0x4e, 0x69, 0x14, 0xc8, 0xdf, 0x8a, 0x5b, 0x93, 0x76,
+  0x52, 0xbd, 0x2e, 0xa5, 0x95, 0xb5, 0xc2, 0x0a, 0xee, 0x33, 0x69, 0x1e,
+  0x1d, 0x64, 0x73, 0xa7, 0xb7, 0x7f, 0x76, 0xa2, 0x2f, 0xaf, 0x42, 0xbe,
+  0x1a, 0x74, 0xb1, 0x6e, 0xd3, 0x51, 0x55, 0x75, 0x82, 0xc4, 0xfc, 0x46,
+  0xaf, 0x1a, 0x52, 0x00,
+};
+
+STATIC UINT32   mTestProcessorCount;
+STATIC BOOLEAN  mTestExtraProcessorDecoded;
+
+/**
+  Stub of ExtractGuidedSectionRegisterHandlers() for the library constructor.
+
+  @retval RETURN_SUCCESS   Always.
+
+**/
+RETURN_STATUS
+EFIAPI
+ExtractGuidedSectionRegisterHandlers (
+  IN CONST GUID                               *SectionGuid,
+  IN EXTRACT_GUIDED_SECTION_GET_INFO_HANDLER  GetInfoHandler,
+  IN EXTRACT_GUIDED_SECTION_DECODE_HANDLER    DecodeHandler
+  )
+{
+  return RETURN_SUCCESS;
+}
+
+/**
+  Return the number of processors set by the test.
+
+  @return The number of processors.
+
+**/
+UINT32
+LzmaChunkedGetProcessorCount (
+  VOID
+  )
+{
+  return mTestProcessorCount;
+}
+
+/**
+  Run LzmaChunkedDecodeBlocks() for a processor that finds no scratch slot,
+  then for the processor that claims the last scratch slot.
+
+  @param  Context   The LZMA_CHUNKED_CONTEXT of the section.
+
+**/
+VOID
+LzmaChunkedDispatch (
+  IN OUT LZMA_CHUNKED_CONTEXT  *Context
+  )
+{
+  Context->NextSlot = Context->ScratchSlotCount;
+  LzmaChunkedDecodeBlocks (Context);
+  mTestExtraProcessorDecoded = (BOOLEAN)(Context->NextBlock != 0);
+
+  Context->NextSlot = Context->ScratchSlotCount - 1;
+  LzmaChunkedDecodeBlocks (Context);
+}
+
+/**
+  Return byte Index of the data the test section was compressed from.
+
+  @param  Index   The offset of the byte.
+
+  @return The byte.
+
+**/
+STATIC
+UINT8
+TestPattern (
+  IN UINTN  Index
+  )
+{
+  return (UINT8)(((Index * 7 + (Index >> 5)) & 0x3F) + 0x20);
+}
+
+/**
+  Return a pointer to a block offset of the test section.
+
+  @param  Context   The test context.
+  @param  Index     The index of the offset.
+
+  @return The offset.
+
+**/
+STATIC
+UINT32 *
+TestBlockOffset (
+  IN TEST_CONTEXT  *Context,
+  IN UINTN         Index
+  )
+{
+  return (UINT32 *)((LZMA_CHUNKED_HEADER *)(Context->Section + 1) + 1) + Index;
+}
+
+/**
+  Get the sizes of the test section, then decode it into a buffer and a
+  scratch buffer of exactly these sizes, followed by guard bytes.
+
+  @param  Context           The test context.
+  @param  ScratchSize       Returns the size of the scratch buffer.
+
+  @retval RETURN_SUCCESS    The section was decoded.
+  @retval others            The section could not be decoded.
+
+**/
+STATIC
+RETURN_STATUS
+TestExtract (
+  IN  TEST_CONTEXT  *Context,
+  OUT UINT32        *ScratchSize
+  )
+{
+  RETURN_STATUS  Status;
+  UINT32         OutputSize;
+  UINT16         SectionAttribute;
+  UINT32         AuthenticationStatus;
+  VOID           *Output;
+
+  Status = LzmaChunkedGuidedSectionGetInfo (Context->Section, &OutputSize, ScratchSize, &SectionAttribute);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  if (OutputSize != TEST_DECODED_SIZE) {
+    return RETURN_BAD_BUFFER_SIZE;
+  }
+
+  Context->Output  = AllocatePool (OutputSize + TEST_GUARD_SIZE);
+  Context->Scratch = AllocatePool (*ScratchSize + TEST_GUARD_SIZE);
+  if ((Context->Output == NULL) || (Context->Scratch == NULL)) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  SetMem (Context->Output, OutputSize + TEST_GUARD_SIZE, TEST_GUARD_PATTERN);
+  SetMem (Context->Scratch, *ScratchSize + TEST_GUARD_SIZE, TEST_GUARD_PATTERN);
+
+  mTestExtraProcessorDecoded = FALSE;
+  Output                     = Context->Output;
+  return LzmaChunkedGuidedSectionExtraction (Context->Section, &Output, Context->Scratch, &AuthenticationStatus);
+}
+
+/**
+  Check that the guard bytes after a buffer are untouched.
+
+  @param  Buffer    The buffer.
+  @param  Size      The size of the buffer, without the guard bytes.
+
+  @retval TRUE      The guard bytes are untouched.
+  @retval FALSE     The guard bytes were overwritten.
+
+**/
+STATIC
+BOOLEAN
+TestGuardIntact (
+  IN UINT8  *Buffer,
+  IN UINTN  Size
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < TEST_GUARD_SIZE; Index++) {
+    if (Buffer[Size + Index] != TEST_GUARD_PATTERN) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Build the GUIDed section of the test from mTestChunkedData.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED                The section was built.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The section could not be built.
+
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LzmaChunkedTestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT   *TestContext;
+  UINT32         DecodedSize;
+  RETURN_STATUS  Status;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  if (TestContext->Section == NULL) {
+    TestContext->SectionSize = sizeof (EFI_GUID_DEFINED_SECTION) + sizeof (mTestChunkedData);
+    TestContext->Section     = AllocatePool (TestContext->SectionSize);
+    if (TestContext->Section == NULL) {
+      return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+    }
+  }
+
+  if (TestContext->Output != NULL) {
+    FreePool (TestContext->Output);
+    TestContext->Output = NULL;
+  }
+
+  if (TestContext->Scratch != NULL) {
+    FreePool (TestContext->Scratch);
+    TestContext->Scratch = NULL;
+  }
+
+  TestContext->Section->CommonHeader.Size[0] = (UINT8)TestContext->SectionSize;
+  TestContext->Section->CommonHeader.Size[1] = (UINT8)(TestContext->SectionSize >> 8);
+  TestContext->Section->CommonHeader.Size[2] = (UINT8)(TestContext->SectionSize >> 16);
+  TestContext->Section->CommonHeader.Type    = EFI_SECTION_GUID_DEFINED;
+  CopyGuid (&TestContext->Section->SectionDefinitionGuid, &gLzmaChunkedCustomDecompressGuid);
+  TestContext->Section->DataOffset = sizeof (EFI_GUID_DEFINED_SECTION);
+  TestContext->Section->Attributes = EFI_GUIDED_SECTION_PROCESSING_REQUIRED;
+  CopyMem (TestContext->Section + 1, mTestChunkedData, sizeof (mTestChunkedData));
+
+  Status = LzmaUefiDecompressGetInfo (
+             (UINT8 *)(TestContext->Section + 1) + *TestBlockOffset (TestContext, 0),
+             *TestBlockOffset (TestContext, 1) - *TestBlockOffset (TestContext, 0),
+             &DecodedSize,
+             &TestContext->BlockScratchSize
+             );
+  if (RETURN_ERROR (Status)) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  mTestProcessorCount = 1;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Decode the test section with one scratch slot.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED                The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED     The test failed.
+
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+DecodeOnOneProcessor (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINT32        ScratchSize;
+  UINTN         Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  UT_ASSERT_NOT_EFI_ERROR (TestExtract (TestContext, &ScratchSize));
+  UT_ASSERT_EQUAL (ScratchSize, TestContext->BlockScratchSize);
+  UT_ASSERT_FALSE (mTestExtraProcessorDecoded);
+
+  for (Index = 0; Index < TEST_DECODED_SIZE; Index++) {
+    UT_ASSERT_EQUAL (TestContext->Output[Index], TestPattern (Index));
+  }
+
+  UT_ASSERT_TRUE (TestGuardIntact (TestContext->Output, TEST_DECODED_SIZE));
+  UT_ASSERT_TRUE (TestGuardIntact (TestContext->Scratch, ScratchSize));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Decode the test section with as many scratch slots as processors, up to the
+  number of blocks, and check that the scratch buffer reported by GetInfo
+  holds every slot used by the decoding.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED                The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED     The test failed.
+
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ScratchSlotsMatchGetInfo (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST UINT32  ProcessorCounts[] = { 2, 4, TEST_BLOCK_COUNT, 8, 64 };
+  TEST_CONTEXT         *TestContext;
+  UINT32               ScratchSize;
+  UINTN                Count;
+  UINTN                Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  for (Count = 0; Count < ARRAY_SIZE (ProcessorCounts); Count++) {
+    UT_ASSERT_EQUAL (LzmaChunkedTestSetup (Context), UNIT_TEST_PASSED);
+    mTestProcessorCount = ProcessorCounts[Count];
+
+    UT_ASSERT_NOT_EFI_ERROR (TestExtract (TestContext, &ScratchSize));
+    UT_ASSERT_EQUAL (ScratchSize, TestContext->BlockScratchSize * MIN (ProcessorCounts[Count], TEST_BLOCK_COUNT));
+    UT_ASSERT_FALSE (mTestExtraProcessorDecoded);
+
+    for (Index = 0; Index < TEST_DECODED_SIZE; Index++) {
+      UT_ASSERT_EQUAL (TestContext->Output[Index], TestPattern (Index));
+    }
+
+    UT_ASSERT_TRUE (TestGuardIntact (TestContext->Output, TEST_DECODED_SIZE));
+    UT_ASSERT_TRUE (TestGuardIntact (TestContext->Scratch, ScratchSize));
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that a block whose LZMA header records the wrong decoded size is
+  rejected.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED                The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED     The test failed.
+
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+CorruptedBlockIsRejected (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINT32        ScratchSize;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  //
+  // The decoded size follows the 5 bytes of LZMA properties.
+  //
+  ((UINT8 *)(TestContext->Section + 1))[*TestBlockOffset (TestContext, 2) + 5] ^= 0x01;
+  mTestProcessorCount = 2;
+
+  UT_ASSERT_STATUS_EQUAL (TestExtract (TestContext, &ScratchSize), RETURN_INVALID_PARAMETER);
+  UT_ASSERT_TRUE (TestGuardIntact (TestContext->Output, TEST_DECODED_SIZE));
+  UT_ASSERT_TRUE (TestGuardIntact (TestContext->Scratch, ScratchSize));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that sections whose header or block offsets do not describe the data
+  are rejected by GetInfo.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED                The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED     The test failed.
+
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+InvalidHeaderIsRejected (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT         *TestContext;
+  LZMA_CHUNKED_HEADER  *Header;
+  UINT32               OutputSize;
+  UINT32               ScratchSize;
+  UINT16               SectionAttribute;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Header      = (LZMA_CHUNKED_HEADER *)(TestContext->Section + 1);
+
+  Header->BlockCount = TEST_BLOCK_COUNT + 1;
+  UT_ASSERT_STATUS_EQUAL (
+    LzmaChunkedGuidedSectionGetInfo (TestContext->Section, &OutputSize, &ScratchSize, &SectionAttribute),
+    RETURN_INVALID_PARAMETER
+    );
+
+  UT_ASSERT_EQUAL (LzmaChunkedTestSetup (Context), UNIT_TEST_PASSED);
+  *TestBlockOffset (TestContext, 2) = *TestBlockOffset (TestContext, 3) + 1;
+  UT_ASSERT_STATUS_EQUAL (
+    LzmaChunkedGuidedSectionGetInfo (TestContext->Section, &OutputSize, &ScratchSize, &SectionAttribute),
+    RETURN_INVALID_PARAMETER
+    );
+
+  UT_ASSERT_EQUAL (LzmaChunkedTestSetup (Context), UNIT_TEST_PASSED);
+  *TestBlockOffset (TestContext, TEST_BLOCK_COUNT) = (UINT32)sizeof (mTestChunkedData) + 1;
+  UT_ASSERT_STATUS_EQUAL (
+    LzmaChunkedGuidedSectionGetInfo (TestContext->Section, &OutputSize, &ScratchSize, &SectionAttribute),
+    RETURN_INVALID_PARAMETER
+    );
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the chunked
+  LZMA section extraction and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      LzmaChunkedTests;
+  TEST_CONTEXT                *TestContext;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  TestContext = AllocateZeroPool (sizeof (TEST_CONTEXT));
+  if (TestContext == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the chunked LZMA Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&LzmaChunkedTests, Framework, "Chunked LZMA Section Tests", "LzmaChunked", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Chunked LZMA Section Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite-----------Description-------------------------------------Name-------------Function-------------------Pre-------------------Post---Context-----
+  //
+  AddTestCase (LzmaChunkedTests, "Decode on one processor", "OneProcessor", DecodeOnOneProcessor, LzmaChunkedTestSetup, NULL, TestContext);
+  AddTestCase (LzmaChunkedTests, "Scratch slots match GetInfo", "ScratchSlots", ScratchSlotsMatchGetInfo, LzmaChunkedTestSetup, NULL, TestContext);
+  AddTestCase (LzmaChunkedTests, "Corrupted block is rejected", "CorruptedBlock", CorruptedBlockIsRejected, LzmaChunkedTestSetup, NULL, TestContext);
+  AddTestCase (LzmaChunkedTests, "Invalid header is rejected", "InvalidHeader", InvalidHeaderIsRejected, LzmaChunkedTestSetup, NULL, TestContext);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  if (TestContext != NULL) {
+    if (TestContext->Section != NULL) {
+      FreePool (TestContext->Section);
+    }
+
+    if (TestContext->Output != NULL) {
+      FreePool (TestContext->Output);
+    }
+
+    if (TestContext->Scratch != NULL) {
+      FreePool (TestContext->Scratch);
+    }
+
+    FreePool (TestContext);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define LzmaChunkedUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+LzmaChunkedUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
@@ -186,6 +186,8 @@ DiskIoDriverBindingStart (
     goto ErrorExit;
   }
 
+  DiskIoCacheInitialize (Instance);
+
   //
   // Install protocol interfaces for the Disk IO device.
   //
@@ -209,6 +211,10 @@ DiskIoDriverBindingStart (
 
 ErrorExit:
   if (EFI_ERROR (Status)) {
+    if (Instance != NULL) {
+      DiskIoCacheFree (Instance);
+    }
+
     if ((Instance != NULL) && (Instance->SharedWorkingBuffer != NULL)) {
       FreeAlignedPages (
         Instance->SharedWorkingBuffer,
@@ -325,6 +331,16 @@ DiskIoDriverBindingStop (
       EfiReleaseLock (&Instance->TaskQueueLock);
     } while (!AllTaskDone);
 
+    //
+    // The cache writes the dirty blocks with the shared working buffer.
+    //
+    Status = DiskIoCacheFlush (Instance);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "DiskIoDriverBindingStop: Failed to write the block cache - %r\n", Status));
+    }
+
+    DiskIoCacheFree (Instance);
+
     FreeAlignedPages (
       Instance->SharedWorkingBuffer,
       EFI_SIZE_TO_PAGES (PcdGet32 (PcdDiskIoDataBufferBlockNum) * Instance->BlockIo->Media->BlockSize)
@@ -858,6 +874,24 @@ DiskIo2ReadWriteDisk (
   Status   = EFI_SUCCESS;
   Blocking = (BOOLEAN)((Token == NULL) || (Token->Event == NULL));
 
+  if (Instance->Cache != NULL) {
+    if (Blocking && DiskIoCacheIsCacheable (Instance, Write, MediaId, Offset, BufferSize)) {
+      //
+      // Wait till pending async task is completed, so that the cache does not
+      // read blocks that are being written.
+      //
+      while (!DiskIo2RemoveCompletedTask (Instance)) {
+      }
+
+      return DiskIoCacheReadWrite (Instance, Write, Offset, BufferSize, Buffer);
+    }
+
+    Status = DiskIoCacheSync (Instance, Write, Offset, BufferSize);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
   if (Blocking) {
     //
     // Wait till pending async task is completed.
@@ -1158,6 +1192,14 @@ DiskIo2FlushDiskEx (
 
   Private = DISK_IO_PRIVATE_DATA_FROM_DISK_IO2 (This);
 
+  //
+  // The dirty cached blocks are written before the device is flushed.
+  //
+  Status = DiskIoCacheFlush (Private);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
   if ((Token != NULL) && (Token->Event != NULL)) {
     Task = AllocatePool (sizeof (DISK_IO2_FLUSH_TASK));
     if (Task == NULL) {
@@ -16,6 +16,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/ComponentName.h>
 #include <Protocol/DriverBinding.h>
 #include <Protocol/DiskIo.h>
+#include <Guid/EventGroup.h>
 #include <Library/DebugLib.h>
 #include <Library/UefiDriverEntryPoint.h>
 #include <Library/UefiLib.h>
@@ -23,6 +24,55 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include <Library/PcdLib.h>
+
+//
+// The read-ahead of a sequential stream starts at DISK_IO_CACHE_MIN_READ_AHEAD
+// blocks, and doubles up to DISK_IO_CACHE_MAX_READ_AHEAD blocks.
+//
+#define DISK_IO_CACHE_MIN_READ_AHEAD  8
+#define DISK_IO_CACHE_MAX_READ_AHEAD  128
+
+#define DISK_IO_CACHE_BLOCK_SIGNATURE  SIGNATURE_32 ('d', 'i', 'c', 'b')
+typedef struct {
+  UINT32        Signature;
+  LIST_ENTRY    HashLink;           /// < link in the hash bucket of Lba
+  LIST_ENTRY    LruLink;            /// < link in the LRU list, most recently used first
+  LIST_ENTRY    DirtyLink;          /// < link in the dirty list, in ascending Lba order
+  EFI_LBA       Lba;
+  BOOLEAN       Valid;
+  BOOLEAN       Dirty;
+  UINT8         *Data;
+} DISK_IO_CACHE_BLOCK;
+
+typedef struct {
+  EFI_LOCK               Lock;
+  UINT32                 MediaId;
+  BOOLEAN                WriteBack;
+  UINTN                  BlockNum;
+  DISK_IO_CACHE_BLOCK    *Blocks;
+  UINT8                  *Data;
+  LIST_ENTRY             *HashTable;
+  UINTN                  HashSize;
+  LIST_ENTRY             LruList;
+  LIST_ENTRY             DirtyList;
+  UINTN                  DirtyCount;
+
+  //
+  // Read-ahead of sequential streams
+  //
+  UINTN                  MaxReadBlocks;
+  UINT8                  *ReadBuffer;
+  EFI_LBA                NextStreamLba;
+  UINTN                  ReadAheadBlocks;
+
+  EFI_EVENT              BeforeExitBootServicesEvent;
+
+  UINT64                 Hits;
+  UINT64                 Misses;
+  UINT64                 DeviceReads;
+  UINT64                 DeviceWrites;
+} DISK_IO_CACHE;
 
 #define DISK_IO_PRIVATE_DATA_SIGNATURE  SIGNATURE_32 ('d', 's', 'k', 'I')
 typedef struct {
@@ -37,6 +87,8 @@ typedef struct {
 
   EFI_LOCK                  TaskQueueLock;
   LIST_ENTRY                TaskQueue;
+
+  DISK_IO_CACHE             *Cache;                /// < NULL when the cache is disabled
 } DISK_IO_PRIVATE_DATA;
 #define DISK_IO_PRIVATE_DATA_FROM_DISK_IO(a)   CR (a, DISK_IO_PRIVATE_DATA, DiskIo,  DISK_IO_PRIVATE_DATA_SIGNATURE)
 #define DISK_IO_PRIVATE_DATA_FROM_DISK_IO2(a)  CR (a, DISK_IO_PRIVATE_DATA, DiskIo2, DISK_IO_PRIVATE_DATA_SIGNATURE)
@@ -335,6 +387,145 @@ DiskIo2FlushDiskEx (
   IN OUT EFI_DISK_IO2_TOKEN  *Token
   );
 
+//
+// Block cache
+//
+
+/**
+  Find a block in the cache.
+
+  @param Cache       Pointer to the DISK_IO_CACHE.
+  @param Lba         The logical block address of the block.
+
+  @return The cached block, or NULL if the block is not cached.
+**/
+DISK_IO_CACHE_BLOCK *
+DiskIoCacheLookup (
+  IN DISK_IO_CACHE  *Cache,
+  IN EFI_LBA        Lba
+  );
+
+/**
+  Create the cache of a DiskIo instance if PcdDiskIoCacheBlockNum is not 0.
+
+  Only the instances on a whole device are cached. The partitions of a device
+  access it through the DiskIo instance of the device, so that they share its
+  cache. The cache is not created if the resources cannot be allocated.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheInitialize (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  );
+
+/**
+  Free the cache of a DiskIo instance. The dirty cached blocks are lost, they
+  should be written by DiskIoCacheFlush() first.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheFree (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  );
+
+/**
+  Check whether a blocking request can be served from the cache.
+
+  Requests that fail the checks of the Block I/O protocol are not cached, so
+  that the Block I/O protocol reports the error.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Write       TRUE: Write request; FALSE: Read request.
+  @param MediaId     ID of the medium to access.
+  @param Offset      The starting byte offset on the device.
+  @param BufferSize  The number of bytes to access.
+
+  @retval TRUE       The request can be served from the cache.
+  @retval FALSE      The request must bypass the cache.
+**/
+BOOLEAN
+DiskIoCacheIsCacheable (
+  IN DISK_IO_PRIVATE_DATA  *Instance,
+  IN BOOLEAN               Write,
+  IN UINT32                MediaId,
+  IN UINT64                Offset,
+  IN UINTN                 BufferSize
+  );
+
+/**
+  Serve a blocking request from the cache.
+
+  The request must have been accepted by DiskIoCacheIsCacheable().
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Write       TRUE: Write request; FALSE: Read request.
+  @param Offset      The starting byte offset on the device.
+  @param BufferSize  The number of bytes to access.
+  @param Buffer      The buffer to hold the data for reading or writing.
+
+  @retval EFI_SUCCESS  The data was read or written.
+  @retval others       The device failed to read or write blocks.
+**/
+EFI_STATUS
+DiskIoCacheReadWrite (
+  IN DISK_IO_PRIVATE_DATA  *Instance,
+  IN BOOLEAN               Write,
+  IN UINT64                Offset,
+  IN UINTN                 BufferSize,
+  IN OUT UINT8             *Buffer
+  );
+
+/**
+  Keep the cache coherent with a request that bypasses it. The dirty cached
+  blocks the request accesses are written, and the cached blocks it writes
+  are dropped.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Write       TRUE: Write request; FALSE: Read request.
+  @param Offset      The starting byte offset on the device.
+  @param BufferSize  The number of bytes to access.
+
+  @retval EFI_SUCCESS  The cache is coherent with the request.
+  @retval others       The device failed to write dirty blocks.
+**/
+EFI_STATUS
+DiskIoCacheSync (
+  IN DISK_IO_PRIVATE_DATA  *Instance,
+  IN BOOLEAN               Write,
+  IN UINT64                Offset,
+  IN UINTN                 BufferSize
+  );
+
+/**
+  Write all the dirty cached blocks to the device.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+
+  @retval EFI_SUCCESS  There are no dirty cached blocks.
+  @retval others       The device failed to write dirty blocks.
+**/
+EFI_STATUS
+DiskIoCacheFlush (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  );
+
+/**
+  Write the dirty cached blocks before ExitBootServices(), while the Block I/O
+  protocol still works. The cache writes through from now on.
+
+  @param  Event                 Event whose notification function is being invoked.
+  @param  Context               The pointer to the notification function's context,
+                                which points to the DISK_IO_PRIVATE_DATA instance.
+**/
+VOID
+EFIAPI
+DiskIoCacheOnBeforeExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  );
+
 //
 // EFI Component Name Functions
 //
@@ -0,0 +1,858 @@
+/** @file
+  Block cache of the DiskIo driver.
+
+  Small blocking requests are served from a cache of whole blocks of the device,
+  so that the many small reads and writes of file system metadata and of boot
+  loaders do not each become a Block I/O request. The cache is organized as:
+    Lookup     - A hash table indexed by LBA.
+    Eviction   - The least recently used block is replaced.
+    Read-ahead - A read miss that continues the previous read reads ahead of
+                 the request. The read-ahead doubles on every miss of the
+                 sequential stream and is reset by a random read.
+    Write-back - When PcdDiskIoCacheWriteBack is TRUE, written blocks are kept
+                 dirty in the cache and are written by DiskIo2.FlushDiskEx()
+                 (which the partitions also use to flush), on eviction, before
+                 ExitBootServices() and when the driver is stopped. Otherwise
+                 they are written before the request returns.
+                 The dirty blocks are kept in a list in ascending LBA order, so
+                 that consecutive ones are written by a single request.
+
+  Requests that bypass the cache, the non-blocking ones and the large ones, write
+  back the dirty blocks they read and drop the cached blocks they write.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DiskIo.h"
+
+/**
+  Find a block in the cache.
+
+  @param Cache       Pointer to the DISK_IO_CACHE.
+  @param Lba         The logical block address of the block.
+
+  @return The cached block, or NULL if the block is not cached.
+**/
+DISK_IO_CACHE_BLOCK *
+DiskIoCacheLookup (
+  IN DISK_IO_CACHE  *Cache,
+  IN EFI_LBA        Lba
+  )
+{
+  LIST_ENTRY           *Bucket;
+  LIST_ENTRY           *Link;
+  DISK_IO_CACHE_BLOCK  *Block;
+
+  Bucket = &Cache->HashTable[(UINTN)Lba & (Cache->HashSize - 1)];
+  for (Link = GetFirstNode (Bucket); !IsNull (Bucket, Link); Link = GetNextNode (Bucket, Link)) {
+    Block = CR (Link, DISK_IO_CACHE_BLOCK, HashLink, DISK_IO_CACHE_BLOCK_SIGNATURE);
+    if (Block->Lba == Lba) {
+      return Block;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Mark a cached block dirty. The block is inserted in the dirty list in
+  ascending LBA order. The list is searched from its end, as blocks are
+  mostly written in ascending LBA order.
+
+  @param Cache       Pointer to the DISK_IO_CACHE.
+  @param Block       The cached block.
+**/
+VOID
+DiskIoCacheSetDirty (
+  IN DISK_IO_CACHE        *Cache,
+  IN DISK_IO_CACHE_BLOCK  *Block
+  )
+{
+  LIST_ENTRY           *Link;
+  DISK_IO_CACHE_BLOCK  *Dirty;
+
+  if (Block->Dirty) {
+    return;
+  }
+
+  for (Link = GetPreviousNode (&Cache->DirtyList, &Cache->DirtyList);
+       !IsNull (&Cache->DirtyList, Link);
+       Link = GetPreviousNode (&Cache->DirtyList, Link))
+  {
+    Dirty = CR (Link, DISK_IO_CACHE_BLOCK, DirtyLink, DISK_IO_CACHE_BLOCK_SIGNATURE);
+    if (Dirty->Lba < Block->Lba) {
+      break;
+    }
+  }
+
+  //
+  // Insert the block after Link, the last dirty block of a lower LBA.
+  //
+  InsertHeadList (Link, &Block->DirtyLink);
+  Block->Dirty = TRUE;
+  Cache->DirtyCount++;
+}
+
+/**
+  Mark a cached block clean.
+
+  @param Cache       Pointer to the DISK_IO_CACHE.
+  @param Block       The cached block, which must be dirty.
+
+  @return The link of the next block in the dirty list.
+**/
+LIST_ENTRY *
+DiskIoCacheClearDirty (
+  IN DISK_IO_CACHE        *Cache,
+  IN DISK_IO_CACHE_BLOCK  *Block
+  )
+{
+  ASSERT (Block->Dirty);
+
+  Block->Dirty = FALSE;
+  Cache->DirtyCount--;
+  return RemoveEntryList (&Block->DirtyLink);
+}
+
+/**
+  Drop a block from the cache, whether it is dirty or not.
+
+  @param Cache       Pointer to the DISK_IO_CACHE.
+  @param Block       The cached block.
+**/
+VOID
+DiskIoCacheDropBlock (
+  IN DISK_IO_CACHE        *Cache,
+  IN DISK_IO_CACHE_BLOCK  *Block
+  )
+{
+  ASSERT (Block->Valid);
+
+  if (Block->Dirty) {
+    DiskIoCacheClearDirty (Cache, Block);
+  }
+
+  Block->Valid = FALSE;
+  RemoveEntryList (&Block->HashLink);
+
+  //
+  // Free blocks are the first ones to be replaced.
+  //
+  RemoveEntryList (&Block->LruLink);
+  InsertTailList (&Cache->LruList, &Block->LruLink);
+}
+
+/**
+  Drop all the blocks of the cache, and restart the cache on the current media.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheDiscard (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  )
+{
+  DISK_IO_CACHE  *Cache;
+  UINTN          Index;
+
+  Cache = Instance->Cache;
+  if (Cache->DirtyCount != 0) {
+    DEBUG ((DEBUG_WARN, "DiskIo: Media changed, %Lu dirty cached blocks are lost\n", (UINT64)Cache->DirtyCount));
+  }
+
+  for (Index = 0; Index < Cache->BlockNum; Index++) {
+    if (Cache->Blocks[Index].Valid) {
+      DiskIoCacheDropBlock (Cache, &Cache->Blocks[Index]);
+    }
+  }
+
+  ASSERT (Cache->DirtyCount == 0);
+  Cache->MediaId         = Instance->BlockIo->Media->MediaId;
+  Cache->NextStreamLba   = 0;
+  Cache->ReadAheadBlocks = 0;
+}
+
+/**
+  Check the media of the device. The cache is discarded if the media changed.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+
+  @retval TRUE       The media is present and the cache holds its blocks.
+  @retval FALSE      There is no media in the device.
+**/
+BOOLEAN
+DiskIoCacheCheckMedia (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  )
+{
+  EFI_BLOCK_IO_MEDIA  *Media;
+
+  Media = Instance->BlockIo->Media;
+  if (!Media->MediaPresent || (Media->MediaId != Instance->Cache->MediaId)) {
+    DiskIoCacheDiscard (Instance);
+  }
+
+  return Media->MediaPresent;
+}
+
+/**
+  Write the dirty cached blocks in a range of LBAs to the device.
+
+  Consecutive dirty blocks are written by a single Block I/O request of up to
+  PcdDiskIoDataBufferBlockNum blocks. The blocks are found in the dirty list,
+  so the cost does not depend on the size of the cache.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param StartLba    The first LBA of the range.
+  @param EndLba      The last LBA of the range.
+
+  @retval EFI_SUCCESS  The dirty blocks of the range were written.
+  @retval others       The device failed to write the blocks. The blocks are
+                       still dirty.
+**/
+EFI_STATUS
+DiskIoCacheWriteBack (
+  IN DISK_IO_PRIVATE_DATA  *Instance,
+  IN EFI_LBA               StartLba,
+  IN EFI_LBA               EndLba
+  )
+{
+  EFI_STATUS           Status;
+  DISK_IO_CACHE        *Cache;
+  DISK_IO_CACHE_BLOCK  *Block;
+  DISK_IO_CACHE_BLOCK  *First;
+  LIST_ENTRY           *Link;
+  EFI_LBA              FirstLba;
+  UINT32               BlockSize;
+  UINTN                MaxCount;
+  UINTN                Count;
+  UINTN                Index;
+
+  Cache     = Instance->Cache;
+  BlockSize = Instance->BlockIo->Media->BlockSize;
+  MaxCount  = PcdGet32 (PcdDiskIoDataBufferBlockNum);
+
+  //
+  // Skip the dirty blocks below the range.
+  //
+  for (Link = GetFirstNode (&Cache->DirtyList); !IsNull (&Cache->DirtyList, Link); Link = GetNextNode (&Cache->DirtyList, Link)) {
+    Block = CR (Link, DISK_IO_CACHE_BLOCK, DirtyLink, DISK_IO_CACHE_BLOCK_SIGNATURE);
+    if (Block->Lba >= StartLba) {
+      break;
+    }
+  }
+
+  while (!IsNull (&Cache->DirtyList, Link)) {
+    First = CR (Link, DISK_IO_CACHE_BLOCK, DirtyLink, DISK_IO_CACHE_BLOCK_SIGNATURE);
+    if (First->Lba > EndLba) {
+      break;
+    }
+
+    //
+    // Gather it with the dirty blocks that follow it.
+    //
+    FirstLba = First->Lba;
+    Count    = 0;
+    Block    = First;
+    do {
+      CopyMem (Instance->SharedWorkingBuffer + Count * BlockSize, Block->Data, BlockSize);
+      Count++;
+      if ((Count == MaxCount) || (FirstLba + Count > EndLba)) {
+        break;
+      }
+
+      Link = GetNextNode (&Cache->DirtyList, &Block->DirtyLink);
+      if (IsNull (&Cache->DirtyList, Link)) {
+        break;
+      }
+
+      Block = CR (Link, DISK_IO_CACHE_BLOCK, DirtyLink, DISK_IO_CACHE_BLOCK_SIGNATURE);
+    } while (Block->Lba == FirstLba + Count);
+
+    Status = Instance->BlockIo->WriteBlocks (
+                                  Instance->BlockIo,
+                                  Cache->MediaId,
+                                  FirstLba,
+                                  Count * BlockSize,
+                                  Instance->SharedWorkingBuffer
+                                  );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Cache->DeviceWrites++;
+    Link = &First->DirtyLink;
+    for (Index = 0; Index < Count; Index++) {
+      Block = CR (Link, DISK_IO_CACHE_BLOCK, DirtyLink, DISK_IO_CACHE_BLOCK_SIGNATURE);
+      Link  = DiskIoCacheClearDirty (Cache, Block);
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Get a block of the cache for an LBA that is not cached. The least recently
+  used block is replaced.
+
+  The content of the returned block is undefined.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Lba         The logical block address of the block.
+  @param Block       Returns the cached block.
+
+  @retval EFI_SUCCESS  The block is returned.
+  @retval others       The replaced block is dirty and the device failed to
+                       write it.
+**/
+EFI_STATUS
+DiskIoCacheAllocateBlock (
+  IN  DISK_IO_PRIVATE_DATA  *Instance,
+  IN  EFI_LBA               Lba,
+  OUT DISK_IO_CACHE_BLOCK   **Block
+  )
+{
+  EFI_STATUS           Status;
+  DISK_IO_CACHE        *Cache;
+  DISK_IO_CACHE_BLOCK  *Victim;
+
+  Cache  = Instance->Cache;
+  Victim = CR (GetPreviousNode (&Cache->LruList, &Cache->LruList), DISK_IO_CACHE_BLOCK, LruLink, DISK_IO_CACHE_BLOCK_SIGNATURE);
+
+  if (Victim->Valid) {
+    if (Victim->Dirty) {
+      //
+      // Write all the dirty blocks, so that the next replacements do not
+      // write single blocks.
+      //
+      Status = DiskIoCacheWriteBack (Instance, 0, MAX_UINT64);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    DiskIoCacheDropBlock (Cache, Victim);
+  }
+
+  Victim->Lba   = Lba;
+  Victim->Valid = TRUE;
+  InsertTailList (&Cache->HashTable[(UINTN)Lba & (Cache->HashSize - 1)], &Victim->HashLink);
+  RemoveEntryList (&Victim->LruLink);
+  InsertHeadList (&Cache->LruList, &Victim->LruLink);
+
+  *Block = Victim;
+  return EFI_SUCCESS;
+}
+
+/**
+  Read blocks from the device into the cache with a single Block I/O request.
+  The dirty cached blocks in the range are written first: the blocks that are
+  replaced while the range is filled must not be filled with old data.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Lba         The first LBA to read.
+  @param Count       The number of blocks to read. It is reduced to the read
+                     buffer size and to the last block of the device.
+
+  @retval EFI_SUCCESS  The blocks were read into the cache.
+  @retval others       The device failed to read or write blocks.
+**/
+EFI_STATUS
+DiskIoCacheFill (
+  IN DISK_IO_PRIVATE_DATA  *Instance,
+  IN EFI_LBA               Lba,
+  IN UINTN                 Count
+  )
+{
+  EFI_STATUS           Status;
+  DISK_IO_CACHE        *Cache;
+  DISK_IO_CACHE_BLOCK  *Block;
+  EFI_BLOCK_IO_MEDIA   *Media;
+  UINTN                Index;
+
+  Cache = Instance->Cache;
+  Media = Instance->BlockIo->Media;
+
+  ASSERT (Lba <= Media->LastBlock);
+  Count = MIN (Count, Cache->MaxReadBlocks);
+  if (Count > Media->LastBlock - Lba + 1) {
+    Count = (UINTN)(Media->LastBlock - Lba + 1);
+  }
+
+  Status = DiskIoCacheWriteBack (Instance, Lba, Lba + Count - 1);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = Instance->BlockIo->ReadBlocks (
+                                Instance->BlockIo,
+                                Cache->MediaId,
+                                Lba,
+                                Count * Media->BlockSize,
+                                Cache->ReadBuffer
+                                );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Cache->DeviceReads++;
+  for (Index = 0; Index < Count; Index++) {
+    Block = DiskIoCacheLookup (Cache, Lba + Index);
+    if (Block == NULL) {
+      Status = DiskIoCacheAllocateBlock (Instance, Lba + Index, &Block);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    ASSERT (!Block->Dirty);
+    CopyMem (Block->Data, Cache->ReadBuffer + Index * Media->BlockSize, Media->BlockSize);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Create the cache of a DiskIo instance if PcdDiskIoCacheBlockNum is not 0.
+
+  Only the instances on a whole device are cached. The partitions of a device
+  access it through the DiskIo instance of the device, so that they share its
+  cache. The cache is not created if the resources cannot be allocated.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheInitialize (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  )
+{
+  EFI_STATUS          Status;
+  DISK_IO_CACHE       *Cache;
+  EFI_BLOCK_IO_MEDIA  *Media;
+  UINTN               BlockNum;
+  UINTN               Index;
+
+  Media    = Instance->BlockIo->Media;
+  BlockNum = PcdGet32 (PcdDiskIoCacheBlockNum);
+  if ((BlockNum == 0) || Media->LogicalPartition || (Media->BlockSize == 0)) {
+    return;
+  }
+
+  Cache = AllocateZeroPool (sizeof (DISK_IO_CACHE));
+  if (Cache == NULL) {
+    return;
+  }
+
+  Cache->BlockNum      = BlockNum;
+  Cache->HashSize      = GetPowerOfTwo32 ((UINT32)BlockNum);
+  Cache->MaxReadBlocks = MAX (MIN (DISK_IO_CACHE_MAX_READ_AHEAD, BlockNum / 2), 1);
+  Cache->WriteBack     = FeaturePcdGet (PcdDiskIoCacheWriteBack);
+  Cache->MediaId       = Media->MediaId;
+  EfiInitializeLock (&Cache->Lock, TPL_CALLBACK);
+  InitializeListHead (&Cache->LruList);
+  InitializeListHead (&Cache->DirtyList);
+
+  Cache->Blocks     = AllocateZeroPool (BlockNum * sizeof (DISK_IO_CACHE_BLOCK));
+  Cache->HashTable  = AllocatePool (Cache->HashSize * sizeof (LIST_ENTRY));
+  Cache->Data       = AllocatePages (EFI_SIZE_TO_PAGES (BlockNum * Media->BlockSize));
+  Cache->ReadBuffer = AllocateAlignedPages (EFI_SIZE_TO_PAGES (Cache->MaxReadBlocks * Media->BlockSize), Media->IoAlign);
+  if ((Cache->Blocks == NULL) || (Cache->HashTable == NULL) || (Cache->Data == NULL) || (Cache->ReadBuffer == NULL)) {
+    DEBUG ((DEBUG_WARN, "DiskIo: No enough memory for the block cache\n"));
+    Instance->Cache = Cache;
+    DiskIoCacheFree (Instance);
+    return;
+  }
+
+  for (Index = 0; Index < Cache->HashSize; Index++) {
+    InitializeListHead (&Cache->HashTable[Index]);
+  }
+
+  //
+  // The consumers flush a device through DiskIo2.FlushDiskEx(), directly or
+  // through the Block I/O protocols of its partitions. A device without
+  // Block I/O 2 has no DiskIo2, so its dirty blocks would not be flushed.
+  //
+  if (Instance->BlockIo2 == NULL) {
+    Cache->WriteBack = FALSE;
+  }
+
+  for (Index = 0; Index < BlockNum; Index++) {
+    Cache->Blocks[Index].Signature = DISK_IO_CACHE_BLOCK_SIGNATURE;
+    Cache->Blocks[Index].Data      = Cache->Data + Index * Media->BlockSize;
+    InsertTailList (&Cache->LruList, &Cache->Blocks[Index].LruLink);
+  }
+
+  if (Cache->WriteBack) {
+    Status = gBS->CreateEventEx (
+                    EVT_NOTIFY_SIGNAL,
+                    TPL_CALLBACK,
+                    DiskIoCacheOnBeforeExitBootServices,
+                    Instance,
+                    &gEfiEventBeforeExitBootServicesGuid,
+                    &Cache->BeforeExitBootServicesEvent
+                    );
+    if (EFI_ERROR (Status)) {
+      Cache->WriteBack = FALSE;
+    }
+  }
+
+  Instance->Cache = Cache;
+}
+
+/**
+  Free the cache of a DiskIo instance. The dirty cached blocks are lost, they
+  should be written by DiskIoCacheFlush() first.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheFree (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  )
+{
+  DISK_IO_CACHE  *Cache;
+  UINT32         BlockSize;
+
+  Cache = Instance->Cache;
+  if (Cache == NULL) {
+    return;
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "DiskIo: Block cache hits/misses/device reads/device writes = %ld/%ld/%ld/%ld\n",
+    Cache->Hits,
+    Cache->Misses,
+    Cache->DeviceReads,
+    Cache->DeviceWrites
+    ));
+
+  BlockSize = Instance->BlockIo->Media->BlockSize;
+  if (Cache->BeforeExitBootServicesEvent != NULL) {
+    gBS->CloseEvent (Cache->BeforeExitBootServicesEvent);
+  }
+
+  if (Cache->ReadBuffer != NULL) {
+    FreeAlignedPages (Cache->ReadBuffer, EFI_SIZE_TO_PAGES (Cache->MaxReadBlocks * BlockSize));
+  }
+
+  if (Cache->Data != NULL) {
+    FreePages (Cache->Data, EFI_SIZE_TO_PAGES (Cache->BlockNum * BlockSize));
+  }
+
+  if (Cache->HashTable != NULL) {
+    FreePool (Cache->HashTable);
+  }
+
+  if (Cache->Blocks != NULL) {
+    FreePool (Cache->Blocks);
+  }
+
+  FreePool (Cache);
+  Instance->Cache = NULL;
+}
+
+/**
+  Check whether a blocking request can be served from the cache.
+
+  Requests that fail the checks of the Block I/O protocol are not cached, so
+  that the Block I/O protocol reports the error.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Write       TRUE: Write request; FALSE: Read request.
+  @param MediaId     ID of the medium to access.
+  @param Offset      The starting byte offset on the device.
+  @param BufferSize  The number of bytes to access.
+
+  @retval TRUE       The request can be served from the cache.
+  @retval FALSE      The request must bypass the cache.
+**/
+BOOLEAN
+DiskIoCacheIsCacheable (
+  IN DISK_IO_PRIVATE_DATA  *Instance,
+  IN BOOLEAN               Write,
+  IN UINT32                MediaId,
+  IN UINT64                Offset,
+  IN UINTN                 BufferSize
+  )
+{
+  EFI_BLOCK_IO_MEDIA  *Media;
+  DISK_IO_CACHE       *Cache;
+  BOOLEAN             Present;
+  UINT64              DeviceSize;
+
+  Cache = Instance->Cache;
+  Media = Instance->BlockIo->Media;
+
+  EfiAcquireLock (&Cache->Lock);
+  Present = DiskIoCacheCheckMedia (Instance);
+  EfiReleaseLock (&Cache->Lock);
+
+  if (!Present || (MediaId != Media->MediaId) || (Write && Media->ReadOnly)) {
+    return FALSE;
+  }
+
+  if ((BufferSize == 0) || (BufferSize > Cache->MaxReadBlocks * Media->BlockSize)) {
+    return FALSE;
+  }
+
+  DeviceSize = MultU64x32 (Media->LastBlock + 1, Media->BlockSize);
+  return (BOOLEAN)((Offset < DeviceSize) && (BufferSize <= DeviceSize - Offset));
+}
+
+/**
+  Serve a blocking request from the cache.
+
+  The request must have been accepted by DiskIoCacheIsCacheable().
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Write       TRUE: Write request; FALSE: Read request.
+  @param Offset      The starting byte offset on the device.
+  @param BufferSize  The number of bytes to access.
+  @param Buffer      The buffer to hold the data for reading or writing.
+
+  @retval EFI_SUCCESS  The data was read or written.
+  @retval others       The device failed to read or write blocks.
+**/
+EFI_STATUS
+DiskIoCacheReadWrite (
+  IN DISK_IO_PRIVATE_DATA  *Instance,
+  IN BOOLEAN               Write,
+  IN UINT64                Offset,
+  IN UINTN                 BufferSize,
+  IN OUT UINT8             *Buffer
+  )
+{
+  EFI_STATUS           Status;
+  DISK_IO_CACHE        *Cache;
+  DISK_IO_CACHE_BLOCK  *Block;
+  UINT32               BlockSize;
+  UINT32               BlockOffset;
+  EFI_LBA              FirstLba;
+  EFI_LBA              LastLba;
+  EFI_LBA              Lba;
+  UINTN                Length;
+  UINTN                Count;
+  BOOLEAN              Sequential;
+
+  Cache     = Instance->Cache;
+  BlockSize = Instance->BlockIo->Media->BlockSize;
+  FirstLba  = DivU64x32Remainder (Offset, BlockSize, &BlockOffset);
+  LastLba   = DivU64x32 (Offset + BufferSize - 1, BlockSize);
+  Status    = EFI_SUCCESS;
+
+  EfiAcquireLock (&Cache->Lock);
+
+  //
+  // A read that starts where the previous read ended, or in its last block,
+  // continues a sequential stream.
+  //
+  Sequential = FALSE;
+  if (!Write) {
+    Sequential = (BOOLEAN)((FirstLba == Cache->NextStreamLba) || (FirstLba + 1 == Cache->NextStreamLba));
+    if (!Sequential) {
+      Cache->ReadAheadBlocks = 0;
+    }
+
+    Cache->NextStreamLba = LastLba + 1;
+  }
+
+  for (Lba = FirstLba; Lba <= LastLba; Lba++) {
+    Length = MIN (BlockSize - BlockOffset, BufferSize);
+    Block  = DiskIoCacheLookup (Cache, Lba);
+    if (Block != NULL) {
+      Cache->Hits++;
+    } else {
+      Cache->Misses++;
+      if (Write && (Length == BlockSize)) {
+        //
+        // The whole block is written, there is no need to read it.
+        //
+        Status = DiskIoCacheAllocateBlock (Instance, Lba, &Block);
+      } else {
+        Count = 1;
+        if (!Write) {
+          Count = (UINTN)(LastLba - Lba) + 1;
+          if (Sequential) {
+            Cache->ReadAheadBlocks = (Cache->ReadAheadBlocks == 0) ? DISK_IO_CACHE_MIN_READ_AHEAD : Cache->ReadAheadBlocks * 2;
+            Cache->ReadAheadBlocks = MIN (Cache->ReadAheadBlocks, Cache->MaxReadBlocks);
+            Count                 += Cache->ReadAheadBlocks;
+          }
+        }
+
+        Status = DiskIoCacheFill (Instance, Lba, Count);
+        Block  = DiskIoCacheLookup (Cache, Lba);
+      }
+
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+
+    if (Write) {
+      CopyMem (Block->Data + BlockOffset, Buffer, Length);
+      DiskIoCacheSetDirty (Cache, Block);
+    } else {
+      CopyMem (Buffer, Block->Data + BlockOffset, Length);
+    }
+
+    RemoveEntryList (&Block->LruLink);
+    InsertHeadList (&Cache->LruList, &Block->LruLink);
+
+    Buffer     += Length;
+    BufferSize -= Length;
+    BlockOffset = 0;
+  }
+
+  if (!EFI_ERROR (Status) && Write && !Cache->WriteBack) {
+    Status = DiskIoCacheWriteBack (Instance, FirstLba, LastLba);
+  }
+
+  if (EFI_ERROR (Status) && Write && !Cache->WriteBack) {
+    //
+    // Do not write the data of a failed write-through request later.
+    //
+    for (Lba = FirstLba; Lba <= LastLba; Lba++) {
+      Block = DiskIoCacheLookup (Cache, Lba);
+      if (Block != NULL) {
+        DiskIoCacheDropBlock (Cache, Block);
+      }
+    }
+  }
+
+  EfiReleaseLock (&Cache->Lock);
+
+  return Status;
+}
+
+/**
+  Keep the cache coherent with a request that bypasses it. The dirty cached
+  blocks the request accesses are written, and the cached blocks it writes
+  are dropped.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Write       TRUE: Write request; FALSE: Read request.
+  @param Offset      The starting byte offset on the device.
+  @param BufferSize  The number of bytes to access.
+
+  @retval EFI_SUCCESS  The cache is coherent with the request.
+  @retval others       The device failed to write dirty blocks.
+**/
+EFI_STATUS
+DiskIoCacheSync (
+  IN DISK_IO_PRIVATE_DATA  *Instance,
+  IN BOOLEAN               Write,
+  IN UINT64                Offset,
+  IN UINTN                 BufferSize
+  )
+{
+  EFI_STATUS           Status;
+  DISK_IO_CACHE        *Cache;
+  DISK_IO_CACHE_BLOCK  *Block;
+  UINT32               BlockSize;
+  EFI_LBA              FirstLba;
+  EFI_LBA              LastLba;
+  EFI_LBA              Lba;
+  UINTN                Index;
+
+  Cache     = Instance->Cache;
+  BlockSize = Instance->BlockIo->Media->BlockSize;
+  if (BufferSize == 0) {
+    return EFI_SUCCESS;
+  }
+
+  FirstLba = DivU64x32 (Offset, BlockSize);
+  if (Offset + BufferSize - 1 < Offset) {
+    LastLba = MAX_UINT64;
+  } else {
+    LastLba = DivU64x32 (Offset + BufferSize - 1, BlockSize);
+  }
+
+  Status = EFI_SUCCESS;
+  EfiAcquireLock (&Cache->Lock);
+  if (DiskIoCacheCheckMedia (Instance)) {
+    Status = DiskIoCacheWriteBack (Instance, FirstLba, LastLba);
+    if (!EFI_ERROR (Status) && Write) {
+      if (LastLba - FirstLba < Cache->BlockNum) {
+        for (Lba = FirstLba; Lba <= LastLba; Lba++) {
+          Block = DiskIoCacheLookup (Cache, Lba);
+          if (Block != NULL) {
+            DiskIoCacheDropBlock (Cache, Block);
+          }
+        }
+      } else {
+        for (Index = 0; Index < Cache->BlockNum; Index++) {
+          Block = &Cache->Blocks[Index];
+          if (Block->Valid && (Block->Lba >= FirstLba) && (Block->Lba <= LastLba)) {
+            DiskIoCacheDropBlock (Cache, Block);
+          }
+        }
+      }
+    }
+  }
+
+  EfiReleaseLock (&Cache->Lock);
+
+  return Status;
+}
+
+/**
+  Write all the dirty cached blocks to the device.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+
+  @retval EFI_SUCCESS  There are no dirty cached blocks.
+  @retval others       The device failed to write dirty blocks.
+**/
+EFI_STATUS
+DiskIoCacheFlush (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  )
+{
+  EFI_STATUS  Status;
+
+  if (Instance->Cache == NULL) {
+    return EFI_SUCCESS;
+  }
+
+  Status = EFI_SUCCESS;
+  EfiAcquireLock (&Instance->Cache->Lock);
+  if (DiskIoCacheCheckMedia (Instance)) {
+    Status = DiskIoCacheWriteBack (Instance, 0, MAX_UINT64);
+  }
+
+  EfiReleaseLock (&Instance->Cache->Lock);
+
+  return Status;
+}
+
+/**
+  Write the dirty cached blocks before ExitBootServices(), while the Block I/O
+  protocol still works. The cache writes through from now on.
+
+  @param  Event                 Event whose notification function is being invoked.
+  @param  Context               The pointer to the notification function's context,
+                                which points to the DISK_IO_PRIVATE_DATA instance.
+**/
+VOID
+EFIAPI
+DiskIoCacheOnBeforeExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  EFI_STATUS            Status;
+  DISK_IO_PRIVATE_DATA  *Instance;
+
+  Instance = (DISK_IO_PRIVATE_DATA *)Context;
+  ASSERT (Instance->Signature == DISK_IO_PRIVATE_DATA_SIGNATURE);
+
+  Status = DiskIoCacheFlush (Instance);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "DiskIo: Failed to write the block cache before ExitBootServices - %r\n", Status));
+  }
+
+  Instance->Cache->WriteBack = FALSE;
+}
@@ -0,0 +1,830 @@
+/** @file
+  Host based unit tests of the block cache of the DiskIo driver.
+
+  The cache runs on a Block I/O protocol backed by a memory disk. Random reads
+  and writes, some of them bypassing the cache, must see the data of a model of
+  the disk, and the disk must match the model after each write-through request
+  and after a flush. The replacement of the least recently used block, the
+  growth of the read-ahead and the coalescing of the dirty blocks are checked
+  from the Block I/O requests the cache issues.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../DiskIo.h"
+
+#include <Library/UnitTestLib.h>
+#include <Library/UnitTestRandomLib.h>
+
+#define UNIT_TEST_APP_NAME     "DiskIo Block Cache Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_BLOCK_SIZE      512
+#define TEST_BLOCK_NUM       1024
+#define TEST_MAX_REQUESTS    64
+#define TEST_RANDOM_BLOCKS   200
+#define TEST_RANDOM_ACTIONS  4000
+
+typedef struct {
+  EFI_LBA    Lba;
+  UINTN      Count;
+} TEST_REQUEST;
+
+typedef struct {
+  BOOLEAN                  WriteBack;
+  BOOLEAN                  HasBlockIo2;
+  EFI_BLOCK_IO_PROTOCOL    BlockIo;
+  EFI_BLOCK_IO_MEDIA       Media;
+  DISK_IO_PRIVATE_DATA     Instance;
+  UINT8                    *Disk;
+  UINT8                    *Model;
+  UINT64                   Seed;
+  ///
+  /// Block I/O requests issued by the cache.
+  ///
+  TEST_REQUEST             Reads[TEST_MAX_REQUESTS];
+  UINTN                    ReadCount;
+  TEST_REQUEST             Writes[TEST_MAX_REQUESTS];
+  UINTN                    WriteCount;
+} TEST_CONTEXT;
+
+STATIC EFI_BLOCK_IO2_PROTOCOL  mBlockIo2;
+
+///
+/// Blocks written out of order, around a block that a request bypassing the
+/// cache reads.
+///
+STATIC CONST EFI_LBA  mDirtyLbas[] = { 10, 12, 11, 13, 31, 30 };
+
+/**
+  Stub of the lock initialization of UefiLib.
+
+  @param[in, out] Lock      The lock to initialize.
+  @param[in]      Priority  The task priority level of the lock.
+
+  @return The lock.
+**/
+EFI_LOCK *
+EFIAPI
+EfiInitializeLock (
+  IN OUT EFI_LOCK  *Lock,
+  IN     EFI_TPL   Priority
+  )
+{
+  Lock->Tpl      = Priority;
+  Lock->OwnerTpl = TPL_APPLICATION;
+  Lock->Lock     = EfiLockReleased;
+  return Lock;
+}
+
+/**
+  Stub of the lock acquisition of UefiLib. The lock must not be held.
+
+  @param[in] Lock  The lock to acquire.
+**/
+VOID
+EFIAPI
+EfiAcquireLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockReleased);
+  Lock->Lock = EfiLockAcquired;
+}
+
+/**
+  Stub of the lock release of UefiLib. The lock must be held.
+
+  @param[in] Lock  The lock to release.
+**/
+VOID
+EFIAPI
+EfiReleaseLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockAcquired);
+  Lock->Lock = EfiLockReleased;
+}
+
+/**
+  Check a request of the memory disk and record it.
+
+  @param[in]  TestContext  The test context.
+  @param[in]  Requests     The recorded requests of the same direction.
+  @param[in]  Count        The number of recorded requests.
+  @param[in]  MediaId      The media ID of the request.
+  @param[in]  Lba          The first block of the request.
+  @param[in]  BufferSize   The size of the request in bytes.
+
+  @retval EFI_SUCCESS            The request is valid.
+  @retval EFI_MEDIA_CHANGED      The media ID is not the one of the media.
+  @retval EFI_INVALID_PARAMETER  The request is not on whole blocks of the disk.
+**/
+STATIC
+EFI_STATUS
+TestRecordRequest (
+  IN     TEST_CONTEXT  *TestContext,
+  IN     TEST_REQUEST  *Requests,
+  IN OUT UINTN         *Count,
+  IN     UINT32        MediaId,
+  IN     EFI_LBA       Lba,
+  IN     UINTN         BufferSize
+  )
+{
+  if (MediaId != TestContext->Media.MediaId) {
+    return EFI_MEDIA_CHANGED;
+  }
+
+  if ((BufferSize == 0) || (BufferSize % TEST_BLOCK_SIZE != 0) ||
+      (Lba + BufferSize / TEST_BLOCK_SIZE > TEST_BLOCK_NUM))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (*Count < TEST_MAX_REQUESTS) {
+    Requests[*Count].Lba   = Lba;
+    Requests[*Count].Count = BufferSize / TEST_BLOCK_SIZE;
+  }
+
+  (*Count)++;
+  return EFI_SUCCESS;
+}
+
+/**
+  Read blocks from the memory disk.
+
+  @param[in]  This        The Block I/O protocol of the memory disk.
+  @param[in]  MediaId     The media ID of the request.
+  @param[in]  Lba         The first block to read.
+  @param[in]  BufferSize  The size of the buffer in bytes.
+  @param[out] Buffer      The buffer to receive the blocks.
+
+  @retval EFI_SUCCESS  The blocks were read.
+  @retval others       The request is not valid.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestReadBlocks (
+  IN  EFI_BLOCK_IO_PROTOCOL  *This,
+  IN  UINT32                 MediaId,
+  IN  EFI_LBA                Lba,
+  IN  UINTN                  BufferSize,
+  OUT VOID                   *Buffer
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  EFI_STATUS    Status;
+
+  TestContext = BASE_CR (This, TEST_CONTEXT, BlockIo);
+  Status      = TestRecordRequest (TestContext, TestContext->Reads, &TestContext->ReadCount, MediaId, Lba, BufferSize);
+  if (!EFI_ERROR (Status)) {
+    CopyMem (Buffer, TestContext->Disk + Lba * TEST_BLOCK_SIZE, BufferSize);
+  }
+
+  return Status;
+}
+
+/**
+  Write blocks to the memory disk.
+
+  @param[in]  This        The Block I/O protocol of the memory disk.
+  @param[in]  MediaId     The media ID of the request.
+  @param[in]  Lba         The first block to write.
+  @param[in]  BufferSize  The size of the buffer in bytes.
+  @param[in]  Buffer      The blocks to write.
+
+  @retval EFI_SUCCESS  The blocks were written.
+  @retval others       The request is not valid.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestWriteBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This,
+  IN UINT32                 MediaId,
+  IN EFI_LBA                Lba,
+  IN UINTN                  BufferSize,
+  IN VOID                   *Buffer
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  EFI_STATUS    Status;
+
+  TestContext = BASE_CR (This, TEST_CONTEXT, BlockIo);
+  Status      = TestRecordRequest (TestContext, TestContext->Writes, &TestContext->WriteCount, MediaId, Lba, BufferSize);
+  if (!EFI_ERROR (Status)) {
+    CopyMem (TestContext->Disk + Lba * TEST_BLOCK_SIZE, Buffer, BufferSize);
+  }
+
+  return Status;
+}
+
+/**
+  Create a memory disk of random content and the cache of its DiskIo instance.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED                      The cache is created.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The cache could not be created.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+CreateCache (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINTN         Index;
+
+  TestContext             = (TEST_CONTEXT *)Context;
+  TestContext->Seed       = 0x2545F4914F6CDD1DULL;
+  TestContext->ReadCount  = 0;
+  TestContext->WriteCount = 0;
+
+  TestContext->Disk  = AllocatePool (TEST_BLOCK_NUM * TEST_BLOCK_SIZE);
+  TestContext->Model = AllocatePool (TEST_BLOCK_NUM * TEST_BLOCK_SIZE);
+  if ((TestContext->Disk == NULL) || (TestContext->Model == NULL)) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  for (Index = 0; Index < TEST_BLOCK_NUM * TEST_BLOCK_SIZE; Index++) {
+    TestContext->Disk[Index] = (UINT8)UnitTestRandom (&TestContext->Seed);
+  }
+
+  CopyMem (TestContext->Model, TestContext->Disk, TEST_BLOCK_NUM * TEST_BLOCK_SIZE);
+
+  ZeroMem (&TestContext->Media, sizeof (TestContext->Media));
+  TestContext->Media.MediaId      = 1;
+  TestContext->Media.MediaPresent = TRUE;
+  TestContext->Media.BlockSize    = TEST_BLOCK_SIZE;
+  TestContext->Media.LastBlock    = TEST_BLOCK_NUM - 1;
+
+  ZeroMem (&TestContext->BlockIo, sizeof (TestContext->BlockIo));
+  TestContext->BlockIo.Media       = &TestContext->Media;
+  TestContext->BlockIo.ReadBlocks  = TestReadBlocks;
+  TestContext->BlockIo.WriteBlocks = TestWriteBlocks;
+
+  ZeroMem (&TestContext->Instance, sizeof (TestContext->Instance));
+  TestContext->Instance.Signature           = DISK_IO_PRIVATE_DATA_SIGNATURE;
+  TestContext->Instance.BlockIo             = &TestContext->BlockIo;
+  TestContext->Instance.BlockIo2            = TestContext->HasBlockIo2 ? &mBlockIo2 : NULL;
+  TestContext->Instance.SharedWorkingBuffer = AllocatePages (
+                                                EFI_SIZE_TO_PAGES (PcdGet32 (PcdDiskIoDataBufferBlockNum) * TEST_BLOCK_SIZE)
+                                                );
+  if (TestContext->Instance.SharedWorkingBuffer == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  DiskIoCacheInitialize (&TestContext->Instance);
+  if (TestContext->Instance.Cache == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  //
+  // The test cases run in write-back or write-through mode, whatever
+  // PcdDiskIoCacheWriteBack is. A device without Block I/O 2 is always
+  // write-through.
+  //
+  if (TestContext->HasBlockIo2) {
+    TestContext->Instance.Cache->WriteBack = TestContext->WriteBack;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the cache and the memory disk.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+**/
+STATIC
+VOID
+EFIAPI
+FreeCache (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  DiskIoCacheFree (&TestContext->Instance);
+  if (TestContext->Instance.SharedWorkingBuffer != NULL) {
+    FreePages (
+      TestContext->Instance.SharedWorkingBuffer,
+      EFI_SIZE_TO_PAGES (PcdGet32 (PcdDiskIoDataBufferBlockNum) * TEST_BLOCK_SIZE)
+      );
+  }
+
+  if (TestContext->Disk != NULL) {
+    FreePool (TestContext->Disk);
+  }
+
+  if (TestContext->Model != NULL) {
+    FreePool (TestContext->Model);
+  }
+
+  TestContext->Instance.SharedWorkingBuffer = NULL;
+  TestContext->Disk                         = NULL;
+  TestContext->Model                        = NULL;
+}
+
+/**
+  Serve a blocking request as DiskIo2ReadWriteDisk() does: from the cache if
+  it can, or from the disk after the cache is synchronized with the request.
+
+  @param[in]      TestContext  The test context.
+  @param[in]      Write        TRUE to write, FALSE to read.
+  @param[in]      Offset       The byte offset on the disk.
+  @param[in]      BufferSize   The number of bytes to access.
+  @param[in, out] Buffer       The data to write, or the buffer to read into.
+
+  @return The status of the cache.
+**/
+STATIC
+EFI_STATUS
+TestReadWrite (
+  IN     TEST_CONTEXT  *TestContext,
+  IN     BOOLEAN       Write,
+  IN     UINT64        Offset,
+  IN     UINTN         BufferSize,
+  IN OUT UINT8         *Buffer
+  )
+{
+  EFI_STATUS  Status;
+
+  if (DiskIoCacheIsCacheable (&TestContext->Instance, Write, TestContext->Media.MediaId, Offset, BufferSize)) {
+    return DiskIoCacheReadWrite (&TestContext->Instance, Write, Offset, BufferSize, Buffer);
+  }
+
+  Status = DiskIoCacheSync (&TestContext->Instance, Write, Offset, BufferSize);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (Write) {
+    CopyMem (TestContext->Disk + Offset, Buffer, BufferSize);
+  } else {
+    CopyMem (Buffer, TestContext->Disk + Offset, BufferSize);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Write a whole block through the cache, with a fill byte, and to the model.
+
+  @param[in]  TestContext  The test context.
+  @param[in]  Lba          The block to write.
+  @param[in]  Fill         The byte to write.
+
+  @return The status of the cache.
+**/
+STATIC
+EFI_STATUS
+TestWriteBlockThroughCache (
+  IN TEST_CONTEXT  *TestContext,
+  IN EFI_LBA       Lba,
+  IN UINT8         Fill
+  )
+{
+  UINT8  Buffer[TEST_BLOCK_SIZE];
+
+  SetMem (Buffer, sizeof (Buffer), Fill);
+  SetMem (TestContext->Model + Lba * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE, Fill);
+  return TestReadWrite (TestContext, TRUE, Lba * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE, Buffer);
+}
+
+/**
+  Check that the dirty list holds exactly the dirty blocks in ascending LBA
+  order.
+
+  @param[in]  Cache  The cache.
+
+  @retval TRUE   The dirty list is consistent.
+  @retval FALSE  The dirty list is not consistent.
+**/
+STATIC
+BOOLEAN
+DirtyListIsConsistent (
+  IN DISK_IO_CACHE  *Cache
+  )
+{
+  LIST_ENTRY           *Link;
+  DISK_IO_CACHE_BLOCK  *Block;
+  DISK_IO_CACHE_BLOCK  *Previous;
+  UINTN                Count;
+  UINTN                Index;
+
+  Count    = 0;
+  Previous = NULL;
+  for (Link = GetFirstNode (&Cache->DirtyList); !IsNull (&Cache->DirtyList, Link); Link = GetNextNode (&Cache->DirtyList, Link)) {
+    Block = CR (Link, DISK_IO_CACHE_BLOCK, DirtyLink, DISK_IO_CACHE_BLOCK_SIGNATURE);
+    if (!Block->Valid || !Block->Dirty || ((Previous != NULL) && (Previous->Lba >= Block->Lba))) {
+      return FALSE;
+    }
+
+    Previous = Block;
+    Count++;
+  }
+
+  if (Count != Cache->DirtyCount) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Cache->BlockNum; Index++) {
+    if (Cache->Blocks[Index].Dirty) {
+      Count--;
+    }
+  }
+
+  return (BOOLEAN)(Count == 0);
+}
+
+/**
+  Random reads and writes, of a few bytes to more blocks than the cache serves,
+  must see the data of the model. The disk must match the model after each
+  write-through request and after each flush.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+RandomAccessesMatchModel (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT   *TestContext;
+  DISK_IO_CACHE  *Cache;
+  UINT8          *Buffer;
+  UINTN          MaxSize;
+  UINTN          Action;
+  UINTN          Index;
+  UINTN          Size;
+  UINT64         Offset;
+  BOOLEAN        Write;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Cache       = TestContext->Instance.Cache;
+  MaxSize     = (Cache->MaxReadBlocks + 8) * TEST_BLOCK_SIZE;
+  Buffer      = AllocatePool (MaxSize);
+  UT_ASSERT_NOT_NULL (Buffer);
+
+  for (Action = 0; Action < TEST_RANDOM_ACTIONS; Action++) {
+    //
+    // Mostly small requests, and some that bypass the cache.
+    //
+    if (UnitTestRandom (&TestContext->Seed) % 8 == 0) {
+      Size = 1 + UnitTestRandom (&TestContext->Seed) % MaxSize;
+    } else {
+      Size = 1 + UnitTestRandom (&TestContext->Seed) % (3 * TEST_BLOCK_SIZE);
+    }
+
+    Offset = UnitTestRandom (&TestContext->Seed) % (TEST_RANDOM_BLOCKS * TEST_BLOCK_SIZE);
+    Write  = (BOOLEAN)(UnitTestRandom (&TestContext->Seed) % 2 == 0);
+
+    if (Write) {
+      for (Index = 0; Index < Size; Index++) {
+        Buffer[Index] = (UINT8)UnitTestRandom (&TestContext->Seed);
+      }
+
+      CopyMem (TestContext->Model + Offset, Buffer, Size);
+      UT_ASSERT_NOT_EFI_ERROR (TestReadWrite (TestContext, TRUE, Offset, Size, Buffer));
+      if (!Cache->WriteBack) {
+        UT_ASSERT_EQUAL (Cache->DirtyCount, 0);
+        UT_ASSERT_MEM_EQUAL (TestContext->Disk, TestContext->Model, TEST_BLOCK_NUM * TEST_BLOCK_SIZE);
+      }
+    } else {
+      UT_ASSERT_NOT_EFI_ERROR (TestReadWrite (TestContext, FALSE, Offset, Size, Buffer));
+      UT_ASSERT_MEM_EQUAL (Buffer, TestContext->Model + Offset, Size);
+    }
+
+    UT_ASSERT_TRUE (DirtyListIsConsistent (Cache));
+
+    if (UnitTestRandom (&TestContext->Seed) % 256 == 0) {
+      UT_ASSERT_NOT_EFI_ERROR (DiskIoCacheFlush (&TestContext->Instance));
+      UT_ASSERT_EQUAL (Cache->DirtyCount, 0);
+      UT_ASSERT_MEM_EQUAL (TestContext->Disk, TestContext->Model, TEST_BLOCK_NUM * TEST_BLOCK_SIZE);
+    }
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (DiskIoCacheFlush (&TestContext->Instance));
+  UT_ASSERT_EQUAL (Cache->DirtyCount, 0);
+  UT_ASSERT_TRUE (DirtyListIsConsistent (Cache));
+  UT_ASSERT_MEM_EQUAL (TestContext->Disk, TestContext->Model, TEST_BLOCK_NUM * TEST_BLOCK_SIZE);
+
+  FreePool (Buffer);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  When the cache is full, the least recently used block is replaced.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LeastRecentlyUsedBlockReplaced (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT   *TestContext;
+  DISK_IO_CACHE  *Cache;
+  UINT8          Buffer[TEST_BLOCK_SIZE];
+  UINTN          Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Cache       = TestContext->Instance.Cache;
+
+  //
+  // Fill the cache with whole blocks, which are not read from the disk.
+  //
+  for (Index = 0; Index < Cache->BlockNum; Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (TestWriteBlockThroughCache (TestContext, 300 + 2 * Index, (UINT8)Index));
+  }
+
+  UT_ASSERT_EQUAL (TestContext->ReadCount, 0);
+
+  //
+  // Use the oldest block again, it is a hit.
+  //
+  UT_ASSERT_NOT_EFI_ERROR (TestReadWrite (TestContext, FALSE, 300 * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE, Buffer));
+  UT_ASSERT_EQUAL (TestContext->ReadCount, 0);
+  UT_ASSERT_MEM_EQUAL (Buffer, TestContext->Model + 300 * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE);
+
+  //
+  // The next block replaces the second oldest one.
+  //
+  UT_ASSERT_NOT_EFI_ERROR (TestWriteBlockThroughCache (TestContext, 900, 0x5A));
+  UT_ASSERT_NOT_NULL (DiskIoCacheLookup (Cache, 300));
+  UT_ASSERT_TRUE (DiskIoCacheLookup (Cache, 302) == NULL);
+  UT_ASSERT_NOT_NULL (DiskIoCacheLookup (Cache, 304));
+  UT_ASSERT_NOT_NULL (DiskIoCacheLookup (Cache, 900));
+
+  UT_ASSERT_NOT_EFI_ERROR (DiskIoCacheFlush (&TestContext->Instance));
+  UT_ASSERT_MEM_EQUAL (TestContext->Disk, TestContext->Model, TEST_BLOCK_NUM * TEST_BLOCK_SIZE);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The read-ahead of a sequential stream doubles on every miss up to the read
+  limit, and a random read resets it.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReadAheadGrowsOnSequentialReads (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT   *TestContext;
+  DISK_IO_CACHE  *Cache;
+  UINT8          Buffer[TEST_BLOCK_SIZE];
+  UINTN          Expected[6];
+  EFI_LBA        Lba;
+  UINTN          Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Cache       = TestContext->Instance.Cache;
+  UT_ASSERT_EQUAL (Cache->MaxReadBlocks, 32);
+
+  //
+  // A random read reads its block, then each miss of the stream reads ahead
+  // 8, 16 and then 31 blocks, to read 32 blocks at most.
+  //
+  Expected[0] = 1;
+  Expected[1] = 1 + DISK_IO_CACHE_MIN_READ_AHEAD;
+  Expected[2] = 1 + 2 * DISK_IO_CACHE_MIN_READ_AHEAD;
+  Expected[3] = Cache->MaxReadBlocks;
+  Expected[4] = Cache->MaxReadBlocks;
+  Expected[5] = 1;
+
+  for (Lba = 100; Lba < 100 + Expected[0] + Expected[1] + Expected[2] + Expected[3] + Expected[4]; Lba++) {
+    UT_ASSERT_NOT_EFI_ERROR (TestReadWrite (TestContext, FALSE, Lba * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE, Buffer));
+    UT_ASSERT_MEM_EQUAL (Buffer, TestContext->Model + Lba * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE);
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (TestReadWrite (TestContext, FALSE, 700 * TEST_BLOCK_SIZE + 10, 100, Buffer));
+  UT_ASSERT_MEM_EQUAL (Buffer, TestContext->Model + 700 * TEST_BLOCK_SIZE + 10, 100);
+
+  UT_ASSERT_EQUAL (TestContext->ReadCount, ARRAY_SIZE (Expected));
+  Lba = 100;
+  for (Index = 0; Index < ARRAY_SIZE (Expected) - 1; Index++) {
+    UT_ASSERT_EQUAL (TestContext->Reads[Index].Lba, Lba);
+    UT_ASSERT_EQUAL (TestContext->Reads[Index].Count, Expected[Index]);
+    Lba += Expected[Index];
+  }
+
+  UT_ASSERT_EQUAL (TestContext->Reads[Index].Lba, 700);
+  UT_ASSERT_EQUAL (TestContext->Reads[Index].Count, Expected[Index]);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The dirty blocks are kept until they are flushed, and consecutive dirty
+  blocks are written by a single request of up to PcdDiskIoDataBufferBlockNum
+  blocks. A request that bypasses the cache writes only the dirty blocks it
+  accesses.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+WriteBackCoalescesDirtyBlocks (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT   *TestContext;
+  DISK_IO_CACHE  *Cache;
+  TEST_REQUEST   Expected[6];
+  UINTN          Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Cache       = TestContext->Instance.Cache;
+  UT_ASSERT_TRUE (Cache->WriteBack);
+  UT_ASSERT_EQUAL (PcdGet32 (PcdDiskIoDataBufferBlockNum), 8);
+
+  for (Index = 0; Index < ARRAY_SIZE (mDirtyLbas); Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (TestWriteBlockThroughCache (TestContext, mDirtyLbas[Index], (UINT8)Index));
+  }
+
+  for (Index = 0; Index < 20; Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (TestWriteBlockThroughCache (TestContext, 59 - Index, (UINT8)(0x80 + Index)));
+  }
+
+  UT_ASSERT_EQUAL (TestContext->WriteCount, 0);
+  UT_ASSERT_EQUAL (Cache->DirtyCount, ARRAY_SIZE (mDirtyLbas) + 20);
+  UT_ASSERT_TRUE (DirtyListIsConsistent (Cache));
+
+  //
+  // A read that bypasses the cache writes the dirty block it reads.
+  //
+  UT_ASSERT_NOT_EFI_ERROR (DiskIoCacheSync (&TestContext->Instance, FALSE, 12 * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE));
+  UT_ASSERT_EQUAL (TestContext->WriteCount, 1);
+  UT_ASSERT_EQUAL (TestContext->Writes[0].Lba, 12);
+  UT_ASSERT_EQUAL (TestContext->Writes[0].Count, 1);
+  UT_ASSERT_TRUE (DirtyListIsConsistent (Cache));
+
+  Expected[0].Lba   = 10;
+  Expected[0].Count = 2;
+  Expected[1].Lba   = 13;
+  Expected[1].Count = 1;
+  Expected[2].Lba   = 30;
+  Expected[2].Count = 2;
+  Expected[3].Lba   = 40;
+  Expected[3].Count = 8;
+  Expected[4].Lba   = 48;
+  Expected[4].Count = 8;
+  Expected[5].Lba   = 56;
+  Expected[5].Count = 4;
+
+  UT_ASSERT_NOT_EFI_ERROR (DiskIoCacheFlush (&TestContext->Instance));
+  UT_ASSERT_EQUAL (TestContext->WriteCount, 1 + ARRAY_SIZE (Expected));
+  for (Index = 0; Index < ARRAY_SIZE (Expected); Index++) {
+    UT_ASSERT_EQUAL (TestContext->Writes[1 + Index].Lba, Expected[Index].Lba);
+    UT_ASSERT_EQUAL (TestContext->Writes[1 + Index].Count, Expected[Index].Count);
+  }
+
+  UT_ASSERT_EQUAL (Cache->DirtyCount, 0);
+  UT_ASSERT_TRUE (DirtyListIsConsistent (Cache));
+  UT_ASSERT_MEM_EQUAL (TestContext->Disk, TestContext->Model, TEST_BLOCK_NUM * TEST_BLOCK_SIZE);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A device without Block I/O 2 cannot be flushed through DiskIo2, so its cache
+  writes through.
+
+  @param[in]  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+WriteThroughWithoutBlockIo2 (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  UT_ASSERT_FALSE (TestContext->Instance.Cache->WriteBack);
+
+  UT_ASSERT_NOT_EFI_ERROR (TestWriteBlockThroughCache (TestContext, 5, 0xA5));
+  UT_ASSERT_EQUAL (TestContext->WriteCount, 1);
+  UT_ASSERT_EQUAL (TestContext->Instance.Cache->DirtyCount, 0);
+  UT_ASSERT_MEM_EQUAL (TestContext->Disk, TestContext->Model, TEST_BLOCK_NUM * TEST_BLOCK_SIZE);
+  return UNIT_TEST_PASSED;
+}
+
+STATIC TEST_CONTEXT  mWriteBackContext    = { TRUE, TRUE };
+STATIC TEST_CONTEXT  mWriteThroughContext = { FALSE, TRUE };
+STATIC TEST_CONTEXT  mNoBlockIo2Context   = { TRUE, FALSE };
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the block
+  cache and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      DiskIoCacheTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&DiskIoCacheTests, Framework, "DiskIo Block Cache Tests", "DiskIoCache", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for DiskIoCacheTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (DiskIoCacheTests, "Random write-back accesses match the model", "RandomWriteBack", RandomAccessesMatchModel, CreateCache, FreeCache, &mWriteBackContext);
+  AddTestCase (DiskIoCacheTests, "Random write-through accesses match the model", "RandomWriteThrough", RandomAccessesMatchModel, CreateCache, FreeCache, &mWriteThroughContext);
+  AddTestCase (DiskIoCacheTests, "The least recently used block is replaced", "Lru", LeastRecentlyUsedBlockReplaced, CreateCache, FreeCache, &mWriteThroughContext);
+  AddTestCase (DiskIoCacheTests, "The read-ahead grows on sequential reads", "ReadAhead", ReadAheadGrowsOnSequentialReads, CreateCache, FreeCache, &mWriteThroughContext);
+  AddTestCase (DiskIoCacheTests, "Write-back coalesces the dirty blocks", "WriteBack", WriteBackCoalescesDirtyBlocks, CreateCache, FreeCache, &mWriteBackContext);
+  AddTestCase (DiskIoCacheTests, "A device without Block I/O 2 is write-through", "NoBlockIo2", WriteThroughWithoutBlockIo2, CreateCache, FreeCache, &mNoBlockIo2Context);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define DiskIoCacheUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+DiskIoCacheUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
@@ -771,6 +771,15 @@ PartitionFlushBlocks (
 
   Private = PARTITION_DEVICE_FROM_BLOCK_IO_THIS (This);
 
+  //
+  // The partition is accessed through the Disk IO protocol of the parent, so
+  // flush it through Disk IO 2 as well, which also writes the data cached by
+  // the Disk IO driver.
+  //
+  if (Private->DiskIo2 != NULL) {
+    return Private->DiskIo2->FlushDiskEx (Private->DiskIo2, NULL);
+  }
+
   return Private->ParentBlockIo->FlushBlocks (Private->ParentBlockIo);
 }
 
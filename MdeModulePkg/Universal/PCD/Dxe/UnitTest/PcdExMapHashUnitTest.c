@@ -0,0 +1,469 @@
+/** @file
+  Host based unit tests of the ExMap hash table lookup of the PCD DXE driver.
+
+  Service.c is built with the services of the rest of the driver replaced by
+  the stubs below. The ExMap and GUID tables below are those of 24 DynamicEx
+  PCDs of three token spaces, and the ExMap hash table is the one that
+  BuildExMapHashTable() of BaseTools/Source/Python/AutoGen/GenPcdDb.py
+  generates for them. BaseTools/Tests/TestPcdExMapHash.py checks that the
+  generator still builds this table and hashes to the values below, so the
+  two tests fail together if the generator and the driver no longer agree.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../Service.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_APP_NAME     "PCD DXE ExMap Hash Table Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_GUID_COUNT   3
+#define TEST_TOKEN_COUNT  24
+
+typedef struct {
+  PCD_DATABASE_INIT       Header;
+  DYNAMICEX_MAPPING       ExMapTable[TEST_TOKEN_COUNT];
+  DYNAMICEX_HASH_ENTRY    ExMapHashTable[TEST_TOKEN_COUNT];
+  EFI_GUID                GuidTable[TEST_GUID_COUNT];
+} TEST_PCD_DATABASE;
+
+STATIC CONST EFI_GUID  mTestGuidTable[TEST_GUID_COUNT] = {
+  { 0x914AEBE7, 0x4635, 0x459b, { 0xAA, 0x1C, 0x11, 0xE2, 0x19, 0xB0, 0x3A, 0x10 }
+  },
+  { 0xA1AFF049, 0xFDEB, 0x442a, { 0xB3, 0x20, 0x13, 0xAB, 0x4C, 0xB7, 0x2B, 0xBC }
+  },
+  { 0x3C7D193C, 0x682C, 0x4C14, { 0xA6, 0x8F, 0x55, 0x2D, 0xEA, 0x4F, 0x43, 0x7E }
+  }
+};
+
+STATIC CONST DYNAMICEX_MAPPING  mTestExMapTable[TEST_TOKEN_COUNT] = {
+  { 0x10000, 1,  0 },
+  { 0x10001, 2,  1 },
+  { 0x10002, 3,  2 },
+  { 0x10011, 4,  0 },
+  { 0x10012, 5,  1 },
+  { 0x10013, 6,  2 },
+  { 0x10022, 7,  0 },
+  { 0x10023, 8,  1 },
+  { 0x10024, 9,  2 },
+  { 0x10033, 10, 0 },
+  { 0x10034, 11, 1 },
+  { 0x10035, 12, 2 },
+  { 0x10044, 13, 0 },
+  { 0x10045, 14, 1 },
+  { 0x10046, 15, 2 },
+  { 0x10055, 16, 0 },
+  { 0x10056, 17, 1 },
+  { 0x10057, 18, 2 },
+  { 0x10066, 19, 0 },
+  { 0x10067, 20, 1 },
+  { 0x10068, 21, 2 },
+  { 0x10077, 22, 0 },
+  { 0x10078, 23, 1 },
+  { 0x10079, 24, 2 }
+};
+
+//
+// Generated by BuildExMapHashTable () for the tables above. The buckets hold
+// one to three PCDs, so both seeded and direct displacements are used.
+//
+STATIC CONST DYNAMICEX_HASH_ENTRY  mTestExMapHashTable[TEST_TOKEN_COUNT] = {
+  { 0x00000004, 3,  0 },
+  { 0x00000001, 6,  0 },
+  { 0x00000007, 17, 0 },
+  { 0x80000013, 15, 0 },
+  { 0x80000011, 0,  0 },
+  { 0x00000001, 5,  0 },
+  { 0x00000000, 18, 0 },
+  { 0x00000000, 20, 0 },
+  { 0x8000000C, 19, 0 },
+  { 0x00000000, 1,  0 },
+  { 0x00000001, 10, 0 },
+  { 0x8000000A, 21, 0 },
+  { 0x80000009, 9,  0 },
+  { 0x80000004, 13, 0 },
+  { 0x00000000, 8,  0 },
+  { 0x00000000, 11, 0 },
+  { 0x00000000, 22, 0 },
+  { 0x00000000, 16, 0 },
+  { 0x00000001, 4,  0 },
+  { 0x00000000, 12, 0 },
+  { 0x00000000, 7,  0 },
+  { 0x00000000, 14, 0 },
+  { 0x00000003, 23, 0 },
+  { 0x80000000, 2,  0 }
+};
+
+//
+// Globals of Pcd.c
+//
+EFI_LOCK  mPcdDatabaseLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
+UINTN     mVpdBaseAddress  = 0;
+
+EFI_BOOT_SERVICES     *gBS = NULL;
+EFI_RUNTIME_SERVICES  *gRT = NULL;
+
+/**
+  Stub of the size service of the driver.
+
+  @param[in]  TokenNumber  The PCD token number.
+
+  @return 0.
+**/
+UINTN
+EFIAPI
+DxePcdGetSize (
+  IN UINTN  TokenNumber
+  )
+{
+  return 0;
+}
+
+/**
+  Stub of the lock service of UefiLib.
+
+  @param[in]  Lock  The lock.
+**/
+VOID
+EFIAPI
+EfiAcquireLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+}
+
+/**
+  Stub of the lock service of UefiLib.
+
+  @param[in]  Lock  The lock.
+**/
+VOID
+EFIAPI
+EfiReleaseLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+}
+
+/**
+  Stub of HobLib. There is no HOB list.
+
+  @param[in]  Guid  The GUID of the HOB.
+
+  @return NULL.
+**/
+VOID *
+EFIAPI
+GetFirstGuidHob (
+  IN CONST EFI_GUID  *Guid
+  )
+{
+  return NULL;
+}
+
+/**
+  Stub of HobLib. There is no HOB list.
+
+  @param[in]  Guid      The GUID of the HOB.
+  @param[in]  HobStart  The HOB to start from.
+
+  @return NULL.
+**/
+VOID *
+EFIAPI
+GetNextGuidHob (
+  IN CONST EFI_GUID  *Guid,
+  IN CONST VOID      *HobStart
+  )
+{
+  return NULL;
+}
+
+/**
+  Stub of DxeServicesLib. There is no firmware volume.
+
+  @param[in]   SectionType      The type of the section.
+  @param[in]   SectionInstance  The instance of the section.
+  @param[out]  Buffer           Returns the section.
+  @param[out]  Size             Returns the size of the section.
+
+  @retval EFI_NOT_FOUND  The section is not found.
+**/
+EFI_STATUS
+EFIAPI
+GetSectionFromFfs (
+  IN  EFI_SECTION_TYPE  SectionType,
+  IN  UINTN             SectionInstance,
+  OUT VOID              **Buffer,
+  OUT UINTN             *Size
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Install the test database as the DXE PCD database, with or without its
+  ExMap hash table.
+
+  @param[in]  Context    The test database.
+
+  @retval UNIT_TEST_PASSED  The database is installed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+PcdExMapHashTestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_PCD_DATABASE  *Database;
+
+  Database = (TEST_PCD_DATABASE *)Context;
+  ZeroMem (Database, sizeof (TEST_PCD_DATABASE));
+  CopyGuid (&Database->Header.Signature, &gPcdDataBaseSignatureGuid);
+  Database->Header.BuildVersion         = PCD_SERVICE_DXE_VERSION;
+  Database->Header.Length               = sizeof (TEST_PCD_DATABASE);
+  Database->Header.ExMapTableOffset     = OFFSET_OF (TEST_PCD_DATABASE, ExMapTable);
+  Database->Header.ExMapHashTableOffset = OFFSET_OF (TEST_PCD_DATABASE, ExMapHashTable);
+  Database->Header.GuidTableOffset      = OFFSET_OF (TEST_PCD_DATABASE, GuidTable);
+  Database->Header.ExTokenCount         = TEST_TOKEN_COUNT;
+  Database->Header.GuidTableCount       = TEST_GUID_COUNT;
+  CopyMem (Database->ExMapTable, mTestExMapTable, sizeof (mTestExMapTable));
+  CopyMem (Database->ExMapHashTable, mTestExMapHashTable, sizeof (mTestExMapHashTable));
+  CopyMem (Database->GuidTable, mTestGuidTable, sizeof (mTestGuidTable));
+
+  mPcdDatabase.PeiDb = NULL;
+  mPcdDatabase.DxeDb = &Database->Header;
+  mPeiDatabaseEmpty  = TRUE;
+  mDxeGuidTableSize  = sizeof (mTestGuidTable);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check the hash of the driver against values of ExMapHash () of GenPcdDb.py.
+
+  @param[in]  Context    The test database.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+HashMatchesGenerator (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UT_ASSERT_EQUAL (PcdExMapHash (&mTestGuidTable[0], 0x10000, 0), 0xAB42E305);
+  UT_ASSERT_EQUAL (PcdExMapHash (&mTestGuidTable[0], 0x10000, 1), 0xA12BD747);
+  UT_ASSERT_EQUAL (PcdExMapHash (&mTestGuidTable[0], 0x10000, 0x1234), 0x1D072323);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that every PCD is found in the generated hash table, and that PCDs
+  that are not in the database are not.
+
+  @param[in]  Context    The test database.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+EveryPcdIsInHashTable (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_PCD_DATABASE  *Database;
+  EFI_GUID           UnknownGuid;
+  UINTN              Index;
+
+  Database = (TEST_PCD_DATABASE *)Context;
+
+  for (Index = 0; Index < TEST_TOKEN_COUNT; Index++) {
+    UT_ASSERT_EQUAL (
+      GetExPcdTokenNumberFromHashTable (
+        &Database->Header,
+        &mTestGuidTable[mTestExMapTable[Index].ExGuidIndex],
+        mTestExMapTable[Index].ExTokenNumber
+        ),
+      mTestExMapTable[Index].TokenNumber
+      );
+
+    //
+    // The same token number in another token space
+    //
+    UT_ASSERT_EQUAL (
+      GetExPcdTokenNumberFromHashTable (
+        &Database->Header,
+        &mTestGuidTable[(mTestExMapTable[Index].ExGuidIndex + 1) % TEST_GUID_COUNT],
+        mTestExMapTable[Index].ExTokenNumber
+        ),
+      PCD_INVALID_TOKEN_NUMBER
+      );
+  }
+
+  CopyGuid (&UnknownGuid, &mTestGuidTable[0]);
+  UnknownGuid.Data4[7] ^= 0x01;
+  for (Index = 0; Index < 0x100; Index++) {
+    UT_ASSERT_EQUAL (
+      GetExPcdTokenNumberFromHashTable (&Database->Header, &UnknownGuid, 0x10000 + (UINT32)Index),
+      PCD_INVALID_TOKEN_NUMBER
+      );
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that GetExPcdTokenNumber () returns the same token numbers with and
+  without the hash table.
+
+  @param[in]  Context    The test database.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LookupMatchesSearch (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_PCD_DATABASE  *Database;
+  UINTN              Index;
+  UINTN              TokenNumber;
+
+  Database = (TEST_PCD_DATABASE *)Context;
+
+  for (Index = 0; Index < TEST_TOKEN_COUNT; Index++) {
+    Database->Header.ExMapHashTableOffset = OFFSET_OF (TEST_PCD_DATABASE, ExMapHashTable);
+    TokenNumber                           = GetExPcdTokenNumber (
+                                              &mTestGuidTable[mTestExMapTable[Index].ExGuidIndex],
+                                              mTestExMapTable[Index].ExTokenNumber
+                                              );
+    UT_ASSERT_EQUAL (TokenNumber, mTestExMapTable[Index].TokenNumber);
+
+    Database->Header.ExMapHashTableOffset = 0;
+    UT_ASSERT_EQUAL (
+      GetExPcdTokenNumber (
+        &mTestGuidTable[mTestExMapTable[Index].ExGuidIndex],
+        mTestExMapTable[Index].ExTokenNumber
+        ),
+      TokenNumber
+      );
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the ExMap
+  hash table lookup and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      ExMapHashTests;
+  TEST_PCD_DATABASE           *Database;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  Database = AllocateZeroPool (sizeof (TEST_PCD_DATABASE));
+  if (Database == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the ExMap hash table Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&ExMapHashTests, Framework, "ExMap Hash Table Tests", "PcdDxe.ExMapHash", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for ExMap Hash Table Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite---------Description------------------------------------------Name------------Function---------------Pre--------------------Post---Context---
+  //
+  AddTestCase (ExMapHashTests, "Hash matches the generator", "Hash", HashMatchesGenerator, PcdExMapHashTestSetup, NULL, Database);
+  AddTestCase (ExMapHashTests, "Every PCD is in the generated hash table", "HashTable", EveryPcdIsInHashTable, PcdExMapHashTestSetup, NULL, Database);
+  AddTestCase (ExMapHashTests, "Lookups match the ExMap table search", "Lookup", LookupMatchesSearch, PcdExMapHashTestSetup, NULL, Database);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  if (Database != NULL) {
+    FreePool (Database);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define PcdExMapHashUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+PcdExMapHashUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
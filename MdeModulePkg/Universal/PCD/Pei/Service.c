@@ -959,6 +959,106 @@ GetWorker (
   return NULL;
 }
 
+/**
+  Compute the hash of a dynamic-ex PCD used in the ExMap hash table of the
+  PCD database.
+
+  It must match ExMapHash() in BaseTools/Source/Python/AutoGen/GenPcdDb.py.
+
+  @param Guid            Token space guid for dynamic-ex PCD entry.
+  @param ExTokenNumber   Token number for dynamic-ex PCD.
+  @param Seed            Seed of the hash.
+
+  @return The 32-bit hash of the PCD.
+
+**/
+UINT32
+PcdExMapHash (
+  IN CONST EFI_GUID  *Guid,
+  IN UINT32          ExTokenNumber,
+  IN UINT32          Seed
+  )
+{
+  CONST UINT8  *Bytes;
+  UINT32       Hash;
+  UINTN        Index;
+
+  //
+  // FNV-1a of the GUID followed by the little endian token number
+  //
+  Hash  = 0x811C9DC5 ^ Seed;
+  Bytes = (CONST UINT8 *)Guid;
+  for (Index = 0; Index < sizeof (EFI_GUID); Index++) {
+    Hash = (Hash ^ Bytes[Index]) * 0x01000193;
+  }
+
+  for (Index = 0; Index < sizeof (UINT32); Index++) {
+    Hash = (Hash ^ (UINT8)(ExTokenNumber >> (Index * 8))) * 0x01000193;
+  }
+
+  //
+  // fmix32 of MurmurHash3
+  //
+  Hash ^= Hash >> 16;
+  Hash *= 0x85EBCA6B;
+  Hash ^= Hash >> 13;
+  Hash *= 0xC2B2AE35;
+  Hash ^= Hash >> 16;
+
+  return Hash;
+}
+
+/**
+  Get Token Number of a dynamic-ex PCD from the ExMap hash table of a PCD
+  database.
+
+  @param Database        PCD database that has an ExMap hash table.
+  @param Guid            Token space guid for dynamic-ex PCD entry.
+  @param ExTokenNumber   Token number for dynamic-ex PCD.
+
+  @return Token Number for dynamic-ex PCD, or PCD_INVALID_TOKEN_NUMBER if the
+          PCD is not in the database.
+
+**/
+UINTN
+GetExPcdTokenNumberFromHashTable (
+  IN PCD_DATABASE_INIT  *Database,
+  IN CONST EFI_GUID     *Guid,
+  IN UINT32             ExTokenNumber
+  )
+{
+  DYNAMICEX_HASH_ENTRY  *HashTable;
+  DYNAMICEX_MAPPING     *ExMap;
+  EFI_GUID              *GuidTable;
+  UINT32                Displacement;
+  UINT32                Slot;
+
+  ASSERT (Database->ExMapHashTableOffset != 0);
+
+  HashTable = (DYNAMICEX_HASH_ENTRY *)((UINT8 *)Database + Database->ExMapHashTableOffset);
+  ExMap     = (DYNAMICEX_MAPPING *)((UINT8 *)Database + Database->ExMapTableOffset);
+  GuidTable = (EFI_GUID *)((UINT8 *)Database + Database->GuidTableOffset);
+
+  Displacement = HashTable[PcdExMapHash (Guid, ExTokenNumber, 0) % Database->ExTokenCount].Displacement;
+  if ((Displacement & PCD_EX_MAP_HASH_DIRECT) != 0) {
+    Slot = Displacement & ~PCD_EX_MAP_HASH_DIRECT;
+  } else {
+    Slot = PcdExMapHash (Guid, ExTokenNumber, Displacement) % Database->ExTokenCount;
+  }
+
+  ASSERT (Slot < Database->ExTokenCount);
+  ExMap += HashTable[Slot].ExMapIndex;
+
+  //
+  // Any PCD hashes to a slot, so the PCD of the slot must be checked.
+  //
+  if ((ExMap->ExTokenNumber != ExTokenNumber) || !CompareGuid (&GuidTable[ExMap->ExGuidIndex], Guid)) {
+    return PCD_INVALID_TOKEN_NUMBER;
+  }
+
+  return ExMap->TokenNumber;
+}
+
 /**
   Get Token Number according to dynamic-ex PCD's {token space guid:token number}
 
@@ -984,9 +1084,21 @@ GetExPcdTokenNumber (
   EFI_GUID           *MatchGuid;
   UINTN              MatchGuidIdx;
   PEI_PCD_DATABASE   *PeiPcdDb;
+  UINTN              TokenNumber;
 
   PeiPcdDb = GetPcdDatabase ();
 
+  //
+  // Look up the PCD in the hash table first. A PCD that is not found there
+  // is searched again below, to report it.
+  //
+  if (PeiPcdDb->ExMapHashTableOffset != 0) {
+    TokenNumber = GetExPcdTokenNumberFromHashTable (PeiPcdDb, Guid, (UINT32)ExTokenNumber);
+    if (TokenNumber != PCD_INVALID_TOKEN_NUMBER) {
+      return TokenNumber;
+    }
+  }
+
   ExMap     = (DYNAMICEX_MAPPING *)((UINT8 *)PeiPcdDb + PeiPcdDb->ExMapTableOffset);
   GuidTable = (EFI_GUID *)((UINT8 *)PeiPcdDb + PeiPcdDb->GuidTableOffset);
 
@@ -31,7 +31,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 // Please make sure the PCD Serivce PEIM Version is consistent with
 // the version of the generated PEIM PCD Database by build tool.
 //
-#define PCD_SERVICE_PEIM_VERSION  7
+#define PCD_SERVICE_PEIM_VERSION  8
 
 //
 // PCD_PEI_SERVICE_DRIVER_VERSION is defined in Autogen.h.
@@ -969,6 +969,43 @@ typedef struct {
   UINT32    LocalTokenNumberAlias;
 } EX_PCD_ENTRY_ATTRIBUTE;
 
+/**
+  Compute the hash of a dynamic-ex PCD used in the ExMap hash table of the
+  PCD database.
+
+  @param Guid            Token space guid for dynamic-ex PCD entry.
+  @param ExTokenNumber   Token number for dynamic-ex PCD.
+  @param Seed            Seed of the hash.
+
+  @return The 32-bit hash of the PCD.
+
+**/
+UINT32
+PcdExMapHash (
+  IN CONST EFI_GUID  *Guid,
+  IN UINT32          ExTokenNumber,
+  IN UINT32          Seed
+  );
+
+/**
+  Get Token Number of a dynamic-ex PCD from the ExMap hash table of a PCD
+  database.
+
+  @param Database        PCD database that has an ExMap hash table.
+  @param Guid            Token space guid for dynamic-ex PCD entry.
+  @param ExTokenNumber   Token number for dynamic-ex PCD.
+
+  @return Token Number for dynamic-ex PCD, or PCD_INVALID_TOKEN_NUMBER if the
+          PCD is not in the database.
+
+**/
+UINTN
+GetExPcdTokenNumberFromHashTable (
+  IN PCD_DATABASE_INIT  *Database,
+  IN CONST EFI_GUID     *Guid,
+  IN UINT32             ExTokenNumber
+  );
+
 /**
   Get Token Number according to dynamic-ex PCD's {token space guid:token number}
 
@@ -85,6 +85,78 @@ GetLbaAndOffsetByAddress (
   return EFI_ABORTED;
 }
 
+/**
+  Gets the block size of the non-volatile variable store in flash and
+  allocates the erase counters of its blocks.
+
+  The counters are kept in memory for the current boot, they are only updated
+  when PcdVariableReclaimDirtyBlocks is TRUE. They are not allocated if the
+  blocks of the store do not all have the same size, reclaim then writes the
+  whole store.
+
+  @param  VariableBase   Base address of the variable store in flash.
+
+**/
+VOID
+InitializeVariableStoreBlocks (
+  IN EFI_PHYSICAL_ADDRESS  VariableBase
+  )
+{
+  EFI_STATUS                          Status;
+  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *Fvb;
+  EFI_LBA                             VarLba;
+  EFI_LBA                             Lba;
+  UINTN                               VarOffset;
+  UINTN                               StoreEnd;
+  UINTN                               BlockSize;
+  UINTN                               Size;
+  UINTN                               NumberOfBlocks;
+  UINTN                               BlockCount;
+
+  Status = GetFvbInfoByAddress (VariableBase, NULL, &Fvb);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  Status = GetLbaAndOffsetByAddress (VariableBase, &VarLba, &VarOffset);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  Status = Fvb->GetBlockSize (Fvb, VarLba, &BlockSize, &NumberOfBlocks);
+  if (EFI_ERROR (Status) || (BlockSize == 0)) {
+    return;
+  }
+
+  //
+  // The changed blocks are found by their index from the first block of the
+  // store, so all the blocks of the store must have the same size. Query the
+  // block size again whenever the blocks of a region are used up.
+  //
+  StoreEnd = VarOffset + ((VARIABLE_STORE_HEADER *)(UINTN)VariableBase)->Size;
+  Lba      = VarLba;
+  for (BlockCount = 0; BlockCount * BlockSize < StoreEnd; BlockCount++) {
+    if (NumberOfBlocks == 0) {
+      Status = Fvb->GetBlockSize (Fvb, Lba, &Size, &NumberOfBlocks);
+      if (EFI_ERROR (Status) || (Size != BlockSize) || (NumberOfBlocks == 0)) {
+        DEBUG ((DEBUG_WARN, "Variable: The blocks of the variable store do not have the same size, reclaim writes the whole store\n"));
+        return;
+      }
+    }
+
+    NumberOfBlocks--;
+    Lba++;
+  }
+
+  mVariableModuleGlobal->NvBlockEraseCount = AllocateRuntimeZeroPool (BlockCount * sizeof (UINT32));
+  if (mVariableModuleGlobal->NvBlockEraseCount == NULL) {
+    return;
+  }
+
+  mVariableModuleGlobal->NvBlockSize  = BlockSize;
+  mVariableModuleGlobal->NvBlockCount = BlockCount;
+}
+
 /**
   Writes a buffer to variable storage space, in the working block.
 
@@ -92,6 +164,10 @@ GetLbaAndOffsetByAddress (
   volume block device. The destination is specified by parameter
   VariableBase. Fault Tolerant Write protocol is used for writing.
 
+  If PcdVariableReclaimDirtyBlocks is TRUE, only the range of blocks that
+  differ from the buffer is written, with a single FTW write so that the
+  update of the store remains fault tolerant.
+
   @param  VariableBase   Base address of variable to write
   @param  VariableBuffer Point to the variable data buffer.
 
@@ -112,6 +188,14 @@ FtwVariableSpace (
   UINTN                              VarOffset;
   UINTN                              FtwBufferSize;
   EFI_FAULT_TOLERANT_WRITE_PROTOCOL  *FtwProtocol;
+  UINTN                              WriteOffset;
+  UINTN                              BlockSize;
+  UINTN                              Block;
+  UINTN                              FirstBlock;
+  UINTN                              LastBlock;
+  UINTN                              BlockStart;
+  UINTN                              BlockEnd;
+  UINT32                             MaxEraseCount;
 
   //
   // Locate fault tolerant write protocol.
@@ -140,18 +224,73 @@ FtwVariableSpace (
   FtwBufferSize = ((VARIABLE_STORE_HEADER *)((UINTN)VariableBase))->Size;
   ASSERT (FtwBufferSize == VariableBuffer->Size);
 
+  WriteOffset = 0;
+  BlockSize   = mVariableModuleGlobal->NvBlockSize;
+  FirstBlock  = 0;
+  LastBlock   = 0;
+  if (FeaturePcdGet (PcdVariableReclaimDirtyBlocks) && (BlockSize != 0)) {
+    //
+    // Find the first and the last block of the store that differ from the
+    // buffer. Block N of the store holds bytes [N * BlockSize - VarOffset,
+    // (N + 1) * BlockSize - VarOffset) of the store. The blocks that hold the
+    // variables preceding the first reclaimed one, and the erased blocks at
+    // the end of the store, are then neither erased nor written.
+    //
+    FirstBlock = MAX_UINTN;
+    for (Block = 0; Block < mVariableModuleGlobal->NvBlockCount; Block++) {
+      BlockStart = (Block == 0) ? 0 : Block * BlockSize - VarOffset;
+      BlockEnd   = MIN ((Block + 1) * BlockSize - VarOffset, FtwBufferSize);
+      if (CompareMem ((UINT8 *)(UINTN)VariableBase + BlockStart, (UINT8 *)VariableBuffer + BlockStart, BlockEnd - BlockStart) != 0) {
+        if (FirstBlock == MAX_UINTN) {
+          FirstBlock = Block;
+        }
+
+        LastBlock = Block;
+      }
+    }
+
+    if (FirstBlock == MAX_UINTN) {
+      return EFI_SUCCESS;
+    }
+
+    WriteOffset   = (FirstBlock == 0) ? 0 : FirstBlock * BlockSize - VarOffset;
+    FtwBufferSize = MIN ((LastBlock + 1) * BlockSize - VarOffset, FtwBufferSize) - WriteOffset;
+    VarLba       += FirstBlock;
+    VarOffset     = (FirstBlock == 0) ? VarOffset : 0;
+  }
+
   //
   // FTW write record.
   //
   Status = FtwProtocol->Write (
                           FtwProtocol,
-                          VarLba,                // LBA
-                          VarOffset,             // Offset
-                          FtwBufferSize,         // NumBytes
-                          NULL,                  // PrivateData NULL
-                          FvbHandle,             // Fvb Handle
-                          (VOID *)VariableBuffer // write buffer
+                          VarLba,                                // LBA
+                          VarOffset,                             // Offset
+                          FtwBufferSize,                         // NumBytes
+                          NULL,                                  // PrivateData NULL
+                          FvbHandle,                             // Fvb Handle
+                          (UINT8 *)VariableBuffer + WriteOffset  // write buffer
                           );
 
+  if (!EFI_ERROR (Status) && FeaturePcdGet (PcdVariableReclaimDirtyBlocks) && (BlockSize != 0)) {
+    for (Block = FirstBlock; Block <= LastBlock; Block++) {
+      mVariableModuleGlobal->NvBlockEraseCount[Block]++;
+    }
+
+    MaxEraseCount = 0;
+    for (Block = 0; Block < mVariableModuleGlobal->NvBlockCount; Block++) {
+      MaxEraseCount = MAX (MaxEraseCount, mVariableModuleGlobal->NvBlockEraseCount[Block]);
+    }
+
+    DEBUG ((
+      DEBUG_INFO,
+      "Variable: Reclaim wrote blocks %Lu - %Lu of %Lu, the most written block was erased %u times\n",
+      (UINT64)FirstBlock,
+      (UINT64)LastBlock,
+      (UINT64)mVariableModuleGlobal->NvBlockCount,
+      MaxEraseCount
+      ));
+  }
+
   return Status;
 }
@@ -0,0 +1,142 @@
+/** @file
+  Host based benchmark of the variable driver. The driver runs on a flash
+  device emulated in memory, with an emulated FVB and FTW protocol.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _VARIABLE_BENCHMARK_H_
+#define _VARIABLE_BENCHMARK_H_
+
+#include <Uefi.h>
+
+#include "../Variable.h"
+
+///
+/// Size of the blocks of the emulated flash device.
+///
+#define VARIABLE_BENCHMARK_BLOCK_SIZE  SIZE_4KB
+
+typedef struct {
+  ///
+  /// Bytes programmed on the flash device. A fault tolerant write programs
+  /// each block it touches twice, in the spare block and in the target block.
+  ///
+  UINT64    BytesWritten;
+  UINT64    BlocksErased;
+  UINT64    FtwWriteCount;
+  ///
+  /// Bytes programmed through FVB that would set a bit of the flash device
+  /// from 0 to 1, which needs an erase on a real device.
+  ///
+  UINT64    ProgramErrors;
+} VARIABLE_BENCHMARK_FLASH_STATS;
+
+extern VARIABLE_MODULE_GLOBAL  *mVariableModuleGlobal;
+extern VARIABLE_STORE_HEADER   *mNvVariableCache;
+
+/**
+
+  Variable store garbage collection and reclaim operation.
+
+  @param[in]      VariableBase            Base address of variable store.
+  @param[out]     LastVariableOffset      Offset of last variable.
+  @param[in]      IsVolatile              The variable store is volatile or not;
+                                          if it is non-volatile, need FTW.
+  @param[in, out] UpdatingPtrTrack        Pointer to updating variable pointer track structure.
+  @param[in]      NewVariable             Pointer to new variable.
+  @param[in]      NewVariableSize         New variable size.
+
+  @return EFI_SUCCESS                  Reclaim operation has finished successfully.
+  @return EFI_OUT_OF_RESOURCES         No enough memory resources or variable space.
+  @return Others                       Unexpect error happened during reclaim operation.
+
+**/
+EFI_STATUS
+Reclaim (
+  IN     EFI_PHYSICAL_ADDRESS    VariableBase,
+  OUT    UINTN                   *LastVariableOffset,
+  IN     BOOLEAN                 IsVolatile,
+  IN OUT VARIABLE_POINTER_TRACK  *UpdatingPtrTrack,
+  IN     VARIABLE_HEADER         *NewVariable,
+  IN     UINTN                   NewVariableSize
+  );
+
+/**
+  Create the emulated flash device with an empty variable store.
+
+  @param[in] NvStorageSize      Size of the variable firmware volume, a multiple
+                                of VARIABLE_BENCHMARK_BLOCK_SIZE.
+
+  @retval EFI_SUCCESS           The flash device was created.
+  @retval EFI_OUT_OF_RESOURCES  The flash device could not be allocated.
+
+**/
+EFI_STATUS
+CreateBenchmarkFlash (
+  IN UINTN  NvStorageSize
+  );
+
+/**
+  Free the emulated flash device. The variable driver must be stopped.
+
+**/
+VOID
+FreeBenchmarkFlash (
+  VOID
+  );
+
+/**
+  Initialize the variable driver from the content of the emulated flash
+  device, the way the DXE variable driver does once the FTW protocol is
+  available.
+
+  @retval EFI_SUCCESS           The variable services can be used.
+  @retval Others                The variable driver failed to initialize.
+
+**/
+EFI_STATUS
+StartBenchmarkVariableDriver (
+  VOID
+  );
+
+/**
+  Free the resources of the variable driver, as if the platform was reset.
+  The content of the emulated flash device is kept.
+
+**/
+VOID
+StopBenchmarkVariableDriver (
+  VOID
+  );
+
+/**
+  Return the statistics of the emulated flash device since it was created.
+
+  @param[out] Stats             Returns the statistics.
+
+**/
+VOID
+GetBenchmarkFlashStats (
+  OUT VARIABLE_BENCHMARK_FLASH_STATS  *Stats
+  );
+
+/**
+  Make writes of the emulated flash device fail, through FVB or FTW, without
+  programming anything.
+
+  @param[in] WritesBeforeFailure  Number of writes that succeed before the
+                                  first write that fails.
+  @param[in] FailureCount         Number of writes that fail, MAX_UINT64 for
+                                  all of them, 0 to stop the failures.
+
+**/
+VOID
+SetBenchmarkFlashWriteFailure (
+  IN UINT64  WritesBeforeFailure,
+  IN UINT64  FailureCount
+  );
+
+#endif
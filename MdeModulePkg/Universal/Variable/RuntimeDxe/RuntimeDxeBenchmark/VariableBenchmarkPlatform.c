@@ -0,0 +1,1141 @@
+/** @file
+  Platform layer of the host based benchmark of the variable driver.
+
+  This file replaces VariableDxe.c, Measurement.c and TcgMorLockDxe.c of the
+  DXE variable driver. It emulates the flash device of the variable store in
+  memory, with the FVB and FTW protocols consumed by the driver, and provides
+  the services of the libraries that have no host instance.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "VariableBenchmark.h"
+#include "../VariableIndex.h"
+
+extern VARIABLE_STORE_INDEX        mVariableStoreIndex[VariableStoreTypeMax];
+extern EFI_FIRMWARE_VOLUME_HEADER  *mNvFvHeaderCache;
+
+typedef struct {
+  EFI_FIRMWARE_VOLUME_HEADER    FvHeader;
+  EFI_FV_BLOCK_MAP_ENTRY        BlockMapTerminator;
+} VARIABLE_BENCHMARK_FV_HEADER;
+
+UINT8                           *mBenchmarkFlash              = NULL;
+UINTN                           mBenchmarkFlashSize           = 0;
+UINT8                           mBenchmarkFvbHandle           = 0;
+VARIABLE_BENCHMARK_FLASH_STATS  mBenchmarkFlashStats          = { 0 };
+UINT64                          mBenchmarkWritesBeforeFailure = 0;
+UINT64                          mBenchmarkWriteFailures       = 0;
+
+/**
+  Check whether the next write of the emulated flash device fails, as set by
+  SetBenchmarkFlashWriteFailure().
+
+  @retval TRUE                  The write fails.
+  @retval FALSE                 The write succeeds.
+
+**/
+BOOLEAN
+IsBenchmarkFlashWriteFailing (
+  VOID
+  )
+{
+  if (mBenchmarkWriteFailures == 0) {
+    return FALSE;
+  }
+
+  if (mBenchmarkWritesBeforeFailure != 0) {
+    mBenchmarkWritesBeforeFailure--;
+    return FALSE;
+  }
+
+  if (mBenchmarkWriteFailures != MAX_UINT64) {
+    mBenchmarkWriteFailures--;
+  }
+
+  return TRUE;
+}
+
+/**
+  Return the address of a range of the emulated flash device.
+
+  @param[in] Lba                The block of the range.
+  @param[in] Offset             Offset of the range in the block.
+  @param[in] Length             Length of the range.
+
+  @return The address of the range, or NULL if it is outside the device.
+
+**/
+UINT8 *
+GetBenchmarkFlashRange (
+  IN EFI_LBA  Lba,
+  IN UINTN    Offset,
+  IN UINTN    Length
+  )
+{
+  UINT64  Start;
+
+  Start = MultU64x32 (Lba, VARIABLE_BENCHMARK_BLOCK_SIZE) + Offset;
+  if ((Start > mBenchmarkFlashSize) || (Length > mBenchmarkFlashSize - Start)) {
+    return NULL;
+  }
+
+  return mBenchmarkFlash + (UINTN)Start;
+}
+
+/**
+  Retrieves Volume attributes of the emulated flash device.
+
+  @param[in]  This              Indicates the EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL instance.
+  @param[out] Attributes        Pointer to EFI_FVB_ATTRIBUTES_2 in which the attributes are returned.
+
+  @retval EFI_SUCCESS           The attributes were returned.
+
+**/
+EFI_STATUS
+EFIAPI
+BenchmarkFvbGetAttributes (
+  IN CONST EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  OUT      EFI_FVB_ATTRIBUTES_2                *Attributes
+  )
+{
+  *Attributes = EFI_FVB2_READ_STATUS | EFI_FVB2_WRITE_STATUS | EFI_FVB2_ERASE_POLARITY;
+  return EFI_SUCCESS;
+}
+
+/**
+  Modifies the current settings of the emulated flash device.
+
+  @param[in]      This          Indicates the EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL instance.
+  @param[in, out] Attributes    The attributes to set.
+
+  @retval EFI_UNSUPPORTED       The attributes of the emulated flash device cannot be changed.
+
+**/
+EFI_STATUS
+EFIAPI
+BenchmarkFvbSetAttributes (
+  IN CONST EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  IN OUT   EFI_FVB_ATTRIBUTES_2                *Attributes
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Retrieves the base address of the emulated flash device.
+
+  @param[in]  This              Indicates the EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL instance.
+  @param[out] Address           Pointer to a caller-allocated EFI_PHYSICAL_ADDRESS.
+
+  @retval EFI_SUCCESS           The base address was returned.
+
+**/
+EFI_STATUS
+EFIAPI
+BenchmarkFvbGetPhysicalAddress (
+  IN CONST EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  OUT      EFI_PHYSICAL_ADDRESS                *Address
+  )
+{
+  *Address = (EFI_PHYSICAL_ADDRESS)(UINTN)mBenchmarkFlash;
+  return EFI_SUCCESS;
+}
+
+/**
+  Retrieves the size of the blocks of the emulated flash device.
+
+  @param[in]  This              Indicates the EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL instance.
+  @param[in]  Lba               Indicates the block for which to return the size.
+  @param[out] BlockSize         Pointer to a caller-allocated UINTN in which the size of the block is returned.
+  @param[out] NumberOfBlocks    Pointer to a caller-allocated UINTN in which the number of consecutive
+                                blocks, starting with Lba, is returned.
+
+  @retval EFI_SUCCESS           The size of the block was returned.
+  @retval EFI_INVALID_PARAMETER The requested LBA is out of range.
+
+**/
+EFI_STATUS
+EFIAPI
+BenchmarkFvbGetBlockSize (
+  IN CONST EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  IN       EFI_LBA                             Lba,
+  OUT      UINTN                               *BlockSize,
+  OUT      UINTN                               *NumberOfBlocks
+  )
+{
+  UINTN  BlockCount;
+
+  BlockCount = mBenchmarkFlashSize / VARIABLE_BENCHMARK_BLOCK_SIZE;
+  if (Lba >= BlockCount) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *BlockSize      = VARIABLE_BENCHMARK_BLOCK_SIZE;
+  *NumberOfBlocks = BlockCount - (UINTN)Lba;
+  return EFI_SUCCESS;
+}
+
+/**
+  Reads the specified number of bytes from the emulated flash device.
+
+  @param[in]      This          Indicates the EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL instance.
+  @param[in]      Lba           The starting logical block index from which to read.
+  @param[in]      Offset        Offset into the block at which to begin reading.
+  @param[in, out] NumBytes      Pointer to a UINTN. At entry, *NumBytes contains the total size of
+                                the buffer. At exit, *NumBytes contains the total number of bytes read.
+  @param[out]     Buffer        Pointer to a caller-allocated buffer that will be used to hold the data
+                                that is read.
+
+  @retval EFI_SUCCESS           The firmware volume was read successfully.
+  @retval EFI_BAD_BUFFER_SIZE   The range is outside the emulated flash device.
+
+**/
+EFI_STATUS
+EFIAPI
+BenchmarkFvbRead (
+  IN CONST EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  IN       EFI_LBA                             Lba,
+  IN       UINTN                               Offset,
+  IN OUT   UINTN                               *NumBytes,
+  OUT      UINT8                               *Buffer
+  )
+{
+  UINT8  *Flash;
+
+  Flash = GetBenchmarkFlashRange (Lba, Offset, *NumBytes);
+  if (Flash == NULL) {
+    *NumBytes = 0;
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  CopyMem (Buffer, Flash, *NumBytes);
+  return EFI_SUCCESS;
+}
+
+/**
+  Writes the specified number of bytes to the emulated flash device.
+
+  Like a NOR flash device, a write can only clear bits. The bytes that would
+  need a bit to be set are counted in the ProgramErrors statistic.
+
+  @param[in]      This          Indicates the EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL instance.
+  @param[in]      Lba           The starting logical block index to write to.
+  @param[in]      Offset        Offset into the block at which to begin writing.
+  @param[in, out] NumBytes      The pointer to a UINTN. At entry, *NumBytes contains the total size of
+                                the buffer. At exit, *NumBytes contains the total number of bytes
+                                actually written.
+  @param[in]      Buffer        The pointer to a caller-allocated buffer that contains the source for
+                                the write.
+
+  @retval EFI_SUCCESS           The firmware volume was written successfully.
+  @retval EFI_BAD_BUFFER_SIZE   The range is outside the emulated flash device.
+  @retval EFI_DEVICE_ERROR      A write failure was set, nothing was written.
+
+**/
+EFI_STATUS
+EFIAPI
+BenchmarkFvbWrite (
+  IN CONST EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  IN       EFI_LBA                             Lba,
+  IN       UINTN                               Offset,
+  IN OUT   UINTN                               *NumBytes,
+  IN       UINT8                               *Buffer
+  )
+{
+  UINT8  *Flash;
+  UINTN  Index;
+
+  Flash = GetBenchmarkFlashRange (Lba, Offset, *NumBytes);
+  if (Flash == NULL) {
+    *NumBytes = 0;
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  if (IsBenchmarkFlashWriteFailing ()) {
+    *NumBytes = 0;
+    return EFI_DEVICE_ERROR;
+  }
+
+  for (Index = 0; Index < *NumBytes; Index++) {
+    if ((~Flash[Index] & Buffer[Index]) != 0) {
+      mBenchmarkFlashStats.ProgramErrors++;
+    }
+
+    Flash[Index] &= Buffer[Index];
+  }
+
+  mBenchmarkFlashStats.BytesWritten += *NumBytes;
+  return EFI_SUCCESS;
+}
+
+/**
+  Erases blocks of the emulated flash device.
+
+  @param[in] This               Indicates the EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL instance.
+  @param[in] ...                The variable argument list is a list of tuples. Each tuple describes
+                                a range of LBAs to erase and consists of the starting LBA and the
+                                number of blocks to erase. The list is terminated with
+                                EFI_LBA_LIST_TERMINATOR.
+
+  @retval EFI_SUCCESS           The erase request successfully completed.
+  @retval EFI_INVALID_PARAMETER A range is outside the emulated flash device.
+
+**/
+EFI_STATUS
+EFIAPI
+BenchmarkFvbEraseBlocks (
+  IN CONST EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  ...
+  )
+{
+  VA_LIST  Args;
+  EFI_LBA  StartingLba;
+  UINTN    NumOfLba;
+  UINT8    *Flash;
+
+  VA_START (Args, This);
+  while (TRUE) {
+    StartingLba = VA_ARG (Args, EFI_LBA);
+    if (StartingLba == EFI_LBA_LIST_TERMINATOR) {
+      break;
+    }
+
+    NumOfLba = VA_ARG (Args, UINTN);
+    Flash    = GetBenchmarkFlashRange (StartingLba, 0, NumOfLba * VARIABLE_BENCHMARK_BLOCK_SIZE);
+    if (Flash == NULL) {
+      VA_END (Args);
+      return EFI_INVALID_PARAMETER;
+    }
+
+    SetMem (Flash, NumOfLba * VARIABLE_BENCHMARK_BLOCK_SIZE, 0xff);
+    mBenchmarkFlashStats.BlocksErased += NumOfLba;
+  }
+
+  VA_END (Args);
+  return EFI_SUCCESS;
+}
+
+EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  mBenchmarkFvb = {
+  BenchmarkFvbGetAttributes,
+  BenchmarkFvbSetAttributes,
+  BenchmarkFvbGetPhysicalAddress,
+  BenchmarkFvbGetBlockSize,
+  BenchmarkFvbRead,
+  BenchmarkFvbWrite,
+  BenchmarkFvbEraseBlocks,
+  NULL
+};
+
+/**
+  Get the size of the largest block that can be updated in a fault-tolerant
+  manner.
+
+  @param[in]  This              Indicates a pointer to the calling context.
+  @param[out] BlockSize         A pointer to a caller-allocated UINTN that is updated to indicate
+                                the size of the largest block that can be updated.
+
+  @retval EFI_SUCCESS           The function completed successfully.
+
+**/
+EFI_STATUS
+EFIAPI
+BenchmarkFtwGetMaxBlockSize (
+  IN EFI_FAULT_TOLERANT_WRITE_PROTOCOL  *This,
+  OUT UINTN                             *BlockSize
+  )
+{
+  *BlockSize = mBenchmarkFlashSize;
+  return EFI_SUCCESS;
+}
+
+/**
+  Allocates space to maintain information about writes. The emulated FTW
+  protocol needs none.
+
+  @param[in] This               A pointer to the calling context.
+  @param[in] CallerId           The GUID identifying the write.
+  @param[in] PrivateDataSize    The size of the caller's private data that must be recorded for
+                                each write.
+  @param[in] NumberOfWrites     The number of fault tolerant block writes that will need to occur.
+
+  @retval EFI_SUCCESS           The function completed successfully.
+
+**/
+EFI_STATUS
+EFIAPI
+BenchmarkFtwAllocate (
+  IN EFI_FAULT_TOLERANT_WRITE_PROTOCOL  *This,
+  IN EFI_GUID                           *CallerId,
+  IN UINTN                              PrivateDataSize,
+  IN UINTN                              NumberOfWrites
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Updates a range of the emulated flash device in a fault tolerant manner.
+
+  A real FTW driver backs up each block that the range touches in a spare
+  block before it erases and writes the block, so each block is counted twice
+  in the statistics.
+
+  @param[in] This               The calling context.
+  @param[in] Lba                The logical block address of the target block.
+  @param[in] Offset             The offset within the target block to place the data.
+  @param[in] Length             The number of bytes to write to the target block.
+  @param[in] PrivateData        A pointer to private data that the caller requires to
+                                complete any pending writes in the event of a fault.
+  @param[in] FvBlockHandle      The handle of FVB protocol that provides services for
+                                reading, writing, and erasing the target block.
+  @param[in] Buffer             The data to write.
+
+  @retval EFI_SUCCESS           The function completed successfully.
+  @retval EFI_BAD_BUFFER_SIZE   The range is outside the emulated flash device.
+  @retval EFI_DEVICE_ERROR      A write failure was set, nothing was written.
+
+**/
+EFI_STATUS
+EFIAPI
+BenchmarkFtwWrite (
+  IN EFI_FAULT_TOLERANT_WRITE_PROTOCOL  *This,
+  IN EFI_LBA                            Lba,
+  IN UINTN                              Offset,
+  IN UINTN                              Length,
+  IN VOID                               *PrivateData,
+  IN EFI_HANDLE                         FvBlockHandle,
+  IN VOID                               *Buffer
+  )
+{
+  UINT8  *Flash;
+  UINTN  BlockCount;
+
+  Flash = GetBenchmarkFlashRange (Lba, Offset, Length);
+  if ((Flash == NULL) || (Length == 0)) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  if (IsBenchmarkFlashWriteFailing ()) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  CopyMem (Flash, Buffer, Length);
+
+  BlockCount                          = (Offset + Length + VARIABLE_BENCHMARK_BLOCK_SIZE - 1) / VARIABLE_BENCHMARK_BLOCK_SIZE;
+  mBenchmarkFlashStats.BytesWritten  += 2 * BlockCount * VARIABLE_BENCHMARK_BLOCK_SIZE;
+  mBenchmarkFlashStats.BlocksErased  += 2 * BlockCount;
+  mBenchmarkFlashStats.FtwWriteCount += 1;
+  return EFI_SUCCESS;
+}
+
+/**
+  Restarts a previously interrupted write. The writes of the emulated FTW
+  protocol cannot be interrupted.
+
+  @param[in] This               The calling context.
+  @param[in] FvBlockHandle      The handle of FVB protocol that provides services.
+
+  @retval EFI_NOT_FOUND         No pending writes exist.
+
+**/
+EFI_STATUS
+EFIAPI
+BenchmarkFtwRestart (
+  IN EFI_FAULT_TOLERANT_WRITE_PROTOCOL  *This,
+  IN EFI_HANDLE                         FvBlockHandle
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Aborts all previously allocated writes.
+
+  @param[in] This               The calling context.
+
+  @retval EFI_NOT_FOUND         No allocated writes exist.
+
+**/
+EFI_STATUS
+EFIAPI
+BenchmarkFtwAbort (
+  IN EFI_FAULT_TOLERANT_WRITE_PROTOCOL  *This
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Returns information about the last write. The writes of the emulated FTW
+  protocol are never pending.
+
+  @param[in]      This            Indicates a pointer to the calling context.
+  @param[out]     CallerId        The GUID identifying the last write.
+  @param[out]     Lba             The logical block address of the last write.
+  @param[out]     Offset          The offset within the block of the last write.
+  @param[out]     Length          The length of the last write.
+  @param[in, out] PrivateDataSize On input, the size of the PrivateData buffer. On output, the size
+                                  of the private data stored for this write.
+  @param[out]     PrivateData     A pointer to a buffer. The function will copy PrivateDataSize
+                                  bytes from the private data stored for this write.
+  @param[out]     Complete        A Boolean value with TRUE indicating that the write was completed.
+
+  @retval EFI_NOT_FOUND           No allocated writes exist.
+
+**/
+EFI_STATUS
+EFIAPI
+BenchmarkFtwGetLastWrite (
+  IN EFI_FAULT_TOLERANT_WRITE_PROTOCOL  *This,
+  OUT EFI_GUID                          *CallerId,
+  OUT EFI_LBA                           *Lba,
+  OUT UINTN                             *Offset,
+  OUT UINTN                             *Length,
+  IN OUT UINTN                          *PrivateDataSize,
+  OUT VOID                              *PrivateData,
+  OUT BOOLEAN                           *Complete
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+EFI_FAULT_TOLERANT_WRITE_PROTOCOL  mBenchmarkFtw = {
+  BenchmarkFtwGetMaxBlockSize,
+  BenchmarkFtwAllocate,
+  BenchmarkFtwWrite,
+  BenchmarkFtwRestart,
+  BenchmarkFtwAbort,
+  BenchmarkFtwGetLastWrite
+};
+
+/**
+  Create the emulated flash device with an empty variable store.
+
+  @param[in] NvStorageSize      Size of the variable firmware volume, a multiple
+                                of VARIABLE_BENCHMARK_BLOCK_SIZE.
+
+  @retval EFI_SUCCESS           The flash device was created.
+  @retval EFI_OUT_OF_RESOURCES  The flash device could not be allocated.
+
+**/
+EFI_STATUS
+CreateBenchmarkFlash (
+  IN UINTN  NvStorageSize
+  )
+{
+  VARIABLE_BENCHMARK_FV_HEADER  *FvHeader;
+  VARIABLE_STORE_HEADER         *VariableStore;
+
+  ASSERT (mBenchmarkFlash == NULL);
+  ASSERT (NvStorageSize != 0 && (NvStorageSize % VARIABLE_BENCHMARK_BLOCK_SIZE) == 0);
+
+  mBenchmarkFlash = AllocatePool (NvStorageSize);
+  if (mBenchmarkFlash == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  mBenchmarkFlashSize = NvStorageSize;
+  SetMem (mBenchmarkFlash, NvStorageSize, 0xff);
+  ZeroMem (&mBenchmarkFlashStats, sizeof (mBenchmarkFlashStats));
+  SetBenchmarkFlashWriteFailure (0, 0);
+
+  FvHeader = (VARIABLE_BENCHMARK_FV_HEADER *)mBenchmarkFlash;
+  ZeroMem (FvHeader, sizeof (*FvHeader));
+  CopyGuid (&FvHeader->FvHeader.FileSystemGuid, &gEfiSystemNvDataFvGuid);
+  FvHeader->FvHeader.FvLength              = NvStorageSize;
+  FvHeader->FvHeader.Signature             = EFI_FVH_SIGNATURE;
+  FvHeader->FvHeader.Attributes            = EFI_FVB2_READ_STATUS | EFI_FVB2_WRITE_STATUS | EFI_FVB2_ERASE_POLARITY;
+  FvHeader->FvHeader.HeaderLength          = (UINT16)sizeof (*FvHeader);
+  FvHeader->FvHeader.Revision              = EFI_FVH_REVISION;
+  FvHeader->FvHeader.BlockMap[0].NumBlocks = (UINT32)(NvStorageSize / VARIABLE_BENCHMARK_BLOCK_SIZE);
+  FvHeader->FvHeader.BlockMap[0].Length    = VARIABLE_BENCHMARK_BLOCK_SIZE;
+  FvHeader->FvHeader.Checksum              = CalculateCheckSum16 ((UINT16 *)FvHeader, sizeof (*FvHeader));
+
+  VariableStore = (VARIABLE_STORE_HEADER *)(FvHeader + 1);
+  CopyGuid (&VariableStore->Signature, &gEfiAuthenticatedVariableGuid);
+  VariableStore->Size      = (UINT32)(NvStorageSize - sizeof (*FvHeader));
+  VariableStore->Format    = VARIABLE_STORE_FORMATTED;
+  VariableStore->State     = VARIABLE_STORE_HEALTHY;
+  VariableStore->Reserved  = 0;
+  VariableStore->Reserved1 = 0;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Free the emulated flash device. The variable driver must be stopped.
+
+**/
+VOID
+FreeBenchmarkFlash (
+  VOID
+  )
+{
+  ASSERT (mVariableModuleGlobal == NULL);
+
+  if (mBenchmarkFlash != NULL) {
+    FreePool (mBenchmarkFlash);
+  }
+
+  mBenchmarkFlash     = NULL;
+  mBenchmarkFlashSize = 0;
+}
+
+/**
+  Initialize the variable driver from the content of the emulated flash
+  device, the way the DXE variable driver does once the FTW protocol is
+  available.
+
+  @retval EFI_SUCCESS           The variable services can be used.
+  @retval Others                The variable driver failed to initialize.
+
+**/
+EFI_STATUS
+StartBenchmarkVariableDriver (
+  VOID
+  )
+{
+  EFI_STATUS                          Status;
+  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *FvbProtocol;
+
+  ASSERT (mBenchmarkFlash != NULL);
+  ASSERT (mVariableModuleGlobal == NULL);
+
+  Status = VariableCommonInitialize ();
+  if (EFI_ERROR (Status)) {
+    mVariableModuleGlobal = NULL;
+    return Status;
+  }
+
+  mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase = (EFI_PHYSICAL_ADDRESS)(UINTN)mBenchmarkFlash + mNvFvHeaderCache->HeaderLength;
+
+  Status = GetFvbInfoByAddress ((EFI_PHYSICAL_ADDRESS)(UINTN)mBenchmarkFlash, NULL, &FvbProtocol);
+  if (EFI_ERROR (Status)) {
+    StopBenchmarkVariableDriver ();
+    return Status;
+  }
+
+  mVariableModuleGlobal->FvbInstance = FvbProtocol;
+
+  Status = VariableWriteServiceInitialize ();
+  if (EFI_ERROR (Status)) {
+    StopBenchmarkVariableDriver ();
+  }
+
+  return Status;
+}
+
+/**
+  Free the resources of the variable driver, as if the platform was reset.
+  The content of the emulated flash device is kept.
+
+**/
+VOID
+StopBenchmarkVariableDriver (
+  VOID
+  )
+{
+  UINTN  Type;
+
+  if (mVariableModuleGlobal == NULL) {
+    return;
+  }
+
+  for (Type = 0; Type < VariableStoreTypeMax; Type++) {
+    if (mVariableStoreIndex[Type].Entries != NULL) {
+      FreePool (mVariableStoreIndex[Type].Entries);
+    }
+
+    ZeroMem (&mVariableStoreIndex[Type], sizeof (mVariableStoreIndex[Type]));
+  }
+
+  if (mVariableModuleGlobal->VariableGlobal.VolatileVariableBase != 0) {
+    FreePool ((VOID *)(UINTN)mVariableModuleGlobal->VariableGlobal.VolatileVariableBase);
+  }
+
+  if (mVariableModuleGlobal->NvBlockEraseCount != NULL) {
+    FreePool (mVariableModuleGlobal->NvBlockEraseCount);
+  }
+
+  if (mVariableModuleGlobal->PlatformLangCodes != NULL) {
+    FreePool (mVariableModuleGlobal->PlatformLangCodes);
+  }
+
+  if (mVariableModuleGlobal->LangCodes != NULL) {
+    FreePool (mVariableModuleGlobal->LangCodes);
+  }
+
+  if (mVariableModuleGlobal->PlatformLang != NULL) {
+    FreePool (mVariableModuleGlobal->PlatformLang);
+  }
+
+  if (mNvFvHeaderCache != NULL) {
+    FreePool (mNvFvHeaderCache);
+  }
+
+  FreePool (mVariableModuleGlobal);
+  mVariableModuleGlobal = NULL;
+  mNvFvHeaderCache      = NULL;
+  mNvVariableCache      = NULL;
+}
+
+/**
+  Return the statistics of the emulated flash device since it was created.
+
+  @param[out] Stats             Returns the statistics.
+
+**/
+VOID
+GetBenchmarkFlashStats (
+  OUT VARIABLE_BENCHMARK_FLASH_STATS  *Stats
+  )
+{
+  CopyMem (Stats, &mBenchmarkFlashStats, sizeof (*Stats));
+}
+
+/**
+  Make writes of the emulated flash device fail, through FVB or FTW, without
+  programming anything.
+
+  @param[in] WritesBeforeFailure  Number of writes that succeed before the
+                                  first write that fails.
+  @param[in] FailureCount         Number of writes that fail, MAX_UINT64 for
+                                  all of them, 0 to stop the failures.
+
+**/
+VOID
+SetBenchmarkFlashWriteFailure (
+  IN UINT64  WritesBeforeFailure,
+  IN UINT64  FailureCount
+  )
+{
+  mBenchmarkWritesBeforeFailure = WritesBeforeFailure;
+  mBenchmarkWriteFailures       = FailureCount;
+}
+
+/**
+  Get the location of the emulated flash device of the variable store.
+
+  @param[out] BaseAddress       The base address of the variable store.
+  @param[out] Length            The length in bytes of the variable store.
+
+  @retval EFI_SUCCESS           The base address and length were returned.
+  @retval EFI_NOT_READY         The emulated flash device was not created.
+
+**/
+EFI_STATUS
+EFIAPI
+GetVariableFlashNvStorageInfo (
+  OUT EFI_PHYSICAL_ADDRESS  *BaseAddress,
+  OUT UINT64                *Length
+  )
+{
+  if (mBenchmarkFlash == NULL) {
+    return EFI_NOT_READY;
+  }
+
+  *BaseAddress = (EFI_PHYSICAL_ADDRESS)(UINTN)mBenchmarkFlash;
+  *Length      = mBenchmarkFlashSize;
+  return EFI_SUCCESS;
+}
+
+/**
+  Retrieve the FTW protocol interface.
+
+  @param[out] FtwProtocol       The interface of Ftw protocol
+
+  @retval EFI_SUCCESS           The emulated FTW protocol was returned.
+
+**/
+EFI_STATUS
+GetFtwProtocol (
+  OUT VOID  **FtwProtocol
+  )
+{
+  *FtwProtocol = &mBenchmarkFtw;
+  return EFI_SUCCESS;
+}
+
+/**
+  Retrieve the FVB protocol interface by HANDLE.
+
+  @param[in]  FvBlockHandle     The handle of FVB protocol that provides services for
+                                reading, writing, and erasing the target block.
+  @param[out] FvBlock           The interface of FVB protocol
+
+  @retval EFI_SUCCESS           The emulated FVB protocol was returned.
+  @retval EFI_UNSUPPORTED       The handle is not the handle of the emulated flash device.
+
+**/
+EFI_STATUS
+GetFvbByHandle (
+  IN  EFI_HANDLE                          FvBlockHandle,
+  OUT EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  **FvBlock
+  )
+{
+  if (FvBlockHandle != (EFI_HANDLE)&mBenchmarkFvbHandle) {
+    return EFI_UNSUPPORTED;
+  }
+
+  *FvBlock = &mBenchmarkFvb;
+  return EFI_SUCCESS;
+}
+
+/**
+  Function returns an array of handles that support the FVB protocol
+  in a buffer allocated from pool.
+
+  @param[out] NumberHandles     The number of handles returned in Buffer.
+  @param[out] Buffer            A pointer to the buffer to return the requested
+                                array of handles that support FVB protocol.
+
+  @retval EFI_SUCCESS           The handle of the emulated flash device was returned.
+  @retval EFI_OUT_OF_RESOURCES  There is not enough pool memory to store the matching results.
+
+**/
+EFI_STATUS
+GetFvbCountAndBuffer (
+  OUT UINTN       *NumberHandles,
+  OUT EFI_HANDLE  **Buffer
+  )
+{
+  *Buffer = AllocatePool (sizeof (EFI_HANDLE));
+  if (*Buffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  (*Buffer)[0]   = (EFI_HANDLE)&mBenchmarkFvbHandle;
+  *NumberHandles = 1;
+  return EFI_SUCCESS;
+}
+
+/**
+  Return TRUE if ExitBootServices () has been called. The benchmark always
+  runs at boot time.
+
+  @retval FALSE                 ExitBootServices () has not been called.
+
+**/
+BOOLEAN
+AtRuntime (
+  VOID
+  )
+{
+  return FALSE;
+}
+
+/**
+  Initializes a basic mutual exclusion lock.
+
+  @param[in, out] Lock          A pointer to the lock data structure to initialize.
+  @param[in]      Priority      The task priority level of the lock.
+
+  @return The lock.
+
+**/
+EFI_LOCK *
+InitializeLock (
+  IN OUT EFI_LOCK  *Lock,
+  IN     EFI_TPL   Priority
+  )
+{
+  Lock->Tpl      = Priority;
+  Lock->OwnerTpl = TPL_APPLICATION;
+  Lock->Lock     = EfiLockReleased;
+  return Lock;
+}
+
+/**
+  Acquires lock only at boot time. The benchmark asserts that the lock is not
+  acquired twice.
+
+  @param[in] Lock               A pointer to the lock to acquire.
+
+**/
+VOID
+AcquireLockOnlyAtBootTime (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockReleased);
+  Lock->Lock = EfiLockAcquired;
+}
+
+/**
+  Releases lock only at boot time. The benchmark asserts that the lock was
+  acquired.
+
+  @param[in] Lock               A pointer to the lock to release.
+
+**/
+VOID
+ReleaseLockOnlyAtBootTime (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockAcquired);
+  Lock->Lock = EfiLockReleased;
+}
+
+/**
+  Increments a 32-bit value. The benchmark is single threaded, so the
+  reentrancy counter of the variable driver needs no atomic operation and no
+  SynchronizationLib (and the TimerLib it depends on).
+
+  @param[in] Value              A pointer to the 32-bit value to increment.
+
+  @return The incremented value.
+
+**/
+UINT32
+EFIAPI
+InterlockedIncrement (
+  IN volatile UINT32  *Value
+  )
+{
+  return ++*Value;
+}
+
+/**
+  Decrements a 32-bit value. See InterlockedIncrement ().
+
+  @param[in] Value              A pointer to the 32-bit value to decrement.
+
+  @return The decremented value.
+
+**/
+UINT32
+EFIAPI
+InterlockedDecrement (
+  IN volatile UINT32  *Value
+  )
+{
+  return --*Value;
+}
+
+/**
+  Measure secure boot policy variables. Nothing is measured on the host.
+
+  @param[in] VariableName       Name of the variable.
+  @param[in] VendorGuid         Guid of the variable.
+
+**/
+VOID
+EFIAPI
+SecureBootHook (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid
+  )
+{
+}
+
+/**
+  Initialize the MOR lock variables. The benchmark does not emulate MOR.
+
+  @retval EFI_SUCCESS           MOR is not emulated.
+
+**/
+EFI_STATUS
+MorLockInit (
+  VOID
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Check the MOR lock variables. The benchmark does not emulate MOR.
+
+  @param[in] VariableName       A pointer to a null-terminated string that is the name of the vendor's variable.
+  @param[in] VendorGuid         A unique identifier for the vendor.
+  @param[in] Attributes         Attributes bitmask to set for the variable.
+  @param[in] DataSize           The size in bytes of the Data buffer.
+  @param[in] Data               A pointer to the buffer containing the contents of the variable.
+
+  @retval EFI_SUCCESS           The variable is not a MOR variable.
+
+**/
+EFI_STATUS
+SetVariableCheckHandlerMor (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid,
+  IN UINT32    Attributes,
+  IN UINTN     DataSize,
+  IN VOID      *Data
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Initialization for authenticated variable services. The benchmark runs the
+  variable driver without authenticated variable support.
+
+  @param[in]  AuthVarLibContextIn   Pointer to input auth variable lib context.
+  @param[out] AuthVarLibContextOut  Pointer to output auth variable lib context.
+
+  @retval EFI_UNSUPPORTED           Authenticated variables are not supported.
+
+**/
+EFI_STATUS
+EFIAPI
+AuthVariableLibInitialize (
+  IN  AUTH_VAR_LIB_CONTEXT_IN   *AuthVarLibContextIn,
+  OUT AUTH_VAR_LIB_CONTEXT_OUT  *AuthVarLibContextOut
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Process variable with EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS set.
+
+  @param[in] VariableName           Name of the variable.
+  @param[in] VendorGuid             Variable vendor GUID.
+  @param[in] Data                   Data pointer.
+  @param[in] DataSize               Size of Data.
+  @param[in] Attributes             Attribute value of the variable.
+
+  @retval EFI_UNSUPPORTED           Authenticated variables are not supported.
+
+**/
+EFI_STATUS
+EFIAPI
+AuthVariableLibProcessVariable (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid,
+  IN VOID      *Data,
+  IN UINTN     DataSize,
+  IN UINT32    Attributes
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Register SetVariable check handler. The handlers are not called by the
+  benchmark.
+
+  @param[in] Handler            Pointer to check handler.
+
+  @retval EFI_SUCCESS           The handler was ignored.
+
+**/
+EFI_STATUS
+EFIAPI
+VarCheckLibRegisterSetVariableCheckHandler (
+  IN VAR_CHECK_SET_VARIABLE_CHECK_HANDLER  Handler
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Variable property set. The properties are not checked by the benchmark.
+
+  @param[in] Name               Pointer to the variable name.
+  @param[in] Guid               Pointer to the vendor GUID.
+  @param[in] VariableProperty   Pointer to the input variable property.
+
+  @retval EFI_SUCCESS           The property was ignored.
+
+**/
+EFI_STATUS
+EFIAPI
+VarCheckLibVariablePropertySet (
+  IN CHAR16                       *Name,
+  IN EFI_GUID                     *Guid,
+  IN VAR_CHECK_VARIABLE_PROPERTY  *VariableProperty
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Variable property get.
+
+  @param[in]  Name              Pointer to the variable name.
+  @param[in]  Guid              Pointer to the vendor GUID.
+  @param[out] VariableProperty  Pointer to the output variable property.
+
+  @retval EFI_NOT_FOUND         The properties are not recorded by the benchmark.
+
+**/
+EFI_STATUS
+EFIAPI
+VarCheckLibVariablePropertyGet (
+  IN CHAR16                        *Name,
+  IN EFI_GUID                      *Guid,
+  OUT VAR_CHECK_VARIABLE_PROPERTY  *VariableProperty
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+/**
+  SetVariable check.
+
+  @param[in] VariableName       Name of Variable to set.
+  @param[in] VendorGuid         Variable vendor GUID.
+  @param[in] Attributes         Attribute value of the variable.
+  @param[in] DataSize           Size of Data to set.
+  @param[in] Data               Data pointer.
+  @param[in] RequestSource      Request source.
+
+  @retval EFI_SUCCESS           The variable is not checked by the benchmark.
+
+**/
+EFI_STATUS
+EFIAPI
+VarCheckLibSetVariableCheck (
+  IN CHAR16                    *VariableName,
+  IN EFI_GUID                  *VendorGuid,
+  IN UINT32                    Attributes,
+  IN UINTN                     DataSize,
+  IN VOID                      *Data,
+  IN VAR_CHECK_REQUEST_SOURCE  RequestSource
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  This function searches the first instance of a HOB from the starting HOB
+  pointer. There are no HOBs on the host.
+
+  @param[in] Guid               The GUID to match with in the HOB list.
+
+  @return NULL.
+
+**/
+VOID *
+EFIAPI
+GetFirstGuidHob (
+  IN CONST EFI_GUID  *Guid
+  )
+{
+  return NULL;
+}
+
+/**
+  This function searches the next instance of a HOB from the starting HOB
+  pointer. There are no HOBs on the host.
+
+  @param[in] Guid               The GUID to match with in the HOB list.
+  @param[in] HobStart           A pointer to a Guid.
+
+  @return NULL.
+
+**/
+VOID *
+EFIAPI
+GetNextGuidHob (
+  IN CONST EFI_GUID  *Guid,
+  IN CONST VOID      *HobStart
+  )
+{
+  return NULL;
+}
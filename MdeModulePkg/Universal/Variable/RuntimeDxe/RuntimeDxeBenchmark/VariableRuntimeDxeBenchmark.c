@@ -0,0 +1,1005 @@
+/** @file
+  Host based benchmark and fuzz harness of the variable driver.
+
+  The benchmark measures the latency of GetVariable(), GetNextVariableName(),
+  SetVariable() and of the reclaim of the non-volatile variable store, and the
+  bytes written to the emulated flash device, across store sizes and variable
+  counts. The results are reported as JSON on the standard output so that
+  regressions can be tracked by a script.
+
+  With --fuzz, a random sequence of SetVariable() calls and platform resets is
+  run instead and the variables are checked against a model of the stores. The
+  sequence is reproducible from the --seed value.
+
+  Usage:
+    VariableRuntimeDxeBenchmark [--store-size Bytes] [--variable-count Count]
+                                [--data-size Bytes] [--seed Seed]
+    VariableRuntimeDxeBenchmark --fuzz Operations [--store-size Bytes] [--seed Seed]
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "VariableBenchmark.h"
+
+#define BENCHMARK_NAME_LENGTH     32
+#define BENCHMARK_MAX_DATA_SIZE   512
+#define BENCHMARK_DEFAULT_SEED    0x2545F4914F6CDD1DULL
+#define BENCHMARK_NV_ATTRIBUTES   (EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS)
+#define BENCHMARK_VOL_ATTRIBUTES  (EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS)
+
+#define FUZZ_SLOT_COUNT          64
+#define FUZZ_MAX_DATA_SIZE       256
+#define FUZZ_MAX_APPEND_SIZE     32
+#define FUZZ_CHECK_INTERVAL      64
+#define FUZZ_DEFAULT_STORE_SIZE  SIZE_16KB
+#define FUZZ_DEFAULT_OPERATIONS  10000
+
+typedef struct {
+  CONST CHAR8                       *Name;
+  UINTN                             Count;
+  UINTN                             Failures;
+  UINT64                            TotalNs;
+  UINT64                            MaxNs;
+  VARIABLE_BENCHMARK_FLASH_STATS    StartStats;
+} BENCHMARK_PHASE;
+
+typedef struct {
+  BOOLEAN    Present;
+  UINT32     Attributes;
+  UINTN      DataSize;
+  UINT8      Data[FUZZ_MAX_DATA_SIZE];
+} FUZZ_SLOT;
+
+typedef enum {
+  FuzzOperationSet,
+  FuzzOperationAppend,
+  FuzzOperationDelete,
+  FuzzOperationGet,
+  FuzzOperationReset,
+  FuzzOperationMax
+} FUZZ_OPERATION;
+
+CONST CHAR8  *mFuzzOperationNames[FuzzOperationMax] = {
+  "set",
+  "append",
+  "delete",
+  "get",
+  "reset"
+};
+
+EFI_GUID  mBenchmarkVendorGuid = {
+  0x5d0a6b0e, 0x4a43, 0x4c1f, { 0x9a, 0x4d, 0x0b, 0x6e, 0x7f, 0x31, 0x28, 0xc5 }
+};
+
+EFI_GUID  mFuzzVendorGuid = {
+  0x8c2f35a1, 0x7d86, 0x4b9e, { 0xa5, 0x0c, 0xe4, 0x93, 0x1b, 0x5f, 0x62, 0xd7 }
+};
+
+UINT64     mRandomState;
+FUZZ_SLOT  mFuzzSlots[FUZZ_SLOT_COUNT];
+UINTN      mFuzzMismatches;
+
+/**
+  Return the next value of the xorshift64 pseudo random number generator.
+
+  @return A pseudo random number.
+
+**/
+UINT64
+GetRandom (
+  VOID
+  )
+{
+  mRandomState ^= mRandomState << 13;
+  mRandomState ^= mRandomState >> 7;
+  mRandomState ^= mRandomState << 17;
+  return mRandomState;
+}
+
+/**
+  Return a pseudo random number in a range.
+
+  @param[in] Limit              The upper bound of the range, excluded.
+
+  @return A pseudo random number in [0, Limit).
+
+**/
+UINTN
+GetRandomBelow (
+  IN UINTN  Limit
+  )
+{
+  return (UINTN)(GetRandom () % Limit);
+}
+
+/**
+  Return a monotonic time stamp.
+
+  @return The time stamp in nanoseconds.
+
+**/
+UINT64
+GetTimeNs (
+  VOID
+  )
+{
+  struct timespec  Time;
+
+  timespec_get (&Time, TIME_UTC);
+  return (UINT64)Time.tv_sec * 1000000000ULL + (UINT64)Time.tv_nsec;
+}
+
+/**
+  Build the name of a variable of the benchmark.
+
+  @param[in]  Prefix            ASCII prefix of the name.
+  @param[in]  Index             Index of the variable.
+  @param[out] Name              Returns the name, BENCHMARK_NAME_LENGTH characters at most.
+
+**/
+VOID
+GetVariableNameByIndex (
+  IN  CONST CHAR8  *Prefix,
+  IN  UINTN        Index,
+  OUT CHAR16       *Name
+  )
+{
+  CHAR8  AsciiName[BENCHMARK_NAME_LENGTH];
+
+  snprintf (AsciiName, sizeof (AsciiName), "%s%05u", Prefix, (unsigned)Index);
+  AsciiStrToUnicodeStrS (AsciiName, Name, BENCHMARK_NAME_LENGTH);
+}
+
+/**
+  Fill the data of a variable of the benchmark.
+
+  @param[in]  Index             Index of the variable.
+  @param[in]  Generation        Number of times the variable was updated.
+  @param[in]  DataSize          Size of the data.
+  @param[out] Data              Returns the data.
+
+**/
+VOID
+GetVariableData (
+  IN  UINTN  Index,
+  IN  UINTN  Generation,
+  IN  UINTN  DataSize,
+  OUT UINT8  *Data
+  )
+{
+  UINTN  Offset;
+
+  for (Offset = 0; Offset < DataSize; Offset++) {
+    Data[Offset] = (UINT8)(Index * 31 + Generation * 7 + Offset);
+  }
+}
+
+/**
+  Start a phase of the benchmark.
+
+  @param[out] Phase             The phase to start.
+  @param[in]  Name              Name of the phase in the report.
+
+**/
+VOID
+BeginPhase (
+  OUT BENCHMARK_PHASE  *Phase,
+  IN  CONST CHAR8      *Name
+  )
+{
+  ZeroMem (Phase, sizeof (*Phase));
+  Phase->Name = Name;
+  GetBenchmarkFlashStats (&Phase->StartStats);
+}
+
+/**
+  Record an operation of a phase of the benchmark.
+
+  @param[in, out] Phase         The phase of the operation.
+  @param[in]      StartNs       Time stamp taken before the operation.
+  @param[in]      Failed        TRUE if the operation did not return the expected status.
+
+**/
+VOID
+RecordOperation (
+  IN OUT BENCHMARK_PHASE  *Phase,
+  IN     UINT64           StartNs,
+  IN     BOOLEAN          Failed
+  )
+{
+  UINT64  ElapsedNs;
+
+  ElapsedNs       = GetTimeNs () - StartNs;
+  Phase->TotalNs += ElapsedNs;
+  Phase->MaxNs    = MAX (Phase->MaxNs, ElapsedNs);
+  Phase->Count++;
+  if (Failed) {
+    Phase->Failures++;
+  }
+}
+
+/**
+  Report a phase of the benchmark as a JSON object.
+
+  @param[in] Phase              The phase to report.
+  @param[in] First              TRUE if this is the first phase of the run.
+
+  @return The number of failed operations of the phase.
+
+**/
+UINTN
+EndPhase (
+  IN BENCHMARK_PHASE  *Phase,
+  IN BOOLEAN          First
+  )
+{
+  VARIABLE_BENCHMARK_FLASH_STATS  Stats;
+
+  GetBenchmarkFlashStats (&Stats);
+  printf (
+    "%s        { \"name\": \"%s\", \"count\": %llu, \"failures\": %llu, \"avg_ns\": %llu, \"max_ns\": %llu, "
+    "\"flash_bytes_written\": %llu, \"flash_blocks_erased\": %llu, \"ftw_writes\": %llu }",
+    First ? "" : ",\n",
+    Phase->Name,
+    (unsigned long long)Phase->Count,
+    (unsigned long long)Phase->Failures,
+    (unsigned long long)((Phase->Count != 0) ? Phase->TotalNs / Phase->Count : 0),
+    (unsigned long long)Phase->MaxNs,
+    (unsigned long long)(Stats.BytesWritten - Phase->StartStats.BytesWritten),
+    (unsigned long long)(Stats.BlocksErased - Phase->StartStats.BlocksErased),
+    (unsigned long long)(Stats.FtwWriteCount - Phase->StartStats.FtwWriteCount)
+    );
+  return Phase->Failures;
+}
+
+/**
+  Return TRUE if the variables of a run of the benchmark fill at most half of
+  the non-volatile variable store, so that every variable can be updated once
+  between two reclaims.
+
+  @param[in] StoreSize          Size of the variable firmware volume.
+  @param[in] VariableCount      Number of variables.
+  @param[in] DataSize           Size of the data of each variable.
+
+**/
+BOOLEAN
+IsRunValid (
+  IN UINTN  StoreSize,
+  IN UINTN  VariableCount,
+  IN UINTN  DataSize
+  )
+{
+  UINTN  VariableSize;
+
+  VariableSize = sizeof (AUTHENTICATED_VARIABLE_HEADER) + HEADER_ALIGN (BENCHMARK_NAME_LENGTH * sizeof (CHAR16) + DataSize);
+  return (BOOLEAN)(VariableCount * VariableSize <= StoreSize / 2);
+}
+
+/**
+  Run the benchmark for one store size and variable count and report it as a
+  JSON object.
+
+  @param[in] StoreSize          Size of the variable firmware volume.
+  @param[in] VariableCount      Number of variables.
+  @param[in] DataSize           Size of the data of each variable.
+  @param[in] First              TRUE if this is the first run of the report.
+
+  @return The number of failed operations of the run.
+
+**/
+UINTN
+RunBenchmark (
+  IN UINTN    StoreSize,
+  IN UINTN    VariableCount,
+  IN UINTN    DataSize,
+  IN BOOLEAN  First
+  )
+{
+  EFI_STATUS       Status;
+  BENCHMARK_PHASE  Phase;
+  UINTN            Failures;
+  UINTN            *Order;
+  UINTN            Index;
+  UINTN            Swap;
+  UINTN            Count;
+  UINT64           StartNs;
+  UINT64           Cursor;
+  UINT32           Attributes;
+  UINTN            Size;
+  CHAR16           Name[BENCHMARK_NAME_LENGTH];
+  EFI_GUID         Guid;
+  UINT8            Data[BENCHMARK_MAX_DATA_SIZE];
+  UINT8            Expected[BENCHMARK_MAX_DATA_SIZE];
+
+  Failures = 0;
+  Order    = AllocatePool (VariableCount * sizeof (UINTN));
+  if ((Order == NULL) || EFI_ERROR (CreateBenchmarkFlash (StoreSize))) {
+    fprintf (stderr, "Out of memory\n");
+    exit (1);
+  }
+
+  for (Index = 0; Index < VariableCount; Index++) {
+    Order[Index] = Index;
+  }
+
+  for (Index = VariableCount; Index > 1; Index--) {
+    Swap             = GetRandomBelow (Index);
+    Count            = Order[Index - 1];
+    Order[Index - 1] = Order[Swap];
+    Order[Swap]      = Count;
+  }
+
+  printf (
+    "%s    {\n      \"store_size\": %llu, \"variable_count\": %llu, \"data_size\": %llu,\n      \"phases\": [\n",
+    First ? "" : ",\n",
+    (unsigned long long)StoreSize,
+    (unsigned long long)VariableCount,
+    (unsigned long long)DataSize
+    );
+
+  BeginPhase (&Phase, "start");
+  StartNs = GetTimeNs ();
+  Status  = StartBenchmarkVariableDriver ();
+  RecordOperation (&Phase, StartNs, EFI_ERROR (Status));
+  Failures += EndPhase (&Phase, TRUE);
+  if (EFI_ERROR (Status)) {
+    fprintf (stderr, "The variable driver failed to start: 0x%llx\n", (unsigned long long)Status);
+    exit (1);
+  }
+
+  BeginPhase (&Phase, "set_add");
+  for (Index = 0; Index < VariableCount; Index++) {
+    GetVariableNameByIndex ("BenchmarkVariable", Index, Name);
+    GetVariableData (Index, 0, DataSize, Data);
+    StartNs = GetTimeNs ();
+    Status  = VariableServiceSetVariable (Name, &mBenchmarkVendorGuid, BENCHMARK_NV_ATTRIBUTES, DataSize, Data);
+    RecordOperation (&Phase, StartNs, EFI_ERROR (Status));
+  }
+
+  Failures += EndPhase (&Phase, FALSE);
+
+  BeginPhase (&Phase, "get_hit");
+  for (Index = 0; Index < VariableCount; Index++) {
+    GetVariableNameByIndex ("BenchmarkVariable", Order[Index], Name);
+    GetVariableData (Order[Index], 0, DataSize, Expected);
+    Size    = sizeof (Data);
+    StartNs = GetTimeNs ();
+    Status  = VariableServiceGetVariable (Name, &mBenchmarkVendorGuid, &Attributes, &Size, Data);
+    RecordOperation (&Phase, StartNs, EFI_ERROR (Status) || (Size != DataSize) || (CompareMem (Data, Expected, DataSize) != 0));
+  }
+
+  Failures += EndPhase (&Phase, FALSE);
+
+  BeginPhase (&Phase, "get_miss");
+  for (Index = 0; Index < VariableCount; Index++) {
+    GetVariableNameByIndex ("BenchmarkVariable", VariableCount + Order[Index], Name);
+    Size    = sizeof (Data);
+    StartNs = GetTimeNs ();
+    Status  = VariableServiceGetVariable (Name, &mBenchmarkVendorGuid, &Attributes, &Size, Data);
+    RecordOperation (&Phase, StartNs, Status != EFI_NOT_FOUND);
+  }
+
+  Failures += EndPhase (&Phase, FALSE);
+
+  BeginPhase (&Phase, "get_next_variable_name");
+  Name[0] = L'\0';
+  Count   = 0;
+  do {
+    Size    = sizeof (Name);
+    StartNs = GetTimeNs ();
+    Status  = VariableServiceGetNextVariableName (&Size, Name, &Guid);
+    RecordOperation (&Phase, StartNs, EFI_ERROR (Status) && (Status != EFI_NOT_FOUND));
+    if (!EFI_ERROR (Status) && CompareGuid (&Guid, &mBenchmarkVendorGuid)) {
+      Count++;
+    }
+  } while (!EFI_ERROR (Status));
+
+  Phase.Failures += (Count != VariableCount) ? 1 : 0;
+  Failures       += EndPhase (&Phase, FALSE);
+
+  BeginPhase (&Phase, "get_next_variable_by_cursor");
+  Cursor = EDKII_VARIABLE_ENUMERATION_CURSOR_START;
+  Count  = 0;
+  do {
+    Size    = sizeof (Name);
+    StartNs = GetTimeNs ();
+    Status  = VariableServiceGetNextVariableNameByCursor (&Cursor, &Size, Name, &Guid, NULL);
+    RecordOperation (&Phase, StartNs, EFI_ERROR (Status) && (Status != EFI_NOT_FOUND));
+    if (!EFI_ERROR (Status) && CompareGuid (&Guid, &mBenchmarkVendorGuid)) {
+      Count++;
+    }
+  } while (!EFI_ERROR (Status));
+
+  Phase.Failures += (Count != VariableCount) ? 1 : 0;
+  Failures       += EndPhase (&Phase, FALSE);
+
+  //
+  // Updating every variable appends a new copy of each of them, the store is
+  // reclaimed by SetVariable() when it is full.
+  //
+  BeginPhase (&Phase, "set_update");
+  for (Index = 0; Index < VariableCount; Index++) {
+    GetVariableNameByIndex ("BenchmarkVariable", Order[Index], Name);
+    GetVariableData (Order[Index], 1, DataSize, Data);
+    StartNs = GetTimeNs ();
+    Status  = VariableServiceSetVariable (Name, &mBenchmarkVendorGuid, BENCHMARK_NV_ATTRIBUTES, DataSize, Data);
+    RecordOperation (&Phase, StartNs, EFI_ERROR (Status));
+  }
+
+  Failures += EndPhase (&Phase, FALSE);
+
+  BeginPhase (&Phase, "set_delete");
+  for (Index = 0; Index < VariableCount; Index += 2) {
+    GetVariableNameByIndex ("BenchmarkVariable", Index, Name);
+    StartNs = GetTimeNs ();
+    Status  = VariableServiceSetVariable (Name, &mBenchmarkVendorGuid, BENCHMARK_NV_ATTRIBUTES, 0, NULL);
+    RecordOperation (&Phase, StartNs, EFI_ERROR (Status));
+  }
+
+  Failures += EndPhase (&Phase, FALSE);
+
+  BeginPhase (&Phase, "reclaim");
+  StartNs = GetTimeNs ();
+  Status  = Reclaim (
+              mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase,
+              &mVariableModuleGlobal->NonVolatileLastVariableOffset,
+              FALSE,
+              NULL,
+              NULL,
+              0
+              );
+  RecordOperation (&Phase, StartNs, EFI_ERROR (Status));
+  Failures += EndPhase (&Phase, FALSE);
+
+  //
+  // The driver parses the store again after a reset, the remaining variables
+  // must have kept their last value.
+  //
+  StopBenchmarkVariableDriver ();
+  BeginPhase (&Phase, "restart");
+  StartNs = GetTimeNs ();
+  Status  = StartBenchmarkVariableDriver ();
+  RecordOperation (&Phase, StartNs, EFI_ERROR (Status));
+  Failures += EndPhase (&Phase, FALSE);
+  if (EFI_ERROR (Status)) {
+    fprintf (stderr, "The variable driver failed to restart: 0x%llx\n", (unsigned long long)Status);
+    exit (1);
+  }
+
+  BeginPhase (&Phase, "get_after_restart");
+  for (Index = 0; Index < VariableCount; Index++) {
+    GetVariableNameByIndex ("BenchmarkVariable", Order[Index], Name);
+    GetVariableData (Order[Index], 1, DataSize, Expected);
+    Size    = sizeof (Data);
+    StartNs = GetTimeNs ();
+    Status  = VariableServiceGetVariable (Name, &mBenchmarkVendorGuid, &Attributes, &Size, Data);
+    if ((Order[Index] % 2) == 0) {
+      RecordOperation (&Phase, StartNs, Status != EFI_NOT_FOUND);
+    } else {
+      RecordOperation (&Phase, StartNs, EFI_ERROR (Status) || (Size != DataSize) || (CompareMem (Data, Expected, DataSize) != 0));
+    }
+  }
+
+  Failures += EndPhase (&Phase, FALSE);
+  printf ("\n      ]\n    }");
+
+  StopBenchmarkVariableDriver ();
+  FreeBenchmarkFlash ();
+  FreePool (Order);
+  return Failures;
+}
+
+/**
+  Record a mismatch between the variable driver and the model of the fuzz
+  harness. The first mismatches are reported on the standard error.
+
+  @param[in] Operation          Number of the operation of the sequence.
+  @param[in] Slot               Slot of the variable.
+  @param[in] Message            Description of the mismatch.
+  @param[in] Status             Status returned by the variable driver.
+
+**/
+VOID
+ReportFuzzMismatch (
+  IN UINTN        Operation,
+  IN UINTN        Slot,
+  IN CONST CHAR8  *Message,
+  IN EFI_STATUS   Status
+  )
+{
+  if (mFuzzMismatches < 16) {
+    fprintf (
+      stderr,
+      "Operation %llu, slot %llu: %s (status 0x%llx)\n",
+      (unsigned long long)Operation,
+      (unsigned long long)Slot,
+      Message,
+      (unsigned long long)Status
+      );
+  }
+
+  mFuzzMismatches++;
+}
+
+/**
+  Check that GetVariable() returns the variable of a slot of the model.
+
+  @param[in] Operation          Number of the operation of the sequence.
+  @param[in] Slot               Slot of the variable.
+
+**/
+VOID
+CheckFuzzSlot (
+  IN UINTN  Operation,
+  IN UINTN  Slot
+  )
+{
+  EFI_STATUS  Status;
+  CHAR16      Name[BENCHMARK_NAME_LENGTH];
+  UINT8       Data[FUZZ_MAX_DATA_SIZE];
+  UINTN       Size;
+  UINT32      Attributes;
+
+  GetVariableNameByIndex ("FuzzVariable", Slot, Name);
+  Size   = sizeof (Data);
+  Status = VariableServiceGetVariable (Name, &mFuzzVendorGuid, &Attributes, &Size, Data);
+  if (!mFuzzSlots[Slot].Present) {
+    if (Status != EFI_NOT_FOUND) {
+      ReportFuzzMismatch (Operation, Slot, "deleted variable found", Status);
+    }
+  } else if (EFI_ERROR (Status)) {
+    ReportFuzzMismatch (Operation, Slot, "variable not found", Status);
+  } else if ((Attributes != mFuzzSlots[Slot].Attributes) ||
+             (Size != mFuzzSlots[Slot].DataSize) ||
+             (CompareMem (Data, mFuzzSlots[Slot].Data, Size) != 0))
+  {
+    ReportFuzzMismatch (Operation, Slot, "variable content differs", Status);
+  }
+}
+
+/**
+  Check that both enumeration services return each variable of the model once
+  and no other variable of the fuzz harness.
+
+  @param[in] Operation          Number of the operation of the sequence.
+
+**/
+VOID
+CheckFuzzEnumeration (
+  IN UINTN  Operation
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Pass;
+  UINT64      Cursor;
+  CHAR16      Name[BENCHMARK_NAME_LENGTH];
+  CHAR16      SlotName[BENCHMARK_NAME_LENGTH];
+  EFI_GUID    Guid;
+  UINTN       Size;
+  UINTN       Slot;
+  UINTN       Seen[FUZZ_SLOT_COUNT];
+
+  for (Pass = 0; Pass < 2; Pass++) {
+    ZeroMem (Seen, sizeof (Seen));
+    Cursor  = EDKII_VARIABLE_ENUMERATION_CURSOR_START;
+    Name[0] = L'\0';
+    while (TRUE) {
+      Size = sizeof (Name);
+      if (Pass != 0) {
+        Status = VariableServiceGetNextVariableNameByCursor (&Cursor, &Size, Name, &Guid, NULL);
+      } else {
+        Status = VariableServiceGetNextVariableName (&Size, Name, &Guid);
+      }
+
+      if (Status == EFI_NOT_FOUND) {
+        break;
+      }
+
+      if (EFI_ERROR (Status)) {
+        ReportFuzzMismatch (Operation, 0, "enumeration failed", Status);
+        return;
+      }
+
+      if (!CompareGuid (&Guid, &mFuzzVendorGuid)) {
+        continue;
+      }
+
+      for (Slot = 0; Slot < FUZZ_SLOT_COUNT; Slot++) {
+        GetVariableNameByIndex ("FuzzVariable", Slot, SlotName);
+        if (StrCmp (Name, SlotName) == 0) {
+          Seen[Slot]++;
+          break;
+        }
+      }
+
+      if (Slot == FUZZ_SLOT_COUNT) {
+        ReportFuzzMismatch (Operation, 0, "unknown variable enumerated", Status);
+      }
+    }
+
+    for (Slot = 0; Slot < FUZZ_SLOT_COUNT; Slot++) {
+      if (Seen[Slot] != (mFuzzSlots[Slot].Present ? 1 : 0)) {
+        ReportFuzzMismatch (
+          Operation,
+          Slot,
+          (Pass != 0) ? "variable enumerated by cursor a wrong number of times" : "variable enumerated a wrong number of times",
+          EFI_SUCCESS
+          );
+      }
+    }
+  }
+}
+
+/**
+  Run a random sequence of variable operations and platform resets, and check
+  the variables against a model of the stores. The result is reported as a
+  JSON object.
+
+  @param[in] StoreSize          Size of the variable firmware volume.
+  @param[in] Operations         Number of operations of the sequence.
+  @param[in] Seed               Seed of the sequence.
+
+  @return The number of mismatches between the variable driver and the model.
+
+**/
+UINTN
+RunFuzz (
+  IN UINTN   StoreSize,
+  IN UINTN   Operations,
+  IN UINT64  Seed
+  )
+{
+  EFI_STATUS                      Status;
+  UINTN                           Operation;
+  FUZZ_OPERATION                  Kind;
+  UINTN                           Slot;
+  UINTN                           Index;
+  UINTN                           Size;
+  UINTN                           Offset;
+  CHAR16                          Name[BENCHMARK_NAME_LENGTH];
+  UINT8                           Data[FUZZ_MAX_DATA_SIZE];
+  UINTN                           Counts[FuzzOperationMax];
+  UINTN                           OutOfResources;
+  VARIABLE_BENCHMARK_FLASH_STATS  Stats;
+
+  ZeroMem (mFuzzSlots, sizeof (mFuzzSlots));
+  ZeroMem (Counts, sizeof (Counts));
+  for (Slot = 0; Slot < FUZZ_SLOT_COUNT; Slot++) {
+    mFuzzSlots[Slot].Attributes = ((Slot % 4) == 3) ? BENCHMARK_VOL_ATTRIBUTES : BENCHMARK_NV_ATTRIBUTES;
+  }
+
+  mFuzzMismatches = 0;
+  OutOfResources  = 0;
+
+  if (EFI_ERROR (CreateBenchmarkFlash (StoreSize))) {
+    fprintf (stderr, "Out of memory\n");
+    exit (1);
+  }
+
+  Status = StartBenchmarkVariableDriver ();
+  if (EFI_ERROR (Status)) {
+    fprintf (stderr, "The variable driver failed to start: 0x%llx\n", (unsigned long long)Status);
+    exit (1);
+  }
+
+  for (Operation = 0; Operation < Operations; Operation++) {
+    //
+    // Resets are rare, the other operations are equally likely.
+    //
+    Kind = (FUZZ_OPERATION)GetRandomBelow (FuzzOperationMax - 1);
+    if (GetRandomBelow (64) == 0) {
+      Kind = FuzzOperationReset;
+    }
+
+    Slot = GetRandomBelow (FUZZ_SLOT_COUNT);
+    GetVariableNameByIndex ("FuzzVariable", Slot, Name);
+    Counts[Kind]++;
+
+    switch (Kind) {
+      case FuzzOperationSet:
+        Size = 1 + GetRandomBelow (FUZZ_MAX_DATA_SIZE);
+        for (Offset = 0; Offset < Size; Offset++) {
+          Data[Offset] = (UINT8)GetRandom ();
+        }
+
+        Status = VariableServiceSetVariable (Name, &mFuzzVendorGuid, mFuzzSlots[Slot].Attributes, Size, Data);
+        if (Status == EFI_OUT_OF_RESOURCES) {
+          OutOfResources++;
+        } else if (EFI_ERROR (Status)) {
+          ReportFuzzMismatch (Operation, Slot, "set failed", Status);
+        } else {
+          mFuzzSlots[Slot].Present  = TRUE;
+          mFuzzSlots[Slot].DataSize = Size;
+          CopyMem (mFuzzSlots[Slot].Data, Data, Size);
+        }
+
+        break;
+
+      case FuzzOperationAppend:
+        Size = 1 + GetRandomBelow (FUZZ_MAX_APPEND_SIZE);
+        if (mFuzzSlots[Slot].Present && (mFuzzSlots[Slot].DataSize + Size > FUZZ_MAX_DATA_SIZE)) {
+          Size = FUZZ_MAX_DATA_SIZE - mFuzzSlots[Slot].DataSize;
+          if (Size == 0) {
+            break;
+          }
+        }
+
+        for (Offset = 0; Offset < Size; Offset++) {
+          Data[Offset] = (UINT8)GetRandom ();
+        }
+
+        Status = VariableServiceSetVariable (
+                   Name,
+                   &mFuzzVendorGuid,
+                   mFuzzSlots[Slot].Attributes | EFI_VARIABLE_APPEND_WRITE,
+                   Size,
+                   Data
+                   );
+        if (Status == EFI_OUT_OF_RESOURCES) {
+          OutOfResources++;
+        } else if (EFI_ERROR (Status)) {
+          ReportFuzzMismatch (Operation, Slot, "append failed", Status);
+        } else {
+          if (!mFuzzSlots[Slot].Present) {
+            mFuzzSlots[Slot].Present  = TRUE;
+            mFuzzSlots[Slot].DataSize = 0;
+          }
+
+          CopyMem (mFuzzSlots[Slot].Data + mFuzzSlots[Slot].DataSize, Data, Size);
+          mFuzzSlots[Slot].DataSize += Size;
+        }
+
+        break;
+
+      case FuzzOperationDelete:
+        Status = VariableServiceSetVariable (Name, &mFuzzVendorGuid, mFuzzSlots[Slot].Attributes, 0, NULL);
+        if (Status != (mFuzzSlots[Slot].Present ? EFI_SUCCESS : EFI_NOT_FOUND)) {
+          ReportFuzzMismatch (Operation, Slot, "delete returned an unexpected status", Status);
+        }
+
+        mFuzzSlots[Slot].Present = FALSE;
+        break;
+
+      case FuzzOperationGet:
+        CheckFuzzSlot (Operation, Slot);
+        break;
+
+      default:
+        //
+        // The volatile variables are lost on a reset.
+        //
+        StopBenchmarkVariableDriver ();
+        Status = StartBenchmarkVariableDriver ();
+        if (EFI_ERROR (Status)) {
+          ReportFuzzMismatch (Operation, 0, "the variable driver failed to restart", Status);
+          break;
+        }
+
+        for (Slot = 0; Slot < FUZZ_SLOT_COUNT; Slot++) {
+          if ((mFuzzSlots[Slot].Attributes & EFI_VARIABLE_NON_VOLATILE) == 0) {
+            mFuzzSlots[Slot].Present = FALSE;
+          }
+        }
+
+        CheckFuzzEnumeration (Operation);
+        break;
+    }
+
+    if (mVariableModuleGlobal == NULL) {
+      break;
+    }
+
+    if (((Operation + 1) % FUZZ_CHECK_INTERVAL) == 0) {
+      CheckFuzzEnumeration (Operation);
+    }
+  }
+
+  if (mVariableModuleGlobal != NULL) {
+    for (Slot = 0; Slot < FUZZ_SLOT_COUNT; Slot++) {
+      CheckFuzzSlot (Operation, Slot);
+    }
+
+    CheckFuzzEnumeration (Operation);
+  }
+
+  GetBenchmarkFlashStats (&Stats);
+  if (Stats.ProgramErrors != 0) {
+    ReportFuzzMismatch (Operation, 0, "bits of the flash device were programmed from 0 to 1", EFI_SUCCESS);
+  }
+
+  printf (
+    "    {\n      \"store_size\": %llu, \"operations\": %llu, \"seed\": %llu, \"mismatches\": %llu,\n",
+    (unsigned long long)StoreSize,
+    (unsigned long long)Operation,
+    (unsigned long long)Seed,
+    (unsigned long long)mFuzzMismatches
+    );
+  printf ("      \"operation_counts\": {");
+  for (Index = 0; Index < FuzzOperationMax; Index++) {
+    printf ("%s \"%s\": %llu", (Index == 0) ? "" : ",", mFuzzOperationNames[Index], (unsigned long long)Counts[Index]);
+  }
+
+  printf (
+    " },\n      \"out_of_resources\": %llu, \"flash_bytes_written\": %llu, \"flash_blocks_erased\": %llu, "
+    "\"ftw_writes\": %llu, \"program_errors\": %llu\n    }",
+    (unsigned long long)OutOfResources,
+    (unsigned long long)Stats.BytesWritten,
+    (unsigned long long)Stats.BlocksErased,
+    (unsigned long long)Stats.FtwWriteCount,
+    (unsigned long long)Stats.ProgramErrors
+    );
+
+  StopBenchmarkVariableDriver ();
+  FreeBenchmarkFlash ();
+  return mFuzzMismatches;
+}
+
+/**
+  Parse the value of a command line option.
+
+  @param[in] Argc               Number of command line arguments.
+  @param[in] Argv               Command line arguments.
+  @param[in] Index              Index of the option.
+
+  @return The value of the option.
+
+**/
+UINT64
+GetOptionValue (
+  IN int   Argc,
+  IN char  **Argv,
+  IN int   Index
+  )
+{
+  char                *End;
+  unsigned long long  Value;
+
+  if (Index + 1 >= Argc) {
+    fprintf (stderr, "%s needs a value\n", Argv[Index]);
+    exit (2);
+  }
+
+  Value = strtoull (Argv[Index + 1], &End, 0);
+  if ((*Argv[Index + 1] == '\0') || (*End != '\0')) {
+    fprintf (stderr, "Invalid value for %s: %s\n", Argv[Index], Argv[Index + 1]);
+    exit (2);
+  }
+
+  return (UINT64)Value;
+}
+
+/**
+  Entry point of the benchmark.
+
+  @param[in] argc               Number of command line arguments.
+  @param[in] argv               Command line arguments.
+
+  @retval 0                     All the operations returned the expected result.
+  @retval 1                     At least one operation returned an unexpected result.
+  @retval 2                     The command line is invalid.
+
+**/
+int
+main (
+  int   argc,
+  char  **argv
+  )
+{
+  STATIC CONST UINTN  StoreSizes[]     = { SIZE_64KB, SIZE_256KB, SIZE_1MB };
+  STATIC CONST UINTN  VariableCounts[] = { 64, 256, 1024 };
+  UINTN               StoreSize;
+  UINTN               VariableCount;
+  UINTN               DataSize;
+  UINT64              Seed;
+  UINTN               FuzzOperations;
+  BOOLEAN             Fuzz;
+  UINTN               StoreIndex;
+  UINTN               CountIndex;
+  UINTN               Failures;
+  BOOLEAN             First;
+  int                 Index;
+
+  StoreSize      = 0;
+  VariableCount  = 0;
+  DataSize       = 32;
+  Seed           = BENCHMARK_DEFAULT_SEED;
+  FuzzOperations = FUZZ_DEFAULT_OPERATIONS;
+  Fuzz           = FALSE;
+
+  for (Index = 1; Index < argc; Index += 2) {
+    if (strcmp (argv[Index], "--store-size") == 0) {
+      StoreSize = (UINTN)GetOptionValue (argc, argv, Index);
+    } else if (strcmp (argv[Index], "--variable-count") == 0) {
+      VariableCount = (UINTN)GetOptionValue (argc, argv, Index);
+    } else if (strcmp (argv[Index], "--data-size") == 0) {
+      DataSize = (UINTN)GetOptionValue (argc, argv, Index);
+    } else if (strcmp (argv[Index], "--seed") == 0) {
+      Seed = GetOptionValue (argc, argv, Index);
+    } else if (strcmp (argv[Index], "--fuzz") == 0) {
+      FuzzOperations = (UINTN)GetOptionValue (argc, argv, Index);
+      Fuzz           = TRUE;
+    } else {
+      fprintf (stderr, "Unknown option %s\n", argv[Index]);
+      return 2;
+    }
+  }
+
+  if ((StoreSize != 0) &&
+      ((StoreSize % VARIABLE_BENCHMARK_BLOCK_SIZE != 0) || (StoreSize < 2 * PcdGet32 (PcdMaxVariableSize)) || (StoreSize > SIZE_64MB)))
+  {
+    fprintf (stderr, "--store-size must be a multiple of %u between 0x%x and 64MB\n", VARIABLE_BENCHMARK_BLOCK_SIZE, 2 * PcdGet32 (PcdMaxVariableSize));
+    return 2;
+  }
+
+  if ((DataSize == 0) || (DataSize > BENCHMARK_MAX_DATA_SIZE)) {
+    fprintf (stderr, "--data-size must be between 1 and %d\n", BENCHMARK_MAX_DATA_SIZE);
+    return 2;
+  }
+
+  if ((StoreSize != 0) && (VariableCount != 0) && !Fuzz && !IsRunValid (StoreSize, VariableCount, DataSize)) {
+    fprintf (stderr, "The variables must fill at most half of --store-size\n");
+    return 2;
+  }
+
+  //
+  // xorshift64 never leaves the state 0.
+  //
+  mRandomState = (Seed != 0) ? Seed : BENCHMARK_DEFAULT_SEED;
+
+  printf ("{\n  \"benchmark\": \"VariableRuntimeDxe\",\n");
+  printf (
+    "  \"features\": { \"PcdVariableStoreIndex\": %s, \"PcdVariableReclaimDirtyBlocks\": %s, \"PcdVariableRuntimeCacheDeltaSync\": %s },\n",
+    FeaturePcdGet (PcdVariableStoreIndex) ? "true" : "false",
+    FeaturePcdGet (PcdVariableReclaimDirtyBlocks) ? "true" : "false",
+    FeaturePcdGet (PcdVariableRuntimeCacheDeltaSync) ? "true" : "false"
+    );
+
+  if (Fuzz) {
+    printf ("  \"fuzz\":\n");
+    Failures = RunFuzz ((StoreSize != 0) ? StoreSize : FUZZ_DEFAULT_STORE_SIZE, FuzzOperations, Seed);
+    printf ("\n}\n");
+    return (Failures == 0) ? 0 : 1;
+  }
+
+  printf ("  \"runs\": [\n");
+  Failures = 0;
+  First    = TRUE;
+  for (StoreIndex = 0; StoreIndex < ARRAY_SIZE (StoreSizes); StoreIndex++) {
+    if ((StoreSize != 0) && (StoreIndex != 0)) {
+      break;
+    }
+
+    for (CountIndex = 0; CountIndex < ARRAY_SIZE (VariableCounts); CountIndex++) {
+      if ((VariableCount != 0) && (CountIndex != 0)) {
+        break;
+      }
+
+      if (!IsRunValid (
+             (StoreSize != 0) ? StoreSize : StoreSizes[StoreIndex],
+             (VariableCount != 0) ? VariableCount : VariableCounts[CountIndex],
+             DataSize
+             ))
+      {
+        continue;
+      }
+
+      Failures += RunBenchmark (
+                    (StoreSize != 0) ? StoreSize : StoreSizes[StoreIndex],
+                    (VariableCount != 0) ? VariableCount : VariableCounts[CountIndex],
+                    DataSize,
+                    First
+                    );
+      First = FALSE;
+    }
+  }
+
+  printf ("\n  ]\n}\n");
+  return (Failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,717 @@
+/** @file
+  Host based unit tests of the variable batch updates of the SMM variable
+  driver.
+
+  The variable driver runs on the emulated flash device of the variable
+  benchmark. Writes of the flash device are made to fail at each position of a
+  batch: a batch whose write fails must be undone, and a batch whose undo also
+  fails must keep the first AppliedCount records and the values of the other
+  variables, also after a reset.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../RuntimeDxeBenchmark/VariableBenchmark.h"
+#include "../VariableBatch.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_APP_NAME     "Variable Batch Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_STORE_SIZE      SIZE_32KB
+#define TEST_VARIABLE_COUNT  4
+#define TEST_NAME_LENGTH     16
+#define TEST_DATA_SIZE       64
+#define TEST_BATCH_SIZE      SIZE_4KB
+#define TEST_MAX_WRITES      64
+#define TEST_NV_ATTRIBUTES   (EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS)
+
+typedef struct {
+  CHAR16    Names[TEST_VARIABLE_COUNT][TEST_NAME_LENGTH];
+  ///
+  /// The value of each variable before the batch, and the value the batch
+  /// writes. A DataSize of 0 is a variable that does not exist, or that the
+  /// batch deletes.
+  ///
+  UINTN     OldDataSize[TEST_VARIABLE_COUNT];
+  UINT8     OldData[TEST_VARIABLE_COUNT][TEST_DATA_SIZE];
+  UINTN     NewDataSize[TEST_VARIABLE_COUNT];
+  UINT8     NewData[TEST_VARIABLE_COUNT][TEST_DATA_SIZE];
+  UINT8     Batch[TEST_BATCH_SIZE];
+  UINTN     BatchSize;
+} TEST_CONTEXT;
+
+STATIC EFI_GUID  mTestVendorGuid = {
+  0x6D2A9F41, 0xC83B, 0x4E17, { 0xB5, 0x0C, 0x7A, 0x94, 0x1E, 0x3D, 0x62, 0xF8 }
+};
+
+STATIC TEST_CONTEXT  mTestContext;
+
+/**
+  Make the name of a test variable from a prefix and an index.
+
+  @param[in]  Prefix  Prefix of the name.
+  @param[in]  Index   Index of the variable.
+  @param[out] Name    Returns the name, TEST_NAME_LENGTH characters at most.
+**/
+STATIC
+VOID
+TestMakeName (
+  IN  CONST CHAR16  *Prefix,
+  IN  UINTN         Index,
+  OUT CHAR16        *Name
+  )
+{
+  UINTN  Length;
+  UINTN  Digits;
+  UINTN  Value;
+
+  StrCpyS (Name, TEST_NAME_LENGTH, Prefix);
+  Length = StrLen (Name);
+
+  Digits = 1;
+  for (Value = Index; Value >= 10; Value /= 10) {
+    Digits++;
+  }
+
+  ASSERT (Length + Digits < TEST_NAME_LENGTH);
+  Name[Length + Digits] = L'\0';
+  for (Value = Index; Digits > 0; Value /= 10) {
+    Digits--;
+    Name[Length + Digits] = (CHAR16)(L'0' + Value % 10);
+  }
+}
+
+/**
+  Create the emulated flash device, start the variable driver and write the
+  values of the variables before the batch.
+
+  The batch updates the first variable, appends to the second one, deletes
+  the third one and creates the fourth one.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED                The variables are written.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The driver failed to start.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+VariableBatchTestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  EFI_STATUS    Status;
+  UINTN         Index;
+  UINTN         Offset;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  ZeroMem (TestContext, sizeof (*TestContext));
+
+  for (Index = 0; Index < TEST_VARIABLE_COUNT; Index++) {
+    TestMakeName (L"Batch", Index, TestContext->Names[Index]);
+    for (Offset = 0; Offset < TEST_DATA_SIZE; Offset++) {
+      TestContext->OldData[Index][Offset] = (UINT8)(Index * 16 + Offset);
+      TestContext->NewData[Index][Offset] = (UINT8)~(Index * 16 + Offset);
+    }
+  }
+
+  TestContext->OldDataSize[0] = TEST_DATA_SIZE;
+  TestContext->NewDataSize[0] = TEST_DATA_SIZE / 2;
+  TestContext->OldDataSize[1] = TEST_DATA_SIZE / 2;
+  TestContext->NewDataSize[1] = TEST_DATA_SIZE;
+  CopyMem (TestContext->NewData[1], TestContext->OldData[1], TEST_DATA_SIZE / 2);
+  TestContext->OldDataSize[2] = TEST_DATA_SIZE;
+  TestContext->NewDataSize[2] = 0;
+  TestContext->OldDataSize[3] = 0;
+  TestContext->NewDataSize[3] = TEST_DATA_SIZE;
+
+  if (EFI_ERROR (CreateBenchmarkFlash (TEST_STORE_SIZE))) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  Status = StartBenchmarkVariableDriver ();
+  if (EFI_ERROR (Status)) {
+    FreeBenchmarkFlash ();
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  for (Index = 0; Index < TEST_VARIABLE_COUNT; Index++) {
+    if (TestContext->OldDataSize[Index] != 0) {
+      Status = VariableServiceSetVariable (
+                 TestContext->Names[Index],
+                 &mTestVendorGuid,
+                 TEST_NV_ATTRIBUTES,
+                 TestContext->OldDataSize[Index],
+                 TestContext->OldData[Index]
+                 );
+      if (EFI_ERROR (Status)) {
+        return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+      }
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Stop the variable driver and free the emulated flash device.
+
+  @param[in]  Context  The test context.
+**/
+STATIC
+VOID
+EFIAPI
+VariableBatchTestCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  SetBenchmarkFlashWriteFailure (0, 0);
+  StopBenchmarkVariableDriver ();
+  FreeBenchmarkFlash ();
+}
+
+/**
+  Append a record to the SMM communication payload of the batch.
+
+  @param[in, out] TestContext  The test context holding the batch.
+  @param[in]      Name         Name of the variable.
+  @param[in]      Attributes   Attributes of the record.
+  @param[in]      DataSize     Size of Data.
+  @param[in]      Data         Data of the record.
+**/
+STATIC
+VOID
+TestAddBatchRecord (
+  IN OUT TEST_CONTEXT  *TestContext,
+  IN     CHAR16        *Name,
+  IN     UINT32        Attributes,
+  IN     UINTN         DataSize,
+  IN     VOID          *Data
+  )
+{
+  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH  *VariableBatch;
+  SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE     *Record;
+
+  VariableBatch = (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH *)TestContext->Batch;
+  if (TestContext->BatchSize == 0) {
+    TestContext->BatchSize = sizeof (*VariableBatch);
+  }
+
+  Record = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *)(TestContext->Batch + TestContext->BatchSize);
+  CopyGuid (&Record->Guid, &mTestVendorGuid);
+  Record->NameSize   = StrSize (Name);
+  Record->DataSize   = DataSize;
+  Record->Attributes = Attributes;
+  CopyMem (Record->Name, Name, Record->NameSize);
+  CopyMem ((UINT8 *)Record->Name + Record->NameSize, Data, DataSize);
+
+  TestContext->BatchSize += SMM_VARIABLE_BATCH_RECORD_SIZE (Record->NameSize, DataSize);
+  VariableBatch->EntryCount++;
+}
+
+/**
+  Build the batch of the test context, one record per variable.
+
+  @param[in, out] TestContext  The test context holding the batch.
+
+  @return The batch header.
+**/
+STATIC
+SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH *
+TestBuildBatch (
+  IN OUT TEST_CONTEXT  *TestContext
+  )
+{
+  ZeroMem (TestContext->Batch, sizeof (TestContext->Batch));
+  TestContext->BatchSize = 0;
+
+  TestAddBatchRecord (TestContext, TestContext->Names[0], TEST_NV_ATTRIBUTES, TestContext->NewDataSize[0], TestContext->NewData[0]);
+  TestAddBatchRecord (
+    TestContext,
+    TestContext->Names[1],
+    TEST_NV_ATTRIBUTES | EFI_VARIABLE_APPEND_WRITE,
+    TestContext->NewDataSize[1] - TestContext->OldDataSize[1],
+    TestContext->NewData[1] + TestContext->OldDataSize[1]
+    );
+  TestAddBatchRecord (TestContext, TestContext->Names[2], TEST_NV_ATTRIBUTES, 0, NULL);
+  TestAddBatchRecord (TestContext, TestContext->Names[3], TEST_NV_ATTRIBUTES, TestContext->NewDataSize[3], TestContext->NewData[3]);
+
+  return (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH *)TestContext->Batch;
+}
+
+/**
+  Check that a variable holds the expected value.
+
+  @param[in]  Name      Name of the variable.
+  @param[in]  DataSize  Expected size of the data, 0 if the variable must not
+                        exist.
+  @param[in]  Data      Expected data.
+
+  @retval TRUE   The variable holds the expected value.
+  @retval FALSE  It does not.
+**/
+STATIC
+BOOLEAN
+TestVariableHolds (
+  IN CHAR16  *Name,
+  IN UINTN   DataSize,
+  IN UINT8   *Data
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       Buffer[TEST_DATA_SIZE];
+  UINTN       Size;
+  UINT32      Attributes;
+
+  Size   = sizeof (Buffer);
+  Status = VariableServiceGetVariable (Name, &mTestVendorGuid, &Attributes, &Size, Buffer);
+  if (DataSize == 0) {
+    return (BOOLEAN)(Status == EFI_NOT_FOUND);
+  }
+
+  return (BOOLEAN)(!EFI_ERROR (Status) && (Size == DataSize) && (CompareMem (Buffer, Data, DataSize) == 0));
+}
+
+/**
+  Check that the first variables hold the values the batch writes, and the
+  other variables the values they had before the batch.
+
+  @param[in]  TestContext   The test context.
+  @param[in]  AppliedCount  Number of the first variables the batch updated.
+
+  @retval TRUE   The variables hold the expected values.
+  @retval FALSE  They do not.
+**/
+STATIC
+BOOLEAN
+TestVariablesHold (
+  IN TEST_CONTEXT  *TestContext,
+  IN UINTN         AppliedCount
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < TEST_VARIABLE_COUNT; Index++) {
+    if (Index < AppliedCount) {
+      if (!TestVariableHolds (TestContext->Names[Index], TestContext->NewDataSize[Index], TestContext->NewData[Index])) {
+        return FALSE;
+      }
+    } else if (!TestVariableHolds (TestContext->Names[Index], TestContext->OldDataSize[Index], TestContext->OldData[Index])) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Restart the variable driver from the content of the emulated flash device,
+  as after a reset.
+
+  @retval TRUE   The driver restarted.
+  @retval FALSE  It failed to restart.
+**/
+STATIC
+BOOLEAN
+TestReset (
+  VOID
+  )
+{
+  StopBenchmarkVariableDriver ();
+  return (BOOLEAN)!EFI_ERROR (StartBenchmarkVariableDriver ());
+}
+
+/**
+  A batch without failure applies all its records.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BatchAppliesAllRecords (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                                 *TestContext;
+  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH  *VariableBatch;
+
+  TestContext   = (TEST_CONTEXT *)Context;
+  VariableBatch = TestBuildBatch (TestContext);
+
+  UT_ASSERT_NOT_EFI_ERROR (SmmSetVariableBatch (VariableBatch, TestContext->BatchSize));
+  UT_ASSERT_EQUAL (VariableBatch->FailedIndex, TEST_VARIABLE_COUNT);
+  UT_ASSERT_EQUAL (VariableBatch->AppliedCount, TEST_VARIABLE_COUNT);
+  UT_ASSERT_TRUE (TestVariablesHold (TestContext, TEST_VARIABLE_COUNT));
+
+  UT_ASSERT_TRUE (TestReset ());
+  UT_ASSERT_TRUE (TestVariablesHold (TestContext, TEST_VARIABLE_COUNT));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A write that fails in the middle of a batch undoes the records applied
+  before it, at every write of the batch.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+FailedWriteUndoesBatch (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                                 *TestContext;
+  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH  *VariableBatch;
+  EFI_STATUS                                   Status;
+  UINT64                                       Writes;
+  UINTN                                        FailedRecords;
+
+  TestContext   = (TEST_CONTEXT *)Context;
+  FailedRecords = 0;
+
+  for (Writes = 0; Writes < TEST_MAX_WRITES; Writes++) {
+    VariableBatchTestCleanup (Context);
+    UT_ASSERT_EQUAL (VariableBatchTestSetup (Context), UNIT_TEST_PASSED);
+
+    VariableBatch = TestBuildBatch (TestContext);
+    SetBenchmarkFlashWriteFailure (Writes, 1);
+    Status = SmmSetVariableBatch (VariableBatch, TestContext->BatchSize);
+    SetBenchmarkFlashWriteFailure (0, 0);
+    if (!EFI_ERROR (Status)) {
+      //
+      // The batch completes before the failure.
+      //
+      UT_ASSERT_EQUAL (VariableBatch->AppliedCount, TEST_VARIABLE_COUNT);
+      UT_ASSERT_TRUE (TestVariablesHold (TestContext, TEST_VARIABLE_COUNT));
+      break;
+    }
+
+    UT_LOG_INFO ("Write %u failed record %u\n", (UINT32)Writes, (UINT32)VariableBatch->FailedIndex);
+    UT_ASSERT_TRUE (VariableBatch->FailedIndex < TEST_VARIABLE_COUNT);
+    UT_ASSERT_EQUAL (VariableBatch->AppliedCount, 0);
+    UT_ASSERT_TRUE (TestVariablesHold (TestContext, 0));
+
+    UT_ASSERT_TRUE (TestReset ());
+    UT_ASSERT_TRUE (TestVariablesHold (TestContext, 0));
+    FailedRecords |= (UINTN)1 << VariableBatch->FailedIndex;
+  }
+
+  //
+  // Every record of the batch failed once.
+  //
+  UT_ASSERT_TRUE (Writes < TEST_MAX_WRITES);
+  UT_ASSERT_EQUAL (FailedRecords, ((UINTN)1 << TEST_VARIABLE_COUNT) - 1);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  An undo that fails stops the rollback: the records before the one that
+  failed and before AppliedCount remain applied, the record that failed holds
+  its old or its new value, and the other variables keep their values, at
+  every write of the batch.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+FailedUndoKeepsPrefix (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                                 *TestContext;
+  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH  *VariableBatch;
+  EFI_STATUS                                   Status;
+  UINT64                                       Writes;
+  UINTN                                        AppliedCount;
+  UINTN                                        FailedIndex;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  for (Writes = 0; Writes < TEST_MAX_WRITES; Writes++) {
+    VariableBatchTestCleanup (Context);
+    UT_ASSERT_EQUAL (VariableBatchTestSetup (Context), UNIT_TEST_PASSED);
+
+    VariableBatch = TestBuildBatch (TestContext);
+    SetBenchmarkFlashWriteFailure (Writes, MAX_UINT64);
+    Status = SmmSetVariableBatch (VariableBatch, TestContext->BatchSize);
+    if (!EFI_ERROR (Status)) {
+      SetBenchmarkFlashWriteFailure (0, 0);
+      UT_ASSERT_EQUAL (VariableBatch->AppliedCount, TEST_VARIABLE_COUNT);
+      break;
+    }
+
+    //
+    // The first undo that writes the variable storage fails too: the undo of
+    // the record that failed, or of the record before it if the record that
+    // failed left its variable unchanged.
+    //
+    FailedIndex  = VariableBatch->FailedIndex;
+    AppliedCount = VariableBatch->AppliedCount;
+    UT_LOG_INFO ("Write %u failed record %u, %u applied\n", (UINT32)Writes, (UINT32)FailedIndex, (UINT32)AppliedCount);
+    UT_ASSERT_TRUE (FailedIndex < TEST_VARIABLE_COUNT);
+    UT_ASSERT_TRUE ((AppliedCount == FailedIndex) || (AppliedCount == FailedIndex + 1));
+    UT_ASSERT_TRUE (TestVariablesHold (TestContext, FailedIndex) || TestVariablesHold (TestContext, FailedIndex + 1));
+    if (AppliedCount == FailedIndex) {
+      UT_ASSERT_TRUE (TestVariablesHold (TestContext, FailedIndex));
+    }
+
+    SetBenchmarkFlashWriteFailure (0, 0);
+    UT_ASSERT_TRUE (TestReset ());
+    UT_ASSERT_TRUE (TestVariablesHold (TestContext, FailedIndex) || TestVariablesHold (TestContext, FailedIndex + 1));
+  }
+
+  UT_ASSERT_TRUE (Writes < TEST_MAX_WRITES);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A batch that updates a variable twice is refused before any write.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+DuplicateVariableRefused (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                                 *TestContext;
+  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH  *VariableBatch;
+  VARIABLE_BENCHMARK_FLASH_STATS               Before;
+  VARIABLE_BENCHMARK_FLASH_STATS               After;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  ZeroMem (TestContext->Batch, sizeof (TestContext->Batch));
+  TestContext->BatchSize = 0;
+  TestAddBatchRecord (TestContext, TestContext->Names[3], TEST_NV_ATTRIBUTES, TestContext->NewDataSize[3], TestContext->NewData[3]);
+  TestAddBatchRecord (TestContext, TestContext->Names[0], TEST_NV_ATTRIBUTES, TestContext->NewDataSize[0], TestContext->NewData[0]);
+  TestAddBatchRecord (TestContext, TestContext->Names[3], TEST_NV_ATTRIBUTES, 0, NULL);
+  VariableBatch = (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH *)TestContext->Batch;
+
+  GetBenchmarkFlashStats (&Before);
+  UT_ASSERT_STATUS_EQUAL (SmmSetVariableBatch (VariableBatch, TestContext->BatchSize), EFI_INVALID_PARAMETER);
+  GetBenchmarkFlashStats (&After);
+
+  UT_ASSERT_EQUAL (VariableBatch->FailedIndex, 2);
+  UT_ASSERT_EQUAL (VariableBatch->AppliedCount, 0);
+  UT_ASSERT_EQUAL (After.BytesWritten, Before.BytesWritten);
+  UT_ASSERT_TRUE (TestVariablesHold (TestContext, 0));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A batch whose records fit in the variable storage, but not with their undo,
+  is refused before any of its records is written.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+SpaceReservedBeforeFirstWrite (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                                 *TestContext;
+  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH  *VariableBatch;
+  SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE     *Record;
+  VARIABLE_BATCH_SPACE                         Space;
+  CHAR16                                       Name[TEST_NAME_LENGTH];
+  UINTN                                        Offset;
+  UINTN                                        Index;
+
+  TestContext   = (TEST_CONTEXT *)Context;
+  VariableBatch = TestBuildBatch (TestContext);
+
+  ZeroMem (&Space, sizeof (Space));
+  Offset = sizeof (*VariableBatch);
+  for (Index = 0; Index < VariableBatch->EntryCount; Index++) {
+    Record = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *)(TestContext->Batch + Offset);
+    UT_ASSERT_NOT_EFI_ERROR (
+      CheckVariableBatchUpdate (Record->Name, &Record->Guid, Record->Attributes, Record->DataSize, (UINT8 *)Record->Name + Record->NameSize, &Space)
+      );
+    Offset += SMM_VARIABLE_BATCH_RECORD_SIZE (Record->NameSize, Record->DataSize);
+  }
+
+  //
+  // Fill the variable storage with small variables that a reclaim cannot
+  // free, until the free area is just below the space of the batch and its
+  // undo. The batch alone, about half of that space, still fits.
+  //
+  for (Index = 0; mNvVariableCache->Size - mVariableModuleGlobal->NonVolatileLastVariableOffset >= Space.NvSize; Index++) {
+    TestMakeName (L"Fill", Index, Name);
+    UT_ASSERT_NOT_EFI_ERROR (VariableServiceSetVariable (Name, &mTestVendorGuid, TEST_NV_ATTRIBUTES, 1, TestContext->OldData[0]));
+  }
+
+  UT_ASSERT_TRUE (mNvVariableCache->Size - mVariableModuleGlobal->NonVolatileLastVariableOffset > Space.NvSize / 2 + TEST_DATA_SIZE);
+
+  UT_ASSERT_STATUS_EQUAL (SmmSetVariableBatch (VariableBatch, TestContext->BatchSize), EFI_OUT_OF_RESOURCES);
+  UT_ASSERT_EQUAL (VariableBatch->AppliedCount, 0);
+  UT_ASSERT_TRUE (TestVariablesHold (TestContext, 0));
+
+  UT_ASSERT_TRUE (TestReset ());
+  UT_ASSERT_TRUE (TestVariablesHold (TestContext, 0));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Add a test case of the variable batch, with the setup and cleanup of the
+  variable driver.
+
+  @param[in]  Suite        The test suite.
+  @param[in]  Description  Description of the test case.
+  @param[in]  ClassName    Class name of the test case.
+  @param[in]  Function     The test case.
+
+  @retval EFI_SUCCESS  The test case was added.
+  @retval Others       The test case could not be added.
+**/
+STATIC
+EFI_STATUS
+AddBatchTestCase (
+  IN UNIT_TEST_SUITE_HANDLE  Suite,
+  IN CHAR8                   *Description,
+  IN CHAR8                   *ClassName,
+  IN UNIT_TEST_FUNCTION      Function
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = AddTestCase (Suite, Description, ClassName, Function, VariableBatchTestSetup, VariableBatchTestCleanup, &mTestContext);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in AddTestCase for %a\n", ClassName));
+  }
+
+  return Status;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the variable
+  batch updates and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      VariableBatchTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the variable batch Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&VariableBatchTests, Framework, "Variable Batch Tests", "Variable.Batch", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Variable Batch Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  Status = AddBatchTestCase (VariableBatchTests, "A batch applies all its records", "Applied", BatchAppliesAllRecords);
+  if (!EFI_ERROR (Status)) {
+    Status = AddBatchTestCase (VariableBatchTests, "A failed write undoes the batch", "FailedWrite", FailedWriteUndoesBatch);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AddBatchTestCase (VariableBatchTests, "A failed undo keeps the first records", "FailedUndo", FailedUndoKeepsPrefix);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AddBatchTestCase (VariableBatchTests, "A variable updated twice is refused", "Duplicate", DuplicateVariableRefused);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AddBatchTestCase (VariableBatchTests, "The space of the undo is reserved", "Space", SpaceReservedBeforeFirstWrite);
+  }
+
+  if (EFI_ERROR (Status)) {
+    goto EXIT;
+  }
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define VariableBatchUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+VariableBatchUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
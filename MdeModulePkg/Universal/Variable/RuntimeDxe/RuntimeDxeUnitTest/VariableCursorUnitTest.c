@@ -0,0 +1,804 @@
+/** @file
+  Host based unit tests of the enumeration cursors of variable stores.
+
+  A volatile and a non-volatile variable store are filled with random added,
+  deleted and in deleted transition variables. The variables enumerated from
+  cursors, one by one or as records, must be the variables enumerated by name
+  with VariableServiceGetNextVariableInternal(). Cursors must be rejected after
+  a reclaim, and cursors that are not on a variable header must be rejected.
+  GetNextVariableByHint() must return the variables of the enumeration by name.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../VariableCursor.h"
+
+#include <Library/UnitTestLib.h>
+#include <Library/UnitTestRandomLib.h>
+
+#define UNIT_TEST_APP_NAME     "Variable Enumeration Cursor Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_STORE_SIZE     SIZE_4KB
+#define TEST_NAME_COUNT     24
+#define TEST_NAME_LENGTH    8
+#define TEST_MAX_VARIABLES  (2 * TEST_NAME_COUNT)
+
+typedef struct {
+  VARIABLE_STORE_HEADER      *Stores[VariableStoreTypeMax];
+  VARIABLE_CURSOR_CONTEXT    Cursors;
+  BOOLEAN                    AuthFormat;
+  ///
+  /// Variables in the order of VariableServiceGetNextVariableInternal().
+  ///
+  VARIABLE_HEADER            *Expected[TEST_MAX_VARIABLES];
+  UINTN                      ExpectedCount;
+  CHAR16                     Names[TEST_NAME_COUNT][TEST_NAME_LENGTH];
+  UINT64                     Seed;
+} TEST_CONTEXT;
+
+STATIC EFI_GUID  mTestVendorGuid = {
+  0x3B1C5E0A, 0x7F24, 0x4D8B, { 0x9A, 0x61, 0x2E, 0xC5, 0x40, 0x17, 0xB8, 0xD3 }
+};
+
+/**
+  Stub of the speculation barrier of the variable driver.
+**/
+VOID
+VariableSpeculationBarrier (
+  VOID
+  )
+{
+}
+
+/**
+  Stub of the runtime check of the variable driver.
+
+  @retval FALSE  The test enumerates variables at boot time.
+**/
+BOOLEAN
+AtRuntime (
+  VOID
+  )
+{
+  return FALSE;
+}
+
+/**
+  Append a variable to a test store.
+
+  @param[in]  TestContext  The test context.
+  @param[in]  Store        The variable store.
+  @param[in]  NameIndex    The index of the name of the variable.
+  @param[in]  State        The state of the variable.
+
+  @return The new variable, or NULL if there is no room left in the store.
+**/
+STATIC
+VARIABLE_HEADER *
+TestAppendVariable (
+  IN TEST_CONTEXT           *TestContext,
+  IN VARIABLE_STORE_HEADER  *Store,
+  IN UINTN                  NameIndex,
+  IN UINT8                  State
+  )
+{
+  VARIABLE_HEADER  *Variable;
+  UINTN            NameSize;
+  UINTN            DataSize;
+  BOOLEAN          AuthFormat;
+
+  AuthFormat = TestContext->AuthFormat;
+  Variable   = GetStartPointer (Store);
+  while (IsValidVariableHeader (Variable, GetEndPointer (Store))) {
+    Variable = GetNextVariablePtr (Variable, AuthFormat);
+  }
+
+  NameSize = StrSize (TestContext->Names[NameIndex]);
+  DataSize = 1 + UnitTestRandom (&TestContext->Seed) % 24;
+  if ((UINTN)GetEndPointer (Store) - (UINTN)Variable <
+      GetVariableHeaderSize (AuthFormat) + NameSize + GET_PAD_SIZE (NameSize) + DataSize + GET_PAD_SIZE (DataSize) + HEADER_ALIGNMENT)
+  {
+    return NULL;
+  }
+
+  ZeroMem (Variable, GetVariableHeaderSize (AuthFormat));
+  Variable->StartId    = VARIABLE_DATA;
+  Variable->State      = State;
+  Variable->Attributes = EFI_VARIABLE_BOOTSERVICE_ACCESS | (UnitTestRandom (&TestContext->Seed) % 2 == 0 ? EFI_VARIABLE_RUNTIME_ACCESS : 0);
+  SetNameSizeOfVariable (Variable, NameSize, AuthFormat);
+  SetDataSizeOfVariable (Variable, DataSize, AuthFormat);
+  CopyGuid (GetVendorGuidPtr (Variable, AuthFormat), &mTestVendorGuid);
+  CopyMem (GetVariableNamePtr (Variable, AuthFormat), TestContext->Names[NameIndex], NameSize);
+  SetMem (GetVariableDataPtr (Variable, AuthFormat), DataSize, (UINT8)NameIndex);
+  return Variable;
+}
+
+/**
+  Allocate an empty test store.
+
+  @param[in]  TestContext  The test context.
+
+  @return The store, or NULL if it could not be allocated.
+**/
+STATIC
+VARIABLE_STORE_HEADER *
+TestCreateStore (
+  IN TEST_CONTEXT  *TestContext
+  )
+{
+  VARIABLE_STORE_HEADER  *Store;
+
+  Store = AllocatePool (TEST_STORE_SIZE);
+  if (Store != NULL) {
+    SetMem (Store, TEST_STORE_SIZE, 0xff);
+    ZeroMem (Store, sizeof (VARIABLE_STORE_HEADER));
+    CopyGuid (&Store->Signature, TestContext->AuthFormat ? &gEfiAuthenticatedVariableGuid : &gEfiVariableGuid);
+    Store->Size   = TEST_STORE_SIZE;
+    Store->Format = VARIABLE_STORE_FORMATTED;
+    Store->State  = VARIABLE_STORE_HEALTHY;
+  }
+
+  return Store;
+}
+
+/**
+  Create the volatile and non-volatile test stores with random variables, and
+  enumerate them by name.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED                      The stores are created.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The stores could not be created.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+VariableCursorTestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT           *TestContext;
+  VARIABLE_STORE_HEADER  *Store;
+  VARIABLE_HEADER        *Variable;
+  UINTN                  NameIndex;
+  UINTN                  Choice;
+  CHAR16                 *Name;
+  EFI_GUID               *Guid;
+
+  TestContext       = (TEST_CONTEXT *)Context;
+  TestContext->Seed = 0xC0450;
+  ZeroMem (&TestContext->Cursors, sizeof (TestContext->Cursors));
+  ZeroMem (TestContext->Stores, sizeof (TestContext->Stores));
+
+  TestContext->Stores[VariableStoreTypeVolatile] = TestCreateStore (TestContext);
+  TestContext->Stores[VariableStoreTypeNv]       = TestCreateStore (TestContext);
+  if ((TestContext->Stores[VariableStoreTypeVolatile] == NULL) || (TestContext->Stores[VariableStoreTypeNv] == NULL)) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  for (NameIndex = 0; NameIndex < TEST_NAME_COUNT; NameIndex++) {
+    Name    = TestContext->Names[NameIndex];
+    Name[0] = L'V';
+    Name[1] = (CHAR16)(L'A' + NameIndex % 26);
+    Name[2] = (CHAR16)(L'a' + NameIndex % 3);
+    Name[3] = L'\0';
+    if (NameIndex % 4 == 0) {
+      Name[3] = L'x';
+      Name[4] = L'\0';
+    }
+
+    //
+    // Added, deleted, or updated with the previous instance left in deleted
+    // transition.
+    //
+    Store  = TestContext->Stores[(UnitTestRandom (&TestContext->Seed) % 2 == 0) ? VariableStoreTypeVolatile : VariableStoreTypeNv];
+    Choice = UnitTestRandom (&TestContext->Seed) % 8;
+    if (Choice == 0) {
+      Variable = TestAppendVariable (TestContext, Store, NameIndex, VAR_ADDED & VAR_DELETED);
+    } else if (Choice == 1) {
+      Variable = TestAppendVariable (TestContext, Store, NameIndex, VAR_ADDED & VAR_IN_DELETED_TRANSITION);
+      if (Variable != NULL) {
+        Variable = TestAppendVariable (TestContext, Store, NameIndex, VAR_ADDED);
+      }
+    } else {
+      Variable = TestAppendVariable (TestContext, Store, NameIndex, VAR_ADDED);
+    }
+
+    if (Variable == NULL) {
+      return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+    }
+  }
+
+  TestContext->ExpectedCount = 0;
+  Name                       = L"";
+  Guid                       = NULL;
+  while (!EFI_ERROR (VariableServiceGetNextVariableInternal (Name, Guid, TestContext->Stores, &Variable, TestContext->AuthFormat))) {
+    if (TestContext->ExpectedCount == TEST_MAX_VARIABLES) {
+      return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+    }
+
+    TestContext->Expected[TestContext->ExpectedCount++] = Variable;
+    Name                                                = GetVariableNamePtr (Variable, TestContext->AuthFormat);
+    Guid                                                = GetVendorGuidPtr (Variable, TestContext->AuthFormat);
+  }
+
+  if (TestContext->ExpectedCount == 0) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the test stores.
+
+  @param[in]  Context    The test context.
+**/
+STATIC
+VOID
+EFIAPI
+VariableCursorTestCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINTN         StoreType;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  for (StoreType = 0; StoreType < VariableStoreTypeMax; StoreType++) {
+    if (TestContext->Stores[StoreType] != NULL) {
+      FreePool (TestContext->Stores[StoreType]);
+      TestContext->Stores[StoreType] = NULL;
+    }
+  }
+}
+
+/**
+  Enumerate the variables one by one from the start cursor.
+
+  @param[in]  TestContext  The test context.
+  @param[in]  SetHint      TRUE to set the hint to the returned cursors as the
+                           variable driver does, FALSE to validate every cursor.
+
+  @retval UNIT_TEST_PASSED             The variables are enumerated by name order.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The enumeration does not match.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestEnumerateByCursor (
+  IN TEST_CONTEXT  *TestContext,
+  IN BOOLEAN       SetHint
+  )
+{
+  EFI_STATUS       Status;
+  UINT64           Cursor;
+  UINT64           NextCursor;
+  UINTN            Index;
+  VARIABLE_HEADER  *Variable;
+
+  Cursor = EDKII_VARIABLE_ENUMERATION_CURSOR_START;
+  for (Index = 0; Index < TestContext->ExpectedCount; Index++) {
+    Status = FindVariableByCursor (&TestContext->Cursors, Cursor, TestContext->Stores, TestContext->AuthFormat, &Variable, &NextCursor);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    UT_ASSERT_EQUAL ((UINTN)Variable, (UINTN)TestContext->Expected[Index]);
+    UT_ASSERT_EQUAL (VARIABLE_CURSOR_GENERATION (NextCursor), TestContext->Cursors.Generation);
+    Cursor = NextCursor;
+    if (SetHint) {
+      TestContext->Cursors.Hint = NextCursor;
+    }
+  }
+
+  Status = FindVariableByCursor (&TestContext->Cursors, Cursor, TestContext->Stores, TestContext->AuthFormat, &Variable, &NextCursor);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Enumerate the variables one by one from cursors.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+CursorsMatchNames (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  UT_ASSERT_EQUAL (TestEnumerateByCursor (TestContext, TRUE), UNIT_TEST_PASSED);
+  UT_ASSERT_EQUAL (TestEnumerateByCursor (TestContext, FALSE), UNIT_TEST_PASSED);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Enumerate the variables as records with buffers of several sizes.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+RecordsMatchNames (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST UINTN                 BufferSizes[] = { 48, 64, 100, 256, TEST_STORE_SIZE };
+  TEST_CONTEXT                       *TestContext;
+  EFI_STATUS                         Status;
+  UINT64                             Buffer[TEST_STORE_SIZE / sizeof (UINT64)];
+  UINT64                             Cursor;
+  UINTN                              BufferSize;
+  UINTN                              SizeIndex;
+  UINTN                              Offset;
+  UINTN                              Index;
+  UINTN                              CallCount;
+  EDKII_VARIABLE_ENUMERATION_RECORD  *Record;
+  VARIABLE_HEADER                    *Variable;
+  BOOLEAN                            AuthFormat;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  AuthFormat  = TestContext->AuthFormat;
+
+  for (SizeIndex = 0; SizeIndex < ARRAY_SIZE (BufferSizes); SizeIndex++) {
+    Cursor    = EDKII_VARIABLE_ENUMERATION_CURSOR_START;
+    Index     = 0;
+    CallCount = 0;
+    while (TRUE) {
+      BufferSize = BufferSizes[SizeIndex];
+      Status     = GetVariableRecordsByCursor (&TestContext->Cursors, &Cursor, TestContext->Stores, AuthFormat, &BufferSize, Buffer);
+      if (Status == EFI_NOT_FOUND) {
+        break;
+      }
+
+      UT_ASSERT_NOT_EFI_ERROR (Status);
+      UT_ASSERT_TRUE (BufferSize <= BufferSizes[SizeIndex]);
+      CallCount++;
+      for (Offset = 0; Offset < BufferSize; Offset += Record->RecordSize) {
+        Record = (EDKII_VARIABLE_ENUMERATION_RECORD *)((UINT8 *)Buffer + Offset);
+        UT_ASSERT_TRUE (Index < TestContext->ExpectedCount);
+        Variable = TestContext->Expected[Index++];
+        UT_ASSERT_EQUAL (Record->RecordSize % sizeof (UINT64), 0);
+        UT_ASSERT_TRUE (Record->RecordSize >= sizeof (EDKII_VARIABLE_ENUMERATION_RECORD) + Record->NameSize);
+        UT_ASSERT_EQUAL (Record->Attributes, Variable->Attributes);
+        UT_ASSERT_EQUAL (Record->NameSize, NameSizeOfVariable (Variable, AuthFormat));
+        UT_ASSERT_EQUAL (Record->DataSize, DataSizeOfVariable (Variable, AuthFormat));
+        UT_ASSERT_TRUE (CompareGuid (&Record->VendorGuid, GetVendorGuidPtr (Variable, AuthFormat)));
+        UT_ASSERT_MEM_EQUAL (Record + 1, GetVariableNamePtr (Variable, AuthFormat), Record->NameSize);
+      }
+
+      UT_ASSERT_EQUAL (Offset, BufferSize);
+    }
+
+    UT_ASSERT_EQUAL (Index, TestContext->ExpectedCount);
+    if (BufferSizes[SizeIndex] == TEST_STORE_SIZE) {
+      UT_ASSERT_EQUAL (CallCount, 1);
+    }
+  }
+
+  //
+  // A buffer smaller than the first record returns the size of the record and
+  // does not move the cursor.
+  //
+  Cursor     = EDKII_VARIABLE_ENUMERATION_CURSOR_START;
+  BufferSize = sizeof (EDKII_VARIABLE_ENUMERATION_RECORD);
+  Status     = GetVariableRecordsByCursor (&TestContext->Cursors, &Cursor, TestContext->Stores, AuthFormat, &BufferSize, Buffer);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_BUFFER_TOO_SMALL);
+  UT_ASSERT_EQUAL (Cursor, EDKII_VARIABLE_ENUMERATION_CURSOR_START);
+  UT_ASSERT_EQUAL (
+    BufferSize,
+    ALIGN_VALUE (sizeof (EDKII_VARIABLE_ENUMERATION_RECORD) + NameSizeOfVariable (TestContext->Expected[0], AuthFormat), sizeof (UINT64))
+    );
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Cursors returned before a reclaim are rejected after it, and the enumeration
+  restarts from the start cursor.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReclaimInvalidatesCursors (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT     *TestContext;
+  EFI_STATUS       Status;
+  UINT64           Cursor;
+  UINT64           NextCursor;
+  UINT64           Buffer[TEST_STORE_SIZE / sizeof (UINT64)];
+  UINTN            BufferSize;
+  UINTN            Index;
+  UINT16           Generation;
+  VARIABLE_HEADER  *Variable;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  Cursor = EDKII_VARIABLE_ENUMERATION_CURSOR_START;
+  for (Index = 0; Index < TestContext->ExpectedCount / 2; Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (FindVariableByCursor (&TestContext->Cursors, Cursor, TestContext->Stores, TestContext->AuthFormat, &Variable, &NextCursor));
+    Cursor                    = NextCursor;
+    TestContext->Cursors.Hint = NextCursor;
+  }
+
+  Generation = TestContext->Cursors.Generation;
+  InvalidateVariableCursors (&TestContext->Cursors);
+  UT_ASSERT_NOT_EQUAL (TestContext->Cursors.Generation, Generation);
+  UT_ASSERT_NOT_EQUAL (TestContext->Cursors.Hint, Cursor);
+
+  Status = FindVariableByCursor (&TestContext->Cursors, Cursor, TestContext->Stores, TestContext->AuthFormat, &Variable, &NextCursor);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+
+  NextCursor = Cursor;
+  BufferSize = sizeof (Buffer);
+  Status     = GetVariableRecordsByCursor (&TestContext->Cursors, &NextCursor, TestContext->Stores, TestContext->AuthFormat, &BufferSize, Buffer);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  UT_ASSERT_EQUAL (NextCursor, Cursor);
+
+  //
+  // The cursor of the same position in the new generation is valid.
+  //
+  Cursor = VARIABLE_CURSOR (TestContext->Cursors.Generation, VARIABLE_CURSOR_STORE_TYPE (Cursor), VARIABLE_CURSOR_OFFSET (Cursor));
+  Status = FindVariableByCursor (&TestContext->Cursors, Cursor, TestContext->Stores, TestContext->AuthFormat, &Variable, &NextCursor);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL ((UINTN)Variable, (UINTN)TestContext->Expected[TestContext->ExpectedCount / 2]);
+
+  //
+  // The generation wraps around after 65536 reclaims, which only makes the
+  // cursors of a much older generation look valid again.
+  //
+  for (Index = 0; Index < MAX_UINT16; Index++) {
+    InvalidateVariableCursors (&TestContext->Cursors);
+    UT_ASSERT_NOT_EQUAL (TestContext->Cursors.Generation, VARIABLE_CURSOR_GENERATION (Cursor));
+  }
+
+  UT_ASSERT_EQUAL (TestEnumerateByCursor (TestContext, TRUE), UNIT_TEST_PASSED);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Cursors that are not on a variable header of a store, or that are not in a
+  store, are rejected.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ForgedCursorsRejected (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT           *TestContext;
+  EFI_STATUS             Status;
+  VARIABLE_STORE_HEADER  *Store;
+  VARIABLE_HEADER        *Header;
+  VARIABLE_HEADER        *Variable;
+  UINT64                 NextCursor;
+  UINT16                 Generation;
+  UINTN                  Offset;
+  UINTN                  HeaderCount;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Generation  = TestContext->Cursors.Generation;
+  Store       = TestContext->Stores[VariableStoreTypeNv];
+
+  //
+  // Every offset of the store: only the variable headers and the end of the
+  // variables are accepted.
+  //
+  Header      = GetStartPointer (Store);
+  HeaderCount = 0;
+  for (Offset = 0; Offset <= TEST_STORE_SIZE + sizeof (UINT32); Offset += sizeof (UINT16)) {
+    Status = FindVariableByCursor (
+               &TestContext->Cursors,
+               VARIABLE_CURSOR (Generation, VariableStoreTypeNv, Offset),
+               TestContext->Stores,
+               TestContext->AuthFormat,
+               &Variable,
+               &NextCursor
+               );
+    if (Offset == (UINTN)Header - (UINTN)Store) {
+      UT_ASSERT_TRUE ((Status == EFI_SUCCESS) || (Status == EFI_NOT_FOUND));
+      if (IsValidVariableHeader (Header, GetEndPointer (Store))) {
+        Header = GetNextVariablePtr (Header, TestContext->AuthFormat);
+        HeaderCount++;
+      }
+    } else {
+      UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+    }
+  }
+
+  UT_ASSERT_NOT_EQUAL (HeaderCount, 0);
+
+  //
+  // Store types that are out of range or have no store.
+  //
+  Status = FindVariableByCursor (
+             &TestContext->Cursors,
+             VARIABLE_CURSOR (Generation, VariableStoreTypeHob, sizeof (VARIABLE_STORE_HEADER)),
+             TestContext->Stores,
+             TestContext->AuthFormat,
+             &Variable,
+             &NextCursor
+             );
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = FindVariableByCursor (
+             &TestContext->Cursors,
+             VARIABLE_CURSOR (Generation, VariableStoreTypeMax, sizeof (VARIABLE_STORE_HEADER)),
+             TestContext->Stores,
+             TestContext->AuthFormat,
+             &Variable,
+             &NextCursor
+             );
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  Status = FindVariableByCursor (
+             &TestContext->Cursors,
+             LShiftU64 (Generation, 48) | sizeof (VARIABLE_STORE_HEADER),
+             TestContext->Stores,
+             TestContext->AuthFormat,
+             &Variable,
+             &NextCursor
+             );
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_INVALID_PARAMETER);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  GetNextVariableByHint() enumerates the variables in name order, resuming
+  after the last variable it returned, and falls back to a lookup by name when
+  the name is not the last variable or when the cursors were invalidated.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+HintMatchesNames (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT     *TestContext;
+  EFI_STATUS       Status;
+  EFI_STATUS       ExpectedStatus;
+  UINTN            Index;
+  UINTN            Round;
+  CHAR16           *Name;
+  EFI_GUID         *Guid;
+  VARIABLE_HEADER  *Variable;
+  VARIABLE_HEADER  *ExpectedVariable;
+  BOOLEAN          AuthFormat;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  AuthFormat  = TestContext->AuthFormat;
+
+  //
+  // A whole enumeration, the last variable is remembered at every step.
+  //
+  Name = L"";
+  Guid = NULL;
+  for (Index = 0; Index < TestContext->ExpectedCount; Index++) {
+    Status = GetNextVariableByHint (&TestContext->Cursors, Name, Guid, TestContext->Stores, &Variable, AuthFormat);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+    UT_ASSERT_EQUAL ((UINTN)Variable, (UINTN)TestContext->Expected[Index]);
+    UT_ASSERT_NOT_EQUAL (TestContext->Cursors.LastVariable, 0);
+    Name = GetVariableNamePtr (Variable, AuthFormat);
+    Guid = GetVendorGuidPtr (Variable, AuthFormat);
+  }
+
+  Status = GetNextVariableByHint (&TestContext->Cursors, Name, Guid, TestContext->Stores, &Variable, AuthFormat);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+  UT_ASSERT_EQUAL (TestContext->Cursors.LastVariable, 0);
+
+  //
+  // Random names, with the cursors invalidated from time to time.
+  //
+  for (Round = 0; Round < 4 * TestContext->ExpectedCount; Round++) {
+    if (UnitTestRandom (&TestContext->Seed) % 8 == 0) {
+      InvalidateVariableCursors (&TestContext->Cursors);
+    }
+
+    Index  = UnitTestRandom (&TestContext->Seed) % TestContext->ExpectedCount;
+    Name   = GetVariableNamePtr (TestContext->Expected[Index], AuthFormat);
+    Guid   = GetVendorGuidPtr (TestContext->Expected[Index], AuthFormat);
+    Status = GetNextVariableByHint (&TestContext->Cursors, Name, Guid, TestContext->Stores, &Variable, AuthFormat);
+    if (Index + 1 == TestContext->ExpectedCount) {
+      UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+    } else {
+      UT_ASSERT_NOT_EFI_ERROR (Status);
+      UT_ASSERT_EQUAL ((UINTN)Variable, (UINTN)TestContext->Expected[Index + 1]);
+    }
+  }
+
+  //
+  // The last variable is deleted: the hint is not used, and the result is the
+  // one of the lookup by name.
+  //
+  Name = L"";
+  Guid = NULL;
+  for (Index = 0; Index < TestContext->ExpectedCount / 2; Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (GetNextVariableByHint (&TestContext->Cursors, Name, Guid, TestContext->Stores, &Variable, AuthFormat));
+    Name = GetVariableNamePtr (Variable, AuthFormat);
+    Guid = GetVendorGuidPtr (Variable, AuthFormat);
+  }
+
+  Variable->State &= VAR_DELETED;
+  ExpectedStatus   = VariableServiceGetNextVariableInternal (Name, Guid, TestContext->Stores, &ExpectedVariable, AuthFormat);
+  Status           = GetNextVariableByHint (&TestContext->Cursors, Name, Guid, TestContext->Stores, &Variable, AuthFormat);
+  UT_ASSERT_STATUS_EQUAL (Status, ExpectedStatus);
+  if (!EFI_ERROR (Status)) {
+    UT_ASSERT_EQUAL ((UINTN)Variable, (UINTN)ExpectedVariable);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Add a test case on the variable stores of a variable format.
+
+  @param[in]  Suite        The test suite.
+  @param[in]  Description  The description of the test case.
+  @param[in]  Name         The name of the test case.
+  @param[in]  Function     The test function.
+  @param[in]  AuthFormat   TRUE to use authenticated variables.
+
+  @retval EFI_SUCCESS           The test case is added.
+  @retval EFI_OUT_OF_RESOURCES  The test context could not be allocated.
+**/
+STATIC
+EFI_STATUS
+AddCursorTestCase (
+  IN UNIT_TEST_SUITE_HANDLE  Suite,
+  IN CHAR8                   *Description,
+  IN CHAR8                   *Name,
+  IN UNIT_TEST_FUNCTION      Function,
+  IN BOOLEAN                 AuthFormat
+  )
+{
+  TEST_CONTEXT  *TestContext;
+
+  //
+  // The contexts are freed when the process exits.
+  //
+  TestContext = AllocateZeroPool (sizeof (TEST_CONTEXT));
+  if (TestContext == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  TestContext->AuthFormat = AuthFormat;
+  return AddTestCase (Suite, Description, Name, Function, VariableCursorTestSetup, VariableCursorTestCleanup, TestContext);
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  enumeration cursors of variable stores and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      VariableCursorTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the variable enumeration cursor Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&VariableCursorTests, Framework, "Variable Enumeration Cursor Tests", "Variable.Cursor", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Variable Enumeration Cursor Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  Status = AddCursorTestCase (VariableCursorTests, "Cursors enumerate the variables in name order", "Cursors", CursorsMatchNames, FALSE);
+  if (!EFI_ERROR (Status)) {
+    Status = AddCursorTestCase (VariableCursorTests, "Cursors enumerate the authenticated variables in name order", "AuthCursors", CursorsMatchNames, TRUE);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AddCursorTestCase (VariableCursorTests, "Records enumerate the variables in name order", "Records", RecordsMatchNames, FALSE);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AddCursorTestCase (VariableCursorTests, "A reclaim invalidates the cursors", "Reclaim", ReclaimInvalidatesCursors, FALSE);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AddCursorTestCase (VariableCursorTests, "Cursors off a variable header are rejected", "Forged", ForgedCursorsRejected, FALSE);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AddCursorTestCase (VariableCursorTests, "GetNextVariableName resumes after the last variable", "Hint", HintMatchesNames, FALSE);
+  }
+
+  if (EFI_ERROR (Status)) {
+    goto EXIT;
+  }
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define VariableCursorUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+VariableCursorUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
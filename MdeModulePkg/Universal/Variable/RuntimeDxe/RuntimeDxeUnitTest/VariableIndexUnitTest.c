@@ -0,0 +1,541 @@
+/** @file
+  Host based unit tests of the hash index of variable stores.
+
+  Random sequences of variable updates and deletes are applied to a variable
+  store the way UpdateVariable() does, sometimes leaving instances in deleted
+  transition, and the store is reclaimed when it is full. After every few
+  updates, every variable is looked up with FindVariableInStoreIndex() and
+  with FindVariableEx(), at boot time and at runtime, and both lookups must
+  return the same instances.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../VariableIndex.h"
+
+#include <Library/UnitTestLib.h>
+#include <Library/UnitTestRandomLib.h>
+
+#define UNIT_TEST_APP_NAME     "Variable Store Index Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_STORE_SIZE      SIZE_16KB
+#define TEST_NAME_COUNT      40
+#define TEST_NAME_LENGTH     16
+#define TEST_RANDOM_STEPS    3000
+#define TEST_CHECK_INTERVAL  8
+
+typedef struct {
+  VARIABLE_STORE_HEADER    *Store;
+  VARIABLE_HEADER          *EndOfVariables;
+  VARIABLE_STORE_INDEX     Index;
+  BOOLEAN                  AuthFormat;
+  UINTN                    IndexStoreSize;
+  UINTN                    ReclaimCount;
+  BOOLEAN                  SawFullIndex;
+  CHAR16                   Names[TEST_NAME_COUNT + 1][TEST_NAME_LENGTH];
+  UINT64                   Seed;
+} TEST_CONTEXT;
+
+STATIC EFI_GUID  mTestVendorGuids[] = {
+  { 0x6A1EE763, 0xD47A, 0x43B4, { 0xAA, 0xBE, 0xEF, 0x1D, 0xE2, 0xAB, 0x56, 0xFC }
+  },
+  { 0x9D5C1A27, 0x2B0E, 0x4F61, { 0x8E, 0x3A, 0x4C, 0x77, 0x10, 0xD2, 0x95, 0x6B }
+  }
+};
+
+STATIC BOOLEAN  mTestAtRuntime = FALSE;
+
+/**
+  Stub of the runtime check of the variable driver.
+
+  @retval TRUE   The test looks up variables at runtime.
+  @retval FALSE  The test looks up variables at boot time.
+**/
+BOOLEAN
+AtRuntime (
+  VOID
+  )
+{
+  return mTestAtRuntime;
+}
+
+/**
+  Return the vendor GUID of a variable of the test.
+
+  @param[in]  NameIndex  The index of the name of the variable.
+
+  @return The vendor GUID. Some names are used with both GUIDs.
+**/
+STATIC
+EFI_GUID *
+TestVendorGuid (
+  IN UINTN  NameIndex
+  )
+{
+  return &mTestVendorGuids[(NameIndex / 3) % ARRAY_SIZE (mTestVendorGuids)];
+}
+
+/**
+  Initialize a variable track pointer of the test store.
+
+  @param[in]   TestContext  The test context.
+  @param[out]  PtrTrack     The variable track pointer.
+**/
+STATIC
+VOID
+TestInitPtrTrack (
+  IN  TEST_CONTEXT            *TestContext,
+  OUT VARIABLE_POINTER_TRACK  *PtrTrack
+  )
+{
+  ZeroMem (PtrTrack, sizeof (VARIABLE_POINTER_TRACK));
+  PtrTrack->StartPtr = GetStartPointer (TestContext->Store);
+  PtrTrack->EndPtr   = GetEndPointer (TestContext->Store);
+  PtrTrack->Volatile = TRUE;
+}
+
+/**
+  Append an added instance of a variable to the test store.
+
+  @param[in]  TestContext  The test context.
+  @param[in]  NameIndex    The index of the name of the variable.
+
+  @return The new instance, or NULL if there is no room left in the store.
+**/
+STATIC
+VARIABLE_HEADER *
+TestAppendVariable (
+  IN TEST_CONTEXT  *TestContext,
+  IN UINTN         NameIndex
+  )
+{
+  VARIABLE_HEADER  *Variable;
+  UINTN            NameSize;
+  UINTN            DataSize;
+  BOOLEAN          AuthFormat;
+
+  Variable   = TestContext->EndOfVariables;
+  AuthFormat = TestContext->AuthFormat;
+  NameSize   = StrSize (TestContext->Names[NameIndex]);
+  DataSize   = 1 + UnitTestRandom (&TestContext->Seed) % 24;
+  if ((UINTN)GetEndPointer (TestContext->Store) - (UINTN)Variable <
+      GetVariableHeaderSize (AuthFormat) + NameSize + GET_PAD_SIZE (NameSize) + DataSize + GET_PAD_SIZE (DataSize) + HEADER_ALIGNMENT)
+  {
+    return NULL;
+  }
+
+  ZeroMem (Variable, GetVariableHeaderSize (AuthFormat));
+  Variable->StartId    = VARIABLE_DATA;
+  Variable->State      = VAR_ADDED;
+  Variable->Attributes = EFI_VARIABLE_BOOTSERVICE_ACCESS;
+  if (UnitTestRandom (&TestContext->Seed) % 2 == 0) {
+    Variable->Attributes |= EFI_VARIABLE_RUNTIME_ACCESS;
+  }
+
+  SetNameSizeOfVariable (Variable, NameSize, AuthFormat);
+  SetDataSizeOfVariable (Variable, DataSize, AuthFormat);
+  CopyGuid (GetVendorGuidPtr (Variable, AuthFormat), TestVendorGuid (NameIndex));
+  CopyMem (GetVariableNamePtr (Variable, AuthFormat), TestContext->Names[NameIndex], NameSize);
+  SetMem (GetVariableDataPtr (Variable, AuthFormat), DataSize, (UINT8)NameIndex);
+
+  TestContext->EndOfVariables = GetNextVariablePtr (Variable, AuthFormat);
+  return Variable;
+}
+
+/**
+  Reclaim the test store: move the added and in deleted transition instances
+  to the start of the store, and reset the index as Reclaim() does.
+
+  @param[in]  TestContext  The test context.
+**/
+STATIC
+VOID
+TestReclaimStore (
+  IN TEST_CONTEXT  *TestContext
+  )
+{
+  UINT8            *Buffer;
+  UINT8            *Next;
+  VARIABLE_HEADER  *Variable;
+  UINTN            Size;
+
+  Buffer = AllocatePool (TEST_STORE_SIZE);
+  ASSERT (Buffer != NULL);
+  SetMem (Buffer, TEST_STORE_SIZE, 0xff);
+
+  Next = Buffer;
+  for (Variable = GetStartPointer (TestContext->Store);
+       IsValidVariableHeader (Variable, GetEndPointer (TestContext->Store));
+       Variable = GetNextVariablePtr (Variable, TestContext->AuthFormat))
+  {
+    if ((Variable->State == VAR_ADDED) || (Variable->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED))) {
+      Size = (UINTN)GetNextVariablePtr (Variable, TestContext->AuthFormat) - (UINTN)Variable;
+      CopyMem (Next, Variable, Size);
+      Next += Size;
+    }
+  }
+
+  Variable = GetStartPointer (TestContext->Store);
+  SetMem (Variable, (UINTN)GetEndPointer (TestContext->Store) - (UINTN)Variable, 0xff);
+  CopyMem (Variable, Buffer, (UINTN)(Next - Buffer));
+  TestContext->EndOfVariables = (VARIABLE_HEADER *)((UINTN)Variable + (UINTN)(Next - Buffer));
+  FreePool (Buffer);
+
+  ResetVariableStoreIndex (&TestContext->Index);
+  TestContext->ReclaimCount++;
+}
+
+/**
+  Update or delete a random variable of the test store.
+
+  @param[in]  TestContext  The test context.
+**/
+STATIC
+VOID
+TestRandomUpdate (
+  IN TEST_CONTEXT  *TestContext
+  )
+{
+  VARIABLE_POINTER_TRACK  PtrTrack;
+  UINTN                   NameIndex;
+  VARIABLE_HEADER         *Variable;
+
+  NameIndex = UnitTestRandom (&TestContext->Seed) % TEST_NAME_COUNT;
+  TestInitPtrTrack (TestContext, &PtrTrack);
+  FindVariableEx (TestContext->Names[NameIndex], TestVendorGuid (NameIndex), TRUE, &PtrTrack, TestContext->AuthFormat);
+
+  if ((PtrTrack.CurrPtr != NULL) && (UnitTestRandom (&TestContext->Seed) % 4 == 0)) {
+    PtrTrack.CurrPtr->State &= VAR_DELETED;
+    return;
+  }
+
+  //
+  // Mark the current instance in deleted transition, then append the new one
+  // and delete the current one, leaving it in deleted transition sometimes as
+  // an interrupted update does.
+  //
+  if (PtrTrack.CurrPtr != NULL) {
+    PtrTrack.CurrPtr->State &= VAR_IN_DELETED_TRANSITION;
+  }
+
+  Variable = TestAppendVariable (TestContext, NameIndex);
+  if (Variable == NULL) {
+    TestReclaimStore (TestContext);
+    return;
+  }
+
+  if ((PtrTrack.CurrPtr != NULL) && (UnitTestRandom (&TestContext->Seed) % 8 != 0)) {
+    PtrTrack.CurrPtr->State &= VAR_DELETED;
+  }
+}
+
+/**
+  Check the index lookups of every variable against FindVariableEx().
+
+  @param[in]  TestContext  The test context.
+
+  @retval UNIT_TEST_PASSED             The lookups match.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A lookup does not match.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestCheckLookups (
+  IN TEST_CONTEXT  *TestContext
+  )
+{
+  VARIABLE_POINTER_TRACK  Expected;
+  VARIABLE_POINTER_TRACK  Actual;
+  EFI_STATUS              ExpectedStatus;
+  EFI_STATUS              ActualStatus;
+  UINTN                   NameIndex;
+  UINTN                   Pass;
+  BOOLEAN                 IgnoreRtCheck;
+
+  for (Pass = 0; Pass < 4; Pass++) {
+    mTestAtRuntime = (BOOLEAN)((Pass & 1) != 0);
+    IgnoreRtCheck  = (BOOLEAN)((Pass & 2) != 0);
+    for (NameIndex = 0; NameIndex <= TEST_NAME_COUNT; NameIndex++) {
+      TestInitPtrTrack (TestContext, &Expected);
+      TestInitPtrTrack (TestContext, &Actual);
+      ExpectedStatus = FindVariableEx (TestContext->Names[NameIndex], TestVendorGuid (NameIndex), IgnoreRtCheck, &Expected, TestContext->AuthFormat);
+      ActualStatus   = FindVariableInStoreIndex (TestContext->Names[NameIndex], TestVendorGuid (NameIndex), IgnoreRtCheck, &Actual, TestContext->AuthFormat, &TestContext->Index);
+      UT_ASSERT_STATUS_EQUAL (ActualStatus, ExpectedStatus);
+      UT_ASSERT_EQUAL ((UINTN)Actual.CurrPtr, (UINTN)Expected.CurrPtr);
+      UT_ASSERT_EQUAL ((UINTN)Actual.InDeletedTransitionPtr, (UINTN)Expected.InDeletedTransitionPtr);
+    }
+  }
+
+  mTestAtRuntime = FALSE;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Create an empty variable store and its index.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED                      The store is created.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The store or the index could
+                                                not be allocated.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+VariableIndexTestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINTN         NameIndex;
+  UINTN         Length;
+  CHAR16        *Name;
+
+  TestContext               = (TEST_CONTEXT *)Context;
+  TestContext->Seed         = 0x5EED;
+  TestContext->ReclaimCount = 0;
+  TestContext->SawFullIndex = FALSE;
+  for (NameIndex = 0; NameIndex <= TEST_NAME_COUNT; NameIndex++) {
+    //
+    // Names of several lengths, the last one is never set. The empty name is
+    // looked up too.
+    //
+    Name = TestContext->Names[NameIndex];
+    if (NameIndex != 0) {
+      *Name++ = L'V';
+      for (Length = 0; Length < NameIndex % 7; Length++) {
+        *Name++ = L'a';
+      }
+
+      *Name++ = (CHAR16)(L'A' + NameIndex / 16);
+      *Name++ = (CHAR16)(L'A' + NameIndex % 16);
+    }
+
+    *Name = L'\0';
+  }
+
+  TestContext->Store = AllocatePool (TEST_STORE_SIZE);
+  if (TestContext->Store == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  SetMem (TestContext->Store, TEST_STORE_SIZE, 0xff);
+  ZeroMem (TestContext->Store, sizeof (VARIABLE_STORE_HEADER));
+  CopyGuid (&TestContext->Store->Signature, TestContext->AuthFormat ? &gEfiAuthenticatedVariableGuid : &gEfiVariableGuid);
+  TestContext->Store->Size   = TEST_STORE_SIZE;
+  TestContext->Store->Format = VARIABLE_STORE_FORMATTED;
+  TestContext->Store->State  = VARIABLE_STORE_HEALTHY;
+
+  TestContext->EndOfVariables = GetStartPointer (TestContext->Store);
+  if (EFI_ERROR (InitializeVariableStoreIndex (&TestContext->Index, TestContext->IndexStoreSize))) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the variable store and its index.
+
+  @param[in]  Context    The test context.
+**/
+STATIC
+VOID
+EFIAPI
+VariableIndexTestCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  if (TestContext->Store != NULL) {
+    FreePool (TestContext->Store);
+    TestContext->Store = NULL;
+  }
+
+  if (TestContext->Index.Entries != NULL) {
+    FreePool (TestContext->Index.Entries);
+    TestContext->Index.Entries = NULL;
+  }
+}
+
+/**
+  Check the index lookups against FindVariableEx() through random updates,
+  deletes and reclaims of a store.
+
+  @param[in]  Context    The test context.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+RandomUpdatesMatchWalk (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINTN         Step;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  for (Step = 0; Step < TEST_RANDOM_STEPS; Step++) {
+    TestRandomUpdate (TestContext);
+    if (Step % TEST_CHECK_INTERVAL == 0) {
+      UT_ASSERT_EQUAL (TestCheckLookups (TestContext), UNIT_TEST_PASSED);
+      TestContext->SawFullIndex |= TestContext->Index.Full;
+    }
+  }
+
+  UT_ASSERT_EQUAL (TestCheckLookups (TestContext), UNIT_TEST_PASSED);
+  UT_ASSERT_NOT_EQUAL (TestContext->ReclaimCount, 0);
+  if (TestContext->IndexStoreSize == 0) {
+    UT_ASSERT_TRUE (TestContext->SawFullIndex);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Add a test case of random updates for a variable format and index size.
+
+  @param[in]  Suite           The test suite.
+  @param[in]  Description     The description of the test case.
+  @param[in]  Name            The name of the test case.
+  @param[in]  AuthFormat      TRUE to use authenticated variables.
+  @param[in]  IndexStoreSize  The store size the index is sized for.
+
+  @retval EFI_SUCCESS           The test case is added.
+  @retval EFI_OUT_OF_RESOURCES  The test context could not be allocated.
+**/
+STATIC
+EFI_STATUS
+AddRandomUpdatesTestCase (
+  IN UNIT_TEST_SUITE_HANDLE  Suite,
+  IN CHAR8                   *Description,
+  IN CHAR8                   *Name,
+  IN BOOLEAN                 AuthFormat,
+  IN UINTN                   IndexStoreSize
+  )
+{
+  TEST_CONTEXT  *TestContext;
+
+  //
+  // The contexts are freed when the process exits.
+  //
+  TestContext = AllocateZeroPool (sizeof (TEST_CONTEXT));
+  if (TestContext == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  TestContext->AuthFormat     = AuthFormat;
+  TestContext->IndexStoreSize = IndexStoreSize;
+  return AddTestCase (Suite, Description, Name, RandomUpdatesMatchWalk, VariableIndexTestSetup, VariableIndexTestCleanup, TestContext);
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the variable
+  store index and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      VariableIndexTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the variable store index Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&VariableIndexTests, Framework, "Variable Store Index Tests", "Variable.Index", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Variable Store Index Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  Status = AddRandomUpdatesTestCase (VariableIndexTests, "Lookups match a store walk", "Lookups", FALSE, TEST_STORE_SIZE);
+  if (!EFI_ERROR (Status)) {
+    Status = AddRandomUpdatesTestCase (VariableIndexTests, "Lookups of authenticated variables match a store walk", "AuthLookups", TRUE, TEST_STORE_SIZE);
+  }
+
+  //
+  // An index sized for an empty store is full after a few variables, and
+  // lookups then walk the store.
+  //
+  if (!EFI_ERROR (Status)) {
+    Status = AddRandomUpdatesTestCase (VariableIndexTests, "Lookups with a full index match a store walk", "FullIndex", FALSE, 0);
+  }
+
+  if (EFI_ERROR (Status)) {
+    goto EXIT;
+  }
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define VariableIndexUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+VariableIndexUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
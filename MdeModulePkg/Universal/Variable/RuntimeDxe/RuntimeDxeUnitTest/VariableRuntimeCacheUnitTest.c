@@ -0,0 +1,524 @@
+/** @file
+  Host based unit tests of the runtime variable cache.
+
+  Random byte ranges are added to the journal of pending updates of a runtime
+  cache, and the bytes the journal covers are compared with a model of the
+  merges. Random changes to the variable stores are then synchronized to the
+  runtime caches, with the read lock sometimes held, and the runtime caches
+  must match the stores after every flush.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../VariableRuntimeCache.h"
+
+#include <Library/UnitTestLib.h>
+#include <Library/UnitTestRandomLib.h>
+
+#define UNIT_TEST_APP_NAME     "Variable Runtime Cache Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_STORE_SIZE         512
+#define TEST_MAX_UPDATE_LENGTH  16
+#define TEST_RANDOM_STEPS       20000
+
+VARIABLE_MODULE_GLOBAL  *mVariableModuleGlobal;
+VARIABLE_STORE_HEADER   *mNvVariableCache;
+
+typedef struct {
+  VARIABLE_MODULE_GLOBAL    ModuleGlobal;
+  BOOLEAN                   ReadLock;
+  BOOLEAN                   PendingUpdate;
+  UINT8                     NvStore[TEST_STORE_SIZE];
+  UINT8                     NvCache[TEST_STORE_SIZE];
+  UINT8                     VolatileStore[TEST_STORE_SIZE];
+  UINT8                     VolatileCache[TEST_STORE_SIZE];
+} TEST_CONTEXT;
+
+STATIC UINT64  mTestSeed;
+
+/**
+  Count the runs of covered bytes of a store.
+
+  @param[in]  Covered  One byte per byte of the store, TRUE if the byte is covered.
+
+  @return The number of runs of covered bytes.
+**/
+STATIC
+UINTN
+TestCountRuns (
+  IN BOOLEAN  *Covered
+  )
+{
+  UINTN  Index;
+  UINTN  Runs;
+
+  Runs = 0;
+  for (Index = 0; Index < TEST_STORE_SIZE; Index++) {
+    if (Covered[Index] && ((Index == 0) || !Covered[Index - 1])) {
+      Runs++;
+    }
+  }
+
+  return Runs;
+}
+
+/**
+  Fill the range between the run of covered bytes that holds a byte and the
+  previous or the next run.
+
+  @param[in, out]  Covered  One byte per byte of the store, TRUE if the byte is covered.
+  @param[in]       Offset   A covered byte.
+  @param[in]       Forward  TRUE to fill up to the next run, FALSE to fill up to the previous run.
+
+  @return The number of bytes filled, or MAX_UINTN if there is no such run.
+**/
+STATIC
+UINTN
+TestFillGap (
+  IN OUT BOOLEAN  *Covered,
+  IN     UINTN    Offset,
+  IN     BOOLEAN  Forward
+  )
+{
+  INTN  Index;
+  INTN  Step;
+  INTN  Start;
+
+  Step  = Forward ? 1 : -1;
+  Index = (INTN)Offset;
+  while ((Index >= 0) && (Index < TEST_STORE_SIZE) && Covered[Index]) {
+    Index += Step;
+  }
+
+  Start = Index;
+  while ((Index >= 0) && (Index < TEST_STORE_SIZE) && !Covered[Index]) {
+    Index += Step;
+  }
+
+  if ((Index < 0) || (Index >= TEST_STORE_SIZE)) {
+    return MAX_UINTN;
+  }
+
+  for (Index = Start; Covered[Index] == FALSE; Index += Step) {
+    Covered[Index] = TRUE;
+  }
+
+  return (UINTN)((Index - Start) * Step);
+}
+
+/**
+  Get the bytes covered by the journal of a runtime cache.
+
+  @param[in]   Cache    The runtime cache.
+  @param[out]  Covered  One byte per byte of the store, TRUE if the byte is covered.
+
+  @retval UNIT_TEST_PASSED            The journal is valid.
+  @retval UNIT_TEST_ERROR_TEST_FAILED Two pending updates overlap or touch, or
+                                      the journal overflowed.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestGetJournalCoverage (
+  IN  VARIABLE_RUNTIME_CACHE  *Cache,
+  OUT BOOLEAN                 *Covered
+  )
+{
+  UINTN  Index;
+  UINTN  Offset;
+
+  UT_ASSERT_TRUE (Cache->PendingUpdateCount <= VARIABLE_RUNTIME_CACHE_MAX_PENDING_UPDATES);
+
+  ZeroMem (Covered, TEST_STORE_SIZE * sizeof (BOOLEAN));
+  for (Index = 0; Index < Cache->PendingUpdateCount; Index++) {
+    UT_ASSERT_NOT_EQUAL (Cache->PendingUpdates[Index].Length, 0);
+    UT_ASSERT_TRUE ((UINTN)Cache->PendingUpdates[Index].Offset + Cache->PendingUpdates[Index].Length <= TEST_STORE_SIZE);
+    for (Offset = Cache->PendingUpdates[Index].Offset; Offset < Cache->PendingUpdates[Index].Offset + Cache->PendingUpdates[Index].Length; Offset++) {
+      UT_ASSERT_FALSE (Covered[Offset]);
+      Covered[Offset] = TRUE;
+    }
+  }
+
+  //
+  // Ranges that touch each other are merged.
+  //
+  UT_ASSERT_EQUAL (TestCountRuns (Covered), Cache->PendingUpdateCount);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Add a range to the journal of a runtime cache and check the result against
+  the bytes covered before.
+
+  If the journal is full, the range must be merged with the closest pending
+  update, which is the closest run of covered bytes. Either run may be taken
+  when both are as close.
+
+  @param[in]  Cache   The runtime cache.
+  @param[in]  Offset  The offset of the range.
+  @param[in]  Length  The length of the range.
+
+  @retval UNIT_TEST_PASSED            The journal covers the expected bytes.
+  @retval UNIT_TEST_ERROR_TEST_FAILED The journal does not cover the expected bytes.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestAddUpdate (
+  IN VARIABLE_RUNTIME_CACHE  *Cache,
+  IN UINTN                   Offset,
+  IN UINTN                   Length
+  )
+{
+  BOOLEAN  Expected[TEST_STORE_SIZE];
+  BOOLEAN  ExpectedForward[TEST_STORE_SIZE];
+  BOOLEAN  Actual[TEST_STORE_SIZE];
+  UINTN    BackwardGap;
+  UINTN    ForwardGap;
+  UINTN    Index;
+
+  UT_ASSERT_EQUAL (TestGetJournalCoverage (Cache, Expected), UNIT_TEST_PASSED);
+  for (Index = Offset; Index < Offset + Length; Index++) {
+    Expected[Index] = TRUE;
+  }
+
+  CopyMem (ExpectedForward, Expected, sizeof (Expected));
+  if ((Length != 0) && (TestCountRuns (Expected) > VARIABLE_RUNTIME_CACHE_MAX_PENDING_UPDATES)) {
+    BackwardGap = TestFillGap (Expected, Offset, FALSE);
+    ForwardGap  = TestFillGap (ExpectedForward, Offset, TRUE);
+    if (ForwardGap < BackwardGap) {
+      CopyMem (Expected, ExpectedForward, sizeof (Expected));
+    } else if (BackwardGap < ForwardGap) {
+      CopyMem (ExpectedForward, Expected, sizeof (Expected));
+    }
+  }
+
+  AddPendingRuntimeVariableCacheUpdate (Cache, Offset, Length);
+
+  UT_ASSERT_EQUAL (TestGetJournalCoverage (Cache, Actual), UNIT_TEST_PASSED);
+  UT_ASSERT_TRUE (
+    (CompareMem (Actual, Expected, sizeof (Actual)) == 0) ||
+    (CompareMem (Actual, ExpectedForward, sizeof (Actual)) == 0)
+    );
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Adjacent and overlapping ranges are merged, and a range added to a full
+  journal is merged with the closest pending update.
+
+  @param[in]  Context  Unused.
+
+  @retval UNIT_TEST_PASSED            The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+MergeRanges (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VARIABLE_RUNTIME_CACHE  Cache;
+  UINTN                   Index;
+
+  ZeroMem (&Cache, sizeof (Cache));
+
+  AddPendingRuntimeVariableCacheUpdate (&Cache, 0, 4);
+  AddPendingRuntimeVariableCacheUpdate (&Cache, 4, 4);
+  AddPendingRuntimeVariableCacheUpdate (&Cache, 2, 3);
+  AddPendingRuntimeVariableCacheUpdate (&Cache, 8, 0);
+  UT_ASSERT_EQUAL (Cache.PendingUpdateCount, 1);
+  UT_ASSERT_EQUAL (Cache.PendingUpdates[0].Offset, 0);
+  UT_ASSERT_EQUAL (Cache.PendingUpdates[0].Length, 8);
+
+  Cache.PendingUpdateCount = 0;
+  for (Index = 0; Index < VARIABLE_RUNTIME_CACHE_MAX_PENDING_UPDATES; Index++) {
+    AddPendingRuntimeVariableCacheUpdate (&Cache, Index * 10, 2);
+  }
+
+  UT_ASSERT_EQUAL (Cache.PendingUpdateCount, VARIABLE_RUNTIME_CACHE_MAX_PENDING_UPDATES);
+
+  //
+  // 33 is one byte after the range at 30 and six bytes before the one at 40.
+  //
+  AddPendingRuntimeVariableCacheUpdate (&Cache, 33, 1);
+  UT_ASSERT_EQUAL (Cache.PendingUpdateCount, VARIABLE_RUNTIME_CACHE_MAX_PENDING_UPDATES);
+  for (Index = 0; Index < Cache.PendingUpdateCount; Index++) {
+    if (Cache.PendingUpdates[Index].Offset == 30) {
+      break;
+    }
+  }
+
+  UT_ASSERT_TRUE (Index < Cache.PendingUpdateCount);
+  UT_ASSERT_EQUAL (Cache.PendingUpdates[Index].Length, 4);
+
+  //
+  // A range that spans several pending updates replaces them.
+  //
+  AddPendingRuntimeVariableCacheUpdate (&Cache, 5, 50);
+  UT_ASSERT_EQUAL (Cache.PendingUpdateCount, 4);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The journal of random ranges covers the bytes of the model.
+
+  @param[in]  Context  Unused.
+
+  @retval UNIT_TEST_PASSED            The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+RandomRangesMatchModel (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VARIABLE_RUNTIME_CACHE  Cache;
+  UINTN                   Step;
+  UINTN                   Offset;
+  UINTN                   Length;
+  UINTN                   FullCount;
+
+  ZeroMem (&Cache, sizeof (Cache));
+  mTestSeed = 0x5EED;
+  FullCount = 0;
+
+  for (Step = 0; Step < TEST_RANDOM_STEPS; Step++) {
+    if (UnitTestRandom (&mTestSeed) % 64 == 0) {
+      Cache.PendingUpdateCount = 0;
+    }
+
+    Length = UnitTestRandom (&mTestSeed) % (TEST_MAX_UPDATE_LENGTH + 1);
+    Offset = UnitTestRandom (&mTestSeed) % (TEST_STORE_SIZE - Length + 1);
+    if (Cache.PendingUpdateCount == VARIABLE_RUNTIME_CACHE_MAX_PENDING_UPDATES) {
+      FullCount++;
+    }
+
+    UT_ASSERT_EQUAL (TestAddUpdate (&Cache, Offset, Length), UNIT_TEST_PASSED);
+  }
+
+  UT_ASSERT_NOT_EQUAL (FullCount, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Set up the variable stores and the runtime caches of the variable driver.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED  The stores are set up.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+RuntimeCacheTestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                    *TestContext;
+  VARIABLE_RUNTIME_CACHE_CONTEXT  *CacheContext;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  ZeroMem (TestContext, sizeof (TEST_CONTEXT));
+  ((VARIABLE_STORE_HEADER *)TestContext->NvStore)->Size       = TEST_STORE_SIZE;
+  ((VARIABLE_STORE_HEADER *)TestContext->VolatileStore)->Size = TEST_STORE_SIZE;
+  CopyMem (TestContext->NvCache, TestContext->NvStore, TEST_STORE_SIZE);
+  CopyMem (TestContext->VolatileCache, TestContext->VolatileStore, TEST_STORE_SIZE);
+
+  CacheContext                                     = &TestContext->ModuleGlobal.VariableGlobal.VariableRuntimeCacheContext;
+  CacheContext->ReadLock                           = &TestContext->ReadLock;
+  CacheContext->PendingUpdate                      = &TestContext->PendingUpdate;
+  CacheContext->VariableRuntimeNvCache.Store       = (VARIABLE_STORE_HEADER *)TestContext->NvCache;
+  CacheContext->VariableRuntimeVolatileCache.Store = (VARIABLE_STORE_HEADER *)TestContext->VolatileCache;
+  TestContext->ModuleGlobal.VariableGlobal.VolatileVariableBase = (EFI_PHYSICAL_ADDRESS)(UINTN)TestContext->VolatileStore;
+
+  mVariableModuleGlobal = &TestContext->ModuleGlobal;
+  mNvVariableCache      = (VARIABLE_STORE_HEADER *)TestContext->NvStore;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Random changes of the variable stores reach the runtime caches when the
+  read lock is released.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED            The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+RandomChangesReachCaches (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT                    *TestContext;
+  VARIABLE_RUNTIME_CACHE_CONTEXT  *CacheContext;
+  VARIABLE_RUNTIME_CACHE          *Cache;
+  UINT8                           *Store;
+  UINTN                           Step;
+  UINTN                           Offset;
+  UINTN                           Length;
+  UINTN                           Index;
+  UINT32                          FlushCount;
+  UINT32                          StoreCopyCount;
+
+  TestContext    = (TEST_CONTEXT *)Context;
+  CacheContext   = &TestContext->ModuleGlobal.VariableGlobal.VariableRuntimeCacheContext;
+  mTestSeed      = 0xCAC4E;
+  FlushCount     = 0;
+  StoreCopyCount = 0;
+
+  for (Step = 0; Step < TEST_RANDOM_STEPS; Step++) {
+    if (UnitTestRandom (&mTestSeed) % 2 == 0) {
+      Cache = &CacheContext->VariableRuntimeNvCache;
+      Store = TestContext->NvStore;
+    } else {
+      Cache = &CacheContext->VariableRuntimeVolatileCache;
+      Store = TestContext->VolatileStore;
+    }
+
+    //
+    // A reclaim synchronizes the whole store.
+    //
+    if (UnitTestRandom (&mTestSeed) % 128 == 0) {
+      Offset = 0;
+      Length = TEST_STORE_SIZE;
+    } else {
+      Length = UnitTestRandom (&mTestSeed) % TEST_MAX_UPDATE_LENGTH + 1;
+      Offset = sizeof (VARIABLE_STORE_HEADER) + UnitTestRandom (&mTestSeed) % (TEST_STORE_SIZE - sizeof (VARIABLE_STORE_HEADER) - Length + 1);
+    }
+
+    for (Index = MAX (Offset, sizeof (VARIABLE_STORE_HEADER)); Index < Offset + Length; Index++) {
+      Store[Index] = (UINT8)UnitTestRandom (&mTestSeed);
+    }
+
+    TestContext->ReadLock = (BOOLEAN)(UnitTestRandom (&mTestSeed) % 4 == 0);
+    UT_ASSERT_NOT_EFI_ERROR (SynchronizeRuntimeVariableCache (Cache, Offset, Length));
+    if (Length == TEST_STORE_SIZE) {
+      StoreCopyCount++;
+    }
+
+    if (!TestContext->ReadLock) {
+      FlushCount++;
+      UT_ASSERT_FALSE (TestContext->PendingUpdate);
+      UT_ASSERT_EQUAL (CacheContext->VariableRuntimeNvCache.PendingUpdateCount, 0);
+      UT_ASSERT_EQUAL (CacheContext->VariableRuntimeVolatileCache.PendingUpdateCount, 0);
+      UT_ASSERT_MEM_EQUAL (TestContext->NvCache, TestContext->NvStore, TEST_STORE_SIZE);
+      UT_ASSERT_MEM_EQUAL (TestContext->VolatileCache, TestContext->VolatileStore, TEST_STORE_SIZE);
+    } else {
+      UT_ASSERT_TRUE (TestContext->PendingUpdate);
+    }
+  }
+
+  if (FeaturePcdGet (PcdVariableCollectStatistics)) {
+    UT_ASSERT_EQUAL (CacheContext->VariableRuntimeNvCache.Statistics.FlushCount, FlushCount);
+    UT_ASSERT_EQUAL (CacheContext->VariableRuntimeVolatileCache.Statistics.FlushCount, FlushCount);
+    UT_ASSERT_TRUE (
+      CacheContext->VariableRuntimeNvCache.Statistics.StoreCopyCount +
+      CacheContext->VariableRuntimeVolatileCache.Statistics.StoreCopyCount <= StoreCopyCount
+      );
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  runtime variable cache and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      RuntimeCacheTests;
+  TEST_CONTEXT                *TestContext;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // The context is freed when the process exits.
+  //
+  TestContext = AllocateZeroPool (sizeof (TEST_CONTEXT));
+  if (TestContext == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the runtime variable cache Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&RuntimeCacheTests, Framework, "Variable Runtime Cache Tests", "Variable.RuntimeCache", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Variable Runtime Cache Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (RuntimeCacheTests, "Adjacent, overlapping and closest ranges are merged", "MergeRanges", MergeRanges, NULL, NULL, NULL);
+  AddTestCase (RuntimeCacheTests, "Pending ranges cover the bytes of the model", "RandomRanges", RandomRangesMatchModel, NULL, NULL, NULL);
+  AddTestCase (RuntimeCacheTests, "Runtime caches match the stores after a flush", "RandomChanges", RandomChangesReachCaches, RuntimeCacheTestSetup, NULL, TestContext);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define VariableRuntimeCacheUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+VariableRuntimeCacheUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
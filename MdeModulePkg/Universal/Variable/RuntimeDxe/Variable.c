@@ -29,6 +29,11 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "VariableNonVolatile.h"
 #include "VariableParsing.h"
 #include "VariableRuntimeCache.h"
+#include "VariableIndex.h"
+#include "VariableCursor.h"
+
+#include <Guid/MemoryOverwriteControl.h>
+#include <IndustryStandard/MemoryOverwriteRequestControlLock.h>
 
 VARIABLE_MODULE_GLOBAL  *mVariableModuleGlobal;
 
@@ -43,6 +48,17 @@ VARIABLE_STORE_HEADER  *mNvVariableCache = NULL;
 ///
 EFI_FIRMWARE_VOLUME_HEADER  *mNvFvHeaderCache = NULL;
 
+///
+/// Hash indexes of the variable stores, used to find variables when
+/// PcdVariableStoreIndex is TRUE.
+///
+VARIABLE_STORE_INDEX  mVariableStoreIndex[VariableStoreTypeMax];
+
+///
+/// Cursor context of the variable stores for the Variable Enumeration Protocol.
+///
+VARIABLE_CURSOR_CONTEXT  mVariableCursorContext;
+
 ///
 /// The memory entry used for variable statistics data.
 ///
@@ -339,11 +355,20 @@ RecordVarErrorFlag (
       // Update the data in NV cache.
       //
       *VarErrFlag = TempFlag;
-      Status      =  SynchronizeRuntimeVariableCache (
-                       &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache,
-                       0,
-                       mNvVariableCache->Size
-                       );
+      if (FeaturePcdGet (PcdVariableRuntimeCacheDeltaSync)) {
+        Status = SynchronizeRuntimeVariableCache (
+                   &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache,
+                   (UINTN)VarErrFlag - (UINTN)mNvVariableCache,
+                   sizeof (TempFlag)
+                   );
+      } else {
+        Status =  SynchronizeRuntimeVariableCache (
+                    &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache,
+                    0,
+                    mNvVariableCache->Size
+                    );
+      }
+
       ASSERT_EFI_ERROR (Status);
     }
   }
@@ -792,6 +817,17 @@ Reclaim (
   }
 
 Done:
+  //
+  // Variables were moved, the index of the store and the indexes of the
+  // runtime caches are rebuilt by the next lookups, and the enumeration
+  // cursors are no longer valid.
+  //
+  ResetVariableStoreIndex (&mVariableStoreIndex[IsVolatile ? VariableStoreTypeVolatile : VariableStoreTypeNv]);
+  InvalidateVariableCursors (&mVariableCursorContext);
+  if (mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.StoreRewriteCount != NULL) {
+    (*(mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.StoreRewriteCount))++;
+  }
+
   DoneStatus = EFI_SUCCESS;
   if (IsVolatile || mVariableModuleGlobal->VariableGlobal.EmuNvMode) {
     DoneStatus = SynchronizeRuntimeVariableCache (
@@ -885,12 +921,13 @@ FindVariable (
     PtrTrack->EndPtr   = GetEndPointer (VariableStoreHeader[Type]);
     PtrTrack->Volatile = (BOOLEAN)(Type == VariableStoreTypeVolatile);
 
-    Status =  FindVariableEx (
+    Status =  FindVariableInStoreIndex (
                 VariableName,
                 VendorGuid,
                 IgnoreRtCheck,
                 PtrTrack,
-                mVariableModuleGlobal->VariableGlobal.AuthFormat
+                mVariableModuleGlobal->VariableGlobal.AuthFormat,
+                &mVariableStoreIndex[Type]
                 );
     if (!EFI_ERROR (Status)) {
       return Status;
@@ -1656,6 +1693,64 @@ AutoUpdateLangVariable (
   }
 }
 
+/**
+  Synchronizes the runtime cache of a variable store with the bytes changed by
+  an update of a variable: the state of the old variable, the state of the old
+  variable in deleted transition and the variables appended to the store.
+
+  @param[in] VariableRuntimeCache    The runtime cache of the updated variable store.
+  @param[in] VariableStore           The updated variable store.
+  @param[in] CacheVariable           The old variable in VariableStore.
+  @param[in] LastVariableOffset      Offset of the free space of the store before the update.
+  @param[in] NewLastVariableOffset   Offset of the free space of the store after the update.
+
+  @retval EFI_SUCCESS                The changed bytes were added as pending updates.
+  @retval EFI_UNSUPPORTED            The runtime cache is not initialized properly.
+
+**/
+EFI_STATUS
+SynchronizeRuntimeVariableCacheForUpdate (
+  IN VARIABLE_RUNTIME_CACHE  *VariableRuntimeCache,
+  IN VARIABLE_STORE_HEADER   *VariableStore,
+  IN VARIABLE_POINTER_TRACK  *CacheVariable,
+  IN UINTN                   LastVariableOffset,
+  IN UINTN                   NewLastVariableOffset
+  )
+{
+  EFI_STATUS       Status;
+  VARIABLE_HEADER  *StateVariable[2];
+  UINTN            Index;
+
+  //
+  // A reclaim of the store during the update already added the whole store
+  //
+  Status = EFI_SUCCESS;
+  if (NewLastVariableOffset > LastVariableOffset) {
+    Status = SynchronizeRuntimeVariableCache (
+               VariableRuntimeCache,
+               LastVariableOffset,
+               NewLastVariableOffset - LastVariableOffset
+               );
+  }
+
+  StateVariable[0] = CacheVariable->CurrPtr;
+  StateVariable[1] = CacheVariable->InDeletedTransitionPtr;
+  for (Index = 0; (Index < ARRAY_SIZE (StateVariable)) && !EFI_ERROR (Status); Index++) {
+    if ((StateVariable[Index] != NULL) &&
+        ((UINTN)StateVariable[Index] > (UINTN)VariableStore) &&
+        ((UINTN)StateVariable[Index] < (UINTN)VariableStore + VariableStore->Size))
+    {
+      Status = SynchronizeRuntimeVariableCache (
+                 VariableRuntimeCache,
+                 (UINTN)&StateVariable[Index]->State - (UINTN)VariableStore,
+                 sizeof (StateVariable[Index]->State)
+                 );
+    }
+  }
+
+  return Status;
+}
+
 /**
   Update the variable region with Variable information. If EFI_VARIABLE_AUTHENTICATED_WRITE_ACCESS is set,
   index of associated public key is needed.
@@ -1688,6 +1783,7 @@ UpdateVariable (
   )
 {
   EFI_STATUS                          Status;
+  EFI_STATUS                          SyncStatus;
   VARIABLE_HEADER                     *NextVariable;
   UINTN                               ScratchSize;
   UINTN                               MaxDataSize;
@@ -1710,6 +1806,8 @@ UpdateVariable (
   BOOLEAN                             IsCommonUserVariable;
   AUTHENTICATED_VARIABLE_HEADER       *AuthVariable;
   BOOLEAN                             AuthFormat;
+  UINTN                               NvLastVariableOffset;
+  UINTN                               VolatileLastVariableOffset;
 
   if ((mVariableModuleGlobal->FvbInstance == NULL) && !mVariableModuleGlobal->VariableGlobal.EmuNvMode) {
     //
@@ -1733,6 +1831,12 @@ UpdateVariable (
 
   AuthFormat = mVariableModuleGlobal->VariableGlobal.AuthFormat;
 
+  //
+  // Remember the end of the stores to find the variables appended by the update.
+  //
+  NvLastVariableOffset       = mVariableModuleGlobal->NonVolatileLastVariableOffset;
+  VolatileLastVariableOffset = mVariableModuleGlobal->VolatileLastVariableOffset;
+
   //
   // Check if CacheVariable points to the variable in variable HOB.
   // If yes, let CacheVariable points to the variable in NV variable cache.
@@ -2175,15 +2279,19 @@ UpdateVariable (
       //
       // Step 1:
       //
-      Status = UpdateVariableStore (
-                 &mVariableModuleGlobal->VariableGlobal,
-                 FALSE,
-                 TRUE,
-                 Fvb,
-                 mVariableModuleGlobal->NonVolatileLastVariableOffset,
-                 (UINT32)VarSize,
-                 (UINT8 *)NextVariable
-                 );
+      // The header is programmed in the VAR_HEADER_VALID_ONLY state, so that
+      // the variable is parsed if step 2 fails, see DataSizeOfVariable().
+      //
+      NextVariable->State = VAR_HEADER_VALID_ONLY;
+      Status              = UpdateVariableStore (
+                              &mVariableModuleGlobal->VariableGlobal,
+                              FALSE,
+                              TRUE,
+                              Fvb,
+                              mVariableModuleGlobal->NonVolatileLastVariableOffset,
+                              (UINT32)VarSize,
+                              (UINT8 *)NextVariable
+                              );
 
       if (EFI_ERROR (Status)) {
         goto Done;
@@ -2204,6 +2312,23 @@ UpdateVariable (
                               );
 
       if (EFI_ERROR (Status)) {
+        //
+        // The header and data of the variable are programmed in the
+        // VAR_HEADER_VALID_ONLY state, and take their space until the next
+        // reclaim, as they do when the store is parsed after a reset. Skip
+        // them, so that the next variable is not programmed over them.
+        //
+        CopyMem ((UINT8 *)mNvVariableCache + mVariableModuleGlobal->NonVolatileLastVariableOffset, (UINT8 *)NextVariable, VarSize);
+        mVariableModuleGlobal->NonVolatileLastVariableOffset += HEADER_ALIGN (VarSize);
+        if ((Attributes & EFI_VARIABLE_HARDWARE_ERROR_RECORD) != 0) {
+          mVariableModuleGlobal->HwErrVariableTotalSize += HEADER_ALIGN (VarSize);
+        } else {
+          mVariableModuleGlobal->CommonVariableTotalSize += HEADER_ALIGN (VarSize);
+          if (IsCommonUserVariable) {
+            mVariableModuleGlobal->CommonUserVariableTotalSize += HEADER_ALIGN (VarSize);
+          }
+        }
+
         goto Done;
       }
 
@@ -2349,7 +2474,11 @@ UpdateVariable (
   }
 
 Done:
-  if (!EFI_ERROR (Status)) {
+  //
+  // A failed update may still have appended a variable to the non-volatile
+  // store, which the runtime cache must hold too.
+  //
+  if (!EFI_ERROR (Status) || (mVariableModuleGlobal->NonVolatileLastVariableOffset != NvLastVariableOffset)) {
     if (((Variable->CurrPtr != NULL) && !Variable->Volatile) || ((Attributes & EFI_VARIABLE_NON_VOLATILE) != 0)) {
       VolatileCacheInstance = &(mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache);
     } else {
@@ -2357,14 +2486,38 @@ Done:
     }
 
     if (VolatileCacheInstance->Store != NULL) {
-      Status =  SynchronizeRuntimeVariableCache (
-                  VolatileCacheInstance,
-                  0,
-                  VolatileCacheInstance->Store->Size
-                  );
-      ASSERT_EFI_ERROR (Status);
+      if (!FeaturePcdGet (PcdVariableRuntimeCacheDeltaSync)) {
+        SyncStatus = SynchronizeRuntimeVariableCache (
+                       VolatileCacheInstance,
+                       0,
+                       VolatileCacheInstance->Store->Size
+                       );
+      } else if (VolatileCacheInstance == &(mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache)) {
+        SyncStatus = SynchronizeRuntimeVariableCacheForUpdate (
+                       VolatileCacheInstance,
+                       mNvVariableCache,
+                       CacheVariable,
+                       NvLastVariableOffset,
+                       mVariableModuleGlobal->NonVolatileLastVariableOffset
+                       );
+      } else {
+        SyncStatus = SynchronizeRuntimeVariableCacheForUpdate (
+                       VolatileCacheInstance,
+                       (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.VolatileVariableBase,
+                       CacheVariable,
+                       VolatileLastVariableOffset,
+                       mVariableModuleGlobal->VolatileLastVariableOffset
+                       );
+      }
+
+      ASSERT_EFI_ERROR (SyncStatus);
+      if (!EFI_ERROR (Status)) {
+        Status = SyncStatus;
+      }
     }
-  } else if (Status == EFI_OUT_OF_RESOURCES) {
+  }
+
+  if (Status == EFI_OUT_OF_RESOURCES) {
     DEBUG ((DEBUG_WARN, "UpdateVariable failed: Out of flash space\n"));
   }
 
@@ -2541,13 +2694,14 @@ VariableServiceGetNextVariableName (
   VariableStoreHeader[VariableStoreTypeHob]      = (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.HobVariableBase;
   VariableStoreHeader[VariableStoreTypeNv]       = mNvVariableCache;
 
-  Status =  VariableServiceGetNextVariableInternal (
-              VariableName,
-              VendorGuid,
-              VariableStoreHeader,
-              &VariablePtr,
-              AuthFormat
-              );
+  Status = GetNextVariableByHint (
+             &mVariableCursorContext,
+             VariableName,
+             VendorGuid,
+             VariableStoreHeader,
+             &VariablePtr,
+             AuthFormat
+             );
   if (!EFI_ERROR (Status)) {
     VarNameSize = NameSizeOfVariable (VariablePtr, AuthFormat);
     ASSERT (VarNameSize != 0);
@@ -2575,54 +2729,172 @@ VariableServiceGetNextVariableName (
 }
 
 /**
+  Return the name and GUID of the variable at an enumeration cursor, and
+  advance the cursor to the next variable.
 
-  This code sets variable in storage blocks (Volatile or Non-Volatile).
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode. This function will do basic validation, before parse the data.
+
+  @param[in, out] Cursor            On input, EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor
+                                    returned by the variable driver. On output, the cursor of the
+                                    next variable if EFI_SUCCESS is returned.
+  @param[in, out] VariableNameSize  On input, the size of the VariableName buffer. On output, the
+                                    size of the name of the variable.
+  @param[out]     VariableName      Returns the Null-terminated name of the variable.
+  @param[out]     VendorGuid        Returns the vendor GUID of the variable.
+  @param[out]     Attributes        Returns the attributes of the variable. Optional.
+
+  @retval EFI_SUCCESS               The variable was returned and Cursor was advanced.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_BUFFER_TOO_SMALL      VariableNameSize is too small for the name. VariableNameSize
+                                    has been updated with the size needed, Cursor is unchanged.
+  @retval EFI_INVALID_PARAMETER     Cursor, VariableNameSize, VariableName or VendorGuid is NULL.
+                                    Or Cursor is not a cursor of the current variable stores.
+
+**/
+EFI_STATUS
+EFIAPI
+VariableServiceGetNextVariableNameByCursor (
+  IN OUT UINT64    *Cursor,
+  IN OUT UINTN     *VariableNameSize,
+  OUT    CHAR16    *VariableName,
+  OUT    EFI_GUID  *VendorGuid,
+  OUT    UINT32    *Attributes OPTIONAL
+  )
+{
+  EFI_STATUS             Status;
+  UINTN                  VarNameSize;
+  UINT64                 NextCursor;
+  BOOLEAN                AuthFormat;
+  VARIABLE_HEADER        *VariablePtr;
+  VARIABLE_STORE_HEADER  *VariableStoreHeader[VariableStoreTypeMax];
+
+  if ((Cursor == NULL) || (VariableNameSize == NULL) || (VariableName == NULL) || (VendorGuid == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  AuthFormat = mVariableModuleGlobal->VariableGlobal.AuthFormat;
+
+  AcquireLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+
+  VariableStoreHeader[VariableStoreTypeVolatile] = (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.VolatileVariableBase;
+  VariableStoreHeader[VariableStoreTypeHob]      = (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.HobVariableBase;
+  VariableStoreHeader[VariableStoreTypeNv]       = mNvVariableCache;
+
+  Status = FindVariableByCursor (&mVariableCursorContext, *Cursor, VariableStoreHeader, AuthFormat, &VariablePtr, &NextCursor);
+  if (!EFI_ERROR (Status)) {
+    VarNameSize = NameSizeOfVariable (VariablePtr, AuthFormat);
+    ASSERT (VarNameSize != 0);
+    if (VarNameSize <= *VariableNameSize) {
+      CopyMem (VariableName, GetVariableNamePtr (VariablePtr, AuthFormat), VarNameSize);
+      CopyMem (VendorGuid, GetVendorGuidPtr (VariablePtr, AuthFormat), sizeof (EFI_GUID));
+      if (Attributes != NULL) {
+        *Attributes = VariablePtr->Attributes;
+      }
+
+      *Cursor                     = NextCursor;
+      mVariableCursorContext.Hint = NextCursor;
+    } else {
+      Status = EFI_BUFFER_TOO_SMALL;
+    }
+
+    *VariableNameSize = VarNameSize;
+  }
+
+  ReleaseLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+  return Status;
+}
+
+/**
+  Return packed EDKII_VARIABLE_ENUMERATION_RECORD records of the variables from
+  an enumeration cursor, as many as Buffer holds, and advance the cursor past
+  them.
 
   Caution: This function may receive untrusted input.
-  This function may be invoked in SMM mode, and datasize and data are external input.
-  This function will do basic validation, before parse the data.
-  This function will parse the authentication carefully to avoid security issues, like
-  buffer overflow, integer overflow.
-  This function will check attribute carefully to avoid authentication bypass.
+  This function may be invoked in SMM mode. This function will do basic validation, before parse the data.
 
-  @param VariableName                     Name of Variable to be found.
-  @param VendorGuid                       Variable vendor GUID.
-  @param Attributes                       Attribute value of the variable found
-  @param DataSize                         Size of Data found. If size is less than the
-                                          data, this value contains the required size.
-  @param Data                             Data pointer.
+  @param[in, out] Cursor            On input, EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor
+                                    returned by the variable driver. On output, the cursor of the
+                                    variable following the last record if EFI_SUCCESS is returned.
+  @param[in, out] BufferSize        On input, the size of Buffer. On output, the size of the records
+                                    returned, or the size of the first record if EFI_BUFFER_TOO_SMALL
+                                    is returned.
+  @param[out]     Buffer            Returns the records.
 
-  @retval EFI_SUCCESS                     The function completed successfully.
-  @retval EFI_NOT_FOUND                   The variable was not found.
-  @retval EFI_BUFFER_TOO_SMALL            The DataSize is too small for the result.
-  @retval EFI_INVALID_PARAMETER           VariableName is NULL.
-  @retval EFI_INVALID_PARAMETER           VendorGuid is NULL.
-  @retval EFI_INVALID_PARAMETER           DataSize is NULL.
-  @retval EFI_INVALID_PARAMETER           The DataSize is not too small and Data is NULL.
-  @retval EFI_DEVICE_ERROR                The variable could not be retrieved due to a hardware error.
-  @retval EFI_SECURITY_VIOLATION          The variable could not be retrieved due to an authentication failure.
-  @retval EFI_UNSUPPORTED                 After ExitBootServices() has been called, this return code may be returned
-                                          if no variable storage is supported. The platform should describe this
-                                          runtime service as unsupported at runtime via an EFI_RT_PROPERTIES_TABLE
-                                          configuration table.
+  @retval EFI_SUCCESS               At least one record was returned and Cursor was advanced.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_BUFFER_TOO_SMALL      Buffer cannot hold the first record. Cursor is unchanged.
+  @retval EFI_INVALID_PARAMETER     Cursor, BufferSize or Buffer is NULL.
+                                    Or Cursor is not a cursor of the current variable stores.
 
 **/
 EFI_STATUS
 EFIAPI
-VariableServiceSetVariable (
-  IN CHAR16    *VariableName,
-  IN EFI_GUID  *VendorGuid,
-  IN UINT32    Attributes,
-  IN UINTN     DataSize,
-  IN VOID      *Data
+VariableServiceGetVariableRecords (
+  IN OUT UINT64  *Cursor,
+  IN OUT UINTN   *BufferSize,
+  OUT    VOID    *Buffer
   )
 {
-  VARIABLE_POINTER_TRACK  Variable;
-  EFI_STATUS              Status;
-  VARIABLE_HEADER         *NextVariable;
-  EFI_PHYSICAL_ADDRESS    Point;
-  UINTN                   PayloadSize;
-  BOOLEAN                 AuthFormat;
+  EFI_STATUS             Status;
+  VARIABLE_STORE_HEADER  *VariableStoreHeader[VariableStoreTypeMax];
+
+  if ((Cursor == NULL) || (BufferSize == NULL) || (Buffer == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  AcquireLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+
+  VariableStoreHeader[VariableStoreTypeVolatile] = (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.VolatileVariableBase;
+  VariableStoreHeader[VariableStoreTypeHob]      = (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.HobVariableBase;
+  VariableStoreHeader[VariableStoreTypeNv]       = mNvVariableCache;
+
+  Status = GetVariableRecordsByCursor (
+             &mVariableCursorContext,
+             Cursor,
+             VariableStoreHeader,
+             mVariableModuleGlobal->VariableGlobal.AuthFormat,
+             BufferSize,
+             Buffer
+             );
+
+  ReleaseLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+  return Status;
+}
+
+/**
+  Checks the parameters of SetVariable() that do not depend on the variable
+  storage, and gets the size of the payload of the variable data.
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode, and datasize and data are external input.
+
+  @param[in]  VariableName      Name of the variable.
+  @param[in]  VendorGuid        Variable vendor GUID.
+  @param[in]  Attributes        Attributes of the variable.
+  @param[in]  DataSize          Size of Data.
+  @param[in]  Data              Data of the variable, including the authentication
+                                descriptor of authenticated variables.
+  @param[out] PayloadSize       Size of the data without the authentication
+                                descriptor.
+
+  @retval EFI_SUCCESS           The parameters are valid.
+  @retval Others                The status SetVariable() returns for these
+                                parameters.
+
+**/
+STATIC
+EFI_STATUS
+CheckSetVariableParameters (
+  IN  CHAR16    *VariableName,
+  IN  EFI_GUID  *VendorGuid,
+  IN  UINT32    Attributes,
+  IN  UINTN     DataSize,
+  IN  VOID      *Data,
+  OUT UINTN     *PayloadSize
+  )
+{
+  BOOLEAN  AuthFormat;
 
   AuthFormat = mVariableModuleGlobal->VariableGlobal.AuthFormat;
 
@@ -2703,7 +2975,7 @@ VariableServiceSetVariable (
       return EFI_UNSUPPORTED;
     }
 
-    PayloadSize = DataSize - AUTHINFO_SIZE;
+    *PayloadSize = DataSize - AUTHINFO_SIZE;
   } else if ((Attributes & EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS) == EFI_VARIABLE_TIME_BASED_AUTHENTICATED_WRITE_ACCESS) {
     //
     // Sanity check for EFI_VARIABLE_AUTHENTICATION_2 descriptor.
@@ -2721,12 +2993,12 @@ VariableServiceSetVariable (
     // before the execution of subsequent codes.
     //
     VariableSpeculationBarrier ();
-    PayloadSize = DataSize - AUTHINFO2_SIZE (Data);
+    *PayloadSize = DataSize - AUTHINFO2_SIZE (Data);
   } else {
-    PayloadSize = DataSize;
+    *PayloadSize = DataSize;
   }
 
-  if ((UINTN)(~0) - PayloadSize < StrSize (VariableName)) {
+  if ((UINTN)(~0) - *PayloadSize < StrSize (VariableName)) {
     //
     // Prevent whole variable size overflow
     //
@@ -2739,7 +3011,7 @@ VariableServiceSetVariable (
   //  bytes for HwErrRec#### variable.
   //
   if ((Attributes & EFI_VARIABLE_HARDWARE_ERROR_RECORD) == EFI_VARIABLE_HARDWARE_ERROR_RECORD) {
-    if (StrSize (VariableName) + PayloadSize >
+    if (StrSize (VariableName) + *PayloadSize >
         PcdGet32 (PcdMaxHardwareErrorVariableSize) - GetVariableHeaderSize (AuthFormat))
     {
       return EFI_INVALID_PARAMETER;
@@ -2750,7 +3022,7 @@ VariableServiceSetVariable (
     //  the DataSize is limited to maximum size of Max(Auth|Volatile)VariableSize bytes.
     //
     if ((Attributes & VARIABLE_ATTRIBUTE_AT_AW) != 0) {
-      if (StrSize (VariableName) + PayloadSize >
+      if (StrSize (VariableName) + *PayloadSize >
           mVariableModuleGlobal->MaxAuthVariableSize -
           GetVariableHeaderSize (AuthFormat))
       {
@@ -2766,14 +3038,14 @@ VariableServiceSetVariable (
           "NameSize(0x%x) + PayloadSize(0x%x) > "
           "MaxAuthVariableSize(0x%x) - HeaderSize(0x%x)\n",
           StrSize (VariableName),
-          PayloadSize,
+          *PayloadSize,
           mVariableModuleGlobal->MaxAuthVariableSize,
           GetVariableHeaderSize (AuthFormat)
           ));
         return EFI_INVALID_PARAMETER;
       }
     } else if ((Attributes & EFI_VARIABLE_NON_VOLATILE) != 0) {
-      if (StrSize (VariableName) + PayloadSize >
+      if (StrSize (VariableName) + *PayloadSize >
           mVariableModuleGlobal->MaxVariableSize - GetVariableHeaderSize (AuthFormat))
       {
         DEBUG ((
@@ -2788,14 +3060,14 @@ VariableServiceSetVariable (
           "NameSize(0x%x) + PayloadSize(0x%x) > "
           "MaxVariableSize(0x%x) - HeaderSize(0x%x)\n",
           StrSize (VariableName),
-          PayloadSize,
+          *PayloadSize,
           mVariableModuleGlobal->MaxVariableSize,
           GetVariableHeaderSize (AuthFormat)
           ));
         return EFI_INVALID_PARAMETER;
       }
     } else {
-      if (StrSize (VariableName) + PayloadSize >
+      if (StrSize (VariableName) + *PayloadSize >
           mVariableModuleGlobal->MaxVolatileVariableSize - GetVariableHeaderSize (AuthFormat))
       {
         DEBUG ((
@@ -2810,7 +3082,7 @@ VariableServiceSetVariable (
           "NameSize(0x%x) + PayloadSize(0x%x) > "
           "MaxVolatileVariableSize(0x%x) - HeaderSize(0x%x)\n",
           StrSize (VariableName),
-          PayloadSize,
+          *PayloadSize,
           mVariableModuleGlobal->MaxVolatileVariableSize,
           GetVariableHeaderSize (AuthFormat)
           ));
@@ -2819,6 +3091,69 @@ VariableServiceSetVariable (
     }
   }
 
+  return EFI_SUCCESS;
+}
+
+/**
+
+  This code sets variable in storage blocks (Volatile or Non-Volatile).
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode, and datasize and data are external input.
+  This function will do basic validation, before parse the data.
+  This function will parse the authentication carefully to avoid security issues, like
+  buffer overflow, integer overflow.
+  This function will check attribute carefully to avoid authentication bypass.
+
+  @param VariableName                     Name of Variable to be found.
+  @param VendorGuid                       Variable vendor GUID.
+  @param Attributes                       Attribute value of the variable found
+  @param DataSize                         Size of Data found. If size is less than the
+                                          data, this value contains the required size.
+  @param Data                             Data pointer.
+
+  @retval EFI_SUCCESS                     The function completed successfully.
+  @retval EFI_NOT_FOUND                   The variable was not found.
+  @retval EFI_BUFFER_TOO_SMALL            The DataSize is too small for the result.
+  @retval EFI_INVALID_PARAMETER           VariableName is NULL.
+  @retval EFI_INVALID_PARAMETER           VendorGuid is NULL.
+  @retval EFI_INVALID_PARAMETER           DataSize is NULL.
+  @retval EFI_INVALID_PARAMETER           The DataSize is not too small and Data is NULL.
+  @retval EFI_DEVICE_ERROR                The variable could not be retrieved due to a hardware error.
+  @retval EFI_SECURITY_VIOLATION          The variable could not be retrieved due to an authentication failure.
+  @retval EFI_UNSUPPORTED                 After ExitBootServices() has been called, this return code may be returned
+                                          if no variable storage is supported. The platform should describe this
+                                          runtime service as unsupported at runtime via an EFI_RT_PROPERTIES_TABLE
+                                          configuration table.
+
+**/
+EFI_STATUS
+EFIAPI
+VariableServiceSetVariable (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid,
+  IN UINT32    Attributes,
+  IN UINTN     DataSize,
+  IN VOID      *Data
+  )
+{
+  VARIABLE_POINTER_TRACK  Variable;
+  EFI_STATUS              Status;
+  VARIABLE_HEADER         *NextVariable;
+  EFI_PHYSICAL_ADDRESS    Point;
+  UINTN                   PayloadSize;
+  BOOLEAN                 AuthFormat;
+
+  AuthFormat = mVariableModuleGlobal->VariableGlobal.AuthFormat;
+
+  //
+  // Check input parameters.
+  //
+  Status = CheckSetVariableParameters (VariableName, VendorGuid, Attributes, DataSize, Data, &PayloadSize);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
   //
   // Special Handling for MOR Lock variable.
   //
@@ -3247,6 +3582,405 @@ ReclaimForOS (
   }
 }
 
+/**
+  Adds the size of a variable that a batch may write to the space of the
+  batch, in the limits of the variable storage that the variable counts in.
+
+  @param[in]      VariableName  Name of the variable.
+  @param[in]      VendorGuid    Variable vendor GUID.
+  @param[in]      Attributes    Attributes of the variable.
+  @param[in]      DataSize      Size of the data of the variable.
+  @param[in, out] Space         The space the batch may append.
+
+  @retval EFI_SUCCESS           The size of the variable is added.
+  @retval EFI_OUT_OF_RESOURCES  The space of the batch overflows.
+
+**/
+EFI_STATUS
+AddVariableBatchSpace (
+  IN     CHAR16                *VariableName,
+  IN     EFI_GUID              *VendorGuid,
+  IN     UINT32                Attributes,
+  IN     UINTN                 DataSize,
+  IN OUT VARIABLE_BATCH_SPACE  *Space
+  )
+{
+  UINTN                        VariableSize;
+  VAR_CHECK_VARIABLE_PROPERTY  Property;
+
+  //
+  // The data size is bounded by the maximum variable size, so that the
+  // variable size does not overflow.
+  //
+  VariableSize = HEADER_ALIGN (
+                   GetVariableHeaderSize (mVariableModuleGlobal->VariableGlobal.AuthFormat)
+                   + StrSize (VariableName) + GET_PAD_SIZE (StrSize (VariableName))
+                   + DataSize + GET_PAD_SIZE (DataSize)
+                   );
+
+  if ((Attributes & EFI_VARIABLE_NON_VOLATILE) == 0) {
+    return SafeUintnAdd (Space->VolatileSize, VariableSize, &Space->VolatileSize);
+  }
+
+  if (EFI_ERROR (SafeUintnAdd (Space->NvSize, VariableSize, &Space->NvSize))) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if ((Attributes & EFI_VARIABLE_HARDWARE_ERROR_RECORD) != 0) {
+    return SafeUintnAdd (Space->HwErrSize, VariableSize, &Space->HwErrSize);
+  }
+
+  if (EFI_ERROR (SafeUintnAdd (Space->CommonSize, VariableSize, &Space->CommonSize))) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Same as IsUserVariable(), for a variable that is not written yet.
+  //
+  if (mEndOfDxe && (mVariableModuleGlobal->CommonMaxUserVariableSpace != mVariableModuleGlobal->CommonVariableSpace) &&
+      (VarCheckLibVariablePropertyGet (VariableName, VendorGuid, &Property) == EFI_NOT_FOUND))
+  {
+    return SafeUintnAdd (Space->CommonUserSize, VariableSize, &Space->CommonUserSize);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Checks a variable update of a batch with the checks of SetVariable() that do
+  not write the variable storage, and adds the space the update and its undo
+  may append to the variable storage.
+
+  The updates that also update other variables or state could not be undone
+  if a later update of the batch fails, so they are refused:
+  - authenticated variables, whose update is verified against a time stamp or
+    a certificate database that the update also changes, and may change the
+    secure boot mode variables;
+  - the MOR variables, whose lock is a one-way state machine;
+  - the language variables, which update each other and the language codes
+    cached by the driver.
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode, and datasize and data are external input.
+
+  @param[in]      VariableName  Name of the variable.
+  @param[in]      VendorGuid    Variable vendor GUID.
+  @param[in]      Attributes    Attributes of the variable.
+  @param[in]      DataSize      Size of Data, 0 deletes the variable.
+  @param[in]      Data          Data of the variable.
+  @param[in, out] Space         The space the batch may append, updated with
+                                the space of this update and its undo.
+
+  @retval EFI_SUCCESS           The update passes the checks of SetVariable().
+  @retval EFI_UNSUPPORTED       The variable cannot be updated by a batch.
+  @retval EFI_OUT_OF_RESOURCES  The space of the batch overflows.
+  @retval Others                The status SetVariable() returns for the update.
+
+**/
+EFI_STATUS
+CheckVariableBatchUpdate (
+  IN     CHAR16                *VariableName,
+  IN     EFI_GUID              *VendorGuid,
+  IN     UINT32                Attributes,
+  IN     UINTN                 DataSize,
+  IN     VOID                  *Data,
+  IN OUT VARIABLE_BATCH_SPACE  *Space
+  )
+{
+  EFI_STATUS              Status;
+  VARIABLE_POINTER_TRACK  Variable;
+  UINTN                   PayloadSize;
+  UINTN                   AppendSize;
+  BOOLEAN                 Exists;
+  UINT32                  OldAttributes;
+  UINTN                   OldDataSize;
+
+  Status = CheckSetVariableParameters (VariableName, VendorGuid, Attributes, DataSize, Data, &PayloadSize);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (((Attributes & VARIABLE_ATTRIBUTE_AT_AW) != 0) ||
+      CompareGuid (VendorGuid, &gEfiMemoryOverwriteControlDataGuid) ||
+      CompareGuid (VendorGuid, &gEfiMemoryOverwriteRequestControlLockGuid))
+  {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (!FeaturePcdGet (PcdUefiVariableDefaultLangDeprecate) &&
+      ((StrCmp (VariableName, EFI_PLATFORM_LANG_CODES_VARIABLE_NAME) == 0) ||
+       (StrCmp (VariableName, EFI_LANG_CODES_VARIABLE_NAME) == 0) ||
+       (StrCmp (VariableName, EFI_PLATFORM_LANG_VARIABLE_NAME) == 0) ||
+       (StrCmp (VariableName, EFI_LANG_VARIABLE_NAME) == 0)))
+  {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = VarCheckLibSetVariableCheck (VariableName, VendorGuid, Attributes, PayloadSize, Data, mRequestSource);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  AcquireLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+
+  Exists        = FALSE;
+  OldAttributes = 0;
+  OldDataSize   = 0;
+  AppendSize    = 0;
+  Status        = FindVariable (VariableName, VendorGuid, &Variable, &mVariableModuleGlobal->VariableGlobal, TRUE);
+  if (!EFI_ERROR (Status)) {
+    Exists        = TRUE;
+    OldAttributes = Variable.CurrPtr->Attributes;
+    OldDataSize   = DataSizeOfVariable (Variable.CurrPtr, mVariableModuleGlobal->VariableGlobal.AuthFormat);
+    if ((OldAttributes & VARIABLE_ATTRIBUTE_AT_AW) != 0) {
+      Status = EFI_UNSUPPORTED;
+    } else if (((OldAttributes & EFI_VARIABLE_RUNTIME_ACCESS) == 0) && AtRuntime ()) {
+      Status = EFI_WRITE_PROTECTED;
+    } else if ((Attributes != 0) && ((Attributes & (~EFI_VARIABLE_APPEND_WRITE)) != OldAttributes)) {
+      Status = EFI_INVALID_PARAMETER;
+    } else if ((Attributes & EFI_VARIABLE_APPEND_WRITE) != 0) {
+      AppendSize = OldDataSize;
+    }
+  }
+
+  ReleaseLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+
+  if (Status == EFI_NOT_FOUND) {
+    Status = EFI_SUCCESS;
+  }
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // The update writes the new variable, and its undo writes the old one back.
+  // The sizes are bounded by the maximum variable size, so that they do not
+  // overflow.
+  //
+  if ((DataSize != 0) && (Attributes != 0)) {
+    Status = AddVariableBatchSpace (VariableName, VendorGuid, Attributes & ~EFI_VARIABLE_APPEND_WRITE, AppendSize + DataSize, Space);
+    if (EFI_ERROR (Status)) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  if (Exists) {
+    Status = AddVariableBatchSpace (VariableName, VendorGuid, OldAttributes, OldDataSize, Space);
+    if (EFI_ERROR (Status)) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Checks that the variable storage can hold the space of a batch.
+
+  @param[in] Space              The space the batch may append.
+
+  @retval TRUE                  The non-volatile variable storage and its
+                                limits can hold the space of the batch.
+  @retval FALSE                 They cannot.
+
+**/
+BOOLEAN
+IsVariableBatchNvSpaceAvailable (
+  IN VARIABLE_BATCH_SPACE  *Space
+  )
+{
+  if (Space->NvSize > mNvVariableCache->Size - mVariableModuleGlobal->NonVolatileLastVariableOffset) {
+    return FALSE;
+  }
+
+  if ((Space->HwErrSize > PcdGet32 (PcdHwErrStorageSize)) ||
+      (Space->HwErrSize > PcdGet32 (PcdHwErrStorageSize) - mVariableModuleGlobal->HwErrVariableTotalSize))
+  {
+    return FALSE;
+  }
+
+  if ((Space->CommonSize > mVariableModuleGlobal->CommonVariableSpace) ||
+      (Space->CommonSize > mVariableModuleGlobal->CommonVariableSpace - mVariableModuleGlobal->CommonVariableTotalSize))
+  {
+    return FALSE;
+  }
+
+  if (AtRuntime () &&
+      ((Space->CommonSize > mVariableModuleGlobal->CommonRuntimeVariableSpace) ||
+       (Space->CommonSize > mVariableModuleGlobal->CommonRuntimeVariableSpace - mVariableModuleGlobal->CommonVariableTotalSize)))
+  {
+    return FALSE;
+  }
+
+  if ((Space->CommonUserSize > mVariableModuleGlobal->CommonMaxUserVariableSpace) ||
+      (Space->CommonUserSize > mVariableModuleGlobal->CommonMaxUserVariableSpace - mVariableModuleGlobal->CommonUserVariableTotalSize))
+  {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  This function reserves the variable storage space of a batch of variable
+  updates and their undo, reclaiming the storage ahead of the batch if its
+  free area or its limits cannot hold them, so that neither the batch nor its
+  undo runs out of space or reclaims the storage.
+
+  Caution: This function may be invoked at SMM mode.
+  Care must be taken to make sure not security issue.
+
+  @param[in] Space              The space the batch may append.
+
+  @retval EFI_SUCCESS           The variable storage can hold the batch.
+  @retval EFI_OUT_OF_RESOURCES  The variable storage cannot hold the batch,
+                                even after a reclaim.
+
+**/
+EFI_STATUS
+ReserveVariableBatchSpace (
+  IN VARIABLE_BATCH_SPACE  *Space
+  )
+{
+  EFI_STATUS             Status;
+  VARIABLE_STORE_HEADER  *VolatileStore;
+
+  VolatileStore = (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.VolatileVariableBase;
+  if (Space->VolatileSize > VolatileStore->Size - mVariableModuleGlobal->VolatileLastVariableOffset) {
+    Status = Reclaim (
+               mVariableModuleGlobal->VariableGlobal.VolatileVariableBase,
+               &mVariableModuleGlobal->VolatileLastVariableOffset,
+               TRUE,
+               NULL,
+               NULL,
+               0
+               );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Variable: reclaim for variable batch - %r\n", Status));
+      return Status;
+    }
+
+    if (Space->VolatileSize > VolatileStore->Size - mVariableModuleGlobal->VolatileLastVariableOffset) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  if (IsVariableBatchNvSpaceAvailable (Space)) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // The storage is not reclaimed at runtime, and cannot be reclaimed before
+  // the FVB protocol is ready.
+  //
+  if (AtRuntime () ||
+      ((mVariableModuleGlobal->FvbInstance == NULL) && !mVariableModuleGlobal->VariableGlobal.EmuNvMode))
+  {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = Reclaim (
+             mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase,
+             &mVariableModuleGlobal->NonVolatileLastVariableOffset,
+             FALSE,
+             NULL,
+             NULL,
+             0
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Variable: reclaim for variable batch - %r\n", Status));
+    return Status;
+  }
+
+  if (!IsVariableBatchNvSpaceAvailable (Space)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Saves the current value of a variable, so that a batch update of the
+  variable can be undone.
+
+  @param[in]  VariableName      Name of the variable.
+  @param[in]  VendorGuid        Variable vendor GUID.
+  @param[out] Undo              The saved value of the variable.
+
+  @retval EFI_SUCCESS           The value of the variable is saved.
+  @retval EFI_OUT_OF_RESOURCES  The data of the variable could not be copied.
+
+**/
+EFI_STATUS
+SaveVariableBatchUndo (
+  IN  CHAR16               *VariableName,
+  IN  EFI_GUID             *VendorGuid,
+  OUT VARIABLE_BATCH_UNDO  *Undo
+  )
+{
+  EFI_STATUS              Status;
+  VARIABLE_POINTER_TRACK  Variable;
+  BOOLEAN                 AuthFormat;
+
+  AuthFormat = mVariableModuleGlobal->VariableGlobal.AuthFormat;
+  ZeroMem (Undo, sizeof (VARIABLE_BATCH_UNDO));
+
+  AcquireLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+
+  Status = FindVariable (VariableName, VendorGuid, &Variable, &mVariableModuleGlobal->VariableGlobal, TRUE);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_SUCCESS;
+  } else {
+    Undo->Exists     = TRUE;
+    Undo->Attributes = Variable.CurrPtr->Attributes;
+    Undo->DataSize   = DataSizeOfVariable (Variable.CurrPtr, AuthFormat);
+    Undo->Data       = AllocateCopyPool (Undo->DataSize, GetVariableDataPtr (Variable.CurrPtr, AuthFormat));
+    if (Undo->Data == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  ReleaseLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+  return Status;
+}
+
+/**
+  Restores the value of a variable saved by SaveVariableBatchUndo().
+
+  @param[in] VariableName      Name of the variable.
+  @param[in] VendorGuid        Variable vendor GUID.
+  @param[in] Undo              The saved value of the variable.
+
+  @retval EFI_SUCCESS           The variable is restored.
+  @retval Others                The variable could not be written.
+
+**/
+EFI_STATUS
+RestoreVariableBatchUndo (
+  IN CHAR16               *VariableName,
+  IN EFI_GUID             *VendorGuid,
+  IN VARIABLE_BATCH_UNDO  *Undo
+  )
+{
+  EFI_STATUS              Status;
+  VARIABLE_POINTER_TRACK  Variable;
+
+  AcquireLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+
+  Status = FindVariable (VariableName, VendorGuid, &Variable, &mVariableModuleGlobal->VariableGlobal, TRUE);
+  if (Undo->Exists) {
+    Status = UpdateVariable (VariableName, VendorGuid, Undo->Data, Undo->DataSize, Undo->Attributes, 0, 0, &Variable, NULL);
+  } else if (!EFI_ERROR (Status)) {
+    Status = UpdateVariable (VariableName, VendorGuid, NULL, 0, 0, 0, 0, &Variable, NULL);
+  } else {
+    Status = EFI_SUCCESS;
+  }
+
+  ReleaseLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+  return Status;
+}
+
 /**
   Get maximum variable size, covering both non-volatile and volatile variables.
 
@@ -3423,6 +4157,10 @@ VariableWriteServiceInitialize (
 
   AcquireLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
 
+  if (FeaturePcdGet (PcdVariableReclaimDirtyBlocks) && !mVariableModuleGlobal->VariableGlobal.EmuNvMode) {
+    InitializeVariableStoreBlocks (mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase);
+  }
+
   //
   // Check if the free area is really free.
   //
@@ -3796,6 +4534,21 @@ VariableCommonInitialize (
   VolatileVariableStore->Reserved  = 0;
   VolatileVariableStore->Reserved1 = 0;
 
+  //
+  // Allocate the hash indexes of the variable stores. A store whose index
+  // could not be allocated is searched header by header.
+  //
+  if (FeaturePcdGet (PcdVariableStoreIndex)) {
+    InitializeVariableStoreIndex (&mVariableStoreIndex[VariableStoreTypeVolatile], VolatileVariableStore->Size);
+    InitializeVariableStoreIndex (&mVariableStoreIndex[VariableStoreTypeNv], mNvVariableCache->Size);
+    if (mVariableModuleGlobal->VariableGlobal.HobVariableBase != 0) {
+      InitializeVariableStoreIndex (
+        &mVariableStoreIndex[VariableStoreTypeHob],
+        ((VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.HobVariableBase)->Size
+        );
+    }
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -17,6 +17,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/Variable.h>
 #include <Protocol/VariableLock.h>
 #include <Protocol/VarCheck.h>
+#include <Protocol/VariableEnumeration.h>
 #include <Library/PcdLib.h>
 #include <Library/HobLib.h>
 #include <Library/UefiDriverEntryPoint.h>
@@ -61,16 +62,43 @@ typedef enum {
   VariableStoreTypeMax
 } VARIABLE_STORE_TYPE;
 
+///
+/// Maximum number of byte ranges waiting to be copied to a runtime cache. A
+/// range added to a full journal is merged with the closest pending range.
+///
+#define VARIABLE_RUNTIME_CACHE_MAX_PENDING_UPDATES  8
+
+typedef struct {
+  UINT32    Offset;
+  UINT32    Length;
+} VARIABLE_RUNTIME_CACHE_UPDATE;
+
+///
+/// Statistics of a runtime cache, collected if PcdVariableCollectStatistics is TRUE.
+///
 typedef struct {
-  UINT32                   PendingUpdateOffset;
-  UINT32                   PendingUpdateLength;
-  VARIABLE_STORE_HEADER    *Store;
+  UINT32    FlushCount;                                 // Flushes of the pending updates.
+  UINT32    RangeCount;                                 // Byte ranges copied.
+  UINT32    StoreCopyCount;                             // Byte ranges that covered the whole store.
+  UINT64    CopiedBytes;                                // Bytes copied.
+} VARIABLE_RUNTIME_CACHE_STATISTICS;
+
+typedef struct {
+  ///
+  /// Journal of the byte ranges of the store that differ from the runtime
+  /// cache, the ranges do not overlap.
+  ///
+  UINT32                               PendingUpdateCount;
+  VARIABLE_RUNTIME_CACHE_UPDATE        PendingUpdates[VARIABLE_RUNTIME_CACHE_MAX_PENDING_UPDATES];
+  VARIABLE_STORE_HEADER                *Store;
+  VARIABLE_RUNTIME_CACHE_STATISTICS    Statistics;
 } VARIABLE_RUNTIME_CACHE;
 
 typedef struct {
   BOOLEAN                   *ReadLock;
   BOOLEAN                   *PendingUpdate;
   BOOLEAN                   *HobFlushComplete;
+  UINT32                    *StoreRewriteCount;         // NULL if the runtime caches are not indexed.
   VARIABLE_RUNTIME_CACHE    VariableRuntimeHobCache;
   VARIABLE_RUNTIME_CACHE    VariableRuntimeNvCache;
   VARIABLE_RUNTIME_CACHE    VariableRuntimeVolatileCache;
@@ -121,8 +149,38 @@ typedef struct {
   CHAR8                                 *PlatformLang;
   CHAR8                                 Lang[ISO_639_2_ENTRY_SIZE + 1];
   EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL    *FvbInstance;
+  ///
+  /// Size and number of the flash blocks of the non-volatile variable store,
+  /// and number of times each block was written by a reclaim.
+  ///
+  UINTN                                 NvBlockSize;
+  UINTN                                 NvBlockCount;
+  UINT32                                *NvBlockEraseCount;
 } VARIABLE_MODULE_GLOBAL;
 
+///
+/// The value of a variable before an update of a batch, used to undo the
+/// update if a later update of the batch fails.
+///
+typedef struct {
+  BOOLEAN    Exists;
+  UINT32     Attributes;
+  UINTN      DataSize;
+  VOID       *Data;
+} VARIABLE_BATCH_UNDO;
+
+///
+/// The variable storage space that a batch of variable updates and their undo
+/// may append, per limit of the variable storage.
+///
+typedef struct {
+  UINTN    NvSize;
+  UINTN    CommonSize;
+  UINTN    CommonUserSize;
+  UINTN    HwErrSize;
+  UINTN    VolatileSize;
+} VARIABLE_BATCH_SPACE;
+
 /**
   Flush the HOB variable to flash.
 
@@ -157,6 +215,21 @@ FtwVariableSpace (
   IN VARIABLE_STORE_HEADER  *VariableBuffer
   );
 
+/**
+  Gets the block size of the non-volatile variable store in flash and
+  allocates the erase counters of its blocks.
+
+  The counters are kept in memory for the current boot, they are only updated
+  when PcdVariableReclaimDirtyBlocks is TRUE.
+
+  @param  VariableBase   Base address of the variable store in flash.
+
+**/
+VOID
+InitializeVariableStoreBlocks (
+  IN EFI_PHYSICAL_ADDRESS  VariableBase
+  );
+
 /**
   Finds variable in storage blocks of volatile and non-volatile storage areas.
 
@@ -377,6 +450,89 @@ ReclaimForOS (
   VOID
   );
 
+/**
+  Checks a variable update of a batch with the checks of SetVariable() that do
+  not write the variable storage, and adds the space the update and its undo
+  may append to the variable storage.
+
+  @param[in]      VariableName  Name of the variable.
+  @param[in]      VendorGuid    Variable vendor GUID.
+  @param[in]      Attributes    Attributes of the variable.
+  @param[in]      DataSize      Size of Data, 0 deletes the variable.
+  @param[in]      Data          Data of the variable.
+  @param[in, out] Space         The space the batch may append, updated with
+                                the space of this update and its undo.
+
+  @retval EFI_SUCCESS           The update passes the checks of SetVariable().
+  @retval EFI_UNSUPPORTED       The variable cannot be updated by a batch.
+  @retval EFI_OUT_OF_RESOURCES  The space of the batch overflows.
+  @retval Others                The status SetVariable() returns for the update.
+
+**/
+EFI_STATUS
+CheckVariableBatchUpdate (
+  IN     CHAR16                *VariableName,
+  IN     EFI_GUID              *VendorGuid,
+  IN     UINT32                Attributes,
+  IN     UINTN                 DataSize,
+  IN     VOID                  *Data,
+  IN OUT VARIABLE_BATCH_SPACE  *Space
+  );
+
+/**
+  This function reserves the variable storage space of a batch of variable
+  updates and their undo, reclaiming the storage ahead of the batch if its
+  free area or its limits cannot hold them.
+
+  @param[in] Space              The space the batch may append.
+
+  @retval EFI_SUCCESS           The variable storage can hold the batch.
+  @retval EFI_OUT_OF_RESOURCES  The variable storage cannot hold the batch,
+                                even after a reclaim.
+
+**/
+EFI_STATUS
+ReserveVariableBatchSpace (
+  IN VARIABLE_BATCH_SPACE  *Space
+  );
+
+/**
+  Saves the current value of a variable, so that a batch update of the
+  variable can be undone.
+
+  @param[in]  VariableName      Name of the variable.
+  @param[in]  VendorGuid        Variable vendor GUID.
+  @param[out] Undo              The saved value of the variable.
+
+  @retval EFI_SUCCESS           The value of the variable is saved.
+  @retval EFI_OUT_OF_RESOURCES  The data of the variable could not be copied.
+
+**/
+EFI_STATUS
+SaveVariableBatchUndo (
+  IN  CHAR16               *VariableName,
+  IN  EFI_GUID             *VendorGuid,
+  OUT VARIABLE_BATCH_UNDO  *Undo
+  );
+
+/**
+  Restores the value of a variable saved by SaveVariableBatchUndo().
+
+  @param[in] VariableName      Name of the variable.
+  @param[in] VendorGuid        Variable vendor GUID.
+  @param[in] Undo              The saved value of the variable.
+
+  @retval EFI_SUCCESS           The variable is restored.
+  @retval Others                The variable could not be written.
+
+**/
+EFI_STATUS
+RestoreVariableBatchUndo (
+  IN CHAR16               *VariableName,
+  IN EFI_GUID             *VendorGuid,
+  IN VARIABLE_BATCH_UNDO  *Undo
+  );
+
 /**
   Get maximum variable size, covering both non-volatile and volatile variables.
 
@@ -509,6 +665,71 @@ VariableServiceGetNextVariableName (
   IN OUT  EFI_GUID  *VendorGuid
   );
 
+/**
+  Return the name and GUID of the variable at an enumeration cursor, and
+  advance the cursor to the next variable.
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode. This function will do basic validation, before parse the data.
+
+  @param[in, out] Cursor            On input, EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor
+                                    returned by the variable driver. On output, the cursor of the
+                                    next variable if EFI_SUCCESS is returned.
+  @param[in, out] VariableNameSize  On input, the size of the VariableName buffer. On output, the
+                                    size of the name of the variable.
+  @param[out]     VariableName      Returns the Null-terminated name of the variable.
+  @param[out]     VendorGuid        Returns the vendor GUID of the variable.
+  @param[out]     Attributes        Returns the attributes of the variable. Optional.
+
+  @retval EFI_SUCCESS               The variable was returned and Cursor was advanced.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_BUFFER_TOO_SMALL      VariableNameSize is too small for the name. VariableNameSize
+                                    has been updated with the size needed, Cursor is unchanged.
+  @retval EFI_INVALID_PARAMETER     Cursor, VariableNameSize, VariableName or VendorGuid is NULL.
+                                    Or Cursor is not a cursor of the current variable stores.
+
+**/
+EFI_STATUS
+EFIAPI
+VariableServiceGetNextVariableNameByCursor (
+  IN OUT UINT64    *Cursor,
+  IN OUT UINTN     *VariableNameSize,
+  OUT    CHAR16    *VariableName,
+  OUT    EFI_GUID  *VendorGuid,
+  OUT    UINT32    *Attributes OPTIONAL
+  );
+
+/**
+  Return packed EDKII_VARIABLE_ENUMERATION_RECORD records of the variables from
+  an enumeration cursor, as many as Buffer holds, and advance the cursor past
+  them.
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode. This function will do basic validation, before parse the data.
+
+  @param[in, out] Cursor            On input, EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor
+                                    returned by the variable driver. On output, the cursor of the
+                                    variable following the last record if EFI_SUCCESS is returned.
+  @param[in, out] BufferSize        On input, the size of Buffer. On output, the size of the records
+                                    returned, or the size of the first record if EFI_BUFFER_TOO_SMALL
+                                    is returned.
+  @param[out]     Buffer            Returns the records.
+
+  @retval EFI_SUCCESS               At least one record was returned and Cursor was advanced.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_BUFFER_TOO_SMALL      Buffer cannot hold the first record. Cursor is unchanged.
+  @retval EFI_INVALID_PARAMETER     Cursor, BufferSize or Buffer is NULL.
+                                    Or Cursor is not a cursor of the current variable stores.
+
+**/
+EFI_STATUS
+EFIAPI
+VariableServiceGetVariableRecords (
+  IN OUT UINT64  *Cursor,
+  IN OUT UINTN   *BufferSize,
+  OUT    VOID    *Buffer
+  );
+
 /**
 
   This code sets variable in storage blocks (Volatile or Non-Volatile).
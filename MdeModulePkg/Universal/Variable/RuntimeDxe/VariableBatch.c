@@ -0,0 +1,243 @@
+/** @file
+  Batch updates of variables, requested with a single SMM communication.
+
+  All the records of a batch are checked, and the variable storage space of
+  the records and of their undo is reserved, before the first record is
+  applied. If a record still fails when it is applied, it and the records
+  applied before it are undone, last one first. Each record and each undo is a
+  separate write of the variable storage, so the rollback is best effort and
+  is not reset-safe.
+
+  Caution: This module requires additional review when modified.
+  This driver will have external input - variable data. They may be input in SMM mode.
+  This external input must be validated carefully to avoid security issue like
+  buffer overflow, integer overflow.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "VariableBatch.h"
+
+/**
+  Apply the records of a SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH request.
+
+  All the records are checked, and the space they and their undo may append
+  to the variable storage is reserved, before the first one is applied. If a
+  record fails when it is applied, it and the records applied before it are
+  undone, last one first. The rollback stops at the first undo that fails, so
+  that the records that may remain applied are always the first AppliedCount
+  records.
+
+  Caution: This function may receive untrusted input.
+  The records are external input, so all of them are validated before the
+  first one is applied.
+
+  @param[in, out] VariableBatch  The batch header, followed by the records.
+                                 FailedIndex returns the index of the record
+                                 that failed, and AppliedCount the number of
+                                 the first records that may remain applied.
+  @param[in]      BatchSize      Size of the batch header and the records.
+
+  @retval EFI_SUCCESS            All the records were applied.
+  @retval EFI_ACCESS_DENIED      The records do not fit in BatchSize or a
+                                 variable name is not Null-terminated.
+  @retval EFI_INVALID_PARAMETER  Two records update the same variable.
+  @retval EFI_OUT_OF_RESOURCES   The variable storage cannot hold the records.
+  @retval Others                 The status of the record that failed.
+
+**/
+EFI_STATUS
+SmmSetVariableBatch (
+  IN OUT SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH  *VariableBatch,
+  IN     UINTN                                        BatchSize
+  )
+{
+  EFI_STATUS                                Status;
+  EFI_STATUS                                UndoStatus;
+  SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE  *SmmVariableHeader;
+  SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE  **Records;
+  VARIABLE_BATCH_UNDO                       *Undo;
+  VARIABLE_BATCH_SPACE                      Space;
+  UINTN                                     Index;
+  UINTN                                     Previous;
+  UINTN                                     Offset;
+  UINTN                                     InfoSize;
+
+  VariableBatch->FailedIndex  = VariableBatch->EntryCount;
+  VariableBatch->AppliedCount = 0;
+  if (VariableBatch->EntryCount == 0) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Each record holds at least its header, so that the size of the arrays
+  // does not overflow.
+  //
+  if (VariableBatch->EntryCount > BatchSize / OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name)) {
+    DEBUG ((DEBUG_ERROR, "SetVariableBatch: SMM communication buffer size invalid!\n"));
+    return EFI_ACCESS_DENIED;
+  }
+
+  Records = AllocateZeroPool (VariableBatch->EntryCount * sizeof (*Records));
+  Undo    = AllocateZeroPool (VariableBatch->EntryCount * sizeof (*Undo));
+  if ((Records == NULL) || (Undo == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+
+  //
+  // Validate all the records, and total the space they and their undo may
+  // append to the variable storage
+  //
+  ZeroMem (&Space, sizeof (Space));
+  Offset = sizeof (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH);
+  for (Index = 0; Index < VariableBatch->EntryCount; Index++) {
+    VariableBatch->FailedIndex = Index;
+    if ((Offset > BatchSize) || (BatchSize - Offset < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name))) {
+      DEBUG ((DEBUG_ERROR, "SetVariableBatch: SMM communication buffer size invalid!\n"));
+      Status = EFI_ACCESS_DENIED;
+      goto Done;
+    }
+
+    SmmVariableHeader = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *)((UINT8 *)VariableBatch + Offset);
+    if (((UINTN)(~0) - SmmVariableHeader->DataSize < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name)) ||
+        ((UINTN)(~0) - SmmVariableHeader->NameSize < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + SmmVariableHeader->DataSize))
+    {
+      //
+      // Prevent InfoSize overflow happen
+      //
+      Status = EFI_ACCESS_DENIED;
+      goto Done;
+    }
+
+    InfoSize = OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name)
+               + SmmVariableHeader->DataSize + SmmVariableHeader->NameSize;
+    if (InfoSize > BatchSize - Offset) {
+      DEBUG ((DEBUG_ERROR, "SetVariableBatch: Data size exceed communication buffer size limit!\n"));
+      Status = EFI_ACCESS_DENIED;
+      goto Done;
+    }
+
+    //
+    // The VariableSpeculationBarrier() call here is to ensure the previous
+    // range/content checks for the CommBuffer have been completed before the
+    // subsequent consumption of the CommBuffer content.
+    //
+    VariableSpeculationBarrier ();
+    if ((SmmVariableHeader->NameSize < sizeof (CHAR16)) || (SmmVariableHeader->Name[SmmVariableHeader->NameSize/sizeof (CHAR16) - 1] != L'\0')) {
+      //
+      // Make sure VariableName is A Null-terminated string.
+      //
+      Status = EFI_ACCESS_DENIED;
+      goto Done;
+    }
+
+    //
+    // The undo of a record restores the value the variable had before the
+    // batch, so a variable is updated at most once by a batch.
+    //
+    for (Previous = 0; Previous < Index; Previous++) {
+      if (CompareGuid (&Records[Previous]->Guid, &SmmVariableHeader->Guid) &&
+          (StrCmp (Records[Previous]->Name, SmmVariableHeader->Name) == 0))
+      {
+        Status = EFI_INVALID_PARAMETER;
+        goto Done;
+      }
+    }
+
+    Status = CheckVariableBatchUpdate (
+               SmmVariableHeader->Name,
+               &SmmVariableHeader->Guid,
+               SmmVariableHeader->Attributes,
+               SmmVariableHeader->DataSize,
+               (UINT8 *)SmmVariableHeader->Name + SmmVariableHeader->NameSize,
+               &Space
+               );
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+
+    Records[Index] = SmmVariableHeader;
+    Offset        += SMM_VARIABLE_BATCH_RECORD_SIZE (SmmVariableHeader->NameSize, SmmVariableHeader->DataSize);
+  }
+
+  VariableBatch->FailedIndex = VariableBatch->EntryCount;
+
+  //
+  // Reserve the space of the records and their undo, reclaiming the storage
+  // at most once for the whole batch
+  //
+  Status = ReserveVariableBatchSpace (&Space);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  //
+  // Save the values to undo before the first record is applied, so that no
+  // allocation fails in the middle of the batch.
+  //
+  for (Index = 0; Index < VariableBatch->EntryCount; Index++) {
+    Status = SaveVariableBatchUndo (Records[Index]->Name, &Records[Index]->Guid, &Undo[Index]);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+  }
+
+  for (Index = 0; Index < VariableBatch->EntryCount; Index++) {
+    SmmVariableHeader = Records[Index];
+    Status            = VariableServiceSetVariable (
+                          SmmVariableHeader->Name,
+                          &SmmVariableHeader->Guid,
+                          SmmVariableHeader->Attributes,
+                          SmmVariableHeader->DataSize,
+                          (UINT8 *)SmmVariableHeader->Name + SmmVariableHeader->NameSize
+                          );
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  if (!EFI_ERROR (Status)) {
+    VariableBatch->AppliedCount = VariableBatch->EntryCount;
+    goto Done;
+  }
+
+  VariableBatch->FailedIndex = Index;
+
+  //
+  // Undo the record that failed, as a write that fails after the new variable
+  // is added still updates the variable, then the records applied before it,
+  // last one first. The rollback stops at the first undo that fails.
+  //
+  Index++;
+  while (Index > 0) {
+    UndoStatus = RestoreVariableBatchUndo (Records[Index - 1]->Name, &Records[Index - 1]->Guid, &Undo[Index - 1]);
+    if (EFI_ERROR (UndoStatus)) {
+      DEBUG ((DEBUG_ERROR, "SetVariableBatch: Failed to undo the update of %g:%s - %r\n", &Records[Index - 1]->Guid, Records[Index - 1]->Name, UndoStatus));
+      break;
+    }
+
+    Index--;
+  }
+
+  VariableBatch->AppliedCount = Index;
+
+Done:
+  if (Undo != NULL) {
+    for (Index = 0; Index < VariableBatch->EntryCount; Index++) {
+      if (Undo[Index].Data != NULL) {
+        FreePool (Undo[Index].Data);
+      }
+    }
+
+    FreePool (Undo);
+  }
+
+  if (Records != NULL) {
+    FreePool (Records);
+  }
+
+  return Status;
+}
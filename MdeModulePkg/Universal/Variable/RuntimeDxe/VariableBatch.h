@@ -0,0 +1,39 @@
+/** @file
+  The variable batch updates of the DXE_SMM and Standalone MM variable modules.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _VARIABLE_BATCH_H_
+#define _VARIABLE_BATCH_H_
+
+#include "Variable.h"
+
+#include <Guid/SmmVariableCommon.h>
+
+/**
+  Apply the records of a SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH request.
+
+  @param[in, out] VariableBatch  The batch header, followed by the records.
+                                 FailedIndex returns the index of the record
+                                 that failed, and AppliedCount the number of
+                                 the first records that may remain applied.
+  @param[in]      BatchSize      Size of the batch header and the records.
+
+  @retval EFI_SUCCESS            All the records were applied.
+  @retval EFI_ACCESS_DENIED      The records do not fit in BatchSize or a
+                                 variable name is not Null-terminated.
+  @retval EFI_INVALID_PARAMETER  Two records update the same variable.
+  @retval EFI_OUT_OF_RESOURCES   The variable storage cannot hold the records.
+  @retval Others                 The status of the record that failed.
+
+**/
+EFI_STATUS
+SmmSetVariableBatch (
+  IN OUT SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH  *VariableBatch,
+  IN     UINTN                                        BatchSize
+  );
+
+#endif
@@ -0,0 +1,346 @@
+/** @file
+  Enumeration cursors of the variable stores.
+
+  A cursor holds the store type and the offset of the next variable header, so
+  an enumeration resumes where it stopped instead of finding the previous
+  variable by its name. The cursor also holds the reclaim generation of the
+  stores, a reclaim moves the variables and invalidates every cursor.
+
+  Caution: This module requires additional review when modified.
+  This driver will have external input - variable data. They may be input in SMM mode.
+  This external input must be validated carefully to avoid security issue like
+  buffer overflow, integer overflow.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "VariableCursor.h"
+
+/**
+  Invalidate the cursors of the variable stores.
+
+  The cursors must be invalidated whenever variables of the stores are moved,
+  e.g. when a store is reclaimed.
+
+  @param[in, out] Context           The cursor context of the variable stores.
+
+**/
+VOID
+InvalidateVariableCursors (
+  IN OUT VARIABLE_CURSOR_CONTEXT  *Context
+  )
+{
+  Context->Generation++;
+  Context->Hint         = 0;
+  Context->LastVariable = 0;
+}
+
+/**
+  Find the first available variable from the position of an enumeration
+  cursor.
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode. A cursor other than the hint is checked to be on a
+  variable header of the store before the store is parsed from it.
+
+  @param[in]  Context               The cursor context of the variable stores.
+  @param[in]  Cursor                EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor returned
+                                    by this function.
+  @param[in]  VariableStoreList     A list of variable stores that should be used to get the variable.
+                                    The maximum number of entries is the max value of VARIABLE_STORE_TYPE.
+  @param[in]  AuthFormat            TRUE indicates authenticated variables are used.
+                                    FALSE indicates authenticated variables are not used.
+  @param[out] VariablePtr           Pointer to the header of the variable found.
+  @param[out] NextCursor            The cursor of the position following the variable found.
+
+  @retval EFI_SUCCESS               The variable was found.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_INVALID_PARAMETER     Cursor is not a cursor of the current variable stores.
+
+**/
+EFI_STATUS
+FindVariableByCursor (
+  IN  VARIABLE_CURSOR_CONTEXT  *Context,
+  IN  UINT64                   Cursor,
+  IN  VARIABLE_STORE_HEADER    **VariableStoreList,
+  IN  BOOLEAN                  AuthFormat,
+  OUT VARIABLE_HEADER          **VariablePtr,
+  OUT UINT64                   *NextCursor
+  )
+{
+  EFI_STATUS              Status;
+  UINTN                   StoreType;
+  UINT32                  Offset;
+  VARIABLE_HEADER         *Position;
+  VARIABLE_POINTER_TRACK  Variable;
+
+  ZeroMem (&Variable, sizeof (Variable));
+
+  if (Cursor == EDKII_VARIABLE_ENUMERATION_CURSOR_START) {
+    for (StoreType = 0; StoreType < VariableStoreTypeMax; StoreType++) {
+      if (VariableStoreList[StoreType] != NULL) {
+        break;
+      }
+    }
+
+    if (StoreType == VariableStoreTypeMax) {
+      return EFI_NOT_FOUND;
+    }
+
+    Variable.StartPtr = GetStartPointer (VariableStoreList[StoreType]);
+    Variable.EndPtr   = GetEndPointer (VariableStoreList[StoreType]);
+    Variable.CurrPtr  = Variable.StartPtr;
+  } else {
+    StoreType = VARIABLE_CURSOR_STORE_TYPE (Cursor);
+    Offset    = VARIABLE_CURSOR_OFFSET (Cursor);
+    if ((VARIABLE_CURSOR_GENERATION (Cursor) != Context->Generation) ||
+        (StoreType >= VariableStoreTypeMax))
+    {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    //
+    // The VariableSpeculationBarrier() call here is to ensure the above
+    // check of the store type has been completed before the store list is
+    // indexed with it.
+    //
+    VariableSpeculationBarrier ();
+    if (VariableStoreList[StoreType] == NULL) {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    Variable.StartPtr = GetStartPointer (VariableStoreList[StoreType]);
+    Variable.EndPtr   = GetEndPointer (VariableStoreList[StoreType]);
+    if ((Offset < (UINTN)Variable.StartPtr - (UINTN)VariableStoreList[StoreType]) ||
+        (Offset > (UINTN)Variable.EndPtr - (UINTN)VariableStoreList[StoreType]))
+    {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    Variable.CurrPtr = (VARIABLE_HEADER *)((UINTN)VariableStoreList[StoreType] + Offset);
+    if (Cursor != Context->Hint) {
+      //
+      // The cursor was not returned by the previous call, check that it is on
+      // a variable header so that no variable data is parsed as a header.
+      //
+      Position = Variable.StartPtr;
+      while (IsValidVariableHeader (Position, Variable.EndPtr) && (Position < Variable.CurrPtr)) {
+        Position = GetNextVariablePtr (Position, AuthFormat);
+      }
+
+      if (Position != Variable.CurrPtr) {
+        return EFI_INVALID_PARAMETER;
+      }
+    }
+  }
+
+  Status = VariableServiceFindNextVariable (&Variable, VariableStoreList, AuthFormat);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  for (StoreType = 0; StoreType < VariableStoreTypeMax; StoreType++) {
+    if ((VariableStoreList[StoreType] != NULL) && (Variable.StartPtr == GetStartPointer (VariableStoreList[StoreType]))) {
+      break;
+    }
+  }
+
+  ASSERT (StoreType < VariableStoreTypeMax);
+
+  *VariablePtr = Variable.CurrPtr;
+  *NextCursor  = VARIABLE_CURSOR (
+                   Context->Generation,
+                   StoreType,
+                   (UINTN)GetNextVariablePtr (Variable.CurrPtr, AuthFormat) - (UINTN)VariableStoreList[StoreType]
+                   );
+  return EFI_SUCCESS;
+}
+
+/**
+  Return packed EDKII_VARIABLE_ENUMERATION_RECORD records of the variables from
+  an enumeration cursor, as many as Buffer holds, and advance the cursor past
+  them.
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode. This function will do basic validation, before parse the data.
+
+  @param[in, out] Context           The cursor context of the variable stores.
+  @param[in, out] Cursor            On input, EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor
+                                    returned by the variable driver. On output, the cursor of the
+                                    variable following the last record if EFI_SUCCESS is returned.
+  @param[in]      VariableStoreList A list of variable stores that should be used to get the variables.
+                                    The maximum number of entries is the max value of VARIABLE_STORE_TYPE.
+  @param[in]      AuthFormat        TRUE indicates authenticated variables are used.
+                                    FALSE indicates authenticated variables are not used.
+  @param[in, out] BufferSize        On input, the size of Buffer. On output, the size of the records
+                                    returned, or the size of the first record if EFI_BUFFER_TOO_SMALL
+                                    is returned.
+  @param[out]     Buffer            Returns the records.
+
+  @retval EFI_SUCCESS               At least one record was returned and Cursor was advanced.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_BUFFER_TOO_SMALL      Buffer cannot hold the first record. Cursor is unchanged.
+  @retval EFI_INVALID_PARAMETER     Cursor is not a cursor of the current variable stores.
+
+**/
+EFI_STATUS
+GetVariableRecordsByCursor (
+  IN OUT VARIABLE_CURSOR_CONTEXT  *Context,
+  IN OUT UINT64                   *Cursor,
+  IN     VARIABLE_STORE_HEADER    **VariableStoreList,
+  IN     BOOLEAN                  AuthFormat,
+  IN OUT UINTN                    *BufferSize,
+  OUT    VOID                     *Buffer
+  )
+{
+  EFI_STATUS                         Status;
+  UINTN                              NameSize;
+  UINTN                              RecordSize;
+  UINTN                              UsedSize;
+  UINT64                             NextCursor;
+  VARIABLE_HEADER                    *VariablePtr;
+  EDKII_VARIABLE_ENUMERATION_RECORD  *Record;
+
+  UsedSize = 0;
+
+  while (TRUE) {
+    Status = FindVariableByCursor (Context, *Cursor, VariableStoreList, AuthFormat, &VariablePtr, &NextCursor);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    NameSize   = NameSizeOfVariable (VariablePtr, AuthFormat);
+    RecordSize = ALIGN_VALUE (sizeof (EDKII_VARIABLE_ENUMERATION_RECORD) + NameSize, sizeof (UINT64));
+    if (RecordSize > *BufferSize - UsedSize) {
+      if (UsedSize == 0) {
+        *BufferSize = RecordSize;
+        Status      = EFI_BUFFER_TOO_SMALL;
+      }
+
+      break;
+    }
+
+    Record             = (EDKII_VARIABLE_ENUMERATION_RECORD *)((UINT8 *)Buffer + UsedSize);
+    Record->RecordSize = (UINT32)RecordSize;
+    Record->Attributes = VariablePtr->Attributes;
+    Record->NameSize   = (UINT32)NameSize;
+    Record->DataSize   = (UINT32)DataSizeOfVariable (VariablePtr, AuthFormat);
+    CopyMem (&Record->VendorGuid, GetVendorGuidPtr (VariablePtr, AuthFormat), sizeof (EFI_GUID));
+    CopyMem (Record + 1, GetVariableNamePtr (VariablePtr, AuthFormat), NameSize);
+    ZeroMem ((UINT8 *)(Record + 1) + NameSize, RecordSize - sizeof (EDKII_VARIABLE_ENUMERATION_RECORD) - NameSize);
+
+    UsedSize     += RecordSize;
+    *Cursor       = NextCursor;
+    Context->Hint = NextCursor;
+  }
+
+  if (UsedSize != 0) {
+    *BufferSize = UsedSize;
+    Status      = EFI_SUCCESS;
+  }
+
+  return Status;
+}
+
+/**
+  This code finds the next available variable as
+  VariableServiceGetNextVariableInternal() does, and remembers it in the
+  cursor context.
+
+  When VariableName and VendorGuid name the variable returned by the previous
+  call, the search resumes after it instead of finding it by its name, so an
+  enumeration of n variables parses O(n) variable headers instead of O(n^2).
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode. Only the variable returned by the previous call is
+  parsed without a lookup, after its state, name and GUID are checked.
+
+  @param[in, out] Context           The cursor context of the variable stores.
+  @param[in]      VariableName      Pointer to variable name.
+  @param[in]      VendorGuid        Variable Vendor Guid.
+  @param[in]      VariableStoreList A list of variable stores that should be used to get the next variable.
+                                    The maximum number of entries is the max value of VARIABLE_STORE_TYPE.
+  @param[out]     VariablePtr       Pointer to variable header address.
+  @param[in]      AuthFormat        TRUE indicates authenticated variables are used.
+                                    FALSE indicates authenticated variables are not used.
+
+  @retval EFI_SUCCESS               The function completed successfully.
+  @retval EFI_NOT_FOUND             The next variable was not found.
+  @retval EFI_INVALID_PARAMETER     If VariableName is not an empty string, while VendorGuid is NULL.
+  @retval EFI_INVALID_PARAMETER     The input values of VariableName and VendorGuid are not a name and
+                                    GUID of an existing variable.
+
+**/
+EFI_STATUS
+GetNextVariableByHint (
+  IN OUT VARIABLE_CURSOR_CONTEXT  *Context,
+  IN     CHAR16                   *VariableName,
+  IN     EFI_GUID                 *VendorGuid,
+  IN     VARIABLE_STORE_HEADER    **VariableStoreList,
+  OUT    VARIABLE_HEADER          **VariablePtr,
+  IN     BOOLEAN                  AuthFormat
+  )
+{
+  EFI_STATUS              Status;
+  UINTN                   StoreType;
+  VARIABLE_HEADER         *Previous;
+  VARIABLE_POINTER_TRACK  Variable;
+
+  Previous = NULL;
+  if ((VariableName[0] != 0) && (Context->LastVariable != 0) &&
+      (VARIABLE_CURSOR_GENERATION (Context->LastVariable) == Context->Generation))
+  {
+    //
+    // The last variable is known to be on a variable header of its store, as
+    // no reclaim moved the variables since it was returned.
+    //
+    StoreType = VARIABLE_CURSOR_STORE_TYPE (Context->LastVariable);
+    if (VariableStoreList[StoreType] != NULL) {
+      Previous = (VARIABLE_HEADER *)((UINTN)VariableStoreList[StoreType] + VARIABLE_CURSOR_OFFSET (Context->LastVariable));
+      if ((Previous->State != VAR_ADDED) ||
+          (AtRuntime () && ((Previous->Attributes & EFI_VARIABLE_RUNTIME_ACCESS) == 0)) ||
+          (VendorGuid == NULL) ||
+          !CompareGuid (VendorGuid, GetVendorGuidPtr (Previous, AuthFormat)) ||
+          (StrSize (VariableName) != NameSizeOfVariable (Previous, AuthFormat)) ||
+          (CompareMem (VariableName, GetVariableNamePtr (Previous, AuthFormat), StrSize (VariableName)) != 0))
+      {
+        Previous = NULL;
+      }
+    }
+  }
+
+  if (Previous != NULL) {
+    Variable.StartPtr = GetStartPointer (VariableStoreList[StoreType]);
+    Variable.EndPtr   = GetEndPointer (VariableStoreList[StoreType]);
+    Variable.CurrPtr  = GetNextVariablePtr (Previous, AuthFormat);
+    Status            = VariableServiceFindNextVariable (&Variable, VariableStoreList, AuthFormat);
+    if (!EFI_ERROR (Status)) {
+      *VariablePtr = Variable.CurrPtr;
+    }
+  } else {
+    Status = VariableServiceGetNextVariableInternal (VariableName, VendorGuid, VariableStoreList, VariablePtr, AuthFormat);
+  }
+
+  Context->LastVariable = 0;
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  for (StoreType = 0; StoreType < VariableStoreTypeMax; StoreType++) {
+    if ((VariableStoreList[StoreType] != NULL) &&
+        ((UINTN)*VariablePtr >= (UINTN)GetStartPointer (VariableStoreList[StoreType])) &&
+        ((UINTN)*VariablePtr < (UINTN)GetEndPointer (VariableStoreList[StoreType])))
+    {
+      Context->LastVariable = VARIABLE_CURSOR (
+                                Context->Generation,
+                                StoreType,
+                                (UINTN)*VariablePtr - (UINTN)VariableStoreList[StoreType]
+                                );
+      break;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,167 @@
+/** @file
+  The enumeration cursors of variable stores shared by the DXE_RUNTIME variable
+  module and the DXE_SMM variable module.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _VARIABLE_CURSOR_H_
+#define _VARIABLE_CURSOR_H_
+
+#include "VariableParsing.h"
+
+///
+/// Encoding of the cursors of the Variable Enumeration Protocol: the reclaim
+/// generation of the stores in bits 48..63, the store type plus one in bits
+/// 32..47 and the offset of a variable header from the start of the store in
+/// bits 0..31.
+///
+#define VARIABLE_CURSOR(Generation, StoreType, Offset) \
+  (LShiftU64 ((UINT16)(Generation), 48) | LShiftU64 ((UINT64)(StoreType) + 1, 32) | (UINT32)(Offset))
+#define VARIABLE_CURSOR_GENERATION(Cursor)  ((UINT16)RShiftU64 ((Cursor), 48))
+#define VARIABLE_CURSOR_STORE_TYPE(Cursor)  ((UINTN)(RShiftU64 ((Cursor), 32) & 0xFFFF) - 1)
+#define VARIABLE_CURSOR_OFFSET(Cursor)      ((UINT32)(Cursor))
+
+typedef struct {
+  ///
+  /// Reclaim generation of the variable stores.
+  ///
+  UINT16    Generation;
+  ///
+  /// Last cursor returned, it is known to be on a variable header and is not
+  /// validated again.
+  ///
+  UINT64    Hint;
+  ///
+  /// Cursor of the header of the last variable returned by
+  /// GetNextVariableByHint(), or 0.
+  ///
+  UINT64    LastVariable;
+} VARIABLE_CURSOR_CONTEXT;
+
+/**
+  Invalidate the cursors of the variable stores.
+
+  The cursors must be invalidated whenever variables of the stores are moved,
+  e.g. when a store is reclaimed.
+
+  @param[in, out] Context           The cursor context of the variable stores.
+
+**/
+VOID
+InvalidateVariableCursors (
+  IN OUT VARIABLE_CURSOR_CONTEXT  *Context
+  );
+
+/**
+  Find the first available variable from the position of an enumeration
+  cursor.
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode. A cursor other than the hint is checked to be on a
+  variable header of the store before the store is parsed from it.
+
+  @param[in]  Context               The cursor context of the variable stores.
+  @param[in]  Cursor                EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor returned
+                                    by this function.
+  @param[in]  VariableStoreList     A list of variable stores that should be used to get the variable.
+                                    The maximum number of entries is the max value of VARIABLE_STORE_TYPE.
+  @param[in]  AuthFormat            TRUE indicates authenticated variables are used.
+                                    FALSE indicates authenticated variables are not used.
+  @param[out] VariablePtr           Pointer to the header of the variable found.
+  @param[out] NextCursor            The cursor of the position following the variable found.
+
+  @retval EFI_SUCCESS               The variable was found.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_INVALID_PARAMETER     Cursor is not a cursor of the current variable stores.
+
+**/
+EFI_STATUS
+FindVariableByCursor (
+  IN  VARIABLE_CURSOR_CONTEXT  *Context,
+  IN  UINT64                   Cursor,
+  IN  VARIABLE_STORE_HEADER    **VariableStoreList,
+  IN  BOOLEAN                  AuthFormat,
+  OUT VARIABLE_HEADER          **VariablePtr,
+  OUT UINT64                   *NextCursor
+  );
+
+/**
+  Return packed EDKII_VARIABLE_ENUMERATION_RECORD records of the variables from
+  an enumeration cursor, as many as Buffer holds, and advance the cursor past
+  them.
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode. This function will do basic validation, before parse the data.
+
+  @param[in, out] Context           The cursor context of the variable stores.
+  @param[in, out] Cursor            On input, EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor
+                                    returned by the variable driver. On output, the cursor of the
+                                    variable following the last record if EFI_SUCCESS is returned.
+  @param[in]      VariableStoreList A list of variable stores that should be used to get the variables.
+                                    The maximum number of entries is the max value of VARIABLE_STORE_TYPE.
+  @param[in]      AuthFormat        TRUE indicates authenticated variables are used.
+                                    FALSE indicates authenticated variables are not used.
+  @param[in, out] BufferSize        On input, the size of Buffer. On output, the size of the records
+                                    returned, or the size of the first record if EFI_BUFFER_TOO_SMALL
+                                    is returned.
+  @param[out]     Buffer            Returns the records.
+
+  @retval EFI_SUCCESS               At least one record was returned and Cursor was advanced.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_BUFFER_TOO_SMALL      Buffer cannot hold the first record. Cursor is unchanged.
+  @retval EFI_INVALID_PARAMETER     Cursor is not a cursor of the current variable stores.
+
+**/
+EFI_STATUS
+GetVariableRecordsByCursor (
+  IN OUT VARIABLE_CURSOR_CONTEXT  *Context,
+  IN OUT UINT64                   *Cursor,
+  IN     VARIABLE_STORE_HEADER    **VariableStoreList,
+  IN     BOOLEAN                  AuthFormat,
+  IN OUT UINTN                    *BufferSize,
+  OUT    VOID                     *Buffer
+  );
+
+/**
+  This code finds the next available variable as
+  VariableServiceGetNextVariableInternal() does, and remembers it in the
+  cursor context.
+
+  When VariableName and VendorGuid name the variable returned by the previous
+  call, the search resumes after it instead of finding it by its name, so an
+  enumeration of n variables parses O(n) variable headers instead of O(n^2).
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode. Only the variable returned by the previous call is
+  parsed without a lookup, after its state, name and GUID are checked.
+
+  @param[in, out] Context           The cursor context of the variable stores.
+  @param[in]      VariableName      Pointer to variable name.
+  @param[in]      VendorGuid        Variable Vendor Guid.
+  @param[in]      VariableStoreList A list of variable stores that should be used to get the next variable.
+                                    The maximum number of entries is the max value of VARIABLE_STORE_TYPE.
+  @param[out]     VariablePtr       Pointer to variable header address.
+  @param[in]      AuthFormat        TRUE indicates authenticated variables are used.
+                                    FALSE indicates authenticated variables are not used.
+
+  @retval EFI_SUCCESS               The function completed successfully.
+  @retval EFI_NOT_FOUND             The next variable was not found.
+  @retval EFI_INVALID_PARAMETER     If VariableName is not an empty string, while VendorGuid is NULL.
+  @retval EFI_INVALID_PARAMETER     The input values of VariableName and VendorGuid are not a name and
+                                    GUID of an existing variable.
+
+**/
+EFI_STATUS
+GetNextVariableByHint (
+  IN OUT VARIABLE_CURSOR_CONTEXT  *Context,
+  IN     CHAR16                   *VariableName,
+  IN     EFI_GUID                 *VendorGuid,
+  IN     VARIABLE_STORE_HEADER    **VariableStoreList,
+  OUT    VARIABLE_HEADER          **VariablePtr,
+  IN     BOOLEAN                  AuthFormat
+  );
+
+#endif
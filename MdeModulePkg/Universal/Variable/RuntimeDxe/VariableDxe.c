@@ -11,16 +11,39 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include "Variable.h"
+#include "VariableIndex.h"
 
 #include <Protocol/VariablePolicy.h>
 #include <Library/VariablePolicyLib.h>
 
+extern VARIABLE_STORE_INDEX  mVariableStoreIndex[VariableStoreTypeMax];
+
 EFI_STATUS
 EFIAPI
 ProtocolIsVariablePolicyEnabled (
   OUT BOOLEAN  *State
   );
 
+EFI_STATUS
+EFIAPI
+VariableEnumerationGetNextVariableName (
+  IN     EDKII_VARIABLE_ENUMERATION_PROTOCOL  *This,
+  IN OUT UINT64                               *Cursor,
+  IN OUT UINTN                                *VariableNameSize,
+  OUT    CHAR16                               *VariableName,
+  OUT    EFI_GUID                             *VendorGuid,
+  OUT    UINT32                               *Attributes OPTIONAL
+  );
+
+EFI_STATUS
+EFIAPI
+VariableEnumerationGetVariableRecords (
+  IN     EDKII_VARIABLE_ENUMERATION_PROTOCOL  *This,
+  IN OUT UINT64                               *Cursor,
+  IN OUT UINTN                                *BufferSize,
+  OUT    VOID                                 *Buffer
+  );
+
 EFI_HANDLE                      mHandle                      = NULL;
 EFI_EVENT                       mVirtualAddressChangeEvent   = NULL;
 VOID                            *mFtwRegistration            = NULL;
@@ -43,6 +66,12 @@ EDKII_VAR_CHECK_PROTOCOL        mVarCheck = {
   VarCheckVariablePropertyGet
 };
 
+EDKII_VARIABLE_ENUMERATION_PROTOCOL  mVariableEnumeration = {
+  EDKII_VARIABLE_ENUMERATION_PROTOCOL_REVISION,
+  VariableEnumerationGetNextVariableName,
+  VariableEnumerationGetVariableRecords
+};
+
 /**
   Some Secure Boot Policy Variable may update following other variable changes(SecureBoot follows PK change, etc).
   Record their initial State when variable write service is ready.
@@ -245,7 +274,8 @@ VariableClassAddressChangeEvent (
   IN VOID       *Context
   )
 {
-  UINTN  Index;
+  UINTN                Index;
+  VARIABLE_STORE_TYPE  Type;
 
   if (mVariableModuleGlobal->FvbInstance != NULL) {
     EfiConvertPointer (0x0, (VOID **)&mVariableModuleGlobal->FvbInstance->GetBlockSize);
@@ -261,6 +291,7 @@ VariableClassAddressChangeEvent (
   EfiConvertPointer (0x0, (VOID **)&mVariableModuleGlobal->PlatformLangCodes);
   EfiConvertPointer (0x0, (VOID **)&mVariableModuleGlobal->LangCodes);
   EfiConvertPointer (0x0, (VOID **)&mVariableModuleGlobal->PlatformLang);
+  EfiConvertPointer (EFI_OPTIONAL_PTR, (VOID **)&mVariableModuleGlobal->NvBlockEraseCount);
   EfiConvertPointer (0x0, (VOID **)&mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase);
   EfiConvertPointer (0x0, (VOID **)&mVariableModuleGlobal->VariableGlobal.VolatileVariableBase);
   EfiConvertPointer (0x0, (VOID **)&mVariableModuleGlobal->VariableGlobal.HobVariableBase);
@@ -268,6 +299,16 @@ VariableClassAddressChangeEvent (
   EfiConvertPointer (0x0, (VOID **)&mNvVariableCache);
   EfiConvertPointer (0x0, (VOID **)&mNvFvHeaderCache);
 
+  //
+  // The start pointers of the variable stores change too, so the indexes are
+  // rebuilt by the next lookups.
+  //
+  for (Type = (VARIABLE_STORE_TYPE)0; Type < VariableStoreTypeMax; Type++) {
+    if (mVariableStoreIndex[Type].Entries != NULL) {
+      EfiConvertPointer (0x0, (VOID **)&mVariableStoreIndex[Type].Entries);
+    }
+  }
+
   if (mAuthContextOut.AddressPointer != NULL) {
     for (Index = 0; Index < mAuthContextOut.AddressPointerCount; Index++) {
       EfiConvertPointer (0x0, (VOID **)mAuthContextOut.AddressPointer[Index]);
@@ -521,6 +562,71 @@ ProtocolIsVariablePolicyEnabled (
   return EFI_SUCCESS;
 }
 
+/**
+  Return the name and GUID of the variable at a cursor, and advance the cursor
+  to the next variable.
+
+  @param[in]      This              The EDKII_VARIABLE_ENUMERATION_PROTOCOL instance.
+  @param[in, out] Cursor            On input, EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor
+                                    returned by this protocol. On output, the cursor of the next
+                                    variable if EFI_SUCCESS is returned.
+  @param[in, out] VariableNameSize  On input, the size of the VariableName buffer. On output, the
+                                    size of the name of the variable.
+  @param[out]     VariableName      Returns the Null-terminated name of the variable.
+  @param[out]     VendorGuid        Returns the vendor GUID of the variable.
+  @param[out]     Attributes        Returns the attributes of the variable. Optional.
+
+  @retval EFI_SUCCESS               The variable was returned and Cursor was advanced.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_BUFFER_TOO_SMALL      VariableNameSize is too small for the name.
+  @retval EFI_INVALID_PARAMETER     An input parameter is invalid.
+
+**/
+EFI_STATUS
+EFIAPI
+VariableEnumerationGetNextVariableName (
+  IN     EDKII_VARIABLE_ENUMERATION_PROTOCOL  *This,
+  IN OUT UINT64                               *Cursor,
+  IN OUT UINTN                                *VariableNameSize,
+  OUT    CHAR16                               *VariableName,
+  OUT    EFI_GUID                             *VendorGuid,
+  OUT    UINT32                               *Attributes OPTIONAL
+  )
+{
+  return VariableServiceGetNextVariableNameByCursor (Cursor, VariableNameSize, VariableName, VendorGuid, Attributes);
+}
+
+/**
+  Return packed EDKII_VARIABLE_ENUMERATION_RECORD records of the variables from
+  a cursor, as many as Buffer holds, and advance the cursor past them.
+
+  @param[in]      This              The EDKII_VARIABLE_ENUMERATION_PROTOCOL instance.
+  @param[in, out] Cursor            On input, EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor
+                                    returned by this protocol. On output, the cursor of the variable
+                                    following the last record if EFI_SUCCESS is returned.
+  @param[in, out] BufferSize        On input, the size of Buffer. On output, the size of the records
+                                    returned, or the size of the first record if EFI_BUFFER_TOO_SMALL
+                                    is returned.
+  @param[out]     Buffer            Returns the records.
+
+  @retval EFI_SUCCESS               At least one record was returned and Cursor was advanced.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_BUFFER_TOO_SMALL      Buffer cannot hold the first record.
+  @retval EFI_INVALID_PARAMETER     An input parameter is invalid.
+
+**/
+EFI_STATUS
+EFIAPI
+VariableEnumerationGetVariableRecords (
+  IN     EDKII_VARIABLE_ENUMERATION_PROTOCOL  *This,
+  IN OUT UINT64                               *Cursor,
+  IN OUT UINTN                                *BufferSize,
+  OUT    VOID                                 *Buffer
+  )
+{
+  return VariableServiceGetVariableRecords (Cursor, BufferSize, Buffer);
+}
+
 /**
   Variable Driver main entry point. The Variable driver places the 4 EFI
   runtime services in the EFI System Table and installs arch protocols
@@ -563,6 +669,14 @@ VariableServiceInitialize (
                   );
   ASSERT_EFI_ERROR (Status);
 
+  Status = gBS->InstallMultipleProtocolInterfaces (
+                  &mHandle,
+                  &gEdkiiVariableEnumerationProtocolGuid,
+                  &mVariableEnumeration,
+                  NULL
+                  );
+  ASSERT_EFI_ERROR (Status);
+
   SystemTable->RuntimeServices->GetVariable         = VariableServiceGetVariable;
   SystemTable->RuntimeServices->GetNextVariableName = VariableServiceGetNextVariableName;
   SystemTable->RuntimeServices->SetVariable         = VariableServiceSetVariable;
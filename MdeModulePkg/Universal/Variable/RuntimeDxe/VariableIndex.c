@@ -0,0 +1,334 @@
+/** @file
+  Hash index of the variables of a variable store.
+
+  The index maps the hash of the vendor GUID and name of a variable to the
+  offset of its header in the store, so that a variable is found without
+  walking the store header by header. Variables are appended to the store
+  when they are updated, their previous instances are only marked deleted,
+  so the index is built lazily: the headers appended since the previous lookup
+  are indexed by the next one. The index holds the variables of every state
+  and the state is checked when a variable is looked up.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "VariableIndex.h"
+
+#define VARIABLE_INDEX_FNV_OFFSET_BASIS  0x811C9DC5U
+#define VARIABLE_INDEX_FNV_PRIME         0x01000193U
+
+/**
+  Allocate the entries of the index of a variable store.
+
+  @param[out] Index             The index to initialize.
+  @param[in]  StoreSize         Size of the variable store in bytes.
+
+  @retval EFI_SUCCESS           The index was initialized.
+  @retval EFI_OUT_OF_RESOURCES  The entries of the index could not be allocated.
+
+**/
+EFI_STATUS
+InitializeVariableStoreIndex (
+  OUT VARIABLE_STORE_INDEX  *Index,
+  IN  UINTN                 StoreSize
+  )
+{
+  UINTN  EntryCount;
+
+  ZeroMem (Index, sizeof (VARIABLE_STORE_INDEX));
+
+  EntryCount = VARIABLE_INDEX_MIN_ENTRY_COUNT;
+  while (EntryCount < StoreSize / VARIABLE_INDEX_STORE_BYTES_PER_ENTRY) {
+    EntryCount <<= 1;
+  }
+
+  Index->Entries = AllocateRuntimePool (EntryCount * sizeof (VARIABLE_INDEX_ENTRY));
+  if (Index->Entries == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Index->EntryCount = (UINT32)EntryCount;
+  ResetVariableStoreIndex (Index);
+  return EFI_SUCCESS;
+}
+
+/**
+  Remove all the variables from the index of a variable store.
+
+  The index must be reset whenever variables of the store are moved, e.g. when
+  the store is reclaimed. Variables appended to the store are added to the
+  index by the next lookup.
+
+  @param[in, out] Index         The index to reset.
+
+**/
+VOID
+ResetVariableStoreIndex (
+  IN OUT VARIABLE_STORE_INDEX  *Index
+  )
+{
+  if (Index->Entries != NULL) {
+    SetMem (Index->Entries, Index->EntryCount * sizeof (VARIABLE_INDEX_ENTRY), 0xff);
+  }
+
+  Index->StartPtr    = NULL;
+  Index->UsedCount   = 0;
+  Index->IndexedSize = 0;
+  Index->Full        = FALSE;
+}
+
+/**
+  Compute the hash of the vendor GUID and name of a variable.
+
+  @param[in] VendorGuid         Vendor GUID of the variable.
+  @param[in] Name               Name of the variable, it may be unaligned.
+  @param[in] NameSize           Size of the name in bytes, including the null terminator.
+
+  @return The FNV-1a hash of the vendor GUID and of the name.
+
+**/
+UINT32
+VariableIndexHash (
+  IN CONST EFI_GUID  *VendorGuid,
+  IN CONST VOID      *Name,
+  IN UINTN           NameSize
+  )
+{
+  UINT32       Hash;
+  CONST UINT8  *Bytes;
+  UINTN        Index;
+
+  Hash  = VARIABLE_INDEX_FNV_OFFSET_BASIS;
+  Bytes = (CONST UINT8 *)VendorGuid;
+  for (Index = 0; Index < sizeof (EFI_GUID); Index++) {
+    Hash = (Hash ^ Bytes[Index]) * VARIABLE_INDEX_FNV_PRIME;
+  }
+
+  Bytes = (CONST UINT8 *)Name;
+  for (Index = 0; Index < NameSize; Index++) {
+    Hash = (Hash ^ Bytes[Index]) * VARIABLE_INDEX_FNV_PRIME;
+  }
+
+  return Hash;
+}
+
+/**
+  Add the variables appended to a variable store since the previous lookup to
+  the index of the store.
+
+  @param[in, out] Index         The index of the variable store.
+  @param[in]      StartPtr      The first variable of the store.
+  @param[in]      EndPtr        The end of the store.
+  @param[in]      AuthFormat    TRUE indicates authenticated variables are used.
+                                FALSE indicates authenticated variables are not used.
+
+**/
+VOID
+UpdateVariableStoreIndex (
+  IN OUT VARIABLE_STORE_INDEX  *Index,
+  IN     VARIABLE_HEADER       *StartPtr,
+  IN     VARIABLE_HEADER       *EndPtr,
+  IN     BOOLEAN               AuthFormat
+  )
+{
+  VARIABLE_HEADER  *Variable;
+  VARIABLE_HEADER  *NextVariable;
+  UINT32           Hash;
+  UINT32           Slot;
+
+  if (Index->StartPtr != StartPtr) {
+    ResetVariableStoreIndex (Index);
+    Index->StartPtr = StartPtr;
+  }
+
+  Variable = (VARIABLE_HEADER *)((UINTN)StartPtr + Index->IndexedSize);
+  while (!Index->Full && IsValidVariableHeader (Variable, EndPtr)) {
+    //
+    // Keep the load factor of the table below 3/4 so that probe sequences
+    // stay short.
+    //
+    if (Index->UsedCount >= Index->EntryCount - Index->EntryCount / 4) {
+      Index->Full = TRUE;
+      break;
+    }
+
+    Hash = VariableIndexHash (
+             GetVendorGuidPtr (Variable, AuthFormat),
+             GetVariableNamePtr (Variable, AuthFormat),
+             NameSizeOfVariable (Variable, AuthFormat)
+             );
+    for (Slot = Hash & (Index->EntryCount - 1);
+         Index->Entries[Slot].Offset != VARIABLE_INDEX_FREE_ENTRY;
+         Slot = (Slot + 1) & (Index->EntryCount - 1))
+    {
+    }
+
+    Index->Entries[Slot].Hash   = Hash;
+    Index->Entries[Slot].Offset = (UINT32)((UINTN)Variable - (UINTN)StartPtr);
+    Index->UsedCount++;
+
+    NextVariable       = GetNextVariablePtr (Variable, AuthFormat);
+    Index->IndexedSize = (UINT32)((UINTN)NextVariable - (UINTN)StartPtr);
+    Variable           = NextVariable;
+  }
+}
+
+/**
+  Check whether an indexed variable is a visible instance of the variable
+  that is looked up.
+
+  @param[in] Variable           The indexed variable.
+  @param[in] VariableName       Name of the variable to be found.
+  @param[in] VendorGuid         Variable vendor GUID to be found.
+  @param[in] NameSize           Size of VariableName in bytes.
+  @param[in] IgnoreRtCheck      Ignore EFI_VARIABLE_RUNTIME_ACCESS attribute
+                                check at runtime when searching variable.
+  @param[in] AuthFormat         TRUE indicates authenticated variables are used.
+                                FALSE indicates authenticated variables are not used.
+
+  @retval TRUE                  The variable matches, it is either added or in
+                                deleted transition.
+  @retval FALSE                 The variable does not match.
+
+**/
+BOOLEAN
+IsIndexedVariableMatch (
+  IN VARIABLE_HEADER  *Variable,
+  IN CHAR16           *VariableName,
+  IN EFI_GUID         *VendorGuid,
+  IN UINTN            NameSize,
+  IN BOOLEAN          IgnoreRtCheck,
+  IN BOOLEAN          AuthFormat
+  )
+{
+  if ((Variable->State != VAR_ADDED) &&
+      (Variable->State != (VAR_IN_DELETED_TRANSITION & VAR_ADDED)))
+  {
+    return FALSE;
+  }
+
+  if (!IgnoreRtCheck && AtRuntime () && ((Variable->Attributes & EFI_VARIABLE_RUNTIME_ACCESS) == 0)) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)((NameSizeOfVariable (Variable, AuthFormat) == NameSize) &&
+                   CompareGuid (VendorGuid, GetVendorGuidPtr (Variable, AuthFormat)) &&
+                   (CompareMem (VariableName, GetVariableNamePtr (Variable, AuthFormat), NameSize) == 0));
+}
+
+/**
+  Finds variable in a variable store with the index of the store.
+
+  This function returns the same variable as FindVariableEx(). Variables
+  appended to the store since the previous lookup are added to the index
+  first. FindVariableEx() is used if the index has no entries, if the index is
+  full or if VariableName is an empty string.
+
+  @param[in]       VariableName       Name of the variable to be found
+  @param[in]       VendorGuid         Variable vendor GUID to be found.
+  @param[in]       IgnoreRtCheck      Ignore EFI_VARIABLE_RUNTIME_ACCESS attribute
+                                      check at runtime when searching variable.
+  @param[in, out]  PtrTrack           Variable Track Pointer structure that contains Variable Information.
+  @param[in]       AuthFormat         TRUE indicates authenticated variables are used.
+                                      FALSE indicates authenticated variables are not used.
+  @param[in, out]  Index              The index of the variable store of PtrTrack.
+
+  @retval          EFI_SUCCESS        Variable found successfully
+  @retval          EFI_NOT_FOUND      Variable not found
+**/
+EFI_STATUS
+FindVariableInStoreIndex (
+  IN     CHAR16                  *VariableName,
+  IN     EFI_GUID                *VendorGuid,
+  IN     BOOLEAN                 IgnoreRtCheck,
+  IN OUT VARIABLE_POINTER_TRACK  *PtrTrack,
+  IN     BOOLEAN                 AuthFormat,
+  IN OUT VARIABLE_STORE_INDEX    *Index
+  )
+{
+  VARIABLE_HEADER  *Variable;
+  VARIABLE_HEADER  *AddedVariable;
+  VARIABLE_HEADER  *InDeletedVariable;
+  UINTN            InDeletedCount;
+  UINTN            NameSize;
+  UINT32           Hash;
+  UINT32           Slot;
+
+  if ((Index->Entries == NULL) || (VariableName[0] == 0)) {
+    return FindVariableEx (VariableName, VendorGuid, IgnoreRtCheck, PtrTrack, AuthFormat);
+  }
+
+  UpdateVariableStoreIndex (Index, PtrTrack->StartPtr, PtrTrack->EndPtr, AuthFormat);
+  if (Index->Full) {
+    return FindVariableEx (VariableName, VendorGuid, IgnoreRtCheck, PtrTrack, AuthFormat);
+  }
+
+  NameSize = StrSize (VariableName);
+  Hash     = VariableIndexHash (VendorGuid, VariableName, NameSize);
+
+  //
+  // FindVariableEx() returns the first added instance of the variable in the
+  // store, so the added instance with the lowest offset is looked for.
+  //
+  AddedVariable  = NULL;
+  InDeletedCount = 0;
+  for (Slot = Hash & (Index->EntryCount - 1);
+       Index->Entries[Slot].Offset != VARIABLE_INDEX_FREE_ENTRY;
+       Slot = (Slot + 1) & (Index->EntryCount - 1))
+  {
+    if (Index->Entries[Slot].Hash != Hash) {
+      continue;
+    }
+
+    Variable = (VARIABLE_HEADER *)((UINTN)PtrTrack->StartPtr + Index->Entries[Slot].Offset);
+    if (!IsIndexedVariableMatch (Variable, VariableName, VendorGuid, NameSize, IgnoreRtCheck, AuthFormat)) {
+      continue;
+    }
+
+    if (Variable->State != VAR_ADDED) {
+      InDeletedCount++;
+    } else if ((AddedVariable == NULL) || (Variable < AddedVariable)) {
+      AddedVariable = Variable;
+    }
+  }
+
+  //
+  // The instance in deleted transition is the last one that precedes the
+  // added instance, or the last one of the store if there is no added
+  // instance.
+  //
+  InDeletedVariable = NULL;
+  if (InDeletedCount != 0) {
+    for (Slot = Hash & (Index->EntryCount - 1);
+         Index->Entries[Slot].Offset != VARIABLE_INDEX_FREE_ENTRY;
+         Slot = (Slot + 1) & (Index->EntryCount - 1))
+    {
+      if (Index->Entries[Slot].Hash != Hash) {
+        continue;
+      }
+
+      Variable = (VARIABLE_HEADER *)((UINTN)PtrTrack->StartPtr + Index->Entries[Slot].Offset);
+      if ((Variable->State == VAR_ADDED) ||
+          ((AddedVariable != NULL) && (Variable > AddedVariable)) ||
+          ((InDeletedVariable != NULL) && (Variable < InDeletedVariable)) ||
+          !IsIndexedVariableMatch (Variable, VariableName, VendorGuid, NameSize, IgnoreRtCheck, AuthFormat))
+      {
+        continue;
+      }
+
+      InDeletedVariable = Variable;
+    }
+  }
+
+  if (AddedVariable != NULL) {
+    PtrTrack->CurrPtr                = AddedVariable;
+    PtrTrack->InDeletedTransitionPtr = InDeletedVariable;
+  } else {
+    PtrTrack->CurrPtr                = InDeletedVariable;
+    PtrTrack->InDeletedTransitionPtr = NULL;
+  }
+
+  return (PtrTrack->CurrPtr == NULL) ? EFI_NOT_FOUND : EFI_SUCCESS;
+}
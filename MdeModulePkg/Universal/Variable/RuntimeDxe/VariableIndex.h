@@ -0,0 +1,119 @@
+/** @file
+  The hash index of variable stores shared by the DXE_RUNTIME variable module,
+  the DXE_SMM variable module and the runtime cache of the SMM variable DXE
+  module.
+
+Copyright (c) 2026, agent. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _VARIABLE_INDEX_H_
+#define _VARIABLE_INDEX_H_
+
+#include "VariableParsing.h"
+
+///
+/// Minimum number of entries of an index, and number of bytes of the
+/// variable store per entry of an index.
+///
+#define VARIABLE_INDEX_MIN_ENTRY_COUNT        16
+#define VARIABLE_INDEX_STORE_BYTES_PER_ENTRY  64
+
+#define VARIABLE_INDEX_FREE_ENTRY  MAX_UINT32
+
+typedef struct {
+  UINT32    Hash;
+  ///
+  /// Offset of the variable header from the start of the variable store, or
+  /// VARIABLE_INDEX_FREE_ENTRY.
+  ///
+  UINT32    Offset;
+} VARIABLE_INDEX_ENTRY;
+
+typedef struct {
+  ///
+  /// First variable of the indexed store. The index is reset when the store
+  /// is looked up with another start pointer.
+  ///
+  VARIABLE_HEADER         *StartPtr;
+  ///
+  /// Open addressing hash table of EntryCount entries, EntryCount is a power
+  /// of two.
+  ///
+  VARIABLE_INDEX_ENTRY    *Entries;
+  UINT32                  EntryCount;
+  UINT32                  UsedCount;
+  ///
+  /// Offset of the first variable header of the store that is not indexed.
+  ///
+  UINT32                  IndexedSize;
+  ///
+  /// TRUE if the store holds too many variables for the index, lookups then
+  /// walk the store until the index is reset.
+  ///
+  BOOLEAN                 Full;
+} VARIABLE_STORE_INDEX;
+
+/**
+  Allocate the entries of the index of a variable store.
+
+  @param[out] Index             The index to initialize.
+  @param[in]  StoreSize         Size of the variable store in bytes.
+
+  @retval EFI_SUCCESS           The index was initialized.
+  @retval EFI_OUT_OF_RESOURCES  The entries of the index could not be allocated.
+
+**/
+EFI_STATUS
+InitializeVariableStoreIndex (
+  OUT VARIABLE_STORE_INDEX  *Index,
+  IN  UINTN                 StoreSize
+  );
+
+/**
+  Remove all the variables from the index of a variable store.
+
+  The index must be reset whenever variables of the store are moved, e.g. when
+  the store is reclaimed. Variables appended to the store are added to the
+  index by the next lookup.
+
+  @param[in, out] Index         The index to reset.
+
+**/
+VOID
+ResetVariableStoreIndex (
+  IN OUT VARIABLE_STORE_INDEX  *Index
+  );
+
+/**
+  Finds variable in a variable store with the index of the store.
+
+  This function returns the same variable as FindVariableEx(). Variables
+  appended to the store since the previous lookup are added to the index
+  first. FindVariableEx() is used if the index has no entries, if the index is
+  full or if VariableName is an empty string.
+
+  @param[in]       VariableName       Name of the variable to be found
+  @param[in]       VendorGuid         Variable vendor GUID to be found.
+  @param[in]       IgnoreRtCheck      Ignore EFI_VARIABLE_RUNTIME_ACCESS attribute
+                                      check at runtime when searching variable.
+  @param[in, out]  PtrTrack           Variable Track Pointer structure that contains Variable Information.
+  @param[in]       AuthFormat         TRUE indicates authenticated variables are used.
+                                      FALSE indicates authenticated variables are not used.
+  @param[in, out]  Index              The index of the variable store of PtrTrack.
+
+  @retval          EFI_SUCCESS        Variable found successfully
+  @retval          EFI_NOT_FOUND      Variable not found
+**/
+EFI_STATUS
+FindVariableInStoreIndex (
+  IN     CHAR16                  *VariableName,
+  IN     EFI_GUID                *VendorGuid,
+  IN     BOOLEAN                 IgnoreRtCheck,
+  IN OUT VARIABLE_POINTER_TRACK  *PtrTrack,
+  IN     BOOLEAN                 AuthFormat,
+  IN OUT VARIABLE_STORE_INDEX    *Index
+  );
+
+#endif
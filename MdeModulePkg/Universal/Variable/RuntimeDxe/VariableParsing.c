@@ -519,101 +519,45 @@ FindVariableEx (
 }
 
 /**
-  This code finds the next available variable.
+  This code finds the first available variable from a position of the variable
+  stores, switching to the next variable stores of the list when needed.
 
-  Caution: This function may receive untrusted input.
-  This function may be invoked in SMM mode. This function will do basic validation, before parse the data.
+  Caution: This function may be invoked in SMM mode.
 
-  @param[in]  VariableName      Pointer to variable name.
-  @param[in]  VendorGuid        Variable Vendor Guid.
-  @param[in]  VariableStoreList A list of variable stores that should be used to get the next variable.
-                                The maximum number of entries is the max value of VARIABLE_STORE_TYPE.
-  @param[out] VariablePtr       Pointer to variable header address.
-  @param[in]  AuthFormat        TRUE indicates authenticated variables are used.
-                                FALSE indicates authenticated variables are not used.
+  @param[in, out] Variable          On input, the store and the variable header of the
+                                    position to start from. On output, the variable found
+                                    and its store.
+  @param[in]      VariableStoreList A list of variable stores that should be used to get the next variable.
+                                    The maximum number of entries is the max value of VARIABLE_STORE_TYPE.
+  @param[in]      AuthFormat        TRUE indicates authenticated variables are used.
+                                    FALSE indicates authenticated variables are not used.
 
-  @retval EFI_SUCCESS           The function completed successfully.
-  @retval EFI_NOT_FOUND         The next variable was not found.
-  @retval EFI_INVALID_PARAMETER If VariableName is not an empty string, while VendorGuid is NULL.
-  @retval EFI_INVALID_PARAMETER The input values of VariableName and VendorGuid are not a name and
-                                GUID of an existing variable.
+  @retval EFI_SUCCESS               The variable was found.
+  @retval EFI_NOT_FOUND             There is no available variable from the position.
 
 **/
 EFI_STATUS
-EFIAPI
-VariableServiceGetNextVariableInternal (
-  IN  CHAR16                 *VariableName,
-  IN  EFI_GUID               *VendorGuid,
-  IN  VARIABLE_STORE_HEADER  **VariableStoreList,
-  OUT VARIABLE_HEADER        **VariablePtr,
-  IN  BOOLEAN                AuthFormat
+VariableServiceFindNextVariable (
+  IN OUT VARIABLE_POINTER_TRACK  *Variable,
+  IN     VARIABLE_STORE_HEADER   **VariableStoreList,
+  IN     BOOLEAN                 AuthFormat
   )
 {
   EFI_STATUS              Status;
   VARIABLE_STORE_TYPE     StoreType;
-  VARIABLE_POINTER_TRACK  Variable;
   VARIABLE_POINTER_TRACK  VariableInHob;
   VARIABLE_POINTER_TRACK  VariablePtrTrack;
 
-  Status = EFI_NOT_FOUND;
-
-  if (VariableStoreList == NULL) {
-    return EFI_INVALID_PARAMETER;
-  }
-
-  ZeroMem (&Variable, sizeof (Variable));
-
-  // Check if the variable exists in the given variable store list
-  for (StoreType = (VARIABLE_STORE_TYPE)0; StoreType < VariableStoreTypeMax; StoreType++) {
-    if (VariableStoreList[StoreType] == NULL) {
-      continue;
-    }
-
-    Variable.StartPtr = GetStartPointer (VariableStoreList[StoreType]);
-    Variable.EndPtr   = GetEndPointer (VariableStoreList[StoreType]);
-    Variable.Volatile = (BOOLEAN)(StoreType == VariableStoreTypeVolatile);
-
-    Status = FindVariableEx (VariableName, VendorGuid, FALSE, &Variable, AuthFormat);
-    if (!EFI_ERROR (Status)) {
-      break;
-    }
-  }
-
-  if ((Variable.CurrPtr == NULL) || EFI_ERROR (Status)) {
-    //
-    // For VariableName is an empty string, FindVariableEx() will try to find and return
-    // the first qualified variable, and if FindVariableEx() returns error (EFI_NOT_FOUND)
-    // as no any variable is found, still go to return the error (EFI_NOT_FOUND).
-    //
-    if (VariableName[0] != 0) {
-      //
-      // For VariableName is not an empty string, and FindVariableEx() returns error as
-      // VariableName and VendorGuid are not a name and GUID of an existing variable,
-      // there is no way to get next variable, follow spec to return EFI_INVALID_PARAMETER.
-      //
-      Status = EFI_INVALID_PARAMETER;
-    }
-
-    goto Done;
-  }
-
-  if (VariableName[0] != 0) {
-    //
-    // If variable name is not empty, get next variable.
-    //
-    Variable.CurrPtr = GetNextVariablePtr (Variable.CurrPtr, AuthFormat);
-  }
-
   while (TRUE) {
     //
     // Switch to the next variable store if needed
     //
-    while (!IsValidVariableHeader (Variable.CurrPtr, Variable.EndPtr)) {
+    while (!IsValidVariableHeader (Variable->CurrPtr, Variable->EndPtr)) {
       //
       // Find current storage index
       //
       for (StoreType = (VARIABLE_STORE_TYPE)0; StoreType < VariableStoreTypeMax; StoreType++) {
-        if ((VariableStoreList[StoreType] != NULL) && (Variable.StartPtr == GetStartPointer (VariableStoreList[StoreType]))) {
+        if ((VariableStoreList[StoreType] != NULL) && (Variable->StartPtr == GetStartPointer (VariableStoreList[StoreType]))) {
           break;
         }
       }
@@ -634,37 +578,36 @@ VariableServiceGetNextVariableInternal (
       // 2. no further storage
       //
       if (StoreType == VariableStoreTypeMax) {
-        Status = EFI_NOT_FOUND;
-        goto Done;
+        return EFI_NOT_FOUND;
       }
 
-      Variable.StartPtr = GetStartPointer (VariableStoreList[StoreType]);
-      Variable.EndPtr   = GetEndPointer (VariableStoreList[StoreType]);
-      Variable.CurrPtr  = Variable.StartPtr;
+      Variable->StartPtr = GetStartPointer (VariableStoreList[StoreType]);
+      Variable->EndPtr   = GetEndPointer (VariableStoreList[StoreType]);
+      Variable->CurrPtr  = Variable->StartPtr;
     }
 
     //
     // Variable is found
     //
-    if ((Variable.CurrPtr->State == VAR_ADDED) || (Variable.CurrPtr->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED))) {
-      if (!AtRuntime () || ((Variable.CurrPtr->Attributes & EFI_VARIABLE_RUNTIME_ACCESS) != 0)) {
-        if (Variable.CurrPtr->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED)) {
+    if ((Variable->CurrPtr->State == VAR_ADDED) || (Variable->CurrPtr->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED))) {
+      if (!AtRuntime () || ((Variable->CurrPtr->Attributes & EFI_VARIABLE_RUNTIME_ACCESS) != 0)) {
+        if (Variable->CurrPtr->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED)) {
           //
           // If it is a IN_DELETED_TRANSITION variable,
           // and there is also a same ADDED one at the same time,
           // don't return it.
           //
-          VariablePtrTrack.StartPtr = Variable.StartPtr;
-          VariablePtrTrack.EndPtr   = Variable.EndPtr;
+          VariablePtrTrack.StartPtr = Variable->StartPtr;
+          VariablePtrTrack.EndPtr   = Variable->EndPtr;
           Status                    = FindVariableEx (
-                                        GetVariableNamePtr (Variable.CurrPtr, AuthFormat),
-                                        GetVendorGuidPtr (Variable.CurrPtr, AuthFormat),
+                                        GetVariableNamePtr (Variable->CurrPtr, AuthFormat),
+                                        GetVendorGuidPtr (Variable->CurrPtr, AuthFormat),
                                         FALSE,
                                         &VariablePtrTrack,
                                         AuthFormat
                                         );
           if (!EFI_ERROR (Status) && (VariablePtrTrack.CurrPtr->State == VAR_ADDED)) {
-            Variable.CurrPtr = GetNextVariablePtr (Variable.CurrPtr, AuthFormat);
+            Variable->CurrPtr = GetNextVariablePtr (Variable->CurrPtr, AuthFormat);
             continue;
           }
         }
@@ -673,33 +616,121 @@ VariableServiceGetNextVariableInternal (
         // Don't return NV variable when HOB overrides it
         //
         if ((VariableStoreList[VariableStoreTypeHob] != NULL) && (VariableStoreList[VariableStoreTypeNv] != NULL) &&
-            (Variable.StartPtr == GetStartPointer (VariableStoreList[VariableStoreTypeNv]))
+            (Variable->StartPtr == GetStartPointer (VariableStoreList[VariableStoreTypeNv]))
             )
         {
           VariableInHob.StartPtr = GetStartPointer (VariableStoreList[VariableStoreTypeHob]);
           VariableInHob.EndPtr   = GetEndPointer (VariableStoreList[VariableStoreTypeHob]);
           Status                 = FindVariableEx (
-                                     GetVariableNamePtr (Variable.CurrPtr, AuthFormat),
-                                     GetVendorGuidPtr (Variable.CurrPtr, AuthFormat),
+                                     GetVariableNamePtr (Variable->CurrPtr, AuthFormat),
+                                     GetVendorGuidPtr (Variable->CurrPtr, AuthFormat),
                                      FALSE,
                                      &VariableInHob,
                                      AuthFormat
                                      );
           if (!EFI_ERROR (Status)) {
-            Variable.CurrPtr = GetNextVariablePtr (Variable.CurrPtr, AuthFormat);
+            Variable->CurrPtr = GetNextVariablePtr (Variable->CurrPtr, AuthFormat);
             continue;
           }
         }
 
-        *VariablePtr = Variable.CurrPtr;
-        Status       = EFI_SUCCESS;
-        goto Done;
+        return EFI_SUCCESS;
       }
     }
 
+    Variable->CurrPtr = GetNextVariablePtr (Variable->CurrPtr, AuthFormat);
+  }
+}
+
+/**
+  This code finds the next available variable.
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode. This function will do basic validation, before parse the data.
+
+  @param[in]  VariableName      Pointer to variable name.
+  @param[in]  VendorGuid        Variable Vendor Guid.
+  @param[in]  VariableStoreList A list of variable stores that should be used to get the next variable.
+                                The maximum number of entries is the max value of VARIABLE_STORE_TYPE.
+  @param[out] VariablePtr       Pointer to variable header address.
+  @param[in]  AuthFormat        TRUE indicates authenticated variables are used.
+                                FALSE indicates authenticated variables are not used.
+
+  @retval EFI_SUCCESS           The function completed successfully.
+  @retval EFI_NOT_FOUND         The next variable was not found.
+  @retval EFI_INVALID_PARAMETER If VariableName is not an empty string, while VendorGuid is NULL.
+  @retval EFI_INVALID_PARAMETER The input values of VariableName and VendorGuid are not a name and
+                                GUID of an existing variable.
+
+**/
+EFI_STATUS
+EFIAPI
+VariableServiceGetNextVariableInternal (
+  IN  CHAR16                 *VariableName,
+  IN  EFI_GUID               *VendorGuid,
+  IN  VARIABLE_STORE_HEADER  **VariableStoreList,
+  OUT VARIABLE_HEADER        **VariablePtr,
+  IN  BOOLEAN                AuthFormat
+  )
+{
+  EFI_STATUS              Status;
+  VARIABLE_STORE_TYPE     StoreType;
+  VARIABLE_POINTER_TRACK  Variable;
+
+  Status = EFI_NOT_FOUND;
+
+  if (VariableStoreList == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ZeroMem (&Variable, sizeof (Variable));
+
+  // Check if the variable exists in the given variable store list
+  for (StoreType = (VARIABLE_STORE_TYPE)0; StoreType < VariableStoreTypeMax; StoreType++) {
+    if (VariableStoreList[StoreType] == NULL) {
+      continue;
+    }
+
+    Variable.StartPtr = GetStartPointer (VariableStoreList[StoreType]);
+    Variable.EndPtr   = GetEndPointer (VariableStoreList[StoreType]);
+    Variable.Volatile = (BOOLEAN)(StoreType == VariableStoreTypeVolatile);
+
+    Status = FindVariableEx (VariableName, VendorGuid, FALSE, &Variable, AuthFormat);
+    if (!EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  if ((Variable.CurrPtr == NULL) || EFI_ERROR (Status)) {
+    //
+    // For VariableName is an empty string, FindVariableEx() will try to find and return
+    // the first qualified variable, and if FindVariableEx() returns error (EFI_NOT_FOUND)
+    // as no any variable is found, still go to return the error (EFI_NOT_FOUND).
+    //
+    if (VariableName[0] != 0) {
+      //
+      // For VariableName is not an empty string, and FindVariableEx() returns error as
+      // VariableName and VendorGuid are not a name and GUID of an existing variable,
+      // there is no way to get next variable, follow spec to return EFI_INVALID_PARAMETER.
+      //
+      Status = EFI_INVALID_PARAMETER;
+    }
+
+    goto Done;
+  }
+
+  if (VariableName[0] != 0) {
+    //
+    // If variable name is not empty, get next variable.
+    //
     Variable.CurrPtr = GetNextVariablePtr (Variable.CurrPtr, AuthFormat);
   }
 
+  Status = VariableServiceFindNextVariable (&Variable, VariableStoreList, AuthFormat);
+  if (!EFI_ERROR (Status)) {
+    *VariablePtr = Variable.CurrPtr;
+  }
+
 Done:
   return Status;
 }
@@ -10,8 +10,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #ifndef _VARIABLE_PARSING_H_
 #define _VARIABLE_PARSING_H_
 
-#include <Guid/ImageAuthentication.h>
 #include "Variable.h"
+#include <Guid/ImageAuthentication.h>
 
 /**
 
@@ -280,6 +280,31 @@ FindVariableEx (
   IN     BOOLEAN                 AuthFormat
   );
 
+/**
+  This code finds the first available variable from a position of the variable
+  stores, switching to the next variable stores of the list when needed.
+
+  Caution: This function may be invoked in SMM mode.
+
+  @param[in, out] Variable          On input, the store and the variable header of the
+                                    position to start from. On output, the variable found
+                                    and its store.
+  @param[in]      VariableStoreList A list of variable stores that should be used to get the next variable.
+                                    The maximum number of entries is the max value of VARIABLE_STORE_TYPE.
+  @param[in]      AuthFormat        TRUE indicates authenticated variables are used.
+                                    FALSE indicates authenticated variables are not used.
+
+  @retval EFI_SUCCESS               The variable was found.
+  @retval EFI_NOT_FOUND             There is no available variable from the position.
+
+**/
+EFI_STATUS
+VariableServiceFindNextVariable (
+  IN OUT VARIABLE_POINTER_TRACK  *Variable,
+  IN     VARIABLE_STORE_HEADER   **VariableStoreList,
+  IN     BOOLEAN                 AuthFormat
+  );
+
 /**
   This code finds the next available variable.
 
@@ -18,6 +18,132 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 extern VARIABLE_MODULE_GLOBAL  *mVariableModuleGlobal;
 extern VARIABLE_STORE_HEADER   *mNvVariableCache;
 
+/**
+  Adds a byte range to the pending updates of a runtime cache.
+
+  Pending updates that overlap or touch the range are merged with it. If the
+  journal of the runtime cache is full, the range is merged with the closest
+  pending update.
+
+  @param[in, out] VariableRuntimeCache  Variable runtime cache structure for the runtime cache being updated.
+  @param[in]      Offset                Offset in bytes to apply the update.
+  @param[in]      Length                Length of data in bytes of the update.
+
+**/
+VOID
+AddPendingRuntimeVariableCacheUpdate (
+  IN OUT VARIABLE_RUNTIME_CACHE  *VariableRuntimeCache,
+  IN     UINTN                   Offset,
+  IN     UINTN                   Length
+  )
+{
+  VARIABLE_RUNTIME_CACHE_UPDATE  *Update;
+  UINTN                          End;
+  UINTN                          Index;
+  UINTN                          Gap;
+  UINTN                          ClosestGap;
+  UINTN                          Closest;
+
+  if (Length == 0) {
+    return;
+  }
+
+  End = Offset + Length;
+
+  Index = 0;
+  while (Index < VariableRuntimeCache->PendingUpdateCount) {
+    Update = &VariableRuntimeCache->PendingUpdates[Index];
+    if ((Update->Offset <= End) && (Offset <= (UINTN)Update->Offset + Update->Length)) {
+      //
+      // Merge the pending update into the range and remove it from the journal
+      //
+      Offset = MIN (Offset, (UINTN)Update->Offset);
+      End    = MAX (End, (UINTN)Update->Offset + Update->Length);
+      VariableRuntimeCache->PendingUpdateCount--;
+      *Update = VariableRuntimeCache->PendingUpdates[VariableRuntimeCache->PendingUpdateCount];
+    } else {
+      Index++;
+    }
+  }
+
+  if (VariableRuntimeCache->PendingUpdateCount == VARIABLE_RUNTIME_CACHE_MAX_PENDING_UPDATES) {
+    //
+    // No other pending update lies between the range and the closest one, so
+    // the merged range does not overlap the rest of the journal
+    //
+    Closest    = 0;
+    ClosestGap = MAX_UINTN;
+    for (Index = 0; Index < VariableRuntimeCache->PendingUpdateCount; Index++) {
+      Update = &VariableRuntimeCache->PendingUpdates[Index];
+      if (Update->Offset > End) {
+        Gap = Update->Offset - End;
+      } else {
+        Gap = Offset - ((UINTN)Update->Offset + Update->Length);
+      }
+
+      if (Gap < ClosestGap) {
+        ClosestGap = Gap;
+        Closest    = Index;
+      }
+    }
+
+    Update = &VariableRuntimeCache->PendingUpdates[Closest];
+    Offset = MIN (Offset, (UINTN)Update->Offset);
+    End    = MAX (End, (UINTN)Update->Offset + Update->Length);
+  } else {
+    Update = &VariableRuntimeCache->PendingUpdates[VariableRuntimeCache->PendingUpdateCount];
+    VariableRuntimeCache->PendingUpdateCount++;
+  }
+
+  Update->Offset = (UINT32)Offset;
+  Update->Length = (UINT32)(End - Offset);
+}
+
+/**
+  Copies the pending updates of a runtime cache from its variable store.
+
+  If PcdVariableCollectStatistics is TRUE, the copies are counted in the
+  statistics of the runtime cache.
+
+  @param[in, out] VariableRuntimeCache  Variable runtime cache structure for the runtime cache being updated.
+  @param[in]      VariableStore         The variable store of the runtime cache.
+
+**/
+VOID
+FlushRuntimeVariableCache (
+  IN OUT VARIABLE_RUNTIME_CACHE  *VariableRuntimeCache,
+  IN     VARIABLE_STORE_HEADER   *VariableStore
+  )
+{
+  VARIABLE_RUNTIME_CACHE_UPDATE      *Update;
+  VARIABLE_RUNTIME_CACHE_STATISTICS  *Statistics;
+  UINTN                              Index;
+
+  Statistics = &VariableRuntimeCache->Statistics;
+  if (FeaturePcdGet (PcdVariableCollectStatistics)) {
+    Statistics->FlushCount++;
+  }
+
+  for (Index = 0; Index < VariableRuntimeCache->PendingUpdateCount; Index++) {
+    Update = &VariableRuntimeCache->PendingUpdates[Index];
+    CopyMem (
+      (UINT8 *)VariableRuntimeCache->Store + Update->Offset,
+      (UINT8 *)VariableStore + Update->Offset,
+      Update->Length
+      );
+
+    if (FeaturePcdGet (PcdVariableCollectStatistics)) {
+      Statistics->RangeCount++;
+      Statistics->CopiedBytes += Update->Length;
+      if ((Update->Offset == 0) && (Update->Length >= VariableStore->Size)) {
+        Statistics->StoreCopyCount++;
+      }
+    }
+  }
+
+  VariableRuntimeCache->PendingUpdateCount = 0;
+}
+
 /**
   Copies any pending updates to runtime variable caches.
 
@@ -45,54 +171,74 @@ FlushPendingRuntimeVariableCacheUpdates (
     if ((VariableRuntimeCacheContext->VariableRuntimeHobCache.Store != NULL) &&
         (mVariableModuleGlobal->VariableGlobal.HobVariableBase > 0))
     {
-      CopyMem (
-        (VOID *)(
-                 ((UINT8 *)(UINTN)VariableRuntimeCacheContext->VariableRuntimeHobCache.Store) +
-                 VariableRuntimeCacheContext->VariableRuntimeHobCache.PendingUpdateOffset
-                 ),
-        (VOID *)(
-                 ((UINT8 *)(UINTN)mVariableModuleGlobal->VariableGlobal.HobVariableBase) +
-                 VariableRuntimeCacheContext->VariableRuntimeHobCache.PendingUpdateOffset
-                 ),
-        VariableRuntimeCacheContext->VariableRuntimeHobCache.PendingUpdateLength
+      FlushRuntimeVariableCache (
+        &VariableRuntimeCacheContext->VariableRuntimeHobCache,
+        (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.HobVariableBase
         );
-      VariableRuntimeCacheContext->VariableRuntimeHobCache.PendingUpdateLength = 0;
-      VariableRuntimeCacheContext->VariableRuntimeHobCache.PendingUpdateOffset = 0;
     }
 
-    CopyMem (
-      (VOID *)(
-               ((UINT8 *)(UINTN)VariableRuntimeCacheContext->VariableRuntimeNvCache.Store) +
-               VariableRuntimeCacheContext->VariableRuntimeNvCache.PendingUpdateOffset
-               ),
-      (VOID *)(
-               ((UINT8 *)(UINTN)mNvVariableCache) +
-               VariableRuntimeCacheContext->VariableRuntimeNvCache.PendingUpdateOffset
-               ),
-      VariableRuntimeCacheContext->VariableRuntimeNvCache.PendingUpdateLength
+    FlushRuntimeVariableCache (
+      &VariableRuntimeCacheContext->VariableRuntimeNvCache,
+      mNvVariableCache
       );
-    VariableRuntimeCacheContext->VariableRuntimeNvCache.PendingUpdateLength = 0;
-    VariableRuntimeCacheContext->VariableRuntimeNvCache.PendingUpdateOffset = 0;
-
-    CopyMem (
-      (VOID *)(
-               ((UINT8 *)(UINTN)VariableRuntimeCacheContext->VariableRuntimeVolatileCache.Store) +
-               VariableRuntimeCacheContext->VariableRuntimeVolatileCache.PendingUpdateOffset
-               ),
-      (VOID *)(
-               ((UINT8 *)(UINTN)mVariableModuleGlobal->VariableGlobal.VolatileVariableBase) +
-               VariableRuntimeCacheContext->VariableRuntimeVolatileCache.PendingUpdateOffset
-               ),
-      VariableRuntimeCacheContext->VariableRuntimeVolatileCache.PendingUpdateLength
+    FlushRuntimeVariableCache (
+      &VariableRuntimeCacheContext->VariableRuntimeVolatileCache,
+      (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.VolatileVariableBase
       );
-    VariableRuntimeCacheContext->VariableRuntimeVolatileCache.PendingUpdateLength = 0;
-    VariableRuntimeCacheContext->VariableRuntimeVolatileCache.PendingUpdateOffset = 0;
-    *(VariableRuntimeCacheContext->PendingUpdate)                                 = FALSE;
+    *(VariableRuntimeCacheContext->PendingUpdate) = FALSE;
   }
 
   return EFI_SUCCESS;
 }
 
+/**
+  Prints the statistics of a runtime variable cache.
+
+  @param[in] CacheName             Name of the runtime cache.
+  @param[in] VariableRuntimeCache  Variable runtime cache structure of the runtime cache.
+
+**/
+STATIC
+VOID
+PrintRuntimeVariableCacheStatistic (
+  IN CHAR8                   *CacheName,
+  IN VARIABLE_RUNTIME_CACHE  *VariableRuntimeCache
+  )
+{
+  DEBUG ((
+    DEBUG_INFO,
+    "Variable runtime %a cache: %u flushes, %u ranges, %u whole store copies, %Lu bytes copied\n",
+    CacheName,
+    VariableRuntimeCache->Statistics.FlushCount,
+    VariableRuntimeCache->Statistics.RangeCount,
+    VariableRuntimeCache->Statistics.StoreCopyCount,
+    VariableRuntimeCache->Statistics.CopiedBytes
+    ));
+}
+
+/**
+  Prints the statistics of the runtime variable caches.
+
+  The statistics are only collected if PcdVariableCollectStatistics is TRUE.
+
+**/
+VOID
+PrintRuntimeVariableCacheStatistics (
+  VOID
+  )
+{
+  VARIABLE_RUNTIME_CACHE_CONTEXT  *VariableRuntimeCacheContext;
+
+  if (!FeaturePcdGet (PcdVariableCollectStatistics)) {
+    return;
+  }
+
+  VariableRuntimeCacheContext = &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext;
+  PrintRuntimeVariableCacheStatistic ("HOB", &VariableRuntimeCacheContext->VariableRuntimeHobCache);
+  PrintRuntimeVariableCacheStatistic ("NV", &VariableRuntimeCacheContext->VariableRuntimeNvCache);
+  PrintRuntimeVariableCacheStatistic ("volatile", &VariableRuntimeCacheContext->VariableRuntimeVolatileCache);
+}
+
 /**
   Synchronizes the runtime variable caches with all pending updates outside runtime.
 
@@ -131,23 +277,12 @@ SynchronizeRuntimeVariableCache (
     return EFI_UNSUPPORTED;
   }
 
-  if (*(mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.PendingUpdate) &&
-      (VariableRuntimeCache->PendingUpdateLength > 0))
-  {
-    VariableRuntimeCache->PendingUpdateLength =
-      (UINT32)(
-               MAX (
-                 (UINTN)(VariableRuntimeCache->PendingUpdateOffset + VariableRuntimeCache->PendingUpdateLength),
-                 Offset + Length
-                 ) - MIN ((UINTN)VariableRuntimeCache->PendingUpdateOffset, Offset)
-               );
-    VariableRuntimeCache->PendingUpdateOffset =
-      (UINT32)MIN ((UINTN)VariableRuntimeCache->PendingUpdateOffset, Offset);
-  } else {
-    VariableRuntimeCache->PendingUpdateLength = (UINT32)Length;
-    VariableRuntimeCache->PendingUpdateOffset = (UINT32)Offset;
+  if (!*(mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.PendingUpdate)) {
+    VariableRuntimeCache->PendingUpdateCount = 0;
   }
 
+  AddPendingRuntimeVariableCacheUpdate (VariableRuntimeCache, Offset, Length);
+
   *(mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.PendingUpdate) = TRUE;
 
   if (*(mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.ReadLock) == FALSE) {
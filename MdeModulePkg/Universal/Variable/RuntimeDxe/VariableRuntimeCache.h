@@ -12,6 +12,25 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "Variable.h"
 
+/**
+  Adds a byte range to the pending updates of a runtime cache.
+
+  Pending updates that overlap or touch the range are merged with it. If the
+  journal of the runtime cache is full, the range is merged with the closest
+  pending update.
+
+  @param[in, out] VariableRuntimeCache  Variable runtime cache structure for the runtime cache being updated.
+  @param[in]      Offset                Offset in bytes to apply the update.
+  @param[in]      Length                Length of data in bytes of the update.
+
+**/
+VOID
+AddPendingRuntimeVariableCacheUpdate (
+  IN OUT VARIABLE_RUNTIME_CACHE  *VariableRuntimeCache,
+  IN     UINTN                   Offset,
+  IN     UINTN                   Length
+  );
+
 /**
   Copies any pending updates to runtime variable caches.
 
@@ -24,6 +43,17 @@ FlushPendingRuntimeVariableCacheUpdates (
   VOID
   );
 
+/**
+  Prints the statistics of the runtime variable caches.
+
+  The statistics are only collected if PcdVariableCollectStatistics is TRUE.
+
+**/
+VOID
+PrintRuntimeVariableCacheStatistics (
+  VOID
+  );
+
 /**
   Synchronizes the runtime variable caches with all pending updates outside runtime.
 
@@ -33,6 +33,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "Variable.h"
 #include "VariableParsing.h"
 #include "VariableRuntimeCache.h"
+#include "VariableBatch.h"
 
 extern VARIABLE_STORE_HEADER  *mNvVariableCache;
 
@@ -469,6 +470,9 @@ SmmVariableHandler (
   SMM_VARIABLE_COMMUNICATE_GET_RUNTIME_CACHE_INFO          *GetRuntimeCacheInfo;
   SMM_VARIABLE_COMMUNICATE_LOCK_VARIABLE                   *VariableToLock;
   SMM_VARIABLE_COMMUNICATE_VAR_CHECK_VARIABLE_PROPERTY     *CommVariableProperty;
+  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH              *VariableBatch;
+  SMM_VARIABLE_COMMUNICATE_GET_NEXT_VARIABLE_BY_CURSOR     *GetNextVariableByCursor;
+  SMM_VARIABLE_COMMUNICATE_GET_VARIABLE_RECORDS            *GetVariableRecords;
   VARIABLE_INFO_ENTRY                                      *VariableInfo;
   VARIABLE_RUNTIME_CACHE_CONTEXT                           *VariableCacheContext;
   VARIABLE_STORE_HEADER                                    *VariableCache;
@@ -665,6 +669,74 @@ SmmVariableHandler (
                  );
       break;
 
+    case SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH:
+      if (CommBufferPayloadSize < sizeof (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH)) {
+        DEBUG ((DEBUG_ERROR, "SetVariableBatch: SMM communication buffer size invalid!\n"));
+        return EFI_SUCCESS;
+      }
+
+      //
+      // Copy the input communicate buffer payload to pre-allocated SMM variable buffer payload.
+      //
+      CopyMem (mVariableBufferPayload, SmmVariableFunctionHeader->Data, CommBufferPayloadSize);
+      VariableBatch = (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH *)mVariableBufferPayload;
+      Status        = SmmSetVariableBatch (VariableBatch, CommBufferPayloadSize);
+      ((SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH *)SmmVariableFunctionHeader->Data)->FailedIndex  = VariableBatch->FailedIndex;
+      ((SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH *)SmmVariableFunctionHeader->Data)->AppliedCount = VariableBatch->AppliedCount;
+      break;
+
+    case SMM_VARIABLE_FUNCTION_GET_NEXT_VARIABLE_BY_CURSOR:
+      if (CommBufferPayloadSize < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_GET_NEXT_VARIABLE_BY_CURSOR, Name)) {
+        DEBUG ((DEBUG_ERROR, "GetNextVariableByCursor: SMM communication buffer size invalid!\n"));
+        return EFI_SUCCESS;
+      }
+
+      //
+      // Copy the input communicate buffer payload to pre-allocated SMM variable buffer payload.
+      //
+      CopyMem (mVariableBufferPayload, SmmVariableFunctionHeader->Data, CommBufferPayloadSize);
+      GetNextVariableByCursor = (SMM_VARIABLE_COMMUNICATE_GET_NEXT_VARIABLE_BY_CURSOR *)mVariableBufferPayload;
+      if (GetNextVariableByCursor->NameSize > CommBufferPayloadSize - OFFSET_OF (SMM_VARIABLE_COMMUNICATE_GET_NEXT_VARIABLE_BY_CURSOR, Name)) {
+        DEBUG ((DEBUG_ERROR, "GetNextVariableByCursor: Data size exceed communication buffer size limit!\n"));
+        Status = EFI_ACCESS_DENIED;
+        goto EXIT;
+      }
+
+      Status = VariableServiceGetNextVariableNameByCursor (
+                 &GetNextVariableByCursor->Cursor,
+                 &GetNextVariableByCursor->NameSize,
+                 GetNextVariableByCursor->Name,
+                 &GetNextVariableByCursor->Guid,
+                 &GetNextVariableByCursor->Attributes
+                 );
+      CopyMem (SmmVariableFunctionHeader->Data, mVariableBufferPayload, CommBufferPayloadSize);
+      break;
+
+    case SMM_VARIABLE_FUNCTION_GET_VARIABLE_RECORDS:
+      if (CommBufferPayloadSize < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_GET_VARIABLE_RECORDS, Records)) {
+        DEBUG ((DEBUG_ERROR, "GetVariableRecords: SMM communication buffer size invalid!\n"));
+        return EFI_SUCCESS;
+      }
+
+      //
+      // Copy the input communicate buffer payload to pre-allocated SMM variable buffer payload.
+      //
+      CopyMem (mVariableBufferPayload, SmmVariableFunctionHeader->Data, CommBufferPayloadSize);
+      GetVariableRecords = (SMM_VARIABLE_COMMUNICATE_GET_VARIABLE_RECORDS *)mVariableBufferPayload;
+      if (GetVariableRecords->RecordsSize > CommBufferPayloadSize - OFFSET_OF (SMM_VARIABLE_COMMUNICATE_GET_VARIABLE_RECORDS, Records)) {
+        DEBUG ((DEBUG_ERROR, "GetVariableRecords: Data size exceed communication buffer size limit!\n"));
+        Status = EFI_ACCESS_DENIED;
+        goto EXIT;
+      }
+
+      Status = VariableServiceGetVariableRecords (
+                 &GetVariableRecords->Cursor,
+                 &GetVariableRecords->RecordsSize,
+                 GetVariableRecords->Records
+                 );
+      CopyMem (SmmVariableFunctionHeader->Data, mVariableBufferPayload, CommBufferPayloadSize);
+      break;
+
     case SMM_VARIABLE_FUNCTION_QUERY_VARIABLE_INFO:
       if (CommBufferPayloadSize < sizeof (SMM_VARIABLE_COMMUNICATE_QUERY_VARIABLE_INFO)) {
         DEBUG ((DEBUG_ERROR, "QueryVariableInfo: SMM communication buffer size invalid!\n"));
@@ -711,6 +783,7 @@ SmmVariableHandler (
       }
 
       ReclaimForOS ();
+      PrintRuntimeVariableCacheStatistics ();
       Status = EFI_SUCCESS;
       break;
 
@@ -815,7 +888,7 @@ SmmVariableHandler (
       CopyMem (SmmVariableFunctionHeader->Data, mVariableBufferPayload, CommBufferPayloadSize);
       break;
     case SMM_VARIABLE_FUNCTION_INIT_RUNTIME_VARIABLE_CACHE_CONTEXT:
-      if (CommBufferPayloadSize < sizeof (SMM_VARIABLE_COMMUNICATE_RUNTIME_VARIABLE_CACHE_CONTEXT)) {
+      if (CommBufferPayloadSize < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_RUNTIME_VARIABLE_CACHE_CONTEXT, StoreRewriteCount)) {
         DEBUG ((DEBUG_ERROR, "InitRuntimeVariableCacheContext: SMM communication buffer size invalid!\n"));
         Status = EFI_ACCESS_DENIED;
         goto EXIT;
@@ -833,6 +906,14 @@ SmmVariableHandler (
       CopyMem (mVariableBufferPayload, SmmVariableFunctionHeader->Data, CommBufferPayloadSize);
       RuntimeVariableCacheContext = (SMM_VARIABLE_COMMUNICATE_RUNTIME_VARIABLE_CACHE_CONTEXT *)mVariableBufferPayload;
 
+      //
+      // The store rewrite count is optional, and is not sent by callers that
+      // do not index the runtime caches.
+      //
+      if (CommBufferPayloadSize < sizeof (SMM_VARIABLE_COMMUNICATE_RUNTIME_VARIABLE_CACHE_CONTEXT)) {
+        RuntimeVariableCacheContext->StoreRewriteCount = NULL;
+      }
+
       //
       // Verify required runtime cache buffers are provided.
       //
@@ -924,6 +1005,17 @@ SmmVariableHandler (
         goto EXIT;
       }
 
+      if ((RuntimeVariableCacheContext->StoreRewriteCount != NULL) &&
+          !VariableSmmIsNonPrimaryBufferValid (
+             (UINTN)RuntimeVariableCacheContext->StoreRewriteCount,
+             sizeof (*(RuntimeVariableCacheContext->StoreRewriteCount))
+             ))
+      {
+        DEBUG ((DEBUG_ERROR, "InitRuntimeVariableCacheContext: Runtime cache store rewrite count buffer in SMRAM or overflow!\n"));
+        Status = EFI_ACCESS_DENIED;
+        goto EXIT;
+      }
+
       VariableCacheContext                                     = &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext;
       VariableCacheContext->VariableRuntimeHobCache.Store      = RuntimeVariableCacheContext->RuntimeHobCache;
       VariableCacheContext->VariableRuntimeVolatileCache.Store = RuntimeVariableCacheContext->RuntimeVolatileCache;
@@ -931,26 +1023,38 @@ SmmVariableHandler (
       VariableCacheContext->PendingUpdate                      = RuntimeVariableCacheContext->PendingUpdate;
       VariableCacheContext->ReadLock                           = RuntimeVariableCacheContext->ReadLock;
       VariableCacheContext->HobFlushComplete                   = RuntimeVariableCacheContext->HobFlushComplete;
+      VariableCacheContext->StoreRewriteCount                  = RuntimeVariableCacheContext->StoreRewriteCount;
 
       // Set up the intial pending request since the RT cache needs to be in sync with SMM cache
-      VariableCacheContext->VariableRuntimeHobCache.PendingUpdateOffset = 0;
-      VariableCacheContext->VariableRuntimeHobCache.PendingUpdateLength = 0;
+      VariableCacheContext->VariableRuntimeHobCache.PendingUpdateCount = 0;
       if ((mVariableModuleGlobal->VariableGlobal.HobVariableBase > 0) &&
           (VariableCacheContext->VariableRuntimeHobCache.Store != NULL))
       {
-        VariableCache                                                     = (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.HobVariableBase;
-        VariableCacheContext->VariableRuntimeHobCache.PendingUpdateLength = (UINT32)((UINTN)GetEndPointer (VariableCache) - (UINTN)VariableCache);
+        VariableCache = (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.HobVariableBase;
+        AddPendingRuntimeVariableCacheUpdate (
+          &VariableCacheContext->VariableRuntimeHobCache,
+          0,
+          (UINTN)GetEndPointer (VariableCache) - (UINTN)VariableCache
+          );
         CopyGuid (&(VariableCacheContext->VariableRuntimeHobCache.Store->Signature), &(VariableCache->Signature));
       }
 
-      VariableCache                                                          = (VARIABLE_STORE_HEADER  *)(UINTN)mVariableModuleGlobal->VariableGlobal.VolatileVariableBase;
-      VariableCacheContext->VariableRuntimeVolatileCache.PendingUpdateOffset = 0;
-      VariableCacheContext->VariableRuntimeVolatileCache.PendingUpdateLength = (UINT32)((UINTN)GetEndPointer (VariableCache) - (UINTN)VariableCache);
+      VariableCache                                                         = (VARIABLE_STORE_HEADER  *)(UINTN)mVariableModuleGlobal->VariableGlobal.VolatileVariableBase;
+      VariableCacheContext->VariableRuntimeVolatileCache.PendingUpdateCount = 0;
+      AddPendingRuntimeVariableCacheUpdate (
+        &VariableCacheContext->VariableRuntimeVolatileCache,
+        0,
+        (UINTN)GetEndPointer (VariableCache) - (UINTN)VariableCache
+        );
       CopyGuid (&(VariableCacheContext->VariableRuntimeVolatileCache.Store->Signature), &(VariableCache->Signature));
 
-      VariableCache                                                    = (VARIABLE_STORE_HEADER  *)(UINTN)mNvVariableCache;
-      VariableCacheContext->VariableRuntimeNvCache.PendingUpdateOffset = 0;
-      VariableCacheContext->VariableRuntimeNvCache.PendingUpdateLength = (UINT32)((UINTN)GetEndPointer (VariableCache) - (UINTN)VariableCache);
+      VariableCache                                                   = (VARIABLE_STORE_HEADER  *)(UINTN)mNvVariableCache;
+      VariableCacheContext->VariableRuntimeNvCache.PendingUpdateCount = 0;
+      AddPendingRuntimeVariableCacheUpdate (
+        &VariableCacheContext->VariableRuntimeNvCache,
+        0,
+        (UINTN)GetEndPointer (VariableCache) - (UINTN)VariableCache
+        );
       CopyGuid (&(VariableCacheContext->VariableRuntimeNvCache.Store->Signature), &(VariableCache->Signature));
 
       *(VariableCacheContext->PendingUpdate)    = TRUE;
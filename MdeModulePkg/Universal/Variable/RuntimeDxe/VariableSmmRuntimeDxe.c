@@ -25,6 +25,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/SmmVariable.h>
 #include <Protocol/VariableLock.h>
 #include <Protocol/VarCheck.h>
+#include <Protocol/VariableBatch.h>
+#include <Protocol/VariableEnumeration.h>
 
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
@@ -43,6 +45,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "PrivilegePolymorphic.h"
 #include "VariableParsing.h"
+#include "VariableIndex.h"
+#include "VariableCursor.h"
 
 EFI_HANDLE                      mHandle                    = NULL;
 EFI_SMM_VARIABLE_PROTOCOL       *mSmmVariable              = NULL;
@@ -57,8 +61,13 @@ BOOLEAN                         mVariableAuthFormat;
 EFI_LOCK                        mVariableServicesLock;
 EDKII_VARIABLE_LOCK_PROTOCOL    mVariableLock;
 EDKII_VAR_CHECK_PROTOCOL        mVarCheck;
-VARIABLE_RUNTIME_CACHE_INFO     mVariableRtCacheInfo;
-BOOLEAN                         mIsRuntimeCacheEnabled = FALSE;
+EDKII_VARIABLE_BATCH_PROTOCOL        mVariableBatch;
+EDKII_VARIABLE_ENUMERATION_PROTOCOL  mVariableEnumeration;
+VARIABLE_RUNTIME_CACHE_INFO          mVariableRtCacheInfo;
+BOOLEAN                              mIsRuntimeCacheEnabled = FALSE;
+VARIABLE_STORE_INDEX                 mVariableRtCacheIndex[VariableStoreTypeMax];
+UINT32                               mVariableRtCacheRewriteCount;
+VARIABLE_CURSOR_CONTEXT              mVariableRtCacheCursorContext;
 
 /**
   The logic to initialize the VariablePolicy engine is in its own file.
@@ -487,7 +496,8 @@ SyncRuntimeCache (
   Check whether a SMI must be triggered to retrieve pending cache updates.
 
   If the variable HOB was finished being flushed since the last check for a runtime cache update, this function
-  will prevent the HOB cache from being used for future runtime cache hits.
+  will prevent the HOB cache from being used for future runtime cache hits. If the stores were rewritten, the
+  indexes of the runtime caches and the last variable returned by GetNextVariableName() are invalidated.
 
 **/
 VOID
@@ -495,7 +505,8 @@ CheckForRuntimeCacheSync (
   VOID
   )
 {
-  CACHE_INFO_FLAG  *CacheInfoFlag;
+  CACHE_INFO_FLAG      *CacheInfoFlag;
+  VARIABLE_STORE_TYPE  StoreType;
 
   CacheInfoFlag = (CACHE_INFO_FLAG *)(UINTN)mVariableRtCacheInfo.CacheInfoFlagBuffer;
 
@@ -511,6 +522,20 @@ CheckForRuntimeCacheSync (
   if ((CacheInfoFlag->HobFlushComplete) && (mVariableRtCacheInfo.RuntimeHobCacheBuffer != 0)) {
     mVariableRtCacheInfo.RuntimeHobCacheBuffer = 0;
   }
+
+  //
+  // Variables were moved within the runtime caches since the previous lookup,
+  // so the indexes of the caches are rebuilt and the last variable returned
+  // by GetNextVariableName() is forgotten.
+  //
+  if (CacheInfoFlag->StoreRewriteCount != mVariableRtCacheRewriteCount) {
+    for (StoreType = (VARIABLE_STORE_TYPE)0; StoreType < VariableStoreTypeMax; StoreType++) {
+      ResetVariableStoreIndex (&mVariableRtCacheIndex[StoreType]);
+    }
+
+    InvalidateVariableCursors (&mVariableRtCacheCursorContext);
+    mVariableRtCacheRewriteCount = CacheInfoFlag->StoreRewriteCount;
+  }
 }
 
 /**
@@ -586,7 +611,14 @@ FindVariableInRuntimeCache (
       RtPtrTrack.EndPtr   = GetEndPointer (VariableStoreList[StoreType]);
       RtPtrTrack.Volatile = (BOOLEAN)(StoreType == VariableStoreTypeVolatile);
 
-      Status = FindVariableEx (VariableName, VendorGuid, FALSE, &RtPtrTrack, mVariableAuthFormat);
+      Status = FindVariableInStoreIndex (
+                 VariableName,
+                 VendorGuid,
+                 FALSE,
+                 &RtPtrTrack,
+                 mVariableAuthFormat,
+                 &mVariableRtCacheIndex[StoreType]
+                 );
       if (!EFI_ERROR (Status)) {
         break;
       }
@@ -867,13 +899,14 @@ GetNextVariableNameInRuntimeCache (
     VariableStoreHeader[VariableStoreTypeHob]      = (VARIABLE_STORE_HEADER *)(UINTN)mVariableRtCacheInfo.RuntimeHobCacheBuffer;
     VariableStoreHeader[VariableStoreTypeNv]       = (VARIABLE_STORE_HEADER *)(UINTN)mVariableRtCacheInfo.RuntimeNvCacheBuffer;
 
-    Status =  VariableServiceGetNextVariableInternal (
-                VariableName,
-                VendorGuid,
-                VariableStoreHeader,
-                &VariablePtr,
-                mVariableAuthFormat
-                );
+    Status = GetNextVariableByHint (
+               &mVariableRtCacheCursorContext,
+               VariableName,
+               VendorGuid,
+               VariableStoreHeader,
+               &VariablePtr,
+               mVariableAuthFormat
+               );
     if (!EFI_ERROR (Status)) {
       VarNameSize = NameSizeOfVariable (VariablePtr, mVariableAuthFormat);
       ASSERT (VarNameSize != 0);
@@ -1184,6 +1217,346 @@ Done:
   return Status;
 }
 
+/**
+  Set several variables in order with a single request to the variable driver.
+
+  The updates are packed into one SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH
+  request. The SMI handler undoes the updates it applied if one fails, and
+  returns the number of updates that may remain applied if an undo fails.
+
+  @param[in]      This          The EDKII_VARIABLE_BATCH_PROTOCOL instance.
+  @param[in]      EntryCount    Number of updates in Entries.
+  @param[in, out] Entries       The updates to apply. The Status field of each
+                                entry is updated on return.
+
+  @retval EFI_SUCCESS           All the updates were applied.
+  @retval EFI_INVALID_PARAMETER Entries is NULL and EntryCount is not 0.
+                                Or an entry has a NULL VariableName or VendorGuid,
+                                an empty VariableName, or a NULL Data and a DataSize
+                                that is not 0.
+                                Or two entries update the same variable.
+  @retval EFI_OUT_OF_RESOURCES  The updates do not fit in the communicate buffer,
+                                or the variable storage cannot hold them.
+  @retval EFI_ABORTED           An update failed and it or the updates applied
+                                before it could not all be undone.
+  @retval Others                The status of the update that failed.
+
+**/
+EFI_STATUS
+EFIAPI
+VariableBatchSetVariables (
+  IN     EDKII_VARIABLE_BATCH_PROTOCOL  *This,
+  IN     UINTN                          EntryCount,
+  IN OUT EDKII_VARIABLE_BATCH_ENTRY     *Entries
+  )
+{
+  EFI_STATUS                                   Status;
+  UINTN                                        Index;
+  UINTN                                        PayloadSize;
+  UINTN                                        RecordSize;
+  UINTN                                        VariableNameSize;
+  UINT8                                        *Record;
+  SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH  *VariableBatch;
+  SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE     *SmmVariableHeader;
+
+  if ((Entries == NULL) && (EntryCount != 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  for (Index = 0; Index < EntryCount; Index++) {
+    Entries[Index].Status = EFI_NOT_STARTED;
+  }
+
+  //
+  // Check input parameters of all the updates, and that all of them fit in
+  // one request.
+  //
+  PayloadSize = sizeof (SMM_VARIABLE_COMMUNICATE_SET_VARIABLE_BATCH);
+  for (Index = 0; Index < EntryCount; Index++) {
+    if ((Entries[Index].VariableName == NULL) || (Entries[Index].VariableName[0] == 0) || (Entries[Index].VendorGuid == NULL) ||
+        ((Entries[Index].DataSize != 0) && (Entries[Index].Data == NULL)))
+    {
+      Entries[Index].Status = EFI_INVALID_PARAMETER;
+      return EFI_INVALID_PARAMETER;
+    }
+
+    //
+    // If VariableName or DataSize exceeds SMM payload limit. Return failure
+    //
+    VariableNameSize = StrSize (Entries[Index].VariableName);
+    RecordSize       = OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + VariableNameSize;
+    if ((RecordSize > mVariableBufferPayloadSize - PayloadSize) ||
+        (Entries[Index].DataSize > mVariableBufferPayloadSize - PayloadSize - RecordSize) ||
+        (SMM_VARIABLE_BATCH_RECORD_SIZE (VariableNameSize, Entries[Index].DataSize) > mVariableBufferPayloadSize - PayloadSize))
+    {
+      Entries[Index].Status = EFI_OUT_OF_RESOURCES;
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    PayloadSize += SMM_VARIABLE_BATCH_RECORD_SIZE (VariableNameSize, Entries[Index].DataSize);
+  }
+
+  AcquireLockOnlyAtBootTime (&mVariableServicesLock);
+
+  //
+  // Init the communicate buffer. The buffer data size is:
+  // SMM_COMMUNICATE_HEADER_SIZE + SMM_VARIABLE_COMMUNICATE_HEADER_SIZE + PayloadSize.
+  //
+  VariableBatch = NULL;
+  Status        = InitCommunicateBuffer ((VOID **)&VariableBatch, PayloadSize, SMM_VARIABLE_FUNCTION_SET_VARIABLE_BATCH);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  ASSERT (VariableBatch != NULL);
+
+  ZeroMem (VariableBatch, PayloadSize);
+  VariableBatch->EntryCount   = EntryCount;
+  VariableBatch->FailedIndex  = EntryCount;
+  VariableBatch->AppliedCount = 0;
+  Record                     = (UINT8 *)(VariableBatch + 1);
+  for (Index = 0; Index < EntryCount; Index++) {
+    SmmVariableHeader = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *)Record;
+    CopyGuid (&SmmVariableHeader->Guid, Entries[Index].VendorGuid);
+    SmmVariableHeader->DataSize   = Entries[Index].DataSize;
+    SmmVariableHeader->NameSize   = StrSize (Entries[Index].VariableName);
+    SmmVariableHeader->Attributes = Entries[Index].Attributes;
+    CopyMem (SmmVariableHeader->Name, Entries[Index].VariableName, SmmVariableHeader->NameSize);
+    CopyMem ((UINT8 *)SmmVariableHeader->Name + SmmVariableHeader->NameSize, Entries[Index].Data, Entries[Index].DataSize);
+
+    Record += SMM_VARIABLE_BATCH_RECORD_SIZE (SmmVariableHeader->NameSize, SmmVariableHeader->DataSize);
+  }
+
+  //
+  // Send data to SMM.
+  //
+  Status = SendCommunicateBuffer (PayloadSize);
+  if (!EFI_ERROR (Status)) {
+    for (Index = 0; Index < EntryCount; Index++) {
+      Entries[Index].Status = EFI_SUCCESS;
+    }
+  } else if (VariableBatch->FailedIndex < EntryCount) {
+    Entries[VariableBatch->FailedIndex].Status = Status;
+    if (VariableBatch->AppliedCount != 0) {
+      //
+      // The rollback stopped at a failed undo, and the first updates remain
+      // applied. The update that failed may remain applied too.
+      //
+      for (Index = 0; (Index < VariableBatch->AppliedCount) && (Index < VariableBatch->FailedIndex); Index++) {
+        Entries[Index].Status = EFI_SUCCESS;
+      }
+
+      Status = EFI_ABORTED;
+    }
+  }
+
+Done:
+  ReleaseLockOnlyAtBootTime (&mVariableServicesLock);
+
+  if (!EfiAtRuntime ()) {
+    for (Index = 0; Index < EntryCount; Index++) {
+      if (Entries[Index].Status == EFI_SUCCESS) {
+        SecureBootHook (
+          Entries[Index].VariableName,
+          Entries[Index].VendorGuid
+          );
+      }
+    }
+  }
+
+  return Status;
+}
+
+/**
+  Return the name and GUID of the variable at a cursor, and advance the cursor
+  to the next variable.
+
+  @param[in]      This              The EDKII_VARIABLE_ENUMERATION_PROTOCOL instance.
+  @param[in, out] Cursor            On input, EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor
+                                    returned by this protocol. On output, the cursor of the next
+                                    variable if EFI_SUCCESS is returned.
+  @param[in, out] VariableNameSize  On input, the size of the VariableName buffer. On output, the
+                                    size of the name of the variable.
+  @param[out]     VariableName      Returns the Null-terminated name of the variable.
+  @param[out]     VendorGuid        Returns the vendor GUID of the variable.
+  @param[out]     Attributes        Returns the attributes of the variable. Optional.
+
+  @retval EFI_SUCCESS               The variable was returned and Cursor was advanced.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_BUFFER_TOO_SMALL      VariableNameSize is too small for the name. VariableNameSize
+                                    has been updated with the size needed, Cursor is unchanged.
+  @retval EFI_INVALID_PARAMETER     Cursor, VariableNameSize, VariableName or VendorGuid is NULL.
+                                    Or Cursor is not a cursor of the current variable stores.
+
+**/
+EFI_STATUS
+EFIAPI
+VariableEnumerationGetNextVariableName (
+  IN     EDKII_VARIABLE_ENUMERATION_PROTOCOL  *This,
+  IN OUT UINT64                               *Cursor,
+  IN OUT UINTN                                *VariableNameSize,
+  OUT    CHAR16                               *VariableName,
+  OUT    EFI_GUID                             *VendorGuid,
+  OUT    UINT32                               *Attributes OPTIONAL
+  )
+{
+  EFI_STATUS                                            Status;
+  UINTN                                                 PayloadSize;
+  UINTN                                                 OutVariableNameSize;
+  SMM_VARIABLE_COMMUNICATE_GET_NEXT_VARIABLE_BY_CURSOR  *SmmGetNextVariableByCursor;
+
+  if ((Cursor == NULL) || (VariableNameSize == NULL) || (VariableName == NULL) || (VendorGuid == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // The name is truncated to the payload limit, the size needed is returned
+  // by EFI_BUFFER_TOO_SMALL as for GetNextVariableName().
+  //
+  OutVariableNameSize = MIN (*VariableNameSize, mVariableBufferPayloadSize - OFFSET_OF (SMM_VARIABLE_COMMUNICATE_GET_NEXT_VARIABLE_BY_CURSOR, Name));
+  PayloadSize         = OFFSET_OF (SMM_VARIABLE_COMMUNICATE_GET_NEXT_VARIABLE_BY_CURSOR, Name) + OutVariableNameSize;
+
+  AcquireLockOnlyAtBootTime (&mVariableServicesLock);
+
+  //
+  // Init the communicate buffer. The buffer data size is:
+  // SMM_COMMUNICATE_HEADER_SIZE + SMM_VARIABLE_COMMUNICATE_HEADER_SIZE + PayloadSize.
+  //
+  SmmGetNextVariableByCursor = NULL;
+  Status                     = InitCommunicateBuffer ((VOID **)&SmmGetNextVariableByCursor, PayloadSize, SMM_VARIABLE_FUNCTION_GET_NEXT_VARIABLE_BY_CURSOR);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  ASSERT (SmmGetNextVariableByCursor != NULL);
+
+  SmmGetNextVariableByCursor->Cursor     = *Cursor;
+  SmmGetNextVariableByCursor->NameSize   = OutVariableNameSize;
+  SmmGetNextVariableByCursor->Attributes = 0;
+
+  //
+  // Send data to SMM.
+  //
+  Status = SendCommunicateBuffer (PayloadSize);
+
+  //
+  // Get data from SMM.
+  //
+  if ((Status == EFI_SUCCESS) || (Status == EFI_BUFFER_TOO_SMALL)) {
+    *VariableNameSize = SmmGetNextVariableByCursor->NameSize;
+  }
+
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  *Cursor = SmmGetNextVariableByCursor->Cursor;
+  CopyGuid (VendorGuid, &SmmGetNextVariableByCursor->Guid);
+  CopyMem (VariableName, SmmGetNextVariableByCursor->Name, SmmGetNextVariableByCursor->NameSize);
+  if (Attributes != NULL) {
+    *Attributes = SmmGetNextVariableByCursor->Attributes;
+  }
+
+Done:
+  ReleaseLockOnlyAtBootTime (&mVariableServicesLock);
+  return Status;
+}
+
+/**
+  Return packed EDKII_VARIABLE_ENUMERATION_RECORD records of the variables from
+  a cursor, as many as Buffer holds, and advance the cursor past them.
+
+  The records are returned by one SMM_VARIABLE_FUNCTION_GET_VARIABLE_RECORDS
+  request, so they are limited to the size of the communicate buffer.
+
+  @param[in]      This              The EDKII_VARIABLE_ENUMERATION_PROTOCOL instance.
+  @param[in, out] Cursor            On input, EDKII_VARIABLE_ENUMERATION_CURSOR_START or a cursor
+                                    returned by this protocol. On output, the cursor of the variable
+                                    following the last record if EFI_SUCCESS is returned.
+  @param[in, out] BufferSize        On input, the size of Buffer. On output, the size of the records
+                                    returned, or the size of the first record if EFI_BUFFER_TOO_SMALL
+                                    is returned.
+  @param[out]     Buffer            Returns the records.
+
+  @retval EFI_SUCCESS               At least one record was returned and Cursor was advanced.
+  @retval EFI_NOT_FOUND             There are no more variables.
+  @retval EFI_BUFFER_TOO_SMALL      Buffer cannot hold the first record. Cursor is unchanged.
+  @retval EFI_OUT_OF_RESOURCES      The first record is larger than the communicate buffer can hold.
+  @retval EFI_INVALID_PARAMETER     Cursor, BufferSize or Buffer is NULL.
+                                    Or Cursor is not a cursor of the current variable stores.
+
+**/
+EFI_STATUS
+EFIAPI
+VariableEnumerationGetVariableRecords (
+  IN     EDKII_VARIABLE_ENUMERATION_PROTOCOL  *This,
+  IN OUT UINT64                               *Cursor,
+  IN OUT UINTN                                *BufferSize,
+  OUT    VOID                                 *Buffer
+  )
+{
+  EFI_STATUS                                     Status;
+  UINTN                                          PayloadSize;
+  UINTN                                          RecordsSize;
+  UINTN                                          MaxRecordsSize;
+  SMM_VARIABLE_COMMUNICATE_GET_VARIABLE_RECORDS  *SmmGetVariableRecords;
+
+  if ((Cursor == NULL) || (BufferSize == NULL) || (Buffer == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  MaxRecordsSize = mVariableBufferPayloadSize - OFFSET_OF (SMM_VARIABLE_COMMUNICATE_GET_VARIABLE_RECORDS, Records);
+  RecordsSize    = MIN (*BufferSize, MaxRecordsSize);
+  PayloadSize = OFFSET_OF (SMM_VARIABLE_COMMUNICATE_GET_VARIABLE_RECORDS, Records) + RecordsSize;
+
+  AcquireLockOnlyAtBootTime (&mVariableServicesLock);
+
+  //
+  // Init the communicate buffer. The buffer data size is:
+  // SMM_COMMUNICATE_HEADER_SIZE + SMM_VARIABLE_COMMUNICATE_HEADER_SIZE + PayloadSize.
+  //
+  SmmGetVariableRecords = NULL;
+  Status                = InitCommunicateBuffer ((VOID **)&SmmGetVariableRecords, PayloadSize, SMM_VARIABLE_FUNCTION_GET_VARIABLE_RECORDS);
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  ASSERT (SmmGetVariableRecords != NULL);
+
+  SmmGetVariableRecords->Cursor      = *Cursor;
+  SmmGetVariableRecords->RecordsSize = RecordsSize;
+
+  //
+  // Send data to SMM.
+  //
+  Status = SendCommunicateBuffer (PayloadSize);
+  if ((Status == EFI_BUFFER_TOO_SMALL) && (SmmGetVariableRecords->RecordsSize > MaxRecordsSize)) {
+    //
+    // No buffer size lets the communicate buffer hold the first record.
+    //
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+
+  //
+  // Get data from SMM.
+  //
+  if ((Status == EFI_SUCCESS) || (Status == EFI_BUFFER_TOO_SMALL)) {
+    *BufferSize = SmmGetVariableRecords->RecordsSize;
+  }
+
+  if (EFI_ERROR (Status)) {
+    goto Done;
+  }
+
+  *Cursor = SmmGetVariableRecords->Cursor;
+  CopyMem (Buffer, SmmGetVariableRecords->Records, SmmGetVariableRecords->RecordsSize);
+
+Done:
+  ReleaseLockOnlyAtBootTime (&mVariableServicesLock);
+  return Status;
+}
+
 /**
   This code returns information about the EFI variables.
 
@@ -1342,12 +1715,17 @@ VariableAddressChangeEvent (
   IN VOID       *Context
   )
 {
+  VARIABLE_STORE_TYPE  StoreType;
+
   EfiConvertPointer (0x0, (VOID **)&mVariableBuffer);
   EfiConvertPointer (0x0, (VOID **)&mMmCommunication2);
   EfiConvertPointer (EFI_OPTIONAL_PTR, (VOID **)&mVariableRtCacheInfo.CacheInfoFlagBuffer);
   EfiConvertPointer (EFI_OPTIONAL_PTR, (VOID **)&mVariableRtCacheInfo.RuntimeHobCacheBuffer);
   EfiConvertPointer (EFI_OPTIONAL_PTR, (VOID **)&mVariableRtCacheInfo.RuntimeNvCacheBuffer);
   EfiConvertPointer (EFI_OPTIONAL_PTR, (VOID **)&mVariableRtCacheInfo.RuntimeVolatileCacheBuffer);
+  for (StoreType = (VARIABLE_STORE_TYPE)0; StoreType < VariableStoreTypeMax; StoreType++) {
+    EfiConvertPointer (EFI_OPTIONAL_PTR, (VOID **)&mVariableRtCacheIndex[StoreType].Entries);
+  }
 }
 
 /**
@@ -1578,6 +1956,16 @@ InitVariableCache (
     InitVariableStoreHeader ((VOID *)(UINTN)mVariableRtCacheInfo.RuntimeHobCacheBuffer, AllocatedHobCacheSize);
     InitVariableStoreHeader ((VOID *)(UINTN)mVariableRtCacheInfo.RuntimeNvCacheBuffer, AllocatedNvCacheSize);
     InitVariableStoreHeader ((VOID *)(UINTN)mVariableRtCacheInfo.RuntimeVolatileCacheBuffer, AllocatedVolatileCacheSize);
+
+    //
+    // Allocate the hash indexes of the runtime caches. A cache whose index
+    // could not be allocated is searched header by header.
+    //
+    if (FeaturePcdGet (PcdVariableStoreIndex)) {
+      InitializeVariableStoreIndex (&mVariableRtCacheIndex[VariableStoreTypeHob], AllocatedHobCacheSize);
+      InitializeVariableStoreIndex (&mVariableRtCacheIndex[VariableStoreTypeNv], AllocatedNvCacheSize);
+      InitializeVariableStoreIndex (&mVariableRtCacheIndex[VariableStoreTypeVolatile], AllocatedVolatileCacheSize);
+    }
   }
 
   return Status;
@@ -1634,6 +2022,7 @@ SendRuntimeVariableCacheContextToSmm (
   SmmRuntimeVarCacheContext->PendingUpdate        = &((CACHE_INFO_FLAG *)(UINTN)mVariableRtCacheInfo.CacheInfoFlagBuffer)->PendingUpdate;
   SmmRuntimeVarCacheContext->ReadLock             = &((CACHE_INFO_FLAG *)(UINTN)mVariableRtCacheInfo.CacheInfoFlagBuffer)->ReadLock;
   SmmRuntimeVarCacheContext->HobFlushComplete     = &((CACHE_INFO_FLAG *)(UINTN)mVariableRtCacheInfo.CacheInfoFlagBuffer)->HobFlushComplete;
+  SmmRuntimeVarCacheContext->StoreRewriteCount    = &((CACHE_INFO_FLAG *)(UINTN)mVariableRtCacheInfo.CacheInfoFlagBuffer)->StoreRewriteCount;
 
   //
   // Send data to SMM.
@@ -1752,6 +2141,27 @@ SmmVariableReady (
                                                      );
   ASSERT_EFI_ERROR (Status);
 
+  mVariableBatch.Revision     = EDKII_VARIABLE_BATCH_PROTOCOL_REVISION;
+  mVariableBatch.SetVariables = VariableBatchSetVariables;
+  Status                      = gBS->InstallMultipleProtocolInterfaces (
+                                       &mHandle,
+                                       &gEdkiiVariableBatchProtocolGuid,
+                                       &mVariableBatch,
+                                       NULL
+                                       );
+  ASSERT_EFI_ERROR (Status);
+
+  mVariableEnumeration.Revision            = EDKII_VARIABLE_ENUMERATION_PROTOCOL_REVISION;
+  mVariableEnumeration.GetNextVariableName = VariableEnumerationGetNextVariableName;
+  mVariableEnumeration.GetVariableRecords  = VariableEnumerationGetVariableRecords;
+  Status                                   = gBS->InstallMultipleProtocolInterfaces (
+                                                    &mHandle,
+                                                    &gEdkiiVariableEnumerationProtocolGuid,
+                                                    &mVariableEnumeration,
+                                                    NULL
+                                                    );
+  ASSERT_EFI_ERROR (Status);
+
   gBS->CloseEvent (Event);
 }
 
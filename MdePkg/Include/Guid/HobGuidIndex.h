@@ -0,0 +1,63 @@
+/** @file
+  Definitions of the GUID HOB index table.
+
+  The DXE core may install an index of the GUID extension HOBs of the HOB
+  list as a configuration table. HOB library instances consult it to look up
+  GUID HOBs with a binary search, instead of walking the whole HOB list, and
+  walk the HOB list when the table is not installed.
+
+  The index holds one entry for each GUID extension HOB, sorted by the bytes
+  of the HOB GUID, then by the address of the HOB. The entries of the HOBs of
+  the same GUID are therefore in the order of the HOB list.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __HOB_GUID_INDEX_H__
+#define __HOB_GUID_INDEX_H__
+
+#define EDKII_HOB_GUID_INDEX_TABLE_GUID \
+  { \
+    0x62820e88, 0xe087, 0x4095, { 0xa7, 0x94, 0x1a, 0x4e, 0xab, 0xe9, 0x99, 0x44 } \
+  }
+
+#define EDKII_HOB_GUID_INDEX_TABLE_SIGNATURE  SIGNATURE_32 ('H', 'G', 'I', 'X')
+#define EDKII_HOB_GUID_INDEX_TABLE_VERSION    1
+
+typedef struct {
+  ///
+  /// The GUID of the HOB
+  ///
+  EFI_GUID    Name;
+  ///
+  /// The address of the HOB
+  ///
+  UINT64      Hob;
+} EDKII_HOB_GUID_INDEX_ENTRY;
+
+typedef struct {
+  UINT32    Signature;
+  UINT32    Version;
+  UINT32    HeaderSize;
+  UINT32    EntrySize;
+  ///
+  /// The address of the HOB list that is indexed, i.e. of its PHIT HOB
+  ///
+  UINT64    HobList;
+  ///
+  /// The address of the end of HOB list HOB of the HOB list
+  ///
+  UINT64    EndOfHobList;
+  ///
+  /// Number of entries that follow the header
+  ///
+  UINT32    EntryCount;
+  UINT32    Reserved;
+  // EDKII_HOB_GUID_INDEX_ENTRY  Entry[EntryCount];
+} EDKII_HOB_GUID_INDEX_TABLE;
+
+extern EFI_GUID  gEdkiiHobGuidIndexTableGuid;
+
+#endif
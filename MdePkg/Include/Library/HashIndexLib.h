@@ -0,0 +1,187 @@
+/** @file
+  A hash index library interface.
+
+  The library class maintains intrusive, fixed-size hash indexes over
+  caller-owned structures. The caller embeds a HASH_INDEX_ENTRY in each
+  structure that is to be indexed and supplies the bucket array, so the
+  library never allocates memory and can be used from any phase, including
+  the DXE, SMM and Standalone MM cores.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __HASH_INDEX_LIB_H__
+#define __HASH_INDEX_LIB_H__
+
+#include <Base.h>
+
+///
+/// Link embedded in every structure that is placed into a hash index.
+///
+typedef struct {
+  LIST_ENTRY    Link;
+  UINTN         Hash;
+} HASH_INDEX_ENTRY;
+
+///
+/// A hash index. BucketCount must be a power of two. A HASH_INDEX whose
+/// buckets are all zero (e.g. a global declared with HASH_INDEX_INITIALIZER)
+/// is initialized on first use.
+///
+typedef struct {
+  LIST_ENTRY    *Buckets;
+  UINTN         BucketCount;
+  UINTN         Count;
+} HASH_INDEX;
+
+///
+/// Static initializer for a HASH_INDEX backed by a global LIST_ENTRY array.
+///
+#define HASH_INDEX_INITIALIZER(BucketArray)  { (BucketArray), ARRAY_SIZE (BucketArray), 0 }
+
+/**
+  Initialize a hash index over a caller supplied bucket array.
+
+  If Index is NULL, then ASSERT().
+  If Buckets is NULL, then ASSERT().
+  If BucketCount is not a power of two, then ASSERT().
+
+  @param[out] Index        The hash index to initialize.
+  @param[in]  Buckets      Array of BucketCount list heads owned by the caller.
+  @param[in]  BucketCount  The number of buckets.
+
+**/
+VOID
+EFIAPI
+HashIndexInitialize (
+  OUT HASH_INDEX  *Index,
+  IN  LIST_ENTRY  *Buckets,
+  IN  UINTN       BucketCount
+  );
+
+/**
+  Compute the hash value of a GUID.
+
+  @param[in] Guid  The GUID to hash.
+
+  @return The hash value.
+
+**/
+UINTN
+EFIAPI
+HashIndexGuid (
+  IN CONST GUID  *Guid
+  );
+
+/**
+  Compute the hash value of a pointer value.
+
+  @param[in] Pointer  The pointer to hash. The memory it points to is not
+                      accessed.
+
+  @return The hash value.
+
+**/
+UINTN
+EFIAPI
+HashIndexPointer (
+  IN CONST VOID  *Pointer
+  );
+
+/**
+  Compute a 64-bit hash value of the contents of a buffer.
+
+  The hash is meant to tell buffers apart with a low probability of accidental
+  collisions where a 32-bit CRC is too weak. It is not a cryptographic hash and
+  must not be used to authenticate data.
+
+  If Length is not zero and Buffer is NULL, then ASSERT().
+
+  @param[in] Buffer  The buffer to hash.
+  @param[in] Length  The size of Buffer in bytes.
+
+  @return The 64-bit hash value.
+
+**/
+UINT64
+EFIAPI
+HashIndexBuffer64 (
+  IN CONST VOID  *Buffer,
+  IN UINTN       Length
+  );
+
+/**
+  Insert an entry into a hash index.
+
+  If Index is NULL, then ASSERT().
+  If Entry is NULL, then ASSERT().
+
+  @param[in, out] Index  The hash index.
+  @param[in, out] Entry  The entry embedded in the structure being indexed.
+  @param[in]      Hash   The hash value of the key of the structure.
+
+**/
+VOID
+EFIAPI
+HashIndexInsert (
+  IN OUT HASH_INDEX        *Index,
+  IN OUT HASH_INDEX_ENTRY  *Entry,
+  IN     UINTN             Hash
+  );
+
+/**
+  Remove an entry from the hash index it was inserted into.
+
+  If Index is NULL, then ASSERT().
+  If Entry is NULL, then ASSERT().
+
+  @param[in, out] Index  The hash index.
+  @param[in, out] Entry  The entry to remove.
+
+**/
+VOID
+EFIAPI
+HashIndexRemove (
+  IN OUT HASH_INDEX        *Index,
+  IN OUT HASH_INDEX_ENTRY  *Entry
+  );
+
+/**
+  Return the first entry in the hash index whose hash value equals Hash.
+
+  Entries sharing a hash value are not necessarily equal, so the caller must
+  compare the full key of the returned structure.
+
+  @param[in] Index  The hash index.
+  @param[in] Hash   The hash value to look up.
+
+  @return The first matching entry, or NULL if there is none.
+
+**/
+HASH_INDEX_ENTRY *
+EFIAPI
+HashIndexGetFirst (
+  IN HASH_INDEX  *Index,
+  IN UINTN       Hash
+  );
+
+/**
+  Return the next entry following Entry that has the same hash value.
+
+  @param[in] Index  The hash index.
+  @param[in] Entry  An entry previously returned by HashIndexGetFirst() or
+                    HashIndexGetNext().
+
+  @return The next matching entry, or NULL if there is none.
+
+**/
+HASH_INDEX_ENTRY *
+EFIAPI
+HashIndexGetNext (
+  IN HASH_INDEX        *Index,
+  IN HASH_INDEX_ENTRY  *Entry
+  );
+
+#endif
@@ -0,0 +1,337 @@
+/** @file
+  Intrusive, fixed-size hash index over caller-owned structures.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/HashIndexLib.h>
+
+#define HASH_INDEX_MURMUR64_MULTIPLIER  0xC6A4A7935BD1E995ULL
+
+/**
+  Final avalanche step of MurmurHash3, spreading every input bit over the
+  whole 32-bit result so that the low bits used for bucket selection are
+  well distributed even for aligned pointers.
+
+  @param[in] Value  The value to mix.
+
+  @return The mixed value.
+
+**/
+STATIC
+UINT32
+HashIndexMix32 (
+  IN UINT32  Value
+  )
+{
+  Value ^= Value >> 16;
+  Value *= 0x85EBCA6B;
+  Value ^= Value >> 13;
+  Value *= 0xC2B2AE35;
+  Value ^= Value >> 16;
+  return Value;
+}
+
+/**
+  Initialize the buckets of an index declared with HASH_INDEX_INITIALIZER
+  if this is its first use.
+
+  @param[in, out] Index  The hash index.
+
+**/
+STATIC
+VOID
+HashIndexCheckInitialized (
+  IN OUT HASH_INDEX  *Index
+  )
+{
+  ASSERT (Index != NULL);
+  ASSERT (Index->Buckets != NULL);
+
+  if (Index->Buckets[0].ForwardLink == NULL) {
+    HashIndexInitialize (Index, Index->Buckets, Index->BucketCount);
+  }
+}
+
+/**
+  Return the bucket that holds entries with the given hash value.
+
+  @param[in] Index  The hash index.
+  @param[in] Hash   The hash value.
+
+  @return The list head of the bucket.
+
+**/
+STATIC
+LIST_ENTRY *
+HashIndexBucket (
+  IN HASH_INDEX  *Index,
+  IN UINTN       Hash
+  )
+{
+  return &Index->Buckets[Hash & (Index->BucketCount - 1)];
+}
+
+/**
+  Initialize a hash index over a caller supplied bucket array.
+
+  If Index is NULL, then ASSERT().
+  If Buckets is NULL, then ASSERT().
+  If BucketCount is not a power of two, then ASSERT().
+
+  @param[out] Index        The hash index to initialize.
+  @param[in]  Buckets      Array of BucketCount list heads owned by the caller.
+  @param[in]  BucketCount  The number of buckets.
+
+**/
+VOID
+EFIAPI
+HashIndexInitialize (
+  OUT HASH_INDEX  *Index,
+  IN  LIST_ENTRY  *Buckets,
+  IN  UINTN       BucketCount
+  )
+{
+  UINTN  BucketIndex;
+
+  ASSERT (Index != NULL);
+  ASSERT (Buckets != NULL);
+  ASSERT (BucketCount != 0);
+  ASSERT ((BucketCount & (BucketCount - 1)) == 0);
+
+  Index->Buckets     = Buckets;
+  Index->BucketCount = BucketCount;
+  Index->Count       = 0;
+
+  for (BucketIndex = 0; BucketIndex < BucketCount; BucketIndex++) {
+    InitializeListHead (&Buckets[BucketIndex]);
+  }
+}
+
+/**
+  Compute the hash value of a GUID.
+
+  @param[in] Guid  The GUID to hash.
+
+  @return The hash value.
+
+**/
+UINTN
+EFIAPI
+HashIndexGuid (
+  IN CONST GUID  *Guid
+  )
+{
+  CONST UINT32  *Data;
+  UINT32        Hash;
+
+  ASSERT (Guid != NULL);
+
+  Data = (CONST UINT32 *)Guid;
+  Hash = ReadUnaligned32 (&Data[0]) ^
+         LRotU32 (ReadUnaligned32 (&Data[1]), 8) ^
+         LRotU32 (ReadUnaligned32 (&Data[2]), 16) ^
+         LRotU32 (ReadUnaligned32 (&Data[3]), 24);
+
+  return HashIndexMix32 (Hash);
+}
+
+/**
+  Compute the hash value of a pointer value.
+
+  @param[in] Pointer  The pointer to hash. The memory it points to is not
+                      accessed.
+
+  @return The hash value.
+
+**/
+UINTN
+EFIAPI
+HashIndexPointer (
+  IN CONST VOID  *Pointer
+  )
+{
+  UINT64  Value;
+
+  Value = (UINT64)(UINTN)Pointer;
+  return HashIndexMix32 ((UINT32)Value ^ (UINT32)RShiftU64 (Value, 32));
+}
+
+/**
+  Compute a 64-bit hash value of the contents of a buffer.
+
+  The hash is MurmurHash64A with a seed of 0.  It is not a cryptographic hash
+  and must not be used to authenticate data.
+
+  If Length is not zero and Buffer is NULL, then ASSERT().
+
+  @param[in] Buffer  The buffer to hash.
+  @param[in] Length  The size of Buffer in bytes.
+
+  @return The 64-bit hash value.
+
+**/
+UINT64
+EFIAPI
+HashIndexBuffer64 (
+  IN CONST VOID  *Buffer,
+  IN UINTN       Length
+  )
+{
+  CONST UINT8  *Data;
+  UINT64       Hash;
+  UINT64       Value;
+  UINTN        Index;
+
+  ASSERT (Buffer != NULL || Length == 0);
+
+  Data = (CONST UINT8 *)Buffer;
+  Hash = MultU64x64 ((UINT64)Length, HASH_INDEX_MURMUR64_MULTIPLIER);
+
+  for ( ; Length >= sizeof (UINT64); Length -= sizeof (UINT64), Data += sizeof (UINT64)) {
+    Value = MultU64x64 (ReadUnaligned64 ((CONST UINT64 *)Data), HASH_INDEX_MURMUR64_MULTIPLIER);
+    Value = MultU64x64 (Value ^ RShiftU64 (Value, 47), HASH_INDEX_MURMUR64_MULTIPLIER);
+    Hash  = MultU64x64 (Hash ^ Value, HASH_INDEX_MURMUR64_MULTIPLIER);
+  }
+
+  if (Length != 0) {
+    Value = 0;
+    for (Index = Length; Index > 0; Index--) {
+      Value = LShiftU64 (Value, 8) | Data[Index - 1];
+    }
+
+    Hash = MultU64x64 (Hash ^ Value, HASH_INDEX_MURMUR64_MULTIPLIER);
+  }
+
+  Hash ^= RShiftU64 (Hash, 47);
+  Hash  = MultU64x64 (Hash, HASH_INDEX_MURMUR64_MULTIPLIER);
+  return Hash ^ RShiftU64 (Hash, 47);
+}
+
+/**
+  Insert an entry into a hash index.
+
+  If Index is NULL, then ASSERT().
+  If Entry is NULL, then ASSERT().
+
+  @param[in, out] Index  The hash index.
+  @param[in, out] Entry  The entry embedded in the structure being indexed.
+  @param[in]      Hash   The hash value of the key of the structure.
+
+**/
+VOID
+EFIAPI
+HashIndexInsert (
+  IN OUT HASH_INDEX        *Index,
+  IN OUT HASH_INDEX_ENTRY  *Entry,
+  IN     UINTN             Hash
+  )
+{
+  ASSERT (Entry != NULL);
+  HashIndexCheckInitialized (Index);
+
+  Entry->Hash = Hash;
+  InsertHeadList (HashIndexBucket (Index, Hash), &Entry->Link);
+  Index->Count++;
+}
+
+/**
+  Remove an entry from the hash index it was inserted into.
+
+  If Index is NULL, then ASSERT().
+  If Entry is NULL, then ASSERT().
+
+  @param[in, out] Index  The hash index.
+  @param[in, out] Entry  The entry to remove.
+
+**/
+VOID
+EFIAPI
+HashIndexRemove (
+  IN OUT HASH_INDEX        *Index,
+  IN OUT HASH_INDEX_ENTRY  *Entry
+  )
+{
+  ASSERT (Index != NULL);
+  ASSERT (Entry != NULL);
+  ASSERT (Index->Count > 0);
+
+  RemoveEntryList (&Entry->Link);
+  Index->Count--;
+}
+
+/**
+  Return the first entry in the hash index whose hash value equals Hash.
+
+  Entries sharing a hash value are not necessarily equal, so the caller must
+  compare the full key of the returned structure.
+
+  @param[in] Index  The hash index.
+  @param[in] Hash   The hash value to look up.
+
+  @return The first matching entry, or NULL if there is none.
+
+**/
+HASH_INDEX_ENTRY *
+EFIAPI
+HashIndexGetFirst (
+  IN HASH_INDEX  *Index,
+  IN UINTN       Hash
+  )
+{
+  LIST_ENTRY        *Bucket;
+  LIST_ENTRY        *Link;
+  HASH_INDEX_ENTRY  *Entry;
+
+  HashIndexCheckInitialized (Index);
+
+  Bucket = HashIndexBucket (Index, Hash);
+  for (Link = Bucket->ForwardLink; Link != Bucket; Link = Link->ForwardLink) {
+    Entry = BASE_CR (Link, HASH_INDEX_ENTRY, Link);
+    if (Entry->Hash == Hash) {
+      return Entry;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Return the next entry following Entry that has the same hash value.
+
+  @param[in] Index  The hash index.
+  @param[in] Entry  An entry previously returned by HashIndexGetFirst() or
+                    HashIndexGetNext().
+
+  @return The next matching entry, or NULL if there is none.
+
+**/
+HASH_INDEX_ENTRY *
+EFIAPI
+HashIndexGetNext (
+  IN HASH_INDEX        *Index,
+  IN HASH_INDEX_ENTRY  *Entry
+  )
+{
+  LIST_ENTRY        *Bucket;
+  LIST_ENTRY        *Link;
+  HASH_INDEX_ENTRY  *Next;
+
+  ASSERT (Index != NULL);
+  ASSERT (Entry != NULL);
+
+  Bucket = HashIndexBucket (Index, Entry->Hash);
+  for (Link = Entry->Link.ForwardLink; Link != Bucket; Link = Link->ForwardLink) {
+    Next = BASE_CR (Link, HASH_INDEX_ENTRY, Link);
+    if (Next->Hash == Entry->Hash) {
+      return Next;
+    }
+  }
+
+  return NULL;
+}
@@ -9,13 +9,16 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <PiDxe.h>
 
 #include <Guid/HobList.h>
+#include <Guid/HobGuidIndex.h>
 
 #include <Library/HobLib.h>
 #include <Library/UefiLib.h>
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
 
-VOID  *mHobList = NULL;
+VOID                        *mHobList            = NULL;
+EDKII_HOB_GUID_INDEX_TABLE  *mHobGuidIndex       = NULL;
+BOOLEAN                     mHobGuidIndexChecked = FALSE;
 
 /**
   Returns the pointer to the HOB list.
@@ -52,6 +55,103 @@ GetHobList (
   return mHobList;
 }
 
+/**
+  Returns the GUID HOB index table installed by the DXE core for the HOB list.
+
+  This function also caches the pointer to the table retrieved.
+
+  @return The GUID HOB index table, or NULL if the HOB list is not indexed.
+
+**/
+STATIC
+EDKII_HOB_GUID_INDEX_TABLE *
+GetHobGuidIndex (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  EDKII_HOB_GUID_INDEX_TABLE  *Index;
+
+  if (!mHobGuidIndexChecked) {
+    mHobGuidIndexChecked = TRUE;
+    Status               = EfiGetSystemConfigurationTable (&gEdkiiHobGuidIndexTableGuid, (VOID **)&Index);
+    if (!EFI_ERROR (Status) &&
+        (Index->Signature == EDKII_HOB_GUID_INDEX_TABLE_SIGNATURE) &&
+        (Index->Version == EDKII_HOB_GUID_INDEX_TABLE_VERSION) &&
+        (Index->EntrySize >= sizeof (EDKII_HOB_GUID_INDEX_ENTRY)) &&
+        (Index->HobList == (UINTN)GetHobList ()))
+    {
+      mHobGuidIndex = Index;
+    }
+  }
+
+  return mHobGuidIndex;
+}
+
+/**
+  Looks up the first instance of the matched GUID HOB from the starting HOB
+  in the GUID HOB index table.
+
+  @param  Index         The GUID HOB index table.
+  @param  Guid          The GUID to match with in the HOB list.
+  @param  HobStart      A pointer to a HOB of the indexed HOB list.
+
+  @return The next instance of the matched GUID HOB from the starting HOB.
+
+**/
+STATIC
+VOID *
+LookupGuidHobIndex (
+  IN CONST EDKII_HOB_GUID_INDEX_TABLE  *Index,
+  IN CONST EFI_GUID                    *Guid,
+  IN CONST VOID                        *HobStart
+  )
+{
+  CONST UINT8                       *Entries;
+  CONST EDKII_HOB_GUID_INDEX_ENTRY  *Entry;
+  EFI_PEI_HOB_POINTERS              GuidHob;
+  UINTN                             Low;
+  UINTN                             High;
+  UINTN                             Middle;
+  INTN                              Result;
+
+  Entries = (CONST UINT8 *)Index + Index->HeaderSize;
+
+  //
+  // Find the first entry of the GUID at or after HobStart
+  //
+  Low  = 0;
+  High = Index->EntryCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    Entry  = (CONST EDKII_HOB_GUID_INDEX_ENTRY *)(Entries + Middle * Index->EntrySize);
+    Result = CompareMem (&Entry->Name, Guid, sizeof (EFI_GUID));
+    if ((Result < 0) || ((Result == 0) && (Entry->Hob < (UINTN)HobStart))) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  //
+  // Skip the HOBs that were changed since the index was built, e.g. marked
+  // as unused
+  //
+  for ( ; Low < Index->EntryCount; Low++) {
+    Entry = (CONST EDKII_HOB_GUID_INDEX_ENTRY *)(Entries + Low * Index->EntrySize);
+    if (!CompareGuid (&Entry->Name, Guid)) {
+      break;
+    }
+
+    GuidHob.Raw = (UINT8 *)(UINTN)Entry->Hob;
+    if ((GuidHob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) && CompareGuid (Guid, &GuidHob.Guid->Name)) {
+      return GuidHob.Raw;
+    }
+  }
+
+  return NULL;
+}
+
 /**
   The constructor function caches the pointer to HOB list by calling GetHobList()
   and will always return EFI_SUCCESS.
@@ -154,6 +254,8 @@ GetFirstHob (
   In contrast with macro GET_NEXT_HOB(), this function does not skip the starting HOB pointer
   unconditionally: it returns HobStart back if HobStart itself meets the requirement;
   caller is required to use GET_NEXT_HOB() if it wishes to skip current HobStart.
+  The GUID HOB index table installed by the DXE core is used to look up the HOBs
+  of the HOB list, if it is available.
 
   If Guid is NULL, then ASSERT().
   If HobStart is NULL, then ASSERT().
@@ -171,7 +273,13 @@ GetNextGuidHob (
   IN CONST VOID      *HobStart
   )
 {
-  EFI_PEI_HOB_POINTERS  GuidHob;
+  EFI_PEI_HOB_POINTERS        GuidHob;
+  EDKII_HOB_GUID_INDEX_TABLE  *Index;
+
+  Index = GetHobGuidIndex ();
+  if ((Index != NULL) && ((UINTN)HobStart >= Index->HobList) && ((UINTN)HobStart <= Index->EndOfHobList)) {
+    return LookupGuidHobIndex (Index, Guid, HobStart);
+  }
 
   GuidHob.Raw = (UINT8 *)HobStart;
   while ((GuidHob.Raw = GetNextHob (EFI_HOB_TYPE_GUID_EXTENSION, GuidHob.Raw)) != NULL) {
@@ -0,0 +1,428 @@
+/** @file
+  Host based unit tests of the hash index library.
+
+  Structures keyed by GUID or by pointer are inserted into hash indexes, and
+  every lookup is checked against the full list of structures, also after
+  structures are removed and when several keys share a hash value.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/HashIndexLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_APP_NAME     "Hash Index Library Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_BUCKET_COUNT  64
+#define TEST_ENTRY_COUNT   256
+
+typedef struct {
+  HASH_INDEX_ENTRY    Entry;
+  EFI_GUID            Guid;
+  BOOLEAN             Inserted;
+} TEST_ENTRY;
+
+typedef struct {
+  HASH_INDEX    Index;
+  LIST_ENTRY    Buckets[TEST_BUCKET_COUNT];
+  TEST_ENTRY    Entries[TEST_ENTRY_COUNT];
+} TEST_CONTEXT;
+
+//
+// An index declared the way the DXE core declares its global indexes
+//
+STATIC LIST_ENTRY  mTestBuckets[TEST_BUCKET_COUNT];
+STATIC HASH_INDEX  mTestIndex = HASH_INDEX_INITIALIZER (mTestBuckets);
+
+/**
+  Count the entries of an index whose key is a GUID, by looking up the hash
+  value of the GUID and comparing the full key of each entry returned.
+
+  @param[in]  Index  The hash index.
+  @param[in]  Guid   The GUID to look up.
+
+  @return The number of entries keyed by the GUID.
+**/
+STATIC
+UINTN
+TestCountGuid (
+  IN HASH_INDEX      *Index,
+  IN CONST EFI_GUID  *Guid
+  )
+{
+  HASH_INDEX_ENTRY  *Entry;
+  UINTN             Count;
+
+  Count = 0;
+  for (Entry = HashIndexGetFirst (Index, HashIndexGuid (Guid));
+       Entry != NULL;
+       Entry = HashIndexGetNext (Index, Entry))
+  {
+    if (CompareGuid (&BASE_CR (Entry, TEST_ENTRY, Entry)->Guid, Guid)) {
+      Count++;
+    }
+  }
+
+  return Count;
+}
+
+/**
+  Fill the entries of the test with distinct GUIDs and an empty index.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED  The entries are initialized.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+HashIndexTestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINTN         Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  ZeroMem (TestContext, sizeof (*TestContext));
+  HashIndexInitialize (&TestContext->Index, TestContext->Buckets, TEST_BUCKET_COUNT);
+
+  //
+  // GUIDs that only differ in a few bits, as the GUIDs of a package do
+  //
+  for (Index = 0; Index < TEST_ENTRY_COUNT; Index++) {
+    TestContext->Entries[Index].Guid.Data1    = 0x5F0B7A8E;
+    TestContext->Entries[Index].Guid.Data2    = (UINT16)(Index % 4);
+    TestContext->Entries[Index].Guid.Data4[7] = (UINT8)(Index / 4);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Every inserted GUID is found exactly once, and removed GUIDs are not found.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED             The lookups match the inserted entries.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A lookup does not match.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+LookupsMatchEntries (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  TEST_ENTRY    *Entry;
+  UINTN         Index;
+  UINTN         Count;
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  for (Index = 0; Index < TEST_ENTRY_COUNT; Index++) {
+    Entry = &TestContext->Entries[Index];
+    UT_ASSERT_EQUAL (TestCountGuid (&TestContext->Index, &Entry->Guid), 0);
+    HashIndexInsert (&TestContext->Index, &Entry->Entry, HashIndexGuid (&Entry->Guid));
+    Entry->Inserted = TRUE;
+    UT_ASSERT_EQUAL (TestContext->Index.Count, Index + 1);
+  }
+
+  //
+  // Remove every third entry, then check every entry
+  //
+  for (Index = 0; Index < TEST_ENTRY_COUNT; Index += 3) {
+    Entry = &TestContext->Entries[Index];
+    HashIndexRemove (&TestContext->Index, &Entry->Entry);
+    Entry->Inserted = FALSE;
+  }
+
+  Count = 0;
+  for (Index = 0; Index < TEST_ENTRY_COUNT; Index++) {
+    Entry = &TestContext->Entries[Index];
+    UT_ASSERT_EQUAL (TestCountGuid (&TestContext->Index, &Entry->Guid), Entry->Inserted ? 1 : 0);
+    if (Entry->Inserted) {
+      Count++;
+    }
+  }
+
+  UT_ASSERT_EQUAL (TestContext->Index.Count, Count);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  All the entries that share a hash value are returned, and entries of the
+  same bucket with another hash value are skipped.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED             The colliding entries are found.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A colliding entry is missing.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+CollidingHashesAreChained (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT      *TestContext;
+  HASH_INDEX_ENTRY  *Entry;
+  UINTN             Index;
+  UINTN             Hash;
+  UINTN             Found[2];
+
+  TestContext = (TEST_CONTEXT *)Context;
+
+  //
+  // Even entries share one hash value, odd entries another one of the same bucket
+  //
+  for (Index = 0; Index < TEST_ENTRY_COUNT; Index++) {
+    Hash = 0x1234 + (Index % 2) * TEST_BUCKET_COUNT;
+    HashIndexInsert (&TestContext->Index, &TestContext->Entries[Index].Entry, Hash);
+  }
+
+  for (Hash = 0; Hash < 2; Hash++) {
+    Found[Hash] = 0;
+    for (Entry = HashIndexGetFirst (&TestContext->Index, 0x1234 + Hash * TEST_BUCKET_COUNT);
+         Entry != NULL;
+         Entry = HashIndexGetNext (&TestContext->Index, Entry))
+    {
+      Index = BASE_CR (Entry, TEST_ENTRY, Entry) - TestContext->Entries;
+      UT_ASSERT_EQUAL (Index % 2, Hash);
+      Found[Hash]++;
+    }
+
+    UT_ASSERT_EQUAL (Found[Hash], TEST_ENTRY_COUNT / 2);
+  }
+
+  UT_ASSERT_EQUAL ((UINTN)HashIndexGetFirst (&TestContext->Index, 0x1234 + 2 * TEST_BUCKET_COUNT), (UINTN)NULL);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  An index declared with HASH_INDEX_INITIALIZER is initialized on first use.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED             The index works without being initialized.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A lookup does not match.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+StaticIndexIsInitializedOnFirstUse (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  TEST_ENTRY    *Entry;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  Entry       = &TestContext->Entries[0];
+
+  UT_ASSERT_EQUAL (mTestIndex.BucketCount, TEST_BUCKET_COUNT);
+  UT_ASSERT_EQUAL (TestCountGuid (&mTestIndex, &Entry->Guid), 0);
+  HashIndexInsert (&mTestIndex, &Entry->Entry, HashIndexGuid (&Entry->Guid));
+  UT_ASSERT_EQUAL (TestCountGuid (&mTestIndex, &Entry->Guid), 1);
+  HashIndexRemove (&mTestIndex, &Entry->Entry);
+  UT_ASSERT_EQUAL (TestCountGuid (&mTestIndex, &Entry->Guid), 0);
+  UT_ASSERT_EQUAL (mTestIndex.Count, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  The hash values of aligned pointers and of similar GUIDs are spread over
+  the buckets, and a GUID hashes the same at any alignment.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED             The hash values are spread.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A bucket holds too many hash values.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+HashesAreSpread (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_CONTEXT  *TestContext;
+  UINTN         PointerLoad[TEST_BUCKET_COUNT];
+  UINTN         GuidLoad[TEST_BUCKET_COUNT];
+  UINT8         Unaligned[sizeof (EFI_GUID) + 1];
+  UINTN         Index;
+
+  TestContext = (TEST_CONTEXT *)Context;
+  ZeroMem (PointerLoad, sizeof (PointerLoad));
+  ZeroMem (GuidLoad, sizeof (GuidLoad));
+
+  for (Index = 0; Index < TEST_ENTRY_COUNT; Index++) {
+    PointerLoad[HashIndexPointer ((VOID *)(UINTN)(SIZE_1GB + Index * SIZE_4KB)) % TEST_BUCKET_COUNT]++;
+    GuidLoad[HashIndexGuid (&TestContext->Entries[Index].Guid) % TEST_BUCKET_COUNT]++;
+
+    CopyMem (&Unaligned[1], &TestContext->Entries[Index].Guid, sizeof (EFI_GUID));
+    UT_ASSERT_EQUAL (HashIndexGuid ((GUID *)&Unaligned[1]), HashIndexGuid (&TestContext->Entries[Index].Guid));
+  }
+
+  //
+  // Four entries per bucket on average; a bucket with three times as many
+  // means that the low bits of the hash values are not mixed
+  //
+  for (Index = 0; Index < TEST_BUCKET_COUNT; Index++) {
+    UT_ASSERT_TRUE (PointerLoad[Index] <= 12);
+    UT_ASSERT_TRUE (GuidLoad[Index] <= 12);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Buffer hashes are MurmurHash64A values that depend on every bit and on the
+  length of the buffer, but not on its alignment.
+
+  @param[in]  Context  The test context.
+
+  @retval UNIT_TEST_PASSED  The test passed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+BufferHashesDependOnEveryBit (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST CHAR8  Text[] = "The quick brown fox jumps over the lazy dog";
+  UINT8               Buffer[64];
+  UINT8               Unaligned[sizeof (Buffer) + 1];
+  UINT64              Hash;
+  UINTN               Length;
+  UINTN               Bit;
+
+  UT_ASSERT_EQUAL (HashIndexBuffer64 (NULL, 0), 0);
+  UT_ASSERT_EQUAL (HashIndexBuffer64 (Text, AsciiStrLen (Text)), 0x5589CA33042A861BULL);
+
+  for (Length = 0; Length < sizeof (Buffer); Length++) {
+    Buffer[Length] = (UINT8)(Length * 7);
+  }
+
+  for (Length = 1; Length <= sizeof (Buffer); Length++) {
+    Hash = HashIndexBuffer64 (Buffer, Length);
+    UT_ASSERT_NOT_EQUAL (Hash, HashIndexBuffer64 (Buffer, Length - 1));
+
+    CopyMem (&Unaligned[1], Buffer, Length);
+    UT_ASSERT_EQUAL (HashIndexBuffer64 (&Unaligned[1], Length), Hash);
+
+    for (Bit = 0; Bit < Length * 8; Bit++) {
+      Buffer[Bit / 8] ^= (UINT8)(1 << (Bit % 8));
+      UT_ASSERT_NOT_EQUAL (HashIndexBuffer64 (Buffer, Length), Hash);
+      Buffer[Bit / 8] ^= (UINT8)(1 << (Bit % 8));
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the hash
+  index library and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      HashIndexTests;
+  STATIC TEST_CONTEXT         TestContext;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Populate the hash index Unit Test Suite.
+  //
+  Status = CreateUnitTestSuite (&HashIndexTests, Framework, "Hash Index Tests", "HashIndexLib", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Hash Index Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite--------Description-----------------------------------------------Name----------------Function----------------------------Pre-----------------Post--Context-----
+  //
+  AddTestCase (HashIndexTests, "Lookups match the inserted entries", "Lookups", LookupsMatchEntries, HashIndexTestSetup, NULL, &TestContext);
+  AddTestCase (HashIndexTests, "Entries sharing a hash value are chained", "Collisions", CollidingHashesAreChained, HashIndexTestSetup, NULL, &TestContext);
+  AddTestCase (HashIndexTests, "Static indexes are initialized on first use", "StaticIndex", StaticIndexIsInitializedOnFirstUse, HashIndexTestSetup, NULL, &TestContext);
+  AddTestCase (HashIndexTests, "Hash values are spread over the buckets", "Spread", HashesAreSpread, HashIndexTestSetup, NULL, &TestContext);
+  AddTestCase (HashIndexTests, "Buffer hashes depend on every bit", "Buffer", BufferHashesDependOnEveryBit, NULL, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define HashIndexLibUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+HashIndexLibUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
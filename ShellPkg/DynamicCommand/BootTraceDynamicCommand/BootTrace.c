@@ -0,0 +1,449 @@
+/** @file
+  Main file for the "boottrace" dynamic UEFI shell command and application.
+
+  This feature displays the boot trace recorded by the DXE core, sorted by
+  the time spent in each module, and can save the raw trace to a file for
+  processing by host tools.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BootTrace.h"
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/HiiLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/ShellLib.h>
+#include <Library/SortLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiHiiServicesLib.h>
+#include <Library/UefiLib.h>
+
+#include <Guid/BootTraceTable.h>
+#include <Protocol/HiiPackageList.h>
+
+#define BOOT_TRACE_FLAG_RAW_STR     L"-r"
+#define BOOT_TRACE_FLAG_OUTPUT_STR  L"-o"
+
+///
+/// Totals of the trace entries of one module. The times exclude the nested
+/// entries, which are accounted to their own modules.
+///
+typedef struct {
+  EFI_GUID    ModuleName;
+  UINT64      ImageTime;
+  UINT64      StartTime;
+  UINT32      StartCount;
+  UINT64      ProtocolInstallCount;
+  UINT64      AllocatedBytes;
+} BOOT_TRACE_MODULE_SUMMARY;
+
+EFI_HII_HANDLE  mBootTraceHiiHandle = NULL;
+
+STATIC CONST SHELL_PARAM_ITEM  ParamList[] = {
+  { BOOT_TRACE_FLAG_RAW_STR,    TypeFlag  },
+  { BOOT_TRACE_FLAG_OUTPUT_STR, TypeValue },
+  { NULL,                       TypeMax   }
+};
+
+/**
+  Return the entry of the boot trace table at a position, counted from the
+  oldest entry still held by the ring buffer.
+
+  @param[in] Table      The boot trace table.
+  @param[in] Position   The position of the entry.
+
+  @return The entry.
+
+**/
+STATIC
+EDKII_BOOT_TRACE_ENTRY *
+GetTraceEntry (
+  IN EDKII_BOOT_TRACE_TABLE  *Table,
+  IN UINTN                   Position
+  )
+{
+  UINT64  Index;
+
+  Index = Position;
+  if (Table->RecordCount > Table->EntryCount) {
+    Index += ModU64x32 (Table->RecordCount, Table->EntryCount);
+  }
+
+  return (EDKII_BOOT_TRACE_ENTRY *)((UINT8 *)Table + Table->HeaderSize +
+                                    (UINTN)ModU64x32 (Index, Table->EntryCount) * Table->EntrySize);
+}
+
+/**
+  Compare two module summaries by the total time spent in the module, the
+  longest first.
+
+  @param[in] Buffer1    The first summary.
+  @param[in] Buffer2    The second summary.
+
+  @retval <0            Buffer1 sorts before Buffer2.
+  @retval 0             Buffer1 and Buffer2 are equivalent.
+  @retval >0            Buffer1 sorts after Buffer2.
+
+**/
+STATIC
+INTN
+EFIAPI
+CompareModuleSummary (
+  IN CONST VOID  *Buffer1,
+  IN CONST VOID  *Buffer2
+  )
+{
+  CONST BOOT_TRACE_MODULE_SUMMARY  *Summary1;
+  CONST BOOT_TRACE_MODULE_SUMMARY  *Summary2;
+  UINT64                           Time1;
+  UINT64                           Time2;
+
+  Summary1 = (CONST BOOT_TRACE_MODULE_SUMMARY *)Buffer1;
+  Summary2 = (CONST BOOT_TRACE_MODULE_SUMMARY *)Buffer2;
+  Time1    = Summary1->ImageTime + Summary1->StartTime;
+  Time2    = Summary2->ImageTime + Summary2->StartTime;
+
+  if (Time1 == Time2) {
+    return 0;
+  }
+
+  return (Time1 > Time2) ? -1 : 1;
+}
+
+/**
+  Print the totals of each module of the boot trace, sorted by the time spent
+  in the module.
+
+  @param[in] Table      The boot trace table.
+  @param[in] Count      The number of entries held by the table.
+
+  @retval EFI_SUCCESS           The summary was printed.
+  @retval EFI_OUT_OF_RESOURCES  Memory allocation failed.
+
+**/
+STATIC
+EFI_STATUS
+PrintModuleSummary (
+  IN EDKII_BOOT_TRACE_TABLE  *Table,
+  IN UINTN                   Count
+  )
+{
+  BOOT_TRACE_MODULE_SUMMARY  *Summaries;
+  BOOT_TRACE_MODULE_SUMMARY  *Summary;
+  EDKII_BOOT_TRACE_ENTRY     *Entry;
+  UINTN                      SummaryCount;
+  UINTN                      Position;
+  UINTN                      Index;
+
+  if (Count == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Summaries = AllocateZeroPool (Count * sizeof (BOOT_TRACE_MODULE_SUMMARY));
+  if (Summaries == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  SummaryCount = 0;
+  for (Position = 0; Position < Count; Position++) {
+    Entry = GetTraceEntry (Table, Position);
+    for (Index = 0; Index < SummaryCount; Index++) {
+      if (CompareGuid (&Summaries[Index].ModuleName, &Entry->ModuleName)) {
+        break;
+      }
+    }
+
+    Summary = &Summaries[Index];
+    if (Index == SummaryCount) {
+      CopyGuid (&Summary->ModuleName, &Entry->ModuleName);
+      SummaryCount++;
+    }
+
+    if (Entry->Type == EDKII_BOOT_TRACE_TYPE_START_IMAGE) {
+      Summary->ImageTime += Entry->Duration - Entry->ChildDuration;
+    } else {
+      Summary->StartTime += Entry->Duration - Entry->ChildDuration;
+      Summary->StartCount++;
+    }
+
+    Summary->ProtocolInstallCount += Entry->ProtocolInstallCount;
+    Summary->AllocatedBytes       += Entry->AllocatedBytes;
+  }
+
+  PerformQuickSort (Summaries, SummaryCount, sizeof (BOOT_TRACE_MODULE_SUMMARY), CompareModuleSummary);
+
+  ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_BOOT_TRACE_MODULE_HEADER), mBootTraceHiiHandle);
+  for (Index = 0; Index < SummaryCount; Index++) {
+    if (ShellGetExecutionBreakFlag ()) {
+      break;
+    }
+
+    Summary = &Summaries[Index];
+    ShellPrintHiiEx (
+      -1,
+      -1,
+      NULL,
+      STRING_TOKEN (STR_BOOT_TRACE_MODULE_LINE),
+      mBootTraceHiiHandle,
+      &Summary->ModuleName,
+      DivU64x32 (Summary->ImageTime, 1000),
+      DivU64x32 (Summary->StartTime, 1000),
+      Summary->StartCount,
+      Summary->ProtocolInstallCount,
+      Summary->AllocatedBytes
+      );
+  }
+
+  FreePool (Summaries);
+  return EFI_SUCCESS;
+}
+
+/**
+  Print the entries of the boot trace, the oldest first.
+
+  @param[in] Table      The boot trace table.
+  @param[in] Count      The number of entries held by the table.
+
+**/
+STATIC
+VOID
+PrintEntries (
+  IN EDKII_BOOT_TRACE_TABLE  *Table,
+  IN UINTN                   Count
+  )
+{
+  EDKII_BOOT_TRACE_ENTRY  *Entry;
+  UINTN                   Position;
+
+  ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_BOOT_TRACE_ENTRY_HEADER), mBootTraceHiiHandle);
+  for (Position = 0; Position < Count; Position++) {
+    if (ShellGetExecutionBreakFlag ()) {
+      break;
+    }
+
+    Entry = GetTraceEntry (Table, Position);
+    ShellPrintHiiEx (
+      -1,
+      -1,
+      NULL,
+      STRING_TOKEN (STR_BOOT_TRACE_ENTRY_LINE),
+      mBootTraceHiiHandle,
+      (Entry->Type == EDKII_BOOT_TRACE_TYPE_START_IMAGE) ? L"Image" : L"Start",
+      Entry->Depth,
+      &Entry->ModuleName,
+      DivU64x32 (Entry->StartTime, 1000),
+      DivU64x32 (Entry->Duration, 1000),
+      DivU64x32 (Entry->Duration - Entry->ChildDuration, 1000),
+      Entry->ProtocolInstallCount,
+      Entry->AllocatedBytes,
+      Entry->ControllerHandle,
+      (EFI_STATUS)Entry->Status
+      );
+  }
+}
+
+/**
+  Save the boot trace table to a file, replacing any existing file.
+
+  @param[in] Table      The boot trace table.
+  @param[in] FileName   The name of the file.
+
+  @retval EFI_SUCCESS   The table was saved.
+  @retval Others        The file could not be written.
+
+**/
+STATIC
+EFI_STATUS
+SaveTable (
+  IN EDKII_BOOT_TRACE_TABLE  *Table,
+  IN CONST CHAR16            *FileName
+  )
+{
+  EFI_STATUS         Status;
+  SHELL_FILE_HANDLE  FileHandle;
+  UINTN              Size;
+
+  ShellDeleteFileByName (FileName);
+
+  Status = ShellOpenFileByName (FileName, &FileHandle, EFI_FILE_MODE_CREATE | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ, 0);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Size   = Table->HeaderSize + (UINTN)Table->EntryCount * Table->EntrySize;
+  Status = ShellWriteFile (FileHandle, &Size, Table);
+  ShellCloseFile (&FileHandle);
+
+  return Status;
+}
+
+/**
+  Main entry function for the "boottrace" command/app.
+
+  @param[in] ImageHandle  Handle to the Image (NULL if Internal).
+  @param[in] SystemTable  Pointer to the System Table (NULL if Internal).
+
+  @retval   SHELL_SUCCESS               The "boottrace" shell command executed successfully.
+  @retval   SHELL_ABORTED               Failed to initialize the shell library.
+  @retval   SHELL_INVALID_PARAMETER     An argument passed to the shell command is invalid.
+  @retval   SHELL_NOT_FOUND             The boot trace table is not installed.
+  @retval   Others                      A different error occurred.
+
+**/
+SHELL_STATUS
+EFIAPI
+RunBootTrace (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS              Status;
+  SHELL_STATUS            ShellStatus;
+  LIST_ENTRY              *Package;
+  CHAR16                  *ProblemParam;
+  CONST CHAR16            *FileName;
+  EDKII_BOOT_TRACE_TABLE  *Table;
+  UINTN                   Count;
+
+  Package     = NULL;
+  ShellStatus = SHELL_SUCCESS;
+
+  Status = ShellInitialize ();
+  if (EFI_ERROR (Status)) {
+    ASSERT_EFI_ERROR (Status);
+    return SHELL_ABORTED;
+  }
+
+  Status = ShellCommandLineParse (ParamList, &Package, &ProblemParam, TRUE);
+  if (EFI_ERROR (Status)) {
+    if ((Status == EFI_VOLUME_CORRUPTED) && (ProblemParam != NULL)) {
+      ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_PROBLEM), mBootTraceHiiHandle, BOOT_TRACE_COMMAND_NAME, ProblemParam);
+      FreePool (ProblemParam);
+    }
+
+    return SHELL_INVALID_PARAMETER;
+  }
+
+  if (ShellCommandLineGetCount (Package) > 1) {
+    ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_TOO_MANY), mBootTraceHiiHandle, BOOT_TRACE_COMMAND_NAME);
+    ShellStatus = SHELL_INVALID_PARAMETER;
+    goto Done;
+  }
+
+  FileName = ShellCommandLineGetValue (Package, BOOT_TRACE_FLAG_OUTPUT_STR);
+  if (ShellCommandLineGetFlag (Package, BOOT_TRACE_FLAG_OUTPUT_STR) && (FileName == NULL)) {
+    ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_NO_VALUE), mBootTraceHiiHandle, BOOT_TRACE_COMMAND_NAME, BOOT_TRACE_FLAG_OUTPUT_STR);
+    ShellStatus = SHELL_INVALID_PARAMETER;
+    goto Done;
+  }
+
+  Status = EfiGetSystemConfigurationTable (&gEdkiiBootTraceTableGuid, (VOID **)&Table);
+  if (EFI_ERROR (Status) || (Table == NULL)) {
+    ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_BOOT_TRACE_NOT_FOUND), mBootTraceHiiHandle);
+    ShellStatus = SHELL_NOT_FOUND;
+    goto Done;
+  }
+
+  if ((Table->Signature != EDKII_BOOT_TRACE_TABLE_SIGNATURE) ||
+      (Table->Version != EDKII_BOOT_TRACE_TABLE_VERSION) ||
+      (Table->HeaderSize < sizeof (EDKII_BOOT_TRACE_TABLE)) ||
+      (Table->EntrySize < sizeof (EDKII_BOOT_TRACE_ENTRY)) ||
+      (Table->EntryCount == 0))
+  {
+    ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_BOOT_TRACE_UNSUPPORTED), mBootTraceHiiHandle);
+    ShellStatus = SHELL_UNSUPPORTED;
+    goto Done;
+  }
+
+  if (FileName != NULL) {
+    Status = SaveTable (Table, FileName);
+    if (EFI_ERROR (Status)) {
+      ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_FILE_WRITE_FAIL), mBootTraceHiiHandle, BOOT_TRACE_COMMAND_NAME, FileName, Status);
+      ShellStatus = SHELL_DEVICE_ERROR;
+    } else {
+      ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_BOOT_TRACE_SAVED), mBootTraceHiiHandle, FileName);
+    }
+
+    goto Done;
+  }
+
+  Count = (UINTN)MIN (Table->RecordCount, Table->EntryCount);
+  ShellPrintHiiEx (
+    -1,
+    -1,
+    NULL,
+    STRING_TOKEN (STR_BOOT_TRACE_SUMMARY),
+    mBootTraceHiiHandle,
+    Table->RecordCount,
+    (UINT64)Count,
+    Table->EntryCount
+    );
+
+  if (ShellCommandLineGetFlag (Package, BOOT_TRACE_FLAG_RAW_STR)) {
+    PrintEntries (Table, Count);
+  } else {
+    Status = PrintModuleSummary (Table, Count);
+    if (EFI_ERROR (Status)) {
+      ShellStatus = SHELL_OUT_OF_RESOURCES;
+    }
+  }
+
+Done:
+  ShellCommandLineFreeVarList (Package);
+  return ShellStatus;
+}
+
+/**
+  Retrieve HII package list from ImageHandle and publish to HII database.
+
+  @param[in] ImageHandle    The image handle of the process.
+
+  @return HII handle.
+
+**/
+EFI_HII_HANDLE
+BootTraceInitializeHiiPackage (
+  IN  EFI_HANDLE  ImageHandle
+  )
+{
+  EFI_STATUS                   Status;
+  EFI_HII_PACKAGE_LIST_HEADER  *PackageList;
+  EFI_HII_HANDLE               HiiHandle;
+
+  //
+  // Retrieve HII package list from ImageHandle
+  //
+  Status = gBS->OpenProtocol (
+                  ImageHandle,
+                  &gEfiHiiPackageListProtocolGuid,
+                  (VOID **)&PackageList,
+                  ImageHandle,
+                  NULL,
+                  EFI_OPEN_PROTOCOL_GET_PROTOCOL
+                  );
+  ASSERT_EFI_ERROR (Status);
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  //
+  // Publish HII package list to HII Database.
+  //
+  Status = gHiiDatabase->NewPackageList (
+                           gHiiDatabase,
+                           PackageList,
+                           NULL,
+                           &HiiHandle
+                           );
+  ASSERT_EFI_ERROR (Status);
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  return HiiHandle;
+}
@@ -0,0 +1,51 @@
+/** @file
+  Internal header file for the "boottrace" shell command and application.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef BOOT_TRACE_SHELL_COMMAND_H_
+#define BOOT_TRACE_SHELL_COMMAND_H_
+
+#include <Uefi.h>
+#include <Protocol/Shell.h>
+
+#define BOOT_TRACE_COMMAND_NAME  L"boottrace"
+
+extern EFI_HII_HANDLE  mBootTraceHiiHandle;
+
+/**
+  Retrieve HII package list from ImageHandle and publish to HII database.
+
+  @param[in] ImageHandle    The image handle of the process.
+
+  @return HII handle.
+
+**/
+EFI_HII_HANDLE
+BootTraceInitializeHiiPackage (
+  IN  EFI_HANDLE  ImageHandle
+  );
+
+/**
+  Main entry function for the "boottrace" command/app.
+
+  @param[in] ImageHandle  Handle to the Image (NULL if Internal).
+  @param[in] SystemTable  Pointer to the System Table (NULL if Internal).
+
+  @retval   SHELL_SUCCESS               The "boottrace" shell command executed successfully.
+  @retval   SHELL_INVALID_PARAMETER     An argument passed to the shell command is invalid.
+  @retval   SHELL_NOT_FOUND             The boot trace table is not installed.
+  @retval   Others                      A different error occurred.
+
+**/
+SHELL_STATUS
+EFIAPI
+RunBootTrace (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  );
+
+#endif
@@ -0,0 +1,56 @@
+/** @file
+  Functionality specific for standalone UEFI application support.
+
+  This application displays the boot trace recorded by the DXE core.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BootTrace.h"
+
+#include <Library/BaseLib.h>
+#include <Library/HiiLib.h>
+
+//
+// String token ID of help message text.
+// Shell supports finding the help message in the resource section of an
+// application image if a .MAN file is not found. This global variable is added
+// to make the build tool recognize that the help string is consumed by the user and
+// then the build tool will add the string into the resource section. Thus the
+// application can use '-?' option to show help message in Shell.
+//
+GLOBAL_REMOVE_IF_UNREFERENCED EFI_STRING_ID  mStringHelpTokenId = STRING_TOKEN (STR_GET_HELP_BOOT_TRACE);
+
+/**
+  Entry of the boot trace application.
+
+  @param ImageHandle            The image handle of the process.
+  @param SystemTable            The EFI System Table pointer.
+
+  @retval EFI_SUCCESS           The application successfully initialized.
+  @retval EFI_ABORTED           The application failed to initialize.
+  @retval Others                A different error occurred.
+
+**/
+EFI_STATUS
+EFIAPI
+BootTraceAppInitialize (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS  Status;
+
+  mBootTraceHiiHandle = BootTraceInitializeHiiPackage (ImageHandle);
+  if (mBootTraceHiiHandle == NULL) {
+    return EFI_ABORTED;
+  }
+
+  Status = (EFI_STATUS)RunBootTrace (ImageHandle, SystemTable);
+
+  HiiRemovePackages (mBootTraceHiiHandle);
+
+  return Status;
+}
@@ -8,6 +8,7 @@
 **/
 
 #include "UefiShellDebug1CommandsLib.h"
+#include <Protocol/VariableEnumeration.h>
 
 typedef enum {
   DmpStoreDisplay,
@@ -28,6 +29,24 @@ typedef struct {
 
 #define DMP_STORE_VARIABLE_SIGNATURE  SIGNATURE_32 ('_', 'd', 's', 's')
 
+#define DMP_STORE_RECORDS_BUFFER_SIZE  SIZE_4KB
+
+///
+/// The variable enumeration protocol of the variable driver, or NULL if the
+/// variables are enumerated with GetNextVariableName().
+///
+STATIC EDKII_VARIABLE_ENUMERATION_PROTOCOL  *mVariableEnumeration = NULL;
+
+///
+/// Variable records returned by GetVariableRecords() and not enumerated yet,
+/// from mRecordsOffset to mRecordsSize, and the cursor following them.
+///
+STATIC UINT8   *mRecords          = NULL;
+STATIC UINTN   mRecordsBufferSize = 0;
+STATIC UINTN   mRecordsSize       = 0;
+STATIC UINTN   mRecordsOffset     = 0;
+STATIC UINT64  mRecordsCursor     = EDKII_VARIABLE_ENUMERATION_CURSOR_START;
+
 /**
   Base on the input attribute value to return the attribute string.
 
@@ -389,6 +408,99 @@ AppendSingleVariableToFile (
   return Status;
 }
 
+/**
+  Get the next records of variables from the variable enumeration protocol.
+
+  @retval EFI_SUCCESS             At least one record was returned.
+  @retval EFI_NOT_FOUND           There are no more variables.
+  @retval others                  The records could not be returned.
+**/
+EFI_STATUS
+DmpStoreGetVariableRecords (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  mRecordsOffset = 0;
+  mRecordsSize   = mRecordsBufferSize;
+  Status         = mVariableEnumeration->GetVariableRecords (mVariableEnumeration, &mRecordsCursor, &mRecordsSize, mRecords);
+  if (Status == EFI_BUFFER_TOO_SMALL) {
+    SHELL_FREE_NON_NULL (mRecords);
+    mRecordsBufferSize = 0;
+    mRecords           = AllocatePool (mRecordsSize);
+    if (mRecords == NULL) {
+      mRecordsSize = 0;
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    mRecordsBufferSize = mRecordsSize;
+    Status             = mVariableEnumeration->GetVariableRecords (mVariableEnumeration, &mRecordsCursor, &mRecordsSize, mRecords);
+  }
+
+  if (EFI_ERROR (Status)) {
+    mRecordsSize = 0;
+  }
+
+  return Status;
+}
+
+/**
+  Get the next variable. The records of the variable enumeration protocol are
+  used when it is available, so that the variable driver does not look up the
+  previous variable by its name, and returns many variables per call.
+
+  @param[in, out] NameSize        The size of the Name buffer.
+  @param[in, out] Name            On input, the previous variable name. On output, the next one.
+  @param[in, out] Guid            On input, the previous GUID. On output, the next one.
+
+  @return The status of GetNextVariableName().
+**/
+EFI_STATUS
+DmpStoreGetNextVariableName (
+  IN OUT UINTN     *NameSize,
+  IN OUT CHAR16    *Name,
+  IN OUT EFI_GUID  *Guid
+  )
+{
+  EFI_STATUS                         Status;
+  EDKII_VARIABLE_ENUMERATION_RECORD  *Record;
+
+  if (mVariableEnumeration != NULL) {
+    Status = EFI_SUCCESS;
+    if (mRecordsOffset == mRecordsSize) {
+      Status = DmpStoreGetVariableRecords ();
+    }
+
+    if (!EFI_ERROR (Status)) {
+      Record = (EDKII_VARIABLE_ENUMERATION_RECORD *)(mRecords + mRecordsOffset);
+      if (Record->NameSize > *NameSize) {
+        *NameSize = Record->NameSize;
+        return EFI_BUFFER_TOO_SMALL;
+      }
+
+      CopyMem (Name, Record + 1, Record->NameSize);
+      CopyGuid (Guid, &Record->VendorGuid);
+      *NameSize       = Record->NameSize;
+      mRecordsOffset += Record->RecordSize;
+      return EFI_SUCCESS;
+    }
+
+    if (Status == EFI_NOT_FOUND) {
+      return Status;
+    }
+
+    //
+    // The cursor is no longer valid as the variable stores were reclaimed, or
+    // a record cannot be returned, continue the enumeration from the previous
+    // variable name.
+    //
+    mVariableEnumeration = NULL;
+  }
+
+  return gRT->GetNextVariableName (NameSize, Name, Guid);
+}
+
 /**
   Recursive function to display or delete variables.
 
@@ -451,7 +563,7 @@ CascadeProcessVariables (
     NameSize     = sizeof (CHAR16);
   }
 
-  Status = gRT->GetNextVariableName (&NameSize, FoundVarName, &FoundVarGuid);
+  Status = DmpStoreGetNextVariableName (&NameSize, FoundVarName, &FoundVarGuid);
   if (Status == EFI_BUFFER_TOO_SMALL) {
     SHELL_FREE_NON_NULL (FoundVarName);
     FoundVarName = AllocateZeroPool (NameSize);
@@ -460,7 +572,7 @@ CascadeProcessVariables (
         StrnCpyS (FoundVarName, NameSize/sizeof (CHAR16), PrevName, NameSize/sizeof (CHAR16) - 1);
       }
 
-      Status = gRT->GetNextVariableName (&NameSize, FoundVarName, &FoundVarGuid);
+      Status = DmpStoreGetNextVariableName (&NameSize, FoundVarName, &FoundVarGuid);
     } else {
       Status = EFI_OUT_OF_RESOURCES;
     }
@@ -687,7 +799,21 @@ ProcessVariables (
   if (Type == DmpStoreLoad) {
     ShellStatus = LoadVariablesFromFile (FileHandle, Name, Guid, &Found);
   } else {
+    if (EFI_ERROR (gBS->LocateProtocol (&gEdkiiVariableEnumerationProtocolGuid, NULL, (VOID **)&mVariableEnumeration))) {
+      mVariableEnumeration = NULL;
+    }
+
+    mRecordsBufferSize = DMP_STORE_RECORDS_BUFFER_SIZE;
+    mRecordsSize       = 0;
+    mRecordsOffset     = 0;
+    mRecordsCursor     = EDKII_VARIABLE_ENUMERATION_CURSOR_START;
+    mRecords           = AllocatePool (mRecordsBufferSize);
+    if (mRecords == NULL) {
+      mVariableEnumeration = NULL;
+    }
+
     ShellStatus = CascadeProcessVariables (Name, Guid, Type, FileHandle, NULL, FoundVarGuid, &Found, StandardFormatOutput);
+    SHELL_FREE_NON_NULL (mRecords);
   }
 
   if (!Found) {
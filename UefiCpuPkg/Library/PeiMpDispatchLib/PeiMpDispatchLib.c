@@ -0,0 +1,110 @@
+/** @file
+  PEI instance of the MP dispatch library, which runs the procedure on all
+  the enabled processors with StartupAllCPUs() of the EDKII PEI MP Services 2
+  PPI.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiPei.h>
+#include <Ppi/MpServices2.h>
+#include <Library/DebugLib.h>
+#include <Library/MpDispatchLib.h>
+#include <Library/PeiServicesLib.h>
+
+/**
+  Return the EDKII PEI MP Services 2 PPI, if it is installed.
+
+  @return The PPI, or NULL if it is not installed.
+
+**/
+STATIC
+EDKII_PEI_MP_SERVICES2_PPI *
+GetMpServices2 (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  EDKII_PEI_MP_SERVICES2_PPI  *MpServices2;
+
+  Status = PeiServicesLocatePpi (&gEdkiiPeiMpServices2PpiGuid, 0, NULL, (VOID **)&MpServices2);
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  return MpServices2;
+}
+
+/**
+  Return the number of processors that MpDispatchRunOnAllProcessors() runs
+  the procedure on.
+
+  The number only changes when processors are enabled or disabled, or when
+  the services used to start the application processors are installed.
+
+  @return The number of enabled processors, or 1 if the EDKII PEI MP Services
+          2 PPI is not installed.
+
+**/
+UINTN
+EFIAPI
+MpDispatchGetProcessorCount (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  EDKII_PEI_MP_SERVICES2_PPI  *MpServices2;
+  UINTN                       NumberOfProcessors;
+  UINTN                       NumberOfEnabledProcessors;
+
+  MpServices2 = GetMpServices2 ();
+  if (MpServices2 == NULL) {
+    return 1;
+  }
+
+  Status = MpServices2->GetNumberOfProcessors (MpServices2, &NumberOfProcessors, &NumberOfEnabledProcessors);
+  if (EFI_ERROR (Status) || (NumberOfEnabledProcessors == 0)) {
+    return 1;
+  }
+
+  return NumberOfEnabledProcessors;
+}
+
+/**
+  Run a procedure on all the enabled processors, the calling boot processor
+  included, and return when it has returned on all of them.
+
+  The boot processor runs the procedure while the application processors run
+  it, rather than waiting for them. If the application processors cannot be
+  started, the procedure is only run on the boot processor.
+
+  @param[in]      Procedure  The procedure to run.
+  @param[in, out] Argument   The argument passed to the procedure.
+
+**/
+VOID
+EFIAPI
+MpDispatchRunOnAllProcessors (
+  IN     EFI_AP_PROCEDURE  Procedure,
+  IN OUT VOID              *Argument  OPTIONAL
+  )
+{
+  EFI_STATUS                  Status;
+  EDKII_PEI_MP_SERVICES2_PPI  *MpServices2;
+
+  ASSERT (Procedure != NULL);
+
+  MpServices2 = GetMpServices2 ();
+  if (MpServices2 != NULL) {
+    Status = MpServices2->StartupAllCPUs (MpServices2, Procedure, 0, Argument);
+    if (!EFI_ERROR (Status)) {
+      return;
+    }
+
+    DEBUG ((DEBUG_WARN, "%a: StartupAllCPUs - %r\n", __func__, Status));
+  }
+
+  Procedure (Argument);
+}
@@ -0,0 +1,35 @@
+/** @file
+  Provides a seeded pseudo random number generator for unit tests.
+
+  Tests that exercise code with random operations need the same sequence of
+  operations on every run, so that a failure can be reproduced. The state of
+  the generator is owned by the caller, so that each test can restart its own
+  sequence from a seed.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _UNIT_TEST_RANDOM_LIB_H_
+#define _UNIT_TEST_RANDOM_LIB_H_
+
+/**
+  Return the next pseudo random number of a sequence.
+
+  The same seed always produces the same sequence of numbers. The numbers are
+  not suitable for cryptography.
+
+  @param[in, out]  Seed  The state of the sequence. Set it to a seed before
+                         the first call.
+
+  @return A pseudo random number.
+
+**/
+UINT32
+EFIAPI
+UnitTestRandom (
+  IN OUT UINT64  *Seed
+  );
+
+#endif
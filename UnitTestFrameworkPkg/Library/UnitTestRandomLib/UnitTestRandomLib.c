@@ -0,0 +1,40 @@
+/** @file
+  Seeded pseudo random number generator for unit tests.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/UnitTestRandomLib.h>
+
+/**
+  Return the next pseudo random number of a sequence.
+
+  The same seed always produces the same sequence of numbers. The numbers are
+  not suitable for cryptography.
+
+  @param[in, out]  Seed  The state of the sequence. Set it to a seed before
+                         the first call.
+
+  @return A pseudo random number.
+
+**/
+UINT32
+EFIAPI
+UnitTestRandom (
+  IN OUT UINT64  *Seed
+  )
+{
+  ASSERT (Seed != NULL);
+
+  //
+  // 64-bit linear congruential generator of Knuth's MMIX, returning the high 31
+  // bits as the low bits of the state have short periods
+  //
+  *Seed = MultU64x64 (*Seed, 6364136223846793005ULL) + 1442695040888963407ULL;
+  return (UINT32)RShiftU64 (*Seed, 33);
+}